@@ -101,6 +101,11 @@ static const int kBGMErrorCode_ReturningEarly       = 2;
 // code received from the HAL.
 - (OSStatus) startPlayThroughSync:(BOOL)forUISoundsDevice;
 
+// The counts of the glitches in playthrough, with the counts from the main and UI sounds
+// playthroughs added together, in the kAudioDeviceCustomPropertyGlitchTelemetry format. (See
+// BGM_GlitchTelemetry.h.) If reset is YES, the counts are reset after they're read.
+- (NSDictionary*) playThroughGlitchTelemetryResetting:(BOOL)reset;
+
 // When the output device is changed, BGMAudioDeviceManager will send the ID of the new output
 // device to BGMXPCHelper through this connection.
 - (void) setBGMXPCHelperConnection:(NSXPCConnection* __nullable)connection;
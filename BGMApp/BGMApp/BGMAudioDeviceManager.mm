@@ -26,6 +26,7 @@
 // Local Includes
 #import "BGM_Types.h"
 #import "BGM_Utils.h"
+#import "BGM_GlitchTelemetry.h"
 #import "BGMAudioDevice.h"
 #import "BGMDeviceControlSync.h"
 #import "BGMOutputDeviceMenuSection.h"
@@ -435,6 +436,19 @@
     return err;
 }
 
+- (NSDictionary*) playThroughGlitchTelemetryResetting:(BOOL)reset {
+    // The counters are atomic, so this doesn't need stateLock.
+    BGM_GlitchTelemetrySnapshot snapshot = playThrough.GetGlitchTelemetry().GetSnapshot();
+    snapshot.Add(playThrough_UISounds.GetGlitchTelemetry().GetSnapshot());
+    
+    if (reset) {
+        playThrough.GetGlitchTelemetry().Reset();
+        playThrough_UISounds.GetGlitchTelemetry().Reset();
+    }
+    
+    return CFBridgingRelease(BGM_GlitchTelemetry::CopyAsDictionary(snapshot).GetDict());
+}
+
 #pragma mark BGMXPCHelper Communication
 
 - (void) setBGMXPCHelperConnection:(NSXPCConnection* __nullable)connection {
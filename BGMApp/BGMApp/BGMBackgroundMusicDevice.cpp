@@ -52,6 +52,27 @@ BGMBackgroundMusicDevice::BGMBackgroundMusicDevice()
         LogError("BGMBackgroundMusicDevice::BGMBackgroundMusicDevice: Error getting BGMDevice ID");
         Throw(CAException(kAudioHardwareIllegalOperationError));
     }
+
+    // Create the shared parameter tables BGMDriver reads. They're optional, so just log it if they
+    // can't be created, e.g. because another user has already created them.
+    auto openParameterTable = [] (const char* name) {
+        return std::shared_ptr<BGMParameterTable>(BGMParameterTableCreate(name),
+                                                  [] (BGMParameterTable* __nullable table) {
+                                                      if(table)
+                                                      {
+                                                          BGMParameterTableClose(table);
+                                                      }
+                                                  });
+    };
+
+    mParameterTable = openParameterTable(kBGMParameterTableName);
+    mUISoundsParameterTable = openParameterTable(kBGMParameterTableName_UISounds);
+
+    if(!mParameterTable)
+    {
+        LogWarning("BGMBackgroundMusicDevice::BGMBackgroundMusicDevice: Couldn't create the "
+                   "shared parameter table");
+    }
 };
 
 BGMBackgroundMusicDevice::~BGMBackgroundMusicDevice()
@@ -201,6 +222,37 @@ void BGMBackgroundMusicDevice::SendAppVolumeOrPanToBGMDevice(SInt32 inNewValue,
     mUISoundsBGMDevice.SetPropertyData_CFType(kBGMAppVolumesAddress, changesPList);
 }
 
+bool BGMBackgroundMusicDevice::SetAppVolumeViaSharedMemory(Float32 inVolume,
+                                                           pid_t inAppProcessID)
+{
+    return SetAppParameterViaSharedMemory(kBGMParameterRelativeVolume, inVolume, inAppProcessID);
+}
+
+bool BGMBackgroundMusicDevice::SetAppPanPositionViaSharedMemory(Float32 inPanPosition,
+                                                                pid_t inAppProcessID)
+{
+    return SetAppParameterViaSharedMemory(kBGMParameterPanPosition, inPanPosition, inAppProcessID);
+}
+
+bool BGMBackgroundMusicDevice::SetAppParameterViaSharedMemory(BGMParameter inParameter,
+                                                              Float32 inValue,
+                                                              pid_t inAppProcessID)
+{
+    if(!mParameterTable || inAppProcessID <= 0)
+    {
+        return false;
+    }
+
+    // Also set it for the instance of BGMDevice that handles UI sounds, like
+    // SendAppVolumeOrPanToBGMDevice does.
+    if(mUISoundsParameterTable)
+    {
+        BGMParameterTableSetValue(mUISoundsParameterTable.get(), inAppProcessID, inParameter, inValue);
+    }
+
+    return BGMParameterTableSetValue(mParameterTable.get(), inAppProcessID, inParameter, inValue);
+}
+
 // This is a temporary solution that lets us control the volumes of some multiprocess apps, i.e.
 // apps that play their audio from a process with a different bundle ID.
 //
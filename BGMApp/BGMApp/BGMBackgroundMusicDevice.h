@@ -39,11 +39,13 @@
 
 // Local Includes
 #include "BGM_Types.h"
+#include "BGM_ParameterTable.h"
 
 // PublicUtility Includes
 #include "CACFString.h"
 
 // STL Includes
+#include <memory>
 #include <vector>
 
 
@@ -120,15 +122,49 @@ public:
                                           pid_t inAppProcessID,
                                           CFStringRef __nullable inAppBundleID);
 
+    /*!
+     Set an app's volume through BGMDriver's shared parameter table instead of the
+     kAudioDeviceCustomPropertyAppVolumes property. This is much cheaper and doesn't block, so it's
+     suitable for controls that change quickly, e.g. MIDI faders. See BGM_ParameterTable.h.
+
+     The volume isn't persisted or returned by GetAppVolumes, so call SetAppVolume with the final
+     value once the control is released.
+
+     @param inVolume A value between kAppRelativeVolumeMinRawValue and
+                     kAppRelativeVolumeMaxRawValue. Fractional values are allowed.
+     @param inAppProcessID The ID of the app's audio process.
+     @return False if the shared parameter table isn't available or is full, in which case the
+             caller should use SetAppVolume instead.
+     */
+    bool                SetAppVolumeViaSharedMemory(Float32 inVolume, pid_t inAppProcessID);
+    /*!
+     The pan position version of SetAppVolumeViaSharedMemory.
+
+     @param inPanPosition A value between kAppPanLeftRawValue and kAppPanRightRawValue. Fractional
+                          values are allowed.
+     */
+    bool                SetAppPanPositionViaSharedMemory(Float32 inPanPosition, pid_t inAppProcessID);
+
 private:
     void                SendAppVolumeOrPanToBGMDevice(SInt32 inNewValue,
                                                       CFStringRef inVolumeTypeKey,
                                                       pid_t inAppProcessID,
                                                       CFStringRef __nullable inAppBundleID);
 
+    bool                SetAppParameterViaSharedMemory(BGMParameter inParameter,
+                                                       Float32 inValue,
+                                                       pid_t inAppProcessID);
+
     static std::vector<CACFString>
                         ResponsibleBundleIDsOf(CACFString inParentBundleID);
 
+    /*!
+     The shared parameter tables of BGMDevice and the UI sounds instance, or null if they couldn't be
+     created. Shared so copies of this object can keep using them.
+     */
+    std::shared_ptr<BGMParameterTable> mParameterTable;
+    std::shared_ptr<BGMParameterTable> mUISoundsParameterTable;
+
 #pragma mark Audible State
 
 public:
@@ -24,6 +24,7 @@
 #include "BGMPlayThrough.h"
 
 // Local Includes
+#include "BGM_RTSafety.h"
 #include "BGM_Types.h"
 #include "BGM_Utils.h"
 
@@ -246,15 +247,16 @@ void    BGMPlayThrough::AllocateBuffer()
     CAMutex::Locker lockerInput(mBufferInputMutex);
     CAMutex::Locker lockerOutput(mBufferOutputMutex);
 
-    mBuffer = std::unique_ptr<CARingBuffer>(new CARingBuffer);
+    mBuffer = std::unique_ptr<BGM_SPSCAudioRingBuffer>(new BGM_SPSCAudioRingBuffer);
 
     // The calculation for the size of the buffer is from Apple's CAPlayThrough.cpp sample code
     //
+    // The IOProcs copy interleaved stereo Float32 frames between the devices' first buffers, since
+    // that's BGMDevice's format. (The output device's virtual format is also assumed to match it.)
+    //
     // TODO: Test playthrough with hardware with more than 2 channels per frame, a sample (virtual) format other than
     //       32-bit floats and/or an IO buffer size other than 512 frames
-    mBuffer->Allocate(outputFormat[0].mChannelsPerFrame,
-                      outputFormat[0].mBytesPerFrame,
-                      mOutputDevice.GetIOBufferSize() * 20);
+    mBuffer->Allocate(2, mOutputDevice.GetIOBufferSize() * 20);
 }
 
 void    BGMPlayThrough::DeallocateBuffer()
@@ -953,6 +955,8 @@ OSStatus    BGMPlayThrough::InputDeviceIOProc(AudioObjectID           inDevice,
 {
     #pragma unused (inDevice, inNow, outOutputData, inOutputTime)
     
+    BGMRTScope("BGMPlayThrough::InputDeviceIOProc");
+    
     // refCon (reference context) is the instance that created the IOProc
     BGMPlayThrough* const refCon = static_cast<BGMPlayThrough*>(inClientData);
     
@@ -989,13 +993,18 @@ OSStatus    BGMPlayThrough::InputDeviceIOProc(AudioObjectID           inDevice,
     if(tryer.HasLock() && refCon->mBuffer)
     {
         CARingBufferError err =
-                refCon->mBuffer->Store(inInputData,
-                                       framesToStore,
-                                       static_cast<CARingBuffer::SampleTime>(
-                                               inInputTime->mSampleTime));
+                refCon->mBuffer->StoreRT(static_cast<const Float32*>(inInputData->mBuffers[0].mData),
+                                         framesToStore,
+                                         static_cast<BGM_SPSCAudioRingBuffer::SampleTime>(
+                                                 inInputTime->mSampleTime));
 #pragma clang diagnostic pop
         refCon->mRTLogger.LogIfRingBufferError_Store(err);
 
+        if(err == kCARingBufferError_CPUOverload)
+        {
+            refCon->mGlitchTelemetry.CountRT(kBGMGlitchCPUOverload);
+        }
+
         refCon->mLastInputSampleTime = inInputTime->mSampleTime;
     }
     else
@@ -1015,7 +1024,9 @@ OSStatus    BGMPlayThrough::OutputDeviceIOProc(AudioObjectID           inDevice,
                                                const AudioTimeStamp*   inOutputTime,
                                                void* __nullable        inClientData)
 {
-    #pragma unused (inDevice, inNow, inInputData, inInputTime)
+    #pragma unused (inDevice, inInputData, inInputTime)
+    
+    BGMRTScope("BGMPlayThrough::OutputDeviceIOProc");
     
     // refCon (reference context) is the instance that created the IOProc
     BGMPlayThrough* const refCon = static_cast<BGMPlayThrough*>(inClientData);
@@ -1055,6 +1066,16 @@ OSStatus    BGMPlayThrough::OutputDeviceIOProc(AudioObjectID           inDevice,
         return noErr;
     }
     
+    refCon->mGlitchTelemetry.CountCycleRT();
+    
+    // Count the cycle as late if the output device was due to start playing its audio already.
+    if((inNow->mFlags & kAudioTimeStampHostTimeValid) &&
+       (inOutputTime->mFlags & kAudioTimeStampHostTimeValid) &&
+       inNow->mHostTime > inOutputTime->mHostTime)
+    {
+        refCon->mGlitchTelemetry.CountRT(kBGMGlitchLateCycle, inNow->mHostTime);
+    }
+    
     // If this is the first time this IOProc has been called since starting playthrough...
     if(refCon->mLastOutputSampleTime == -1)
     {
@@ -1066,10 +1087,10 @@ OSStatus    BGMPlayThrough::OutputDeviceIOProc(AudioObjectID           inDevice,
                                              refCon->mLastInputSampleTime);
     }
     
-    CARingBuffer::SampleTime readHeadSampleTime =
-        static_cast<CARingBuffer::SampleTime>(inOutputTime->mSampleTime - refCon->mInToOutSampleOffset);
-    CARingBuffer::SampleTime lastInputSampleTime =
-        static_cast<CARingBuffer::SampleTime>(refCon->mLastInputSampleTime);
+    BGM_SPSCAudioRingBuffer::SampleTime readHeadSampleTime =
+        static_cast<BGM_SPSCAudioRingBuffer::SampleTime>(inOutputTime->mSampleTime - refCon->mInToOutSampleOffset);
+    BGM_SPSCAudioRingBuffer::SampleTime lastInputSampleTime =
+        static_cast<BGM_SPSCAudioRingBuffer::SampleTime>(refCon->mLastInputSampleTime);
     
     UInt32 framesToOutput = outOutputData->mBuffers[0].mDataByteSize / (SizeOf32(Float32) * 2);
 
@@ -1105,7 +1126,7 @@ OSStatus    BGMPlayThrough::OutputDeviceIOProc(AudioObjectID           inDevice,
         // The vast majority of the time, just using lastInputSampleTime as the read head time
         // instead of the one we calculate would work fine (and would also account for the above).
         SInt64 bufferStartTime, bufferEndTime;
-        CARingBufferError err = refCon->mBuffer->GetTimeBounds(bufferStartTime, bufferEndTime);
+        CARingBufferError err = refCon->mBuffer->GetTimeBoundsRT(bufferStartTime, bufferEndTime);
         bool outOfBounds = false;
 
         if(err == kCARingBufferError_OK)
@@ -1120,20 +1141,45 @@ OSStatus    BGMPlayThrough::OutputDeviceIOProc(AudioObjectID           inDevice,
                                                 readHeadSampleTime,
                                                 refCon->mInToOutSampleOffset);
 
+            // If the read head is behind the oldest audio in the buffer, the input overwrote the
+            // audio before it could be played. Otherwise, the output got ahead of the input.
+            refCon->mGlitchTelemetry.CountRT(outOfBounds && readHeadSampleTime < bufferStartTime ?
+                                             kBGMGlitchOverrun :
+                                             kBGMGlitchUnderrun);
+            refCon->mGlitchTelemetry.CountRT(kBGMGlitchResync);
+
             // Recalculate the in-to-out offset and read head.
             refCon->mInToOutSampleOffset = inOutputTime->mSampleTime - lastInputSampleTime;
-            readHeadSampleTime = static_cast<CARingBuffer::SampleTime>(
+            readHeadSampleTime = static_cast<BGM_SPSCAudioRingBuffer::SampleTime>(
                     inOutputTime->mSampleTime - refCon->mInToOutSampleOffset);
         }
 
+        refCon->mGlitchTelemetry.RecordOffsetRT(refCon->mInToOutSampleOffset);
+
         // Copy the frames from the ring buffer.
-        err = refCon->mBuffer->Fetch(outOutputData, framesToOutput, readHeadSampleTime);
+        err = refCon->mBuffer->FetchRT(static_cast<Float32*>(outOutputData->mBuffers[0].mData),
+                                       framesToOutput,
+                                       readHeadSampleTime);
         refCon->mRTLogger.LogIfRingBufferError_Fetch(err);
 
+        if(err == kCARingBufferError_CPUOverload)
+        {
+            refCon->mGlitchTelemetry.CountRT(kBGMGlitchCPUOverload);
+        }
+
         if(err != kCARingBufferError_OK)
         {
             FillWithSilence(outOutputData);
         }
+        else
+        {
+            // Only the first buffer is played through. CARingBuffer used to write silence to the
+            // others.
+            for(UInt32 i = 1; i < outOutputData->mNumberBuffers; i++)
+            {
+                memset(outOutputData->mBuffers[i].mData, 0, outOutputData->mBuffers[i].mDataByteSize);
+            }
+        }
     }
     else
     {
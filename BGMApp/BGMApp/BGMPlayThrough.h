@@ -42,10 +42,11 @@
 // Local Includes
 #include "BGMAudioDevice.h"
 #include "BGMPlayThroughRTLogger.h"
+#include "BGM_AudioRingBuffer.h"
+#include "BGM_GlitchTelemetry.h"
 
 // PublicUtility Includes
 #include "CAMutex.h"
-#include "CARingBuffer.h"
 #include "BGMThreadSafetyAnalysis.h"
 
 // STL Includes
@@ -127,6 +128,12 @@ public:
     OSStatus            Stop();
     void                StopIfIdle();
     
+    /*!
+     The underruns, overruns, resyncs and ring buffer overloads in playthrough and the output
+     IOProc's late cycles. Counted by the IOProcs. Can be read or reset from any thread.
+     */
+    BGM_GlitchTelemetry& GetGlitchTelemetry() { return mGlitchTelemetry; }
+    
 private:
     
     static OSStatus     BGMDeviceListenerProc(AudioObjectID inObjectID,
@@ -173,7 +180,8 @@ private:
                                           IOState& outNewState);
     
 private:
-    std::unique_ptr<CARingBuffer>    mBuffer PT_GUARDED_BY(mBufferInputMutex)
+    // The input IOProc stores into the buffer while the output IOProc fetches from it.
+    std::unique_ptr<BGM_SPSCAudioRingBuffer> mBuffer PT_GUARDED_BY(mBufferInputMutex)
                                         PT_GUARDED_BY(mBufferOutputMutex) { nullptr };
     
     AudioDeviceIOProcID __nullable mInputDeviceIOProcID { nullptr };
@@ -228,6 +236,8 @@ private:
     // Subtract this from the output time to get the input time.
     Float64             mInToOutSampleOffset { 0.0 };
 
+    BGM_GlitchTelemetry mGlitchTelemetry;
+
     BGMPlayThroughRTLogger mRTLogger;
 
 };
@@ -18,6 +18,7 @@
 //  BGMApp
 //
 //  Copyright © 2020 Kyle Neideck
+//  Copyright © 2026 Background Music contributors
 //
 
 // Self Include
@@ -28,15 +29,12 @@
 
 // PublicUtility Includes
 #include "CADebugMacros.h"
-
-// STL Includes
-#include <atomic>
+#include "CAException.h"
 
 // System Includes
 #include <CoreAudio/CoreAudio.h>
-#include <mach/mach_init.h>
-#include <mach/task.h>
-#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
 
 
 #pragma clang assume_nonnull begin
@@ -51,89 +49,148 @@
     #define LogSync_Debug(inFormat, ...) DebugMsg(inFormat, ## __VA_ARGS__)
 #endif
 
-#pragma mark Construction/Destruction
+// One for each IOProc and one for the threads that call BGMPlayThrough::Start.
+enum BGMPlayThroughRTEventChannel : UInt16
+{
+    kInputIOProcChannel,
+    kOutputIOProcChannel,
+    kControlChannel,
+    kChannelCount
+};
 
-BGMPlayThroughRTLogger::BGMPlayThroughRTLogger()
+enum BGMPlayThroughRTEvent : UInt16
 {
-    // Create the semaphore we use to wake up the logging thread when it has messages to log.
-    mWakeUpLoggingThreadSemaphore = CreateSemaphore();
+    kEventReleasingWaitingThreads,
+    kEventReleaseWaitingThreadsSignalError,
+    kEventDroppedFrames,
+    kEventNoSamplesReady,
+    kEventExceptionStoppingIOProc,
+    kEventExceptionStoppingIOProcUnknownError,
+    kEventUnexpectedIOStateAfterStopping,
+    kEventRingBufferNotAllocated,
+    kEventRingBufferLocked,
+    kEventRingBufferCPUOverload,
+    kEventRingBufferError,
+    kEventTypeCount
+};
+
+static const BGM_RTEventType kEventTypes[kEventTypeCount] = {
+    {
+        "BGMPlayThrough::ReleaseThreadsWaitingForOutputToStart: Releasing waiting threads",
+        kBGMRTEventSeverityDebug,
+        nullptr,
+        { nullptr, nullptr, nullptr, nullptr },
+        { kBGMRTEventArgUnused, kBGMRTEventArgUnused, kBGMRTEventArgUnused, kBGMRTEventArgUnused }
+    },
+    {
+        "BGMPlayThrough::ReleaseThreadsWaitingForOutputToStart: semaphore_signal_all returned an error",
+        kBGMRTEventSeverityError,
+        nullptr,
+        { "error", nullptr, nullptr, nullptr },
+        { kBGMRTEventArgInteger, kBGMRTEventArgUnused, kBGMRTEventArgUnused, kBGMRTEventArgUnused }
+    },
+    {
+        "BGMPlayThrough::OutputDeviceIOProc: Dropped frames before output started.",
+        kBGMRTEventSeverityDebug,
+        nullptr,
+        { "frames", "mFirstInputSampleTime", "mLastInputSampleTime", nullptr },
+        { kBGMRTEventArgFloat, kBGMRTEventArgFloat, kBGMRTEventArgFloat, kBGMRTEventArgUnused }
+    },
+    {
+        "BGMPlayThrough::OutputDeviceIOProc: No input samples ready at output sample time.",
+        kBGMRTEventSeverityDebug,
+        nullptr,
+        { "lastInputSampleTime", "readHeadSampleTime", "mInToOutSampleOffset", nullptr },
+        { kBGMRTEventArgInteger, kBGMRTEventArgInteger, kBGMRTEventArgFloat, kBGMRTEventArgUnused }
+    },
+    {
+        "BGMPlayThrough::UpdateIOProcState: Exception while stopping IOProc.",
+        kBGMRTEventSeverityError,
+        "ioProc",
+        { "error", nullptr, nullptr, nullptr },
+        { kBGMRTEventArgOSStatus, kBGMRTEventArgUnused, kBGMRTEventArgUnused, kBGMRTEventArgUnused }
+    },
+    {
+        "BGMPlayThrough::UpdateIOProcState: Exception while stopping IOProc. Error unknown.",
+        kBGMRTEventSeverityError,
+        "ioProc",
+        { nullptr, nullptr, nullptr, nullptr },
+        { kBGMRTEventArgUnused, kBGMRTEventArgUnused, kBGMRTEventArgUnused, kBGMRTEventArgUnused }
+    },
+    {
+        "BGMPlayThrough::UpdateIOProcState: IO state changed since last read.",
+        kBGMRTEventSeverityWarning,
+        "ioProc",
+        { "state", nullptr, nullptr, nullptr },
+        { kBGMRTEventArgInteger, kBGMRTEventArgUnused, kBGMRTEventArgUnused, kBGMRTEventArgUnused }
+    },
+    {
+        "BGMPlayThrough: Ring buffer unavailable. No buffer currently allocated.",
+        kBGMRTEventSeverityWarning,
+        "ioProc",
+        { nullptr, nullptr, nullptr, nullptr },
+        { kBGMRTEventArgUnused, kBGMRTEventArgUnused, kBGMRTEventArgUnused, kBGMRTEventArgUnused }
+    },
+    {
+        "BGMPlayThrough: Ring buffer unavailable. Buffer locked for allocation/deallocation by "
+            "another thread.",
+        kBGMRTEventSeverityWarning,
+        "ioProc",
+        { nullptr, nullptr, nullptr, nullptr },
+        { kBGMRTEventArgUnused, kBGMRTEventArgUnused, kBGMRTEventArgUnused, kBGMRTEventArgUnused }
+    },
+    {
+        // kCARingBufferError_CPUOverload might not be our fault, so it's only a warning.
+        "BGMPlayThrough: Ring buffer error: kCARingBufferError_CPUOverload.",
+        kBGMRTEventSeverityWarning,
+        "ioProc",
+        { "error", nullptr, nullptr, nullptr },
+        { kBGMRTEventArgInteger, kBGMRTEventArgUnused, kBGMRTEventArgUnused, kBGMRTEventArgUnused }
+    },
+    {
+        // Other types of ring buffer errors should never occur. This will crash debug builds.
+        "BGMPlayThrough: Ring buffer error.",
+        kBGMRTEventSeverityError,
+        "ioProc",
+        { "error", nullptr, nullptr, nullptr },
+        { kBGMRTEventArgInteger, kBGMRTEventArgUnused, kBGMRTEventArgUnused, kBGMRTEventArgUnused }
+    }
+};
 
-    // Create the logging thread last because it starts immediately and expects the other member
-    // variables to be initialised.
-    mLoggingThread = std::thread(&BGMPlayThroughRTLogger::LoggingThreadEntry, this);
-}
+#pragma mark Construction/Destruction
 
-// static
-semaphore_t BGMPlayThroughRTLogger::CreateSemaphore()
+BGMPlayThroughRTLogger::BGMPlayThroughRTLogger()
+:
+    mEventLog(kEventTypes,
+              kEventTypeCount,
+              kChannelCount,
+              BGM_RTEventLog::kDefaultEventsPerChannel,
+              [this] (BGMRTEventSeverity inSeverity, const char* inMessage) {
+                  LogMessage(inSeverity, inMessage);
+              })
 {
-    // TODO: Make a BGMMachSemaphore class to reduce some of this repetitive semaphore code.
-
-    // Create the semaphore.
-    semaphore_t semaphore;
-    kern_return_t error =
-            semaphore_create(mach_task_self(), &semaphore, SYNC_POLICY_FIFO, 0);
-
-    // Check the error code.
-    BGM_Utils::ThrowIfMachError("BGMPlayThroughRTLogger::CreateSemaphore",
-                                "semaphore_create",
-                                error);
-    ThrowIf(semaphore == SEMAPHORE_NULL,
-            CAException(kAudioHardwareUnspecifiedError),
-            "BGMPlayThroughRTLogger::CreateSemaphore: Failed to create semaphore");
-
-    return semaphore;
+    // Record the events to a file if asked to. This is meant for debugging glitches, so it isn't
+    // exposed anywhere else.
+    const char* theRecordingPath = getenv("BGMRTEventLogPath");
+
+    if(theRecordingPath != nullptr && theRecordingPath[0] != '\0')
+    {
+        BGMLogAndSwallowExceptions("BGMPlayThroughRTLogger::BGMPlayThroughRTLogger", [&] {
+            mEventLog.StartRecording(theRecordingPath);
+        });
+    }
 }
 
 BGMPlayThroughRTLogger::~BGMPlayThroughRTLogger()
 {
-    // Stop the logging thread.
-    mLoggingThreadShouldExit = true;
-    kern_return_t error = semaphore_signal(mWakeUpLoggingThreadSemaphore);
-
-    BGM_Utils::LogIfMachError("BGMPlayThroughRTLogger::~BGMPlayThroughRTLogger",
-                              "semaphore_signal",
-                              error);
-
-    if(error == KERN_SUCCESS)
-    {
-        // Wait for it to stop.
-        mLoggingThread.join();
-
-        // Destroy the semaphore.
-        error = semaphore_destroy(mach_task_self(), mWakeUpLoggingThreadSemaphore);
-        BGM_Utils::LogIfMachError("BGMPlayThroughRTLogger::~BGMPlayThroughRTLogger",
-                                  "semaphore_destroy",
-                                  error);
-    }
-    else
-    {
-        // If we couldn't tell it to wake up, it's not safe to wait for it to stop or to destroy the
-        // semaphore. We have to detach it so its destructor doesn't cause a crash.
-        mLoggingThread.detach();
-    }
+    // mEventLog stops its logging thread and finishes the recording, if there is one.
 }
 
 #pragma mark Log Messages
 
 void BGMPlayThroughRTLogger::LogReleasingWaitingThreads()
 {
-    if(!BGMDebugLoggingIsEnabled())
-    {
-        return;
-    }
-
-    if(!mLogReleasingWaitingThreadsMsg.is_lock_free())
-    {
-        // Modifying mLogReleasingWaitingThreadsMsg might cause the thread to lock a mutex that
-        // isn't safe to lock on a realtime thread, so just give up.
-        return;
-    }
-
-    // Set the flag that tells the logging thread to log the message.
-    mLogReleasingWaitingThreadsMsg = true;
-
-    // Wake the logging thread so it can log the message.
-    WakeLoggingThread();
+    mEventLog.LogRT(kControlChannel, kEventReleasingWaitingThreads);
 }
 
 void BGMPlayThroughRTLogger::LogIfMachError_ReleaseWaitingThreadsSignal(mach_error_t inError)
@@ -144,88 +201,73 @@ void BGMPlayThroughRTLogger::LogIfMachError_ReleaseWaitingThreadsSignal(mach_err
         return;
     }
 
-    if(!mReleaseWaitingThreadsSignalError.is_lock_free())
-    {
-        // Modifying mReleaseWaitingThreadsSignalError might cause the thread to lock a mutex that
-        // isn't safe to lock on a realtime thread, so just give up.
-        return;
-    }
-
-    mReleaseWaitingThreadsSignalError = inError;
-    WakeLoggingThread();
+    mEventLog.LogRT(kControlChannel, kEventReleaseWaitingThreadsSignalError, inError);
 }
 
 void BGMPlayThroughRTLogger::LogIfDroppedFrames(Float64 inFirstInputSampleTime,
                                                 Float64 inLastInputSampleTime)
 {
-    if(inFirstInputSampleTime == inLastInputSampleTime || !BGMDebugLoggingIsEnabled())
+    if(inFirstInputSampleTime == inLastInputSampleTime)
     {
-        // Either we didn't drop any initial frames or we don't need to log a message about it.
+        // We didn't drop any initial frames.
         return;
     }
 
-    LogAsync(mDroppedFrames, [&]()
-    {
-        // Store the data to include in the log message.
-        mDroppedFrames.firstInputSampleTime = inFirstInputSampleTime;
-        mDroppedFrames.lastInputSampleTime = inLastInputSampleTime;
-    });
+    mEventLog.LogRT(kOutputIOProcChannel,
+                    kEventDroppedFrames,
+                    inLastInputSampleTime - inFirstInputSampleTime,
+                    inFirstInputSampleTime,
+                    inLastInputSampleTime);
 }
 
 void BGMPlayThroughRTLogger::LogNoSamplesReady(CARingBuffer::SampleTime inLastInputSampleTime,
                                                CARingBuffer::SampleTime inReadHeadSampleTime,
                                                Float64 inInToOutSampleOffset)
 {
-    if(!BGMDebugLoggingIsEnabled())
-    {
-        return;
-    }
-
-    LogAsync(mNoSamplesReady, [&]()
-    {
-        // Store the data to include in the log message.
-        mNoSamplesReady.lastInputSampleTime = inLastInputSampleTime;
-        mNoSamplesReady.readHeadSampleTime = inReadHeadSampleTime;
-        mNoSamplesReady.inToOutSampleOffset = inInToOutSampleOffset;
-    });
+    mEventLog.LogRT(kOutputIOProcChannel,
+                    kEventNoSamplesReady,
+                    inLastInputSampleTime,
+                    inReadHeadSampleTime,
+                    inInToOutSampleOffset);
 }
 
 void BGMPlayThroughRTLogger::LogExceptionStoppingIOProc(const char* inCallerName,
                                                         OSStatus inError,
                                                         bool inErrorKnown)
 {
-    LogAsync(mExceptionStoppingIOProc, [&]()
+    if(inErrorKnown)
     {
-        // Store the data to include in the log message.
-        mExceptionStoppingIOProc.callerName = inCallerName;
-        mExceptionStoppingIOProc.error = inError;
-        mExceptionStoppingIOProc.errorKnown = inErrorKnown;
-    });
+        mEventLog.LogDetailRT(GetChannel(inCallerName),
+                              kEventExceptionStoppingIOProc,
+                              inCallerName,
+                              inError);
+    }
+    else
+    {
+        mEventLog.LogDetailRT(GetChannel(inCallerName),
+                              kEventExceptionStoppingIOProcUnknownError,
+                              inCallerName);
+    }
 }
 
 void BGMPlayThroughRTLogger::LogUnexpectedIOStateAfterStopping(const char* inCallerName,
                                                                int inIOState)
 {
-    LogAsync(mUnexpectedIOStateAfterStopping, [&]()
-    {
-        // Store the data to include in the log message.
-        mUnexpectedIOStateAfterStopping.callerName = inCallerName;
-        mUnexpectedIOStateAfterStopping.ioState = inIOState;
-    });
+    mEventLog.LogDetailRT(GetChannel(inCallerName),
+                          kEventUnexpectedIOStateAfterStopping,
+                          inCallerName,
+                          inIOState);
 }
 
 void BGMPlayThroughRTLogger::LogRingBufferUnavailable(const char* inCallerName, bool inGotLock)
 {
-    LogAsync(mRingBufferUnavailable, [&]()
-    {
-        // Store the data to include in the log message.
-        mRingBufferUnavailable.callerName = inCallerName;
-        mRingBufferUnavailable.gotLock = inGotLock;
-    });
+    mEventLog.LogDetailRT(GetChannel(inCallerName),
+                          inGotLock ? kEventRingBufferNotAllocated : kEventRingBufferLocked,
+                          inCallerName);
 }
 
 void BGMPlayThroughRTLogger::LogIfRingBufferError(CARingBufferError inError,
-                                                  std::atomic<CARingBufferError>& outError)
+                                                  const char* inCallerName)
 {
     if(inError == kCARingBufferError_OK)
     {
@@ -233,48 +275,41 @@ void BGMPlayThroughRTLogger::LogIfRingBufferError(CARingBufferError inError,
         return;
     }
 
-    if(!outError.is_lock_free())
-    {
-        // Modifying outError might cause the thread to lock a mutex that isn't safe to lock on
-        // a realtime thread, so just give up.
-        return;
-    }
-
-    // Store the error.
-    outError = inError;
-
-    // Wake the logging thread so it can log the error.
-    WakeLoggingThread();
+    mEventLog.LogDetailRT(GetChannel(inCallerName),
+                          (inError == kCARingBufferError_CPUOverload) ?
+                                  kEventRingBufferCPUOverload :
+                                  kEventRingBufferError,
+                          inCallerName,
+                          inError);
 }
 
-template <typename T, typename F>
-void BGMPlayThroughRTLogger::LogAsync(T& inMessageData, F&& inStoreMessageData)
+// static
+UInt16 BGMPlayThroughRTLogger::GetChannel(const char* inCallerName)
 {
-    if(!inMessageData.shouldLogMessage.is_lock_free())
-    {
-        // Modifying shouldLogMessage might cause the thread to lock a mutex that isn't safe to
-        // lock on a realtime thread, so just give up.
-        return;
-    }
+    // Only the IOProcs call the methods that take a caller name.
+    return (strcmp(inCallerName, "InputDeviceIOProc") == 0) ?
+            kInputIOProcChannel :
+            kOutputIOProcChannel;
+}
 
-    if(inMessageData.shouldLogMessage)
-    {
-        // The logging thread could be reading inMessageData.
-        return;
-    }
+#pragma mark Logging Thread
 
-    // Store the data to include in the log message.
-    //
-    // std::forward lets the compiler treat inStoreMessageData as an rvalue if the caller gave it as
-    // an rvalue. No idea if that actually does anything.
-    std::forward<F>(inStoreMessageData)();
+void BGMPlayThroughRTLogger::LogMessage(BGMRTEventSeverity inSeverity, const char* inMessage)
+{
+    switch(inSeverity)
+    {
+        case kBGMRTEventSeverityDebug:
+            LogSync_Debug("%s", inMessage);
+            break;
 
-    // shouldLogMessage is a std::atomic, so this store also makes sure that the non-atomic stores
-    // in inStoreMessageData will be visible to the logger thread (since the default memory order is
-    // memory_order_seq_cst).
-    inMessageData.shouldLogMessage = true;
+        case kBGMRTEventSeverityWarning:
+            LogSync_Warning("%s", inMessage);
+            break;
 
-    WakeLoggingThread();
+        default:
+            LogSync_Error("%s", inMessage);
+            break;
+    }
 }
 
 void BGMPlayThroughRTLogger::LogSync_Warning(const char* inFormat, ...)
@@ -310,209 +345,14 @@ void BGMPlayThroughRTLogger::LogSync_Error(const char* inFormat, ...)
     va_end(args);
 }
 
-#pragma mark Logging Thread
-
-void BGMPlayThroughRTLogger::WakeLoggingThread()
-{
-    kern_return_t error = semaphore_signal(mWakeUpLoggingThreadSemaphore);
-
-    BGMAssert(error == KERN_SUCCESS, "semaphore_signal (%d)", error);
-
-    // We can't do anything useful with the error in release builds. At least, not easily.
-    (void)error;
-}
-
-void BGMPlayThroughRTLogger::LogMessages()
-{
-    // Log the messages/errors from the realtime threads (if any).
-    LogSync_ReleasingWaitingThreads();
-    LogSync_ReleaseWaitingThreadsSignalError();
-    LogSync_DroppedFrames();
-    LogSync_NoSamplesReady();
-    LogSync_ExceptionStoppingIOProc();
-    LogSync_UnexpectedIOStateAfterStopping();
-    LogSync_RingBufferUnavailable();
-    LogSync_RingBufferError(mRingBufferStoreError, "InputDeviceIOProc");
-    LogSync_RingBufferError(mRingBufferFetchError, "OutputDeviceIOProc");
-}
-
-void BGMPlayThroughRTLogger::LogSync_ReleasingWaitingThreads()
-{
-    if(mLogReleasingWaitingThreadsMsg)
-    {
-        LogSync_Debug("BGMPlayThrough::ReleaseThreadsWaitingForOutputToStart: "
-                      "Releasing waiting threads");
-        // Reset it.
-        mLogReleasingWaitingThreadsMsg = false;
-    }
-}
-
-void BGMPlayThroughRTLogger::LogSync_ReleaseWaitingThreadsSignalError()
-{
-    if(mReleaseWaitingThreadsSignalError != KERN_SUCCESS)
-    {
-        BGM_Utils::LogIfMachError("BGMPlayThrough::ReleaseThreadsWaitingForOutputToStart",
-                                  "semaphore_signal_all",
-                                  mReleaseWaitingThreadsSignalError);
-        // Reset it.
-        mReleaseWaitingThreadsSignalError = KERN_SUCCESS;
-    }
-}
-
-void BGMPlayThroughRTLogger::LogSync_DroppedFrames()
-{
-    if(mDroppedFrames.shouldLogMessage)
-    {
-        LogSync_Debug("BGMPlayThrough::OutputDeviceIOProc: "
-                      "Dropped %f frames before output started. %s%f %s%f",
-                      (mDroppedFrames.lastInputSampleTime - mDroppedFrames.firstInputSampleTime),
-                      "mFirstInputSampleTime=",
-                      mDroppedFrames.firstInputSampleTime,
-                      "mLastInputSampleTime=",
-                      mDroppedFrames.lastInputSampleTime);
-        mDroppedFrames.shouldLogMessage = false;
-    }
-}
-
-void BGMPlayThroughRTLogger::LogSync_NoSamplesReady()
-{
-    if(mNoSamplesReady.shouldLogMessage)
-    {
-        LogSync_Debug("BGMPlayThrough::OutputDeviceIOProc: "
-                      "No input samples ready at output sample time. %s%lld %s%lld %s%f",
-                      "lastInputSampleTime=", mNoSamplesReady.lastInputSampleTime,
-                      "readHeadSampleTime=", mNoSamplesReady.readHeadSampleTime,
-                      "mInToOutSampleOffset=", mNoSamplesReady.inToOutSampleOffset);
-        mNoSamplesReady.shouldLogMessage = false;
-    }
-}
-
-void BGMPlayThroughRTLogger::LogSync_ExceptionStoppingIOProc()
-{
-    if(mExceptionStoppingIOProc.shouldLogMessage)
-    {
-        const char error4CC[5] = CA4CCToCString(mExceptionStoppingIOProc.error);
-        LogSync_Error("BGMPlayThrough::UpdateIOProcState: "
-                      "Exception while stopping IOProc %s: %s (%d)",
-                      mExceptionStoppingIOProc.callerName,
-                      mExceptionStoppingIOProc.errorKnown ? error4CC : "unknown",
-                      mExceptionStoppingIOProc.error);
-        mExceptionStoppingIOProc.shouldLogMessage = false;
-    }
-}
-
-void BGMPlayThroughRTLogger::LogSync_UnexpectedIOStateAfterStopping()
-{
-    if(mUnexpectedIOStateAfterStopping.shouldLogMessage)
-    {
-        LogSync_Warning("BGMPlayThrough::UpdateIOProcState: "
-                        "%s IO state changed since last read. state = %d",
-                        mUnexpectedIOStateAfterStopping.callerName,
-                        mUnexpectedIOStateAfterStopping.ioState);
-        mUnexpectedIOStateAfterStopping.shouldLogMessage = false;
-    }
-}
-
-void BGMPlayThroughRTLogger::LogSync_RingBufferUnavailable()
-{
-    if(mRingBufferUnavailable.shouldLogMessage)
-    {
-        LogSync_Warning("BGMPlayThrough::%s: Ring buffer unavailable. %s",
-                        mRingBufferUnavailable.callerName,
-                        mRingBufferUnavailable.gotLock ?
-                            "No buffer currently allocated." :
-                            "Buffer locked for allocation/deallocation by another thread.");
-        mRingBufferUnavailable.shouldLogMessage = false;
-    }
-}
-
-void BGMPlayThroughRTLogger::LogSync_RingBufferError(
-        std::atomic<CARingBufferError>& ioRingBufferError,
-        const char* inMethodName)
-{
-    CARingBufferError error = ioRingBufferError;
-
-    switch(error)
-    {
-        case kCARingBufferError_OK:
-            // No error.
-            return;
-        case kCARingBufferError_CPUOverload:
-            // kCARingBufferError_CPUOverload might not be our fault, so just log a warning.
-            LogSync_Warning("BGMPlayThrough::%s: Ring buffer error: "
-                            "kCARingBufferError_CPUOverload (%d)",
-                            inMethodName,
-                            error);
-            break;
-        default:
-            // Other types of CARingBuffer errors should never occur. This will crash debug builds.
-            LogSync_Error("BGMPlayThrough::%s: Ring buffer error: %s (%d)",
-                          inMethodName,
-                          (error == kCARingBufferError_TooMuch ?
-                                  "kCARingBufferError_TooMuch" :
-                                  "unknown error"),
-                          error);
-            break;
-    };
-
-    // Reset it.
-    ioRingBufferError = kCARingBufferError_OK;
-}
-
-// static
-void* __nullable BGMPlayThroughRTLogger::LoggingThreadEntry(BGMPlayThroughRTLogger* inRefCon)
-{
-    DebugMsg("BGMPlayThroughRTLogger::IOProcLoggingThreadEntry: "
-             "Starting the IOProc logging thread");
-
-    while(!inRefCon->mLoggingThreadShouldExit)
-    {
-        // Log the messages, if there are any to log.
-        inRefCon->LogMessages();
-
-        // Wait until woken up.
-        kern_return_t error = semaphore_wait(inRefCon->mWakeUpLoggingThreadSemaphore);
-        BGM_Utils::LogIfMachError("BGMPlayThroughRTLogger::IOProcLoggingThreadEntry",
-                                  "semaphore_wait",
-                                  error);
-    }
-
-    DebugMsg("BGMPlayThroughRTLogger::IOProcLoggingThreadEntry: IOProc logging thread exiting");
-
-    return nullptr;
-}
-
 #if BGM_UnitTest
 
 #pragma mark Test Helpers
 
 bool BGMPlayThroughRTLogger::WaitUntilLoggerThreadIdle()
 {
-    int msWaited = 0;
-
-    while(mLogReleasingWaitingThreadsMsg ||
-            mReleaseWaitingThreadsSignalError != KERN_SUCCESS ||
-            mDroppedFrames.shouldLogMessage ||
-            mNoSamplesReady.shouldLogMessage ||
-            mUnexpectedIOStateAfterStopping.shouldLogMessage ||
-            mRingBufferUnavailable.shouldLogMessage ||
-            mExceptionStoppingIOProc.shouldLogMessage ||
-            mRingBufferStoreError != kCARingBufferError_OK ||
-            mRingBufferFetchError != kCARingBufferError_OK)
-    {
-        // Poll until the logger thread has nothing left to log. (Ideally we'd use a semaphore
-        // instead of polling, but it isn't worth the effort at this point.)
-        usleep(10 * 1000);
-        msWaited += 10;
-
-        // Time out after 5 seconds.
-        if(msWaited > 5000)
-        {
-            return false;
-        }
-    }
-
-    return true;
+    // Time out after 5 seconds.
+    return mEventLog.WaitUntilDrained(5000);
 }
 
 #endif /* BGM_UnitTest */
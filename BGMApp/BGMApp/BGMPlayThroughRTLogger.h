@@ -23,9 +23,12 @@
 //  non-realtime thread.
 //
 //  For the sake of simplicity, this class is very closely coupled with BGMPlayThrough and its
-//  methods make assumptions about where they will be called. Also, if the same logging method is
-//  called multiple times before the logging thread next checks for messages, it will only log the
-//  message for one of those calls and ignore the others.
+//  methods make assumptions about where they will be called. Each message is logged as an event in
+//  a BGM_RTEventLog, on the channel for the thread that's expected to call its method, so every call
+//  is kept, with its timing, up to the size of the channel. (It used to have a slot for each type of
+//  message, so a burst of them was logged as one message.) If BGMApp is started with
+//  BGMRTEventLogPath set in its environment, the events are also recorded to that file. See
+//  bgm-rt-event-decode in BGMDriver/Tools.
 //
 //  This class's methods are real-time safe in that they return in a bounded amount of time and we
 //  think they're probably fast enough that the callers won't miss their deadlines, but we don't try
@@ -36,15 +39,14 @@
 #ifndef BGMApp__BGMPlayThroughRTLogger
 #define BGMApp__BGMPlayThroughRTLogger
 
+// Local Includes
+#include "BGM_RTEventLog.h"
+
 // PublicUtility Includes
 #include "CARingBuffer.h"
 
-// STL Includes
-#include <thread>
-
 // System Includes
 #include <mach/error.h>
-#include <mach/semaphore.h>
 
 
 #pragma clang assume_nonnull begin
@@ -60,8 +62,6 @@ public:
                             BGMPlayThroughRTLogger(const BGMPlayThroughRTLogger&) = delete;
                             BGMPlayThroughRTLogger& operator=(
                                     const BGMPlayThroughRTLogger&) = delete;
-private:
-    static semaphore_t      CreateSemaphore();
 
 #pragma mark Log Messages
 
@@ -104,44 +104,28 @@ public:
     /*! For BGMPlayThrough::OutputDeviceIOProc. */
     void                    LogIfRingBufferError_Fetch(CARingBufferError inError)
                             {
-                                LogIfRingBufferError(inError, mRingBufferFetchError);
+                                LogIfRingBufferError(inError, "OutputDeviceIOProc");
                             }
     /*! For BGMPlayThrough::InputDeviceIOProc. */
     void                    LogIfRingBufferError_Store(CARingBufferError inError)
                             {
-                                LogIfRingBufferError(inError, mRingBufferStoreError);
+                                LogIfRingBufferError(inError, "InputDeviceIOProc");
                             }
 
 private:
-    void                    LogIfRingBufferError(CARingBufferError inError,
-                                                 std::atomic<CARingBufferError>& outError);
+    void                    LogIfRingBufferError(CARingBufferError inError, const char* inCallerName);
 
-    template <typename T, typename F>
-    void                    LogAsync(T& inMessageData, F&& inStoreMessageData);
-
-    // Wrapper methods used to mock out the logging for unit tests.
-    void                    LogSync_Warning(const char* inFormat, ...) __printflike(2, 3);
-    void                    LogSync_Error(const char* inFormat, ...) __printflike(2, 3);
+    /*! The channel of the IOProc named inCallerName. */
+    static UInt16           GetChannel(const char* inCallerName);
 
 #pragma mark Logging Thread
 
 private:
-    void                    WakeLoggingThread();
-
-    void                    LogMessages();
-    void                    LogSync_ReleasingWaitingThreads();
-    void                    LogSync_ReleaseWaitingThreadsSignalError();
-    void                    LogSync_DroppedFrames();
-    void                    LogSync_NoSamplesReady();
-    void                    LogSync_ExceptionStoppingIOProc();
-    void                    LogSync_UnexpectedIOStateAfterStopping();
-    void                    LogSync_RingBufferUnavailable();
-    void                    LogSync_RingBufferError(
-                                std::atomic<CARingBufferError>& ioRingBufferError,
-                                const char* inMethodName);
-
-    // The entry point of the logging thread (mLoggingThread).
-    static void* __nullable LoggingThreadEntry(BGMPlayThroughRTLogger* inRefCon);
+    void                    LogMessage(BGMRTEventSeverity inSeverity, const char* inMessage);
+
+    // Wrapper methods used to mock out the logging for unit tests.
+    void                    LogSync_Warning(const char* inFormat, ...) __printflike(2, 3);
+    void                    LogSync_Error(const char* inFormat, ...) __printflike(2, 3);
 
 #if BGM_UnitTest
 
@@ -154,61 +138,6 @@ public:
      */
     bool                    WaitUntilLoggerThreadIdle();
 
-#endif /* BGM_UnitTest */
-
-private:
-    // For BGMPlayThrough::ReleaseThreadsWaitingForOutputToStart
-    std::atomic<bool>       mLogReleasingWaitingThreadsMsg { false };
-    std::atomic<kern_return_t> mReleaseWaitingThreadsSignalError { KERN_SUCCESS };
-
-    // For BGMPlayThrough::InputDeviceIOProc and BGMPlayThrough::OutputDeviceIOProc
-    struct {
-        Float64 firstInputSampleTime;
-        Float64 lastInputSampleTime;
-        std::atomic<bool> shouldLogMessage { false };
-    } mDroppedFrames;
-
-    struct {
-        CARingBuffer::SampleTime lastInputSampleTime;
-        CARingBuffer::SampleTime readHeadSampleTime;
-        Float64 inToOutSampleOffset;
-        std::atomic<bool> shouldLogMessage { false };
-    } mNoSamplesReady;
-
-    struct {
-        const char* callerName;
-        bool gotLock;
-        std::atomic<bool> shouldLogMessage { false };
-    } mRingBufferUnavailable;
-
-    // For BGMPlayThrough::UpdateIOProcState
-    struct {
-        const char* callerName;
-        int ioState;
-        std::atomic<bool> shouldLogMessage { false };
-    } mUnexpectedIOStateAfterStopping;
-
-    struct {
-        const char* callerName;
-        OSStatus error;
-        bool errorKnown;  // If false, we didn't get an error code from the exception.
-        std::atomic<bool> shouldLogMessage { false };
-    } mExceptionStoppingIOProc;
-
-    // For BGMPlayThrough::OutputDeviceIOProc
-    std::atomic<CARingBufferError> mRingBufferStoreError { kCARingBufferError_OK };
-    // For BGMPlayThrough::InputDeviceIOProc.
-    std::atomic<CARingBufferError> mRingBufferFetchError { kCARingBufferError_OK };
-
-    // Signalled to wake up the mLoggingThread when it has messages to log.
-    semaphore_t             mWakeUpLoggingThreadSemaphore;
-    std::atomic<bool>       mLoggingThreadShouldExit { false };
-    // The thread that actually logs the messages.
-    std::thread             mLoggingThread;
-
-#if BGM_UnitTest
-
-public:
     // Tests normally crash (abort) if LogError is called. This flag lets us test the code that
     // would otherwise call LogError.
     bool                    mContinueOnErrorLogged { false };
@@ -219,6 +148,10 @@ public:
 
 #endif /* BGM_UnitTest */
 
+private:
+    // Declared last so it's destroyed, which stops its logging thread, first.
+    BGM_RTEventLog          mEventLog;
+
 };
 
 #pragma clang assume_nonnull end
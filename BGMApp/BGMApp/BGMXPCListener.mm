@@ -235,6 +235,10 @@
                           userInfo:@{ NSLocalizedDescriptionKey: description }]);
 }
 
+- (void) playThroughGlitchTelemetryResetting:(BOOL)reset withReply:(void (^)(NSDictionary*))reply {
+    reply([audioDevices playThroughGlitchTelemetryResetting:reset]);
+}
+
 @end
 
 #pragma clang assume_nonnull end
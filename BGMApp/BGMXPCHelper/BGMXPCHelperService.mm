@@ -243,6 +243,22 @@ static NSXPCConnection* __nullable sBGMAppConnection = nil;
     reply(replyToBGMDriver);
 }
 
+- (void) bgmAppPlayThroughGlitchTelemetryResetting:(BOOL)reset
+                                         withReply:(void (^)(NSDictionary* __nullable telemetry,
+                                                             NSError* __nullable error))reply {
+    // Pass the message along to BGMApp. Unlike startBGMAppPlayThroughSyncWithReply, nothing is
+    // waiting on this, so it doesn't need to block.
+    [BGMXPCHelperService withBGMAppRemoteProxy:^(id remoteObjectProxy) {
+        [remoteObjectProxy playThroughGlitchTelemetryResetting:reset withReply:^(NSDictionary* telemetry) {
+            reply(telemetry, nil);
+        }];
+    } errorHandler:^(NSError* error) {
+        reply(nil, [BGMXPCHelperService errorWithCode:kBGMXPC_MessageFailure
+                                          description:[error localizedDescription]
+                                      underlyingError:error]);
+    }];
+}
+
 - (void) setOutputDeviceToMakeDefaultOnAbnormalTermination:(AudioObjectID)deviceID {
     outputDeviceToMakeDefaultOnAbnormalTermination = deviceID;
     DebugMsg("BGMXPCHelperService::setOutputDeviceToMakeDefaultOnAbnormalTermination: ID set to %u",
@@ -62,6 +62,7 @@ void    BGM_AudibleState::Reset() noexcept
 }
 
 void    BGM_AudibleState::UpdateWithClientIO(bool inClientIsMusicPlayer,
+                                             bool inClientAudioIsSustained,
                                              UInt32 inIOBufferFrameSize,
                                              Float64 inOutputSampleTime,
                                              const Float32* inBuffer)
@@ -84,7 +85,8 @@ void    BGM_AudibleState::UpdateWithClientIO(bool inClientIsMusicPlayer,
                                                       endFrameSampleTime);
         }
     }
-    else if(endFrameSampleTime > mSampleTimes.latestAudibleNonMusic &&  // Don't bother checking the
+    else if(inClientAudioIsSustained &&  // Short sounds don't count.
+            endFrameSampleTime > mSampleTimes.latestAudibleNonMusic &&  // Don't bother checking the
                                                                         // buffer if it won't change
                                                                         // anything.
             BufferIsAudible(inIOBufferFrameSize, inBuffer))
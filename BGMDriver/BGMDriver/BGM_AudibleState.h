@@ -60,9 +60,14 @@ public:
      the audible state. The update will only affect the return value of GetState after the next
      call to UpdateWithMixedIO, when all IO for the cycle has been read.
 
+     inClientAudioIsSustained should be false if the client's audio is only a short sound, e.g. a
+     notification, so it doesn't make the device audible. (See BGM_SignalClassifier.) It's ignored
+     for the music player.
+
      Real-time safe. Not thread safe.
      */
     void                        UpdateWithClientIO(bool inClientIsMusicPlayer,
+                                                   bool inClientAudioIsSustained,
                                                    UInt32 inIOBufferFrameSize,
                                                    Float64 inOutputSampleTime,
                                                    const Float32* inBuffer);
@@ -0,0 +1,105 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_Crossfader.cpp
+//  BGMDriver
+//
+//  Copyright © 2026 Background Music contributors
+//
+
+// Self Include
+#include "BGM_Crossfader.h"
+
+// STL Includes
+#include <algorithm>
+#include <cmath>
+
+
+#pragma clang assume_nonnull begin
+
+BGM_Crossfader::Side    BGM_Crossfader::GetSide(const CACFString& inBundleID) const
+{
+    if(!inBundleID.IsValid())
+    {
+        return kSideNone;
+    }
+
+    if(mGroupA.count(inBundleID) != 0)
+    {
+        return kSideA;
+    }
+
+    if(mGroupB.count(inBundleID) != 0)
+    {
+        return kSideB;
+    }
+
+    return kSideNone;
+}
+
+Float32 BGM_Crossfader::GetGain(Side inSide) const
+{
+    if(inSide == kSideNone)
+    {
+        return 1.0f;
+    }
+
+    Float32 theGainA;
+    Float32 theGainB;
+    CalculateGains(mCurve, mPosition, theGainA, theGainB);
+
+    return (inSide == kSideA) ? theGainA : theGainB;
+}
+
+void    BGM_Crossfader::CalculateGains(BGMCrossfaderCurve inCurve,
+                                       Float32 inPosition,
+                                       Float32& outGainA,
+                                       Float32& outGainB)
+{
+    Float32 thePosition = std::min(1.0f, std::max(-1.0f, inPosition));
+
+    // How far the position is from group A's end to group B's end, from 0.0 to 1.0.
+    Float32 theFraction = (thePosition + 1.0f) / 2.0f;
+
+    switch(inCurve)
+    {
+        case kBGMCrossfaderCurveLinear:
+            outGainA = 1.0f - theFraction;
+            outGainB = theFraction;
+            break;
+
+        case kBGMCrossfaderCurveCut:
+            outGainA = std::min(1.0f, 1.0f - thePosition);
+            outGainB = std::min(1.0f, 1.0f + thePosition);
+            break;
+
+        case kBGMCrossfaderCurveEqualPower:
+        default:
+        {
+            Float32 theAngle = theFraction * static_cast<Float32>(M_PI_2);
+
+            // cosf(pi/2) is very slightly negative in single precision, so clamp the gains to
+            // keep the ends silent.
+            outGainA = std::max(0.0f, std::cos(theAngle));
+            outGainB = std::max(0.0f, std::sin(theAngle));
+        }
+            break;
+    }
+}
+
+#pragma clang assume_nonnull end
+
@@ -0,0 +1,93 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_Crossfader.h
+//  BGMDriver
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  The settings of BGMDevice's crossfader, which fades between two groups of apps, and the gains
+//  they give each group. See kAudioDeviceCustomPropertyCrossfader.
+//
+//  BGM_Clients applies the gains to the audio of each client in the groups with a BGM_GainRamp, so
+//  the fades are smooth however often the position is updated.
+//
+
+#ifndef BGMDriver__BGM_Crossfader
+#define BGMDriver__BGM_Crossfader
+
+// Local Includes
+#include "BGM_Types.h"
+
+// PublicUtility Includes
+#include "CACFString.h"
+
+// STL Includes
+#include <set>
+
+
+#pragma clang assume_nonnull begin
+
+struct BGM_Crossfader
+{
+    enum Side
+    {
+        kSideNone,
+        kSideA,
+        kSideB
+    };
+
+    std::set<CACFString>    mGroupA;
+    std::set<CACFString>    mGroupB;
+    Float32                 mPosition = 0.0f;
+    BGMCrossfaderCurve      mCurve = kBGMCrossfaderCurveEqualPower;
+
+    /*! @return The group the app with the given bundle ID is in, if any. */
+    Side                    GetSide(const CACFString& inBundleID) const;
+
+    /*! @return The gain for the apps on inSide at the current position. 1.0 for kSideNone. */
+    Float32                 GetGain(Side inSide) const;
+
+    /*!
+     Calculate the gains a crossfader gives its two groups.
+
+     @param inCurve The crossfader's curve. Unknown curves are treated as
+                    kBGMCrossfaderCurveEqualPower.
+     @param inPosition The crossfader's position, from -1.0 (only group A) to 1.0 (only group B).
+                       Clamped to that range.
+     @param outGainA The gain for group A, from 0.0 to 1.0.
+     @param outGainB The gain for group B, from 0.0 to 1.0.
+     */
+    static void             CalculateGains(BGMCrossfaderCurve inCurve,
+                                           Float32 inPosition,
+                                           Float32& outGainA,
+                                           Float32& outGainB);
+
+    bool operator==(const BGM_Crossfader& other) const {
+        return mGroupA == other.mGroupA &&
+               mGroupB == other.mGroupB &&
+               mPosition == other.mPosition &&
+               mCurve == other.mCurve;
+    }
+
+    bool operator!=(const BGM_Crossfader& other) const { return !(*this == other); }
+};
+
+#pragma clang assume_nonnull end
+
+#endif /* BGMDriver__BGM_Crossfader */
+
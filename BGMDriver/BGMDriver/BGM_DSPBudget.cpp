@@ -0,0 +1,183 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_DSPBudget.cpp
+//  BGMDriver
+//
+//  Copyright © 2026 Background Music contributors
+//
+
+// Self Include
+#include "BGM_DSPBudget.h"
+
+// PublicUtility Includes
+#include "CAHostTimeBase.h"
+
+
+#pragma clang assume_nonnull begin
+
+constexpr Float64 BGM_DSPBudget::kInCycleLoads[];
+constexpr Float64 BGM_DSPBudget::kRaiseLoad;
+constexpr Float64 BGM_DSPBudget::kLowerLoad;
+constexpr Float64 BGM_DSPBudget::kRecoverySecs;
+
+BGM_DSPBudget::BGM_DSPBudget()
+:
+    mSampleRate(44100.0),
+    mHostTicksPerSecond(CAHostTimeBase::GetFrequency()),
+    mClock(&BGM_DSPBudget::GetHostClockTime),
+    mClockRefCon(nullptr),
+    mInCycle(false),
+    mCycleOutputSampleTime(0.0),
+    mCycleStartHostTime(0),
+    mCycleBudgetHostTicks(0.0),
+    mSustainedLevel(kShedNothing),
+    mLastCycleLoad(0.0),
+    mSecsUnderLowerLoad(0.0)
+{
+}
+
+void    BGM_DSPBudget::SetSampleRate(Float64 inSampleRate)
+{
+    mSampleRate.store(inSampleRate, std::memory_order_relaxed);
+}
+
+void    BGM_DSPBudget::SetClock(Clock _Nullable inClock, void* _Nullable inRefCon)
+{
+    mClock = (inClock != nullptr) ? inClock : &BGM_DSPBudget::GetHostClockTime;
+    mClockRefCon = inRefCon;
+}
+
+// static
+UInt64  BGM_DSPBudget::GetHostClockTime(void* _Nullable inRefCon)
+{
+    (void)inRefCon;
+    return CAHostTimeBase::GetTheCurrentTime();
+}
+
+void    BGM_DSPBudget::Reset()
+{
+    mInCycle = false;
+    mSustainedLevel.store(kShedNothing, std::memory_order_relaxed);
+    mLastCycleLoad.store(0.0, std::memory_order_relaxed);
+    mSecsUnderLowerLoad = 0.0;
+}
+
+void    BGM_DSPBudget::BeginOperationRT(UInt32 inIOBufferFrameSize,
+                                        const AudioTimeStamp& inOutputTime)
+{
+    if(mInCycle && inOutputTime.mSampleTime == mCycleOutputSampleTime)
+    {
+        return;
+    }
+
+    mInCycle = true;
+    mCycleOutputSampleTime = inOutputTime.mSampleTime;
+    mCycleBudgetHostTicks =
+            inIOBufferFrameSize / mSampleRate.load(std::memory_order_relaxed) * mHostTicksPerSecond;
+
+    const UInt64 theBudgetHostTicks = static_cast<UInt64>(mCycleBudgetHostTicks);
+
+    if((inOutputTime.mFlags & kAudioTimeStampHostTimeValid) &&
+       inOutputTime.mHostTime > theBudgetHostTicks)
+    {
+        // Time the cycle against its deadline, so the time before the HAL started it counts too.
+        mCycleStartHostTime = inOutputTime.mHostTime - theBudgetHostTicks;
+    }
+    else
+    {
+        mCycleStartHostTime = mClock(mClockRefCon);
+    }
+}
+
+BGM_DSPBudget::ShedLevel    BGM_DSPBudget::GetShedLevelRT() const
+{
+    ShedLevel theLevel = mSustainedLevel.load(std::memory_order_relaxed);
+
+    if(!mInCycle || mCycleBudgetHostTicks <= 0.0)
+    {
+        return theLevel;
+    }
+
+    const UInt64 theHostTime = mClock(mClockRefCon);
+
+    if(theHostTime < mCycleStartHostTime)
+    {
+        return theLevel;
+    }
+
+    const Float64 theLoad = (theHostTime - mCycleStartHostTime) / mCycleBudgetHostTicks;
+
+    // Find the highest level the load has reached in this cycle.
+    for(UInt32 theInCycleLevel = kShedLevelCount - 1; theInCycleLevel > theLevel; theInCycleLevel--)
+    {
+        if(theLoad >= kInCycleLoads[theInCycleLevel])
+        {
+            return static_cast<ShedLevel>(theInCycleLevel);
+        }
+    }
+
+    return theLevel;
+}
+
+void    BGM_DSPBudget::EndCycleRT()
+{
+    if(!mInCycle || mCycleBudgetHostTicks <= 0.0)
+    {
+        mInCycle = false;
+        return;
+    }
+
+    mInCycle = false;
+
+    const UInt64 theHostTime = mClock(mClockRefCon);
+    const Float64 theLoad = (theHostTime >= mCycleStartHostTime) ?
+            (theHostTime - mCycleStartHostTime) / mCycleBudgetHostTicks :
+            0.0;
+    mLastCycleLoad.store(theLoad, std::memory_order_relaxed);
+
+    const UInt32 theLevel = mSustainedLevel.load(std::memory_order_relaxed);
+
+    if(theLoad > kRaiseLoad)
+    {
+        // Shed more, starting with the next cycle.
+        mSecsUnderLowerLoad = 0.0;
+
+        if(theLevel + 1 < kShedLevelCount)
+        {
+            mSustainedLevel.store(static_cast<ShedLevel>(theLevel + 1), std::memory_order_relaxed);
+        }
+    }
+    else if(theLoad < kLowerLoad)
+    {
+        // Only shed less once the load has been low for a while, so a level doesn't flap on and off.
+        mSecsUnderLowerLoad += mCycleBudgetHostTicks / mHostTicksPerSecond;
+
+        if(theLevel > kShedNothing && mSecsUnderLowerLoad >= kRecoverySecs)
+        {
+            mSustainedLevel.store(static_cast<ShedLevel>(theLevel - 1), std::memory_order_relaxed);
+            mSecsUnderLowerLoad = 0.0;
+        }
+    }
+    else
+    {
+        mSecsUnderLowerLoad = 0.0;
+    }
+}
+
+#pragma clang assume_nonnull end
+
@@ -0,0 +1,162 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_DSPBudget.h
+//  BGMDriver
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  Tracks how much of each IO cycle's time BGM_IOPipeline has used, so it can skip optional
+//  per-client processing when the cycle is close to its deadline instead of overloading the device.
+//
+//  The budget for a cycle is the length of its buffer, i.e. the buffer size divided by the sample
+//  rate, and it ends at the cycle's deadline: the host time of its output, which is when the HAL
+//  expects to start playing the cycle's mix. (BGM_Device counts the cycles that miss it as late.)
+//  The cycle's load is how much of the budget has gone, so a cycle the HAL starts late has less
+//  time left and sheds sooner than one that starts on time, even if it does the same work. If the
+//  output time has no host time, the budget starts at the cycle's first IO operation instead, so
+//  only the time spent in the cycle counts. A cycle ends when its mix is written. The processing is
+//  shed in levels, each of which also sheds the levels before it:
+//
+//      kShedSpectralFeatures   The signal classifiers skip their FFTs. (See BGM_SignalClassifier.)
+//      kShedLowPriorityEQ      The EQ of low-priority apps is bypassed.
+//      kShedRouteMixing        Routed audio isn't mixed, so route destinations get silence.
+//
+//  High-priority apps are never shed. (See kAudioDeviceCustomPropertyAppPriorities.)
+//
+//  There are two ways a level can be reached. Within a cycle, the level rises as the cycle uses up
+//  its budget, so the clients processed last in an overloaded cycle are shed and the cycle can
+//  still finish in time. Across cycles, the level rises by one each time a cycle uses more than
+//  kRaiseLoad of its budget and only falls by one after kRecoverySecs of cycles using less than
+//  kLowerLoad. That keeps a sustained overload shed from the start of each cycle without the level
+//  flapping from cycle to cycle. The shed level used is the higher of the two.
+//
+//  The time is read from the host's clock by default. Another clock can be set with SetClock, e.g.
+//  so the simulated host (see BGM_SimulatedHost.h) can time its cycles in simulated time, which
+//  makes the levels they reach independent of the machine's speed and load.
+//
+//  The RT methods must only be called from the IO thread. The sample rate and the last cycle's
+//  load can be read from any thread.
+//
+
+#ifndef BGMDriver__BGM_DSPBudget
+#define BGMDriver__BGM_DSPBudget
+
+// System Includes
+#include <CoreAudio/CoreAudioTypes.h>
+#include <MacTypes.h>
+
+// STL Includes
+#include <atomic>
+
+
+#pragma clang assume_nonnull begin
+
+class BGM_DSPBudget
+{
+
+public:
+    enum ShedLevel : UInt32
+    {
+        kShedNothing,
+        kShedSpectralFeatures,
+        kShedLowPriorityEQ,
+        kShedRouteMixing,
+        kShedLevelCount
+    };
+
+    // The fractions of its budget a cycle has to have used for each level to be reached within it.
+    static constexpr Float64    kInCycleLoads[kShedLevelCount] = { 0.0, 0.6, 0.75, 0.9 };
+    // A cycle that uses more than this fraction of its budget raises the sustained level by one.
+    static constexpr Float64    kRaiseLoad = 0.7;
+    // The sustained level falls by one after the cycles have used less than this fraction of their
+    // budgets for kRecoverySecs.
+    static constexpr Float64    kLowerLoad = 0.5;
+    static constexpr Float64    kRecoverySecs = 1.0;
+
+    /*! Returns the current time in host ticks. Must be real-time safe. */
+    typedef UInt64 (*Clock)(void* _Nullable inRefCon);
+
+                                BGM_DSPBudget();
+                                BGM_DSPBudget(const BGM_DSPBudget&) = delete;
+                                BGM_DSPBudget& operator=(const BGM_DSPBudget&) = delete;
+
+    /*! Set the sample rate of the IO cycles. Can be called from any thread. */
+    void                        SetSampleRate(Float64 inSampleRate);
+
+    /*!
+     Replace the clock the cycles are timed with. Only call this while IO is stopped.
+
+     @param inClock The new clock, or null for the host's clock (CAHostTimeBase).
+     @param inRefCon Passed to inClock.
+     */
+    void                        SetClock(Clock _Nullable inClock, void* _Nullable inRefCon);
+
+    /*!
+     Start timing a cycle if the operation is the first in its cycle. Called at the start of each IO
+     operation.
+
+     @param inIOBufferFrameSize The cycle's buffer size.
+     @param inOutputTime The cycle's output time. Operations with a different output sample time
+                         from the current cycle's start a new cycle, even if the current one never
+                         ended, e.g. because the HAL stopped IO before writing its mix.
+     */
+    void                        BeginOperationRT(UInt32 inIOBufferFrameSize,
+                                                 const AudioTimeStamp& inOutputTime);
+
+    /*! @return The level of processing to shed now. */
+    ShedLevel                   GetShedLevelRT() const;
+
+    /*! Finish timing the current cycle and update the sustained level with its load. */
+    void                        EndCycleRT();
+
+    /*! The sustained level, i.e. the level every client is shed to from the start of a cycle. */
+    ShedLevel                   GetSustainedShedLevel() const { return mSustainedLevel.load(std::memory_order_relaxed); }
+
+    /*! The fraction of its budget the last cycle used. Can be more than 1.0. */
+    Float64                     GetLastCycleLoad() const { return mLastCycleLoad.load(std::memory_order_relaxed); }
+
+    /*! Forget the cycles so far, e.g. when IO starts. Not thread-safe. */
+    void                        Reset();
+
+private:
+    static UInt64               GetHostClockTime(void* _Nullable inRefCon);
+
+private:
+    std::atomic<Float64>        mSampleRate;
+    Float64                     mHostTicksPerSecond;
+    Clock                       mClock;
+    void* _Nullable             mClockRefCon;
+
+    // The cycle being timed, if any. Only accessed on the IO thread. mCycleStartHostTime is when its
+    // budget started, which is its deadline minus the budget.
+    bool                        mInCycle;
+    Float64                     mCycleOutputSampleTime;
+    UInt64                      mCycleStartHostTime;
+    Float64                     mCycleBudgetHostTicks;
+
+    std::atomic<ShedLevel>      mSustainedLevel;
+    std::atomic<Float64>        mLastCycleLoad;
+    // How long the cycles have been under kLowerLoad for. Only accessed on the IO thread.
+    Float64                     mSecsUnderLowerLoad;
+
+};
+
+#pragma clang assume_nonnull end
+
+#endif /* BGMDriver__BGM_DSPBudget */
+
@@ -0,0 +1,161 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+
+//
+//
+//  BGM_DSPContext.cpp
+//  BGMDriver
+//
+//  Copyright © 2026 Background Music contributors
+//
+
+// Self Include
+#include "BGM_DSPContext.h"
+
+// STL Includes
+#include <cmath>
+
+// System Includes
+#if defined(__APPLE__)
+#include <Accelerate/Accelerate.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <xmmintrin.h>
+#endif
+
+
+#pragma clang assume_nonnull begin
+
+namespace
+{
+
+#if defined(__x86_64__) || defined(__i386__)
+    // The MXCSR flush-to-zero (bit 15) and denormals-are-zero (bit 6) flags.
+    const UInt64 kFlushDenormalsMask = 0x8040;
+#elif defined(__aarch64__) || defined(__arm64__)
+    // The FPCR flush-to-zero flag (bit 24).
+    const UInt64 kFlushDenormalsMask = 1ULL << 24;
+#else
+    const UInt64 kFlushDenormalsMask = 0;
+#endif
+
+    UInt64  GetControlRegister()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        return _mm_getcsr();
+#elif defined(__aarch64__) || defined(__arm64__)
+        UInt64 theFPCR;
+        __asm__ __volatile__("mrs %0, fpcr" : "=r"(theFPCR));
+        return theFPCR;
+#else
+        return 0;
+#endif
+    }
+
+    void    SetControlRegister(UInt64 inValue)
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        _mm_setcsr(static_cast<unsigned int>(inValue));
+#elif defined(__aarch64__) || defined(__arm64__)
+        __asm__ __volatile__("msr fpcr, %0" : : "r"(inValue));
+#else
+        (void)inValue;
+#endif
+    }
+
+    template<typename T>
+    bool    FlushState(T* ioState, UInt32 inCount)
+    {
+        bool isZero = true;
+
+        for(UInt32 i = 0; i < inCount; i++)
+        {
+            if(std::fabs(ioState[i]) < static_cast<T>(BGM_DSPContext::kStateFlushThreshold))
+            {
+                ioState[i] = 0;
+            }
+            else
+            {
+                isZero = false;
+            }
+        }
+
+        return isZero;
+    }
+
+}
+
+BGM_DSPContext::BGM_DSPContext()
+:
+    mSavedControlRegister(GetControlRegister()),
+    mChangedControlRegister(false)
+{
+    // Writing the control register can stall the pipeline, so only write it if it would change.
+    if((mSavedControlRegister & kFlushDenormalsMask) != kFlushDenormalsMask)
+    {
+        SetControlRegister(mSavedControlRegister | kFlushDenormalsMask);
+        mChangedControlRegister = true;
+    }
+}
+
+BGM_DSPContext::~BGM_DSPContext()
+{
+    if(mChangedControlRegister)
+    {
+        SetControlRegister(mSavedControlRegister);
+    }
+}
+
+bool    BGM_DSPContext::FlushesDenormals()
+{
+    return (kFlushDenormalsMask != 0) &&
+           ((GetControlRegister() & kFlushDenormalsMask) == kFlushDenormalsMask);
+}
+
+#pragma mark Kernels
+
+bool    BGM_DSPContext::IsSilentRT(const Float32* inBuffer, UInt32 inSampleCount)
+{
+#if defined(__APPLE__)
+    Float32 thePeak = 0.0f;
+    vDSP_maxmgv(inBuffer, 1, &thePeak, inSampleCount);
+    return thePeak == 0.0f;
+#else
+    for(UInt32 i = 0; i < inSampleCount; i++)
+    {
+        if(inBuffer[i] != 0.0f)
+        {
+            return false;
+        }
+    }
+
+    return true;
+#endif
+}
+
+bool    BGM_DSPContext::FlushStateRT(Float32* ioState, UInt32 inCount)
+{
+    return FlushState(ioState, inCount);
+}
+
+bool    BGM_DSPContext::FlushStateRT(Float64* ioState, UInt32 inCount)
+{
+    return FlushState(ioState, inCount);
+}
+
+#pragma clang assume_nonnull end
+
@@ -0,0 +1,99 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+
+//
+//
+//  BGM_DSPContext.h
+//  BGMDriver
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  Sets up the floating-point environment for the driver's DSP while an instance is in scope.
+//
+//  When an app goes quiet, the states of its recursive filters (e.g. its EQ) decay towards zero
+//  and eventually become subnormal ("denormal") numbers. On x86, arithmetic on subnormals can be
+//  orders of magnitude slower than on normal numbers, so a silent app could cost more CPU time
+//  than a loud one. Creating a BGM_DSPContext enables flush-to-zero and denormals-are-zero, which
+//  makes the CPU treat subnormals as zero, and the destructor restores the previous mode. The
+//  mode is per-thread, so the context has to be created on the thread doing the DSP, i.e. the IO
+//  thread, and it's cheap enough to create for every IO operation.
+//
+//  On arm64 only flush-to-zero is set, which covers both inputs and outputs. Elsewhere the
+//  context does nothing, so DSP code should also flush its filter states with FlushStateRT when
+//  its input is silent rather than relying on the context.
+//
+
+#ifndef BGMDriver__BGM_DSPContext
+#define BGMDriver__BGM_DSPContext
+
+// System Includes
+#include <MacTypes.h>
+
+
+#pragma clang assume_nonnull begin
+
+class BGM_DSPContext
+{
+
+public:
+    /*! Enable flush-to-zero and denormals-are-zero on this thread. Real-time safe. */
+                        BGM_DSPContext();
+    /*! Restore the floating-point mode the thread had when this context was created. */
+                        ~BGM_DSPContext();
+
+                        BGM_DSPContext(const BGM_DSPContext&) = delete;
+    BGM_DSPContext&     operator=(const BGM_DSPContext&) = delete;
+
+    /*!
+     @return True if subnormal results are currently flushed to zero on this thread, e.g. because a
+             BGM_DSPContext is in scope. Always false on CPUs the context doesn't support.
+     */
+    static bool         FlushesDenormals();
+
+#pragma mark Kernels
+
+    /*!
+     @return True if every sample in inBuffer is zero.
+     */
+    static bool         IsSilentRT(const Float32* inBuffer, UInt32 inSampleCount);
+
+    /*!
+     Set the values in a filter's state to zero if they're too small to affect its output, i.e.
+     smaller in magnitude than kStateFlushThreshold. Intended to be called when the filter's input
+     is silent, so the state never decays far enough to become subnormal and, once it has been
+     flushed, the filter can be skipped until its input isn't silent.
+
+     @return True if every value in ioState is now zero.
+     */
+    static bool         FlushStateRT(Float32* ioState, UInt32 inCount);
+    static bool         FlushStateRT(Float64* ioState, UInt32 inCount);
+
+    // About -300 dBFS, far below anything audible, but far above the largest subnormal Float32.
+    static constexpr Float32    kStateFlushThreshold = 1.0e-15f;
+
+private:
+    // The thread's floating-point control register (MXCSR on x86, FPCR on arm64) before this
+    // context changed it.
+    UInt64              mSavedControlRegister;
+    // False if the mode was already set, e.g. by an enclosing context, so there's nothing to restore.
+    bool                mChangedControlRegister;
+
+};
+
+#pragma clang assume_nonnull end
+
+#endif /* BGMDriver__BGM_DSPContext */
+
@@ -0,0 +1,284 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_DSPWorkerPool.cpp
+//  BGMDriver
+//
+//  Copyright © 2026 Background Music contributors
+//
+
+// Self Include
+#include "BGM_DSPWorkerPool.h"
+
+// Local Includes
+#include "BGM_DSPContext.h"
+#include "BGM_RTSafety.h"
+#include "BGM_Utils.h"
+
+// PublicUtility Includes
+#include "CAException.h"
+#include "CADebugMacros.h"
+#include "CAHostTimeBase.h"
+
+// STL Includes
+#include <thread>
+
+// System Includes
+#include <CoreAudio/AudioHardwareBase.h>
+#include <mach/mach_init.h>
+#include <mach/task.h>
+
+
+#pragma clang assume_nonnull begin
+
+// The same time constraints as BGM_TaskQueue's real-time thread. The workers' jobs are usually much
+// shorter, but a worker runs jobs until the queues are empty, so it can use a few at once.
+static const UInt32 kWorkerNominalComputationNs = 50 * NSEC_PER_USEC;
+static const UInt32 kWorkerMaximumComputationNs = 60 * NSEC_PER_USEC;
+
+constexpr UInt32 BGM_DSPWorkerPool::kMaxWorkers;
+constexpr UInt32 BGM_DSPWorkerPool::kMaxJobsPerCycle;
+
+#pragma mark Construction/destruction
+
+BGM_DSPWorkerPool::BGM_DSPWorkerPool(UInt32 inWorkerCount,
+                                     JobFunction inJobFunction,
+                                     void* inRefCon)
+:
+    mJobFunction(inJobFunction),
+    mRefCon(inRefCon),
+    mWorkers(),
+    mPendingJobs(0),
+    mJobsThisCycle(0),
+    mStopping(false),
+    mWorkerStoppedSemaphore(SEMAPHORE_NULL)
+{
+    ThrowIf(inWorkerCount == 0 || inWorkerCount > kMaxWorkers,
+            CAException(kAudioHardwareIllegalOperationError),
+            "BGM_DSPWorkerPool::BGM_DSPWorkerPool: Invalid worker count");
+
+    auto createSemaphore = [] () {
+        semaphore_t theSemaphore;
+        kern_return_t theError = semaphore_create(mach_task_self(), &theSemaphore, SYNC_POLICY_FIFO, 0);
+
+        BGM_Utils::ThrowIfMachError("BGM_DSPWorkerPool::BGM_DSPWorkerPool", "semaphore_create", theError);
+
+        ThrowIf(theSemaphore == SEMAPHORE_NULL,
+                CAException(kAudioHardwareUnspecifiedError),
+                "BGM_DSPWorkerPool::BGM_DSPWorkerPool: Could not create semaphore");
+
+        return theSemaphore;
+    };
+
+    mWorkerStoppedSemaphore = createSemaphore();
+
+    // Create all of the workers before starting any, since they steal from each other's queues.
+    for(UInt32 i = 0; i < inWorkerCount; i++)
+    {
+        std::unique_ptr<Worker> theWorker(new Worker);
+        theWorker->mPool = this;
+        theWorker->mIndex = i;
+        theWorker->mWorkQueuedSemaphore = createSemaphore();
+        theWorker->mHead = 0;
+        theWorker->mTail = 0;
+
+        for(std::atomic<UInt32>& theJob : theWorker->mJobs)
+        {
+            theJob.store(0, std::memory_order_relaxed);
+        }
+
+        // See the comment about the period in BGM_TaskQueue::BGM_TaskQueue.
+        theWorker->mThread.reset(new CAPThread(&BGM_DSPWorkerPool::WorkerThreadProc,
+                                               theWorker.get(),
+                                               /* inPeriod = */ 0,
+                                               static_cast<UInt32>(CAHostTimeBase::ConvertFromNanos(kWorkerNominalComputationNs)),
+                                               static_cast<UInt32>(CAHostTimeBase::ConvertFromNanos(kWorkerMaximumComputationNs)),
+                                               /* inIsPreemptible = */ true));
+
+        mWorkers.push_back(std::move(theWorker));
+    }
+
+    for(std::unique_ptr<Worker>& theWorker : mWorkers)
+    {
+        theWorker->mThread->Start();
+    }
+}
+
+BGM_DSPWorkerPool::~BGM_DSPWorkerPool()
+{
+    // Wake the workers so they see they should stop, then wait for them to finish. They can't be
+    // joined because CAPThread detaches its threads.
+    mStopping.store(true, std::memory_order_release);
+
+    for(std::unique_ptr<Worker>& theWorker : mWorkers)
+    {
+        kern_return_t theError = semaphore_signal(theWorker->mWorkQueuedSemaphore);
+        BGM_Utils::LogIfMachError("BGM_DSPWorkerPool::~BGM_DSPWorkerPool", "semaphore_signal", theError);
+    }
+
+    for(std::unique_ptr<Worker>& theWorker : mWorkers)
+    {
+        kern_return_t theError = semaphore_wait(mWorkerStoppedSemaphore);
+        BGM_Utils::LogIfMachError("BGM_DSPWorkerPool::~BGM_DSPWorkerPool", "semaphore_wait", theError);
+
+        // CAPThread still uses the thread object after the thread routine returns.
+        while(theWorker->mThread->IsRunning())
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    auto destroySemaphore = [] (semaphore_t inSemaphore) {
+        kern_return_t theError = semaphore_destroy(mach_task_self(), inSemaphore);
+
+        BGM_Utils::LogIfMachError("BGM_DSPWorkerPool::~BGM_DSPWorkerPool", "semaphore_destroy", theError);
+    };
+
+    for(std::unique_ptr<Worker>& theWorker : mWorkers)
+    {
+        destroySemaphore(theWorker->mWorkQueuedSemaphore);
+    }
+
+    destroySemaphore(mWorkerStoppedSemaphore);
+}
+
+#pragma mark Jobs
+
+bool    BGM_DSPWorkerPool::SubmitRT(UInt32 inJob)
+{
+    if(mJobsThisCycle >= kMaxJobsPerCycle)
+    {
+        return false;
+    }
+
+    Worker& theWorker = *mWorkers[mJobsThisCycle % mWorkers.size()];
+    mJobsThisCycle++;
+
+    mPendingJobs.fetch_add(1, std::memory_order_relaxed);
+
+    // Only this thread writes the tail, so it can be read relaxed. The release publishes the job,
+    // and anything the caller wrote for it, to the thread that takes it.
+    const UInt32 theTail = theWorker.mTail.load(std::memory_order_relaxed);
+    theWorker.mJobs[theTail % kMaxJobsPerCycle].store(inJob, std::memory_order_relaxed);
+    theWorker.mTail.store(theTail + 1, std::memory_order_release);
+
+    kern_return_t theError = semaphore_signal(theWorker.mWorkQueuedSemaphore);
+    BGM_Utils::ThrowIfMachError("BGM_DSPWorkerPool::SubmitRT", "semaphore_signal", theError);
+
+    return true;
+}
+
+void    BGM_DSPWorkerPool::JoinRT()
+{
+    // Run the jobs no worker has taken yet, then wait for the ones they're running. The workers are
+    // real-time threads, so they won't be preempted for long.
+    while(mPendingJobs.load(std::memory_order_acquire) != 0)
+    {
+        if(!RunJobRT(0))
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    mJobsThisCycle = 0;
+}
+
+// static
+bool    BGM_DSPWorkerPool::TakeJobRT(Worker& ioWorker, UInt32& outJob)
+{
+    UInt32 theHead = ioWorker.mHead.load(std::memory_order_relaxed);
+
+    while(theHead != ioWorker.mTail.load(std::memory_order_acquire))
+    {
+        // Read the job before claiming it. The IO thread can only overwrite it after it's been
+        // taken, so if the compare-and-swap succeeds, nobody else has taken it and it's still the
+        // job that was submitted.
+        const UInt32 theJob = ioWorker.mJobs[theHead % kMaxJobsPerCycle].load(std::memory_order_relaxed);
+
+        if(ioWorker.mHead.compare_exchange_weak(theHead,
+                                                theHead + 1,
+                                                std::memory_order_acq_rel,
+                                                std::memory_order_relaxed))
+        {
+            outJob = theJob;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool    BGM_DSPWorkerPool::RunJobRT(UInt32 inFirstWorker)
+{
+    const UInt32 theWorkerCount = GetWorkerCount();
+
+    for(UInt32 i = 0; i < theWorkerCount; i++)
+    {
+        UInt32 theJob;
+
+        if(TakeJobRT(*mWorkers[(inFirstWorker + i) % theWorkerCount], theJob))
+        {
+            mJobFunction(mRefCon, theJob);
+
+            // The release makes the job's results visible to the IO thread when JoinRT sees the
+            // count reach zero.
+            mPendingJobs.fetch_sub(1, std::memory_order_release);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+#pragma mark Worker Threads
+
+// static
+void* _Nullable BGM_DSPWorkerPool::WorkerThreadProc(void* inRefCon)
+{
+    Worker* theWorker = static_cast<Worker*>(inRefCon);
+    BGM_DSPWorkerPool* thePool = theWorker->mPool;
+
+    while(true)
+    {
+        // The semaphore is signalled once for each job given to this worker, but a worker often
+        // finds its queue already emptied by the time it wakes, in which case it just waits again.
+        kern_return_t theError = semaphore_wait(theWorker->mWorkQueuedSemaphore);
+        BGM_Utils::LogIfMachError("BGM_DSPWorkerPool::WorkerThreadProc", "semaphore_wait", theError);
+
+        if(thePool->mStopping.load(std::memory_order_acquire))
+        {
+            break;
+        }
+
+        BGMRTScope("BGM_DSPWorkerPool::WorkerThreadProc");
+
+        // The jobs are DSP, so they need the same floating-point mode as the IO thread's.
+        BGM_DSPContext theDSPContext;
+
+        while(thePool->RunJobRT(theWorker->mIndex))
+        {
+        }
+    }
+
+    kern_return_t theError = semaphore_signal(thePool->mWorkerStoppedSemaphore);
+    BGM_Utils::LogIfMachError("BGM_DSPWorkerPool::WorkerThreadProc", "semaphore_signal", theError);
+
+    return nullptr;
+}
+
+#pragma clang assume_nonnull end
+
@@ -0,0 +1,157 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_DSPWorkerPool.h
+//  BGMDriver
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  A pool of real-time worker threads that BGM_IOPipeline can hand the clients' DSP to, so the
+//  processing for an IO cycle can use more than one core. (See BGM_IOPipeline::
+//  SetDSPOffloadWorkerCount.)
+//
+//  The IO thread submits jobs during a cycle with SubmitRT and then calls JoinRT before it writes
+//  the mix, which returns once every job has finished. A job is just an index, which the pool
+//  passes to the job function it was created with.
+//
+//  Each worker has its own queue. SubmitRT deals the jobs out to the workers' queues in turn and
+//  wakes the worker it gave the job to. A worker runs the jobs in its own queue first and then
+//  steals from the others', so a worker that's slow to wake or stuck with long jobs doesn't hold
+//  up the cycle while the others are idle. While it waits in JoinRT, the IO thread steals jobs as
+//  well, so it's never just waiting for a worker to wake up.
+//
+//  The queues are bounded rings written only by the IO thread. Taking a job is a compare-and-swap
+//  on the queue's head, so the owner and the thieves can take from a queue at the same time. The
+//  rings can't wrap within a cycle, since no more than kMaxJobsPerCycle jobs can be submitted
+//  between joins. Submitting, taking and joining are lock-free and the workers are woken with
+//  Mach semaphores, which are real-time safe to signal.
+//
+//  The workers are time-constraint threads (see CAPThread), like BGM_TaskQueue's real-time
+//  thread, so they run at the IO thread's priority band.
+//
+
+#ifndef BGMDriver__BGM_DSPWorkerPool
+#define BGMDriver__BGM_DSPWorkerPool
+
+// Local Includes
+#include "BGM_Types.h"
+
+// PublicUtility Includes
+#include "CAPThread.h"
+
+// STL Includes
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// System Includes
+#include <mach/semaphore.h>
+
+
+#pragma clang assume_nonnull begin
+
+class BGM_DSPWorkerPool
+{
+
+public:
+    typedef void (*JobFunction)(void* inRefCon, UInt32 inJob);
+
+    static constexpr UInt32     kMaxWorkers = kBGMMaxDSPOffloadWorkers;
+    static constexpr UInt32     kMaxJobsPerCycle = 256;
+
+    /*!
+     Start the worker threads. Not real-time safe.
+
+     @param inWorkerCount The number of worker threads, from 1 to kMaxWorkers.
+     @param inJobFunction Called on the worker threads (or in JoinRT on the IO thread) to run each
+                          job. Must be real-time safe.
+     @param inRefCon Passed to inJobFunction.
+     @throws CAException if the threads or their semaphores couldn't be created.
+     */
+                                BGM_DSPWorkerPool(UInt32 inWorkerCount,
+                                                  JobFunction inJobFunction,
+                                                  void* inRefCon);
+    /*! Stop the worker threads and wait for them to finish. Not real-time safe. */
+                                ~BGM_DSPWorkerPool();
+                                BGM_DSPWorkerPool(const BGM_DSPWorkerPool&) = delete;
+                                BGM_DSPWorkerPool& operator=(const BGM_DSPWorkerPool&) = delete;
+
+    UInt32                      GetWorkerCount() const { return static_cast<UInt32>(mWorkers.size()); }
+
+    /*!
+     Queue a job for the workers. Only call from the IO thread.
+
+     @return False if kMaxJobsPerCycle jobs have already been submitted since the last JoinRT, in
+             which case the caller should run the job itself.
+     */
+    bool                        SubmitRT(UInt32 inJob);
+
+    /*!
+     Wait for every job submitted since the last call to finish, helping to run them. Only call
+     from the IO thread. Once this returns, the jobs' results are visible to the IO thread.
+     */
+    void                        JoinRT();
+
+private:
+    struct Worker
+    {
+        BGM_DSPWorkerPool*              mPool;
+        UInt32                          mIndex;
+        std::unique_ptr<CAPThread>      mThread;
+        semaphore_t                     mWorkQueuedSemaphore;
+
+        // The queue. Jobs are taken from mHead and added at mTail, both of which only increase.
+        // Only the IO thread writes mTail and mJobs.
+        std::atomic<UInt32>             mJobs[kMaxJobsPerCycle];
+        std::atomic<UInt32>             mHead;
+        std::atomic<UInt32>             mTail;
+    };
+
+    static void* _Nullable      WorkerThreadProc(void* inRefCon);
+
+    /*! Take a job from the worker's queue. Can be called from any of the pool's threads. */
+    static bool                 TakeJobRT(Worker& ioWorker, UInt32& outJob);
+
+    /*!
+     Take and run a job, trying the queue of the worker at inFirstWorker first and then stealing
+     from the others in turn.
+
+     @return False if every queue was empty.
+     */
+    bool                        RunJobRT(UInt32 inFirstWorker);
+
+private:
+    const JobFunction           mJobFunction;
+    void* const                 mRefCon;
+
+    std::vector<std::unique_ptr<Worker>> mWorkers;
+
+    // The jobs that have been submitted but haven't finished.
+    std::atomic<UInt32>         mPendingJobs;
+    // The jobs submitted since the last join, which is also the worker the next job goes to (mod the
+    // number of workers). Only accessed by the IO thread.
+    UInt32                      mJobsThisCycle;
+
+    std::atomic<bool>           mStopping;
+    semaphore_t                 mWorkerStoppedSemaphore;
+
+};
+
+#pragma clang assume_nonnull end
+
+#endif /* BGMDriver__BGM_DSPWorkerPool */
+
@@ -33,6 +33,8 @@
 
 // Local Includes
 #include "BGM_PlugIn.h"
+#include "BGM_DSPContext.h"
+#include "BGM_RTSafety.h"
 #include "BGM_XPCHelper.h"
 #include "BGM_Utils.h"
 
@@ -46,10 +48,76 @@
 
 // STL Includes
 #include <stdexcept>
+#include <string>
 
 // System Includes
 #include <CoreAudio/AudioHardwareBase.h>
-
+#include <limits.h>
+
+
+// The custom properties BGMDevice publishes, for kAudioObjectPropertyCustomPropertyInfoList.
+static const AudioServerPlugInCustomPropertyInfo kBGMDeviceCustomPropertyInfoList[] = {
+    { kAudioDeviceCustomPropertyAppVolumes,
+      kAudioServerPlugInCustomPropertyDataTypeCFPropertyList,
+      kAudioServerPlugInCustomPropertyDataTypeNone },
+    { kAudioDeviceCustomPropertyMusicPlayerProcessID,
+      kAudioServerPlugInCustomPropertyDataTypeCFPropertyList,
+      kAudioServerPlugInCustomPropertyDataTypeNone },
+    { kAudioDeviceCustomPropertyMusicPlayerBundleID,
+      kAudioServerPlugInCustomPropertyDataTypeCFString,
+      kAudioServerPlugInCustomPropertyDataTypeNone },
+    { kAudioDeviceCustomPropertyDeviceIsRunningSomewhereOtherThanBGMApp,
+      kAudioServerPlugInCustomPropertyDataTypeCFPropertyList,
+      kAudioServerPlugInCustomPropertyDataTypeNone },
+    { kAudioDeviceCustomPropertyDeviceAudibleState,
+      kAudioServerPlugInCustomPropertyDataTypeCFPropertyList,
+      kAudioServerPlugInCustomPropertyDataTypeNone },
+    { kAudioDeviceCustomPropertyEnabledOutputControls,
+      kAudioServerPlugInCustomPropertyDataTypeCFPropertyList,
+      kAudioServerPlugInCustomPropertyDataTypeNone },
+    { kAudioDeviceCustomPropertyAppRouting,
+      kAudioServerPlugInCustomPropertyDataTypeCFPropertyList,
+      kAudioServerPlugInCustomPropertyDataTypeNone },
+    { kAudioDeviceCustomPropertyMixMinusApps,
+      kAudioServerPlugInCustomPropertyDataTypeCFPropertyList,
+      kAudioServerPlugInCustomPropertyDataTypeNone },
+    { kAudioDeviceCustomPropertyCaptureFilters,
+      kAudioServerPlugInCustomPropertyDataTypeCFPropertyList,
+      kAudioServerPlugInCustomPropertyDataTypeNone },
+    { kAudioDeviceCustomPropertyCrossfader,
+      kAudioServerPlugInCustomPropertyDataTypeCFPropertyList,
+      kAudioServerPlugInCustomPropertyDataTypeNone },
+    { kAudioDeviceCustomPropertyAppAutomation,
+      kAudioServerPlugInCustomPropertyDataTypeCFPropertyList,
+      kAudioServerPlugInCustomPropertyDataTypeNone },
+    { kAudioDeviceCustomPropertyScene,
+      kAudioServerPlugInCustomPropertyDataTypeCFPropertyList,
+      kAudioServerPlugInCustomPropertyDataTypeNone },
+    { kAudioDeviceCustomPropertyDucking,
+      kAudioServerPlugInCustomPropertyDataTypeCFPropertyList,
+      kAudioServerPlugInCustomPropertyDataTypeNone },
+    { kAudioDeviceCustomPropertyLoudness,
+      kAudioServerPlugInCustomPropertyDataTypeCFPropertyList,
+      kAudioServerPlugInCustomPropertyDataTypeNone },
+    { kAudioDeviceCustomPropertyLoudnessNormalization,
+      kAudioServerPlugInCustomPropertyDataTypeCFPropertyList,
+      kAudioServerPlugInCustomPropertyDataTypeNone },
+    { kAudioDeviceCustomPropertyIOTrace,
+      kAudioServerPlugInCustomPropertyDataTypeCFPropertyList,
+      kAudioServerPlugInCustomPropertyDataTypeNone },
+    { kAudioDeviceCustomPropertyGlitchTelemetry,
+      kAudioServerPlugInCustomPropertyDataTypeCFPropertyList,
+      kAudioServerPlugInCustomPropertyDataTypeNone },
+    { kAudioDeviceCustomPropertyAppPriorities,
+      kAudioServerPlugInCustomPropertyDataTypeCFPropertyList,
+      kAudioServerPlugInCustomPropertyDataTypeNone },
+    { kAudioDeviceCustomPropertyDSPOffloadWorkers,
+      kAudioServerPlugInCustomPropertyDataTypeCFPropertyList,
+      kAudioServerPlugInCustomPropertyDataTypeNone }
+};
+
+static const UInt32 kBGMDeviceCustomPropertyCount =
+        sizeof(kBGMDeviceCustomPropertyInfoList) / sizeof(AudioServerPlugInCustomPropertyInfo);
 
 #pragma mark Construction/Destruction
 
@@ -136,10 +204,11 @@ BGM_Device::BGM_Device(AudioObjectID inObjectID,
 	mDeviceUID(inDeviceUID),
 	mDeviceModelUID(inDeviceModelUID),
     mWrappedAudioEngine(nullptr),
-    mClients(inObjectID, &mTaskQueue),
+    mClients(inObjectID,
+             (inObjectID == kObjectID_Device_UI_Sounds) ? kBGMParameterTableName_UISounds : kBGMParameterTableName),
+    mIOPipeline(mClients, mIOMutex),
     mInputStream(inInputStreamID, inObjectID, false, kSampleRateDefault),
     mOutputStream(inOutputStreamID, inObjectID, false, kSampleRateDefault),
-    mAudibleState(),
     mVolumeControl(inOutputVolumeControlID, GetObjectID()),
     mMuteControl(inOutputMuteControlID, GetObjectID())
 {
@@ -202,10 +271,7 @@ void    BGM_Device::InitLoopback()
     mLoopbackTime.hostTicksPerFrame = CAHostTimeBase::GetFrequency() / mLoopbackSampleRate;
     
     //  Allocate (or re-allocate) the loopback buffer.
-    //  2 channels * 32-bit float = bytes in each frame
-    //  Pass 1 for nChannels because it's going to be storing interleaved audio, which means we
-    //  don't need a separate buffer for each channel.
-	mLoopbackRingBuffer.Allocate(1, 2 * sizeof(Float32), kLoopbackRingBufferFrameSize);
+    mIOPipeline.AllocateLoopback();
 }
 
 #pragma mark Property Operations
@@ -328,6 +394,18 @@ bool	BGM_Device::Device_HasProperty(AudioObjectID inObjectID, pid_t inClientPID,
         case kAudioDeviceCustomPropertyDeviceIsRunningSomewhereOtherThanBGMApp:
         case kAudioDeviceCustomPropertyAppVolumes:
         case kAudioDeviceCustomPropertyAppRouting:
+        case kAudioDeviceCustomPropertyMixMinusApps:
+        case kAudioDeviceCustomPropertyCaptureFilters:
+        case kAudioDeviceCustomPropertyCrossfader:
+        case kAudioDeviceCustomPropertyAppAutomation:
+        case kAudioDeviceCustomPropertyScene:
+        case kAudioDeviceCustomPropertyDucking:
+        case kAudioDeviceCustomPropertyLoudness:
+        case kAudioDeviceCustomPropertyLoudnessNormalization:
+        case kAudioDeviceCustomPropertyIOTrace:
+        case kAudioDeviceCustomPropertyGlitchTelemetry:
+        case kAudioDeviceCustomPropertyAppPriorities:
+        case kAudioDeviceCustomPropertyDSPOffloadWorkers:
         case kAudioDeviceCustomPropertyEnabledOutputControls:
 			theAnswer = true;
 			break;
@@ -368,6 +446,7 @@ bool	BGM_Device::Device_IsPropertySettable(AudioObjectID inObjectID, pid_t inCli
         case kAudioObjectPropertyCustomPropertyInfoList:
         case kAudioDeviceCustomPropertyDeviceAudibleState:
         case kAudioDeviceCustomPropertyDeviceIsRunningSomewhereOtherThanBGMApp:
+        case kAudioDeviceCustomPropertyLoudness:
 			theAnswer = false;
 			break;
             
@@ -376,6 +455,17 @@ bool	BGM_Device::Device_IsPropertySettable(AudioObjectID inObjectID, pid_t inCli
         case kAudioDeviceCustomPropertyMusicPlayerBundleID:
         case kAudioDeviceCustomPropertyAppVolumes:
         case kAudioDeviceCustomPropertyAppRouting:
+        case kAudioDeviceCustomPropertyMixMinusApps:
+        case kAudioDeviceCustomPropertyCaptureFilters:
+        case kAudioDeviceCustomPropertyCrossfader:
+        case kAudioDeviceCustomPropertyAppAutomation:
+        case kAudioDeviceCustomPropertyScene:
+        case kAudioDeviceCustomPropertyDucking:
+        case kAudioDeviceCustomPropertyLoudnessNormalization:
+        case kAudioDeviceCustomPropertyIOTrace:
+        case kAudioDeviceCustomPropertyGlitchTelemetry:
+        case kAudioDeviceCustomPropertyAppPriorities:
+        case kAudioDeviceCustomPropertyDSPOffloadWorkers:
         case kAudioDeviceCustomPropertyEnabledOutputControls:
 			theAnswer = true;
 			break;
@@ -463,7 +553,7 @@ UInt32	BGM_Device::Device_GetPropertyDataSize(AudioObjectID inObjectID, pid_t in
             break;
             
         case kAudioObjectPropertyCustomPropertyInfoList:
-            theAnswer = sizeof(AudioServerPlugInCustomPropertyInfo) * 7;
+            theAnswer = sizeof(kBGMDeviceCustomPropertyInfoList);
             break;
             
         case kAudioDeviceCustomPropertyDeviceAudibleState:
@@ -490,6 +580,54 @@ UInt32	BGM_Device::Device_GetPropertyDataSize(AudioObjectID inObjectID, pid_t in
             theAnswer = sizeof(CFPropertyListRef);
             break;
 
+        case kAudioDeviceCustomPropertyMixMinusApps:
+            theAnswer = sizeof(CFPropertyListRef);
+            break;
+
+        case kAudioDeviceCustomPropertyCaptureFilters:
+            theAnswer = sizeof(CFPropertyListRef);
+            break;
+
+        case kAudioDeviceCustomPropertyCrossfader:
+            theAnswer = sizeof(CFPropertyListRef);
+            break;
+
+        case kAudioDeviceCustomPropertyAppAutomation:
+            theAnswer = sizeof(CFPropertyListRef);
+            break;
+
+        case kAudioDeviceCustomPropertyScene:
+            theAnswer = sizeof(CFPropertyListRef);
+            break;
+
+        case kAudioDeviceCustomPropertyDucking:
+            theAnswer = sizeof(CFPropertyListRef);
+            break;
+
+        case kAudioDeviceCustomPropertyLoudness:
+            theAnswer = sizeof(CFPropertyListRef);
+            break;
+
+        case kAudioDeviceCustomPropertyLoudnessNormalization:
+            theAnswer = sizeof(CFPropertyListRef);
+            break;
+
+        case kAudioDeviceCustomPropertyIOTrace:
+            theAnswer = sizeof(CFPropertyListRef);
+            break;
+
+        case kAudioDeviceCustomPropertyGlitchTelemetry:
+            theAnswer = sizeof(CFPropertyListRef);
+            break;
+
+        case kAudioDeviceCustomPropertyAppPriorities:
+            theAnswer = sizeof(CFPropertyListRef);
+            break;
+
+        case kAudioDeviceCustomPropertyDSPOffloadWorkers:
+            theAnswer = sizeof(CFNumberRef);
+            break;
+
         case kAudioDeviceCustomPropertyEnabledOutputControls:
             theAnswer = sizeof(CFArrayRef);
             break;
@@ -788,7 +926,9 @@ void	BGM_Device::Device_GetPropertyData(AudioObjectID inObjectID, pid_t inClient
 
         // TODO: Should we return the real kAudioDevicePropertyLatency and/or
         //       kAudioDevicePropertySafetyOffset for the real/wrapped output device?
-        //       If so, should we also add on the extra latency added by Background Music? 
+        //       If so, should we also add on the extra latency added by Background Music? (The
+        //       latency added by offloading the DSP is reported by the output stream. See
+        //       SetDSPOffloadWorkerCount.)
 
 		case kAudioDevicePropertyNominalSampleRate:
 			//	This property returns the nominal sample rate of the device.
@@ -894,53 +1034,14 @@ void	BGM_Device::Device_GetPropertyData(AudioObjectID inObjectID, pid_t inClient
             theNumberItemsToFetch = inDataSize / sizeof(AudioServerPlugInCustomPropertyInfo);
             
             //	clamp it to the number of items we have
-            if(theNumberItemsToFetch > 7)
+            if(theNumberItemsToFetch > kBGMDeviceCustomPropertyCount)
             {
-                theNumberItemsToFetch = 7;
+                theNumberItemsToFetch = kBGMDeviceCustomPropertyCount;
             }
             
-            if(theNumberItemsToFetch > 0)
-            {
-                ((AudioServerPlugInCustomPropertyInfo*)outData)[0].mSelector = kAudioDeviceCustomPropertyAppVolumes;
-                ((AudioServerPlugInCustomPropertyInfo*)outData)[0].mPropertyDataType = kAudioServerPlugInCustomPropertyDataTypeCFPropertyList;
-                ((AudioServerPlugInCustomPropertyInfo*)outData)[0].mQualifierDataType = kAudioServerPlugInCustomPropertyDataTypeNone;
-            }
-            if(theNumberItemsToFetch > 1)
-            {
-                ((AudioServerPlugInCustomPropertyInfo*)outData)[1].mSelector = kAudioDeviceCustomPropertyMusicPlayerProcessID;
-                ((AudioServerPlugInCustomPropertyInfo*)outData)[1].mPropertyDataType = kAudioServerPlugInCustomPropertyDataTypeCFPropertyList;
-                ((AudioServerPlugInCustomPropertyInfo*)outData)[1].mQualifierDataType = kAudioServerPlugInCustomPropertyDataTypeNone;
-            }
-            if(theNumberItemsToFetch > 2)
-            {
-                ((AudioServerPlugInCustomPropertyInfo*)outData)[2].mSelector = kAudioDeviceCustomPropertyMusicPlayerBundleID;
-                ((AudioServerPlugInCustomPropertyInfo*)outData)[2].mPropertyDataType = kAudioServerPlugInCustomPropertyDataTypeCFString;
-                ((AudioServerPlugInCustomPropertyInfo*)outData)[2].mQualifierDataType = kAudioServerPlugInCustomPropertyDataTypeNone;
-            }
-            if(theNumberItemsToFetch > 3)
-            {
-                ((AudioServerPlugInCustomPropertyInfo*)outData)[3].mSelector = kAudioDeviceCustomPropertyDeviceIsRunningSomewhereOtherThanBGMApp;
-                ((AudioServerPlugInCustomPropertyInfo*)outData)[3].mPropertyDataType = kAudioServerPlugInCustomPropertyDataTypeCFPropertyList;
-                ((AudioServerPlugInCustomPropertyInfo*)outData)[3].mQualifierDataType = kAudioServerPlugInCustomPropertyDataTypeNone;
-            }
-            if(theNumberItemsToFetch > 4)
-            {
-                ((AudioServerPlugInCustomPropertyInfo*)outData)[4].mSelector = kAudioDeviceCustomPropertyDeviceAudibleState;
-                ((AudioServerPlugInCustomPropertyInfo*)outData)[4].mPropertyDataType = kAudioServerPlugInCustomPropertyDataTypeCFPropertyList;
-                ((AudioServerPlugInCustomPropertyInfo*)outData)[4].mQualifierDataType = kAudioServerPlugInCustomPropertyDataTypeNone;
-            }
-            if(theNumberItemsToFetch > 5)
-            {
-                ((AudioServerPlugInCustomPropertyInfo*)outData)[5].mSelector = kAudioDeviceCustomPropertyEnabledOutputControls;
-                ((AudioServerPlugInCustomPropertyInfo*)outData)[5].mPropertyDataType = kAudioServerPlugInCustomPropertyDataTypeCFPropertyList;
-                ((AudioServerPlugInCustomPropertyInfo*)outData)[5].mQualifierDataType = kAudioServerPlugInCustomPropertyDataTypeNone;
-            }
-            if(theNumberItemsToFetch > 6)
-            {
-                ((AudioServerPlugInCustomPropertyInfo*)outData)[6].mSelector = kAudioDeviceCustomPropertyAppRouting;
-                ((AudioServerPlugInCustomPropertyInfo*)outData)[6].mPropertyDataType = kAudioServerPlugInCustomPropertyDataTypeCFPropertyList;
-                ((AudioServerPlugInCustomPropertyInfo*)outData)[6].mQualifierDataType = kAudioServerPlugInCustomPropertyDataTypeNone;
-            }
+            memcpy(outData,
+                   kBGMDeviceCustomPropertyInfoList,
+                   theNumberItemsToFetch * sizeof(AudioServerPlugInCustomPropertyInfo));
 
             outDataSize = theNumberItemsToFetch * sizeof(AudioServerPlugInCustomPropertyInfo);
             break;
@@ -950,7 +1051,7 @@ void	BGM_Device::Device_GetPropertyData(AudioObjectID inObjectID, pid_t inClient
                 ThrowIf(inDataSize < sizeof(CFNumberRef), CAException(kAudioHardwareBadPropertySizeError), "BGM_Device::Device_GetPropertyData: not enough space for the return value of kAudioDeviceCustomPropertyDeviceAudibleState for the device");
 
                 // The audible state is read without locking to avoid priority inversions on the IO threads.
-                BGMDeviceAudibleState theAudibleState = mAudibleState.GetState();
+                BGMDeviceAudibleState theAudibleState = mIOPipeline.GetAudibleState();
                 *reinterpret_cast<CFNumberRef*>(outData) =
                         CFNumberCreate(kCFAllocatorDefault, kCFNumberSInt32Type, &theAudibleState);
                 outDataSize = sizeof(CFNumberRef);
@@ -1000,6 +1101,123 @@ void	BGM_Device::Device_GetPropertyData(AudioObjectID inObjectID, pid_t inClient
             }
             break;
 
+        case kAudioDeviceCustomPropertyMixMinusApps:
+            {
+                ThrowIf(inDataSize < sizeof(CFArrayRef), CAException(kAudioHardwareBadPropertySizeError), "BGM_Device::Device_GetPropertyData: not enough space for the return value of kAudioDeviceCustomPropertyMixMinusApps for the device");
+                CAMutex::Locker theStateLocker(mStateMutex);
+                *reinterpret_cast<CFArrayRef*>(outData) = mClients.CopyMixMinusAppsAsArray().GetCFArray();
+                outDataSize = sizeof(CFArrayRef);
+            }
+            break;
+
+        case kAudioDeviceCustomPropertyCaptureFilters:
+            {
+                ThrowIf(inDataSize < sizeof(CFArrayRef), CAException(kAudioHardwareBadPropertySizeError), "BGM_Device::Device_GetPropertyData: not enough space for the return value of kAudioDeviceCustomPropertyCaptureFilters for the device");
+                CAMutex::Locker theStateLocker(mStateMutex);
+                *reinterpret_cast<CFArrayRef*>(outData) = mClients.CopyCaptureFiltersAsArray().GetCFArray();
+                outDataSize = sizeof(CFArrayRef);
+            }
+            break;
+
+        case kAudioDeviceCustomPropertyCrossfader:
+            {
+                ThrowIf(inDataSize < sizeof(CFDictionaryRef), CAException(kAudioHardwareBadPropertySizeError), "BGM_Device::Device_GetPropertyData: not enough space for the return value of kAudioDeviceCustomPropertyCrossfader for the device");
+                CAMutex::Locker theStateLocker(mStateMutex);
+                *reinterpret_cast<CFDictionaryRef*>(outData) = mClients.CopyCrossfaderAsDictionary().GetDict();
+                outDataSize = sizeof(CFDictionaryRef);
+            }
+            break;
+
+        case kAudioDeviceCustomPropertyAppAutomation:
+            {
+                ThrowIf(inDataSize < sizeof(CFArrayRef), CAException(kAudioHardwareBadPropertySizeError), "BGM_Device::Device_GetPropertyData: not enough space for the return value of kAudioDeviceCustomPropertyAppAutomation for the device");
+                CAMutex::Locker theStateLocker(mStateMutex);
+                *reinterpret_cast<CFArrayRef*>(outData) = mClients.CopyAppAutomationAsArray().GetCFArray();
+                outDataSize = sizeof(CFArrayRef);
+            }
+            break;
+
+        case kAudioDeviceCustomPropertyScene:
+            {
+                ThrowIf(inDataSize < sizeof(CFDictionaryRef), CAException(kAudioHardwareBadPropertySizeError), "BGM_Device::Device_GetPropertyData: not enough space for the return value of kAudioDeviceCustomPropertyScene for the device");
+                CAMutex::Locker theStateLocker(mStateMutex);
+                *reinterpret_cast<CFDictionaryRef*>(outData) = mClients.CopySceneAsDictionary().GetDict();
+                outDataSize = sizeof(CFDictionaryRef);
+            }
+            break;
+
+        case kAudioDeviceCustomPropertyDucking:
+            {
+                ThrowIf(inDataSize < sizeof(CFDictionaryRef), CAException(kAudioHardwareBadPropertySizeError), "BGM_Device::Device_GetPropertyData: not enough space for the return value of kAudioDeviceCustomPropertyDucking for the device");
+                CAMutex::Locker theStateLocker(mStateMutex);
+                *reinterpret_cast<CFDictionaryRef*>(outData) = mClients.CopyDuckingAsDictionary().GetDict();
+                outDataSize = sizeof(CFDictionaryRef);
+            }
+            break;
+
+        case kAudioDeviceCustomPropertyLoudness:
+            {
+                ThrowIf(inDataSize < sizeof(CFArrayRef), CAException(kAudioHardwareBadPropertySizeError), "BGM_Device::Device_GetPropertyData: not enough space for the return value of kAudioDeviceCustomPropertyLoudness for the device");
+                // The meters' values are atomic, so this doesn't need the state mutex.
+                *reinterpret_cast<CFArrayRef*>(outData) = mClients.CopyLoudnessAsArray().GetCFArray();
+                outDataSize = sizeof(CFArrayRef);
+            }
+            break;
+
+        case kAudioDeviceCustomPropertyLoudnessNormalization:
+            {
+                ThrowIf(inDataSize < sizeof(CFDictionaryRef), CAException(kAudioHardwareBadPropertySizeError), "BGM_Device::Device_GetPropertyData: not enough space for the return value of kAudioDeviceCustomPropertyLoudnessNormalization for the device");
+                CAMutex::Locker theStateLocker(mStateMutex);
+                *reinterpret_cast<CFDictionaryRef*>(outData) = mClients.CopyLoudnessNormalizationAsDictionary().GetDict();
+                outDataSize = sizeof(CFDictionaryRef);
+            }
+            break;
+
+        case kAudioDeviceCustomPropertyIOTrace:
+            {
+                ThrowIf(inDataSize < sizeof(CFDictionaryRef), CAException(kAudioHardwareBadPropertySizeError), "BGM_Device::Device_GetPropertyData: not enough space for the return value of kAudioDeviceCustomPropertyIOTrace for the device");
+                CACFDictionary theIOTrace(false);
+                theIOTrace.AddCString(CFSTR(kBGMIOTraceKey_Path), mIOTraceRecorder.GetPath().c_str());
+                theIOTrace.AddBool(CFSTR(kBGMIOTraceKey_RecordAudio), mIOTraceRecorder.IsRecordingAudio());
+                theIOTrace.AddSInt32(CFSTR(kBGMIOTraceKey_DroppedRecords),
+                                     static_cast<SInt32>(mIOTraceRecorder.GetDroppedRecordCount()));
+                *reinterpret_cast<CFDictionaryRef*>(outData) = theIOTrace.GetDict();
+                outDataSize = sizeof(CFDictionaryRef);
+            }
+            break;
+
+        case kAudioDeviceCustomPropertyGlitchTelemetry:
+            {
+                ThrowIf(inDataSize < sizeof(CFDictionaryRef), CAException(kAudioHardwareBadPropertySizeError), "BGM_Device::Device_GetPropertyData: not enough space for the return value of kAudioDeviceCustomPropertyGlitchTelemetry for the device");
+                // The counters are atomic, so this doesn't need the state mutex.
+                BGM_GlitchTelemetrySnapshot theSnapshot = mIOPipeline.GetGlitchTelemetry().GetSnapshot();
+                *reinterpret_cast<CFDictionaryRef*>(outData) =
+                        BGM_GlitchTelemetry::CopyAsDictionary(theSnapshot).GetDict();
+                outDataSize = sizeof(CFDictionaryRef);
+            }
+            break;
+
+        case kAudioDeviceCustomPropertyAppPriorities:
+            {
+                ThrowIf(inDataSize < sizeof(CFArrayRef), CAException(kAudioHardwareBadPropertySizeError), "BGM_Device::Device_GetPropertyData: not enough space for the return value of kAudioDeviceCustomPropertyAppPriorities for the device");
+                CAMutex::Locker theStateLocker(mStateMutex);
+                *reinterpret_cast<CFArrayRef*>(outData) = mClients.CopyAppPrioritiesAsArray().GetCFArray();
+                outDataSize = sizeof(CFArrayRef);
+            }
+            break;
+
+        case kAudioDeviceCustomPropertyDSPOffloadWorkers:
+            {
+                ThrowIf(inDataSize < sizeof(CFNumberRef), CAException(kAudioHardwareBadPropertySizeError), "BGM_Device::Device_GetPropertyData: not enough space for the return value of kAudioDeviceCustomPropertyDSPOffloadWorkers for the device");
+                // The workers are only changed with the state mutex held. (See SetDSPOffloadWorkerCount.)
+                CAMutex::Locker theStateLocker(mStateMutex);
+                UInt32 theWorkerCount = mIOPipeline.GetDSPOffloadWorkerCount();
+                *reinterpret_cast<CFNumberRef*>(outData) =
+                        CFNumberCreate(kCFAllocatorDefault, kCFNumberSInt32Type, &theWorkerCount);
+                outDataSize = sizeof(CFNumberRef);
+            }
+            break;
+
         case kAudioDeviceCustomPropertyEnabledOutputControls:
             {
                 ThrowIf(inDataSize < sizeof(CFArrayRef), CAException(kAudioHardwareBadPropertySizeError), "BGM_Device::Device_GetPropertyData: not enough space for the return value of kAudioDeviceCustomPropertyEnabledOutputControls for the device");
@@ -1165,6 +1383,416 @@ void	BGM_Device::Device_SetPropertyData(AudioObjectID inObjectID, pid_t inClient
             }
             break;
 
+        case kAudioDeviceCustomPropertyMixMinusApps:
+            {
+                ThrowIf(inDataSize < sizeof(CFArrayRef), CAException(kAudioHardwareBadPropertySizeError), "BGM_Device::Device_SetPropertyData: wrong size for the data for kAudioDeviceCustomPropertyMixMinusApps");
+                
+                CFArrayRef arrayRef = *reinterpret_cast<const CFArrayRef*>(inData);
+
+                ThrowIfNULL(arrayRef, CAException(kAudioHardwareIllegalOperationError), "BGM_Device::Device_SetPropertyData: kAudioDeviceCustomPropertyMixMinusApps cannot be set to NULL");
+                ThrowIf(CFGetTypeID(arrayRef) != CFArrayGetTypeID(), CAException(kAudioHardwareIllegalOperationError), "BGM_Device::Device_SetPropertyData: CFType given for kAudioDeviceCustomPropertyMixMinusApps was not a CFArray");
+                
+                CACFArray array(arrayRef, false);
+
+                bool propertyWasChanged = false;
+
+                CAMutex::Locker theStateLocker(mStateMutex);
+
+                try
+                {
+                    propertyWasChanged = mClients.SetMixMinusApps(array);
+                }
+                catch(BGM_InvalidClientException)
+                {
+                    Throw(CAException(kAudioHardwareIllegalOperationError));
+                }
+                
+                if(propertyWasChanged)
+                {
+                    // Send notification
+                    CADispatchQueue::GetGlobalSerialQueue().Dispatch(false, ^{
+                        AudioObjectPropertyAddress theChangedProperties[] = { kBGMMixMinusAppsAddress };
+                        BGM_PlugIn::Host_PropertiesChanged(inObjectID, 1, theChangedProperties);
+                    });
+                }
+            }
+            break;
+
+        case kAudioDeviceCustomPropertyCaptureFilters:
+            {
+                ThrowIf(inDataSize < sizeof(CFArrayRef), CAException(kAudioHardwareBadPropertySizeError), "BGM_Device::Device_SetPropertyData: wrong size for the data for kAudioDeviceCustomPropertyCaptureFilters");
+                
+                CFArrayRef arrayRef = *reinterpret_cast<const CFArrayRef*>(inData);
+
+                ThrowIfNULL(arrayRef, CAException(kAudioHardwareIllegalOperationError), "BGM_Device::Device_SetPropertyData: kAudioDeviceCustomPropertyCaptureFilters cannot be set to NULL");
+                ThrowIf(CFGetTypeID(arrayRef) != CFArrayGetTypeID(), CAException(kAudioHardwareIllegalOperationError), "BGM_Device::Device_SetPropertyData: CFType given for kAudioDeviceCustomPropertyCaptureFilters was not a CFArray");
+                
+                CACFArray array(arrayRef, false);
+
+                bool propertyWasChanged = false;
+
+                CAMutex::Locker theStateLocker(mStateMutex);
+
+                try
+                {
+                    propertyWasChanged = mClients.SetCaptureFilters(array);
+                }
+                catch(BGM_InvalidClientException)
+                {
+                    Throw(CAException(kAudioHardwareIllegalOperationError));
+                }
+                
+                if(propertyWasChanged)
+                {
+                    // Send notification
+                    CADispatchQueue::GetGlobalSerialQueue().Dispatch(false, ^{
+                        AudioObjectPropertyAddress theChangedProperties[] = { kBGMCaptureFiltersAddress };
+                        BGM_PlugIn::Host_PropertiesChanged(inObjectID, 1, theChangedProperties);
+                    });
+                }
+            }
+            break;
+
+        case kAudioDeviceCustomPropertyCrossfader:
+            {
+                ThrowIf(inDataSize < sizeof(CFDictionaryRef), CAException(kAudioHardwareBadPropertySizeError), "BGM_Device::Device_SetPropertyData: wrong size for the data for kAudioDeviceCustomPropertyCrossfader");
+                
+                CFDictionaryRef dictRef = *reinterpret_cast<const CFDictionaryRef*>(inData);
+
+                ThrowIfNULL(dictRef, CAException(kAudioHardwareIllegalOperationError), "BGM_Device::Device_SetPropertyData: kAudioDeviceCustomPropertyCrossfader cannot be set to NULL");
+                ThrowIf(CFGetTypeID(dictRef) != CFDictionaryGetTypeID(), CAException(kAudioHardwareIllegalOperationError), "BGM_Device::Device_SetPropertyData: CFType given for kAudioDeviceCustomPropertyCrossfader was not a CFDictionary");
+                
+                CACFDictionary dict(dictRef, false);
+
+                bool propertyWasChanged = false;
+
+                // Only the crossfader ramps' target gains are changed when it's moved, so this
+                // doesn't need to stop IO or update the client maps.
+                CAMutex::Locker theStateLocker(mStateMutex);
+
+                try
+                {
+                    propertyWasChanged = mClients.SetCrossfader(dict);
+                }
+                catch(BGM_InvalidClientException)
+                {
+                    Throw(CAException(kAudioHardwareIllegalOperationError));
+                }
+                
+                if(propertyWasChanged)
+                {
+                    // Send notification
+                    CADispatchQueue::GetGlobalSerialQueue().Dispatch(false, ^{
+                        AudioObjectPropertyAddress theChangedProperties[] = { kBGMCrossfaderAddress };
+                        BGM_PlugIn::Host_PropertiesChanged(inObjectID, 1, theChangedProperties);
+                    });
+                }
+            }
+            break;
+
+        case kAudioDeviceCustomPropertyAppAutomation:
+            {
+                ThrowIf(inDataSize < sizeof(CFArrayRef), CAException(kAudioHardwareBadPropertySizeError), "BGM_Device::Device_SetPropertyData: wrong size for the data for kAudioDeviceCustomPropertyAppAutomation");
+                
+                CFArrayRef arrayRef = *reinterpret_cast<const CFArrayRef*>(inData);
+
+                ThrowIfNULL(arrayRef, CAException(kAudioHardwareIllegalOperationError), "BGM_Device::Device_SetPropertyData: kAudioDeviceCustomPropertyAppAutomation cannot be set to NULL");
+                ThrowIf(CFGetTypeID(arrayRef) != CFArrayGetTypeID(), CAException(kAudioHardwareIllegalOperationError), "BGM_Device::Device_SetPropertyData: CFType given for kAudioDeviceCustomPropertyAppAutomation was not a CFArray");
+                
+                CACFArray array(arrayRef, false);
+
+                bool propertyWasChanged = false;
+
+                // The events are passed to the IO thread through the clients' lock-free queues, so
+                // this doesn't need to stop IO.
+                CAMutex::Locker theStateLocker(mStateMutex);
+
+                try
+                {
+                    propertyWasChanged = mClients.SetAppAutomation(array);
+                }
+                catch(BGM_InvalidClientException)
+                {
+                    Throw(CAException(kAudioHardwareIllegalOperationError));
+                }
+                
+                if(propertyWasChanged)
+                {
+                    // Send notification
+                    CADispatchQueue::GetGlobalSerialQueue().Dispatch(false, ^{
+                        AudioObjectPropertyAddress theChangedProperties[] = { kBGMAppAutomationAddress };
+                        BGM_PlugIn::Host_PropertiesChanged(inObjectID, 1, theChangedProperties);
+                    });
+                }
+            }
+            break;
+
+        case kAudioDeviceCustomPropertyScene:
+            {
+                ThrowIf(inDataSize < sizeof(CFDictionaryRef), CAException(kAudioHardwareBadPropertySizeError), "BGM_Device::Device_SetPropertyData: wrong size for the data for kAudioDeviceCustomPropertyScene");
+                
+                CFDictionaryRef dictRef = *reinterpret_cast<const CFDictionaryRef*>(inData);
+
+                ThrowIfNULL(dictRef, CAException(kAudioHardwareIllegalOperationError), "BGM_Device::Device_SetPropertyData: kAudioDeviceCustomPropertyScene cannot be set to NULL");
+                ThrowIf(CFGetTypeID(dictRef) != CFDictionaryGetTypeID(), CAException(kAudioHardwareIllegalOperationError), "BGM_Device::Device_SetPropertyData: CFType given for kAudioDeviceCustomPropertyScene was not a CFDictionary");
+                
+                CACFDictionary dict(dictRef, false);
+
+                bool propertyWasChanged = false;
+
+                // The scene is staged on this thread and published with the client maps, so this
+                // doesn't need to stop IO.
+                CAMutex::Locker theStateLocker(mStateMutex);
+
+                try
+                {
+                    propertyWasChanged = mClients.SetScene(dict);
+                }
+                catch(BGM_InvalidClientException)
+                {
+                    Throw(CAException(kAudioHardwareIllegalOperationError));
+                }
+                catch(BGM_InvalidClientPIDException)
+                {
+                    Throw(CAException(kAudioHardwareIllegalOperationError));
+                }
+                catch(BGM_InvalidClientRelativeVolumeException)
+                {
+                    Throw(CAException(kAudioHardwareIllegalOperationError));
+                }
+                catch(BGM_InvalidClientPanPositionException)
+                {
+                    Throw(CAException(kAudioHardwareIllegalOperationError));
+                }
+                
+                if(propertyWasChanged)
+                {
+                    // Send notifications for the scene and the properties it covers
+                    CADispatchQueue::GetGlobalSerialQueue().Dispatch(false, ^{
+                        AudioObjectPropertyAddress theChangedProperties[] = {
+                            kBGMSceneAddress,
+                            kBGMAppVolumesAddress,
+                            kBGMAppRoutingAddress,
+                            kBGMMusicPlayerProcessIDAddress,
+                            kBGMMusicPlayerBundleIDAddress
+                        };
+                        BGM_PlugIn::Host_PropertiesChanged(inObjectID, 5, theChangedProperties);
+                    });
+                }
+            }
+            break;
+
+        case kAudioDeviceCustomPropertyDucking:
+            {
+                ThrowIf(inDataSize < sizeof(CFDictionaryRef), CAException(kAudioHardwareBadPropertySizeError), "BGM_Device::Device_SetPropertyData: wrong size for the data for kAudioDeviceCustomPropertyDucking");
+                
+                CFDictionaryRef dictRef = *reinterpret_cast<const CFDictionaryRef*>(inData);
+
+                ThrowIfNULL(dictRef, CAException(kAudioHardwareIllegalOperationError), "BGM_Device::Device_SetPropertyData: kAudioDeviceCustomPropertyDucking cannot be set to NULL");
+                ThrowIf(CFGetTypeID(dictRef) != CFDictionaryGetTypeID(), CAException(kAudioHardwareIllegalOperationError), "BGM_Device::Device_SetPropertyData: CFType given for kAudioDeviceCustomPropertyDucking was not a CFDictionary");
+                
+                CACFDictionary dict(dictRef, false);
+
+                bool propertyWasChanged = false;
+
+                // Like the crossfader, the ducking envelope's settings are lock-free and the clients'
+                // roles are published with the client maps, so this doesn't need to stop IO.
+                CAMutex::Locker theStateLocker(mStateMutex);
+
+                try
+                {
+                    propertyWasChanged = mClients.SetDucking(dict);
+                }
+                catch(BGM_InvalidClientException)
+                {
+                    Throw(CAException(kAudioHardwareIllegalOperationError));
+                }
+                
+                if(propertyWasChanged)
+                {
+                    // Send notification
+                    CADispatchQueue::GetGlobalSerialQueue().Dispatch(false, ^{
+                        AudioObjectPropertyAddress theChangedProperties[] = { kBGMDuckingAddress };
+                        BGM_PlugIn::Host_PropertiesChanged(inObjectID, 1, theChangedProperties);
+                    });
+                }
+            }
+            break;
+
+        case kAudioDeviceCustomPropertyLoudnessNormalization:
+            {
+                ThrowIf(inDataSize < sizeof(CFDictionaryRef), CAException(kAudioHardwareBadPropertySizeError), "BGM_Device::Device_SetPropertyData: wrong size for the data for kAudioDeviceCustomPropertyLoudnessNormalization");
+                
+                CFDictionaryRef dictRef = *reinterpret_cast<const CFDictionaryRef*>(inData);
+
+                ThrowIfNULL(dictRef, CAException(kAudioHardwareIllegalOperationError), "BGM_Device::Device_SetPropertyData: kAudioDeviceCustomPropertyLoudnessNormalization cannot be set to NULL");
+                ThrowIf(CFGetTypeID(dictRef) != CFDictionaryGetTypeID(), CAException(kAudioHardwareIllegalOperationError), "BGM_Device::Device_SetPropertyData: CFType given for kAudioDeviceCustomPropertyLoudnessNormalization was not a CFDictionary");
+                
+                CACFDictionary dict(dictRef, false);
+
+                bool propertyWasChanged = false;
+
+                // The meters' normalization settings are lock-free, so this doesn't need to stop IO.
+                CAMutex::Locker theStateLocker(mStateMutex);
+
+                try
+                {
+                    propertyWasChanged = mClients.SetLoudnessNormalization(dict);
+                }
+                catch(BGM_InvalidClientException)
+                {
+                    Throw(CAException(kAudioHardwareIllegalOperationError));
+                }
+                
+                if(propertyWasChanged)
+                {
+                    // Send notification
+                    CADispatchQueue::GetGlobalSerialQueue().Dispatch(false, ^{
+                        AudioObjectPropertyAddress theChangedProperties[] = { kBGMLoudnessNormalizationAddress };
+                        BGM_PlugIn::Host_PropertiesChanged(inObjectID, 1, theChangedProperties);
+                    });
+                }
+            }
+            break;
+
+        case kAudioDeviceCustomPropertyIOTrace:
+            {
+                ThrowIf(inDataSize < sizeof(CFDictionaryRef), CAException(kAudioHardwareBadPropertySizeError), "BGM_Device::Device_SetPropertyData: wrong size for the data for kAudioDeviceCustomPropertyIOTrace");
+                
+                CFDictionaryRef dictRef = *reinterpret_cast<const CFDictionaryRef*>(inData);
+
+                ThrowIfNULL(dictRef, CAException(kAudioHardwareIllegalOperationError), "BGM_Device::Device_SetPropertyData: kAudioDeviceCustomPropertyIOTrace cannot be set to NULL");
+                ThrowIf(CFGetTypeID(dictRef) != CFDictionaryGetTypeID(), CAException(kAudioHardwareIllegalOperationError), "BGM_Device::Device_SetPropertyData: CFType given for kAudioDeviceCustomPropertyIOTrace was not a CFDictionary");
+                
+                CACFDictionary dict(dictRef, false);
+
+                CFStringRef thePathRef = NULL;
+                ThrowIf(!dict.GetString(CFSTR(kBGMIOTraceKey_Path), thePathRef) || thePathRef == NULL,
+                        CAException(kAudioHardwareIllegalOperationError),
+                        "BGM_Device::Device_SetPropertyData: No path given for kAudioDeviceCustomPropertyIOTrace");
+
+                bool theRecordAudio = false;
+                dict.GetBool(CFSTR(kBGMIOTraceKey_RecordAudio), theRecordAudio);
+
+                char thePath[PATH_MAX];
+                ThrowIf(!CFStringGetCString(thePathRef, thePath, sizeof(thePath), kCFStringEncodingUTF8),
+                        CAException(kAudioHardwareIllegalOperationError),
+                        "BGM_Device::Device_SetPropertyData: Invalid path given for kAudioDeviceCustomPropertyIOTrace");
+
+                // The recorder only reads the sample rate when it starts, so this doesn't need to
+                // stop IO. It records the clients added from now on, and the IO thread records the
+                // others' operations without them.
+                CAMutex::Locker theStateLocker(mStateMutex);
+
+                if(thePath[0] == '\0')
+                {
+                    mIOTraceRecorder.Stop();
+                    mIOPipeline.GetRTEventLog().StopRecording();
+                }
+                else
+                {
+                    mIOTraceRecorder.Start(thePath, theRecordAudio, GetSampleRate());
+
+                    // Record the IO thread's events next to the trace, for bgm-rt-event-decode.
+                    try
+                    {
+                        mIOPipeline.GetRTEventLog().StartRecording((std::string(thePath) + ".events").c_str());
+                    }
+                    catch(CAException e)
+                    {
+                        LogWarning("BGM_Device::Device_SetPropertyData: Couldn't record the RT events "
+                                   "for the IO trace (%d)", e.GetError());
+                    }
+                }
+
+                // Send notification
+                CADispatchQueue::GetGlobalSerialQueue().Dispatch(false, ^{
+                    AudioObjectPropertyAddress theChangedProperties[] = { kBGMIOTraceAddress };
+                    BGM_PlugIn::Host_PropertiesChanged(inObjectID, 1, theChangedProperties);
+                });
+            }
+            break;
+
+        case kAudioDeviceCustomPropertyGlitchTelemetry:
+            {
+                ThrowIf(inDataSize < sizeof(CFBooleanRef),
+                        CAException(kAudioHardwareBadPropertySizeError),
+                        "BGM_Device::Device_SetPropertyData: wrong size for the data for "
+                        "kAudioDeviceCustomPropertyGlitchTelemetry");
+
+                CFBooleanRef theResetRef = *reinterpret_cast<const CFBooleanRef*>(inData);
+
+                ThrowIf(theResetRef != kCFBooleanTrue,
+                        CAException(kAudioHardwareIllegalOperationError),
+                        "BGM_Device::Device_SetPropertyData: kAudioDeviceCustomPropertyGlitchTelemetry "
+                        "can only be set to kCFBooleanTrue");
+
+                // The counters are atomic, so this doesn't need to stop IO. A glitch counted while
+                // they're being reset might be lost.
+                mIOPipeline.GetGlitchTelemetry().Reset();
+
+                // Send notification
+                CADispatchQueue::GetGlobalSerialQueue().Dispatch(false, ^{
+                    AudioObjectPropertyAddress theChangedProperties[] = { kBGMGlitchTelemetryAddress };
+                    BGM_PlugIn::Host_PropertiesChanged(inObjectID, 1, theChangedProperties);
+                });
+            }
+            break;
+
+        case kAudioDeviceCustomPropertyAppPriorities:
+            {
+                ThrowIf(inDataSize < sizeof(CFArrayRef), CAException(kAudioHardwareBadPropertySizeError), "BGM_Device::Device_SetPropertyData: wrong size for the data for kAudioDeviceCustomPropertyAppPriorities");
+                
+                CFArrayRef arrayRef = *reinterpret_cast<const CFArrayRef*>(inData);
+
+                ThrowIfNULL(arrayRef, CAException(kAudioHardwareIllegalOperationError), "BGM_Device::Device_SetPropertyData: kAudioDeviceCustomPropertyAppPriorities cannot be set to NULL");
+                ThrowIf(CFGetTypeID(arrayRef) != CFArrayGetTypeID(), CAException(kAudioHardwareIllegalOperationError), "BGM_Device::Device_SetPropertyData: CFType given for kAudioDeviceCustomPropertyAppPriorities was not a CFArray");
+                
+                CACFArray array(arrayRef, false);
+
+                bool propertyWasChanged = false;
+
+                CAMutex::Locker theStateLocker(mStateMutex);
+
+                try
+                {
+                    propertyWasChanged = mClients.SetAppPriorities(array);
+                }
+                catch(BGM_InvalidClientException)
+                {
+                    Throw(CAException(kAudioHardwareIllegalOperationError));
+                }
+                
+                if(propertyWasChanged)
+                {
+                    // Send notification
+                    CADispatchQueue::GetGlobalSerialQueue().Dispatch(false, ^{
+                        AudioObjectPropertyAddress theChangedProperties[] = { kBGMAppPrioritiesAddress };
+                        BGM_PlugIn::Host_PropertiesChanged(inObjectID, 1, theChangedProperties);
+                    });
+                }
+            }
+            break;
+
+        case kAudioDeviceCustomPropertyDSPOffloadWorkers:
+            {
+                ThrowIf(inDataSize < sizeof(CFNumberRef), CAException(kAudioHardwareBadPropertySizeError), "BGM_Device::Device_SetPropertyData: wrong size for the data for kAudioDeviceCustomPropertyDSPOffloadWorkers");
+                
+                CFNumberRef theWorkerCountRef = *reinterpret_cast<const CFNumberRef*>(inData);
+                
+                ThrowIfNULL(theWorkerCountRef, CAException(kAudioHardwareIllegalOperationError), "BGM_Device::Device_SetPropertyData: kAudioDeviceCustomPropertyDSPOffloadWorkers cannot be set to NULL");
+                ThrowIf(CFGetTypeID(theWorkerCountRef) != CFNumberGetTypeID(), CAException(kAudioHardwareIllegalOperationError), "BGM_Device::Device_SetPropertyData: CFType given for kAudioDeviceCustomPropertyDSPOffloadWorkers was not a CFNumber");
+                
+                SInt32 theWorkerCount = -1;
+                Boolean success = CFNumberGetValue(theWorkerCountRef, kCFNumberSInt32Type, &theWorkerCount);
+                
+                ThrowIf(!success || theWorkerCount < 0, CAException(kAudioHardwareIllegalOperationError), "BGM_Device::Device_SetPropertyData: invalid worker count for kAudioDeviceCustomPropertyDSPOffloadWorkers");
+                
+                // The notification is sent once the workers have been changed.
+                RequestDSPOffloadWorkerCount(static_cast<UInt32>(theWorkerCount));
+            }
+            break;
+
         case kAudioDeviceCustomPropertyEnabledOutputControls:
             {
                 ThrowIf(inDataSize < sizeof(CFArrayRef),
@@ -1378,7 +2006,14 @@ void	BGM_Device::WillDoIOOperation(UInt32 inOperationID, bool& outWillDo, bool&
 
 void	BGM_Device::BeginIOOperation(UInt32 inOperationID, UInt32 inIOBufferFrameSize, const AudioServerPlugInIOCycleInfo& inIOCycleInfo, UInt32 inClientID)
 {
-	#pragma unused(inIOBufferFrameSize, inIOCycleInfo)
+    BGMRTScope("BGM_Device::BeginIOOperation");
+    
+    mIOTraceRecorder.RecordOperationRT(kBGMIOTraceRecordBeginOperation,
+                                       inClientID,
+                                       inOperationID,
+                                       inIOBufferFrameSize,
+                                       inIOCycleInfo,
+                                       nullptr);
     
     if(inOperationID == kAudioServerPlugInIOOperationThread)
     {
@@ -1401,59 +2036,61 @@ void	BGM_Device::DoIOOperation(AudioObjectID inStreamObjectID, UInt32 inClientID
 {
     #pragma unused(inStreamObjectID, ioSecondaryBuffer)
     
+    BGMRTScope("BGM_Device::DoIOOperation");
+    
+    // Treat subnormal floats as zero while we process the audio, since the filter states of quiet
+    // clients would otherwise decay into them and make every cycle slower on x86.
+    BGM_DSPContext theDSPContext;
+    
+    // If a trace is being recorded, record the operation with the audio it was given, or, for
+    // ReadInput, the audio it read. (See BGM_IOTrace.h.)
+    if(inOperationID != kAudioServerPlugInIOOperationReadInput)
+    {
+        mIOTraceRecorder.RecordOperationRT(kBGMIOTraceRecordDoOperation,
+                                           inClientID,
+                                           inOperationID,
+                                           inIOBufferFrameSize,
+                                           inIOCycleInfo,
+                                           reinterpret_cast<const Float32*>(ioMainBuffer));
+    }
+    
 	switch(inOperationID)
 	{
 		case kAudioServerPlugInIOOperationReadInput:
-            {
-                CAMutex::Locker theIOLocker(mIOMutex);
-
-                // Check if this client has incoming routes
-                // If so, it should receive ONLY the routed audio, not the full loopback
-                bool hasIncomingRoutes = mClients.HasIncomingRoutesRT(inClientID);
-                
-                if(hasIncomingRoutes)
-                {
-                    // Zero the buffer first, then mix in only routed audio
-                    memset(ioMainBuffer, 0, inIOBufferFrameSize * sizeof(Float32) * 2);
-                    
-                    // Mix in audio specifically routed to this client
-                    mClients.MixRoutedAudioRT(inClientID, 
-                                              reinterpret_cast<Float32*>(ioMainBuffer), 
-                                              inIOBufferFrameSize);
-                }
-                else
-                {
-                    // No incoming routes - provide the normal loopback of all apps
-                    ReadInputData(inIOBufferFrameSize,
-                                  inIOCycleInfo.mInputTime.mSampleTime,
-                                  ioMainBuffer);
-                }
-            }
+            mIOPipeline.ReadInputRT(inClientID,
+                                    inIOBufferFrameSize,
+                                    inIOCycleInfo.mInputTime.mSampleTime,
+                                    inIOCycleInfo.mOutputTime,
+                                    reinterpret_cast<Float32*>(ioMainBuffer));
+            
+            mIOTraceRecorder.RecordOperationRT(kBGMIOTraceRecordDoOperation,
+                                               inClientID,
+                                               inOperationID,
+                                               inIOBufferFrameSize,
+                                               inIOCycleInfo,
+                                               reinterpret_cast<const Float32*>(ioMainBuffer));
 			break;
             
         case kAudioServerPlugInIOOperationProcessOutput:
+            // Classify, measure and store the client's audio, then apply its volume, pan, EQ, etc.
+            if(mIOPipeline.ProcessOutputRT(inClientID,
+                                           inIOBufferFrameSize,
+                                           inIOCycleInfo.mOutputTime,
+                                           reinterpret_cast<Float32*>(ioMainBuffer)))
             {
-                bool theClientIsMusicPlayer = mClients.IsMusicPlayerRT(inClientID);
-                
-                CAMutex::Locker theIOLocker(mIOMutex);
-                // Called in this IO operation so we can get the music player client's data separately
-				mAudibleState.UpdateWithClientIO(theClientIsMusicPlayer,
-												 inIOBufferFrameSize,
-												 inIOCycleInfo.mOutputTime.mSampleTime,
-												 reinterpret_cast<const Float32*>(ioMainBuffer));
-                
-                // Store this client's audio to its routing buffer BEFORE volume is applied
-                // This ensures routed audio has full signal even when volume to master is 0
-                // We always store - the routing decision is made in ReadInput
-                mClients.StoreClientAudioRT(inClientID, 
-                                            reinterpret_cast<const Float32*>(ioMainBuffer), 
-                                            inIOBufferFrameSize);
-                
-                // NOTE: Do NOT mix routed audio here! ProcessOutput is the app's OUTPUT to master.
-                // Routed audio is delivered via ReadInput (the app's INPUT from driver).
+                // The DSP is offloaded and the IO buffer size changed, which changes how late the
+                // clients' output is played.
+                mOutputStream.SetLatency(mIOPipeline.GetDSPOffloadLatencyFrames());
+                mTaskQueue.QueueAsync_SendPropertyNotification(kAudioStreamPropertyLatency,
+                                                               mOutputStream.GetObjectID());
             }
-            // Apply volume, pan, and EQ to this client's audio (for master output)
-            ApplyClientRelativeVolume(inClientID, inIOBufferFrameSize, ioMainBuffer);
+            
+            mIOTraceRecorder.RecordOperationRT(kBGMIOTraceRecordOperationResult,
+                                               inClientID,
+                                               inOperationID,
+                                               inIOBufferFrameSize,
+                                               inIOCycleInfo,
+                                               reinterpret_cast<const Float32*>(ioMainBuffer));
             break;
 
         case kAudioServerPlugInIOOperationProcessMix:
@@ -1475,13 +2112,11 @@ void	BGM_Device::DoIOOperation(AudioObjectID inStreamObjectID, UInt32 inClientID
 
         case kAudioServerPlugInIOOperationWriteMix:
             {
-                CAMutex::Locker theIOLocker(mIOMutex);
-
+                // Copy the mixed audio into the loopback buffer and update the audible state.
                 bool didChangeState =
-                        mAudibleState.UpdateWithMixedIO(
-                                inIOBufferFrameSize,
-                                inIOCycleInfo.mOutputTime.mSampleTime,
-                                reinterpret_cast<const Float32*>(ioMainBuffer));
+                        mIOPipeline.WriteMixRT(inIOBufferFrameSize,
+                                               inIOCycleInfo.mOutputTime.mSampleTime,
+                                               reinterpret_cast<const Float32*>(ioMainBuffer));
 
                 if(didChangeState)
                 {
@@ -1490,23 +2125,42 @@ void	BGM_Device::DoIOOperation(AudioObjectID inStreamObjectID, UInt32 inClientID
 							kAudioDeviceCustomPropertyDeviceAudibleState, GetObjectID());
                 }
 
-                // Copy the audio data into our ring buffer.
-                WriteOutputData(inIOBufferFrameSize,
-                                inIOCycleInfo.mOutputTime.mSampleTime,
-                                ioMainBuffer);
+                // The cycle is late if its mix is only being written after the HAL expected to
+                // start playing it.
+                BGM_GlitchTelemetry& theGlitchTelemetry = mIOPipeline.GetGlitchTelemetry();
+                const UInt64 theNow = CAHostTimeBase::GetTheCurrentTime();
+
+                if((inIOCycleInfo.mOutputTime.mFlags & kAudioTimeStampHostTimeValid) &&
+                   theNow > inIOCycleInfo.mOutputTime.mHostTime)
+                {
+                    theGlitchTelemetry.CountRT(kBGMGlitchLateCycle, theNow);
+                }
+
+                theGlitchTelemetry.RecordOffsetRT(inIOCycleInfo.mOutputTime.mSampleTime -
+                                                  inIOCycleInfo.mInputTime.mSampleTime);
             }
 			break;
 
 		default:
-            // Note that this will only log the error in debug builds.
-			DebugMsg("BGM_Device::DoIOOperation: Unexpected IO operation: %u", inOperationID);
+            // Note that this will only print the message in debug builds.
+            mIOPipeline.GetRTEventLog().LogRT(0,
+                                              kBGMIOPipelineRTEventUnexpectedIOOperation,
+                                              inOperationID,
+                                              inClientID);
 			break;
 	};
 }
 
 void	BGM_Device::EndIOOperation(UInt32 inOperationID, UInt32 inIOBufferFrameSize, const AudioServerPlugInIOCycleInfo& inIOCycleInfo, UInt32 inClientID)
 {
-    #pragma unused(inIOBufferFrameSize, inIOCycleInfo)
+    BGMRTScope("BGM_Device::EndIOOperation");
+    
+    mIOTraceRecorder.RecordOperationRT(kBGMIOTraceRecordEndOperation,
+                                       inClientID,
+                                       inOperationID,
+                                       inIOBufferFrameSize,
+                                       inIOCycleInfo,
+                                       nullptr);
 
     if(inOperationID == kAudioServerPlugInIOOperationThread)
     {
@@ -1518,179 +2172,6 @@ void	BGM_Device::EndIOOperation(UInt32 inOperationID, UInt32 inIOBufferFrameSize
     }
 }
 
-void	BGM_Device::ReadInputData(UInt32 inIOBufferFrameSize, Float64 inSampleTime, void* outBuffer)
-{
-    // Wrap the provided buffer in an AudioBufferList.
-    AudioBufferList abl = {
-        .mNumberBuffers = 1,
-        .mBuffers[0] = {
-            .mNumberChannels = 2,
-            // Each frame is 2 Float32 samples (one per channel). The number of frames * the number
-            // of bytes per frame = the size of outBuffer in bytes.
-            .mDataByteSize = static_cast<UInt32>(inIOBufferFrameSize * sizeof(Float32) * 2),
-            .mData = outBuffer
-        }
-    };
-
-    // Copy the audio data from our ring buffer into the provided buffer.
-    CARingBufferError err =
-            mLoopbackRingBuffer.Fetch(&abl,
-                                      inIOBufferFrameSize,
-                                      static_cast<CARingBuffer::SampleTime>(inSampleTime));
-
-    // Handle errors.
-    switch (err)
-    {
-        case kCARingBufferError_CPUOverload:
-            // Write silence to the buffer.
-            memset(outBuffer, 0, abl.mBuffers[0].mDataByteSize);
-            break;
-        case kCARingBufferError_TooMuch:
-            // Should be impossible, but handle it just in case. Write silence to the buffer and
-            // return an error code.
-            memset(outBuffer, 0, abl.mBuffers[0].mDataByteSize);
-            Throw(CAException(kAudioHardwareIllegalOperationError));
-        case kCARingBufferError_OK:
-            break;
-        default:
-            throw CAException(kAudioHardwareUnspecifiedError);
-    }
-}
-
-void	BGM_Device::WriteOutputData(UInt32 inIOBufferFrameSize, Float64 inSampleTime, const void* inBuffer)
-{
-    // Wrap the provided buffer in an AudioBufferList.
-    AudioBufferList abl = {
-        .mNumberBuffers = 1,
-        .mBuffers[0] = {
-            .mNumberChannels = 2,
-            // Each frame is 2 Float32 samples (one per channel). The number of frames * the number
-            // of bytes per frame = the size of inBuffer in bytes.
-            .mDataByteSize = static_cast<UInt32>(inIOBufferFrameSize * sizeof(Float32) * 2),
-            .mData = const_cast<void *>(inBuffer)
-        }
-    };
-
-    // Copy the audio data from the provided buffer into our ring buffer.
-    CARingBufferError err =
-            mLoopbackRingBuffer.Store(&abl,
-                                      inIOBufferFrameSize,
-                                      static_cast<CARingBuffer::SampleTime>(inSampleTime));
-
-    // Return an error code if we failed to store the data. (But ignore CPU overload, which would be
-    // temporary.)
-    if (err != kCARingBufferError_OK && err != kCARingBufferError_CPUOverload)
-    {
-        Throw(CAException(err));
-    }
-}
-
-void	BGM_Device::ApplyClientRelativeVolume(UInt32 inClientID, UInt32 inIOBufferFrameSize, void* ioBuffer) const
-{
-    Float32* theBuffer = reinterpret_cast<Float32*>(ioBuffer);
-    Float32 theRelativeVolume = mClients.GetClientRelativeVolumeRT(inClientID);
-    
-    auto thePanPositionInt = mClients.GetClientPanPositionRT(inClientID);
-    Float32 thePanPosition = static_cast<Float32>(thePanPositionInt) / 100.0f;
-    
-    // Apply per-client 3-band EQ (before volume and pan)
-    BGM_Client* theClient = mClients.GetClientForEQRT(inClientID);
-    if (theClient != nullptr)
-    {
-        // Check if any EQ band is active (non-zero)
-        bool hasEQ = (theClient->mEQLowGain != 0.0f || 
-                      theClient->mEQMidGain != 0.0f || 
-                      theClient->mEQHighGain != 0.0f);
-        
-        if (hasEQ)
-        {
-            // Process each frame through the 3-band EQ (interleaved stereo)
-            for (UInt32 frame = 0; frame < inIOBufferFrameSize; frame++)
-            {
-                UInt32 L = frame * 2;
-                UInt32 R = L + 1;
-                
-                Float32 left = theBuffer[L];
-                Float32 right = theBuffer[R];
-                
-                // Low shelf filter
-                Float32 outL = theClient->mEQLowCoeffs[0] * left + theClient->mEQLowDelayL[0];
-                theClient->mEQLowDelayL[0] = theClient->mEQLowCoeffs[1] * left - theClient->mEQLowCoeffs[3] * outL + theClient->mEQLowDelayL[1];
-                theClient->mEQLowDelayL[1] = theClient->mEQLowCoeffs[2] * left - theClient->mEQLowCoeffs[4] * outL;
-                left = outL;
-                
-                Float32 outR = theClient->mEQLowCoeffs[0] * right + theClient->mEQLowDelayR[0];
-                theClient->mEQLowDelayR[0] = theClient->mEQLowCoeffs[1] * right - theClient->mEQLowCoeffs[3] * outR + theClient->mEQLowDelayR[1];
-                theClient->mEQLowDelayR[1] = theClient->mEQLowCoeffs[2] * right - theClient->mEQLowCoeffs[4] * outR;
-                right = outR;
-                
-                // Mid peak filter
-                outL = theClient->mEQMidCoeffs[0] * left + theClient->mEQMidDelayL[0];
-                theClient->mEQMidDelayL[0] = theClient->mEQMidCoeffs[1] * left - theClient->mEQMidCoeffs[3] * outL + theClient->mEQMidDelayL[1];
-                theClient->mEQMidDelayL[1] = theClient->mEQMidCoeffs[2] * left - theClient->mEQMidCoeffs[4] * outL;
-                left = outL;
-                
-                outR = theClient->mEQMidCoeffs[0] * right + theClient->mEQMidDelayR[0];
-                theClient->mEQMidDelayR[0] = theClient->mEQMidCoeffs[1] * right - theClient->mEQMidCoeffs[3] * outR + theClient->mEQMidDelayR[1];
-                theClient->mEQMidDelayR[1] = theClient->mEQMidCoeffs[2] * right - theClient->mEQMidCoeffs[4] * outR;
-                right = outR;
-                
-                // High shelf filter
-                outL = theClient->mEQHighCoeffs[0] * left + theClient->mEQHighDelayL[0];
-                theClient->mEQHighDelayL[0] = theClient->mEQHighCoeffs[1] * left - theClient->mEQHighCoeffs[3] * outL + theClient->mEQHighDelayL[1];
-                theClient->mEQHighDelayL[1] = theClient->mEQHighCoeffs[2] * left - theClient->mEQHighCoeffs[4] * outL;
-                left = outL;
-                
-                outR = theClient->mEQHighCoeffs[0] * right + theClient->mEQHighDelayR[0];
-                theClient->mEQHighDelayR[0] = theClient->mEQHighCoeffs[1] * right - theClient->mEQHighCoeffs[3] * outR + theClient->mEQHighDelayR[1];
-                theClient->mEQHighDelayR[1] = theClient->mEQHighCoeffs[2] * right - theClient->mEQHighCoeffs[4] * outR;
-                right = outR;
-                
-                theBuffer[L] = left;
-                theBuffer[R] = right;
-            }
-        }
-    }
-    
-    // TODO When we get around to supporting devices with more than two channels it would be worth looking into
-    //      kAudioFormatProperty_PanningMatrix and kAudioFormatProperty_BalanceFade in AudioFormat.h.
-    
-    // TODO precompute matrix coefficients w/ volume and do everything in one pass
-    
-    // Apply balance w/ crossfeed to the frames in the buffer.
-    // Expect samples interleaved, starting with left
-    if (thePanPosition > 0.0f) {
-        for (UInt32 i = 0; i < inIOBufferFrameSize * 2; i += 2) {
-            auto L = i;
-            auto R = i + 1;
-            
-            theBuffer[R] = theBuffer[R] + theBuffer[L] * thePanPosition;
-            theBuffer[L] = theBuffer[L] * (1 - thePanPosition);
-        }
-    } else if (thePanPosition < 0.0f) {
-        for (UInt32 i = 0; i < inIOBufferFrameSize * 2; i += 2) {
-            auto L = i;
-            auto R = i + 1;
-            
-            theBuffer[L] = theBuffer[L] + theBuffer[R] * (-thePanPosition);
-            theBuffer[R] = theBuffer[R] * (1 + thePanPosition);
-        }
-    }
-
-    if(theRelativeVolume != 1.0f)
-    {
-        for(UInt32 i = 0; i < inIOBufferFrameSize * 2; i++)
-        {
-            Float32 theAdjustedSample = theBuffer[i] * theRelativeVolume;
-            
-            // Clamp to [-1, 1].
-            // (This way is roughly 6 times faster than using std::min and std::max because the compiler can vectorize the loop.)
-            const Float32 theAdjustedSampleClippedBelow = theAdjustedSample < -1.0f ? -1.0f : theAdjustedSample;
-            theBuffer[i] = theAdjustedSampleClippedBelow > 1.0f ? 1.0f : theAdjustedSampleClippedBelow;
-        }
-    }
-}
-
 #pragma mark Accessors
 
 void    BGM_Device::RequestEnabledControls(bool inVolumeEnabled, bool inMuteEnabled)
@@ -1777,6 +2258,31 @@ void	BGM_Device::RequestSampleRate(Float64 inRequestedSampleRate)
     }
 }
 
+void	BGM_Device::RequestDSPOffloadWorkerCount(UInt32 inWorkerCount)
+{
+    ThrowIf(inWorkerCount > kBGMMaxDSPOffloadWorkers,
+            CAException(kAudioHardwareIllegalOperationError),
+            "BGM_Device::RequestDSPOffloadWorkerCount: too many workers");
+
+    CAMutex::Locker theStateLocker(mStateMutex);
+
+    if(inWorkerCount != mIOPipeline.GetDSPOffloadWorkerCount())
+    {
+        DebugMsg("BGM_Device::RequestDSPOffloadWorkerCount: Requesting %u workers", inWorkerCount);
+
+        mPendingDSPOffloadWorkerCount = inWorkerCount;
+
+        // Ask the host to stop IO so the workers can be changed. See
+        // RequestDeviceConfigurationChange in AudioServerPlugIn.h.
+        AudioObjectID theDeviceObjectID = GetObjectID();
+        UInt64 action = static_cast<UInt64>(ChangeAction::SetDSPOffloadWorkers);
+
+        CADispatchQueue::GetGlobalSerialQueue().Dispatch(false, ^{
+            BGM_PlugIn::Host_RequestDeviceConfigurationChange(theDeviceObjectID, action, nullptr);
+        });
+    }
+}
+
 BGM_Object&  BGM_Device::GetOwnedObjectByID(AudioObjectID inObjectID)
 {
 	// C++ is weird. See "Avoid Duplication in const and Non-const Member Functions" in Item 3 of Effective C++.
@@ -1837,6 +2343,36 @@ UInt32	BGM_Device::GetNumberOfOutputControls() const
     return theAnswer;
 }
 
+void    BGM_Device::SetDSPOffloadWorkerCount(UInt32 inWorkerCount)
+{
+    CAMutex::Locker theStateLocker(mStateMutex);
+
+    if(inWorkerCount != mIOPipeline.GetDSPOffloadWorkerCount())
+    {
+        DebugMsg("BGM_Device::SetDSPOffloadWorkerCount: Offloading the DSP to %u workers",
+                 inWorkerCount);
+
+        mIOPipeline.SetDSPOffloadWorkerCount(inWorkerCount);
+
+        // The offloaded DSP plays the clients' output one IO buffer late, so report that as the
+        // output stream's latency while there are workers.
+        mOutputStream.SetLatency(mIOPipeline.GetDSPOffloadLatencyFrames());
+
+        AudioObjectID theDeviceObjectID = GetObjectID();
+        AudioObjectID theOutputStreamObjectID = mOutputStream.GetObjectID();
+
+        CADispatchQueue::GetGlobalSerialQueue().Dispatch(false, ^{
+            AudioObjectPropertyAddress theChangedProperties[] = { kBGMDSPOffloadWorkersAddress };
+            BGM_PlugIn::Host_PropertiesChanged(theDeviceObjectID, 1, theChangedProperties);
+
+            AudioObjectPropertyAddress theChangedStreamProperties[] = {
+                { kAudioStreamPropertyLatency, kAudioObjectPropertyScopeGlobal, kAudioObjectPropertyElementMaster }
+            };
+            BGM_PlugIn::Host_PropertiesChanged(theOutputStreamObjectID, 1, theChangedStreamProperties);
+        });
+    }
+}
+
 void    BGM_Device::SetEnabledControls(bool inVolumeEnabled, bool inMuteEnabled)
 {
     CAMutex::Locker theStateLocker(mStateMutex);
@@ -1906,6 +2442,13 @@ void BGM_Device::SetSampleRate(Float64 inSampleRate, bool force)
         // Update the streams.
         mInputStream.SetSampleRate(inSampleRate);
         mOutputStream.SetSampleRate(inSampleRate);
+
+        // Update the volume control, which uses the sample rate to time its volume changes.
+        mVolumeControl.SetSampleRate(inSampleRate);
+
+        // And the clients, for the crossfader's fades.
+        mClients.SetSampleRate(inSampleRate);
+        mIOPipeline.SetSampleRate(inSampleRate);
     }
     else
     {
@@ -1942,11 +2485,15 @@ kern_return_t	BGM_Device::_HW_StartIO()
     // Reset the loopback timing values
     mLoopbackTime.numberTimeStamps = 0;
     mLoopbackTime.anchorHostTime = CAHostTimeBase::GetTheCurrentTime();
-    // ...and the most-recent audible/silent sample times. mAudibleState is usually guarded by the
-	// IO mutex, but we haven't started IO yet (and this function can only be called by one thread
-	// at a time).
+    // ...and the most-recent audible/silent sample times. The audible state is usually guarded by
+	// the IO mutex, but we haven't started IO yet (and this function can only be called by one
+	// thread at a time).
 	BGMAssert(mIOMutex.IsFree(), "BGM_Device::_HW_StartIO: IO mutex taken before starting IO");
-    mAudibleState.Reset();
+    mIOPipeline.ResetAudibleState();
+    // The cycles timed before IO stopped don't say anything about the ones to come.
+    mIOPipeline.GetDSPBudget().Reset();
+    // And the clients' offloaded audio from before IO stopped shouldn't be played now.
+    mIOPipeline.ResetDSPOffload();
     
     return KERN_SUCCESS;
 }
@@ -1996,6 +2543,10 @@ void	BGM_Device::AddClient(const AudioServerPlugInClientInfo* inClientInfo)
     CAMutex::Locker theStateLocker(mStateMutex);
 
     mClients.AddClient(inClientInfo);
+    
+    mIOTraceRecorder.RecordClientAdded(inClientInfo->mClientID,
+                                       inClientInfo->mProcessID,
+                                       inClientInfo->mBundleID);
 }
 
 void	BGM_Device::RemoveClient(const AudioServerPlugInClientInfo* inClientInfo)
@@ -2013,6 +2564,8 @@ void	BGM_Device::RemoveClient(const AudioServerPlugInClientInfo* inClientInfo)
     }
 
     mClients.RemoveClient(inClientInfo->mClientID);
+    
+    mIOTraceRecorder.RecordClientRemoved(inClientInfo->mClientID);
 }
 
 void	BGM_Device::PerformConfigChange(UInt64 inChangeAction, void* inChangeInfo)
@@ -2033,6 +2586,10 @@ void	BGM_Device::PerformConfigChange(UInt64 inChangeAction, void* inChangeInfo)
             SetEnabledControls(mPendingOutputVolumeControlEnabled,
                                mPendingOutputMuteControlEnabled);
             break;
+
+        case ChangeAction::SetDSPOffloadWorkers:
+            SetDSPOffloadWorkerCount(mPendingDSPOffloadWorkerCount);
+            break;
     }
 }
 
@@ -36,7 +36,8 @@
 #include "BGM_WrappedAudioEngine.h"
 #include "BGM_Clients.h"
 #include "BGM_TaskQueue.h"
-#include "BGM_AudibleState.h"
+#include "BGM_IOPipeline.h"
+#include "BGM_IOTrace.h"
 #include "BGM_Stream.h"
 #include "BGM_VolumeControl.h"
 #include "BGM_MuteControl.h"
@@ -44,7 +45,6 @@
 // PublicUtility Includes
 #include "CAMutex.h"
 #include "CAVolumeCurve.h"
-#include "CARingBuffer.h"
 
 // System Includes
 #include <CoreFoundation/CoreFoundation.h>
@@ -113,11 +113,6 @@ public:
 	void						DoIOOperation(AudioObjectID inStreamObjectID, UInt32 inClientID, UInt32 inOperationID, UInt32 inIOBufferFrameSize, const AudioServerPlugInIOCycleInfo& inIOCycleInfo, void* __nonnull ioMainBuffer, void* __nullable ioSecondaryBuffer);
 	void						EndIOOperation(UInt32 inOperationID, UInt32 inIOBufferFrameSize, const AudioServerPlugInIOCycleInfo& inIOCycleInfo, UInt32 inClientID);
 
-private:
-	void						ReadInputData(UInt32 inIOBufferFrameSize, Float64 inSampleTime, void* __nonnull outBuffer);
-    void						WriteOutputData(UInt32 inIOBufferFrameSize, Float64 inSampleTime, const void* __nonnull inBuffer);
-    void                        ApplyClientRelativeVolume(UInt32 inClientID, UInt32 inIOBufferFrameSize, void* __nonnull inBuffer) const;
-
 #pragma mark Accessors
 
 public:
@@ -132,6 +127,15 @@ public:
     Float64						GetSampleRate() const;
     void                        RequestSampleRate(Float64 inRequestedSampleRate);
 
+    /*!
+     Set the number of worker threads the clients' DSP is offloaded to. (See
+     kAudioDeviceCustomPropertyDSPOffloadWorkers.) This function is async because it has to ask the
+     host to stop IO for the device before the workers can be changed.
+
+     @throws CAException if inWorkerCount is more than kBGMMaxDSPOffloadWorkers.
+     */
+    void                        RequestDSPOffloadWorkerCount(UInt32 inWorkerCount);
+
 private:
 	/*!
      @return The Audio Object that has the ID inObjectID and belongs to this device.
@@ -171,6 +175,14 @@ private:
              fails.
      */
     void                        SetSampleRate(Float64 inNewSampleRate, bool force = false);
+    /*!
+     Start or stop the worker threads the clients' DSP is offloaded to, and update the output
+     stream's latency, since the offloaded DSP delays the clients' output by one IO buffer.
+
+     Private because this can only be called after asking the host to stop IO for the device. See
+     BGM_Device::RequestDSPOffloadWorkerCount.
+     */
+    void                        SetDSPOffloadWorkerCount(UInt32 inWorkerCount);
 
     /*! @return True if inObjectID is the ID of one of this device's streams. */
     inline bool                 IsStreamID(AudioObjectID inObjectID) const noexcept;
@@ -237,9 +249,13 @@ private:
     
     BGM_Clients                 mClients;
     
-    #define kLoopbackRingBufferFrameSize    16384
+    // The audio processing for DoIOOperation. Owns the loopback ring buffer and the audible state.
+    BGM_IOPipeline              mIOPipeline;
+    
+    // Records the IO operations when kAudioDeviceCustomPropertyIOTrace is set.
+    BGM_IOTraceRecorder         mIOTraceRecorder;
+    
     Float64                     mLoopbackSampleRate;
-    CARingBuffer                mLoopbackRingBuffer;
 
     // TODO: a comment explaining why we need a clock for loopback-only mode
     struct {
@@ -251,18 +267,18 @@ private:
     BGM_Stream                  mInputStream;
     BGM_Stream                  mOutputStream;
 
-    BGM_AudibleState            mAudibleState;
-
     enum class ChangeAction : UInt64
     {
         SetSampleRate,
-        SetEnabledControls
+        SetEnabledControls,
+        SetDSPOffloadWorkers
     };
 
     BGM_VolumeControl			mVolumeControl;
 	BGM_MuteControl				mMuteControl;
     bool                        mPendingOutputVolumeControlEnabled = true;
     bool                        mPendingOutputMuteControlEnabled   = true;
+    UInt32                      mPendingDSPOffloadWorkerCount      = 0;
 
 };
 
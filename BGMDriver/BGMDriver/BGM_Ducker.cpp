@@ -0,0 +1,191 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_Ducker.cpp
+//  BGMDriver
+//
+//  Copyright © 2026 Background Music contributors
+//
+
+// Self Include
+#include "BGM_Ducker.h"
+
+// Local Includes
+#include "BGM_GainRamp.h"
+
+// STL Includes
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// System Includes
+#if defined(__APPLE__)
+#include <Accelerate/Accelerate.h>
+#endif
+
+
+#pragma clang assume_nonnull begin
+
+BGM_Ducker::Role    BGM_Ducker::Settings::GetRole(const CACFString& inBundleID) const
+{
+    if(!inBundleID.IsValid())
+    {
+        return kRoleNone;
+    }
+
+    if(mTriggers.count(inBundleID) != 0)
+    {
+        return kRoleTrigger;
+    }
+
+    if(mTargets.count(inBundleID) != 0)
+    {
+        return kRoleTarget;
+    }
+
+    return kRoleNone;
+}
+
+BGM_Ducker::BGM_Ducker()
+:
+    mLastTriggeredSampleTime(-std::numeric_limits<Float64>::infinity()),
+    mCycleSampleTime(std::numeric_limits<Float64>::quiet_NaN())
+{
+    UpdateRTSettings();
+}
+
+void    BGM_Ducker::SetSettings(const Settings& inSettings)
+{
+    mSettings = inSettings;
+    UpdateRTSettings();
+}
+
+void    BGM_Ducker::SetSampleRate(Float64 inSampleRate)
+{
+    mSampleRate = inSampleRate;
+    UpdateRTSettings();
+}
+
+void    BGM_Ducker::UpdateRTSettings()
+{
+    // The attack and release times are how long the gain takes to move between unity and the depth.
+    // The rates have a minimum so the gain still moves back to unity if the depth is set to 0 dB
+    // while ducking.
+    const Float32 theRangeDB = (-mSettings.mDepthDB > kMinRampRangeDB) ? -mSettings.mDepthDB : kMinRampRangeDB;
+
+    auto theDBPerFrame = [&] (Float32 inMillis) {
+        Float64 theFrames = inMillis / 1000.0 * mSampleRate;
+        return (theFrames > 0.0) ?
+                static_cast<Float32>(theRangeDB / theFrames) :
+                std::numeric_limits<Float32>::infinity();
+    };
+
+    mThresholdLevel = std::pow(10.0f, mSettings.mThresholdDB / 20.0f);
+    mDepthDB = mSettings.mDepthDB;
+    mAttackDBPerFrame = theDBPerFrame(mSettings.mAttackMillis);
+    mReleaseDBPerFrame = theDBPerFrame(mSettings.mReleaseMillis);
+    mHoldFrames = mSettings.mHoldMillis / 1000.0 * mSampleRate;
+    mDucksMusicPlayer = mSettings.mDucksMusicPlayer;
+    mSustainedTriggersOnly = mSettings.mSustainedTriggersOnly;
+}
+
+void    BGM_Ducker::DetectRT(const Float32* inBuffer, UInt32 inFrameCount, Float64 inSampleTime)
+{
+    if(PeakLevelRT(inBuffer, inFrameCount * kChannels) > mThresholdLevel.load(std::memory_order_relaxed))
+    {
+        mLastTriggeredSampleTime = std::max(mLastTriggeredSampleTime, inSampleTime + inFrameCount);
+    }
+}
+
+void    BGM_Ducker::ApplyRT(Float32* ioBuffer, UInt32 inFrameCount, Float64 inSampleTime)
+{
+    if(inFrameCount == 0)
+    {
+        return;
+    }
+
+    if(inSampleTime != mCycleSampleTime)
+    {
+        AdvanceRT(inFrameCount, inSampleTime);
+    }
+
+    if(mCycleStartGain != 1.0f || mCycleEndGain != 1.0f)
+    {
+        BGM_GainRamp::RampMultiplyRT(ioBuffer, inFrameCount, kChannels, mCycleStartGain, mCycleEndGain);
+    }
+}
+
+void    BGM_Ducker::AdvanceRT(UInt32 inFrameCount, Float64 inSampleTime)
+{
+    // Duck if a trigger was over the threshold within the hold time before the start of this
+    // cycle, or earlier in this cycle. Triggers measured after the targets in a cycle are within
+    // the hold time in the next cycle even if it's zero.
+    bool isTriggered =
+            (inSampleTime - mLastTriggeredSampleTime) <= mHoldFrames.load(std::memory_order_relaxed);
+
+    const Float32 theTargetGainDB = isTriggered ? mDepthDB.load(std::memory_order_relaxed) : 0.0f;
+    Float32 theEndGainDB;
+
+    // Move towards the target at the attack rate if that's down and the release rate if it's up.
+    // (It can be up while triggered if the depth was made shallower.)
+    if(theTargetGainDB < mGainDB)
+    {
+        theEndGainDB = std::max(theTargetGainDB,
+                                mGainDB - mAttackDBPerFrame.load(std::memory_order_relaxed) * inFrameCount);
+    }
+    else
+    {
+        theEndGainDB = std::min(theTargetGainDB,
+                                mGainDB + mReleaseDBPerFrame.load(std::memory_order_relaxed) * inFrameCount);
+    }
+
+    // The last cycle's end gain is this one's start gain, so the gain is continuous. The gain is
+    // exactly 1.0 at 0 dB so ApplyRT can skip unducked cycles.
+    mCycleStartGain = mCycleEndGain;
+    mCycleEndGain = (theEndGainDB == 0.0f) ? 1.0f : std::pow(10.0f, theEndGainDB / 20.0f);
+
+    mGainDB = theEndGainDB;
+    mCycleSampleTime = inSampleTime;
+}
+
+#pragma mark Kernels
+
+Float32 BGM_Ducker::PeakLevelRT(const Float32* inBuffer, UInt32 inSampleCount)
+{
+#if defined(__APPLE__)
+    Float32 thePeak = 0.0f;
+    vDSP_maxmgv(inBuffer, 1, &thePeak, inSampleCount);
+    return thePeak;
+#else
+    return PeakLevelReferenceRT(inBuffer, inSampleCount);
+#endif
+}
+
+Float32 BGM_Ducker::PeakLevelReferenceRT(const Float32* inBuffer, UInt32 inSampleCount)
+{
+    Float32 thePeak = 0.0f;
+
+    for(UInt32 i = 0; i < inSampleCount; i++)
+    {
+        thePeak = std::max(thePeak, std::fabs(inBuffer[i]));
+    }
+
+    return thePeak;
+}
+
+#pragma clang assume_nonnull end
+
@@ -0,0 +1,204 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_Ducker.h
+//  BGMDriver
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  Ducks the audio of some apps (the targets, e.g. the music player) while other apps (the
+//  triggers, e.g. a conferencing app) are playing audio above a threshold. See
+//  kAudioDeviceCustomPropertyDucking.
+//
+//  The triggers' audio is measured in ProcessOutput, and the ducking gain follows an
+//  attack/hold/release envelope: it falls to the ducking depth over the attack time when a trigger
+//  goes over the threshold, stays there until the triggers have been under it for the hold time and
+//  then rises back to unity over the release time. The gain moves linearly in dB and is ramped
+//  across each IO buffer.
+//
+//  The envelope is advanced once per IO cycle, the first time a target's audio is ducked in the
+//  cycle, so every target gets the same gain. A trigger measured earlier in the cycle than a target
+//  affects it in the same cycle, otherwise in the next one.
+//
+//  The settings can be changed from any thread without locking. The RT methods must only be called
+//  from the IO thread.
+//
+
+#ifndef BGMDriver__BGM_Ducker
+#define BGMDriver__BGM_Ducker
+
+// Local Includes
+#include "BGM_Types.h"
+
+// PublicUtility Includes
+#include "CACFString.h"
+
+// System Includes
+#include <MacTypes.h>
+
+// STL Includes
+#include <atomic>
+#include <set>
+
+
+#pragma clang assume_nonnull begin
+
+class BGM_Ducker
+{
+
+public:
+    enum Role
+    {
+        kRoleNone,
+        kRoleTrigger,
+        kRoleTarget
+    };
+
+    struct Settings
+    {
+        // The bundle IDs of the apps whose audio causes ducking.
+        std::set<CACFString>    mTriggers;
+        // The bundle IDs of the apps whose audio is ducked.
+        std::set<CACFString>    mTargets;
+        // True if the music player's audio should be ducked as well as mTargets'.
+        bool                    mDucksMusicPlayer = false;
+        // True if the triggers only cause ducking while BGM_SignalClassifier classifies their audio
+        // as sustained.
+        bool                    mSustainedTriggersOnly = false;
+
+        Float32                 mThresholdDB = kBGMDuckingDefaultThresholdDB;
+        Float32                 mDepthDB = kBGMDuckingDefaultDepthDB;
+        Float32                 mAttackMillis = kBGMDuckingDefaultAttackMillis;
+        Float32                 mHoldMillis = kBGMDuckingDefaultHoldMillis;
+        Float32                 mReleaseMillis = kBGMDuckingDefaultReleaseMillis;
+
+        /*! @return The role of the app with the given bundle ID. */
+        Role                    GetRole(const CACFString& inBundleID) const;
+
+        bool operator==(const Settings& other) const {
+            return mTriggers == other.mTriggers &&
+                   mTargets == other.mTargets &&
+                   mDucksMusicPlayer == other.mDucksMusicPlayer &&
+                   mSustainedTriggersOnly == other.mSustainedTriggersOnly &&
+                   mThresholdDB == other.mThresholdDB &&
+                   mDepthDB == other.mDepthDB &&
+                   mAttackMillis == other.mAttackMillis &&
+                   mHoldMillis == other.mHoldMillis &&
+                   mReleaseMillis == other.mReleaseMillis;
+        }
+
+        bool operator!=(const Settings& other) const { return !(*this == other); }
+    };
+
+                        BGM_Ducker();
+
+    /*! The settings the envelope was last given. Not thread-safe. */
+    const Settings&     GetSettings() const { return mSettings; }
+
+    /*!
+     Change the envelope's settings. Lock-free, but not thread-safe. The IO thread might use a mix of
+     the old and new settings for one IO cycle.
+     */
+    void                SetSettings(const Settings& inSettings);
+
+    /*! Set the sample rate of the audio the RT methods will be given. See SetSettings. */
+    void                SetSampleRate(Float64 inSampleRate);
+
+    /*! @return True if the music player's clients should be ducked. */
+    bool                DucksMusicPlayerRT() const
+                            { return mDucksMusicPlayer.load(std::memory_order_relaxed); }
+
+    /*! @return True if the triggers' audio should only be measured while it's sustained. */
+    bool                SustainedTriggersOnlyRT() const
+                            { return mSustainedTriggersOnly.load(std::memory_order_relaxed); }
+
+    /*!
+     Measure a trigger's audio for the IO cycle.
+
+     @param inBuffer The trigger's audio. Interleaved stereo.
+     @param inFrameCount The number of frames in inBuffer.
+     @param inSampleTime The sample time of the cycle's first frame.
+     */
+    void                DetectRT(const Float32* inBuffer, UInt32 inFrameCount, Float64 inSampleTime);
+
+    /*!
+     Apply the ducking gain to a target's audio for the IO cycle. Does nothing if the gain is and
+     stays at unity.
+
+     @param ioBuffer The target's audio. Interleaved stereo.
+     @param inFrameCount The number of frames in ioBuffer.
+     @param inSampleTime The sample time of the cycle's first frame.
+     */
+    void                ApplyRT(Float32* ioBuffer, UInt32 inFrameCount, Float64 inSampleTime);
+
+    /*! @return The ducking gain in dB at the end of the last IO cycle, i.e. 0.0 if not ducking. */
+    Float32             GetGainDBRT() const { return mGainDB; }
+
+#pragma mark Kernels
+
+    /*!
+     @return The largest absolute value in inBuffer. Uses vDSP on macOS and PeakLevelReferenceRT
+             elsewhere.
+     */
+    static Float32      PeakLevelRT(const Float32* inBuffer, UInt32 inSampleCount);
+
+    /*! A portable implementation of PeakLevelRT. */
+    static Float32      PeakLevelReferenceRT(const Float32* inBuffer, UInt32 inSampleCount);
+
+private:
+    /*! Move the envelope to the end of the IO cycle starting at inSampleTime. */
+    void                AdvanceRT(UInt32 inFrameCount, Float64 inSampleTime);
+
+    /*! Recalculate the RT copies of the settings. */
+    void                UpdateRTSettings();
+
+    static constexpr UInt32     kChannels = 2;
+
+    // See UpdateRTSettings.
+    static constexpr Float32    kMinRampRangeDB = 1.0f;
+
+    Settings                    mSettings;
+    Float64                     mSampleRate = 44100.0;
+
+    // The settings in the units the IO thread uses.
+    std::atomic<Float32>        mThresholdLevel;
+    std::atomic<Float32>        mDepthDB;
+    // How far the gain moves per frame while attacking/releasing, in dB. Infinity if the time is
+    // zero.
+    std::atomic<Float32>        mAttackDBPerFrame;
+    std::atomic<Float32>        mReleaseDBPerFrame;
+    std::atomic<Float64>        mHoldFrames;
+    std::atomic<bool>           mDucksMusicPlayer;
+    std::atomic<bool>           mSustainedTriggersOnly;
+
+    // The envelope's state. Only accessed on the IO thread.
+    //
+    // The sample time just after the last buffer a trigger was over the threshold in.
+    Float64                     mLastTriggeredSampleTime;
+    // The sample time of the cycle the envelope was last advanced for.
+    Float64                     mCycleSampleTime;
+    // The gains at the start and end of that cycle.
+    Float32                     mCycleStartGain = 1.0f;
+    Float32                     mCycleEndGain = 1.0f;
+    Float32                     mGainDB = 0.0f;
+
+};
+
+#pragma clang assume_nonnull end
+
+#endif /* BGMDriver__BGM_Ducker */
+
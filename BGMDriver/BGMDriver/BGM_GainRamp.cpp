@@ -0,0 +1,162 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_GainRamp.cpp
+//  BGMDriver
+//
+//  Copyright © 2026 Background Music contributors
+//
+
+// Self Include
+#include "BGM_GainRamp.h"
+
+// STL Includes
+#include <cmath>
+#include <limits>
+
+// System Includes
+#if defined(__APPLE__)
+#include <Accelerate/Accelerate.h>
+#endif
+
+
+#pragma clang assume_nonnull begin
+
+BGM_GainRamp::BGM_GainRamp(Float32 inInitialGain,
+                           Float64 inTimeConstantSecs,
+                           Float64 inSampleRate)
+:
+    mTargetGain(inInitialGain),
+    mDecayPerFrame(0.0f),
+    mCurrentGain(inInitialGain)
+{
+    SetTimeConstant(inTimeConstantSecs, inSampleRate);
+}
+
+void    BGM_GainRamp::SetTimeConstant(Float64 inTimeConstantSecs, Float64 inSampleRate)
+{
+    Float64 theTimeConstantFrames = inTimeConstantSecs * inSampleRate;
+
+    mDecayPerFrame = (theTimeConstantFrames > 0.0) ?
+            static_cast<Float32>(1.0 / theTimeConstantFrames) :
+            std::numeric_limits<Float32>::infinity();
+}
+
+void    BGM_GainRamp::SetTargetGain(Float32 inTargetGain)
+{
+    mTargetGain.store(inTargetGain, std::memory_order_relaxed);
+}
+
+Float32 BGM_GainRamp::GetTargetGain() const
+{
+    return mTargetGain.load(std::memory_order_relaxed);
+}
+
+void    BGM_GainRamp::ApplyRT(Float32* ioBuffer, UInt32 inFrameCount)
+{
+    if(inFrameCount == 0)
+    {
+        return;
+    }
+
+    Float32 theTargetGain = mTargetGain.load(std::memory_order_relaxed);
+
+    if(mCurrentGain == theTargetGain)
+    {
+        // Not ramping, so we can just apply the gain. Skip it if it wouldn't change anything.
+        if(theTargetGain != 1.0f)
+        {
+            RampMultiplyRT(ioBuffer, inFrameCount, kChannels, theTargetGain, theTargetGain);
+        }
+
+        return;
+    }
+
+    // Work out where the gain will be at the end of this buffer. The distance to the target shrinks
+    // by a factor of e every time constant, so the time it takes doesn't depend on the buffer size
+    // or the sample rate.
+    Float32 theDecay = std::exp(-static_cast<Float32>(inFrameCount) *
+                                mDecayPerFrame.load(std::memory_order_relaxed));
+    Float32 theEndGain = theTargetGain + (mCurrentGain - theTargetGain) * theDecay;
+
+    if(std::fabs(theEndGain - theTargetGain) < kSnapThreshold)
+    {
+        theEndGain = theTargetGain;
+    }
+
+    RampMultiplyRT(ioBuffer, inFrameCount, kChannels, mCurrentGain, theEndGain);
+
+    mCurrentGain = theEndGain;
+}
+
+#pragma mark Kernels
+
+void    BGM_GainRamp::RampMultiplyRT(Float32* ioBuffer,
+                                     UInt32 inFrameCount,
+                                     UInt32 inChannels,
+                                     Float32 inStartGain,
+                                     Float32 inEndGain)
+{
+#if defined(__APPLE__)
+    if(inStartGain == inEndGain)
+    {
+        // The gain is constant, so the channels don't need to be handled separately.
+        vDSP_vsmul(ioBuffer, 1, &inStartGain, ioBuffer, 1, inFrameCount * inChannels);
+        return;
+    }
+
+    const Float32 theStep = (inEndGain - inStartGain) / static_cast<Float32>(inFrameCount);
+
+    // vDSP_vrampmul advances the gain it's given, so each channel needs its own copy.
+    for(UInt32 theChannel = 0; theChannel < inChannels; theChannel++)
+    {
+        Float32 theGain = inStartGain;
+
+        vDSP_vrampmul(ioBuffer + theChannel, inChannels,
+                      &theGain,
+                      &theStep,
+                      ioBuffer + theChannel, inChannels,
+                      inFrameCount);
+    }
+#else
+    RampMultiplyReferenceRT(ioBuffer, inFrameCount, inChannels, inStartGain, inEndGain);
+#endif
+}
+
+void    BGM_GainRamp::RampMultiplyReferenceRT(Float32* ioBuffer,
+                                              UInt32 inFrameCount,
+                                              UInt32 inChannels,
+                                              Float32 inStartGain,
+                                              Float32 inEndGain)
+{
+    const Float32 theStep = (inFrameCount > 0) ?
+            (inEndGain - inStartGain) / static_cast<Float32>(inFrameCount) :
+            0.0f;
+
+    for(UInt32 theFrame = 0; theFrame < inFrameCount; theFrame++)
+    {
+        const Float32 theGain = inStartGain + theStep * static_cast<Float32>(theFrame);
+
+        for(UInt32 theChannel = 0; theChannel < inChannels; theChannel++)
+        {
+            ioBuffer[theFrame * inChannels + theChannel] *= theGain;
+        }
+    }
+}
+
+#pragma clang assume_nonnull end
+
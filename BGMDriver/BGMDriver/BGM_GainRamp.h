@@ -0,0 +1,126 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_GainRamp.h
+//  BGMDriver
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  Applies a gain to audio that changes smoothly, rather than instantly, when a new gain is set, so
+//  volume changes don't cause clicks or zipper noise.
+//
+//  The gain approaches its target exponentially with a fixed time constant. Each IO buffer is
+//  multiplied by a linear ramp from the gain at its start to the gain at its end, so the gain is
+//  continuous between buffers.
+//
+//  The target gain can be set from any thread without locking. ApplyRT must only be called from one
+//  thread at a time, i.e. the IO thread.
+//
+
+#ifndef BGMDriver__BGM_GainRamp
+#define BGMDriver__BGM_GainRamp
+
+// System Includes
+#include <MacTypes.h>
+
+// STL Includes
+#include <atomic>
+
+
+#pragma clang assume_nonnull begin
+
+class BGM_GainRamp
+{
+
+public:
+    /*!
+     @param inInitialGain The gain to start at.
+     @param inTimeConstantSecs See SetTimeConstant.
+     @param inSampleRate See SetTimeConstant.
+     */
+                        BGM_GainRamp(Float32 inInitialGain,
+                                     Float64 inTimeConstantSecs,
+                                     Float64 inSampleRate);
+
+    /*!
+     Set how quickly the gain moves to a new target. After inTimeConstantSecs, the gain will have
+     moved about 63% of the way (1 - 1/e) to the target. Real-time safe, but should usually only be
+     called when the sample rate changes.
+
+     @param inTimeConstantSecs The time constant in seconds. If it's zero, the gain reaches new
+                               targets by the end of the next buffer.
+     @param inSampleRate The sample rate of the audio ApplyRT will be given.
+     */
+    void                SetTimeConstant(Float64 inTimeConstantSecs, Float64 inSampleRate);
+
+    /*! Set the gain to move to. Real-time safe and lock-free. Can be called from any thread. */
+    void                SetTargetGain(Float32 inTargetGain);
+
+    /*! @return The gain the ramp is moving to, or has reached. */
+    Float32             GetTargetGain() const;
+
+    /*!
+     Multiply the samples in ioBuffer by the gain, moving the gain towards its target. Does nothing
+     if the gain has reached its target and the target is 1.0.
+
+     @param ioBuffer The audio to apply the gain to. Interleaved stereo.
+     @param inFrameCount The number of frames in ioBuffer.
+     */
+    void                ApplyRT(Float32* ioBuffer, UInt32 inFrameCount);
+
+#pragma mark Kernels
+
+    /*!
+     Multiply interleaved audio by a gain that changes linearly from inStartGain for the first frame
+     to just before inEndGain for the last, i.e. the gain for frame i is
+     inStartGain + i * (inEndGain - inStartGain) / inFrameCount, so the next buffer can start at
+     inEndGain.
+
+     Uses vDSP on macOS and RampMultiplyReferenceRT elsewhere.
+     */
+    static void         RampMultiplyRT(Float32* ioBuffer,
+                                       UInt32 inFrameCount,
+                                       UInt32 inChannels,
+                                       Float32 inStartGain,
+                                       Float32 inEndGain);
+
+    /*! A portable implementation of RampMultiplyRT, which also defines its results. */
+    static void         RampMultiplyReferenceRT(Float32* ioBuffer,
+                                                UInt32 inFrameCount,
+                                                UInt32 inChannels,
+                                                Float32 inStartGain,
+                                                Float32 inEndGain);
+
+private:
+    // Once the gain is this close to its target, it's set to the target.
+    static constexpr Float32    kSnapThreshold = 1.0e-5f;
+
+    static constexpr UInt32     kChannels = 2;
+
+    std::atomic<Float32>        mTargetGain;
+    // The reciprocal of the time constant in frames, or infinity if the time constant is zero.
+    std::atomic<Float32>        mDecayPerFrame;
+
+    // The gain at the start of the next buffer. Only accessed by ApplyRT.
+    Float32                     mCurrentGain;
+
+};
+
+#pragma clang assume_nonnull end
+
+#endif /* BGMDriver__BGM_GainRamp */
+
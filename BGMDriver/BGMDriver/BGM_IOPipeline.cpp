@@ -0,0 +1,736 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_IOPipeline.cpp
+//  BGMDriver
+//
+//  Copyright © 2026 Background Music contributors
+//  Copyright © 2016, 2017, 2019 Kyle Neideck
+//  Copyright © 2019 Gordon Childs
+//
+//  The IO operations in this file were moved here from BGM_Device.cpp.
+//
+
+// Self Include
+#include "BGM_IOPipeline.h"
+
+// Local Includes
+#include "BGM_Clients.h"
+#include "BGM_ClientDSPStatePool.h"
+#include "BGM_SceneMorph.h"
+#include "BGM_Utils.h"
+
+// PublicUtility Includes
+#include "CADebugMacros.h"
+#include "CAException.h"
+#include "CAHostTimeBase.h"
+
+// STL Includes
+#include <cmath>
+#include <cstring>
+
+// System Includes
+#include <CoreAudio/AudioHardwareBase.h>
+
+
+#pragma clang assume_nonnull begin
+
+static const BGM_RTEventType kRTEventTypes[kBGMIOPipelineRTEventTypeCount] = {
+    {
+        "BGM_IOPipeline::ReadInputData: Loopback audio overwritten while reading it",
+        kBGMRTEventSeverityWarning,
+        nullptr,
+        { "sampleTime", "frames", nullptr, nullptr },
+        { kBGMRTEventArgFloat, kBGMRTEventArgInteger, kBGMRTEventArgUnused, kBGMRTEventArgUnused }
+    },
+    {
+        "BGM_IOPipeline::WriteOutputData: Couldn't store the mix",
+        kBGMRTEventSeverityWarning,
+        nullptr,
+        { "sampleTime", "frames", "error", nullptr },
+        { kBGMRTEventArgFloat, kBGMRTEventArgInteger, kBGMRTEventArgInteger, kBGMRTEventArgUnused }
+    },
+    {
+        "BGM_Device::DoIOOperation: Unexpected IO operation",
+        kBGMRTEventSeverityDebug,
+        nullptr,
+        { "operation", "client", nullptr, nullptr },
+        { kBGMRTEventArgInteger, kBGMRTEventArgInteger, kBGMRTEventArgUnused, kBGMRTEventArgUnused }
+    }
+};
+
+BGM_IOPipeline::BGM_IOPipeline(BGM_Clients& inClients, CAMutex& inIOMutex)
+:
+    mClients(inClients),
+    mIOMutex(inIOMutex),
+    mLoopbackRingBuffer(),
+    mLoopbackEndSampleTime(-1),
+    mAudibleState(),
+    mRTEventLog(kRTEventTypes, kBGMIOPipelineRTEventTypeCount, 1),
+    mGlitchTelemetry(),
+    mDSPBudget(),
+    mDSPWorkerPool(),
+    mOffloadedClients(),
+    mOffloadCycle(0),
+    mIOBufferFrameSize(0),
+    mHostTicksPerFrame(CAHostTimeBase::GetFrequency() / 44100.0)
+{
+}
+
+constexpr UInt32 BGM_IOPipeline::kMaxOffloadedClients;
+constexpr UInt32 BGM_IOPipeline::kMaxOffloadedFrames;
+
+void    BGM_IOPipeline::AllocateLoopback()
+{
+    //  Allocate (or re-allocate) the loopback buffer, which stores interleaved stereo audio.
+    mLoopbackRingBuffer.Allocate(2, kLoopbackRingBufferFrameSize);
+    mLoopbackEndSampleTime = -1;
+}
+
+void    BGM_IOPipeline::SetSampleRate(Float64 inSampleRate)
+{
+    mDSPBudget.SetSampleRate(inSampleRate);
+    mHostTicksPerFrame = CAHostTimeBase::GetFrequency() / inSampleRate;
+}
+
+void    BGM_IOPipeline::ResetAudibleState()
+{
+    // mAudibleState is usually guarded by the IO mutex, but IO hasn't started yet.
+    BGMAssert(mIOMutex.IsFree(), "BGM_IOPipeline::ResetAudibleState: IO mutex taken before starting IO");
+    mAudibleState.Reset();
+}
+
+#pragma mark DSP Offloading
+
+void    BGM_IOPipeline::SetDSPOffloadWorkerCount(UInt32 inWorkerCount)
+{
+    BGMAssert(mIOMutex.IsFree(), "BGM_IOPipeline::SetDSPOffloadWorkerCount: Called during IO");
+    
+    ThrowIf(inWorkerCount > BGM_DSPWorkerPool::kMaxWorkers,
+            CAException(kAudioHardwareIllegalOperationError),
+            "BGM_IOPipeline::SetDSPOffloadWorkerCount: Too many workers");
+    
+    if(inWorkerCount == GetDSPOffloadWorkerCount())
+    {
+        return;
+    }
+    
+    // Stop the old workers first, since the new ones would replace the clients' buffers.
+    mDSPWorkerPool.reset();
+    
+    if(inWorkerCount == 0)
+    {
+        mOffloadedClients.clear();
+        mOffloadedClients.shrink_to_fit();
+        return;
+    }
+    
+    // Allocate the clients' buffers up front, since they're filled on the IO thread.
+    if(mOffloadedClients.empty())
+    {
+        mOffloadedClients.resize(kMaxOffloadedClients);
+        
+        for(OffloadedClient& theClient : mOffloadedClients)
+        {
+            for(std::vector<Float32>& theBuffer : theClient.mBuffers)
+            {
+                // Interleaved stereo
+                theBuffer.resize(kMaxOffloadedFrames * 2);
+            }
+        }
+    }
+    
+    ResetDSPOffload();
+    
+    mDSPWorkerPool.reset(new BGM_DSPWorkerPool(inWorkerCount,
+                                               &BGM_IOPipeline::ProcessOffloadedClientRT,
+                                               this));
+}
+
+UInt32  BGM_IOPipeline::GetDSPOffloadWorkerCount() const
+{
+    return (mDSPWorkerPool == nullptr) ? 0 : mDSPWorkerPool->GetWorkerCount();
+}
+
+UInt32  BGM_IOPipeline::GetDSPOffloadLatencyFrames() const
+{
+    // Buffers larger than kMaxOffloadedFrames are processed on the IO thread. (See
+    // OffloadClientDSPRT.)
+    const UInt32 theFrameSize = mIOBufferFrameSize.load(std::memory_order_relaxed);
+    return (mDSPWorkerPool == nullptr || theFrameSize > kMaxOffloadedFrames) ? 0 : theFrameSize;
+}
+
+void    BGM_IOPipeline::ResetDSPOffload()
+{
+    BGMAssert(mIOMutex.IsFree(), "BGM_IOPipeline::ResetDSPOffload: IO mutex taken before starting IO");
+    
+    for(OffloadedClient& theClient : mOffloadedClients)
+    {
+        theClient.mInUse = false;
+    }
+    
+    mOffloadCycle = 0;
+}
+
+bool    BGM_IOPipeline::OffloadClientDSPRT(UInt32 inClientID,
+                                           UInt32 inIOBufferFrameSize,
+                                           bool inBypassEQ,
+                                           const AudioTimeStamp& inOutputTime,
+                                           Float32* ioBuffer)
+{
+    if(mDSPWorkerPool == nullptr || inIOBufferFrameSize > kMaxOffloadedFrames)
+    {
+        return false;
+    }
+    
+    // Find the client's slot, or a free one if it doesn't have one yet.
+    UInt32 theSlot = kMaxOffloadedClients;
+    
+    for(UInt32 i = 0; i < mOffloadedClients.size(); i++)
+    {
+        if(mOffloadedClients[i].mInUse && mOffloadedClients[i].mClientID == inClientID)
+        {
+            theSlot = i;
+            break;
+        }
+        else if(!mOffloadedClients[i].mInUse && theSlot == kMaxOffloadedClients)
+        {
+            theSlot = i;
+        }
+    }
+    
+    if(theSlot == kMaxOffloadedClients)
+    {
+        return false;
+    }
+    
+    OffloadedClient& theClient = mOffloadedClients[theSlot];
+    
+    if(!theClient.mInUse)
+    {
+        theClient.mInUse = true;
+        theClient.mClientID = inClientID;
+        theClient.mFrames[0] = 0;
+        theClient.mFrames[1] = 0;
+    }
+    
+    const UInt32 theJobBuffer = static_cast<UInt32>(mOffloadCycle % 2);
+    const UInt32 theResultBuffer = 1 - theJobBuffer;
+    const size_t theByteSize = inIOBufferFrameSize * sizeof(Float32) * 2;
+    
+    // The last cycle's result can only be used if the client did IO in the last cycle, since its
+    // buffer is freed otherwise, and the buffer size hasn't changed.
+    const bool hasResult = theClient.mFrames[theResultBuffer] == inIOBufferFrameSize;
+    
+    // Queue this cycle's audio.
+    memcpy(theClient.mBuffers[theJobBuffer].data(), ioBuffer, theByteSize);
+    theClient.mFrames[theJobBuffer] = inIOBufferFrameSize;
+    theClient.mLastCycle = mOffloadCycle;
+    theClient.mBypassEQ = inBypassEQ;
+    
+    // The job's result is played in the next cycle, so the parts of the DSP that depend on the time,
+    // like the automation, have to see the next cycle's output time. Otherwise they'd take effect
+    // one buffer early.
+    theClient.mOutputTime = inOutputTime;
+    theClient.mOutputTime.mSampleTime += inIOBufferFrameSize;
+    
+    if(inOutputTime.mFlags & kAudioTimeStampHostTimeValid)
+    {
+        Float64 theHostTicksPerFrame = mHostTicksPerFrame;
+        
+        if((inOutputTime.mFlags & kAudioTimeStampRateScalarValid) && inOutputTime.mRateScalar > 0.0)
+        {
+            theHostTicksPerFrame *= inOutputTime.mRateScalar;
+        }
+        
+        theClient.mOutputTime.mHostTime +=
+                static_cast<UInt64>(std::llround(inIOBufferFrameSize * theHostTicksPerFrame));
+    }
+    
+    if(!mDSPWorkerPool->SubmitRT(theSlot))
+    {
+        // Shouldn't happen, since there are fewer clients than jobs, but the job can just as well
+        // be run here.
+        ProcessOffloadedClientRT(this, theSlot);
+    }
+    
+    // Replace the client's audio with last cycle's.
+    if(hasResult)
+    {
+        memcpy(ioBuffer, theClient.mBuffers[theResultBuffer].data(), theByteSize);
+    }
+    else
+    {
+        memset(ioBuffer, 0, theByteSize);
+    }
+    
+    return true;
+}
+
+// static
+void    BGM_IOPipeline::ProcessOffloadedClientRT(void* inRefCon, UInt32 inJob)
+{
+    BGM_IOPipeline* thePipeline = static_cast<BGM_IOPipeline*>(inRefCon);
+    OffloadedClient& theClient = thePipeline->mOffloadedClients[inJob];
+    const UInt32 theBuffer = static_cast<UInt32>(theClient.mLastCycle % 2);
+    
+    // The job usually runs on a worker thread, so it needs its own reader to keep the client from
+    // being freed while it's processed.
+    BGM_Clients::ReaderRT theClientsReader(thePipeline->mClients);
+    
+    thePipeline->ApplyClientDSPRT(theClient.mClientID,
+                                  theClient.mFrames[theBuffer],
+                                  theClient.mBypassEQ,
+                                  theClient.mOutputTime,
+                                  theClient.mBuffers[theBuffer].data());
+}
+
+#pragma mark IO Operations
+
+void    BGM_IOPipeline::ReadInputRT(UInt32 inClientID,
+                                    UInt32 inIOBufferFrameSize,
+                                    Float64 inInputSampleTime,
+                                    const AudioTimeStamp& inOutputTime,
+                                    Float32* ioBuffer)
+{
+    // Keep the clients we read from being freed until we're done with them
+    BGM_Clients::ReaderRT theClientsReader(mClients);
+    
+    mDSPBudget.BeginOperationRT(inIOBufferFrameSize, inOutputTime);
+    
+    CAMutex::Locker theIOLocker(mIOMutex);
+
+    // Check if this client has incoming routes
+    // If so, it should receive ONLY the routed audio, not the full loopback
+    bool hasIncomingRoutes = mClients.HasIncomingRoutesRT(inClientID);
+    
+    if(hasIncomingRoutes)
+    {
+        // Zero the buffer first, then mix in only routed audio
+        memset(ioBuffer, 0, inIOBufferFrameSize * sizeof(Float32) * 2);
+        
+        // Mixing the routes is the last thing to be shed, since the client gets silence without it.
+        const bool shedRouteMixing =
+                mDSPBudget.GetShedLevelRT() >= BGM_DSPBudget::kShedRouteMixing &&
+                mClients.GetClientPriorityRT(inClientID) != kBGMAppPriorityHigh;
+        
+        if(shedRouteMixing)
+        {
+            mGlitchTelemetry.CountRT(kBGMGlitchShedRouteMixing);
+        }
+        else
+        {
+            // Mix in audio specifically routed to this client. The sources' audio is read by sample
+            // time, the same way as the loopback audio, so routes have the same latency however the
+            // HAL orders the clients' IO.
+            mClients.MixRoutedAudioRT(inClientID, ioBuffer, inIOBufferFrameSize, inInputSampleTime);
+        }
+    }
+    else if(mClients.FetchCaptureSubmixRT(inClientID, ioBuffer, inIOBufferFrameSize, inInputSampleTime))
+    {
+        // The client's app has a capture filter, so it gets the filtered submix, which was mixed
+        // in ProcessOutput, instead of the full loopback.
+    }
+    else
+    {
+        // No incoming routes - provide the normal loopback of all apps
+        bool didReadLoopback = ReadInputData(inIOBufferFrameSize, inInputSampleTime, ioBuffer);
+        
+        // If this is a mix-minus client, remove its app's output from the loopback audio, which
+        // leaves the mix of every other app. The app's clients' output was stored by sample time in
+        // ProcessOutput, so this subtracts exactly what they contributed to the frames we just read.
+        // (Unless we wrote silence instead.)
+        if(didReadLoopback)
+        {
+            mClients.SubtractMixMinusContributionRT(inClientID,
+                                                    ioBuffer,
+                                                    inIOBufferFrameSize,
+                                                    inInputSampleTime);
+        }
+    }
+}
+
+bool    BGM_IOPipeline::ProcessOutputRT(UInt32 inClientID,
+                                        UInt32 inIOBufferFrameSize,
+                                        const AudioTimeStamp& inOutputTime,
+                                        Float32* ioBuffer)
+{
+    BGM_Clients::ReaderRT theClientsReader(mClients);
+    
+    // The offloaded audio is played one IO buffer late, so the latency changes with the buffer size.
+    const UInt32 theLatencyFrames = GetDSPOffloadLatencyFrames();
+    mIOBufferFrameSize.store(inIOBufferFrameSize, std::memory_order_relaxed);
+    const bool didChangeLatency = (GetDSPOffloadLatencyFrames() != theLatencyFrames);
+    
+    mDSPBudget.BeginOperationRT(inIOBufferFrameSize, inOutputTime);
+    
+    const BGMAppPriority theClientPriority = mClients.GetClientPriorityRT(inClientID);
+    
+    {
+        bool theClientIsMusicPlayer = mClients.IsMusicPlayerRT(inClientID);
+        
+        // The FFT is the most expensive part of the classification, but the classifier can still
+        // tell sustained audio from short sounds reasonably well without it, so it's shed first.
+        const bool shedSpectralFeatures =
+                theClientPriority != kBGMAppPriorityHigh &&
+                mDSPBudget.GetShedLevelRT() >= BGM_DSPBudget::kShedSpectralFeatures;
+        
+        if(shedSpectralFeatures)
+        {
+            mGlitchTelemetry.CountRT(kBGMGlitchShedSpectralFeatures);
+        }
+        
+        // Classify the client's audio so notification sounds, UI clicks, etc. don't make the
+        // device audible and pause the music player. This also tells the ducker whether a trigger
+        // is playing sustained audio.
+        bool theClientAudioIsSustained =
+                mClients.ClassifyClientAudioRT(inClientID,
+                                               ioBuffer,
+                                               inIOBufferFrameSize,
+                                               shedSpectralFeatures);
+        
+        CAMutex::Locker theIOLocker(mIOMutex);
+        // Called in this IO operation so we can get the music player client's data separately
+        mAudibleState.UpdateWithClientIO(theClientIsMusicPlayer,
+                                         theClientAudioIsSustained,
+                                         inIOBufferFrameSize,
+                                         inOutputTime.mSampleTime,
+                                         ioBuffer);
+        
+        // Store this client's audio to its routing buffer BEFORE volume is applied
+        // This ensures routed audio has full signal even when volume to master is 0
+        // We always store - the routing decision is made in ReadInput
+        mClients.StoreClientAudioRT(inClientID,
+                                    ioBuffer,
+                                    inIOBufferFrameSize,
+                                    inOutputTime.mSampleTime);
+        
+        // NOTE: Do NOT mix routed audio here! ProcessOutput is the app's OUTPUT to master.
+        // Routed audio is delivered via ReadInput (the app's INPUT from driver).
+    }
+    
+    // The EQ of low-priority clients is bypassed if the cycle is running out of time.
+    const bool bypassEQ =
+            theClientPriority == kBGMAppPriorityLow &&
+            mDSPBudget.GetShedLevelRT() >= BGM_DSPBudget::kShedLowPriorityEQ;
+    
+    // Apply the client's gains and EQ, either on the DSP worker threads or here.
+    if(!OffloadClientDSPRT(inClientID, inIOBufferFrameSize, bypassEQ, inOutputTime, ioBuffer))
+    {
+        ApplyClientDSPRT(inClientID, inIOBufferFrameSize, bypassEQ, inOutputTime, ioBuffer);
+    }
+    
+    // Measure the client's audio if its app triggers ducking, or duck it if it's a target. This is
+    // after the client's own gains so a trigger that's been turned down doesn't duck the others.
+    mClients.ApplyDuckingRT(inClientID, ioBuffer, inIOBufferFrameSize, inOutputTime.mSampleTime);
+    
+    // Keep a copy of what this client is adding to the mix if it's a mix-minus client. This has to
+    // be after its volume, etc. have been applied so it matches the audio that will be in the
+    // loopback buffer.
+    mClients.StoreMixMinusContributionRT(inClientID,
+                                         ioBuffer,
+                                         inIOBufferFrameSize,
+                                         inOutputTime.mSampleTime);
+    
+    // Mix this client's audio into the filtered capture submixes that include it.
+    mClients.AccumulateCaptureSubmixesRT(inClientID,
+                                         ioBuffer,
+                                         inIOBufferFrameSize,
+                                         inOutputTime.mSampleTime);
+    
+    return didChangeLatency;
+}
+
+bool    BGM_IOPipeline::WriteMixRT(UInt32 inIOBufferFrameSize,
+                                   Float64 inOutputSampleTime,
+                                   const Float32* inBuffer)
+{
+    // The offloaded DSP has to finish within the cycle, so its results are ready for the next one.
+    if(mDSPWorkerPool != nullptr)
+    {
+        mDSPWorkerPool->JoinRT();
+        
+        // Free the buffers of the clients that didn't do IO this cycle.
+        for(OffloadedClient& theClient : mOffloadedClients)
+        {
+            if(theClient.mInUse && theClient.mLastCycle != mOffloadCycle)
+            {
+                theClient.mInUse = false;
+            }
+        }
+        
+        mOffloadCycle++;
+    }
+    
+    CAMutex::Locker theIOLocker(mIOMutex);
+    
+    bool didChangeState =
+            mAudibleState.UpdateWithMixedIO(inIOBufferFrameSize, inOutputSampleTime, inBuffer);
+    
+    // Copy the audio data into our ring buffer.
+    WriteOutputData(inIOBufferFrameSize, inOutputSampleTime, inBuffer);
+    
+    mGlitchTelemetry.CountCycleRT();
+    
+    // The mix is the end of the cycle, so this is how long the cycle's processing took.
+    mDSPBudget.EndCycleRT();
+    
+    return didChangeState;
+}
+
+#pragma mark Loopback Buffer
+
+bool    BGM_IOPipeline::ReadInputData(UInt32 inIOBufferFrameSize,
+                                      Float64 inSampleTime,
+                                      Float32* outBuffer)
+{
+    // Each frame is 2 Float32 samples (one per channel).
+    const size_t theBufferByteSize = inIOBufferFrameSize * sizeof(Float32) * 2;
+
+    // Count it if the client is reading audio that isn't in the buffer (yet or anymore), which
+    // FetchRT replaces with silence. The buffer is only empty before the first mix is written,
+    // which isn't a glitch.
+    BGM_SPSCAudioRingBuffer::SampleTime theStartTime, theEndTime;
+    const BGM_SPSCAudioRingBuffer::SampleTime theReadStartTime =
+            static_cast<BGM_SPSCAudioRingBuffer::SampleTime>(inSampleTime);
+
+    if(mLoopbackRingBuffer.GetTimeBoundsRT(theStartTime, theEndTime) == kCARingBufferError_OK &&
+       theStartTime != theEndTime)
+    {
+        if(theReadStartTime < theStartTime)
+        {
+            mGlitchTelemetry.CountRT(kBGMGlitchOverrun);
+        }
+        else if(theReadStartTime + inIOBufferFrameSize > theEndTime)
+        {
+            mGlitchTelemetry.CountRT(kBGMGlitchUnderrun);
+        }
+    }
+
+    // Copy the audio data from our ring buffer into the provided buffer.
+    CARingBufferError err =
+            mLoopbackRingBuffer.FetchRT(outBuffer, inIOBufferFrameSize, theReadStartTime);
+
+    // Handle errors.
+    switch (err)
+    {
+        case kCARingBufferError_CPUOverload:
+            // Write silence to the buffer.
+            memset(outBuffer, 0, theBufferByteSize);
+            mGlitchTelemetry.CountRT(kBGMGlitchCPUOverload);
+            mRTEventLog.LogRT(0, kBGMIOPipelineRTEventLoopbackFetchOverload, inSampleTime, inIOBufferFrameSize);
+            return false;
+        case kCARingBufferError_TooMuch:
+            // Should be impossible, but handle it just in case. Write silence to the buffer and
+            // return an error code.
+            memset(outBuffer, 0, theBufferByteSize);
+            Throw(CAException(kAudioHardwareIllegalOperationError));
+        case kCARingBufferError_OK:
+            return true;
+        default:
+            throw CAException(kAudioHardwareUnspecifiedError);
+    }
+}
+
+void    BGM_IOPipeline::WriteOutputData(UInt32 inIOBufferFrameSize,
+                                        Float64 inSampleTime,
+                                        const Float32* inBuffer)
+{
+    // The mixes should be contiguous. If they aren't, e.g. because the HAL restarted the device's
+    // sample times or skipped a cycle, the ring buffer has to move its write position.
+    if(mLoopbackEndSampleTime != -1 && inSampleTime != mLoopbackEndSampleTime)
+    {
+        mGlitchTelemetry.CountRT(kBGMGlitchResync);
+    }
+
+    mLoopbackEndSampleTime = inSampleTime + inIOBufferFrameSize;
+
+    // Copy the audio data from the provided buffer into our ring buffer.
+    CARingBufferError err =
+            mLoopbackRingBuffer.StoreRT(inBuffer,
+                                        inIOBufferFrameSize,
+                                        static_cast<BGM_SPSCAudioRingBuffer::SampleTime>(inSampleTime));
+
+    if (err == kCARingBufferError_CPUOverload)
+    {
+        mGlitchTelemetry.CountRT(kBGMGlitchCPUOverload);
+    }
+
+    if (err != kCARingBufferError_OK)
+    {
+        mRTEventLog.LogRT(0, kBGMIOPipelineRTEventLoopbackStoreError, inSampleTime, inIOBufferFrameSize, err);
+    }
+
+    // Return an error code if we failed to store the data. (But ignore CPU overload, which would be
+    // temporary.)
+    if (err != kCARingBufferError_OK && err != kCARingBufferError_CPUOverload)
+    {
+        Throw(CAException(err));
+    }
+}
+
+#pragma mark Per-client Processing
+
+void    BGM_IOPipeline::ApplyClientDSPRT(UInt32 inClientID,
+                                         UInt32 inIOBufferFrameSize,
+                                         bool inBypassEQ,
+                                         const AudioTimeStamp& inOutputTime,
+                                         Float32* ioBuffer)
+{
+    // Measure the client's loudness and apply its loudness normalization gain. This is before its
+    // volume so the user's volume setting is relative to the normalized level.
+    mClients.ApplyLoudnessNormalizationRT(inClientID, ioBuffer, inIOBufferFrameSize);
+    
+    // Apply volume, pan, and EQ to this client's audio (for master output).
+    ApplyClientRelativeVolume(inClientID, inIOBufferFrameSize, inBypassEQ, ioBuffer);
+    
+    // If the client is in one of the crossfader's groups, fade it. The gain is ramped across the
+    // buffer, so the fade is smooth however often the crossfader's position is set.
+    mClients.ApplyCrossfaderGainRT(inClientID, ioBuffer, inIOBufferFrameSize);
+    
+    // Apply the gain changes scheduled for the client's app. They start on the frames whose host
+    // times they were scheduled for, so the buffer is split at their start times.
+    mClients.ApplyAppAutomationRT(inClientID, ioBuffer, inIOBufferFrameSize, inOutputTime);
+}
+
+void    BGM_IOPipeline::ApplyClientRelativeVolume(UInt32 inClientID,
+                                                  UInt32 inIOBufferFrameSize,
+                                                  bool inBypassEQ,
+                                                  Float32* ioBuffer)
+{
+    Float32* theBuffer = ioBuffer;
+    
+    // If the client's app is morphing to a scene, its volume, pan and EQ come from the morph
+    // instead of its settings.
+    BGM_SceneMorphSegment theMorph;
+    bool isMorphing = mClients.GetSceneMorphRT(inClientID, inIOBufferFrameSize, theMorph);
+    
+    Float32 theRelativeVolume =
+        isMorphing ? theMorph.mStartVolume : mClients.GetClientRelativeVolumeRT(inClientID);
+    
+    Float32 thePanPosition =
+        isMorphing ? theMorph.mStartPan : mClients.GetClientPanPositionRT(inClientID) / 100.0f;
+    
+    // Apply per-client 3-band EQ (before volume and pan)
+    BGM_Client* theClient = mClients.GetClientForEQRT(inClientID);
+    if (theClient != nullptr)
+    {
+        // Check if any EQ band is active (non-zero)
+        bool hasEQ = isMorphing ?
+                     theMorph.mHasEQ :
+                     (theClient->mEQLowGain != 0.0f ||
+                      theClient->mEQMidGain != 0.0f ||
+                      theClient->mEQHighGain != 0.0f);
+        
+        const Float32* const theEQCoeffs[BGM_ClientDSPStatePool::kEQBands] = {
+            isMorphing ? theMorph.mEQCoeffs[0] : theClient->mEQLowCoeffs,
+            isMorphing ? theMorph.mEQCoeffs[1] : theClient->mEQMidCoeffs,
+            isMorphing ? theMorph.mEQCoeffs[2] : theClient->mEQHighCoeffs
+        };
+        
+        // The filter states are kept in the client's DSP state slot, which flushes them when the
+        // client goes silent.
+        if (hasEQ && inBypassEQ)
+        {
+            mGlitchTelemetry.CountRT(kBGMGlitchShedEQ);
+        }
+        else if (hasEQ)
+        {
+            mClients.ApplyClientEQRT(*theClient, theEQCoeffs, theBuffer, inIOBufferFrameSize);
+        }
+    }
+    
+    // While morphing, ramp the pan position and volume across the buffer so they change smoothly.
+    if(isMorphing &&
+       (theMorph.mStartPan != theMorph.mEndPan || theMorph.mStartVolume != theMorph.mEndVolume))
+    {
+        const Float32 thePanStep =
+            (theMorph.mEndPan - theMorph.mStartPan) / static_cast<Float32>(inIOBufferFrameSize);
+        const Float32 theVolumeStep =
+            (theMorph.mEndVolume - theMorph.mStartVolume) / static_cast<Float32>(inIOBufferFrameSize);
+        
+        for(UInt32 frame = 0; frame < inIOBufferFrameSize; frame++)
+        {
+            const Float32 thePan = theMorph.mStartPan + thePanStep * static_cast<Float32>(frame);
+            const Float32 theVolume = theMorph.mStartVolume + theVolumeStep * static_cast<Float32>(frame);
+            
+            Float32 left = theBuffer[frame * 2];
+            Float32 right = theBuffer[frame * 2 + 1];
+            
+            // The same balance w/ crossfeed as below
+            if(thePan > 0.0f)
+            {
+                right = right + left * thePan;
+                left = left * (1 - thePan);
+            }
+            else if(thePan < 0.0f)
+            {
+                left = left + right * (-thePan);
+                right = right * (1 + thePan);
+            }
+            
+            left *= theVolume;
+            right *= theVolume;
+            
+            theBuffer[frame * 2] = left < -1.0f ? -1.0f : (left > 1.0f ? 1.0f : left);
+            theBuffer[frame * 2 + 1] = right < -1.0f ? -1.0f : (right > 1.0f ? 1.0f : right);
+        }
+        
+        return;
+    }
+    
+    // TODO When we get around to supporting devices with more than two channels it would be worth looking into
+    //      kAudioFormatProperty_PanningMatrix and kAudioFormatProperty_BalanceFade in AudioFormat.h.
+    
+    // TODO precompute matrix coefficients w/ volume and do everything in one pass
+    
+    // Apply balance w/ crossfeed to the frames in the buffer.
+    // Expect samples interleaved, starting with left
+    if (thePanPosition > 0.0f) {
+        for (UInt32 i = 0; i < inIOBufferFrameSize * 2; i += 2) {
+            auto L = i;
+            auto R = i + 1;
+            
+            theBuffer[R] = theBuffer[R] + theBuffer[L] * thePanPosition;
+            theBuffer[L] = theBuffer[L] * (1 - thePanPosition);
+        }
+    } else if (thePanPosition < 0.0f) {
+        for (UInt32 i = 0; i < inIOBufferFrameSize * 2; i += 2) {
+            auto L = i;
+            auto R = i + 1;
+            
+            theBuffer[L] = theBuffer[L] + theBuffer[R] * (-thePanPosition);
+            theBuffer[R] = theBuffer[R] * (1 + thePanPosition);
+        }
+    }
+
+    if(theRelativeVolume != 1.0f)
+    {
+        for(UInt32 i = 0; i < inIOBufferFrameSize * 2; i++)
+        {
+            Float32 theAdjustedSample = theBuffer[i] * theRelativeVolume;
+            
+            // Clamp to [-1, 1].
+            // (This way is roughly 6 times faster than using std::min and std::max because the compiler can vectorize the loop.)
+            const Float32 theAdjustedSampleClippedBelow = theAdjustedSample < -1.0f ? -1.0f : theAdjustedSample;
+            theBuffer[i] = theAdjustedSampleClippedBelow > 1.0f ? 1.0f : theAdjustedSampleClippedBelow;
+        }
+    }
+}
+
+#pragma clang assume_nonnull end
+
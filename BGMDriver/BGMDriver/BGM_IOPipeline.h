@@ -0,0 +1,319 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_IOPipeline.h
+//  BGMDriver
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  The audio processing BGM_Device does in its IO operations: reading the loopback audio (or
+//  routed audio) for clients' input, the per-client processing in ProcessOutput and storing the
+//  mixed output in the loopback buffer.
+//
+//  BGM_Device owns one and calls it from DoIOOperation, but it only depends on BGM_Clients, so it
+//  can also be driven without the HAL, e.g. by BGM_SimulatedHost in the portable build. (See
+//  BGMDriver/Portable.)
+//
+//  The IO functions are real-time safe. They lock the IO mutex passed to the constructor where
+//  BGM_Device used to, so it still synchronises the device's IO with its other uses of that mutex.
+//
+//  Each IO cycle is timed against its deadline with a BGM_DSPBudget. When a cycle is running out of
+//  time, the optional per-client processing is skipped, depending on the clients' priorities. (See
+//  BGM_DSPBudget.h.)
+//
+//  The per-client DSP can optionally be offloaded to a pool of real-time worker threads (see
+//  SetDSPOffloadWorkerCount), so the cycle's processing is spread across more than one core. The
+//  HAL mixes each client's buffer as soon as its ProcessOutput operation returns, so a client's DSP
+//  can't be waited for in the same operation. Instead, the audio a client gives ProcessOutput is
+//  processed by the workers while the HAL carries on with the other clients, and the result
+//  replaces the client's audio in the next cycle's ProcessOutput. That adds exactly one buffer of
+//  latency to the clients' output, which is why offloading is off by default. BGM_Device reports it
+//  as the output stream's latency. (See GetDSPOffloadLatencyFrames.) The jobs are given
+//  the next cycle's output time, so scheduled automation still starts on the frame it was
+//  scheduled for. The workers are joined before the mix is written, so every cycle's jobs finish
+//  within the cycle.
+//
+
+#ifndef BGMDriver__BGM_IOPipeline
+#define BGMDriver__BGM_IOPipeline
+
+// Local Includes
+#include "BGM_Types.h"
+#include "BGM_AudibleState.h"
+#include "BGM_AudioRingBuffer.h"
+#include "BGM_DSPBudget.h"
+#include "BGM_DSPWorkerPool.h"
+#include "BGM_GlitchTelemetry.h"
+#include "BGM_RTEventLog.h"
+
+// PublicUtility Includes
+#include "CAMutex.h"
+
+// STL Includes
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// System Includes
+#include <CoreAudio/CoreAudioTypes.h>
+
+
+// Forward Declarations
+class BGM_Clients;
+
+
+#pragma clang assume_nonnull begin
+
+// The events logged to BGM_IOPipeline::GetRTEventLog.
+enum BGMIOPipelineRTEvent : UInt16
+{
+    // The loopback audio for a client's input was overwritten while it was being read, so the
+    // client got silence.
+    kBGMIOPipelineRTEventLoopbackFetchOverload,
+    // The mix couldn't be stored in the loopback buffer.
+    kBGMIOPipelineRTEventLoopbackStoreError,
+    // Logged by BGM_Device::DoIOOperation.
+    kBGMIOPipelineRTEventUnexpectedIOOperation,
+    kBGMIOPipelineRTEventTypeCount
+};
+
+class BGM_IOPipeline
+{
+
+public:
+    // The size of the loopback ring buffer, which holds the mixed output for the input stream.
+    #define kLoopbackRingBufferFrameSize    16384
+    
+    // When the DSP is offloaded, the clients after this many in a cycle and the buffers larger than
+    // this are processed on the IO thread, as they are when offloading is off.
+    static constexpr UInt32     kMaxOffloadedClients = 32;
+    static constexpr UInt32     kMaxOffloadedFrames = 4096;
+    
+                                BGM_IOPipeline(BGM_Clients& inClients, CAMutex& inIOMutex);
+                                BGM_IOPipeline(const BGM_IOPipeline&) = delete;
+                                BGM_IOPipeline& operator=(const BGM_IOPipeline&) = delete;
+    
+    /*!
+     Allocate (or re-allocate) the loopback ring buffer. Must be called before any IO and whenever
+     the sample rate changes. Not real-time safe. The caller must stop IO first.
+     */
+    void                        AllocateLoopback();
+    
+    /*!
+     Set the sample rate of the IO cycles, which their time budgets and the timestamps of the
+     offloaded DSP depend on. Not real-time safe. The caller must stop IO first.
+     */
+    void                        SetSampleRate(Float64 inSampleRate);
+    
+    /*!
+     The kAudioServerPlugInIOOperationReadInput operation. Writes the audio for the client's input
+     stream to ioBuffer: the audio routed to it if it has incoming routes, its app's capture
+     submix if it has one or the loopback audio (minus the client's own output for mix-minus
+     clients) otherwise.
+     
+     If the cycle is almost out of time, the routed audio is dropped (for clients that aren't high
+     priority) and the client gets silence instead. inOutputTime is the cycle's output time, which
+     its time budget ends at. (See BGM_DSPBudget.)
+     */
+    void                        ReadInputRT(UInt32 inClientID,
+                                            UInt32 inIOBufferFrameSize,
+                                            Float64 inInputSampleTime,
+                                            const AudioTimeStamp& inOutputTime,
+                                            Float32* ioBuffer);
+    
+    /*!
+     The kAudioServerPlugInIOOperationProcessOutput operation. Classifies and measures the client's
+     audio, updates the audible state and stores the audio for routing before applying the
+     client's loudness normalization, volume, pan, EQ, crossfader gain, automation and ducking in
+     place.
+     
+     If the cycle is running out of time, the classification skips its spectral features and the
+     EQ of low-priority clients is bypassed. High-priority clients are always fully processed.
+     
+     If the DSP is offloaded, the client's gains are applied to its audio on the worker threads and
+     the audio it's left with is the last cycle's, with its gains already applied.
+     
+     @return True if the IO buffer size changed the latency offloading adds, in which case the
+             caller should send a kAudioStreamPropertyLatency notification for the output stream.
+     */
+    bool                        ProcessOutputRT(UInt32 inClientID,
+                                                UInt32 inIOBufferFrameSize,
+                                                const AudioTimeStamp& inOutputTime,
+                                                Float32* ioBuffer);
+    
+    /*!
+     The kAudioServerPlugInIOOperationWriteMix operation. Waits for the cycle's offloaded DSP to
+     finish, if there is any, then updates the audible state with the mixed output and copies it
+     into the loopback ring buffer.
+     
+     @return True if the audible state changed, in which case the caller should send a
+             kAudioDeviceCustomPropertyDeviceAudibleState notification.
+     */
+    bool                        WriteMixRT(UInt32 inIOBufferFrameSize,
+                                           Float64 inOutputSampleTime,
+                                           const Float32* inBuffer);
+    
+    /*!
+     @return The device's current audible state. Read without locking to avoid priority inversions
+             on the IO threads.
+     */
+    BGMDeviceAudibleState       GetAudibleState() const { return mAudibleState.GetState(); }
+    
+    /*!
+     Forget the IO the audible state has seen. Only call this before starting IO, since the audible
+     state is otherwise guarded by the IO mutex.
+     */
+    void                        ResetAudibleState();
+    
+    /*!
+     The time budget of the IO cycles and how much processing is being shed to stay within it. Only
+     call Reset on it before starting IO.
+     */
+    BGM_DSPBudget&              GetDSPBudget() { return mDSPBudget; }
+    
+    /*!
+     Offload the clients' loudness normalization, volume, pan, EQ, crossfader gain and automation to
+     inWorkerCount real-time worker threads, which adds one IO buffer of latency to the clients'
+     output. (See the comment at the top of this file.) 0 stops offloading. Not real-time safe.
+     The caller must stop IO first.
+     
+     @throws CAException if the worker count is more than BGM_DSPWorkerPool::kMaxWorkers or the
+                         workers couldn't be started.
+     */
+    void                        SetDSPOffloadWorkerCount(UInt32 inWorkerCount);
+    /*! @return The number of worker threads the DSP is offloaded to, or 0 if it isn't offloaded. */
+    UInt32                      GetDSPOffloadWorkerCount() const;
+    /*!
+     @return The latency offloading adds to the clients' output, which is the size of the last IO
+             buffer, or 0 if the DSP isn't offloaded or the buffers are too large to offload. Only
+             counts the IO buffers seen since the pipeline was created, so it's 0 before the first
+             one. Real-time safe, but the caller has to make sure the workers aren't being changed.
+     */
+    UInt32                      GetDSPOffloadLatencyFrames() const;
+    
+    /*!
+     Forget the clients' offloaded audio from before IO stopped, so it isn't played when IO starts
+     again. Only call this before starting IO.
+     */
+    void                        ResetDSPOffload();
+    
+    /*!
+     The log for events on the IO thread, which is the only thread that logs to it. Since the HAL
+     calls a device's IO operations on one thread, it has a single channel, 0.
+     */
+    BGM_RTEventLog&             GetRTEventLog() { return mRTEventLog; }
+    
+    /*!
+     The counts of the loopback buffer's underruns, overruns, resyncs and CPU overloads and the IO
+     cycles. BGM_Device also counts its late cycles and the offsets between its input and output
+     sample times here, and the processing the IO operations skip to stay within their time budgets.
+     Published as kAudioDeviceCustomPropertyGlitchTelemetry.
+     */
+    BGM_GlitchTelemetry&        GetGlitchTelemetry() { return mGlitchTelemetry; }
+
+private:
+    /*!
+     Copy the loopback audio for the given sample times into outBuffer.
+
+     @return True if the audio was copied. False if the time bounds of the loopback buffer couldn't
+             be read in time and silence was written to outBuffer instead.
+     */
+    bool                        ReadInputData(UInt32 inIOBufferFrameSize,
+                                              Float64 inSampleTime,
+                                              Float32* outBuffer);
+    void                        WriteOutputData(UInt32 inIOBufferFrameSize,
+                                                Float64 inSampleTime,
+                                                const Float32* inBuffer);
+    /*!
+     The part of ProcessOutput that can be offloaded: loudness normalization, volume, pan, EQ,
+     crossfader gain and automation. Only touches the client's own DSP state, so it can run for
+     different clients at the same time.
+     */
+    void                        ApplyClientDSPRT(UInt32 inClientID,
+                                                 UInt32 inIOBufferFrameSize,
+                                                 bool inBypassEQ,
+                                                 const AudioTimeStamp& inOutputTime,
+                                                 Float32* ioBuffer);
+    /*!
+     Queue the client's audio for the DSP worker threads and replace it with the result of the job
+     queued in the last cycle, or silence if there wasn't one.
+     
+     @return False if the client's DSP can't be offloaded this cycle, in which case ioBuffer is
+             unchanged and the caller should process it on this thread.
+     */
+    bool                        OffloadClientDSPRT(UInt32 inClientID,
+                                                   UInt32 inIOBufferFrameSize,
+                                                   bool inBypassEQ,
+                                                   const AudioTimeStamp& inOutputTime,
+                                                   Float32* ioBuffer);
+    /*! The BGM_DSPWorkerPool job function. inJob is the index of the client in mOffloadedClients. */
+    static void                 ProcessOffloadedClientRT(void* inRefCon, UInt32 inJob);
+    void                        ApplyClientRelativeVolume(UInt32 inClientID,
+                                                          UInt32 inIOBufferFrameSize,
+                                                          bool inBypassEQ,
+                                                          Float32* ioBuffer);
+
+private:
+    BGM_Clients&                mClients;
+    CAMutex&                    mIOMutex;
+    
+    BGM_SPSCAudioRingBuffer     mLoopbackRingBuffer;
+    // The sample time after the last mix written to mLoopbackRingBuffer, or -1 if none has been
+    // written since it was allocated. Guarded by the IO mutex.
+    Float64                     mLoopbackEndSampleTime;
+    BGM_AudibleState            mAudibleState;
+    
+    BGM_RTEventLog              mRTEventLog;
+    BGM_GlitchTelemetry         mGlitchTelemetry;
+    
+    BGM_DSPBudget               mDSPBudget;
+    
+    // A client whose DSP is being offloaded. The IO thread fills one buffer with the client's audio
+    // for a job each cycle, while the other holds the result of the last cycle's job. Only the IO
+    // thread writes the other fields, and only while the client's job isn't queued or running.
+    struct OffloadedClient
+    {
+        bool                    mInUse = false;
+        UInt32                  mClientID = 0;
+        // The cycle the client last queued a job in. Its audio is in mBuffers[mLastCycle % 2].
+        UInt64                  mLastCycle = 0;
+        // The frames in each buffer. 0 if the buffer doesn't hold a result.
+        UInt32                  mFrames[2] = { 0, 0 };
+        std::vector<Float32>    mBuffers[2];
+        // The output time of the cycle the job's result will be played in.
+        AudioTimeStamp          mOutputTime;
+        bool                    mBypassEQ = false;
+    };
+    
+    // Null when the DSP isn't offloaded. Only changed while IO is stopped.
+    std::unique_ptr<BGM_DSPWorkerPool> mDSPWorkerPool;
+    std::vector<OffloadedClient> mOffloadedClients;
+    // Counts the cycles while the DSP is offloaded. Only accessed on the IO thread.
+    UInt64                      mOffloadCycle;
+    // The size of the last IO buffer ProcessOutputRT was given, for GetDSPOffloadLatencyFrames. Only
+    // written on the IO thread.
+    std::atomic<UInt32>         mIOBufferFrameSize;
+    // The length of a frame in host ticks at the sample rate, for offsetting the offloaded DSP's
+    // timestamps.
+    Float64                     mHostTicksPerFrame;
+
+};
+
+#pragma clang assume_nonnull end
+
+#endif /* BGMDriver__BGM_IOPipeline */
+
@@ -0,0 +1,436 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_IOTrace.cpp
+//  BGMDriver
+//
+//  Copyright © 2026 Background Music contributors
+//
+
+// Self Include
+#include "BGM_IOTrace.h"
+
+// PublicUtility Includes
+#include "CADebugMacros.h"
+#include "CAException.h"
+
+// STL Includes
+#include <algorithm>
+#include <chrono>
+
+// System Includes
+#include <CoreFoundation/CoreFoundation.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+
+#pragma clang assume_nonnull begin
+
+// How often the writer thread drains the ring buffer. The IO thread can't wake it, since that isn't
+// real-time safe.
+static const UInt32 kWriterThreadPeriodMS = 20;
+
+#pragma mark Recorder
+
+BGM_IOTraceRecorder::BGM_IOTraceRecorder()
+:
+    mStateMutex("BGM_IOTraceRecorder state"),
+    mRingBuffer(),
+    mWritePosition(0),
+    mReadPosition(0),
+    mIsRecording(false),
+    mRecordAudio(false),
+    mDroppedRecords(0),
+    mFile(nullptr),
+    mPath(),
+    mFileHeader(),
+    mStopWriter(false)
+{
+}
+
+BGM_IOTraceRecorder::~BGM_IOTraceRecorder()
+{
+    Stop();
+}
+
+void    BGM_IOTraceRecorder::Start(const char* inPath, bool inRecordAudio, Float64 inSampleRate)
+{
+    CAMutex::Locker theStateLocker(mStateMutex);
+
+    // CAMutex is recursive, so Stop can take the state mutex again.
+    Stop();
+
+    // Don't overwrite anything that's already at the path.
+    int theFileDescriptor = open(inPath, O_WRONLY | O_CREAT | O_EXCL, 0644);
+
+    if(theFileDescriptor < 0)
+    {
+        LogError("BGM_IOTraceRecorder::Start: Couldn't create %s: %s", inPath, strerror(errno));
+        Throw(CAException(kAudioHardwareIllegalOperationError));
+    }
+
+    mFile = fdopen(theFileDescriptor, "wb");
+
+    if(mFile == nullptr)
+    {
+        close(theFileDescriptor);
+        Throw(CAException(kAudioHardwareUnspecifiedError));
+    }
+
+    mFileHeader.mMagic = kBGMIOTraceMagic;
+    mFileHeader.mVersion = kBGMIOTraceVersion;
+    mFileHeader.mSampleRate = inSampleRate;
+    mFileHeader.mFlags = inRecordAudio ? static_cast<UInt32>(kBGMIOTraceFileFlagHasAudio) : 0u;
+    mFileHeader.mDroppedRecords = 0;
+
+    if(fwrite(&mFileHeader, sizeof(mFileHeader), 1, mFile) != 1)
+    {
+        LogError("BGM_IOTraceRecorder::Start: Couldn't write to %s", inPath);
+        fclose(mFile);
+        mFile = nullptr;
+        unlink(inPath);
+        Throw(CAException(kAudioHardwareUnspecifiedError));
+    }
+
+    // The ring buffer is allocated the first time a trace is recorded and kept after that, since
+    // the IO thread could still be writing to it just after recording stops.
+    if(!mRingBuffer)
+    {
+        mRingBuffer.reset(new UInt8[kRingBufferBytes]);
+    }
+
+    mPath = inPath;
+    mRecordAudio = inRecordAudio;
+    mDroppedRecords = 0;
+    mReadPosition.store(mWritePosition.load(std::memory_order_acquire), std::memory_order_release);
+
+    {
+        std::lock_guard<std::mutex> theLock(mWriterMutex);
+        mStopWriter = false;
+        // Discard any client records queued as the last recording stopped.
+        mPendingRecords.clear();
+    }
+
+    mWriterThread = std::thread(&BGM_IOTraceRecorder::WriterThreadProc, this);
+
+    DebugMsg("BGM_IOTraceRecorder::Start: Recording to %s", inPath);
+
+    mIsRecording.store(true, std::memory_order_release);
+}
+
+void    BGM_IOTraceRecorder::Stop()
+{
+    CAMutex::Locker theStateLocker(mStateMutex);
+
+    if(!IsRecording())
+    {
+        return;
+    }
+
+    mIsRecording.store(false, std::memory_order_release);
+
+    // Let the writer thread finish draining the ring buffer.
+    {
+        std::lock_guard<std::mutex> theLock(mWriterMutex);
+        mStopWriter = true;
+    }
+
+    mWriterWake.notify_one();
+    mWriterThread.join();
+
+    FinishFile();
+
+    DebugMsg("BGM_IOTraceRecorder::Stop: Stopped recording to %s (%u records dropped)",
+             mPath.c_str(),
+             mDroppedRecords.load());
+
+    mPath.clear();
+}
+
+std::string BGM_IOTraceRecorder::GetPath() const
+{
+    CAMutex::Locker theStateLocker(mStateMutex);
+    return mPath;
+}
+
+void    BGM_IOTraceRecorder::RecordOperationRT(BGMIOTraceRecordType inType,
+                                               UInt32 inClientID,
+                                               UInt32 inOperationID,
+                                               UInt32 inIOBufferFrameSize,
+                                               const AudioServerPlugInIOCycleInfo& inIOCycleInfo,
+                                               const Float32* _Nullable inAudio)
+{
+    if(!mIsRecording.load(std::memory_order_acquire))
+    {
+        return;
+    }
+
+    BGM_IOTraceRecord theRecord;
+    theRecord.mType = inType;
+    theRecord.mClientID = inClientID;
+    theRecord.mOperationID = inOperationID;
+    theRecord.mIOBufferFrameSize = inIOBufferFrameSize;
+    theRecord.mIOCycleCounter = inIOCycleInfo.mIOCycleCounter;
+    theRecord.mInputSampleTime = inIOCycleInfo.mInputTime.mSampleTime;
+    theRecord.mOutputSampleTime = inIOCycleInfo.mOutputTime.mSampleTime;
+    theRecord.mOutputHostTime = inIOCycleInfo.mOutputTime.mHostTime;
+    theRecord.mOutputTimeFlags = inIOCycleInfo.mOutputTime.mFlags;
+    theRecord.mPayloadBytes =
+            (mRecordAudio && inAudio != nullptr) ? inIOBufferFrameSize * 2 * sizeof(Float32) : 0;
+
+    const UInt64 theRecordBytes = sizeof(theRecord) + theRecord.mPayloadBytes;
+
+    // Only this thread changes mWritePosition, so it can be read relaxed. mReadPosition only
+    // increases, so the free space can only be underestimated.
+    UInt64 theWritePosition = mWritePosition.load(std::memory_order_relaxed);
+    UInt64 theUsedBytes = theWritePosition - mReadPosition.load(std::memory_order_acquire);
+
+    if(kRingBufferBytes - theUsedBytes < theRecordBytes)
+    {
+        mDroppedRecords++;
+        return;
+    }
+
+    // Copy the record into the ring buffer, wrapping around the end if necessary.
+    auto writeBytes = [&] (const void* inBytes, UInt64 inByteCount) {
+        UInt64 theOffset = theWritePosition % kRingBufferBytes;
+        UInt64 theFirstPart = std::min(inByteCount, kRingBufferBytes - theOffset);
+
+        memcpy(mRingBuffer.get() + theOffset, inBytes, theFirstPart);
+        memcpy(mRingBuffer.get(),
+               reinterpret_cast<const UInt8*>(inBytes) + theFirstPart,
+               inByteCount - theFirstPart);
+
+        theWritePosition += inByteCount;
+    };
+
+    writeBytes(&theRecord, sizeof(theRecord));
+
+    if(theRecord.mPayloadBytes > 0)
+    {
+        writeBytes(inAudio, theRecord.mPayloadBytes);
+    }
+
+    mWritePosition.store(theWritePosition, std::memory_order_release);
+}
+
+void    BGM_IOTraceRecorder::RecordClientAdded(UInt32 inClientID,
+                                               pid_t inProcessID,
+                                               CFStringRef _Nullable inBundleID)
+{
+    if(!IsRecording())
+    {
+        return;
+    }
+
+    BGM_PendingRecord theRecord = {};
+    theRecord.mRecord.mType = kBGMIOTraceRecordClientAdded;
+    theRecord.mRecord.mClientID = inClientID;
+
+    SInt32 theProcessID = inProcessID;
+    theRecord.mPayload.resize(sizeof(theProcessID));
+    memcpy(theRecord.mPayload.data(), &theProcessID, sizeof(theProcessID));
+
+    if(inBundleID != nullptr)
+    {
+        CFIndex theMaxBytes =
+                CFStringGetMaximumSizeForEncoding(CFStringGetLength(inBundleID), kCFStringEncodingUTF8) + 1;
+        std::vector<char> theBundleID(static_cast<size_t>(theMaxBytes), '\0');
+
+        if(CFStringGetCString(inBundleID, theBundleID.data(), theMaxBytes, kCFStringEncodingUTF8))
+        {
+            theRecord.mPayload.insert(theRecord.mPayload.end(),
+                                      theBundleID.data(),
+                                      theBundleID.data() + strlen(theBundleID.data()));
+        }
+    }
+
+    QueuePendingRecord(theRecord);
+}
+
+void    BGM_IOTraceRecorder::RecordClientRemoved(UInt32 inClientID)
+{
+    if(!IsRecording())
+    {
+        return;
+    }
+
+    BGM_PendingRecord theRecord = {};
+    theRecord.mRecord.mType = kBGMIOTraceRecordClientRemoved;
+    theRecord.mRecord.mClientID = inClientID;
+
+    QueuePendingRecord(theRecord);
+}
+
+void    BGM_IOTraceRecorder::QueuePendingRecord(BGM_PendingRecord& inRecord)
+{
+    inRecord.mRecord.mPayloadBytes = static_cast<UInt32>(inRecord.mPayload.size());
+
+    std::lock_guard<std::mutex> theLock(mWriterMutex);
+
+    // Written to the file after everything the IO thread has recorded so far, so a client's
+    // ClientAdded record comes before its IO operations and its ClientRemoved record after them.
+    inRecord.mRingBufferPosition = mWritePosition.load(std::memory_order_acquire);
+    mPendingRecords.push_back(std::move(inRecord));
+}
+
+void    BGM_IOTraceRecorder::WriterThreadProc()
+{
+    bool theShouldStop = false;
+
+    while(!theShouldStop)
+    {
+        std::vector<BGM_PendingRecord> thePendingRecords;
+
+        {
+            std::unique_lock<std::mutex> theLock(mWriterMutex);
+
+            mWriterWake.wait_for(theLock,
+                                 std::chrono::milliseconds(kWriterThreadPeriodMS),
+                                 [&] { return mStopWriter; });
+
+            theShouldStop = mStopWriter;
+            thePendingRecords.swap(mPendingRecords);
+        }
+
+        // Every pending record was queued before this, so their positions are all before it.
+        const UInt64 theEndPosition = mWritePosition.load(std::memory_order_acquire);
+
+        for(const BGM_PendingRecord& theRecord : thePendingRecords)
+        {
+            DrainRingBuffer(theRecord.mRingBufferPosition);
+
+            fwrite(&theRecord.mRecord, sizeof(theRecord.mRecord), 1, mFile);
+
+            if(!theRecord.mPayload.empty())
+            {
+                fwrite(theRecord.mPayload.data(), 1, theRecord.mPayload.size(), mFile);
+            }
+        }
+
+        DrainRingBuffer(theEndPosition);
+    }
+}
+
+void    BGM_IOTraceRecorder::DrainRingBuffer(UInt64 inEndPosition)
+{
+    UInt64 theReadPosition = mReadPosition.load(std::memory_order_relaxed);
+
+    // Records queued before this recording started.
+    if(inEndPosition <= theReadPosition)
+    {
+        return;
+    }
+
+    while(theReadPosition < inEndPosition)
+    {
+        UInt64 theOffset = theReadPosition % kRingBufferBytes;
+        UInt64 theBytes = std::min(inEndPosition - theReadPosition, kRingBufferBytes - theOffset);
+
+        fwrite(mRingBuffer.get() + theOffset, 1, theBytes, mFile);
+
+        theReadPosition += theBytes;
+    }
+
+    mReadPosition.store(theReadPosition, std::memory_order_release);
+}
+
+void    BGM_IOTraceRecorder::FinishFile()
+{
+    // Fill in the number of dropped records now that it's known.
+    mFileHeader.mDroppedRecords = mDroppedRecords.load();
+
+    if(mDroppedRecords.load() > 0)
+    {
+        LogWarning("BGM_IOTraceRecorder::FinishFile: %u records were dropped from %s",
+                   mDroppedRecords.load(),
+                   mPath.c_str());
+    }
+
+    if(fseek(mFile, 0, SEEK_SET) != 0 ||
+       fwrite(&mFileHeader, sizeof(mFileHeader), 1, mFile) != 1)
+    {
+        LogError("BGM_IOTraceRecorder::FinishFile: Couldn't update the header of %s", mPath.c_str());
+    }
+
+    if(fclose(mFile) != 0)
+    {
+        LogError("BGM_IOTraceRecorder::FinishFile: Couldn't write %s: %s", mPath.c_str(), strerror(errno));
+    }
+
+    mFile = nullptr;
+}
+
+#pragma mark Reader
+
+BGM_IOTraceReader::BGM_IOTraceReader(const char* inPath)
+:
+    mFile(fopen(inPath, "rb")),
+    mFileHeader()
+{
+    ThrowIfNULL(mFile,
+                CAException(kAudioHardwareIllegalOperationError),
+                "BGM_IOTraceReader::BGM_IOTraceReader: Couldn't open the file");
+
+    bool theHeaderIsValid = (fread(&mFileHeader, sizeof(mFileHeader), 1, mFile) == 1) &&
+                            (mFileHeader.mMagic == kBGMIOTraceMagic) &&
+                            (mFileHeader.mVersion == kBGMIOTraceVersion);
+
+    if(!theHeaderIsValid)
+    {
+        fclose(mFile);
+        Throw(CAException(kAudioHardwareIllegalOperationError));
+    }
+}
+
+BGM_IOTraceReader::~BGM_IOTraceReader()
+{
+    fclose(mFile);
+}
+
+bool    BGM_IOTraceReader::ReadRecord(BGM_IOTraceRecord& outRecord, std::vector<UInt8>& outPayload)
+{
+    size_t theBytesRead = fread(&outRecord, 1, sizeof(outRecord), mFile);
+
+    if(theBytesRead == 0 && feof(mFile))
+    {
+        return false;
+    }
+
+    ThrowIf(theBytesRead != sizeof(outRecord),
+            CAException(kAudioHardwareIllegalOperationError),
+            "BGM_IOTraceReader::ReadRecord: Truncated record");
+
+    ThrowIf(outRecord.mType < kBGMIOTraceRecordBeginOperation ||
+                    outRecord.mType > kBGMIOTraceRecordClientRemoved ||
+                    outRecord.mPayloadBytes > BGM_IOTraceRecorder::kRingBufferBytes,
+            CAException(kAudioHardwareIllegalOperationError),
+            "BGM_IOTraceReader::ReadRecord: Invalid record");
+
+    outPayload.resize(outRecord.mPayloadBytes);
+
+    ThrowIf(!outPayload.empty() && fread(outPayload.data(), 1, outPayload.size(), mFile) != outPayload.size(),
+            CAException(kAudioHardwareIllegalOperationError),
+            "BGM_IOTraceReader::ReadRecord: Truncated payload");
+
+    return true;
+}
+
+#pragma clang assume_nonnull end
+
@@ -0,0 +1,249 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_IOTrace.h
+//  BGMDriver
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  Records the IO operations BGM_Device performs to a trace file, so the exact sequence of client
+//  IO callbacks, buffer sizes and sample times that caused a problem (e.g. a glitch or the audible
+//  state flapping) can be replayed through the driver's core later. See bgm-io-trace-replay in
+//  BGMDriver/Tools.
+//
+//  The IO thread writes each record to a lock-free ring buffer, which a non-realtime thread drains
+//  to the file. If the ring buffer fills up, records are dropped and counted rather than blocking
+//  the IO thread, so a trace with dropped records can't be replayed exactly.
+//
+//  Only the IO operations and the clients being added and removed are recorded. Changes to the
+//  device's properties, e.g. the app volumes, aren't, so traces should be recorded with the
+//  settings they'll be replayed with.
+//
+
+#ifndef BGMDriver__BGM_IOTrace
+#define BGMDriver__BGM_IOTrace
+
+// PublicUtility Includes
+#include "CAMutex.h"
+
+// STL Includes
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// System Includes
+#include <CoreAudio/AudioServerPlugIn.h>
+#include <stdio.h>
+#include <sys/types.h>
+
+
+#pragma clang assume_nonnull begin
+
+#pragma mark File Format
+
+// A trace file is a BGM_IOTraceFileHeader followed by records, each of which is a BGM_IOTraceRecord
+// followed by mPayloadBytes of payload. All values are in the recording machine's byte order.
+
+#define kBGMIOTraceMagic        'BGMT'
+#define kBGMIOTraceVersion      1
+
+enum BGMIOTraceFileFlags : UInt32
+{
+    // The records of IO operations with audio buffers include the audio.
+    kBGMIOTraceFileFlagHasAudio = (1 << 0)
+};
+
+struct BGM_IOTraceFileHeader
+{
+    UInt32                      mMagic;
+    UInt32                      mVersion;
+    Float64                     mSampleRate;
+    UInt32                      mFlags;
+    // The number of records that didn't fit in the ring buffer. Written when recording stops.
+    UInt32                      mDroppedRecords;
+};
+
+enum BGMIOTraceRecordType : UInt32
+{
+    // BeginIOOperation, DoIOOperation and EndIOOperation. For DoIOOperation, the payload is the
+    // audio the operation was given, i.e. the client's unprocessed output for
+    // kAudioServerPlugInIOOperationProcessOutput and the mix for the mix operations, except for
+    // kAudioServerPlugInIOOperationReadInput, where it's the audio the operation read.
+    kBGMIOTraceRecordBeginOperation = 1,
+    kBGMIOTraceRecordDoOperation,
+    kBGMIOTraceRecordEndOperation,
+    // The audio kAudioServerPlugInIOOperationProcessOutput returned to the HAL. Follows the
+    // operation's kBGMIOTraceRecordDoOperation record.
+    kBGMIOTraceRecordOperationResult,
+    // A client was added. The payload is its pid_t, as an SInt32, followed by its bundle ID in
+    // UTF-8 (not null-terminated), if it has one.
+    kBGMIOTraceRecordClientAdded,
+    kBGMIOTraceRecordClientRemoved
+};
+
+struct BGM_IOTraceRecord
+{
+    UInt32                      mType;
+    UInt32                      mClientID;
+    UInt32                      mOperationID;
+    UInt32                      mIOBufferFrameSize;
+    UInt64                      mIOCycleCounter;
+    Float64                     mInputSampleTime;
+    Float64                     mOutputSampleTime;
+    UInt64                      mOutputHostTime;
+    // The AudioTimeStampFlags of the cycle's output time.
+    UInt32                      mOutputTimeFlags;
+    UInt32                      mPayloadBytes;
+};
+
+#pragma mark Recorder
+
+class BGM_IOTraceRecorder
+{
+
+public:
+    // The size of the ring buffer between the IO thread and the thread that writes the file. About
+    // five seconds of stereo audio for four clients at 48 kHz.
+    static const UInt32         kRingBufferBytes = 32 * 1024 * 1024;
+
+                                BGM_IOTraceRecorder();
+                                ~BGM_IOTraceRecorder();
+                                BGM_IOTraceRecorder(const BGM_IOTraceRecorder&) = delete;
+                                BGM_IOTraceRecorder& operator=(const BGM_IOTraceRecorder&) = delete;
+
+    /*!
+     Start recording to a new file at inPath, stopping the current recording first if there is one.
+     Doesn't overwrite existing files. Not real-time safe.
+
+     @throws CAException If the file couldn't be created.
+     */
+    void                        Start(const char* inPath, bool inRecordAudio, Float64 inSampleRate);
+    /*!
+     Stop recording and finish writing the file. Not real-time safe. An IO operation that was being
+     recorded when this is called can end up at the start of the next recording.
+     */
+    void                        Stop();
+
+    bool                        IsRecording() const { return mIsRecording.load(std::memory_order_acquire); }
+    bool                        IsRecordingAudio() const { return mRecordAudio; }
+    /*! The path of the current recording, or an empty string if not recording. */
+    std::string                 GetPath() const;
+    /*! The number of records dropped from the current (or last) recording. */
+    UInt32                      GetDroppedRecordCount() const { return mDroppedRecords.load(); }
+
+    /*!
+     Record an IO operation. Does nothing if not recording. Real-time safe, but only one thread may
+     call it at a time, which is true of the IO thread of a device.
+
+     @param inAudio The interleaved stereo audio to store with the record if audio is being
+                    recorded. Can be null.
+     */
+    void                        RecordOperationRT(BGMIOTraceRecordType inType,
+                                                  UInt32 inClientID,
+                                                  UInt32 inOperationID,
+                                                  UInt32 inIOBufferFrameSize,
+                                                  const AudioServerPlugInIOCycleInfo& inIOCycleInfo,
+                                                  const Float32* _Nullable inAudio);
+
+    /*! Record a client being added or removed. Not real-time safe. Does nothing if not recording. */
+    void                        RecordClientAdded(UInt32 inClientID,
+                                                  pid_t inProcessID,
+                                                  CFStringRef _Nullable inBundleID);
+    void                        RecordClientRemoved(UInt32 inClientID);
+
+private:
+    // A record from a non-realtime thread, waiting to be written to the file after the records the
+    // IO thread had written to the ring buffer when it was queued.
+    struct BGM_PendingRecord
+    {
+        UInt64                  mRingBufferPosition;
+        BGM_IOTraceRecord       mRecord;
+        std::vector<UInt8>      mPayload;
+    };
+
+    void                        QueuePendingRecord(BGM_PendingRecord& inRecord);
+    void                        WriterThreadProc();
+    /*! Write the records in the ring buffer up to inEndPosition to the file. */
+    void                        DrainRingBuffer(UInt64 inEndPosition);
+    void                        FinishFile();
+
+private:
+    // Guards the non-realtime state. Never taken by the IO thread.
+    mutable CAMutex             mStateMutex;
+
+    std::unique_ptr<UInt8[]>    mRingBuffer;
+    // Total bytes written and read. Only the IO thread writes mWritePosition and only the writer
+    // thread writes mReadPosition.
+    std::atomic<UInt64>         mWritePosition;
+    std::atomic<UInt64>         mReadPosition;
+
+    std::atomic<bool>           mIsRecording;
+    bool                        mRecordAudio;
+    std::atomic<UInt32>         mDroppedRecords;
+
+    FILE* _Nullable             mFile;
+    std::string                 mPath;
+    BGM_IOTraceFileHeader       mFileHeader;
+
+    std::thread                 mWriterThread;
+    std::mutex                  mWriterMutex;
+    std::condition_variable     mWriterWake;
+    bool                        mStopWriter;
+    std::vector<BGM_PendingRecord> mPendingRecords;
+
+};
+
+#pragma mark Reader
+
+class BGM_IOTraceReader
+{
+
+public:
+    /*!
+     Open a trace file and read its header.
+
+     @throws CAException If the file couldn't be opened or isn't a trace.
+     */
+                                BGM_IOTraceReader(const char* inPath);
+                                ~BGM_IOTraceReader();
+                                BGM_IOTraceReader(const BGM_IOTraceReader&) = delete;
+                                BGM_IOTraceReader& operator=(const BGM_IOTraceReader&) = delete;
+
+    const BGM_IOTraceFileHeader& GetFileHeader() const { return mFileHeader; }
+
+    /*!
+     Read the next record and its payload.
+
+     @return False at the end of the file.
+     @throws CAException If the file is truncated or corrupt.
+     */
+    bool                        ReadRecord(BGM_IOTraceRecord& outRecord, std::vector<UInt8>& outPayload);
+
+private:
+    FILE*                       mFile;
+    BGM_IOTraceFileHeader       mFileHeader;
+
+};
+
+#pragma clang assume_nonnull end
+
+#endif /* BGMDriver__BGM_IOTrace */
+
@@ -0,0 +1,323 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_LoudnessMeter.cpp
+//  BGMDriver
+//
+//  Copyright © 2026 Background Music contributors
+//
+
+// Self Include
+#include "BGM_LoudnessMeter.h"
+
+// Local Includes
+#include "BGM_DSPContext.h"
+#include "BGM_GainRamp.h"
+
+// STL Includes
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+
+#pragma clang assume_nonnull begin
+
+BGM_LoudnessMeter::BGM_LoudnessMeter(Float64 inSampleRate)
+:
+    mSampleRate(inSampleRate),
+    mNormalizationEnabled(false),
+    mTargetLUFS(kBGMLoudnessNormalizationDefaultTargetLUFS),
+    mMaxSlewDBPerSec(kBGMLoudnessNormalizationDefaultMaxSlewDBPerSec),
+    mMaxGainDB(kBGMLoudnessNormalizationDefaultMaxGainDB),
+    mMomentaryLUFS(kBGMLoudnessMinLUFS),
+    mShortTermLUFS(kBGMLoudnessMinLUFS),
+    mIntegratedLUFS(kBGMLoudnessMinLUFS),
+    mGainDB(0.0f),
+    mFilterSampleRate(inSampleRate)
+{
+    ResetRT();
+}
+
+void    BGM_LoudnessMeter::SetSampleRate(Float64 inSampleRate)
+{
+    mSampleRate.store(inSampleRate, std::memory_order_relaxed);
+}
+
+void    BGM_LoudnessMeter::SetNormalization(const Normalization& inNormalization)
+{
+    mNormalizationEnabled.store(inNormalization.mEnabled, std::memory_order_relaxed);
+    mTargetLUFS.store(inNormalization.mTargetLUFS, std::memory_order_relaxed);
+    mMaxSlewDBPerSec.store(inNormalization.mMaxSlewDBPerSec, std::memory_order_relaxed);
+    mMaxGainDB.store(inNormalization.mMaxGainDB, std::memory_order_relaxed);
+}
+
+void    BGM_LoudnessMeter::ResetRT()
+{
+    CalculateKWeighting(mFilterSampleRate, mHighShelf, mHighPass);
+
+    // The sub-blocks are 100 ms.
+    mSubBlockFrames = std::max(1u, static_cast<UInt32>(std::lround(mFilterSampleRate / 10.0)));
+
+    std::memset(mHighShelfState, 0, sizeof(mHighShelfState));
+    std::memset(mHighPassState, 0, sizeof(mHighPassState));
+
+    mSubBlockSum = 0.0;
+    mSubBlockFramesDone = 0;
+    std::memset(mSubBlocks, 0, sizeof(mSubBlocks));
+    mSubBlockCount = 0;
+
+    std::memset(mHistogramCounts, 0, sizeof(mHistogramCounts));
+    std::memset(mHistogramSums, 0, sizeof(mHistogramSums));
+    mGatedBlockCount = 0;
+    mGatedBlockSum = 0.0;
+
+    mMomentaryLUFS.store(kBGMLoudnessMinLUFS, std::memory_order_relaxed);
+    mShortTermLUFS.store(kBGMLoudnessMinLUFS, std::memory_order_relaxed);
+    mIntegratedLUFS.store(kBGMLoudnessMinLUFS, std::memory_order_relaxed);
+}
+
+void    BGM_LoudnessMeter::ProcessRT(Float32* ioBuffer, UInt32 inFrameCount)
+{
+    const Float64 theSampleRate = mSampleRate.load(std::memory_order_relaxed);
+
+    if(theSampleRate != mFilterSampleRate)
+    {
+        mFilterSampleRate = theSampleRate;
+        ResetRT();
+    }
+
+    // Once the input is silent and the filters' states have decayed, the weighted signal is zero,
+    // so the filters can be skipped. Flushing the states also keeps them from becoming subnormal.
+    bool isSettled = BGM_DSPContext::IsSilentRT(ioBuffer, inFrameCount * kChannels);
+
+    if(isSettled)
+    {
+        isSettled = BGM_DSPContext::FlushStateRT(&mHighShelfState[0][0], kChannels * 2);
+        isSettled = BGM_DSPContext::FlushStateRT(&mHighPassState[0][0], kChannels * 2) && isSettled;
+    }
+
+    // The filters are recursive, so they have to be run sample by sample. Their state is kept in
+    // double precision because the high-pass filter's poles are very close to the unit circle.
+    for(UInt32 theFrame = 0; theFrame < inFrameCount; theFrame++)
+    {
+        for(UInt32 theChannel = 0; !isSettled && theChannel < kChannels; theChannel++)
+        {
+            const Float64 theInput = ioBuffer[theFrame * kChannels + theChannel];
+            Float64* theShelfState = mHighShelfState[theChannel];
+            Float64* thePassState = mHighPassState[theChannel];
+
+            const Float64 theShelved = mHighShelf[0] * theInput + theShelfState[0];
+            theShelfState[0] = mHighShelf[1] * theInput - mHighShelf[3] * theShelved + theShelfState[1];
+            theShelfState[1] = mHighShelf[2] * theInput - mHighShelf[4] * theShelved;
+
+            const Float64 theWeighted = mHighPass[0] * theShelved + thePassState[0];
+            thePassState[0] = mHighPass[1] * theShelved - mHighPass[3] * theWeighted + thePassState[1];
+            thePassState[1] = mHighPass[2] * theShelved - mHighPass[4] * theWeighted;
+
+            // Both channels have a weight of 1.0.
+            mSubBlockSum += theWeighted * theWeighted;
+        }
+
+        if(++mSubBlockFramesDone == mSubBlockFrames)
+        {
+            CompleteSubBlockRT();
+        }
+    }
+
+    ApplyNormalizationRT(ioBuffer, inFrameCount);
+}
+
+void    BGM_LoudnessMeter::CompleteSubBlockRT()
+{
+    mSubBlocks[mSubBlockCount % kShortTermSubBlocks] = mSubBlockSum / mSubBlockFrames;
+    mSubBlockCount++;
+
+    mSubBlockSum = 0.0;
+    mSubBlockFramesDone = 0;
+
+    if(mSubBlockCount < kMomentarySubBlocks)
+    {
+        return;
+    }
+
+    // The mean square of the latest inSubBlocks sub-blocks.
+    auto theMeanOfLatest = [&] (UInt64 inSubBlocks) {
+        Float64 theSum = 0.0;
+
+        for(UInt64 i = mSubBlockCount - inSubBlocks; i < mSubBlockCount; i++)
+        {
+            theSum += mSubBlocks[i % kShortTermSubBlocks];
+        }
+
+        return theSum / inSubBlocks;
+    };
+
+    // Until there's 3 s of audio, the short-term loudness is measured over as much as there is.
+    const Float64 theBlockMeanSquare = theMeanOfLatest(kMomentarySubBlocks);
+    const UInt64 theShortTermSubBlocks =
+            (mSubBlockCount < kShortTermSubBlocks) ? mSubBlockCount : kShortTermSubBlocks;
+
+    mMomentaryLUFS.store(LoudnessOfMeanSquare(theBlockMeanSquare), std::memory_order_relaxed);
+    mShortTermLUFS.store(LoudnessOfMeanSquare(theMeanOfLatest(theShortTermSubBlocks)),
+                         std::memory_order_relaxed);
+
+    // The momentary window is also the latest gating block. (They overlap by 75%.)
+    const Float32 theBlockLUFS = LoudnessOfMeanSquare(theBlockMeanSquare);
+
+    if(theBlockLUFS > kAbsoluteGateLUFS)
+    {
+        const UInt32 theBin = std::min(kHistogramBins - 1,
+                                       static_cast<UInt32>((theBlockLUFS - kAbsoluteGateLUFS) / kHistogramStepLU));
+
+        mHistogramCounts[theBin]++;
+        mHistogramSums[theBin] += theBlockMeanSquare;
+        mGatedBlockCount++;
+        mGatedBlockSum += theBlockMeanSquare;
+
+        mIntegratedLUFS.store(CalculateIntegratedLUFS(), std::memory_order_relaxed);
+    }
+}
+
+Float32 BGM_LoudnessMeter::CalculateIntegratedLUFS() const
+{
+    if(mGatedBlockCount == 0)
+    {
+        return kBGMLoudnessMinLUFS;
+    }
+
+    // The relative gate is kRelativeGateLU below the mean of the blocks over the absolute gate.
+    const Float64 theRelativeGate =
+            mGatedBlockSum / mGatedBlockCount * std::pow(10.0, kRelativeGateLU / 10.0);
+    const Float32 theRelativeGateLUFS = LoudnessOfMeanSquare(theRelativeGate);
+
+    const UInt32 theFirstBin = (theRelativeGateLUFS > kAbsoluteGateLUFS) ?
+            static_cast<UInt32>((theRelativeGateLUFS - kAbsoluteGateLUFS) / kHistogramStepLU) :
+            0;
+
+    UInt64 theCount = 0;
+    Float64 theSum = 0.0;
+
+    for(UInt32 theBin = theFirstBin; theBin < kHistogramBins; theBin++)
+    {
+        // Only the first bin can have blocks on both sides of the gate. They're all counted if their
+        // mean is over it, which is within kHistogramStepLU of gating each block separately.
+        if(mHistogramCounts[theBin] != 0 &&
+           mHistogramSums[theBin] / mHistogramCounts[theBin] > theRelativeGate)
+        {
+            theCount += mHistogramCounts[theBin];
+            theSum += mHistogramSums[theBin];
+        }
+    }
+
+    return (theCount > 0) ? LoudnessOfMeanSquare(theSum / theCount) : kBGMLoudnessMinLUFS;
+}
+
+void    BGM_LoudnessMeter::ApplyNormalizationRT(Float32* ioBuffer, UInt32 inFrameCount)
+{
+    const Float32 theMaxGainDB = mMaxGainDB.load(std::memory_order_relaxed);
+
+    // Slew back to unity gain if normalization is off.
+    Float32 theTargetGainDB = 0.0f;
+
+    if(mNormalizationEnabled.load(std::memory_order_relaxed))
+    {
+        const Float32 theTargetLUFS = mTargetLUFS.load(std::memory_order_relaxed);
+        const Float32 theShortTermLUFS = mShortTermLUFS.load(std::memory_order_relaxed);
+
+        // Hold the gain while the client is much quieter than the target, e.g. silent or between
+        // songs, so it isn't boosted all the way up and then too loud when it starts again.
+        theTargetGainDB = (theShortTermLUFS < theTargetLUFS - kNormalizationHoldLU) ?
+                mCurrentGainDB :
+                theTargetLUFS - theShortTermLUFS;
+
+        theTargetGainDB = std::min(theMaxGainDB, std::max(-theMaxGainDB, theTargetGainDB));
+    }
+
+    const Float32 theMaxStepDB = static_cast<Float32>(mMaxSlewDBPerSec.load(std::memory_order_relaxed) *
+                                                      inFrameCount / mFilterSampleRate);
+    const Float32 theEndGainDB =
+            mCurrentGainDB + std::min(theMaxStepDB, std::max(-theMaxStepDB, theTargetGainDB - mCurrentGainDB));
+
+    if(mCurrentGainDB != 0.0f || theEndGainDB != 0.0f)
+    {
+        BGM_GainRamp::RampMultiplyRT(ioBuffer,
+                                     inFrameCount,
+                                     kChannels,
+                                     std::pow(10.0f, mCurrentGainDB / 20.0f),
+                                     std::pow(10.0f, theEndGainDB / 20.0f));
+    }
+
+    mCurrentGainDB = theEndGainDB;
+    mGainDB.store(theEndGainDB, std::memory_order_relaxed);
+}
+
+#pragma mark Kernels
+
+void    BGM_LoudnessMeter::CalculateKWeighting(Float64 inSampleRate,
+                                               Coefficients& outHighShelf,
+                                               Coefficients& outHighPass)
+{
+    // BS.1770 only gives the coefficients for 48 kHz. These are the analogue prototypes they were
+    // designed from, so the filters can be recalculated for other sample rates with the bilinear
+    // transform.
+
+    // The high shelf, which models the acoustic effect of the head: about +4 dB above 2 kHz.
+    {
+        const Float64 theFrequency = 1681.974450955533;
+        const Float64 theGainDB = 3.999843853973347;
+        const Float64 theQ = 0.7071752369554196;
+
+        const Float64 K = std::tan(M_PI * theFrequency / inSampleRate);
+        const Float64 Vh = std::pow(10.0, theGainDB / 20.0);
+        const Float64 Vb = std::pow(Vh, 0.4996667741545416);
+        const Float64 a0 = 1.0 + K / theQ + K * K;
+
+        outHighShelf[0] = (Vh + Vb * K / theQ + K * K) / a0;
+        outHighShelf[1] = 2.0 * (K * K - Vh) / a0;
+        outHighShelf[2] = (Vh - Vb * K / theQ + K * K) / a0;
+        outHighShelf[3] = 2.0 * (K * K - 1.0) / a0;
+        outHighShelf[4] = (1.0 - K / theQ + K * K) / a0;
+    }
+
+    // The "RLB" high-pass filter.
+    {
+        const Float64 theFrequency = 38.13547087602444;
+        const Float64 theQ = 0.5003270373238773;
+
+        const Float64 K = std::tan(M_PI * theFrequency / inSampleRate);
+        const Float64 a0 = 1.0 + K / theQ + K * K;
+
+        outHighPass[0] = 1.0;
+        outHighPass[1] = -2.0;
+        outHighPass[2] = 1.0;
+        outHighPass[3] = 2.0 * (K * K - 1.0) / a0;
+        outHighPass[4] = (1.0 - K / theQ + K * K) / a0;
+    }
+}
+
+Float32 BGM_LoudnessMeter::LoudnessOfMeanSquare(Float64 inMeanSquare)
+{
+    if(inMeanSquare <= 0.0)
+    {
+        return kBGMLoudnessMinLUFS;
+    }
+
+    return std::max(kBGMLoudnessMinLUFS, static_cast<Float32>(-0.691 + 10.0 * std::log10(inMeanSquare)));
+}
+
+#pragma clang assume_nonnull end
+
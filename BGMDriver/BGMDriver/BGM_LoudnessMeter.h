@@ -0,0 +1,197 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_LoudnessMeter.h
+//  BGMDriver
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  Measures the loudness of a client's audio as specified by EBU R128 and ITU-R BS.1770, and
+//  optionally applies a slowly changing gain to normalize it. See
+//  kAudioDeviceCustomPropertyLoudness and kAudioDeviceCustomPropertyLoudnessNormalization.
+//
+//  The audio is K-weighted (a high shelf and a high-pass filter) and its mean square is summed
+//  over 100 ms sub-blocks. The momentary and short-term loudness are the means of the last 4 and
+//  30 sub-blocks. Each 400 ms window is also a gating block for the integrated loudness. Rather
+//  than storing the blocks, they're added to a histogram with kHistogramStepLU-wide bins, so the
+//  gating takes a fixed amount of memory and time however long the client plays.
+//
+//  The normalization gain moves towards the target minus the short-term loudness at no more than
+//  the maximum slew rate, and is held while the client is much quieter than the target, e.g.
+//  between songs. The audio is measured before the gain is applied.
+//
+//  The normalization settings and sample rate can be changed from any thread without locking.
+//  ProcessRT must only be called from the IO thread. The loudness values can be read from any
+//  thread.
+//
+
+#ifndef BGMDriver__BGM_LoudnessMeter
+#define BGMDriver__BGM_LoudnessMeter
+
+// Local Includes
+#include "BGM_Types.h"
+
+// System Includes
+#include <MacTypes.h>
+
+// STL Includes
+#include <atomic>
+
+
+#pragma clang assume_nonnull begin
+
+class BGM_LoudnessMeter
+{
+
+public:
+    struct Normalization
+    {
+        bool            mEnabled = false;
+        Float32         mTargetLUFS = kBGMLoudnessNormalizationDefaultTargetLUFS;
+        Float32         mMaxSlewDBPerSec = kBGMLoudnessNormalizationDefaultMaxSlewDBPerSec;
+        Float32         mMaxGainDB = kBGMLoudnessNormalizationDefaultMaxGainDB;
+
+        bool operator==(const Normalization& other) const {
+            return mEnabled == other.mEnabled &&
+                   mTargetLUFS == other.mTargetLUFS &&
+                   mMaxSlewDBPerSec == other.mMaxSlewDBPerSec &&
+                   mMaxGainDB == other.mMaxGainDB;
+        }
+
+        bool operator!=(const Normalization& other) const { return !(*this == other); }
+    };
+
+    // The coefficients of a biquad filter, in the order b0, b1, b2, a1, a2 (with a0 normalized to
+    // 1), like BGM_Client's EQ coefficients.
+    typedef Float64     Coefficients[5];
+
+    // Gating blocks quieter than this aren't counted in the integrated loudness.
+    static constexpr Float32    kAbsoluteGateLUFS = -70.0f;
+    // Nor are blocks more than this much quieter than the mean of the blocks over the absolute gate.
+    static constexpr Float32    kRelativeGateLU = -10.0f;
+    // The normalization gain is held while the short-term loudness is this far below the target.
+    static constexpr Float32    kNormalizationHoldLU = 20.0f;
+
+    explicit            BGM_LoudnessMeter(Float64 inSampleRate);
+
+    /*!
+     Set the sample rate of the audio ProcessRT will be given. Can be called from any thread. The
+     measurements start again from the next IO cycle.
+     */
+    void                SetSampleRate(Float64 inSampleRate);
+
+    /*! Change the normalization settings. Can be called from any thread. */
+    void                SetNormalization(const Normalization& inNormalization);
+
+    /*!
+     Measure the client's audio for an IO cycle and then apply the normalization gain to it.
+
+     @param ioBuffer The client's audio. Interleaved stereo.
+     @param inFrameCount The number of frames in ioBuffer.
+     */
+    void                ProcessRT(Float32* ioBuffer, UInt32 inFrameCount);
+
+    /*! The loudness values in LUFS, or kBGMLoudnessMinLUFS if there hasn't been enough audio. */
+    Float32             GetMomentaryLUFS() const { return mMomentaryLUFS.load(std::memory_order_relaxed); }
+    Float32             GetShortTermLUFS() const { return mShortTermLUFS.load(std::memory_order_relaxed); }
+    Float32             GetIntegratedLUFS() const { return mIntegratedLUFS.load(std::memory_order_relaxed); }
+
+    /*! The normalization gain at the end of the last IO cycle, in dB. */
+    Float32             GetGainDB() const { return mGainDB.load(std::memory_order_relaxed); }
+
+#pragma mark Kernels
+
+    /*! Calculate the coefficients of the two K-weighting filters for the sample rate. */
+    static void         CalculateKWeighting(Float64 inSampleRate,
+                                            Coefficients& outHighShelf,
+                                            Coefficients& outHighPass);
+
+    /*! @return The loudness in LUFS of K-weighted audio with the given mean square, summed over the channels. */
+    static Float32      LoudnessOfMeanSquare(Float64 inMeanSquare);
+
+private:
+    static constexpr UInt32     kChannels = 2;
+    static constexpr UInt32     kMomentarySubBlocks = 4;
+    static constexpr UInt32     kShortTermSubBlocks = 30;
+
+    // The histogram covers kAbsoluteGateLUFS to kHistogramMaxLUFS. Louder blocks go in the top bin.
+    static constexpr Float32    kHistogramStepLU = 0.1f;
+    static constexpr Float32    kHistogramMaxLUFS = 10.0f;
+    static constexpr UInt32     kHistogramBins = 800;
+
+    /*! Clear the measurements and set up the filters for mFilterSampleRate. */
+    void                ResetRT();
+
+    /*! Add the last sub-block to the windows and gating histogram and update the loudness values. */
+    void                CompleteSubBlockRT();
+
+    /*! Recalculate the integrated loudness from the gating histogram. */
+    Float32             CalculateIntegratedLUFS() const;
+
+    /*! Move the normalization gain for this IO cycle and apply it to the buffer. */
+    void                ApplyNormalizationRT(Float32* ioBuffer, UInt32 inFrameCount);
+
+    std::atomic<Float64>        mSampleRate;
+
+    // The normalization settings.
+    std::atomic<bool>           mNormalizationEnabled;
+    std::atomic<Float32>        mTargetLUFS;
+    std::atomic<Float32>        mMaxSlewDBPerSec;
+    std::atomic<Float32>        mMaxGainDB;
+
+    // The results.
+    std::atomic<Float32>        mMomentaryLUFS;
+    std::atomic<Float32>        mShortTermLUFS;
+    std::atomic<Float32>        mIntegratedLUFS;
+    std::atomic<Float32>        mGainDB;
+
+    // Only used on the IO thread.
+
+    // The sample rate the filters and sub-blocks were set up for.
+    Float64                     mFilterSampleRate = 0.0;
+    UInt32                      mSubBlockFrames = 0;
+
+    Coefficients                mHighShelf;
+    Coefficients                mHighPass;
+    // Each filter's state, for each channel, in transposed direct form II.
+    Float64                     mHighShelfState[kChannels][2];
+    Float64                     mHighPassState[kChannels][2];
+
+    // The sum of the squares of the current sub-block's filtered samples and the number of frames
+    // in it so far.
+    Float64                     mSubBlockSum = 0.0;
+    UInt32                      mSubBlockFramesDone = 0;
+
+    // The mean squares of the latest sub-blocks, in a ring buffer, and the number written.
+    Float64                     mSubBlocks[kShortTermSubBlocks];
+    UInt64                      mSubBlockCount = 0;
+
+    // The gating histogram. The number of gating blocks in each bin and the sum of their mean
+    // squares, and the totals for all of the bins.
+    UInt32                      mHistogramCounts[kHistogramBins];
+    Float64                     mHistogramSums[kHistogramBins];
+    UInt64                      mGatedBlockCount = 0;
+    Float64                     mGatedBlockSum = 0.0;
+
+    Float32                     mCurrentGainDB = 0.0f;
+
+};
+
+#pragma clang assume_nonnull end
+
+#endif /* BGMDriver__BGM_LoudnessMeter */
+
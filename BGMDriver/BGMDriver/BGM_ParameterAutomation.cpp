@@ -0,0 +1,173 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_ParameterAutomation.cpp
+//  BGMDriver
+//
+//  Copyright © 2026 Background Music contributors
+//
+
+// Self Include
+#include "BGM_ParameterAutomation.h"
+
+// Local Includes
+#include "BGM_GainRamp.h"
+
+// STL Includes
+#include <algorithm>
+#include <cmath>
+
+
+#pragma clang assume_nonnull begin
+
+BGM_ParameterAutomation::BGM_ParameterAutomation(Float32 inInitialValue)
+:
+    mEvents(),
+    mValue(inInitialValue)
+{
+}
+
+bool    BGM_ParameterAutomation::ScheduleEvent(const Event& inEvent)
+{
+    UInt32 theWriteIndex = mWriteIndex.load(std::memory_order_relaxed);
+    UInt32 theNextWriteIndex = (theWriteIndex + 1) % mEvents.size();
+
+    if(theNextWriteIndex == mReadIndex.load(std::memory_order_acquire))
+    {
+        // Full.
+        return false;
+    }
+
+    mEvents[theWriteIndex] = inEvent;
+
+    // Publish the event to the IO thread.
+    mWriteIndex.store(theNextWriteIndex, std::memory_order_release);
+
+    return true;
+}
+
+UInt32  BGM_ParameterAutomation::GetPendingEventCount() const
+{
+    UInt32 theReadIndex = mReadIndex.load(std::memory_order_acquire);
+    UInt32 theWriteIndex = mWriteIndex.load(std::memory_order_acquire);
+
+    return static_cast<UInt32>((theWriteIndex + mEvents.size() - theReadIndex) % mEvents.size());
+}
+
+void    BGM_ParameterAutomation::ApplyGainRT(Float32* ioBuffer,
+                                             UInt32 inFrameCount,
+                                             Float64 inSampleTime,
+                                             Float64 inTime,
+                                             Float64 inTimeUnitsPerFrame)
+{
+    const SInt64 theBufferStart = static_cast<SInt64>(std::llround(inSampleTime));
+    const SInt64 theBufferEnd = theBufferStart + inFrameCount;
+
+    // Converts an event's time to the sample time of the frame it starts on.
+    auto theEventSampleTime = [&] (const Event& inEvent) -> SInt64 {
+        return theBufferStart +
+               static_cast<SInt64>(std::llround((inEvent.mTime - inTime) / inTimeUnitsPerFrame));
+    };
+
+    SInt64 theFrame = theBufferStart;
+
+    while(theFrame < theBufferEnd)
+    {
+        // Start the events that are due. Look at the next event, if there is one, without removing
+        // it from the queue yet.
+        UInt32 theReadIndex = mReadIndex.load(std::memory_order_relaxed);
+        bool hasNextEvent = (theReadIndex != mWriteIndex.load(std::memory_order_acquire));
+
+        while(hasNextEvent && theEventSampleTime(mEvents[theReadIndex]) <= theFrame)
+        {
+            StartEventRT(mEvents[theReadIndex], theEventSampleTime(mEvents[theReadIndex]));
+
+            theReadIndex = (theReadIndex + 1) % mEvents.size();
+            mReadIndex.store(theReadIndex, std::memory_order_release);
+            hasNextEvent = (theReadIndex != mWriteIndex.load(std::memory_order_acquire));
+        }
+
+        // The gain is linear until the next event starts or the current ramp finishes, so apply it
+        // to the frames up to then in one go.
+        SInt64 theSegmentEnd = theBufferEnd;
+
+        if(hasNextEvent)
+        {
+            theSegmentEnd = std::min(theSegmentEnd, theEventSampleTime(mEvents[theReadIndex]));
+        }
+
+        bool isRamping = (mRampFrames > 1) && (theFrame < mRampStartTime + mRampFrames - 1);
+
+        if(isRamping)
+        {
+            // The ramp reaches its target on its last frame, which starts a constant segment.
+            theSegmentEnd = std::min(theSegmentEnd, mRampStartTime + mRampFrames - 1);
+        }
+
+        UInt32 theSegmentFrames = static_cast<UInt32>(theSegmentEnd - theFrame);
+        Float32* theSegment = ioBuffer + (theFrame - theBufferStart) * kChannels;
+
+        if(isRamping)
+        {
+            // RampMultiplyRT's gain for frame i is start + i * (end - start) / frames, so passing
+            // the ramp's gains at the first frame and just after the last gives exactly the ramp.
+            Float32 theSlope = (mValue - mRampStartValue) / static_cast<Float32>(mRampFrames);
+            Float32 theStartGain =
+                    mRampStartValue + theSlope * static_cast<Float32>(theFrame - mRampStartTime + 1);
+            Float32 theEndGain =
+                    mRampStartValue + theSlope * static_cast<Float32>(theSegmentEnd - mRampStartTime + 1);
+
+            BGM_GainRamp::RampMultiplyRT(theSegment, theSegmentFrames, kChannels, theStartGain, theEndGain);
+        }
+        else if(mValue != 1.0f)
+        {
+            BGM_GainRamp::RampMultiplyRT(theSegment, theSegmentFrames, kChannels, mValue, mValue);
+        }
+
+        theFrame = theSegmentEnd;
+    }
+}
+
+Float32 BGM_ParameterAutomation::GetValueAt(SInt64 inSampleTime) const
+{
+    if(mRampFrames <= 1 || inSampleTime >= mRampStartTime + mRampFrames - 1)
+    {
+        return mValue;
+    }
+
+    if(inSampleTime < mRampStartTime)
+    {
+        return mRampStartValue;
+    }
+
+    Float32 theProgress = static_cast<Float32>(inSampleTime - mRampStartTime + 1) /
+                          static_cast<Float32>(mRampFrames);
+
+    return mRampStartValue + (mValue - mRampStartValue) * theProgress;
+}
+
+void    BGM_ParameterAutomation::StartEventRT(const Event& inEvent, SInt64 inSampleTime)
+{
+    // Ramp from wherever the previous ramp had got to when this event started.
+    mRampStartValue = GetValueAt(inSampleTime);
+    mRampStartTime = inSampleTime;
+    mRampFrames = inEvent.mRampFrames;
+    mValue = inEvent.mValue;
+}
+
+#pragma clang assume_nonnull end
+
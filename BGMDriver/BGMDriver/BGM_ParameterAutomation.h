@@ -0,0 +1,137 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_ParameterAutomation.h
+//  BGMDriver
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  A gain parameter that changes at scheduled times, e.g. "at time T, ramp to -12 dB over 500 ms",
+//  with sample-accurate timing.
+//
+//  Events are scheduled from a non-real-time thread and passed to the IO thread through a
+//  lock-free single-producer, single-consumer queue. ApplyGainRT works out the sample time each
+//  event starts at from the IO cycle's timestamp and splits the buffer at event boundaries, so a
+//  change starts on exactly the frame it was scheduled for, whatever the buffer size.
+//
+//  Only depends on the C++ standard library (and vDSP through BGM_GainRamp on macOS), so it can be
+//  tested outside of coreaudiod by simulating the IO cycles.
+//
+
+#ifndef BGMDriver__BGM_ParameterAutomation
+#define BGMDriver__BGM_ParameterAutomation
+
+// System Includes
+#include <MacTypes.h>
+
+// STL Includes
+#include <array>
+#include <atomic>
+
+
+#pragma clang assume_nonnull begin
+
+class BGM_ParameterAutomation
+{
+
+public:
+    struct Event
+    {
+        // When the change starts, in the same clock as the times given to ApplyGainRT, e.g. host
+        // time.
+        Float64 mTime = 0.0;
+        // The gain to change to.
+        Float32 mValue = 1.0f;
+        // The number of frames to ramp over. The gain changes linearly and reaches mValue on the
+        // last of them. If it's 0 or 1, the gain changes to mValue on the frame at mTime.
+        UInt32  mRampFrames = 0;
+    };
+
+    // The most events that can be waiting for their start times at once.
+    static constexpr UInt32     kMaxPendingEvents = 256;
+
+    /*! @param inInitialValue The gain before the first event. */
+                                BGM_ParameterAutomation(Float32 inInitialValue);
+                                ~BGM_ParameterAutomation() = default;
+                                BGM_ParameterAutomation(const BGM_ParameterAutomation&) = delete;
+                                BGM_ParameterAutomation& operator=(const BGM_ParameterAutomation&) = delete;
+
+    /*!
+     Add an event to the queue. Events must be scheduled in order of their start times. Not
+     real-time safe. Must only be called from one thread at a time.
+
+     @return False if the queue is full, in which case the event isn't scheduled.
+     */
+    bool                        ScheduleEvent(const Event& inEvent);
+
+    /*!
+     @return The number of events in the queue. If it's called from the thread that schedules the
+             events, the number can only be lower than this when it next schedules one, since only
+             the IO thread removes them.
+     */
+    UInt32                      GetPendingEventCount() const;
+
+    /*!
+     Multiply the samples in ioBuffer by the gain, starting the events that are due during the
+     buffer on the frames they're scheduled for.
+
+     Events that should have started before the buffer, e.g. because they were scheduled late or
+     while IO was stopped, start at the beginning of the buffer, but their ramps continue from
+     where they would have been if they'd started on time.
+
+     @param ioBuffer The audio to apply the gain to. Interleaved stereo.
+     @param inFrameCount The number of frames in ioBuffer.
+     @param inSampleTime The sample time of the first frame.
+     @param inTime The time of the first frame in the clock the events' times are in.
+     @param inTimeUnitsPerFrame The length of a frame in that clock, e.g. host ticks per frame.
+     */
+    void                        ApplyGainRT(Float32* ioBuffer,
+                                            UInt32 inFrameCount,
+                                            Float64 inSampleTime,
+                                            Float64 inTime,
+                                            Float64 inTimeUnitsPerFrame);
+
+private:
+    // The gain at the given sample time, according to the current ramp, if there is one.
+    Float32                     GetValueAt(SInt64 inSampleTime) const;
+
+    // Start a ramp from the current gain (as of inSampleTime) to inEvent's gain.
+    void                        StartEventRT(const Event& inEvent, SInt64 inSampleTime);
+
+    static constexpr UInt32     kChannels = 2;
+
+    // The queue. Only the producer writes mWriteIndex and the events after it, and only the
+    // consumer writes mReadIndex.
+    std::array<Event, kMaxPendingEvents + 1>    mEvents;
+    std::atomic<UInt32>         mReadIndex { 0 };
+    std::atomic<UInt32>         mWriteIndex { 0 };
+
+    // The state of the gain. Only accessed by ApplyGainRT.
+    //
+    // If mRampFrames > 1, the gain is ramping linearly from mRampStartValue at mRampStartTime to
+    // mValue at mRampStartTime + mRampFrames - 1. Otherwise it's constant at mValue.
+    Float32                     mValue;
+    Float32                     mRampStartValue = 0.0f;
+    SInt64                      mRampStartTime = 0;
+    UInt32                      mRampFrames = 0;
+
+};
+
+#pragma clang assume_nonnull end
+
+#endif /* BGMDriver__BGM_ParameterAutomation */
+
@@ -0,0 +1,223 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//  BGM_SampleTimeRingBuffer.cpp
+//  BGMDriver
+//
+//  Copyright © 2026 Background Music contributors
+//
+
+// Self Include
+#include "BGM_SampleTimeRingBuffer.h"
+
+// PublicUtility Includes
+#include "CABitOperations.h"
+
+// STL Includes
+#include <algorithm>  // For std::min and std::max.
+#include <cstring>
+
+
+#pragma clang assume_nonnull begin
+
+BGM_SampleTimeRingBuffer::BGM_SampleTimeRingBuffer(UInt32 inCapacityFrames)
+:
+    mCapacityFrames(NextPowerOfTwo(inCapacityFrames)),
+    mCapacityFramesMask(mCapacityFrames - 1),
+    mSamples(mCapacityFrames * kChannels, 0.0f)
+{
+}
+
+void    BGM_SampleTimeRingBuffer::StoreRT(const Float32* inBuffer,
+                                          UInt32 inFrameCount,
+                                          Float64 inSampleTime)
+{
+    if(inFrameCount == 0)
+    {
+        return;
+    }
+
+    SInt64 theStartTime = static_cast<SInt64>(inSampleTime);
+
+    // If we've been given more audio than we can hold, skip the frames that would just be
+    // overwritten.
+    if(inFrameCount > mCapacityFrames)
+    {
+        UInt32 theSkippedFrames = inFrameCount - mCapacityFrames;
+        inBuffer += theSkippedFrames * kChannels;
+        theStartTime += theSkippedFrames;
+        inFrameCount = mCapacityFrames;
+    }
+
+    if(theStartTime < mEndTime || theStartTime - mEndTime >= mCapacityFrames)
+    {
+        // Either time has gone backwards or there's a gap at least as long as the buffer, so none
+        // of the audio we're holding can be used anymore.
+        mStartTime = theStartTime;
+        mEndTime = theStartTime;
+    }
+
+    // Fill any frames we skipped over with silence. Then copy the new frames in.
+    if(theStartTime > mEndTime)
+    {
+        WriteFramesRT(mEndTime, nullptr, static_cast<UInt32>(theStartTime - mEndTime));
+    }
+
+    WriteFramesRT(theStartTime, inBuffer, inFrameCount);
+
+    mEndTime = theStartTime + inFrameCount;
+    mStartTime = std::max(mStartTime, mEndTime - static_cast<SInt64>(mCapacityFrames));
+}
+
+void    BGM_SampleTimeRingBuffer::AccumulateRT(const Float32* inBuffer,
+                                               UInt32 inFrameCount,
+                                               Float64 inSampleTime)
+{
+    if(inFrameCount == 0)
+    {
+        return;
+    }
+
+    SInt64 theStartTime = static_cast<SInt64>(inSampleTime);
+
+    if(inFrameCount > mCapacityFrames)
+    {
+        UInt32 theSkippedFrames = inFrameCount - mCapacityFrames;
+        inBuffer += theSkippedFrames * kChannels;
+        theStartTime += theSkippedFrames;
+        inFrameCount = mCapacityFrames;
+    }
+
+    SInt64 theEndTime = theStartTime + inFrameCount;
+
+    if(theStartTime < mEndTime - static_cast<SInt64>(mCapacityFrames) ||
+       theStartTime - mEndTime >= mCapacityFrames)
+    {
+        // The audio is either older than anything we're holding, which means time has gone
+        // backwards, or so far ahead that none of the audio we're holding can be used anymore.
+        mStartTime = theStartTime;
+        mEndTime = theStartTime;
+    }
+
+    // The first audio given for these sample times. Start them from silence. (This also fills any
+    // frames we skipped over with silence.)
+    if(theEndTime > mEndTime)
+    {
+        SInt64 theSilenceStart = std::max(mEndTime, theEndTime - static_cast<SInt64>(mCapacityFrames));
+        WriteFramesRT(theSilenceStart, nullptr, static_cast<UInt32>(theEndTime - theSilenceStart));
+
+        mEndTime = theEndTime;
+        mStartTime = std::max(mStartTime, mEndTime - static_cast<SInt64>(mCapacityFrames));
+    }
+
+    // Mix the new frames in, skipping any that are too old to be held.
+    for(SInt64 theTime = std::max(theStartTime, mStartTime); theTime < theEndTime; theTime++)
+    {
+        const Float32* theFrame = &inBuffer[(theTime - theStartTime) * kChannels];
+        Float32* theDestFrame =
+                &mSamples[(static_cast<UInt32>(theTime) & mCapacityFramesMask) * kChannels];
+
+        theDestFrame[0] += theFrame[0];
+        theDestFrame[1] += theFrame[1];
+    }
+}
+
+void    BGM_SampleTimeRingBuffer::FetchRT(Float32* outBuffer,
+                                          UInt32 inFrameCount,
+                                          Float64 inSampleTime) const
+{
+    SInt64 theRequestedStart = static_cast<SInt64>(inSampleTime);
+
+    for(UInt32 theFrameIndex = 0; theFrameIndex < inFrameCount; theFrameIndex++)
+    {
+        SInt64 theTime = theRequestedStart + theFrameIndex;
+        Float32* theDestFrame = &outBuffer[theFrameIndex * kChannels];
+
+        if(theTime >= mStartTime && theTime < mEndTime)
+        {
+            const Float32* theFrame =
+                    &mSamples[(static_cast<UInt32>(theTime) & mCapacityFramesMask) * kChannels];
+            theDestFrame[0] = theFrame[0];
+            theDestFrame[1] = theFrame[1];
+        }
+        else
+        {
+            theDestFrame[0] = 0.0f;
+            theDestFrame[1] = 0.0f;
+        }
+    }
+}
+
+void    BGM_SampleTimeRingBuffer::SubtractFromRT(Float32* ioBuffer,
+                                                 UInt32 inFrameCount,
+                                                 Float64 inSampleTime) const
+{
+    SInt64 theRequestedStart = static_cast<SInt64>(inSampleTime);
+
+    // Only the part of the requested range that we're holding audio for.
+    SInt64 theStart = std::max(theRequestedStart, mStartTime);
+    SInt64 theEnd = std::min(theRequestedStart + static_cast<SInt64>(inFrameCount), mEndTime);
+
+    for(SInt64 theTime = theStart; theTime < theEnd; theTime++)
+    {
+        const Float32* theFrame =
+                &mSamples[(static_cast<UInt32>(theTime) & mCapacityFramesMask) * kChannels];
+        Float32* theDestFrame = &ioBuffer[(theTime - theRequestedStart) * kChannels];
+
+        theDestFrame[0] -= theFrame[0];
+        theDestFrame[1] -= theFrame[1];
+    }
+}
+
+void    BGM_SampleTimeRingBuffer::WriteFramesRT(SInt64 inSampleTime,
+                                                const Float32* _Nullable inFrames,
+                                                UInt32 inFrameCount)
+{
+    // Split the write where it wraps around the end of the buffer.
+    UInt32 theOffset = static_cast<UInt32>(inSampleTime) & mCapacityFramesMask;
+    UInt32 theFirstPart = std::min(inFrameCount, mCapacityFrames - theOffset);
+    UInt32 theParts[2][2] = { { theOffset, theFirstPart }, { 0, inFrameCount - theFirstPart } };
+
+    for(auto& thePart : theParts)
+    {
+        if(thePart[1] == 0)
+        {
+            continue;
+        }
+
+        Float32* theDest = &mSamples[thePart[0] * kChannels];
+        size_t theSize = thePart[1] * kChannels * sizeof(Float32);
+
+        if(inFrames)
+        {
+            memcpy(theDest, inFrames, theSize);
+            inFrames += thePart[1] * kChannels;
+        }
+        else
+        {
+            memset(theDest, 0, theSize);
+        }
+    }
+}
+
+void    BGM_SampleTimeRingBuffer::Reset()
+{
+    mStartTime = 0;
+    mEndTime = 0;
+}
+
+#pragma clang assume_nonnull end
+
@@ -0,0 +1,136 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//  BGM_SampleTimeRingBuffer.h
+//  BGMDriver
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  A ring buffer of interleaved stereo Float32 audio indexed by device sample time rather than by
+//  read/write positions. Audio stored for the output time of an IO cycle can be looked up again
+//  using the input time of a later cycle (e.g. in ReadInput), the same way BGMDevice's loopback
+//  ring buffer works, so the two stay time-aligned.
+//
+//  Frames that were never stored, or that have since been overwritten, read as silence.
+//
+//  Not thread-safe. The methods that end with "RT" are real-time safe.
+//
+
+#ifndef BGMDriver__BGM_SampleTimeRingBuffer
+#define BGMDriver__BGM_SampleTimeRingBuffer
+
+// System Includes
+#include <MacTypes.h>
+
+// STL Includes
+#include <vector>
+
+
+#pragma clang assume_nonnull begin
+
+class BGM_SampleTimeRingBuffer
+{
+
+public:
+    /*!
+     @param inCapacityFrames The number of frames the buffer can hold. Will be rounded up to a power
+                             of two.
+     */
+                                BGM_SampleTimeRingBuffer(UInt32 inCapacityFrames);
+                                ~BGM_SampleTimeRingBuffer() = default;
+                                // Disallow copying
+                                BGM_SampleTimeRingBuffer(const BGM_SampleTimeRingBuffer&) = delete;
+                                BGM_SampleTimeRingBuffer& operator=(const BGM_SampleTimeRingBuffer&) = delete;
+
+    /*! @return The number of frames the buffer can hold. */
+    UInt32                      GetCapacityFrames() const { return mCapacityFrames; }
+
+    /*!
+     Copy inFrameCount frames of audio into the buffer, starting at inSampleTime. Any frames
+     skipped since the last call are filled with silence. Storing at an earlier sample time than
+     the last call empties the buffer first.
+
+     @param inBuffer The audio to store. Interleaved stereo.
+     @param inFrameCount The number of frames in inBuffer. If it's larger than the capacity of the
+                         buffer, only the last frames will be kept.
+     @param inSampleTime The sample time of the first frame in inBuffer.
+     */
+    void                        StoreRT(const Float32* inBuffer,
+                                        UInt32 inFrameCount,
+                                        Float64 inSampleTime);
+
+    /*!
+     Mix inFrameCount frames of audio into the buffer, starting at inSampleTime. Sample times that
+     haven't had audio stored or mixed in yet start from silence, so several sources can each mix
+     their audio for the same IO cycle into the buffer.
+
+     @param inBuffer The audio to mix in. Interleaved stereo.
+     @param inFrameCount The number of frames in inBuffer.
+     @param inSampleTime The sample time of the first frame in inBuffer.
+     */
+    void                        AccumulateRT(const Float32* inBuffer,
+                                             UInt32 inFrameCount,
+                                             Float64 inSampleTime);
+
+    /*!
+     Copy the audio stored for the sample times [inSampleTime, inSampleTime + inFrameCount) into
+     outBuffer. Frames that aren't in the buffer are written as silence.
+
+     @param outBuffer The buffer to copy into. Interleaved stereo.
+     @param inFrameCount The number of frames to copy.
+     @param inSampleTime The sample time of the first frame to copy.
+     */
+    void                        FetchRT(Float32* outBuffer,
+                                        UInt32 inFrameCount,
+                                        Float64 inSampleTime) const;
+
+    /*!
+     Subtract the audio stored for the sample times [inSampleTime, inSampleTime + inFrameCount)
+     from ioBuffer. Frames that aren't in the buffer are left unchanged.
+
+     @param ioBuffer The audio to subtract from. Interleaved stereo.
+     @param inFrameCount The number of frames in ioBuffer.
+     @param inSampleTime The sample time of the first frame in ioBuffer.
+     */
+    void                        SubtractFromRT(Float32* ioBuffer,
+                                               UInt32 inFrameCount,
+                                               Float64 inSampleTime) const;
+
+    /*! Empty the buffer. */
+    void                        Reset();
+
+private:
+    // Copy inFrameCount frames into the buffer at inSampleTime, or write silence if inFrames is null.
+    void                        WriteFramesRT(SInt64 inSampleTime,
+                                              const Float32* _Nullable inFrames,
+                                              UInt32 inFrameCount);
+
+    static constexpr UInt32     kChannels = 2;
+
+    UInt32                      mCapacityFrames;
+    UInt32                      mCapacityFramesMask;
+    std::vector<Float32>        mSamples;
+
+    // The range of sample times currently held by the buffer: [mStartTime, mEndTime).
+    SInt64                      mStartTime = 0;
+    SInt64                      mEndTime   = 0;
+
+};
+
+#pragma clang assume_nonnull end
+
+#endif /* BGMDriver__BGM_SampleTimeRingBuffer */
+
@@ -0,0 +1,115 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_SceneMorph.cpp
+//  BGMDriver
+//
+//  Copyright © 2026 Background Music contributors
+//
+
+// Self Include
+#include "BGM_SceneMorph.h"
+
+// STL Includes
+#include <algorithm>
+
+
+#pragma clang assume_nonnull begin
+
+BGM_SceneMorph::BGM_SceneMorph(const Parameters& inFrom,
+                               const Parameters& inTo,
+                               UInt32 inDurationFrames,
+                               Float64 inSampleRate)
+:
+    mFrom(inFrom),
+    mTo(inTo),
+    mDurationFrames(std::max(inDurationFrames, 1U)),
+    mSampleRate(inSampleRate),
+    mMorphsEQ(EQGainsDiffer(inFrom, inTo))
+{
+}
+
+bool    BGM_SceneMorph::EQGainsDiffer(const Parameters& inA, const Parameters& inB)
+{
+    for(UInt32 i = 0; i < kEQBands; i++)
+    {
+        if(inA.mEQGains[i] != inB.mEQGains[i])
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+BGM_SceneMorph::Parameters  BGM_SceneMorph::GetCurrentParameters() const
+{
+    return Interpolate(mElapsedFrames.load(std::memory_order_relaxed));
+}
+
+bool    BGM_SceneMorph::IsFinished() const
+{
+    return mElapsedFrames.load(std::memory_order_relaxed) >= mDurationFrames;
+}
+
+bool    BGM_SceneMorph::AdvanceRT(UInt32 inFrameCount, Parameters& outStart, Parameters& outEnd)
+{
+    UInt32 theElapsedFrames = mElapsedFrames.load(std::memory_order_relaxed);
+
+    if(theElapsedFrames >= mDurationFrames)
+    {
+        return false;
+    }
+
+    UInt32 theEndFrames = theElapsedFrames + std::min(inFrameCount, mDurationFrames - theElapsedFrames);
+
+    outStart = Interpolate(theElapsedFrames);
+    outEnd = Interpolate(theEndFrames);
+
+    mElapsedFrames.store(theEndFrames, std::memory_order_relaxed);
+
+    return true;
+}
+
+BGM_SceneMorph::Parameters  BGM_SceneMorph::Interpolate(UInt32 inElapsedFrames) const
+{
+    if(inElapsedFrames >= mDurationFrames)
+    {
+        return mTo;
+    }
+
+    const Float32 theFraction =
+            static_cast<Float32>(inElapsedFrames) / static_cast<Float32>(mDurationFrames);
+
+    auto theLerp = [theFraction] (Float32 inFrom, Float32 inTo) {
+        return inFrom + (inTo - inFrom) * theFraction;
+    };
+
+    Parameters theParameters;
+    theParameters.mRawVolume = theLerp(mFrom.mRawVolume, mTo.mRawVolume);
+    theParameters.mPanPosition = theLerp(mFrom.mPanPosition, mTo.mPanPosition);
+
+    for(UInt32 i = 0; i < kEQBands; i++)
+    {
+        theParameters.mEQGains[i] = theLerp(mFrom.mEQGains[i], mTo.mEQGains[i]);
+    }
+
+    return theParameters;
+}
+
+#pragma clang assume_nonnull end
+
@@ -0,0 +1,122 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_SceneMorph.h
+//  BGMDriver
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  Moves a client's volume, pan position and EQ gains from where they were when a scene was set
+//  (see kAudioDeviceCustomPropertyScene) to the scene's values over a fixed number of frames.
+//
+//  Each parameter is interpolated linearly in the units the apps set it in, i.e. the raw volume
+//  (like moving a fader), the raw pan position and the EQ gains in dB. The IO thread advances the
+//  morph once per buffer and gets the values at the start and end of the buffer, so it can ramp
+//  across it.
+//
+//  A morph is created with its start and end values and never changed after that, so it can be
+//  read from any thread. Only the IO thread advances it.
+//
+
+#ifndef BGMDriver__BGM_SceneMorph
+#define BGMDriver__BGM_SceneMorph
+
+// Local Includes
+#include "BGM_Types.h"
+
+// System Includes
+#include <MacTypes.h>
+
+// STL Includes
+#include <atomic>
+
+
+#pragma clang assume_nonnull begin
+
+class BGM_SceneMorph
+{
+
+public:
+    static constexpr UInt32 kEQBands = 3;
+
+    struct Parameters
+    {
+        // In [kAppRelativeVolumeMinRawValue, kAppRelativeVolumeMaxRawValue].
+        Float32         mRawVolume = (kAppRelativeVolumeMinRawValue + kAppRelativeVolumeMaxRawValue) / 2.0f;
+        // In [kAppPanLeftRawValue, kAppPanRightRawValue].
+        Float32         mPanPosition = 0.0f;
+        // The low, mid and high EQ gains in dB.
+        Float32         mEQGains[kEQBands] = { 0.0f, 0.0f, 0.0f };
+    };
+
+    /*!
+     @param inFrom The parameters to start at.
+     @param inTo The parameters to end at.
+     @param inDurationFrames How long to morph for. Must be at least one frame.
+     @param inSampleRate The sample rate of the client's audio, which its EQ coefficients are
+                         calculated for.
+     */
+                        BGM_SceneMorph(const Parameters& inFrom,
+                                       const Parameters& inTo,
+                                       UInt32 inDurationFrames,
+                                       Float64 inSampleRate);
+
+    /*! @return The parameters at the end of the last buffer the IO thread advanced the morph by. */
+    Parameters          GetCurrentParameters() const;
+
+    const Parameters&   GetTargetParameters() const { return mTo; }
+
+    Float64             GetSampleRate() const { return mSampleRate; }
+
+    /*! @return True if the EQ gains change during the morph. */
+    bool                MorphsEQ() const { return mMorphsEQ; }
+
+    bool                IsFinished() const;
+
+    /*!
+     Advance the morph by one IO buffer.
+
+     @param inFrameCount The number of frames in the buffer.
+     @param outStart The parameters for the first frame of the buffer.
+     @param outEnd The parameters for the frame after the last frame of the buffer, i.e. the first
+                   frame of the next. Once the morph has finished, these are the target parameters.
+     @return False if the morph had already finished before this buffer, in which case outStart
+             and outEnd aren't set and the client's own settings should be used.
+     */
+    bool                AdvanceRT(UInt32 inFrameCount, Parameters& outStart, Parameters& outEnd);
+
+private:
+    static bool         EQGainsDiffer(const Parameters& inA, const Parameters& inB);
+
+    Parameters          Interpolate(UInt32 inElapsedFrames) const;
+
+    const Parameters    mFrom;
+    const Parameters    mTo;
+    const UInt32        mDurationFrames;
+    const Float64       mSampleRate;
+    const bool          mMorphsEQ;
+
+    // Only written by AdvanceRT, but read by GetCurrentParameters when a new scene is set part way
+    // through this one.
+    std::atomic<UInt32> mElapsedFrames { 0 };
+
+};
+
+#pragma clang assume_nonnull end
+
+#endif /* BGMDriver__BGM_SceneMorph */
+
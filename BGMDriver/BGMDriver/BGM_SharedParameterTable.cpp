@@ -0,0 +1,177 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//
+//  BGM_SharedParameterTable.cpp
+//  BGMDriver
+//
+//  Copyright © 2026 Background Music contributors
+//
+
+// Self Include
+#include "BGM_SharedParameterTable.h"
+
+// PublicUtility Includes
+#include "CADebugMacros.h"
+
+// System Includes
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+#pragma clang assume_nonnull begin
+
+BGM_SharedParameterTable::BGM_SharedParameterTable(const char* _Nullable inName)
+:
+    mName((inName != nullptr) ? inName : ""),
+    mOpenMutex("BGM_SharedParameterTable::mOpenMutex"),
+    mTable(nullptr),
+    mIsShared(false),
+    mPrivateTable(new BGMParameterTable)
+{
+    BGMParameterTableInitialize(mPrivateTable.get());
+    mTable = mPrivateTable.get();
+
+    for(auto& theSlotCounts : mClearedWriteCounts)
+    {
+        for(std::atomic<UInt32>& theCount : theSlotCounts)
+        {
+            theCount = 0;
+        }
+    }
+
+    OpenSharedIfNeeded();
+}
+
+BGM_SharedParameterTable::~BGM_SharedParameterTable()
+{
+    if(mIsShared)
+    {
+        BGMParameterTableClose(mTable);
+    }
+}
+
+void    BGM_SharedParameterTable::OpenSharedIfNeeded()
+{
+    CAMutex::Locker theLocker(mOpenMutex);
+
+    if(mIsShared || mName.empty())
+    {
+        return;
+    }
+
+    BGMParameterTable* theSharedTable = BGMParameterTableOpenReadOnly(mName.c_str(), GetWriterUserID());
+
+    if(theSharedTable != nullptr)
+    {
+        // Nothing can have been set in the private table, since only the driver can see it, so
+        // there's nothing to copy. The IO thread's slot caches are invalidated by the new pointer.
+        // The write counts in a new table start where BGMApp left them, so forget the private
+        // table's cleared counts.
+        for(auto& theSlotCounts : mClearedWriteCounts)
+        {
+            for(std::atomic<UInt32>& theCount : theSlotCounts)
+            {
+                theCount = 0;
+            }
+        }
+
+        mTable.store(theSharedTable, std::memory_order_release);
+        mIsShared = true;
+        // The private table is kept, since the IO thread could still be reading it.
+    }
+}
+
+bool    BGM_SharedParameterTable::GetValueRT(pid_t inProcessID,
+                                             BGM_ParameterSlotCache& ioCache,
+                                             BGMParameter inParameter,
+                                             Float32& outValue) const
+{
+    const BGMParameterTable* theTable = mTable.load(std::memory_order_acquire);
+    UInt32 theAllocationCount = __atomic_load_n(&theTable->mAllocationCount, __ATOMIC_ACQUIRE);
+
+    if(theTable != ioCache.mTable || theAllocationCount != ioCache.mAllocationCount)
+    {
+        const BGMParameterTableSlot* theSlot =
+                BGMParameterTableFindSlot(const_cast<BGMParameterTable*>(theTable), inProcessID);
+
+        ioCache.mTable = theTable;
+        ioCache.mSlot = (theSlot != nullptr) ? static_cast<SInt32>(theSlot - theTable->mSlots) : -1;
+        ioCache.mAllocationCount = theAllocationCount;
+    }
+
+    if(ioCache.mSlot < 0)
+    {
+        return false;
+    }
+
+    const BGMParameterTableSlot& theSlot = theTable->mSlots[ioCache.mSlot];
+
+    // Ignore the value if it hasn't been set since ClearValue unset it.
+    UInt32 theWriteCount = __atomic_load_n(&theSlot.mWriteCounts[inParameter], __ATOMIC_ACQUIRE);
+
+    if(theWriteCount == mClearedWriteCounts[ioCache.mSlot][inParameter].load(std::memory_order_relaxed))
+    {
+        return false;
+    }
+
+    return BGMParameterTableGetValue(&theSlot, inProcessID, inParameter, &outValue);
+}
+
+void    BGM_SharedParameterTable::ClearValue(pid_t inProcessID, BGMParameter inParameter)
+{
+    BGMParameterTable* theTable = mTable.load(std::memory_order_acquire);
+    BGMParameterTableSlot* theSlot = BGMParameterTableFindSlot(theTable, inProcessID);
+
+    if(theSlot != nullptr)
+    {
+        mClearedWriteCounts[theSlot - theTable->mSlots][inParameter].store(
+                __atomic_load_n(&theSlot->mWriteCounts[inParameter], __ATOMIC_ACQUIRE),
+                std::memory_order_relaxed);
+    }
+}
+
+void    BGM_SharedParameterTable::ClearValues(pid_t inProcessID)
+{
+    for(UInt32 theParameter = 0; theParameter < kBGMParameterCount; theParameter++)
+    {
+        ClearValue(inProcessID, static_cast<BGMParameter>(theParameter));
+    }
+}
+
+// static
+uid_t   BGM_SharedParameterTable::GetWriterUserID()
+{
+#if defined(__APPLE__)
+    // BGMApp runs as the user logged in at the console, who owns /dev/console. If no one's logged
+    // in, root owns it, so only a table created by root would be read.
+    struct stat theConsoleInfo;
+
+    if(stat("/dev/console", &theConsoleInfo) == 0)
+    {
+        return theConsoleInfo.st_uid;
+    }
+
+    return 0;
+#else
+    // E.g. the portable build's simulated host, where the apps run as the same user as the driver.
+    return geteuid();
+#endif
+}
+
+#pragma clang assume_nonnull end
+
@@ -0,0 +1,139 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//
+//  BGM_SharedParameterTable.h
+//  BGMDriver
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  Reads the apps' parameters for a device from the BGMParameterTable (see BGM_ParameterTable.h)
+//  BGMApp creates in shared memory.
+//
+//  The driver only maps the table read-only, and only if it's owned by the console user and no one
+//  else can write to it. Until BGMApp has created the table, e.g. while it isn't running, a private
+//  table is used instead. It works the same way, but only the driver can see it, so apps fall back
+//  to setting kAudioDeviceCustomPropertyAppVolumes. Once the shared table is mapped, it's used until
+//  the driver is restarted.
+//
+//  Since the driver can't write to the table, it unsets values by remembering the value's write
+//  count when it's unset, and ignoring the value until the app sets it again.
+//
+
+#ifndef BGMDriver__BGM_SharedParameterTable
+#define BGMDriver__BGM_SharedParameterTable
+
+// Local Includes
+#include "BGM_ParameterTable.h"
+
+// PublicUtility Includes
+#include "CAMutex.h"
+
+// STL Includes
+#include <atomic>
+#include <memory>
+#include <string>
+
+
+#pragma clang assume_nonnull begin
+
+// Where a client's app's slot was the last time it was looked for. Only used by the thread
+// processing the client's audio, i.e. the IO thread or a DSP worker, and by one at a time.
+struct BGM_ParameterSlotCache
+{
+    // The table the slot was looked for in. The shared table replaces the private one when it's
+    // mapped, which invalidates the slot.
+    const BGMParameterTable* _Nullable mTable = nullptr;
+    SInt32      mSlot = -1;
+    // The table's mAllocationCount when the slot was looked for. The table's count starts at 1, so
+    // the first lookup always searches.
+    UInt32      mAllocationCount = 0;
+};
+
+class BGM_SharedParameterTable
+{
+
+public:
+    /*!
+     @param inName The name of the shared memory object BGMApp creates the table in, e.g.
+                   kBGMParameterTableName. If it's null, only the private table is used.
+     */
+                                BGM_SharedParameterTable(const char* _Nullable inName);
+                                ~BGM_SharedParameterTable();
+                                BGM_SharedParameterTable(const BGM_SharedParameterTable&) = delete;
+                                BGM_SharedParameterTable& operator=(const BGM_SharedParameterTable&) = delete;
+
+    /*!
+     Map the shared table if it's been created since the last call. Call this when an app might have
+     started, e.g. when a client is added. Not real-time safe.
+     */
+    void                        OpenSharedIfNeeded();
+
+    /*! @return True if the shared table has been mapped, i.e. apps can write to it. */
+    bool                        IsShared() const { return mIsShared; }
+
+    /*!
+     The table being read. Only the private table can be written to, e.g. by tests acting as an
+     app. The shared one is mapped read-only.
+     */
+    BGMParameterTable*          GetTable() const { return mTable.load(std::memory_order_acquire); }
+
+    /*!
+     Get one of an app's parameters, if it's been set in the table and hasn't been unset with
+     ClearValue since. Real-time safe.
+
+     @param ioCache The cache of where the app's slot is. Only searches the table again if slots have
+                    been claimed or released since the last search.
+     @return True if the parameter was found.
+     */
+    bool                        GetValueRT(pid_t inProcessID,
+                                           BGM_ParameterSlotCache& ioCache,
+                                           BGMParameter inParameter,
+                                           Float32& outValue) const;
+
+    /*!
+     Unset one of an app's parameters, so the value set with kAudioDeviceCustomPropertyAppVolumes is
+     used instead until the app sets the parameter in the table again.
+     */
+    void                        ClearValue(pid_t inProcessID, BGMParameter inParameter);
+
+    /*!
+     Unset all of an app's parameters, e.g. because it's exited, so they can't be used for a new
+     process that gets the same PID.
+     */
+    void                        ClearValues(pid_t inProcessID);
+
+private:
+    // The user the shared table has to belong to, i.e. the one BGMApp runs as.
+    static uid_t                GetWriterUserID();
+
+    const std::string           mName;
+    CAMutex                     mOpenMutex;
+
+    std::atomic<BGMParameterTable*> mTable;
+    std::atomic<bool>           mIsShared;
+    std::unique_ptr<BGMParameterTable> mPrivateTable;
+
+    // The write count of each value in each slot when ClearValue last unset it.
+    std::atomic<UInt32>         mClearedWriteCounts[kBGMParameterTableSlotCount][kBGMParameterCount];
+
+};
+
+#pragma clang assume_nonnull end
+
+#endif /* BGMDriver__BGM_SharedParameterTable */
+
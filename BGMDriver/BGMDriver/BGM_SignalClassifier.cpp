@@ -0,0 +1,337 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_SignalClassifier.cpp
+//  BGMDriver
+//
+//  Copyright © 2026 Background Music contributors
+//
+
+// Self Include
+#include "BGM_SignalClassifier.h"
+
+// STL Includes
+#include <algorithm>
+#include <cmath>
+
+// System Includes
+#if defined(__APPLE__)
+#include <Accelerate/Accelerate.h>
+#endif
+
+
+#pragma clang assume_nonnull begin
+
+BGM_SignalClassifier::BGM_SignalClassifier(Float64 inSampleRate)
+:
+    mSampleRate(inSampleRate)
+{
+    const Float64 kPi = 3.14159265358979323846;
+
+    // A periodic Hann window, so consecutive windows overlap-add to a constant.
+    for(UInt32 i = 0; i < kFFTSize; i++)
+    {
+        mWindow[i] = static_cast<Float32>(0.5 - 0.5 * std::cos(2.0 * kPi * i / kFFTSize));
+    }
+
+    for(UInt32 i = 0; i < kFFTSize / 2; i++)
+    {
+        mCos[i] = static_cast<Float32>(std::cos(2.0 * kPi * i / kFFTSize));
+        mSin[i] = static_cast<Float32>(-std::sin(2.0 * kPi * i / kFFTSize));
+    }
+
+    UInt32 theBits = 0;
+    while((1U << theBits) < kFFTSize)
+    {
+        theBits++;
+    }
+
+    for(UInt32 i = 0; i < kFFTSize; i++)
+    {
+        UInt32 theReversed = 0;
+
+        for(UInt32 theBit = 0; theBit < theBits; theBit++)
+        {
+            theReversed |= ((i >> theBit) & 1) << (theBits - 1 - theBit);
+        }
+
+        mBitReversed[i] = static_cast<UInt16>(theReversed);
+    }
+}
+
+void    BGM_SignalClassifier::SetSampleRate(Float64 inSampleRate)
+{
+    mSampleRate.store(inSampleRate, std::memory_order_relaxed);
+}
+
+void    BGM_SignalClassifier::Reset()
+{
+    mClass = kClassSilent;
+    mFeatures = Features();
+    mGapSecs = 0.0;
+    mSecsSinceOnset = 0.0;
+    mPeakEnergyDB = kSilentEnergyDB;
+}
+
+BGM_SignalClassifier::Class BGM_SignalClassifier::ProcessRT(const Float32* inBuffer,
+                                                             UInt32 inFrameCount,
+                                                             bool inSkipSpectralFeatures)
+{
+    if(inFrameCount == 0)
+    {
+        return mClass;
+    }
+
+    const Float64 theBufferSecs = inFrameCount / mSampleRate.load(std::memory_order_relaxed);
+
+    // Extract the buffer's features.
+    Float32 theMeanSquare = MeanSquareRT(inBuffer, inFrameCount * kChannels);
+    Float32 theEnergyDB = (theMeanSquare > 0.0f) ? 10.0f * std::log10(theMeanSquare) : kSilentEnergyDB;
+    mFeatures.mEnergyDB = (theEnergyDB > kSilentEnergyDB) ? theEnergyDB : kSilentEnergyDB;
+
+    mFeatures.mZeroCrossingRate = (inFrameCount > 1) ?
+            static_cast<Float32>(ZeroCrossingsRT(inBuffer, kChannels, inFrameCount)) / (inFrameCount - 1) :
+            0.0f;
+
+    bool didCalculateFlux = false;
+
+    if(inSkipSpectralFeatures)
+    {
+        // The history will have a gap in it, so wait for it to be refilled before the next FFT.
+        mFramesSinceFFT = 0;
+    }
+    else
+    {
+        UpdateHistory(inBuffer, inFrameCount);
+    }
+
+    if(mFramesSinceFFT >= kFFTSize)
+    {
+        mFeatures.mSpectralFlux = CalculateSpectralFlux();
+        mFramesSinceFFT = 0;
+        didCalculateFlux = true;
+    }
+
+    const bool isActive = mFeatures.mEnergyDB >= kActiveEnergyDB;
+
+    // Start a new sound or end the current one after a long enough gap.
+    if(isActive)
+    {
+        mGapSecs = 0.0;
+
+        if(mClass == kClassSilent)
+        {
+            // The start of the sound is its first onset.
+            mClass = kClassTransient;
+            mFeatures.mDurationSecs = 0.0;
+            mFeatures.mOnsets = 1;
+            mSecsSinceOnset = 0.0;
+            mPeakEnergyDB = mFeatures.mEnergyDB;
+        }
+    }
+    else if(mClass != kClassSilent)
+    {
+        mGapSecs += theBufferSecs;
+
+        if(mGapSecs > kMaxGapSecs)
+        {
+            mClass = kClassSilent;
+            mFeatures.mDurationSecs = 0.0;
+            mFeatures.mOnsets = 0;
+        }
+    }
+
+    if(mClass == kClassSilent)
+    {
+        return mClass;
+    }
+
+    mFeatures.mDurationSecs += theBufferSecs;
+    mSecsSinceOnset += theBufferSecs;
+
+    if(isActive)
+    {
+        mPeakEnergyDB = std::max(mPeakEnergyDB, mFeatures.mEnergyDB);
+
+        if(didCalculateFlux &&
+           mFeatures.mSpectralFlux >= kOnsetFlux &&
+           mSecsSinceOnset >= kMinOnsetIntervalSecs)
+        {
+            mFeatures.mOnsets++;
+            mSecsSinceOnset = 0.0;
+        }
+    }
+
+    // Once a sound is sustained, it stays sustained until it ends.
+    if(mClass == kClassTransient &&
+       isActive &&
+       mFeatures.mDurationSecs >= kMinSustainedSecs &&
+       mFeatures.mZeroCrossingRate <= kMaxZeroCrossingRate &&
+       (mFeatures.mOnsets >= kMinOnsets || mFeatures.mEnergyDB >= mPeakEnergyDB - kMaxDecayDB))
+    {
+        mClass = kClassSustained;
+    }
+
+    return mClass;
+}
+
+void    BGM_SignalClassifier::UpdateHistory(const Float32* inBuffer, UInt32 inFrameCount)
+{
+    const UInt32 theNewFrames = (inFrameCount < kFFTSize) ? inFrameCount : kFFTSize;
+    const Float32* theNewFramesStart = inBuffer + (inFrameCount - theNewFrames) * kChannels;
+
+    // Shift the history back to make room for the new frames.
+    std::copy(mHistory + theNewFrames, mHistory + kFFTSize, mHistory);
+
+    for(UInt32 i = 0; i < theNewFrames; i++)
+    {
+        mHistory[kFFTSize - theNewFrames + i] =
+                0.5f * (theNewFramesStart[i * kChannels] + theNewFramesStart[i * kChannels + 1]);
+    }
+
+    mFramesSinceFFT += inFrameCount;
+}
+
+Float32 BGM_SignalClassifier::CalculateSpectralFlux()
+{
+    for(UInt32 i = 0; i < kFFTSize; i++)
+    {
+        mReal[i] = mHistory[i] * mWindow[i];
+        mImag[i] = 0.0f;
+    }
+
+    FFT();
+
+    Float32 theFlux = 0.0f;
+    Float32 theTotalMagnitude = 0.0f;
+
+    for(UInt32 theBin = 0; theBin < kBins; theBin++)
+    {
+        Float32 theMagnitude = std::sqrt(mReal[theBin] * mReal[theBin] + mImag[theBin] * mImag[theBin]);
+
+        theFlux += std::max(0.0f, theMagnitude - mMagnitudes[theBin]);
+        theTotalMagnitude += theMagnitude;
+
+        mMagnitudes[theBin] = theMagnitude;
+    }
+
+    return (theTotalMagnitude > 0.0f) ? (theFlux / theTotalMagnitude) : 0.0f;
+}
+
+void    BGM_SignalClassifier::FFT()
+{
+    for(UInt32 i = 0; i < kFFTSize; i++)
+    {
+        UInt32 j = mBitReversed[i];
+
+        if(i < j)
+        {
+            std::swap(mReal[i], mReal[j]);
+            std::swap(mImag[i], mImag[j]);
+        }
+    }
+
+    for(UInt32 theSize = 2; theSize <= kFFTSize; theSize *= 2)
+    {
+        const UInt32 theHalfSize = theSize / 2;
+        const UInt32 theTwiddleStep = kFFTSize / theSize;
+
+        for(UInt32 theStart = 0; theStart < kFFTSize; theStart += theSize)
+        {
+            for(UInt32 k = 0; k < theHalfSize; k++)
+            {
+                const Float32 theCos = mCos[k * theTwiddleStep];
+                const Float32 theSin = mSin[k * theTwiddleStep];
+
+                const UInt32 theEven = theStart + k;
+                const UInt32 theOdd = theEven + theHalfSize;
+
+                const Float32 theOddReal = mReal[theOdd] * theCos - mImag[theOdd] * theSin;
+                const Float32 theOddImag = mReal[theOdd] * theSin + mImag[theOdd] * theCos;
+
+                mReal[theOdd] = mReal[theEven] - theOddReal;
+                mImag[theOdd] = mImag[theEven] - theOddImag;
+                mReal[theEven] += theOddReal;
+                mImag[theEven] += theOddImag;
+            }
+        }
+    }
+}
+
+#pragma mark Kernels
+
+Float32 BGM_SignalClassifier::MeanSquareRT(const Float32* inBuffer, UInt32 inSampleCount)
+{
+#if defined(__APPLE__)
+    Float32 theMeanSquare = 0.0f;
+    vDSP_measqv(inBuffer, 1, &theMeanSquare, inSampleCount);
+    return theMeanSquare;
+#else
+    return MeanSquareReferenceRT(inBuffer, inSampleCount);
+#endif
+}
+
+Float32 BGM_SignalClassifier::MeanSquareReferenceRT(const Float32* inBuffer, UInt32 inSampleCount)
+{
+    if(inSampleCount == 0)
+    {
+        return 0.0f;
+    }
+
+    Float32 theSum = 0.0f;
+
+    for(UInt32 i = 0; i < inSampleCount; i++)
+    {
+        theSum += inBuffer[i] * inBuffer[i];
+    }
+
+    return theSum / inSampleCount;
+}
+
+UInt32  BGM_SignalClassifier::ZeroCrossingsRT(const Float32* inBuffer, UInt32 inStride, UInt32 inSampleCount)
+{
+#if defined(__APPLE__)
+    // vDSP_nzcros stops after the given number of crossings, so allow as many as there could be.
+    vDSP_Length theLastCrossingIndex = 0;
+    vDSP_Length theCrossings = 0;
+    vDSP_nzcros(inBuffer, inStride, inSampleCount, &theLastCrossingIndex, &theCrossings, inSampleCount);
+    return static_cast<UInt32>(theCrossings);
+#else
+    return ZeroCrossingsReferenceRT(inBuffer, inStride, inSampleCount);
+#endif
+}
+
+UInt32  BGM_SignalClassifier::ZeroCrossingsReferenceRT(const Float32* inBuffer,
+                                                       UInt32 inStride,
+                                                       UInt32 inSampleCount)
+{
+    UInt32 theCrossings = 0;
+
+    for(UInt32 i = 1; i < inSampleCount; i++)
+    {
+        // Like vDSP_nzcros, count a crossing when the sign bit changes.
+        if(std::signbit(inBuffer[i * inStride]) != std::signbit(inBuffer[(i - 1) * inStride]))
+        {
+            theCrossings++;
+        }
+    }
+
+    return theCrossings;
+}
+
+#pragma clang assume_nonnull end
+
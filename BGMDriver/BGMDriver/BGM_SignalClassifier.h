@@ -0,0 +1,186 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_SignalClassifier.h
+//  BGMDriver
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  Classifies a client's audio as silent, transient (e.g. notification sounds and UI clicks) or
+//  sustained (e.g. speech, music or video), so short sounds don't make BGMDevice audible and pause
+//  the music player.
+//
+//  Each IO buffer is reduced to a few cheap features: its short-term energy, its zero-crossing
+//  rate, the spectral flux from a small FFT, which is used to count onsets, and how long the current
+//  sound has lasted. A sound is sustained once it has lasted kMinSustainedSecs and either has had
+//  several onsets, like speech and music, or hasn't decayed, like a held note. It stays sustained
+//  until it ends.
+//
+//  The cost per IO cycle is bounded: the energy and zero-crossing rate are vectorized and the FFT
+//  runs at most once per cycle, on the latest kFFTSize frames.
+//
+//  Not thread-safe. ProcessRT must only be called from the IO thread, but the sample rate can be set
+//  from any thread.
+//
+
+#ifndef BGMDriver__BGM_SignalClassifier
+#define BGMDriver__BGM_SignalClassifier
+
+// System Includes
+#include <MacTypes.h>
+
+// STL Includes
+#include <atomic>
+
+
+#pragma clang assume_nonnull begin
+
+class BGM_SignalClassifier
+{
+
+public:
+    enum Class
+    {
+        kClassSilent,
+        kClassTransient,
+        kClassSustained
+    };
+
+    static constexpr UInt32     kFFTSize = 256;
+
+    // The energy reported for digital silence.
+    static constexpr Float32    kSilentEnergyDB = -120.0f;
+    // Buffers quieter than this are silent.
+    static constexpr Float32    kActiveEnergyDB = -60.0f;
+    // Gaps in a sound shorter than this, e.g. between words, don't end it.
+    static constexpr Float64    kMaxGapSecs = 0.3;
+    // How long a sound has to last before it can be sustained.
+    static constexpr Float64    kMinSustainedSecs = 0.5;
+    // A sound with this many onsets is sustained once it's lasted long enough.
+    static constexpr UInt32     kMinOnsets = 2;
+    // Otherwise, it's sustained if it's within this many dB of its peak energy.
+    static constexpr Float32    kMaxDecayDB = 6.0f;
+    // The spectral flux of an onset.
+    static constexpr Float32    kOnsetFlux = 0.25f;
+    // The minimum time between onsets.
+    static constexpr Float64    kMinOnsetIntervalSecs = 0.1;
+    // Sounds with higher zero-crossing rates, i.e. mostly high-frequency content like hiss or the
+    // clicks of a UI sound, never become sustained. (White noise crosses zero about half the time.)
+    static constexpr Float32    kMaxZeroCrossingRate = 0.6f;
+
+    struct Features
+    {
+        // The mean square of the last buffer in dBFS.
+        Float32         mEnergyDB = kSilentEnergyDB;
+        // The fraction of the last buffer's (left channel) samples that crossed zero.
+        Float32         mZeroCrossingRate = 0.0f;
+        // The positive change in the magnitude spectrum at the last FFT, relative to the spectrum's
+        // total magnitude, so it's roughly from 0.0 to 1.0.
+        Float32         mSpectralFlux = 0.0f;
+        // How long the current sound has lasted, including short gaps.
+        Float64         mDurationSecs = 0.0;
+        // The number of onsets in the current sound.
+        UInt32          mOnsets = 0;
+    };
+
+    explicit            BGM_SignalClassifier(Float64 inSampleRate);
+
+    /*! Set the sample rate of the audio ProcessRT will be given. Can be called from any thread. */
+    void                SetSampleRate(Float64 inSampleRate);
+
+    /*!
+     Update the classification with the client's audio for an IO cycle.
+
+     @param inBuffer The client's audio. Interleaved stereo.
+     @param inFrameCount The number of frames in inBuffer.
+     @param inSkipSpectralFeatures True to skip the FFT, e.g. when the IO cycle is short on time. No
+                                   onsets are counted in the buffer, so the classification only uses
+                                   the energy, zero-crossing rate and duration.
+     @return The class of the client's audio as of the end of inBuffer.
+     */
+    Class               ProcessRT(const Float32* inBuffer,
+                                  UInt32 inFrameCount,
+                                  bool inSkipSpectralFeatures = false);
+
+    Class               GetClass() const { return mClass; }
+
+    const Features&     GetFeatures() const { return mFeatures; }
+
+    /*! Forget the current sound, e.g. when the client stops IO. */
+    void                Reset();
+
+#pragma mark Kernels
+
+    /*!
+     @return The mean of the squares of the samples. Uses vDSP on macOS and the reference
+             implementation elsewhere.
+     */
+    static Float32      MeanSquareRT(const Float32* inBuffer, UInt32 inSampleCount);
+    static Float32      MeanSquareReferenceRT(const Float32* inBuffer, UInt32 inSampleCount);
+
+    /*!
+     @return The number of times consecutive samples with the given stride change sign. Uses vDSP
+             on macOS and the reference implementation elsewhere.
+     */
+    static UInt32       ZeroCrossingsRT(const Float32* inBuffer, UInt32 inStride, UInt32 inSampleCount);
+    static UInt32       ZeroCrossingsReferenceRT(const Float32* inBuffer, UInt32 inStride, UInt32 inSampleCount);
+
+private:
+    static constexpr UInt32     kChannels = 2;
+    static constexpr UInt32     kBins = kFFTSize / 2 + 1;
+
+    /*! Add the mono mix of the buffer's last kFFTSize frames (at most) to mHistory. */
+    void                UpdateHistory(const Float32* inBuffer, UInt32 inFrameCount);
+
+    /*! Calculate the magnitude spectrum of mHistory and return its spectral flux. */
+    Float32             CalculateSpectralFlux();
+
+    /*! In-place radix-2 FFT of mReal and mImag. */
+    void                FFT();
+
+    std::atomic<Float64>    mSampleRate;
+
+    Class                   mClass = kClassSilent;
+    Features                mFeatures;
+
+    // The current sound's state.
+    Float64                 mGapSecs = 0.0;
+    Float64                 mSecsSinceOnset = 0.0;
+    Float32                 mPeakEnergyDB = kSilentEnergyDB;
+
+    // The latest kFFTSize frames, mixed to mono, oldest first, and the number of frames added since
+    // the last FFT.
+    Float32                 mHistory[kFFTSize] = {};
+    UInt32                  mFramesSinceFFT = 0;
+
+    // Precomputed FFT tables.
+    Float32                 mWindow[kFFTSize];
+    Float32                 mCos[kFFTSize / 2];
+    Float32                 mSin[kFFTSize / 2];
+    UInt16                  mBitReversed[kFFTSize];
+
+    // FFT buffers and the previous magnitude spectrum.
+    Float32                 mReal[kFFTSize];
+    Float32                 mImag[kFFTSize];
+    Float32                 mMagnitudes[kBins] = {};
+
+};
+
+#pragma clang assume_nonnull end
+
+#endif /* BGMDriver__BGM_SignalClassifier */
+
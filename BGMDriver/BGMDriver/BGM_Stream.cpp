@@ -49,7 +49,8 @@ BGM_Stream::BGM_Stream(AudioObjectID inObjectID,
     mIsInput(inIsInput),
     mIsStreamActive(false),
     mSampleRate(inSampleRate),
-    mStartingChannel(inStartingChannel)
+    mStartingChannel(inStartingChannel),
+    mLatency(0)
 {
 }
 
@@ -292,7 +293,7 @@ void    BGM_Stream::GetPropertyData(AudioObjectID inObjectID,
                     CAException(kAudioHardwareBadPropertySizeError),
                     "BGM_Stream::GetPropertyData: not enough space for the return "
                     "value of kAudioStreamPropertyLatency for the stream");
-            *reinterpret_cast<UInt32*>(outData) = 0;
+            *reinterpret_cast<UInt32*>(outData) = mLatency.load(std::memory_order_relaxed);
             outDataSize = sizeof(UInt32);
             break;
 
@@ -484,5 +485,10 @@ void    BGM_Stream::SetSampleRate(Float64 inSampleRate)
     mSampleRate = inSampleRate;
 }
 
+void    BGM_Stream::SetLatency(UInt32 inLatencyFrames)
+{
+    mLatency.store(inLatencyFrames, std::memory_order_relaxed);
+}
+
 #pragma clang assume_nonnull end
 
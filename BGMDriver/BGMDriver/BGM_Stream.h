@@ -34,6 +34,9 @@
 // PublicUtility Includes
 #include "CAMutex.h"
 
+// STL Includes
+#include <atomic>
+
 // System Includes
 #include <CoreAudio/AudioHardwareBase.h>
 
@@ -88,6 +91,11 @@ public:
 #pragma mark Accessors
 
     void                        SetSampleRate(Float64 inSampleRate);
+    /*!
+     Set the stream's kAudioStreamPropertyLatency, in frames. Real-time safe. The caller should send
+     the property's notification.
+     */
+    void                        SetLatency(UInt32 inLatencyFrames);
 
 private:
     CAMutex                     mStateMutex;
@@ -103,6 +111,12 @@ private:
      kAudioStreamPropertyStartingChannel.
      */
     UInt32                      mStartingChannel;
+    /*!
+     The presentation latency the device adds to the stream, in frames. See
+     kAudioStreamPropertyLatency. Atomic rather than guarded by mStateMutex so it can be set on the
+     IO thread.
+     */
+    std::atomic<UInt32>         mLatency;
 
 };
 
@@ -28,8 +28,8 @@
 #include "BGM_Utils.h"
 #include "BGM_PlugIn.h"
 #include "BGM_Clients.h"
-#include "BGM_ClientMap.h"
 #include "BGM_ClientTasks.h"
+#include "BGM_RTSafety.h"
 
 // PublicUtility Includes
 #include "CAException.h"
@@ -148,17 +148,6 @@ UInt32  BGM_TaskQueue::NanosToAbsoluteTime(UInt32 inNanos)
 
 #pragma mark Task queueing
 
-void    BGM_TaskQueue::QueueSync_SwapClientShadowMaps(BGM_ClientMap* inClientMap)
-{
-    // TODO: Is there any reason to use uintptr_t when we pass pointers to tasks like this? I can't think of any
-    //       reason for a system to have (non-function) pointers larger than 64-bit, so I figure they should fit.
-    //
-    //       From http://en.cppreference.com/w/cpp/language/reinterpret_cast:
-    //       "A pointer converted to an integer of sufficient size and back to the same pointer type is guaranteed
-    //        to have its original value [...]"
-    QueueSync(kBGMTaskSwapClientShadowMaps, /* inRunOnRealtimeThread = */ true, reinterpret_cast<UInt64>(inClientMap));
-}
-
 void    BGM_TaskQueue::QueueAsync_SendPropertyNotification(AudioObjectPropertySelector inProperty, AudioObjectID inDeviceID)
 {
     DebugMsg("BGM_TaskQueue::QueueAsync_SendPropertyNotification: Queueing property notification. inProperty=%u inDeviceID=%u",
@@ -292,7 +281,7 @@ void    BGM_TaskQueue::AssertCurrentThreadIsRTWorkerThread(const char* inCallerM
 }
 
 //static
-void* __nullable    BGM_TaskQueue::RealTimeThreadProc(void* inRefCon)
+void* _Nullable    BGM_TaskQueue::RealTimeThreadProc(void* inRefCon)
 {
     DebugMsg("BGM_TaskQueue::RealTimeThreadProc: The realtime worker thread has started");
     
@@ -307,7 +296,7 @@ void* __nullable    BGM_TaskQueue::RealTimeThreadProc(void* inRefCon)
 }
 
 //static
-void* __nullable    BGM_TaskQueue::NonRealTimeThreadProc(void* inRefCon)
+void* _Nullable    BGM_TaskQueue::NonRealTimeThreadProc(void* inRefCon)
 {
     DebugMsg("BGM_TaskQueue::NonRealTimeThreadProc: The non-realtime worker thread has started");
     
@@ -321,7 +310,7 @@ void* __nullable    BGM_TaskQueue::NonRealTimeThreadProc(void* inRefCon)
     return NULL;
 }
 
-void    BGM_TaskQueue::WorkerThreadProc(semaphore_t inWorkQueuedSemaphore, semaphore_t inSyncTaskCompletedSemaphore, TAtomicStack<BGM_Task>* inTasks, TAtomicStack2<BGM_Task>* __nullable inFreeList, std::function<bool(BGM_Task*)> inProcessTask)
+void    BGM_TaskQueue::WorkerThreadProc(semaphore_t inWorkQueuedSemaphore, semaphore_t inSyncTaskCompletedSemaphore, TAtomicStack<BGM_Task>* inTasks, TAtomicStack2<BGM_Task>* _Nullable inFreeList, std::function<bool(BGM_Task*)> inProcessTask)
 {
     bool theThreadShouldStop = false;
     
@@ -393,6 +382,8 @@ bool    BGM_TaskQueue::ProcessRealTimeThreadTask(BGM_Task* inTask)
 {
     AssertCurrentThreadIsRTWorkerThread("BGM_TaskQueue::ProcessRealTimeThreadTask");
     
+    BGMRTScope("BGM_TaskQueue::ProcessRealTimeThreadTask");
+    
     switch(inTask->GetTaskID())
     {
         case kBGMTaskStopWorkerThread:
@@ -400,14 +391,6 @@ bool    BGM_TaskQueue::ProcessRealTimeThreadTask(BGM_Task* inTask)
             // Return that the thread should stop itself
             return true;
             
-        case kBGMTaskSwapClientShadowMaps:
-            {
-                DebugMsg("BGM_TaskQueue::ProcessRealTimeThreadTask: Swapping the shadow maps in BGM_ClientMap");
-                BGM_ClientMap* theClientMap = reinterpret_cast<BGM_ClientMap*>(inTask->GetArg1());
-                BGM_ClientTasks::SwapInShadowMapsRT(theClientMap);
-            }
-            break;
-            
         default:
             Assert(false, "BGM_TaskQueue::ProcessRealTimeThreadTask: Unexpected task ID");
             break;
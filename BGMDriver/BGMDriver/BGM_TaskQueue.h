@@ -40,7 +40,6 @@
 
 // Forward declarations
 class BGM_Clients;
-class BGM_ClientMap;
 
 
 #pragma clang assume_nonnull begin
@@ -62,9 +61,6 @@ private:
         kBGMTaskUninitialized,
         kBGMTaskStopWorkerThread,
         
-        // Realtime thread only
-        kBGMTaskSwapClientShadowMaps,
-        
         // Non-realtime thread only
         kBGMTaskStartClientIO,
         kBGMTaskStopClientIO,
@@ -91,8 +87,8 @@ private:
         void                            MarkCompleted() { mIsComplete = true; }
         
         // Used by TAtomicStack
-        BGM_Task* __nullable &          next() { return mNext; }
-        BGM_Task* __nullable            mNext;
+        BGM_Task* _Nullable &          next() { return mNext; }
+        BGM_Task* _Nullable            mNext;
         
     private:
         BGM_TaskID                      mTaskID;
@@ -114,8 +110,6 @@ private:
     static UInt32                       NanosToAbsoluteTime(UInt32 inNanos);
     
 public:
-    void                                QueueSync_SwapClientShadowMaps(BGM_ClientMap* inClientMap);
-    
     // Sends a property changed notification to the BGMDevice host. Assumes the scope and element are kAudioObjectPropertyScopeGlobal and
     // kAudioObjectPropertyElementMaster because currently those are the only ones we use.
     void                                QueueAsync_SendPropertyNotification(AudioObjectPropertySelector inProperty, AudioObjectID inDeviceID);
@@ -139,10 +133,10 @@ public:
     void                                AssertCurrentThreadIsRTWorkerThread(const char* inCallerMethodName);
     
 private:
-    static void* __nullable             RealTimeThreadProc(void* inRefCon);
-    static void* __nullable             NonRealTimeThreadProc(void* inRefCon);
+    static void* _Nullable             RealTimeThreadProc(void* inRefCon);
+    static void* _Nullable             NonRealTimeThreadProc(void* inRefCon);
     
-    void                                WorkerThreadProc(semaphore_t inWorkQueuedSemaphore, semaphore_t inSyncTaskCompletedSemaphore, TAtomicStack<BGM_Task>* inTasks, TAtomicStack2<BGM_Task>* __nullable inFreeList, std::function<bool(BGM_Task*)> inProcessTask);
+    void                                WorkerThreadProc(semaphore_t inWorkQueuedSemaphore, semaphore_t inSyncTaskCompletedSemaphore, TAtomicStack<BGM_Task>* inTasks, TAtomicStack2<BGM_Task>* _Nullable inFreeList, std::function<bool(BGM_Task*)> inProcessTask);
     
     // These return true when the thread should be stopped
     bool                                ProcessRealTimeThreadTask(BGM_Task* inTask);
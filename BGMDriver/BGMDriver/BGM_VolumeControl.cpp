@@ -38,7 +38,6 @@
 
 // System Includes
 #include <CoreAudio/AudioHardwareBase.h>
-#include <Accelerate/Accelerate.h>
 
 
 #pragma clang assume_nonnull begin
@@ -58,7 +57,7 @@ BGM_VolumeControl::BGM_VolumeControl(AudioObjectID inObjectID,
                 inElement),
     mMutex("Volume Control"),
     mVolumeRaw(kDefaultMinRawVolume),
-    mAmplitudeGain(0.0f),
+    mGainRamp(0.0f, kGainRampTimeConstantSecs, kDefaultSampleRate),
     mMinVolumeRaw(kDefaultMinRawVolume),
     mMaxVolumeRaw(kDefaultMaxRawVolume),
     mMinVolumeDb(kDefaultMinDbVolume),
@@ -362,6 +361,11 @@ void    BGM_VolumeControl::SetWillApplyVolumeToAudio(bool inWillApplyVolumeToAud
     mWillApplyVolumeToAudio = inWillApplyVolumeToAudio;
 }
 
+void    BGM_VolumeControl::SetSampleRate(Float64 inSampleRate)
+{
+    mGainRamp.SetTimeConstant(kGainRampTimeConstantSecs, inSampleRate);
+}
+
 #pragma mark IO Operations
 
 bool    BGM_VolumeControl::WillApplyVolumeToAudioRT() const
@@ -369,33 +373,17 @@ bool    BGM_VolumeControl::WillApplyVolumeToAudioRT() const
     return mWillApplyVolumeToAudio;
 }
 
-void    BGM_VolumeControl::ApplyVolumeToAudioRT(Float32* ioBuffer, UInt32 inBufferFrameSize) const
+void    BGM_VolumeControl::ApplyVolumeToAudioRT(Float32* ioBuffer, UInt32 inBufferFrameSize)
 {
     ThrowIf(!mWillApplyVolumeToAudio,
             CAException(kAudioHardwareIllegalOperationError),
             "BGM_VolumeControl::ApplyVolumeToAudioRT: This control doesn't process audio data");
 
-    // Don't bother if the change is very unlikely to be perceptible.
-    if((mAmplitudeGain < 0.99f) || (mAmplitudeGain > 1.01f))
-    {
-        // Apply the amount of gain/loss for the current volume to the audio signal by multiplying
-        // each sample. This call to vDSP_vsmul is equivalent to
-        //
-        // for(UInt32 i = 0; i < inBufferFrameSize * 2; i++)
-        // {
-        //     ioBuffer[i] *= mAmplitudeGain;
-        // }
-        //
-        // but a bit faster on processors with newer SIMD instructions. However, it shouldn't take
-        // more than a few microseconds either way. (Unless some of the samples were subnormal
-        // numbers for some reason.)
-        //
-        // It would be a tiny bit faster still to not do this in-place, i.e. use separate input and
-        // output buffers, but then we'd have to copy the data into the output buffer when the
-        // volume is at 1.0. With our current use of this class, most people will leave the volume
-        // at 1.0, so it wouldn't be worth it.
-        vDSP_vsmul(ioBuffer, 1, &mAmplitudeGain, ioBuffer, 1, inBufferFrameSize * 2);
-    }
+    // Apply the amount of gain/loss for the current volume to the audio signal by multiplying each
+    // sample. If the volume has changed, the gain ramps smoothly from the old volume to the new one.
+    // (This used to skip gains within 1% of 1.0, but that made the gain jump when it crossed into or
+    // out of that range, so now it's only skipped when it's exactly 1.0.)
+    mGainRamp.ApplyRT(ioBuffer, inBufferFrameSize);
 }
 
 #pragma mark Implementation
@@ -443,9 +431,13 @@ void    BGM_VolumeControl::SetVolumeRaw(SInt32 inNewVolumeRaw)
         SInt32 theSliderPositionInRawSteps = static_cast<SInt32>(theSliderPosition * theRawRange);
         theSliderPositionInRawSteps += mMinVolumeRaw;
 
-        mAmplitudeGain = mVolumeCurve.ConvertRawToScalar(theSliderPositionInRawSteps);
+        Float32 theAmplitudeGain = mVolumeCurve.ConvertRawToScalar(theSliderPositionInRawSteps);
+
+        BGMAssert((theAmplitudeGain >= 0.0f) && (theAmplitudeGain <= 1.0f), "Gain not in [0,1]");
 
-        BGMAssert((mAmplitudeGain >= 0.0f) && (mAmplitudeGain <= 1.0f), "Gain not in [0,1]");
+        // Publish the new gain to the IO thread. This doesn't need the mutex. ApplyVolumeToAudioRT
+        // will ramp to it.
+        mGainRamp.SetTargetGain(theAmplitudeGain);
 
         // Send notifications.
         CADispatchQueue::GetGlobalSerialQueue().Dispatch(false, ^{
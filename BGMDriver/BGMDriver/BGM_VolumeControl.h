@@ -26,6 +26,9 @@
 // Superclass Includes
 #include "BGM_Control.h"
 
+// Local Includes
+#include "BGM_GainRamp.h"
+
 // PublicUtility Includes
 #include "CAVolumeCurve.h"
 #include "CAMutex.h"
@@ -114,6 +117,12 @@ public:
      */
     void                SetWillApplyVolumeToAudio(bool inWillApplyVolumeToAudio);
 
+    /*!
+     Set the sample rate of the audio ApplyVolumeToAudioRT will be given. Used to make volume
+     changes take the same amount of time at any sample rate.
+     */
+    void                SetSampleRate(Float64 inSampleRate);
+
 #pragma mark IO Operations
 
     /*!
@@ -125,6 +134,9 @@ public:
      Apply this volume control's volume to the samples in ioBuffer. That is, increase/decrease the
      volumes of the samples by the current volume of this control.
 
+     When the volume changes, the gain applied moves to the new volume over a few milliseconds,
+     rather than jumping to it, so the change doesn't cause an audible click.
+
      @param ioBuffer The audio sample buffer to process.
      @param inBufferFrameSize The number of sample frames in ioBuffer. The audio is assumed to be in
                               stereo, i.e. two samples per frame. (Though, hopefully we'll support
@@ -132,7 +144,7 @@ public:
      @throws CAException If SetWillApplyVolumeToAudio hasn't been used to set this control to apply
                          its volume to audio data.
      */
-    void                ApplyVolumeToAudioRT(Float32* ioBuffer, UInt32 inBufferFrameSize) const;
+    void                ApplyVolumeToAudioRT(Float32* ioBuffer, UInt32 inBufferFrameSize);
 
 #pragma mark Implementation
 
@@ -144,6 +156,9 @@ private:
     const SInt32        kDefaultMaxRawVolume = 96;
     const Float32       kDefaultMinDbVolume  = -96.0f;
     const Float32       kDefaultMaxDbVolume  = 0.0f;
+    // The time constant of the ramp used to change the gain applied to the audio.
+    const Float64       kGainRampTimeConstantSecs = 0.01;
+    const Float64       kDefaultSampleRate = 44100.0;
 
     CAMutex             mMutex;
 
@@ -155,8 +170,9 @@ private:
 
     CAVolumeCurve       mVolumeCurve;
     // The gain (or loss) to apply to an audio signal to increase/decrease its volume by the current
-    // volume of this control.
-    Float32             mAmplitudeGain;
+    // volume of this control. Its target is set when the volume changes and read without locking
+    // during IO.
+    BGM_GainRamp        mGainRamp;
 
     bool                mWillApplyVolumeToAudio;
 
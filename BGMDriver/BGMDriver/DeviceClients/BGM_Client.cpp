@@ -23,6 +23,11 @@
 // Self Include
 #include "BGM_Client.h"
 
+// STL Includes
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
 
 BGM_Client::BGM_Client(const AudioServerPlugInClientInfo* inClientInfo)
 :
@@ -49,90 +54,124 @@ void    BGM_Client::Copy(const BGM_Client& inClient)
     mIsMusicPlayer = inClient.mIsMusicPlayer;
     mRelativeVolume = inClient.mRelativeVolume;
     mPanPosition = inClient.mPanPosition;
+    mDuckingRole = inClient.mDuckingRole;
+    mPriority = inClient.mPriority;
     
     // Copy EQ settings
     mEQLowGain = inClient.mEQLowGain;
     mEQMidGain = inClient.mEQMidGain;
     mEQHighGain = inClient.mEQHighGain;
+    std::copy(std::begin(inClient.mEQLowCoeffs), std::end(inClient.mEQLowCoeffs), mEQLowCoeffs);
+    std::copy(std::begin(inClient.mEQMidCoeffs), std::end(inClient.mEQMidCoeffs), mEQMidCoeffs);
+    std::copy(std::begin(inClient.mEQHighCoeffs), std::end(inClient.mEQHighCoeffs), mEQHighCoeffs);
     
     // Copy outgoing routes
     mOutgoingRoutes = inClient.mOutgoingRoutes;
+    mIncomingRoutingKernels = inClient.mIncomingRoutingKernels;
     
-    // Note: routing buffer is NOT copied - it stays with original client
-    // Each client instance needs its own buffer
-}
-
-void    BGM_Client::AllocateRoutingBuffer()
-{
-    if (!mRoutingBufferAllocated && mRoutingBuffer == nullptr)
-    {
-        mRoutingBuffer = new Float32[kRoutingBufferFrames * kRoutingBufferChannels];
-        // Zero the buffer
-        memset(mRoutingBuffer, 0, kRoutingBufferFrames * kRoutingBufferChannels * sizeof(Float32));
-        mRoutingBufferAllocated = true;
-        mRoutingBufferWritePos = 0;
-    }
-}
-
-void    BGM_Client::DeallocateRoutingBuffer()
-{
-    if (mRoutingBufferAllocated && mRoutingBuffer != nullptr)
-    {
-        delete[] mRoutingBuffer;
-        mRoutingBuffer = nullptr;
-        mRoutingBufferAllocated = false;
-        mRoutingBufferWritePos = 0;
-    }
+    // The mix-minus buffer is owned by BGM_ClientMap, so the copies share it
+    mMixMinus = inClient.mMixMinus;
+    mMixMinusBuffer = inClient.mMixMinusBuffer;
+    
+    // Same for the routing buffer, capture submixes, crossfade ramp, automation, scene morph, signal
+    // classifier and loudness meter, which are owned by BGM_Clients
+    mRoutingBuffer = inClient.mRoutingBuffer;
+    mCaptureSubmix = inClient.mCaptureSubmix;
+    mCaptureSubmixContributions = inClient.mCaptureSubmixContributions;
+    mCrossfadeRamp = inClient.mCrossfadeRamp;
+    mAutomation = inClient.mAutomation;
+    mSceneMorph = inClient.mSceneMorph;
+    mSignalClassifier = inClient.mSignalClassifier;
+    mLoudnessMeter = inClient.mLoudnessMeter;
+    
+    // And the client's slot in BGM_Clients' DSP state pool, so the copies share its EQ state
+    mDSPStateSlot = inClient.mDSPStateSlot;
 }
 
-void    BGM_Client::StoreToRoutingBuffer(const Float32* inBuffer, UInt32 inFrameCount, Float64 inSampleTime)
+void    BGM_Client::ComputeEQCoefficients(Float32 inGainDB,
+                                          Float32 inFreq,
+                                          Float64 inSampleRate,
+                                          int filterType,
+                                          Float32* outCoeffs)
 {
-    if (!mRoutingBufferAllocated || mRoutingBuffer == nullptr)
-    {
-        return;
-    }
+    // filterType: 0=low shelf, 1=parametric, 2=high shelf
+    // outCoeffs: [b0, b1, b2, a1, a2]
+    Float64 A = pow(10.0, inGainDB / 40.0);  // sqrt of linear gain
+    Float64 w0 = 2.0 * M_PI * inFreq / inSampleRate;
+    Float64 cosw0 = cos(w0);
+    Float64 sinw0 = sin(w0);
     
-    // Store interleaved stereo samples in circular buffer
-    UInt64 writePos = mRoutingBufferWritePos.load(std::memory_order_relaxed);
+    Float64 b0, b1, b2, a0, a1, a2;
     
-    for (UInt32 frame = 0; frame < inFrameCount; frame++)
-    {
-        UInt32 bufferOffset = (writePos % kRoutingBufferFrames) * kRoutingBufferChannels;
-        mRoutingBuffer[bufferOffset + 0] = inBuffer[frame * 2 + 0];  // Left
-        mRoutingBuffer[bufferOffset + 1] = inBuffer[frame * 2 + 1];  // Right
-        writePos++;
+    if (filterType == 0) {
+        // Low shelf
+        Float64 S = 1.0;
+        Float64 alpha = sinw0 / 2.0 * sqrt((A + 1.0/A) * (1.0/S - 1.0) + 2.0);
+        Float64 sqrtA = sqrt(A);
+        
+        b0 = A * ((A + 1.0) - (A - 1.0) * cosw0 + 2.0 * sqrtA * alpha);
+        b1 = 2.0 * A * ((A - 1.0) - (A + 1.0) * cosw0);
+        b2 = A * ((A + 1.0) - (A - 1.0) * cosw0 - 2.0 * sqrtA * alpha);
+        a0 = (A + 1.0) + (A - 1.0) * cosw0 + 2.0 * sqrtA * alpha;
+        a1 = -2.0 * ((A - 1.0) + (A + 1.0) * cosw0);
+        a2 = (A + 1.0) + (A - 1.0) * cosw0 - 2.0 * sqrtA * alpha;
+    } else if (filterType == 2) {
+        // High shelf
+        Float64 S = 1.0;
+        Float64 alpha = sinw0 / 2.0 * sqrt((A + 1.0/A) * (1.0/S - 1.0) + 2.0);
+        Float64 sqrtA = sqrt(A);
+        
+        b0 = A * ((A + 1.0) + (A - 1.0) * cosw0 + 2.0 * sqrtA * alpha);
+        b1 = -2.0 * A * ((A - 1.0) + (A + 1.0) * cosw0);
+        b2 = A * ((A + 1.0) + (A - 1.0) * cosw0 - 2.0 * sqrtA * alpha);
+        a0 = (A + 1.0) - (A - 1.0) * cosw0 + 2.0 * sqrtA * alpha;
+        a1 = 2.0 * ((A - 1.0) - (A + 1.0) * cosw0);
+        a2 = (A + 1.0) - (A - 1.0) * cosw0 - 2.0 * sqrtA * alpha;
+    } else {
+        // Parametric (peaking) - wide Q for broad mid control
+        Float64 Q = 0.5;
+        Float64 alpha = sinw0 / (2.0 * Q);
+        
+        b0 = 1.0 + alpha * A;
+        b1 = -2.0 * cosw0;
+        b2 = 1.0 - alpha * A;
+        a0 = 1.0 + alpha / A;
+        a1 = -2.0 * cosw0;
+        a2 = 1.0 - alpha / A;
     }
     
-    mRoutingBufferWritePos.store(writePos, std::memory_order_release);
-    mRoutingBufferSampleTime = inSampleTime + inFrameCount;
+    // Normalize and output
+    outCoeffs[0] = static_cast<Float32>(b0 / a0);
+    outCoeffs[1] = static_cast<Float32>(b1 / a0);
+    outCoeffs[2] = static_cast<Float32>(b2 / a0);
+    outCoeffs[3] = static_cast<Float32>(a1 / a0);
+    outCoeffs[4] = static_cast<Float32>(a2 / a0);
 }
 
-Float32 BGM_Client::FetchFromRoutingBuffer(SInt32 inChannel, UInt64 inSampleOffset) const
+#pragma mark BGM_RoutingKernel
+
+BGM_RoutingKernel::BGM_RoutingKernel(const BGM_AudioRoute& inRoute, UInt32 inSourceClientID)
+:
+    mSourceClientID(inSourceClientID),
+    mDelayFrames(inRoute.mDelayFrames)
 {
-    if (!mRoutingBufferAllocated || mRoutingBuffer == nullptr)
+    if(inRoute.HasDefaultChannelGains())
     {
-        return 0.0f;
-    }
-    
-    // Calculate buffer position
-    UInt64 readPos = mRoutingBufferWritePos.load(std::memory_order_acquire);
-    
-    // We want to read data that was written inSampleOffset frames ago
-    // Make sure we don't underflow
-    if (readPos < inSampleOffset)
-    {
-        return 0.0f;
+        mIsDenseStereo = true;
+        mDenseGain = inRoute.mGain;
+        return;
     }
     
-    UInt64 targetPos = readPos - inSampleOffset;
-    UInt32 bufferOffset = (targetPos % kRoutingBufferFrames) * kRoutingBufferChannels;
-    
-    // Bounds check the channel
-    if (inChannel < 0 || inChannel >= static_cast<SInt32>(kRoutingBufferChannels))
+    for(UInt32 theDestChannel = 0; theDestChannel < BGM_AudioRoute::kChannels; theDestChannel++)
     {
-        return 0.0f;
+        for(UInt32 theSourceChannel = 0; theSourceChannel < BGM_AudioRoute::kChannels; theSourceChannel++)
+        {
+            Float32 theGain = inRoute.mChannelGains[theDestChannel][theSourceChannel] * inRoute.mGain;
+            
+            if(theGain != 0.0f)
+            {
+                mTaps[mNumTaps++] = { theSourceChannel, theDestChannel, theGain };
+            }
+        }
     }
-    
-    return mRoutingBuffer[bufferOffset + static_cast<UInt32>(inChannel)];
 }
-
@@ -23,13 +23,23 @@
 #ifndef __BGMDriver__BGM_Client__
 #define __BGMDriver__BGM_Client__
 
+// Local Includes
+#include "BGM_ClientDSPStatePool.h"
+#include "BGM_Ducker.h"
+#include "BGM_GainRamp.h"
+#include "BGM_LoudnessMeter.h"
+#include "BGM_ParameterAutomation.h"
+#include "BGM_SampleTimeRingBuffer.h"
+#include "BGM_SceneMorph.h"
+#include "BGM_SignalClassifier.h"
+#include "BGM_Types.h"
+
 // PublicUtility Includes
 #include "CACFString.h"
 
 // System Includes
 #include <CoreAudio/AudioServerPlugIn.h>
 #include <vector>
-#include <atomic>
 
 
 #pragma clang assume_nonnull begin
@@ -42,15 +52,106 @@
 
 struct BGM_AudioRoute
 {
+    static constexpr UInt32 kChannels = 2;
+    
     pid_t       mSourcePID = 0;         // Source client process ID
     pid_t       mDestPID = 0;           // Destination client process ID  
+    
+    // If set, the route's source/destination is every client with this bundle ID instead of the
+    // clients of mSourcePID/mDestPID. This lets a route follow an app's helper processes, which
+    // usually come and go while the app is running.
+    CACFString  mSourceBundleID;
+    CACFString  mDestBundleID;
+    
     Float32     mGain = 1.0f;           // Routing gain (0.0 to 1.0+)
     bool        mEnabled = false;       // Is the route active
+    UInt32      mDelayFrames = 0;       // Extra delay, on top of the loopback alignment
+    
+    // The gain from each source channel to each destination channel, before mGain is applied.
+    // Indexed [destination channel][source channel]. Defaults to L->L and R->R.
+    Float32     mChannelGains[kChannels][kChannels] = { { 1.0f, 0.0f }, { 0.0f, 1.0f } };
     
     bool operator==(const BGM_AudioRoute& other) const {
-        return mSourcePID == other.mSourcePID && 
-               mDestPID == other.mDestPID;
+        return EndpointMatches(mSourcePID, mSourceBundleID, other.mSourcePID, other.mSourceBundleID) &&
+               EndpointMatches(mDestPID, mDestBundleID, other.mDestPID, other.mDestBundleID);
+    }
+    
+    // True if a client with the given PID and bundle ID is the source/destination of this route.
+    bool SourceMatches(pid_t inPID, const CACFString& inBundleID) const {
+        return ClientMatches(mSourcePID, mSourceBundleID, inPID, inBundleID);
+    }
+    
+    bool DestMatches(pid_t inPID, const CACFString& inBundleID) const {
+        return ClientMatches(mDestPID, mDestBundleID, inPID, inBundleID);
+    }
+    
+    // True if the channel matrix is the default, L->L and R->R.
+    bool HasDefaultChannelGains() const {
+        return mChannelGains[0][0] == 1.0f && mChannelGains[0][1] == 0.0f &&
+               mChannelGains[1][0] == 0.0f && mChannelGains[1][1] == 1.0f;
     }
+    
+private:
+    static bool ClientMatches(pid_t inEndpointPID,
+                              const CACFString& inEndpointBundleID,
+                              pid_t inPID,
+                              const CACFString& inBundleID) {
+        if(inEndpointBundleID.IsValid())
+        {
+            return inBundleID.IsValid() && inBundleID == inEndpointBundleID;
+        }
+        
+        return inPID == inEndpointPID;
+    }
+    
+    static bool EndpointMatches(pid_t inPID1,
+                                const CACFString& inBundleID1,
+                                pid_t inPID2,
+                                const CACFString& inBundleID2) {
+        if(inBundleID1.IsValid() || inBundleID2.IsValid())
+        {
+            return inBundleID1.IsValid() && inBundleID2.IsValid() && inBundleID1 == inBundleID2;
+        }
+        
+        return inPID1 == inPID2;
+    }
+};
+
+//==================================================================================================
+//	BGM_RoutingKernel
+//
+//  A route compiled into the form it's mixed in with during IO. Each destination client holds the
+//  kernels for its incoming routes.
+//==================================================================================================
+
+struct BGM_RoutingKernel
+{
+    struct Tap
+    {
+        UInt32  mSourceChannel;
+        UInt32  mDestChannel;
+        Float32 mGain;
+    };
+    
+    // The client whose routing buffer the kernel reads from. A route to or from an app with several
+    // clients is compiled into a kernel for each pair of its source and destination clients.
+    UInt32      mSourceClientID = 0;
+    
+    // The route's delay. The kernel reads the source's audio from this many frames before the
+    // destination's input sample time.
+    UInt32      mDelayFrames = 0;
+    
+    // True if the route's channel matrix is L->L and R->R with the same gain, in which case the
+    // source's interleaved audio is mixed in with a single vectorised multiply-add.
+    bool        mIsDenseStereo = false;
+    Float32     mDenseGain = 0.0f;
+    
+    // Otherwise, the non-zero entries of the route's channel matrix (with its overall gain applied).
+    UInt32      mNumTaps = 0;
+    Tap         mTaps[BGM_AudioRoute::kChannels * BGM_AudioRoute::kChannels];
+    
+    BGM_RoutingKernel() = default;
+    BGM_RoutingKernel(const BGM_AudioRoute& inRoute, UInt32 inSourceClientID);
 };
 
 //==================================================================================================
@@ -74,6 +175,19 @@ private:
     void                          Copy(const BGM_Client& inClient);
     
 public:
+    // The EQ bands. filterType is 0 for the low shelf, 1 for the mid peak and 2 for the high shelf.
+    // Writes the band's biquad coefficients, [b0, b1, b2, a1, a2], to outCoeffs. Real-time safe.
+    static void                   ComputeEQCoefficients(Float32 inGainDB,
+                                                        Float32 inFreq,
+                                                        Float64 inSampleRate,
+                                                        int filterType,
+                                                        Float32* outCoeffs);
+    
+    static constexpr Float32      kEQLowFrequency = 250.0f;
+    static constexpr Float32      kEQMidFrequency = 1000.0f;
+    static constexpr Float32      kEQHighFrequency = 3000.0f;
+    
+
     // These fields are duplicated from AudioServerPlugInClientInfo (except the mBundleID CFStringRef is
     // wrapped in a CACFString here).
     UInt32                        mClientID;
@@ -108,35 +222,83 @@ public:
     Float32                       mEQMidCoeffs[5] = {1.0f, 0.0f, 0.0f, 0.0f, 0.0f};
     Float32                       mEQHighCoeffs[5] = {1.0f, 0.0f, 0.0f, 0.0f, 0.0f};
     
-    // EQ filter delay states per channel (L/R)
-    Float32                       mEQLowDelayL[2] = {0.0f, 0.0f};
-    Float32                       mEQLowDelayR[2] = {0.0f, 0.0f};
-    Float32                       mEQMidDelayL[2] = {0.0f, 0.0f};
-    Float32                       mEQMidDelayR[2] = {0.0f, 0.0f};
-    Float32                       mEQHighDelayL[2] = {0.0f, 0.0f};
-    Float32                       mEQHighDelayR[2] = {0.0f, 0.0f};
-    
-    // Per-client ring buffer for inter-app routing (stores this client's processed audio)
-    // Other clients can read from this buffer if they have routes configured
-    // Buffer is allocated lazily when first route to this client is created
+    // The client's slot in BGM_Clients' DSP state pool, which holds the state that changes while
+    // its audio is processed (on the IO thread or a DSP worker): the EQ's filter states and where
+    // its app's slot in the shared parameter table was last found. It's kept out of BGM_Client so
+    // BGM_ClientMap's two copies of the client share it. Assigned by BGM_Clients when the client is
+    // added.
+    UInt32                        mDSPStateSlot = BGM_ClientDSPStatePool::kNoSlot;
+    
+    // The most frames of routed audio MixRoutedAudioRT mixes into a destination at a time
     static constexpr UInt32       kRoutingBufferFrames = 4096;
     static constexpr UInt32       kRoutingBufferChannels = 2;
-    Float32*                      mRoutingBuffer = nullptr;        // [kRoutingBufferFrames * kRoutingBufferChannels]
-    std::atomic<UInt64>           mRoutingBufferWritePos{0};       // Current write position in frames
-    Float64                       mRoutingBufferSampleTime = 0.0;  // Sample time of last write
-    bool                          mRoutingBufferAllocated = false;
+    
+    // If this client is the source of an enabled route, its audio (from before its volume, etc. are
+    // applied) indexed by output sample time, so each destination can read the audio for its own
+    // input sample time. Owned by BGM_Clients, which shares it between the copies of the client in
+    // the client maps and only frees it after updating both of them.
+    BGM_SampleTimeRingBuffer* _Nullable mRoutingBuffer = nullptr;
     
     // Routes FROM this client to other clients
     std::vector<BGM_AudioRoute>   mOutgoingRoutes;
     
-    // Allocate routing buffer (called when first route involving this client is created)
-    void                          AllocateRoutingBuffer();
-    // Deallocate routing buffer
-    void                          DeallocateRoutingBuffer();
-    // Store processed audio into routing buffer
-    void                          StoreToRoutingBuffer(const Float32* inBuffer, UInt32 inFrameCount, Float64 inSampleTime);
-    // Fetch audio from routing buffer for a specific channel
-    Float32                       FetchFromRoutingBuffer(SInt32 inChannel, UInt64 inSampleOffset) const;
+    // The enabled routes TO this client, compiled by BGM_Clients. Kept with the client so they can be
+    // read during IO without touching BGM_Clients' routing table.
+    std::vector<BGM_RoutingKernel> mIncomingRoutingKernels;
+    
+    // True if this client should be given a mix-minus loopback feed, i.e. the loopback audio minus
+    // its app's output. See kAudioDeviceCustomPropertyMixMinusApps.
+    bool                          mMixMinus = false;
+    
+    // This client's contribution to the output mix (after its volume, pan and EQ have been
+    // applied), indexed by sample time, so it can be subtracted from the loopback audio when the
+    // client reads it. Only allocated for mix-minus clients. Owned by BGM_ClientMap, which shares it
+    // between its two copies of the client.
+    BGM_SampleTimeRingBuffer* _Nullable mMixMinusBuffer = nullptr;
+    
+    // If this client's app has a capture filter (see kAudioDeviceCustomPropertyCaptureFilters), the
+    // filtered submix it reads from BGMDevice's input stream instead of the full loopback audio.
+    BGM_SampleTimeRingBuffer* _Nullable mCaptureSubmix = nullptr;
+    
+    // The filtered submixes that include this client's audio. The client's output is mixed into each
+    // of them in ProcessOutput.
+    //
+    // The submixes are owned by BGM_Clients, which only frees them after updating these pointers in
+    // both of BGM_ClientMap's copies of the client.
+    std::vector<BGM_SampleTimeRingBuffer*> mCaptureSubmixContributions;
+    
+    // If this client's app is in one of the crossfader's groups (see
+    // kAudioDeviceCustomPropertyCrossfader), the ramp that applies the crossfader's gain to its
+    // audio. Owned by BGM_Clients, like mRoutingBuffer.
+    BGM_GainRamp* _Nullable       mCrossfadeRamp = nullptr;
+    
+    // If gain changes have been scheduled for this client's app (see
+    // kAudioDeviceCustomPropertyAppAutomation), the queue of changes and the gain they've got to.
+    // Owned by BGM_Clients.
+    BGM_ParameterAutomation* _Nullable mAutomation = nullptr;
+    
+    // If a scene with a morph time has been set (see kAudioDeviceCustomPropertyScene), the morph
+    // from this client's settings before the scene to the scene's. mRelativeVolume, mPanPosition and
+    // the EQ settings are already the scene's, but aren't used until the morph has finished. Owned
+    // by BGM_Clients.
+    BGM_SceneMorph* _Nullable     mSceneMorph = nullptr;
+    
+    // Whether this client's app triggers ducking or is ducked (see
+    // kAudioDeviceCustomPropertyDucking). The music player is also ducked if the ducking settings
+    // say so, which is checked separately so this doesn't have to change with the music player.
+    BGM_Ducker::Role              mDuckingRole = BGM_Ducker::kRoleNone;
+    
+    // How much of this client's optional processing can be skipped when an IO cycle is running out
+    // of time (see kAudioDeviceCustomPropertyAppPriorities and BGM_DSPBudget).
+    BGMAppPriority                mPriority = kBGMAppPriorityNormal;
+    
+    // Classifies this client's audio as silent, transient or sustained each IO cycle, so short
+    // sounds like notifications don't make the device audible. Owned by BGM_Clients.
+    BGM_SignalClassifier* _Nullable mSignalClassifier = nullptr;
+    
+    // Measures the loudness of this client's audio and applies the loudness normalization gain to
+    // it (see kAudioDeviceCustomPropertyLoudness). Owned by BGM_Clients.
+    BGM_LoudnessMeter* _Nullable  mLoudnessMeter = nullptr;
     
 };
 
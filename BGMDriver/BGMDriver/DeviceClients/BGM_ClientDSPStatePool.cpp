@@ -0,0 +1,204 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+
+//
+//
+//  BGM_ClientDSPStatePool.cpp
+//  BGMDriver
+//
+//  Copyright © 2026 Background Music contributors
+//
+
+// Self Include
+#include "BGM_ClientDSPStatePool.h"
+
+// Local Includes
+#include "BGM_DSPContext.h"
+#include "BGM_Utils.h"
+
+// PublicUtility Includes
+#include "CAException.h"
+
+// STL Includes
+#include <algorithm>
+#include <new>
+
+// System Includes
+#include <CoreAudio/AudioHardwareBase.h>
+#include <stdlib.h>
+
+
+#pragma clang assume_nonnull begin
+
+// Each of a block's arrays should start on its own cache line.
+static_assert(sizeof(Float32) * BGM_ClientDSPStatePool::kSlotsPerBlock % 64 == 0,
+              "The EQ state arrays aren't a whole number of cache lines");
+
+BGM_ClientDSPStatePool::BGM_ClientDSPStatePool()
+:
+    mBlocks()
+{
+    // Allocate the first block now, so the pool doesn't have to allocate until it has more clients
+    // than that.
+    UInt32 theSlot = AllocateSlot();
+    FreeSlot(theSlot);
+}
+
+BGM_ClientDSPStatePool::~BGM_ClientDSPStatePool()
+{
+    for(UInt32 i = 0; i < mBlockCount; i++)
+    {
+        mBlocks[i]->~Block();
+        free(mBlocks[i]);
+    }
+}
+
+UInt32  BGM_ClientDSPStatePool::AllocateSlot()
+{
+    if(mFreeSlots.empty())
+    {
+        ThrowIf(mBlockCount == kMaxBlocks,
+                CAException(kAudioHardwareIllegalOperationError),
+                "BGM_ClientDSPStatePool::AllocateSlot: Too many clients");
+
+        void* theMemory = nullptr;
+
+        if(posix_memalign(&theMemory, kCacheLineSize, sizeof(Block)) != 0)
+        {
+            throw std::bad_alloc();
+        }
+
+        // Reserve the free list's memory first, so a block is never allocated without its slots
+        // being added to it.
+        try
+        {
+            mFreeSlots.reserve((mBlockCount + 1) * kSlotsPerBlock);
+        }
+        catch(...)
+        {
+            free(theMemory);
+            throw;
+        }
+
+        mBlocks[mBlockCount] = new (theMemory) Block;
+
+        // Push the slots in reverse so the lowest is used first.
+        for(UInt32 i = kSlotsPerBlock; i > 0; i--)
+        {
+            mFreeSlots.push_back(mBlockCount * kSlotsPerBlock + i - 1);
+        }
+
+        mBlockCount++;
+    }
+
+    UInt32 theSlot = mFreeSlots.back();
+    mFreeSlots.pop_back();
+
+    // Reset the state the slot's previous client left.
+    Block& theBlock = GetBlockRT(theSlot);
+    const UInt32 theIndex = theSlot % kSlotsPerBlock;
+
+    for(UInt32 theState = 0; theState < kEQStateCount; theState++)
+    {
+        theBlock.mEQStates[theState][theIndex] = 0.0f;
+    }
+
+    theBlock.mParameterSlotCaches[theIndex] = BGM_ParameterSlotCache();
+
+    return theSlot;
+}
+
+void    BGM_ClientDSPStatePool::FreeSlot(UInt32 inSlot)
+{
+    BGMAssert(inSlot < mBlockCount * kSlotsPerBlock, "Invalid slot %u", inSlot);
+    BGMAssert(std::find(mFreeSlots.begin(), mFreeSlots.end(), inSlot) == mFreeSlots.end(),
+              "Slot %u freed twice",
+              inSlot);
+
+    // mFreeSlots has already reserved enough memory for every slot.
+    mFreeSlots.push_back(inSlot);
+}
+
+UInt32  BGM_ClientDSPStatePool::GetSlotsInUse() const
+{
+    return mBlockCount * kSlotsPerBlock - static_cast<UInt32>(mFreeSlots.size());
+}
+
+BGM_ParameterSlotCache& BGM_ClientDSPStatePool::GetParameterSlotCacheRT(UInt32 inSlot) const
+{
+    return GetBlockRT(inSlot).mParameterSlotCaches[inSlot % kSlotsPerBlock];
+}
+
+BGM_ClientDSPStatePool::Block&  BGM_ClientDSPStatePool::GetBlockRT(UInt32 inSlot) const
+{
+    BGMAssert(inSlot < mBlockCount * kSlotsPerBlock, "Invalid slot %u", inSlot);
+    return *mBlocks[inSlot / kSlotsPerBlock];
+}
+
+#pragma mark EQ
+
+void    BGM_ClientDSPStatePool::ApplyEQRT(UInt32 inSlot,
+                                          const Float32* const inCoeffs[kEQBands],
+                                          Float32* ioBuffer,
+                                          UInt32 inFrameCount) const
+{
+    Block& theBlock = GetBlockRT(inSlot);
+    const UInt32 theIndex = inSlot % kSlotsPerBlock;
+
+    // Work on a local copy of the filter states, so the compiler can keep them in registers instead
+    // of reloading them after every write to ioBuffer, which it would have to assume might alias
+    // them.
+    Float32 theStates[kEQStateCount];
+
+    for(UInt32 theState = 0; theState < kEQStateCount; theState++)
+    {
+        theStates[theState] = theBlock.mEQStates[theState][theIndex];
+    }
+
+    // Once the client goes silent, the filters' states decay towards zero. Flush them when they're
+    // too small to matter, after which the EQ can be skipped until the client makes sound again.
+    bool isSettled = BGM_DSPContext::IsSilentRT(ioBuffer, inFrameCount * kEQChannels) &&
+                     BGM_DSPContext::FlushStateRT(theStates, kEQStateCount);
+
+    for(UInt32 theFrame = 0; !isSettled && theFrame < inFrameCount; theFrame++)
+    {
+        for(UInt32 theChannel = 0; theChannel < kEQChannels; theChannel++)
+        {
+            Float32 theSample = ioBuffer[theFrame * kEQChannels + theChannel];
+
+            for(UInt32 theBand = 0; theBand < kEQBands; theBand++)
+            {
+                const Float32* c = inCoeffs[theBand];
+                Float32* d = &theStates[(theBand * kEQChannels + theChannel) * 2];
+
+                const Float32 theOut = c[0] * theSample + d[0];
+                d[0] = c[1] * theSample - c[3] * theOut + d[1];
+                d[1] = c[2] * theSample - c[4] * theOut;
+                theSample = theOut;
+            }
+
+            ioBuffer[theFrame * kEQChannels + theChannel] = theSample;
+        }
+    }
+
+    for(UInt32 theState = 0; theState < kEQStateCount; theState++)
+    {
+        theBlock.mEQStates[theState][theIndex] = theStates[theState];
+    }
+}
+
+#pragma clang assume_nonnull end
+
@@ -0,0 +1,155 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+
+//
+//
+//  BGM_ClientDSPStatePool.h
+//  BGMDriver
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  Holds the state that changes while the clients' audio is processed, e.g. the filter
+//  states of their EQs, in preallocated blocks indexed by a slot that stays the same for as long as
+//  the client exists.
+//
+//  BGM_ClientMap keeps two copies of every BGM_Client and switches the IO thread between them
+//  whenever a client's settings change. If this state were kept in BGM_Client, each switch would
+//  move the IO thread onto the other copy's stale state, causing a discontinuity in the client's
+//  audio. BGM_Client only holds its slot, so both copies refer to the same state, and only the
+//  settings are copied.
+//
+//  Each block holds the state of kSlotsPerBlock clients, stored as a structure of arrays, i.e. the
+//  same variable for every slot in the block is stored contiguously. Blocks are aligned to cache
+//  lines and are never moved or freed until the pool is destroyed, so a slot can be used without
+//  locking. The first block is allocated when the pool is created, so adding a client only
+//  allocates if there are already more than kSlotsPerBlock clients.
+//
+//  AllocateSlot and FreeSlot are not real-time safe and must not be called concurrently. The
+//  methods ending in RT are called from the IO thread or, when the DSP is offloaded, from the
+//  BGM_DSPWorkerPool threads. (See BGM_IOPipeline.h.) Different slots can be used on different
+//  threads at the same time, but each slot must only be used by one thread at a time, which holds
+//  because each client's processing is either done on the IO thread or queued as a single job per
+//  cycle.
+//
+
+#ifndef BGMDriver__BGM_ClientDSPStatePool
+#define BGMDriver__BGM_ClientDSPStatePool
+
+// Local Includes
+#include "BGM_SharedParameterTable.h"
+
+// System Includes
+#include <MacTypes.h>
+
+// STL Includes
+#include <vector>
+
+
+#pragma clang assume_nonnull begin
+
+class BGM_ClientDSPStatePool
+{
+
+public:
+    static constexpr UInt32     kSlotsPerBlock = 64;
+    static constexpr UInt32     kMaxBlocks = 64;
+    static constexpr UInt32     kMaxSlots = kSlotsPerBlock * kMaxBlocks;
+
+    // The slot of a client that hasn't been given one.
+    static constexpr UInt32     kNoSlot = 0xFFFFFFFF;
+
+    // The number of EQ bands and the number of values in an EQ's filter states. Each band has a
+    // biquad filter per channel with two delays, in transposed direct form II.
+    static constexpr UInt32     kEQBands = 3;
+    static constexpr UInt32     kEQChannels = 2;
+    static constexpr UInt32     kEQStateCount = kEQBands * kEQChannels * 2;
+
+                                BGM_ClientDSPStatePool();
+                                ~BGM_ClientDSPStatePool();
+
+                                BGM_ClientDSPStatePool(const BGM_ClientDSPStatePool&) = delete;
+    BGM_ClientDSPStatePool&     operator=(const BGM_ClientDSPStatePool&) = delete;
+
+    /*!
+     Find an unused slot, allocating a new block if they're all in use, and reset its state.
+     Throws CAException if all kMaxSlots slots are in use.
+     */
+    UInt32                      AllocateSlot();
+
+    /*!
+     Return a slot to the pool. The IO thread and the DSP workers must no longer be able to reach
+     the slot, i.e. its client must have been removed from both sets of BGM_ClientMap's maps.
+     */
+    void                        FreeSlot(UInt32 inSlot);
+
+    /*! @return The number of slots currently allocated. */
+    UInt32                      GetSlotsInUse() const;
+
+    /*!
+     @return The cache of where the client's app's slot in the shared parameter table was last
+             found. See BGM_SharedParameterTable::GetValueRT. Only one thread may use the
+             slot's cache at a time.
+     */
+    BGM_ParameterSlotCache&     GetParameterSlotCacheRT(UInt32 inSlot) const;
+
+    /*!
+     Run a client's audio through its 3-band EQ. If the audio is silent and the filters' states
+     have decayed to almost nothing, they're flushed to zero (see BGM_DSPContext::FlushStateRT) and
+     the audio is left as it is.
+
+     Const because the state is kept in the blocks, rather than in the pool itself, which lets
+     const code in the IO path use it.
+     
+     Can be called from the IO thread or a DSP worker thread, but only one thread may process a
+     slot at a time, since the filter states are updated without locking.
+
+     @param inSlot The client's slot.
+     @param inCoeffs The biquad coefficients of the low, mid and high bands, each in the order b0,
+                     b1, b2, a1, a2. See BGM_Client::ComputeEQCoefficients.
+     @param ioBuffer The client's audio. Interleaved stereo.
+     @param inFrameCount The number of frames in ioBuffer.
+     */
+    void                        ApplyEQRT(UInt32 inSlot,
+                                          const Float32* const inCoeffs[kEQBands],
+                                          Float32* ioBuffer,
+                                          UInt32 inFrameCount) const;
+
+private:
+    struct Block
+    {
+        // The EQ filter states, indexed [state][slot]. The states of each client's filters are
+        // indexed by (band * kEQChannels + channel) * 2 + delay.
+        Float32                 mEQStates[kEQStateCount][kSlotsPerBlock];
+        BGM_ParameterSlotCache  mParameterSlotCaches[kSlotsPerBlock];
+    };
+
+    static constexpr size_t     kCacheLineSize = 64;
+
+    Block&                      GetBlockRT(UInt32 inSlot) const;
+
+    // The blocks allocated so far, in order. The rest are null.
+    Block* _Nullable            mBlocks[kMaxBlocks];
+    UInt32                      mBlockCount = 0;
+
+    // The slots in the allocated blocks that aren't in use.
+    std::vector<UInt32>         mFreeSlots;
+
+};
+
+#pragma clang assume_nonnull end
+
+#endif /* BGMDriver__BGM_ClientDSPStatePool */
+
@@ -0,0 +1,216 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+
+//
+//
+//  BGM_ClientIndex.h
+//  BGMDriver
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  An open-addressed hash table from a key, e.g. a client ID or a PID, to one of BGM_ClientMap's
+//  client slots. The keys aren't stored in the table. Each entry holds the key's hash and the slot,
+//  and the key is read from the client in the slot when the entry's hash matches, so an index by
+//  bundle ID doesn't have to retain its own copies of the strings.
+//
+//  Collisions are resolved by linear probing and entries are removed by shifting the entries after
+//  them back, so lookups never have to skip deleted entries. The table doubles in size when it's
+//  half full and never shrinks.
+//
+//  Find is real-time safe. The other methods aren't, and no thread can call Find while one of them
+//  is running. BGM_ClientMap guarantees that by keeping a separate set of indexes for each copy of
+//  the clients and only changing the set the IO threads aren't reading.
+//
+//  Traits has to provide:
+//
+//      typedef <key type> Key;
+//      static const Key& GetKey(const Slot& inSlot, UInt32 inCopy);
+//      static size_t Hash(const Key& inKey);
+//
+//  where inCopy is the copy of the client to read the key from. Keys are compared with ==.
+//
+
+#ifndef BGMDriver__BGM_ClientIndex
+#define BGMDriver__BGM_ClientIndex
+
+// System Includes
+#include <MacTypes.h>
+
+// STL Includes
+#include <vector>
+
+
+#pragma clang assume_nonnull begin
+
+template <typename Slot, typename Traits>
+class BGM_ClientIndex
+{
+
+public:
+    typedef typename Traits::Key Key;
+
+    /*! @param inCopy The copy of the clients this index is for. */
+    explicit                    BGM_ClientIndex(UInt32 inCopy)
+    :
+        mCopy(inCopy),
+        mEntries(kInitialCapacity),
+        mCount(0)
+    {
+    }
+
+    /*! @return The slot for inKey, or null if it isn't in the index. Real-time safe. */
+    Slot* _Nullable             Find(const Key& inKey) const
+    {
+        const size_t thePosition = FindPosition(inKey, Traits::Hash(inKey));
+        return (thePosition == kNotFound) ? nullptr : mEntries[thePosition].mSlot;
+    }
+
+    /*! Add inKey to the index. It must not already be in it. */
+    void                        Insert(const Key& inKey, Slot* inSlot)
+    {
+        if((mCount + 1) * 2 > mEntries.size())
+        {
+            Grow();
+        }
+
+        InsertEntry(Entry(Traits::Hash(inKey), inSlot));
+        mCount++;
+    }
+
+    /*! Change the slot for inKey, which must be in the index. */
+    void                        Replace(const Key& inKey, Slot* inSlot)
+    {
+        const size_t thePosition = FindPosition(inKey, Traits::Hash(inKey));
+
+        if(thePosition != kNotFound)
+        {
+            mEntries[thePosition].mSlot = inSlot;
+        }
+    }
+
+    /*! Remove inKey from the index, if it's in it. */
+    void                        Erase(const Key& inKey)
+    {
+        size_t theHole = FindPosition(inKey, Traits::Hash(inKey));
+
+        if(theHole == kNotFound)
+        {
+            return;
+        }
+
+        const size_t theMask = mEntries.size() - 1;
+
+        // Move back any entries after the hole that would be unreachable with the hole there, i.e.
+        // the ones whose home positions aren't between the hole and where they are.
+        for(size_t i = (theHole + 1) & theMask; mEntries[i].mSlot != nullptr; i = (i + 1) & theMask)
+        {
+            const size_t theHome = mEntries[i].mHash & theMask;
+            const bool isReachable =
+                (theHole <= i) ? (theHole < theHome && theHome <= i) : (theHole < theHome || theHome <= i);
+
+            if(!isReachable)
+            {
+                mEntries[theHole] = mEntries[i];
+                theHole = i;
+            }
+        }
+
+        mEntries[theHole] = Entry();
+        mCount--;
+    }
+
+    /*! Call inFunction with each slot in the index, in no particular order. */
+    template <typename Function>
+    void                        ForEach(Function inFunction) const
+    {
+        for(const Entry& theEntry : mEntries)
+        {
+            if(theEntry.mSlot != nullptr)
+            {
+                inFunction(theEntry.mSlot);
+            }
+        }
+    }
+
+    UInt32                      GetCount() const { return mCount; }
+
+private:
+    struct Entry
+    {
+                                Entry() = default;
+                                Entry(size_t inHash, Slot* inSlot) : mHash(inHash), mSlot(inSlot) { }
+        
+        size_t                  mHash = 0;
+        // Null if the entry is empty.
+        Slot* _Nullable         mSlot = nullptr;
+    };
+
+    static constexpr size_t     kInitialCapacity = 16;
+    static constexpr size_t     kNotFound = static_cast<size_t>(-1);
+
+    size_t                      FindPosition(const Key& inKey, size_t inHash) const
+    {
+        const size_t theMask = mEntries.size() - 1;
+
+        for(size_t i = inHash & theMask; mEntries[i].mSlot != nullptr; i = (i + 1) & theMask)
+        {
+            if(mEntries[i].mHash == inHash && Traits::GetKey(*mEntries[i].mSlot, mCopy) == inKey)
+            {
+                return i;
+            }
+        }
+
+        return kNotFound;
+    }
+
+    void                        InsertEntry(const Entry& inEntry)
+    {
+        const size_t theMask = mEntries.size() - 1;
+        size_t i = inEntry.mHash & theMask;
+
+        while(mEntries[i].mSlot != nullptr)
+        {
+            i = (i + 1) & theMask;
+        }
+
+        mEntries[i] = inEntry;
+    }
+
+    void                        Grow()
+    {
+        std::vector<Entry> theOldEntries(mEntries.size() * 2);
+        theOldEntries.swap(mEntries);
+
+        for(const Entry& theEntry : theOldEntries)
+        {
+            if(theEntry.mSlot != nullptr)
+            {
+                InsertEntry(theEntry);
+            }
+        }
+    }
+
+private:
+    UInt32                      mCopy;
+    // The size is always a power of two.
+    std::vector<Entry>          mEntries;
+    UInt32                      mCount;
+
+};
+
+#pragma clang assume_nonnull end
+
+#endif /* BGMDriver__BGM_ClientIndex */
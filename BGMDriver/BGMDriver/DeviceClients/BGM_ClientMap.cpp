@@ -32,15 +32,91 @@
 #include "CAException.h"
 
 // System Includes
+#include <algorithm>
 #include <climits>
 #include <cmath>
+#include <thread>
 
 
 #pragma clang assume_nonnull begin
 
+// The size of each mix-minus client's buffer. The same as BGMDevice's loopback ring buffer (see
+// kLoopbackRingBufferFrameSize), so a client's output can be subtracted for any sample time it can
+// still read from the loopback buffer.
+static const UInt32 kMixMinusBufferFrameSize = 16384;
+
+BGM_ClientMap::BGM_ClientMap()
+:
+    mMutex("Client map mutex"),
+    mPublishedCopy(0),
+    mReadIndicator(0),
+    mClientsByID { ClientIDIndex(0), ClientIDIndex(1) },
+    mClientsByPID { ProcessIDIndex(0), ProcessIDIndex(1) },
+    mClientsByBundleID { BundleIDIndex(0), BundleIDIndex(1) }
+{
+    mReaders[0] = 0;
+    mReaders[1] = 0;
+}
+
+#pragma mark Readers
+
+BGM_ClientMap::ReaderRT::ReaderRT(const BGM_ClientMap& inClientMap)
+:
+    mClientMap(inClientMap),
+    mReadIndicator(inClientMap.mReadIndicator.load())
+{
+    mClientMap.mReaders[mReadIndicator].fetch_add(1);
+}
+
+BGM_ClientMap::ReaderRT::~ReaderRT()
+{
+    mClientMap.mReaders[mReadIndicator].fetch_sub(1);
+}
+
+void    BGM_ClientMap::PublishShadowCopies()
+{
+    // Switch the IO threads over to the shadow copies
+    mPublishedCopy.store(GetShadowCopy());
+    
+    // Wait for the IO threads that could have started reading before the switch. New readers are
+    // counted by mReaders[mReadIndicator], so first make sure no readers are still counted by the
+    // other one, then have new readers use it instead and wait for the ones counted by this one to
+    // finish. Only IO threads hold ReaderRTs and they only hold them for an IO operation, so this
+    // shouldn't take long.
+    auto theWaitForReaders = [&] (UInt32 inReadIndicator) {
+        while(mReaders[inReadIndicator].load() != 0)
+        {
+            std::this_thread::yield();
+        }
+    };
+    
+    const UInt32 theReadIndicator = mReadIndicator.load();
+    
+    theWaitForReaders(theReadIndicator ^ 1);
+    mReadIndicator.store(theReadIndicator ^ 1);
+    theWaitForReaders(theReadIndicator);
+}
+
+//static
+size_t  BGM_ClientMap::HashInteger(UInt32 inValue)
+{
+    inValue ^= inValue >> 16;
+    inValue *= 0x85EBCA6B;
+    inValue ^= inValue >> 13;
+    inValue *= 0xC2B2AE35;
+    inValue ^= inValue >> 16;
+    return inValue;
+}
+
+#pragma mark Add/Remove Clients
+
 void    BGM_ClientMap::AddClient(BGM_Client inClient)
 {
-    CAMutex::Locker theShadowMapsLocker(mShadowMapsMutex);
+    CAMutex::Locker theLocker(mMutex);
+    
+    ThrowIf(mClientsByID[GetShadowCopy()].Find(inClient.mClientID) != nullptr,
+            BGM_InvalidClientException(),
+            "BGM_ClientMap::AddClient: Tried to add client whose client ID was already in use");
     
     // If this client has been a client in the past (and has a bundle ID), copy its previous audio settings
     auto pastClientItr = inClient.mBundleID.IsValid() ? mPastClientMap.find(inClient.mBundleID) : mPastClientMap.end();
@@ -54,15 +130,35 @@ void    BGM_ClientMap::AddClient(BGM_Client inClient)
         inClient.mPanPosition = pastClientItr->second.mPanPosition;
     }
     
-    // Add the new client to the shadow maps
-    AddClientToShadowMaps(inClient);
+    // Reuse a slot if there's a free one
+    Slot* theSlot;
+    
+    if(mFreeSlots.empty())
+    {
+        mSlots.emplace_back();
+        theSlot = &mSlots.back();
+    }
+    else
+    {
+        theSlot = mFreeSlots.back();
+        mFreeSlots.pop_back();
+    }
+    
+    // Mix-minus clients need a buffer for their output before they start IO
+    if(inClient.mMixMinus)
+    {
+        inClient.mMixMinusBuffer = GetOrCreateMixMinusBuffer(*theSlot);
+    }
+    
+    // Add the new client to the shadow copies
+    AddClientToShadowCopies(inClient, theSlot);
     
-    // Swap the maps with their shadow maps
-    SwapInShadowMaps();
+    // Publish them
+    PublishShadowCopies();
     
-    // The shadow maps (which were the main maps until we swapped them) are now missing the new client. Add it again to
-    // keep the sets of maps identical.
-    AddClientToShadowMaps(inClient);
+    // The new shadow copies (which were the published copies until now) are now missing the new
+    // client. Add it again to keep both copies identical.
+    AddClientToShadowCopies(inClient, theSlot);
 
     // Insert the client into the past clients map. We do this here rather than in RemoveClient
     // because some apps add multiple clients with the same bundle ID and we want to give them all
@@ -70,172 +166,320 @@ void    BGM_ClientMap::AddClient(BGM_Client inClient)
     if(inClient.mBundleID.IsValid())
     {
         mPastClientMap[inClient.mBundleID] = inClient;
+        // The mix-minus buffer will be freed when the client is removed.
+        mPastClientMap[inClient.mBundleID].mMixMinusBuffer = nullptr;
     }
 }
 
-void    BGM_ClientMap::AddClientToShadowMaps(BGM_Client inClient)
+void    BGM_ClientMap::AddClientToShadowCopies(const BGM_Client& inClient, Slot* inSlot)
 {
-    ThrowIf(mClientMapShadow.count(inClient.mClientID) != 0,
-            BGM_InvalidClientException(),
-            "BGM_ClientMap::AddClientToShadowMaps: Tried to add client whose client ID was already in use");
+    const UInt32 theCopy = GetShadowCopy();
     
-    // Add to the client ID shadow map
-    mClientMapShadow[inClient.mClientID] = inClient;
+    inSlot->mClient[theCopy] = inClient;
     
-    // Get a reference to the client in the map so we can add it to the pointer maps
-    BGM_Client& clientInMap = mClientMapShadow.at(inClient.mClientID);
+    mClientsByID[theCopy].Insert(inClient.mClientID, inSlot);
+    AddToList(mClientsByPID[theCopy], inClient.mProcessID, &Slot::mSamePID, inSlot);
     
-    // Add to the PID shadow map
-    mClientMapByPIDShadow[inClient.mProcessID].push_back(&clientInMap);
-    
-    // Add to the bundle ID shadow map
     if(inClient.mBundleID.IsValid())
     {
-        mClientMapByBundleIDShadow[inClient.mBundleID].push_back(&clientInMap);
+        AddToList(mClientsByBundleID[theCopy], inClient.mBundleID, &Slot::mSameBundleID, inSlot);
     }
 }
 
 BGM_Client    BGM_ClientMap::RemoveClient(UInt32 inClientID)
 {
-    CAMutex::Locker theShadowMapsLocker(mShadowMapsMutex);
+    CAMutex::Locker theLocker(mMutex);
     
-    auto theClientItr = mClientMapShadow.find(inClientID);
+    Slot* theSlot = mClientsByID[GetShadowCopy()].Find(inClientID);
     
     // Removing a client that was never added is an error
-    ThrowIf(theClientItr == mClientMapShadow.end(),
+    ThrowIf(theSlot == nullptr,
             BGM_InvalidClientException(),
             "BGM_ClientMap::RemoveClient: Could not find client to be removed");
     
-    BGM_Client theClient = theClientItr->second;
+    BGM_Client theClient = theSlot->mClient[GetShadowCopy()];
+    
+    // Remove the client from the shadow copies
+    RemoveClientFromShadowCopies(theSlot);
+    
+    // Publish them
+    PublishShadowCopies();
+    
+    // Remove the client again so both copies are kept identical
+    RemoveClientFromShadowCopies(theSlot);
+    
+    // Neither copy has the client now, so no IO thread can be using its mix-minus buffer or the
+    // slot
+    theSlot->mMixMinusBuffer.reset();
+    theClient.mMixMinusBuffer = nullptr;
+    
+    // Release the client's bundle ID, routes, etc. and free the slot
+    theSlot->mClient[0] = BGM_Client();
+    theSlot->mClient[1] = BGM_Client();
+    mFreeSlots.push_back(theSlot);
+    
+    return theClient;
+}
+
+void    BGM_ClientMap::RemoveClientFromShadowCopies(Slot* inSlot)
+{
+    const UInt32 theCopy = GetShadowCopy();
+    const BGM_Client& theClient = inSlot->mClient[theCopy];
+    
+    // Remove from the lists first, since the indexes read the keys from the client
+    RemoveFromList(mClientsByPID[theCopy], theClient.mProcessID, &Slot::mSamePID, inSlot);
     
-    // Remove the client from the shadow maps
-    mClientMapShadow.erase(theClientItr);
-    mClientMapByPIDShadow.erase(theClient.mProcessID);
     if(theClient.mBundleID.IsValid())
     {
-        mClientMapByBundleID.erase(theClient.mBundleID);
+        RemoveFromList(mClientsByBundleID[theCopy], theClient.mBundleID, &Slot::mSameBundleID, inSlot);
     }
     
-    // Swap the maps with their shadow maps
-    SwapInShadowMaps();
+    mClientsByID[theCopy].Erase(theClient.mClientID);
+}
+
+template <typename Index>
+void    BGM_ClientMap::AddToList(Index& ioIndex,
+                                 const typename Index::Key& inKey,
+                                 ListMember inList,
+                                 Slot* inSlot)
+{
+    const UInt32 theCopy = GetShadowCopy();
+    Slot::Links& theLinks = (inSlot->*inList)[theCopy];
+    Slot* theFirst = ioIndex.Find(inKey);
     
-    // Erase the client again so the maps and their shadow maps are kept identical
-    mClientMapShadow.erase(inClientID);
-    mClientMapByPIDShadow.erase(theClient.mProcessID);
-    if(theClient.mBundleID.IsValid())
+    if(theFirst == nullptr)
     {
-        mClientMapByBundleID.erase(theClient.mBundleID);
+        // This is the only slot with the key
+        theLinks.mPrevious = inSlot;
+        theLinks.mNext = inSlot;
+        ioIndex.Insert(inKey, inSlot);
     }
+    else
+    {
+        // Add it to the end of the list, which is before the first slot since the list is circular
+        Slot* theLast = (theFirst->*inList)[theCopy].mPrevious;
+        
+        theLinks.mPrevious = theLast;
+        theLinks.mNext = theFirst;
+        (theLast->*inList)[theCopy].mNext = inSlot;
+        (theFirst->*inList)[theCopy].mPrevious = inSlot;
+    }
+}
+
+template <typename Index>
+void    BGM_ClientMap::RemoveFromList(Index& ioIndex,
+                                      const typename Index::Key& inKey,
+                                      ListMember inList,
+                                      Slot* inSlot)
+{
+    const UInt32 theCopy = GetShadowCopy();
+    Slot::Links& theLinks = (inSlot->*inList)[theCopy];
     
-    return theClient;
+    if(theLinks.mNext == inSlot)
+    {
+        // It was the only slot with the key
+        ioIndex.Erase(inKey);
+    }
+    else
+    {
+        (theLinks.mPrevious->*inList)[theCopy].mNext = theLinks.mNext;
+        (theLinks.mNext->*inList)[theCopy].mPrevious = theLinks.mPrevious;
+        
+        if(ioIndex.Find(inKey) == inSlot)
+        {
+            ioIndex.Replace(inKey, theLinks.mNext);
+        }
+    }
+    
+    theLinks = Slot::Links();
 }
 
-bool    BGM_ClientMap::GetClientRT(UInt32 inClientID, BGM_Client* outClient) const
+void    BGM_ClientMap::ForEachShadowClient(pid_t inAppPID, std::function<void(Slot&, BGM_Client&)> inFunction) const
 {
-    CAMutex::Locker theMapsLocker(mMapsMutex);
-    return GetClient(mClientMap, inClientID, outClient);
+    const UInt32 theCopy = GetShadowCopy();
+    Slot* theFirst = mClientsByPID[theCopy].Find(inAppPID);
+    Slot* theSlot = theFirst;
+    
+    while(theSlot != nullptr)
+    {
+        // Get the next slot first in case inFunction changes the client's PID
+        Slot* theNext = theSlot->mSamePID[theCopy].mNext;
+        inFunction(*theSlot, theSlot->mClient[theCopy]);
+        theSlot = (theNext == theFirst) ? nullptr : theNext;
+    }
 }
 
-BGM_Client* _Nullable BGM_ClientMap::GetClientPtrRT(UInt32 inClientID) const
+void    BGM_ClientMap::ForEachShadowClient(CACFString inAppBundleID, std::function<void(Slot&, BGM_Client&)> inFunction) const
 {
-    CAMutex::Locker theMapsLocker(mMapsMutex);
-    auto theClientItr = const_cast<std::map<UInt32, BGM_Client>&>(mClientMap).find(inClientID);
-    if(theClientItr != mClientMap.end())
+    // The index's hash function needs a valid string, and clients without bundle IDs aren't in it.
+    if(!inAppBundleID.IsValid())
     {
-        return &theClientItr->second;
+        return;
+    }
+    
+    const UInt32 theCopy = GetShadowCopy();
+    Slot* theFirst = mClientsByBundleID[theCopy].Find(inAppBundleID);
+    Slot* theSlot = theFirst;
+    
+    while(theSlot != nullptr)
+    {
+        Slot* theNext = theSlot->mSameBundleID[theCopy].mNext;
+        inFunction(*theSlot, theSlot->mClient[theCopy]);
+        theSlot = (theNext == theFirst) ? nullptr : theNext;
     }
-    return nullptr;
 }
 
-bool    BGM_ClientMap::GetClientNonRT(UInt32 inClientID, BGM_Client* outClient) const
+#pragma mark Client Lookup
+
+BGM_Client* _Nullable BGM_ClientMap::FindPublishedClientRT(UInt32 inClientID) const
 {
-    CAMutex::Locker theShadowMapsLocker(mShadowMapsMutex);
-    return GetClient(mClientMapShadow, inClientID, outClient);
+    const UInt32 theCopy = mPublishedCopy.load();
+    Slot* theSlot = mClientsByID[theCopy].Find(inClientID);
+    return (theSlot == nullptr) ? nullptr : &theSlot->mClient[theCopy];
 }
 
-//static
-bool    BGM_ClientMap::GetClient(const std::map<UInt32, BGM_Client>& inClientMap, UInt32 inClientID, BGM_Client* outClient)
+bool    BGM_ClientMap::GetClientRT(UInt32 inClientID, BGM_Client* outClient) const
 {
-    auto theClientItr = inClientMap.find(inClientID);
+    BGM_Client* theClient = FindPublishedClientRT(inClientID);
     
-    if(theClientItr != inClientMap.end())
+    if(theClient != nullptr)
     {
-        *outClient = theClientItr->second;
+        *outClient = *theClient;
         return true;
     }
     
     return false;
 }
 
-std::vector<BGM_Client> BGM_ClientMap::GetClientsByPID(pid_t inPID) const
+BGM_Client* _Nullable BGM_ClientMap::GetClientPtrRT(UInt32 inClientID) const
 {
-    CAMutex::Locker theShadowMapsLocker(mShadowMapsMutex);
+    return FindPublishedClientRT(inClientID);
+}
+
+bool    BGM_ClientMap::GetClientNonRT(UInt32 inClientID, BGM_Client* outClient) const
+{
+    CAMutex::Locker theLocker(mMutex);
     
-    std::vector<BGM_Client> theClients;
+    const UInt32 theCopy = GetShadowCopy();
+    Slot* theSlot = mClientsByID[theCopy].Find(inClientID);
     
-    auto theMapItr = mClientMapByPIDShadow.find(inPID);
-    if(theMapItr != mClientMapByPIDShadow.end())
+    if(theSlot != nullptr)
     {
-        // Found clients with the PID, so copy them into the return vector
-        for(auto& theClientPtrsItr : theMapItr->second)
-        {
-            theClients.push_back(*theClientPtrsItr);
-        }
+        *outClient = theSlot->mClient[theCopy];
+        return true;
     }
     
+    return false;
+}
+
+std::vector<BGM_Client> BGM_ClientMap::GetClientsByPID(pid_t inPID) const
+{
+    CAMutex::Locker theLocker(mMutex);
+    
+    std::vector<BGM_Client> theClients;
+    
+    ForEachShadowClient(inPID, [&] (Slot&, BGM_Client& inClient) {
+        theClients.push_back(inClient);
+    });
+    
     return theClients;
 }
 
+std::vector<UInt32> BGM_ClientMap::GetClientIDsNonRT(pid_t inPID) const
+{
+    CAMutex::Locker theLocker(mMutex);
+    
+    std::vector<UInt32> theClientIDs;
+    
+    ForEachShadowClient(inPID, [&] (Slot&, BGM_Client& inClient) {
+        theClientIDs.push_back(inClient.mClientID);
+    });
+    
+    return theClientIDs;
+}
+
+std::vector<UInt32> BGM_ClientMap::GetClientIDsNonRT(CACFString inBundleID) const
+{
+    CAMutex::Locker theLocker(mMutex);
+    
+    std::vector<UInt32> theClientIDs;
+    
+    ForEachShadowClient(inBundleID, [&] (Slot&, BGM_Client& inClient) {
+        theClientIDs.push_back(inClient.mClientID);
+    });
+    
+    return theClientIDs;
+}
+
+UInt32  BGM_ClientMap::GetClientCountNonRT() const
+{
+    CAMutex::Locker theLocker(mMutex);
+    return mClientsByID[GetShadowCopy()].GetCount();
+}
+
 #pragma mark Music Player
 
 void    BGM_ClientMap::UpdateMusicPlayerFlags(pid_t inMusicPlayerPID)
 {
-    CAMutex::Locker theShadowMapsLocker(mShadowMapsMutex);
+    CAMutex::Locker theLocker(mMutex);
     
-    auto theIsMusicPlayerTest = [&] (BGM_Client theClient) {
+    auto theIsMusicPlayerTest = [&] (const BGM_Client& theClient) {
         return (theClient.mProcessID == inMusicPlayerPID);
     };
     
-    UpdateMusicPlayerFlagsInShadowMaps(theIsMusicPlayerTest);
-    SwapInShadowMaps();
-    UpdateMusicPlayerFlagsInShadowMaps(theIsMusicPlayerTest);
+    UpdateMusicPlayerFlagsInShadowCopies(theIsMusicPlayerTest);
+    PublishShadowCopies();
+    UpdateMusicPlayerFlagsInShadowCopies(theIsMusicPlayerTest);
 }
 
 void    BGM_ClientMap::UpdateMusicPlayerFlags(CACFString inMusicPlayerBundleID)
 {
-    CAMutex::Locker theShadowMapsLocker(mShadowMapsMutex);
+    CAMutex::Locker theLocker(mMutex);
     
-    auto theIsMusicPlayerTest = [&] (BGM_Client theClient) {
+    auto theIsMusicPlayerTest = [&] (const BGM_Client& theClient) {
         return (theClient.mBundleID.IsValid() && theClient.mBundleID == inMusicPlayerBundleID);
     };
     
-    UpdateMusicPlayerFlagsInShadowMaps(theIsMusicPlayerTest);
-    SwapInShadowMaps();
-    UpdateMusicPlayerFlagsInShadowMaps(theIsMusicPlayerTest);
+    UpdateMusicPlayerFlagsInShadowCopies(theIsMusicPlayerTest);
+    PublishShadowCopies();
+    UpdateMusicPlayerFlagsInShadowCopies(theIsMusicPlayerTest);
 }
 
-void    BGM_ClientMap::UpdateMusicPlayerFlagsInShadowMaps(std::function<bool(BGM_Client)> inIsMusicPlayerTest)
+void    BGM_ClientMap::UpdateMusicPlayerFlagsInShadowCopies(std::function<bool(const BGM_Client&)> inIsMusicPlayerTest)
 {
-    for(auto& theItr : mClientMapShadow)
-    {
-        BGM_Client& theClient = theItr.second;
+    const UInt32 theCopy = GetShadowCopy();
+    
+    mClientsByID[theCopy].ForEach([&] (Slot* inSlot) {
+        BGM_Client& theClient = inSlot->mClient[theCopy];
         theClient.mIsMusicPlayer = inIsMusicPlayerTest(theClient);
-    }
+    });
 }
 
 #pragma mark App Volumes
 
-CACFArray   BGM_ClientMap::CopyClientRelativeVolumesAsAppVolumes(CAVolumeCurve inVolumeCurve) const
+CACFArray   BGM_ClientMap::CopyClientRelativeVolumesAsAppVolumes(const CAVolumeCurve& inVolumeCurve) const
 {
-    // Since this is a read-only, non-real-time operation, we can read from the shadow maps to avoid
-    // locking the main maps.
-    CAMutex::Locker theShadowMapsLocker(mShadowMapsMutex);
+    // Since this is a read-only, non-real-time operation, we can read from the shadow copies.
+    CAMutex::Locker theLocker(mMutex);
     
     CACFArray theAppVolumes(false);
     
-    for(auto& theClientEntry : mClientMapShadow)
+    // Add the clients in order of their IDs, so the array doesn't depend on the order of the index.
+    const UInt32 theCopy = GetShadowCopy();
+    std::vector<const BGM_Client*> theClients;
+    theClients.reserve(mClientsByID[theCopy].GetCount());
+    
+    mClientsByID[theCopy].ForEach([&] (Slot* inSlot) {
+        theClients.push_back(&inSlot->mClient[theCopy]);
+    });
+    
+    std::sort(theClients.begin(), theClients.end(), [] (const BGM_Client* inA, const BGM_Client* inB) {
+        return inA->mClientID < inB->mClientID;
+    });
+    
+    for(const BGM_Client* theClient : theClients)
     {
-        CopyClientIntoAppVolumesArray(theClientEntry.second, inVolumeCurve, theAppVolumes);
+        CopyClientIntoAppVolumesArray(*theClient, inVolumeCurve, theAppVolumes);
     }
     
     for(auto& thePastClientEntry : mPastClientMap)
@@ -246,10 +490,14 @@ CACFArray   BGM_ClientMap::CopyClientRelativeVolumesAsAppVolumes(CAVolumeCurve i
     return theAppVolumes;
 }
 
-void    BGM_ClientMap::CopyClientIntoAppVolumesArray(BGM_Client inClient, CAVolumeCurve inVolumeCurve, CACFArray& ioAppVolumes) const
+void    BGM_ClientMap::CopyClientIntoAppVolumesArray(const BGM_Client& inClient, const CAVolumeCurve& inVolumeCurve, CACFArray& ioAppVolumes) const
 {
-    // Only include clients set to a non-default volume or pan
-    if(inClient.mRelativeVolume != 1.0 || inClient.mPanPosition != 0)
+    bool hasEQ = (inClient.mEQLowGain != 0.0f ||
+                  inClient.mEQMidGain != 0.0f ||
+                  inClient.mEQHighGain != 0.0f);
+    
+    // Only include clients set to a non-default volume, pan or EQ
+    if(inClient.mRelativeVolume != 1.0 || inClient.mPanPosition != 0 || hasEQ)
     {
         CACFDictionary theAppVolume(false);
         
@@ -261,27 +509,21 @@ void    BGM_ClientMap::CopyClientIntoAppVolumesArray(BGM_Client inClient, CAVolu
         theAppVolume.AddSInt32(CFSTR(kBGMAppVolumesKey_PanPosition),
                                inClient.mPanPosition);
         
+        if(hasEQ)
+        {
+            // The EQ gains are sent in 10ths of dB
+            theAppVolume.AddSInt32(CFSTR(kBGMAppVolumesKey_EQLowGain),
+                                   static_cast<SInt32>(std::lround(inClient.mEQLowGain * 10.0f)));
+            theAppVolume.AddSInt32(CFSTR(kBGMAppVolumesKey_EQMidGain),
+                                   static_cast<SInt32>(std::lround(inClient.mEQMidGain * 10.0f)));
+            theAppVolume.AddSInt32(CFSTR(kBGMAppVolumesKey_EQHighGain),
+                                   static_cast<SInt32>(std::lround(inClient.mEQHighGain * 10.0f)));
+        }
+        
         ioAppVolumes.AppendDictionary(theAppVolume.GetDict());
     }
 }
 
-template <typename T>
-std::vector<BGM_Client*> * _Nullable GetClientsFromMap(std::map<T, std::vector<BGM_Client*>> & map, T key) {
-    auto theClientItr = map.find(key);
-    if(theClientItr != map.end()) {
-        return &theClientItr->second;
-    }
-    return nullptr;
-}
-
-std::vector<BGM_Client*> * _Nullable BGM_ClientMap::GetClients(pid_t inAppPid) {
-    return GetClientsFromMap(mClientMapByPIDShadow, inAppPid);
-}
-
-std::vector<BGM_Client*> * _Nullable BGM_ClientMap::GetClients(CACFString inAppBundleID) {
-    return GetClientsFromMap(mClientMapByBundleIDShadow, inAppBundleID);
-}
-
 void ShowSetRelativeVolumeMessage(pid_t inAppPID, BGM_Client* theClient);
 void ShowSetRelativeVolumeMessage(CACFString inAppBundleID, BGM_Client* theClient);
 
@@ -321,27 +563,22 @@ bool BGM_ClientMap::SetClientsRelativeVolume(pid_t searchKey, Float32 inRelative
 {
     bool didChangeVolume = false;
     
-    CAMutex::Locker theShadowMapsLocker(mShadowMapsMutex);
+    CAMutex::Locker theLocker(mMutex);
     
     auto theSetVolumesInShadowMapsFunc = [&] {
         // Look up the clients for the key and update their volumes
         
-        auto theClients = GetClients(searchKey);
-        if(theClients != nullptr)
-        {
-            for(BGM_Client* theClient : *theClients)
-            {
-                theClient->mRelativeVolume = inRelativeVolume;
-                
-                ShowSetRelativeVolumeMessage(searchKey, theClient);
-                
-                didChangeVolume = true;
-            }
-        }
+        ForEachShadowClient(searchKey, [&] (Slot&, BGM_Client& theClient) {
+            theClient.mRelativeVolume = inRelativeVolume;
+            
+            ShowSetRelativeVolumeMessage(searchKey, &theClient);
+            
+            didChangeVolume = true;
+        });
     };
     
     theSetVolumesInShadowMapsFunc();
-    SwapInShadowMaps();
+    PublishShadowCopies();
     theSetVolumesInShadowMapsFunc();
     
     return didChangeVolume;
@@ -351,27 +588,22 @@ bool BGM_ClientMap::SetClientsRelativeVolume(CACFString searchKey, Float32 inRel
 {
     bool didChangeVolume = false;
     
-    CAMutex::Locker theShadowMapsLocker(mShadowMapsMutex);
+    CAMutex::Locker theLocker(mMutex);
     
     auto theSetVolumesInShadowMapsFunc = [&] {
         // Look up the clients for the key and update their volumes
         
-        auto theClients = GetClients(searchKey);
-        if(theClients != nullptr)
-        {
-            for(BGM_Client* theClient : *theClients)
-            {
-                theClient->mRelativeVolume = inRelativeVolume;
-                
-                ShowSetRelativeVolumeMessage(searchKey, theClient);
-                
-                didChangeVolume = true;
-            }
-        }
+        ForEachShadowClient(searchKey, [&] (Slot&, BGM_Client& theClient) {
+            theClient.mRelativeVolume = inRelativeVolume;
+            
+            ShowSetRelativeVolumeMessage(searchKey, &theClient);
+            
+            didChangeVolume = true;
+        });
     };
     
     theSetVolumesInShadowMapsFunc();
-    SwapInShadowMaps();
+    PublishShadowCopies();
     theSetVolumesInShadowMapsFunc();
     
     return didChangeVolume;
@@ -381,21 +613,18 @@ bool BGM_ClientMap::SetClientsPanPosition(pid_t searchKey, SInt32 inPanPosition)
 {
     bool didChangePanPosition = false;
     
-    CAMutex::Locker theShadowMapsLocker(mShadowMapsMutex);
+    CAMutex::Locker theLocker(mMutex);
     
     auto theSetPansInShadowMapsFunc = [&] {
         // Look up the clients for the key and update their pan positions
-        auto theClients = GetClients(searchKey);
-        if(theClients != nullptr) {
-            for(auto theClient: *theClients) {
-                theClient->mPanPosition = inPanPosition;
-                didChangePanPosition = true;
-            }
-        }
+        ForEachShadowClient(searchKey, [&] (Slot&, BGM_Client& theClient) {
+            theClient.mPanPosition = inPanPosition;
+            didChangePanPosition = true;
+        });
     };
     
     theSetPansInShadowMapsFunc();
-    SwapInShadowMaps();
+    PublishShadowCopies();
     theSetPansInShadowMapsFunc();
     
     return didChangePanPosition;
@@ -405,113 +634,49 @@ bool BGM_ClientMap::SetClientsPanPosition(CACFString searchKey, SInt32 inPanPosi
 {
     bool didChangePanPosition = false;
     
-    CAMutex::Locker theShadowMapsLocker(mShadowMapsMutex);
+    CAMutex::Locker theLocker(mMutex);
     
     auto theSetPansInShadowMapsFunc = [&] {
         // Look up the clients for the key and update their pan positions
-        auto theClients = GetClients(searchKey);
-        if(theClients != nullptr) {
-            for(auto theClient: *theClients) {
-                theClient->mPanPosition = inPanPosition;
-                didChangePanPosition = true;
-            }
-        }
+        ForEachShadowClient(searchKey, [&] (Slot&, BGM_Client& theClient) {
+            theClient.mPanPosition = inPanPosition;
+            didChangePanPosition = true;
+        });
     };
     
     theSetPansInShadowMapsFunc();
-    SwapInShadowMaps();
+    PublishShadowCopies();
     theSetPansInShadowMapsFunc();
     
     return didChangePanPosition;
 }
 
-// Helper to compute biquad coefficients for EQ
-static void ComputeEQCoefficients(Float32 inGainDB, Float32 inFreq, Float64 inSampleRate, int filterType,
-                                   Float32* outCoeffs)
-{
-    // filterType: 0=low shelf, 1=parametric, 2=high shelf
-    // outCoeffs: [b0, b1, b2, a1, a2]
-    Float64 A = pow(10.0, inGainDB / 40.0);  // sqrt of linear gain
-    Float64 w0 = 2.0 * M_PI * inFreq / inSampleRate;
-    Float64 cosw0 = cos(w0);
-    Float64 sinw0 = sin(w0);
-    
-    Float64 b0, b1, b2, a0, a1, a2;
-    
-    if (filterType == 0) {
-        // Low shelf
-        Float64 S = 1.0;
-        Float64 alpha = sinw0 / 2.0 * sqrt((A + 1.0/A) * (1.0/S - 1.0) + 2.0);
-        Float64 sqrtA = sqrt(A);
-        
-        b0 = A * ((A + 1.0) - (A - 1.0) * cosw0 + 2.0 * sqrtA * alpha);
-        b1 = 2.0 * A * ((A - 1.0) - (A + 1.0) * cosw0);
-        b2 = A * ((A + 1.0) - (A - 1.0) * cosw0 - 2.0 * sqrtA * alpha);
-        a0 = (A + 1.0) + (A - 1.0) * cosw0 + 2.0 * sqrtA * alpha;
-        a1 = -2.0 * ((A - 1.0) + (A + 1.0) * cosw0);
-        a2 = (A + 1.0) + (A - 1.0) * cosw0 - 2.0 * sqrtA * alpha;
-    } else if (filterType == 2) {
-        // High shelf
-        Float64 S = 1.0;
-        Float64 alpha = sinw0 / 2.0 * sqrt((A + 1.0/A) * (1.0/S - 1.0) + 2.0);
-        Float64 sqrtA = sqrt(A);
-        
-        b0 = A * ((A + 1.0) + (A - 1.0) * cosw0 + 2.0 * sqrtA * alpha);
-        b1 = -2.0 * A * ((A - 1.0) + (A + 1.0) * cosw0);
-        b2 = A * ((A + 1.0) + (A - 1.0) * cosw0 - 2.0 * sqrtA * alpha);
-        a0 = (A + 1.0) - (A - 1.0) * cosw0 + 2.0 * sqrtA * alpha;
-        a1 = 2.0 * ((A - 1.0) - (A + 1.0) * cosw0);
-        a2 = (A + 1.0) - (A - 1.0) * cosw0 - 2.0 * sqrtA * alpha;
-    } else {
-        // Parametric (peaking) - wide Q for broad mid control
-        Float64 Q = 0.5;
-        Float64 alpha = sinw0 / (2.0 * Q);
-        
-        b0 = 1.0 + alpha * A;
-        b1 = -2.0 * cosw0;
-        b2 = 1.0 - alpha * A;
-        a0 = 1.0 + alpha / A;
-        a1 = -2.0 * cosw0;
-        a2 = 1.0 - alpha / A;
-    }
-    
-    // Normalize and output
-    outCoeffs[0] = static_cast<Float32>(b0 / a0);
-    outCoeffs[1] = static_cast<Float32>(b1 / a0);
-    outCoeffs[2] = static_cast<Float32>(b2 / a0);
-    outCoeffs[3] = static_cast<Float32>(a1 / a0);
-    outCoeffs[4] = static_cast<Float32>(a2 / a0);
-}
-
 bool BGM_ClientMap::SetClientsEQ(pid_t searchKey, Float32 inLowGain, Float32 inMidGain, Float32 inHighGain, Float64 inSampleRate)
 {
     bool didChangeEQ = false;
     
-    CAMutex::Locker theShadowMapsLocker(mShadowMapsMutex);
+    CAMutex::Locker theLocker(mMutex);
     
     auto theSetEQInShadowMapsFunc = [&] {
-        auto theClients = GetClients(searchKey);
-        if(theClients != nullptr) {
-            for(auto theClient: *theClients) {
-                if (inLowGain != kAppEQGainNoValue) {
-                    theClient->mEQLowGain = inLowGain;
-                    ComputeEQCoefficients(inLowGain, 250.0f, inSampleRate, 0, theClient->mEQLowCoeffs);
-                }
-                if (inMidGain != kAppEQGainNoValue) {
-                    theClient->mEQMidGain = inMidGain;
-                    ComputeEQCoefficients(inMidGain, 1000.0f, inSampleRate, 1, theClient->mEQMidCoeffs);
-                }
-                if (inHighGain != kAppEQGainNoValue) {
-                    theClient->mEQHighGain = inHighGain;
-                    ComputeEQCoefficients(inHighGain, 3000.0f, inSampleRate, 2, theClient->mEQHighCoeffs);
-                }
-                didChangeEQ = true;
+        ForEachShadowClient(searchKey, [&] (Slot&, BGM_Client& theClient) {
+            if (inLowGain != kAppEQGainNoValue) {
+                theClient.mEQLowGain = inLowGain;
+                BGM_Client::ComputeEQCoefficients(inLowGain, 250.0f, inSampleRate, 0, theClient.mEQLowCoeffs);
             }
-        }
+            if (inMidGain != kAppEQGainNoValue) {
+                theClient.mEQMidGain = inMidGain;
+                BGM_Client::ComputeEQCoefficients(inMidGain, 1000.0f, inSampleRate, 1, theClient.mEQMidCoeffs);
+            }
+            if (inHighGain != kAppEQGainNoValue) {
+                theClient.mEQHighGain = inHighGain;
+                BGM_Client::ComputeEQCoefficients(inHighGain, 3000.0f, inSampleRate, 2, theClient.mEQHighCoeffs);
+            }
+            didChangeEQ = true;
+        });
     };
     
     theSetEQInShadowMapsFunc();
-    SwapInShadowMaps();
+    PublishShadowCopies();
     theSetEQInShadowMapsFunc();
     
     return didChangeEQ;
@@ -521,31 +686,28 @@ bool BGM_ClientMap::SetClientsEQ(CACFString searchKey, Float32 inLowGain, Float3
 {
     bool didChangeEQ = false;
     
-    CAMutex::Locker theShadowMapsLocker(mShadowMapsMutex);
+    CAMutex::Locker theLocker(mMutex);
     
     auto theSetEQInShadowMapsFunc = [&] {
-        auto theClients = GetClients(searchKey);
-        if(theClients != nullptr) {
-            for(auto theClient: *theClients) {
-                if (inLowGain != kAppEQGainNoValue) {
-                    theClient->mEQLowGain = inLowGain;
-                    ComputeEQCoefficients(inLowGain, 200.0f, inSampleRate, 0, theClient->mEQLowCoeffs);
-                }
-                if (inMidGain != kAppEQGainNoValue) {
-                    theClient->mEQMidGain = inMidGain;
-                    ComputeEQCoefficients(inMidGain, 1000.0f, inSampleRate, 1, theClient->mEQMidCoeffs);
-                }
-                if (inHighGain != kAppEQGainNoValue) {
-                    theClient->mEQHighGain = inHighGain;
-                    ComputeEQCoefficients(inHighGain, 3000.0f, inSampleRate, 2, theClient->mEQHighCoeffs);
-                }
-                didChangeEQ = true;
+        ForEachShadowClient(searchKey, [&] (Slot&, BGM_Client& theClient) {
+            if (inLowGain != kAppEQGainNoValue) {
+                theClient.mEQLowGain = inLowGain;
+                BGM_Client::ComputeEQCoefficients(inLowGain, 200.0f, inSampleRate, 0, theClient.mEQLowCoeffs);
             }
-        }
+            if (inMidGain != kAppEQGainNoValue) {
+                theClient.mEQMidGain = inMidGain;
+                BGM_Client::ComputeEQCoefficients(inMidGain, 1000.0f, inSampleRate, 1, theClient.mEQMidCoeffs);
+            }
+            if (inHighGain != kAppEQGainNoValue) {
+                theClient.mEQHighGain = inHighGain;
+                BGM_Client::ComputeEQCoefficients(inHighGain, 3000.0f, inSampleRate, 2, theClient.mEQHighCoeffs);
+            }
+            didChangeEQ = true;
+        });
     };
     
     theSetEQInShadowMapsFunc();
-    SwapInShadowMaps();
+    PublishShadowCopies();
     theSetEQInShadowMapsFunc();
     
     return didChangeEQ;
@@ -553,86 +715,207 @@ bool BGM_ClientMap::SetClientsEQ(CACFString searchKey, Float32 inLowGain, Float3
 
 void    BGM_ClientMap::UpdateClientIOStateNonRT(UInt32 inClientID, bool inDoingIO)
 {
-    CAMutex::Locker theShadowMapsLocker(mShadowMapsMutex);
+    CAMutex::Locker theLocker(mMutex);
+    
+    auto theUpdateShadowCopyFunc = [&] {
+        Slot* theSlot = mClientsByID[GetShadowCopy()].Find(inClientID);
+        
+        if(theSlot != nullptr)
+        {
+            theSlot->mClient[GetShadowCopy()].mDoingIO = inDoingIO;
+        }
+    };
     
-    mClientMapShadow[inClientID].mDoingIO = inDoingIO;
-    SwapInShadowMaps();
-    mClientMapShadow[inClientID].mDoingIO = inDoingIO;
+    theUpdateShadowCopyFunc();
+    PublishShadowCopies();
+    theUpdateShadowCopyFunc();
 }
 
-void    BGM_ClientMap::SwapInShadowMaps()
+#pragma mark Routing
+
+BGM_Client* _Nullable BGM_ClientMap::GetClientByPIDRT(pid_t inAppPID) const
 {
-    mTaskQueue->QueueSync_SwapClientShadowMaps(this);
+    const UInt32 theCopy = mPublishedCopy.load();
+    
+    // Return the first client for this PID
+    Slot* theSlot = mClientsByPID[theCopy].Find(inAppPID);
+    return (theSlot == nullptr) ? nullptr : &theSlot->mClient[theCopy];
 }
 
-void    BGM_ClientMap::SwapInShadowMapsRT()
+#pragma mark Mix-Minus
+
+bool    BGM_ClientMap::SetClientsMixMinus(pid_t inAppPID, bool inMixMinus)
 {
-#if DEBUG
-    // This method should only be called by the realtime worker thread in BGM_TaskQueue. The only safe way to call it is on a realtime
-    // thread while a non-realtime thread is holding the shadow maps mutex. (These assertions assume that the realtime worker thread is
-    // the only thread we'll call this on, but we could decide to change that at some point.)
-    mTaskQueue->AssertCurrentThreadIsRTWorkerThread("BGM_ClientMap::SwapInShadowMapsRT");
+    bool didChangeMixMinus = false;
     
-    Assert(!mShadowMapsMutex.IsFree(), "Can't swap in the shadow maps while the shadow maps mutex is free");
-    Assert(!mShadowMapsMutex.IsOwnedByCurrentThread(), "The shadow maps mutex should not be held by a realtime thread");
-#endif
+    CAMutex::Locker theLocker(mMutex);
     
-    CAMutex::Locker theMapsLocker(mMapsMutex);
+    auto theSetMixMinusInShadowMapsFunc = [&] {
+        ForEachShadowClient(inAppPID, [&] (Slot& theSlot, BGM_Client& theClient) {
+            if(inMixMinus && theClient.mMixMinusBuffer == nullptr) {
+                theClient.mMixMinusBuffer = GetOrCreateMixMinusBuffer(theSlot);
+            }
+            didChangeMixMinus = didChangeMixMinus || (theClient.mMixMinus != inMixMinus);
+            theClient.mMixMinus = inMixMinus;
+        });
+    };
+    
+    theSetMixMinusInShadowMapsFunc();
+    PublishShadowCopies();
+    theSetMixMinusInShadowMapsFunc();
     
-    mClientMap.swap(mClientMapShadow);
-    mClientMapByPID.swap(mClientMapByPIDShadow);
-    mClientMapByBundleID.swap(mClientMapByBundleIDShadow);
+    return didChangeMixMinus;
 }
 
-#pragma mark Routing
-
-void    BGM_ClientMap::AllocateRoutingBufferForPID(pid_t inAppPID)
+bool    BGM_ClientMap::SetClientsMixMinus(CACFString inAppBundleID, bool inMixMinus)
 {
-    CAMutex::Locker theShadowMapsLocker(mShadowMapsMutex);
+    bool didChangeMixMinus = false;
     
-    auto theAllocateInShadowMapsFunc = [&] {
-        auto theClients = GetClients(inAppPID);
-        if(theClients != nullptr) {
-            for(auto theClient: *theClients) {
-                theClient->AllocateRoutingBuffer();
+    CAMutex::Locker theLocker(mMutex);
+    
+    auto theSetMixMinusInShadowMapsFunc = [&] {
+        ForEachShadowClient(inAppBundleID, [&] (Slot& theSlot, BGM_Client& theClient) {
+            if(inMixMinus && theClient.mMixMinusBuffer == nullptr) {
+                theClient.mMixMinusBuffer = GetOrCreateMixMinusBuffer(theSlot);
             }
-        }
+            didChangeMixMinus = didChangeMixMinus || (theClient.mMixMinus != inMixMinus);
+            theClient.mMixMinus = inMixMinus;
+        });
     };
     
-    theAllocateInShadowMapsFunc();
-    SwapInShadowMaps();
-    theAllocateInShadowMapsFunc();
+    theSetMixMinusInShadowMapsFunc();
+    PublishShadowCopies();
+    theSetMixMinusInShadowMapsFunc();
+    
+    return didChangeMixMinus;
 }
 
-void    BGM_ClientMap::DeallocateRoutingBufferForPID(pid_t inAppPID)
+BGM_SampleTimeRingBuffer*   BGM_ClientMap::GetOrCreateMixMinusBuffer(Slot& inSlot)
 {
-    CAMutex::Locker theShadowMapsLocker(mShadowMapsMutex);
+    // We keep the buffer if the client turns mix-minus off, since it's likely to be turned on again,
+    // so this only allocates the first time.
+    if(!inSlot.mMixMinusBuffer)
+    {
+        inSlot.mMixMinusBuffer.reset(new BGM_SampleTimeRingBuffer(kMixMinusBufferFrameSize));
+    }
     
-    auto theDeallocateInShadowMapsFunc = [&] {
-        auto theClients = GetClients(inAppPID);
-        if(theClients != nullptr) {
-            for(auto theClient: *theClients) {
-                theClient->DeallocateRoutingBuffer();
-            }
+    return inSlot.mMixMinusBuffer.get();
+}
+
+void    BGM_ClientMap::StoreMixMinusContributionRT(UInt32 inClientID,
+                                                   const Float32* inBuffer,
+                                                   UInt32 inFrameCount,
+                                                   Float64 inOutputSampleTime) const
+{
+    BGM_Client* theClient = FindPublishedClientRT(inClientID);
+    if(theClient != nullptr && theClient->mMixMinus && theClient->mMixMinusBuffer != nullptr)
+    {
+        theClient->mMixMinusBuffer->StoreRT(inBuffer, inFrameCount, inOutputSampleTime);
+    }
+}
+
+void    BGM_ClientMap::SubtractMixMinusContributionRT(UInt32 inClientID,
+                                                      Float32* ioBuffer,
+                                                      UInt32 inFrameCount,
+                                                      Float64 inInputSampleTime) const
+{
+    const UInt32 theCopy = mPublishedCopy.load();
+    Slot* theReaderSlot = mClientsByID[theCopy].Find(inClientID);
+    
+    if(theReaderSlot == nullptr || !theReaderSlot->mClient[theCopy].mMixMinus)
+    {
+        return;
+    }
+    
+    const BGM_Client& theReader = theReaderSlot->mClient[theCopy];
+    
+    auto theSubtractFunc = [&] (const BGM_Client& inClient) {
+        if(inClient.mMixMinus && inClient.mMixMinusBuffer != nullptr)
+        {
+            inClient.mMixMinusBuffer->SubtractFromRT(ioBuffer, inFrameCount, inInputSampleTime);
         }
     };
     
-    theDeallocateInShadowMapsFunc();
-    SwapInShadowMaps();
-    theDeallocateInShadowMapsFunc();
+    // Apps often read input through a different client than the one they play through, so remove
+    // the output of every client of the reader's app, not just the reader's own. Walk the lists
+    // from the reader's slot, which is in both, so this doesn't have to look the app up.
+    Slot* theSlot = theReaderSlot;
+    
+    do
+    {
+        theSubtractFunc(theSlot->mClient[theCopy]);
+        theSlot = theSlot->mSamePID[theCopy].mNext;
+    }
+    while(theSlot != nullptr && theSlot != theReaderSlot);
+    
+    // Clients with the reader's bundle ID, skipping the ones with its PID since they've already
+    // been subtracted. Clients without bundle IDs aren't in a list.
+    theSlot = theReaderSlot->mSameBundleID[theCopy].mNext;
+    
+    while(theSlot != nullptr && theSlot != theReaderSlot)
+    {
+        if(theSlot->mClient[theCopy].mProcessID != theReader.mProcessID)
+        {
+            theSubtractFunc(theSlot->mClient[theCopy]);
+        }
+        
+        theSlot = theSlot->mSameBundleID[theCopy].mNext;
+    }
 }
 
-BGM_Client* _Nullable BGM_ClientMap::GetClientByPIDRT(pid_t inAppPID) const
+#pragma mark Capture Filters
+
+bool    BGM_ClientMap::HasClientWithBundleID(CACFString inAppBundleID) const
+{
+    CAMutex::Locker theLocker(mMutex);
+    return inAppBundleID.IsValid() && mClientsByBundleID[GetShadowCopy()].Find(inAppBundleID) != nullptr;
+}
+
+void    BGM_ClientMap::UpdateClients(std::function<void(BGM_Client&)> inUpdateClient)
 {
-    CAMutex::Locker theMapsLocker(mMapsMutex);
+    CAMutex::Locker theLocker(mMutex);
+    
+    auto theUpdateShadowCopiesFunc = [&] {
+        const UInt32 theCopy = GetShadowCopy();
+        
+        mClientsByID[theCopy].ForEach([&] (Slot* inSlot) {
+            inUpdateClient(inSlot->mClient[theCopy]);
+        });
+    };
     
-    auto theClientItr = const_cast<std::map<pid_t, BGM_ClientPtrList>&>(mClientMapByPID).find(inAppPID);
-    if(theClientItr != mClientMapByPID.end() && !theClientItr->second.empty())
+    theUpdateShadowCopiesFunc();
+    PublishShadowCopies();
+    theUpdateShadowCopiesFunc();
+}
+
+void    BGM_ClientMap::AccumulateCaptureSubmixesRT(UInt32 inClientID,
+                                                   const Float32* inBuffer,
+                                                   UInt32 inFrameCount,
+                                                   Float64 inOutputSampleTime) const
+{
+    BGM_Client* theClient = FindPublishedClientRT(inClientID);
+    if(theClient != nullptr)
     {
-        // Return the first client for this PID
-        return theClientItr->second.front();
+        for(BGM_SampleTimeRingBuffer* theSubmix : theClient->mCaptureSubmixContributions)
+        {
+            theSubmix->AccumulateRT(inBuffer, inFrameCount, inOutputSampleTime);
+        }
     }
-    return nullptr;
+}
+
+bool    BGM_ClientMap::FetchCaptureSubmixRT(UInt32 inClientID,
+                                            Float32* outBuffer,
+                                            UInt32 inFrameCount,
+                                            Float64 inInputSampleTime) const
+{
+    BGM_Client* theClient = FindPublishedClientRT(inClientID);
+    if(theClient != nullptr && theClient->mCaptureSubmix != nullptr)
+    {
+        theClient->mCaptureSubmix->FetchRT(outBuffer, inFrameCount, inInputSampleTime);
+        return true;
+    }
+    
+    return false;
 }
 
 #pragma clang assume_nonnull end
@@ -25,7 +25,7 @@
 
 // Local Includes
 #include "BGM_Client.h"
-#include "BGM_TaskQueue.h"
+#include "BGM_ClientIndex.h"
 
 // PublicUtility Includes
 #include "CAMutex.h"
@@ -34,13 +34,19 @@
 #include "CAVolumeCurve.h"
 
 // STL Includes
+#include <atomic>
+#include <deque>
 #include <map>
 #include <vector>
 #include <functional>
+#include <memory>
 
 
-// Forward Declarations
-class BGM_ClientTasks;
+// Hashes CACFStrings so they can be used as keys in unordered maps/sets. The strings must be valid.
+struct BGM_CACFStringHash
+{
+    size_t operator()(const CACFString& inString) const { return CFHash(inString.GetCFString()); }
+};
 
 
 #pragma clang assume_nonnull begin
@@ -49,21 +55,32 @@ class BGM_ClientTasks;
 //	BGM_ClientMap
 //
 //  This class stores the clients (BGM_Client) that have been registered with BGMDevice by the HAL.
-//  It also maintains maps from clients' PIDs and bundle IDs to the clients. When a client is
-//  removed by the HAL we add it to a map of past clients to keep track of settings specific to that
-//  client. (Currently only the client's volume.)
+//  It also indexes the clients by their PIDs and bundle IDs. When a client is removed by the HAL we
+//  add it to a map of past clients to keep track of settings specific to that client. (Currently
+//  only the client's volume.)
+//
+//  Each client is kept in a slot, which holds two copies of it. The IO threads read one copy of
+//  every client, the published copies, and the other copies, the shadow copies, are only used by
+//  non-real-time threads. There's a set of hash indexes (by client ID, PID and bundle ID) for each
+//  copy as well, which only refer to the slots.
+//
+//  To update the clients we lock mMutex, change the shadow copies and their indexes, publish them
+//  by switching which copy the IO threads read (a single atomic store), wait for any IO threads
+//  still reading the old copies to finish and then repeat the change on the old copies, so both
+//  copies are identical again. That way the IO threads never lock anything or see a change half
+//  made, and a change only costs as much as updating the clients it changes and their index
+//  entries, however many clients there are. The actual work doesn't need to be real-time safe.
 //
-//  Since the maps are read from during IO, this class has to be real-time safe when accessing
-//  them. So each map has an identical "shadow" map, which we use to buffer updates.
+//  The IO threads have to hold a ReaderRT while they read the clients, which is how we know when
+//  they've finished with the old copies. Pointers to clients (e.g. from GetClientPtrRT) are only
+//  valid until it's released.
 //
-//  To update the clients we lock the shadow maps, modify them, have BGM_TaskQueue's real-time
-//  thread swap them with the main maps, and then repeat the modification to keep both sets of maps
-//  identical. We have to swap the maps on a real-time thread so we can take the main maps' lock
-//  without risking priority inversion, but this way the actual work doesn't need to be real-time
-//  safe.
+//  Slots are reused when clients are removed and aren't freed until the BGM_ClientMap is destroyed,
+//  so adding a client only allocates if there are more clients than there have been before. (And
+//  for the copy of the client's vectors.)
 //
-//  Methods that only read from the maps and are called on non-real-time threads will just read
-//  from the shadow maps because it's easier.
+//  Methods that only read from the clients and are called on non-real-time threads will just read
+//  the shadow copies because it's easier.
 //
 //  Methods whose names end with "RT" and "NonRT" can only safely be called from real-time and
 //  non-real-time threads respectively. (Methods with neither are most likely non-RT.)
@@ -72,54 +89,68 @@ class BGM_ClientTasks;
 class BGM_ClientMap
 {
     
-    friend class BGM_ClientTasks;
-    
-    typedef std::vector<BGM_Client*> BGM_ClientPtrList;
-    
 public:
-                                                        BGM_ClientMap(BGM_TaskQueue* inTaskQueue) : mTaskQueue(inTaskQueue), mMapsMutex("Maps mutex"), mShadowMapsMutex("Shadow maps mutex") { };
-
-    void                                                AddClient(BGM_Client inClient);
+                                                        BGM_ClientMap();
+                                                        ~BGM_ClientMap() = default;
+                                                        BGM_ClientMap(const BGM_ClientMap&) = delete;
+                                                        BGM_ClientMap& operator=(const BGM_ClientMap&) = delete;
+    
+    // Real-time threads have to hold one of these while they read the clients and use the pointers
+    // to clients returned by this class. Changes to the clients wait for the threads holding one
+    // that could still be reading the old copies to release it. They can be nested. Wait-free.
+    class ReaderRT
+    {
+    public:
+                                                        ReaderRT(const BGM_ClientMap& inClientMap);
+                                                        ~ReaderRT();
+                                                        ReaderRT(const ReaderRT&) = delete;
+                                                        ReaderRT& operator=(const ReaderRT&) = delete;
+        
+    private:
+        const BGM_ClientMap&                            mClientMap;
+        UInt32                                          mReadIndicator;
+    };
     
-private:
-    void                                                AddClientToShadowMaps(BGM_Client inClient);
+    void                                                AddClient(BGM_Client inClient);
     
-public:
     // Returns the removed client
     BGM_Client                                          RemoveClient(UInt32 inClientID);
     
     // These methods are functionally identical except that GetClientRT must only be called from real-time threads and GetClientNonRT
-    // must only be called from non-real-time threads. Both return true if a client was found.
+    // must only be called from non-real-time threads. Both return true if a client was found. GetClientRT allocates if the
+    // client has routes or capture submixes, so the IO threads should use GetClientPtrRT instead.
     bool                                                GetClientRT(UInt32 inClientID, BGM_Client* outClient) const;
     bool                                                GetClientNonRT(UInt32 inClientID, BGM_Client* outClient) const;
     
-    // Returns a pointer to the actual client object for EQ processing (needs mutable access for filter state)
-    // Only call from RT threads. Returns nullptr if not found.
+    // Returns a pointer to the actual client object, so the IO thread can read it without copying it.
+    // Only call from RT threads, while holding a ReaderRT. Returns nullptr if not found.
     BGM_Client* _Nullable                               GetClientPtrRT(UInt32 inClientID) const;
     
-private:
-    static bool                                         GetClient(const std::map<UInt32, BGM_Client>& inClientMap,
-                                                                  UInt32 inClientID,
-                                                                  BGM_Client* outClient);
-    
-public:
     std::vector<BGM_Client>                             GetClientsByPID(pid_t inPID) const;
     
+    // The IDs of the current clients with the given PID/bundle ID. These are hash lookups, so they
+    // stay cheap with many clients.
+    std::vector<UInt32>                                 GetClientIDsNonRT(pid_t inPID) const;
+    std::vector<UInt32>                                 GetClientIDsNonRT(CACFString inBundleID) const;
+    
+    // The number of current clients.
+    UInt32                                              GetClientCountNonRT() const;
+    
     // Set the isMusicPlayer flag for each client. (True if the client has the given bundle ID/PID, false otherwise.)
     void                                                UpdateMusicPlayerFlags(pid_t inMusicPlayerPID);
     void                                                UpdateMusicPlayerFlags(CACFString inMusicPlayerBundleID);
     
 private:
-    void                                                UpdateMusicPlayerFlagsInShadowMaps(std::function<bool(BGM_Client)> inIsMusicPlayerTest);
+    void                                                UpdateMusicPlayerFlagsInShadowCopies(std::function<bool(const BGM_Client&)> inIsMusicPlayerTest);
     
 public:
     // Copies the current and past clients into an array in the format expected for
     // kAudioDeviceCustomPropertyAppVolumes. (Except that CACFArray and CACFDictionary are used instead
     // of unwrapped CFArray and CFDictionary refs.)
-    CACFArray                                           CopyClientRelativeVolumesAsAppVolumes(CAVolumeCurve inVolumeCurve) const;
+    CACFArray                                           CopyClientRelativeVolumesAsAppVolumes(const CAVolumeCurve& inVolumeCurve) const;
     
 private:
-    void                                                CopyClientIntoAppVolumesArray(BGM_Client inClient, CAVolumeCurve inVolumeCurve, CACFArray& ioAppVolumes) const;
+    void                                                CopyClientIntoAppVolumesArray(const BGM_Client& inClient, const CAVolumeCurve& inVolumeCurve, CACFArray& ioAppVolumes) const;
     
 public:
     // Using the template function hits LLVM Bug 23987
@@ -147,56 +178,173 @@ public:
     bool                                                SetClientsEQ(pid_t inAppPID, Float32 inLowGain, Float32 inMidGain, Float32 inHighGain, Float64 inSampleRate);
     bool                                                SetClientsEQ(CACFString inAppBundleID, Float32 inLowGain, Float32 inMidGain, Float32 inHighGain, Float64 inSampleRate);
     
-    // Routing buffer management
-    void                                                AllocateRoutingBufferForPID(pid_t inAppPID);
-    void                                                DeallocateRoutingBufferForPID(pid_t inAppPID);
-    
-    // Get client by PID for routing (RT-safe)
+    // Get client by PID for routing (RT-safe). Only call while holding a ReaderRT.
     BGM_Client* _Nullable                               GetClientByPIDRT(pid_t inAppPID) const;
     
+    // Set the mix-minus flag for the clients with the given PID/bundle ID. Allocates their
+    // mix-minus buffers if they don't already have them. Returns true if a client was found and its
+    // flag changed.
+    bool                                                SetClientsMixMinus(pid_t inAppPID, bool inMixMinus);
+    bool                                                SetClientsMixMinus(CACFString inAppBundleID, bool inMixMinus);
+    
+public:
+    // If the client is a mix-minus client, store its (processed) output for the IO cycle so it can
+    // be subtracted from the loopback audio the client reads later. Real-time safe.
+    void                                                StoreMixMinusContributionRT(UInt32 inClientID,
+                                                                                    const Float32* inBuffer,
+                                                                                    UInt32 inFrameCount,
+                                                                                    Float64 inOutputSampleTime) const;
+    // If the client is a mix-minus client, subtract the output of its app, i.e. every mix-minus
+    // client with its PID or bundle ID, for the given sample times from ioBuffer, which should hold
+    // the loopback audio for those sample times. Real-time safe.
+    void                                                SubtractMixMinusContributionRT(UInt32 inClientID,
+                                                                                       Float32* ioBuffer,
+                                                                                       UInt32 inFrameCount,
+                                                                                       Float64 inInputSampleTime) const;
+    
+    // Returns true if any current client has the given bundle ID.
+    bool                                                HasClientWithBundleID(CACFString inAppBundleID) const;
+    
+    // Calls inUpdateClient for each current client, in both copies, e.g. to set the client's
+    // capture submixes or routing kernels. inUpdateClient must make the same changes both times it's
+    // called for a client.
+    void                                                UpdateClients(std::function<void(BGM_Client&)> inUpdateClient);
+    
+    // Mix the client's (processed) output for the IO cycle into each of the filtered capture
+    // submixes that include it. Real-time safe.
+    void                                                AccumulateCaptureSubmixesRT(UInt32 inClientID,
+                                                                                    const Float32* inBuffer,
+                                                                                    UInt32 inFrameCount,
+                                                                                    Float64 inOutputSampleTime) const;
+    // If the client reads a filtered capture submix, copy the submix for the given sample times into
+    // outBuffer and return true. Otherwise, return false and leave outBuffer unchanged. Real-time
+    // safe.
+    bool                                                FetchCaptureSubmixRT(UInt32 inClientID,
+                                                                             Float32* outBuffer,
+                                                                             UInt32 inFrameCount,
+                                                                             Float64 inInputSampleTime) const;
+    
     void                                                StartIONonRT(UInt32 inClientID) { UpdateClientIOStateNonRT(inClientID, true); }
     void                                                StopIONonRT(UInt32 inClientID) { UpdateClientIOStateNonRT(inClientID, false); }
     
 private:
     void                                                UpdateClientIOStateNonRT(UInt32 inClientID, bool inDoingIO);
     
-    // Has a real-time thread call SwapInShadowMapsRT. (Synchronously queues the call as a task on mTaskQueue.)
-    // The shadow maps mutex must be locked when calling this method.
-    void                                                SwapInShadowMaps();
-    // Note that this method is called by BGM_TaskQueue through the BGM_ClientTasks interface. The shadow maps
-    // mutex must be locked when calling this method.
-    void                                                SwapInShadowMapsRT();
-    
-    // Client lookup for PID inAppPID
-    std::vector<BGM_Client*> * _Nullable                GetClients(pid_t inAppPid);
-    // Client lookup for bundle ID inAppBundleID
-    std::vector<BGM_Client*> * _Nullable                GetClients(CACFString inAppBundleID);
-    
 private:
-    BGM_TaskQueue*                                      mTaskQueue;
-    
-    // Must be held to access mClientMap or mClientMapByPID. Code that runs while holding this mutex needs
-    // to be real-time safe. Should probably not be held for most operations on mClientMapByBundleID because,
-    // as far as I can tell, code that works with CFStrings is unlikely to be real-time safe.
-    CAMutex                                             mMapsMutex;
-    // Should only be locked by non-real-time threads. Should not be released until the maps have been
-    // made identical to their shadow maps.
-    CAMutex                                             mShadowMapsMutex;
-    
-    // The clients currently registered with BGMDevice. Indexed by client ID.
-    std::map<UInt32, BGM_Client>                        mClientMap;
-    // We keep this in sync with mClientMap so it can be modified outside of real-time safe sections and
-    // then swapped in on a real-time thread, which is safe.
-    std::map<UInt32, BGM_Client>                        mClientMapShadow;
-    
-    // These maps hold lists of pointers to clients in mClientMap/mClientMapShadow. Lists because a process
-    // can have multiple clients and clients can have the same bundle ID.
+    // A client's place in the map. The copies of the client are indexed by copy, i.e. 0 or 1, as are
+    // the links of the lists of the clients with the same PID and the same bundle ID.
+    struct Slot
+    {
+        struct Links
+        {
+            Slot* _Nullable                             mPrevious = nullptr;
+            Slot* _Nullable                             mNext = nullptr;
+        };
+        
+        BGM_Client                                      mClient[2];
+        Links                                           mSamePID[2];
+        Links                                           mSameBundleID[2];
+        
+        // The client's mix-minus buffer, if it's ever been a mix-minus client. The copies of the
+        // client only hold a pointer to it. Freed when the client is removed.
+        std::unique_ptr<BGM_SampleTimeRingBuffer>       mMixMinusBuffer;
+    };
+    
+    struct ClientIDTraits
+    {
+        typedef UInt32 Key;
+        static const UInt32& GetKey(const Slot& inSlot, UInt32 inCopy) { return inSlot.mClient[inCopy].mClientID; }
+        static size_t Hash(UInt32 inClientID) { return HashInteger(inClientID); }
+    };
+    
+    // The PID and bundle ID indexes map to the first of a circular list of the clients with the PID
+    // or bundle ID, in the order they were added.
+    struct ProcessIDTraits
+    {
+        typedef pid_t Key;
+        static const pid_t& GetKey(const Slot& inSlot, UInt32 inCopy) { return inSlot.mClient[inCopy].mProcessID; }
+        static size_t Hash(pid_t inPID) { return HashInteger(static_cast<UInt32>(inPID)); }
+    };
+    
+    struct BundleIDTraits
+    {
+        typedef CACFString Key;
+        static const CACFString& GetKey(const Slot& inSlot, UInt32 inCopy) { return inSlot.mClient[inCopy].mBundleID; }
+        static size_t Hash(const CACFString& inBundleID) { return BGM_CACFStringHash()(inBundleID); }
+    };
+    
+    // A member of Slot that links it into a list of slots, e.g. &Slot::mSamePID.
+    typedef Slot::Links (Slot::*                        ListMember)[2];
+    
+    typedef BGM_ClientIndex<Slot, ClientIDTraits>       ClientIDIndex;
+    typedef BGM_ClientIndex<Slot, ProcessIDTraits>      ProcessIDIndex;
+    typedef BGM_ClientIndex<Slot, BundleIDTraits>       BundleIDIndex;
+    
+    // A finalizer from MurmurHash3, since client IDs and PIDs are mostly sequential.
+    static size_t                                       HashInteger(UInt32 inValue);
+    
+    UInt32                                              GetShadowCopy() const { return mPublishedCopy.load(std::memory_order_relaxed) ^ 1; }
+    
+    // Adds the client to the shadow copies in the given slot, which must be free in them.
+    void                                                AddClientToShadowCopies(const BGM_Client& inClient, Slot* inSlot);
+    void                                                RemoveClientFromShadowCopies(Slot* inSlot);
+    
+    // Add/remove the slot to/from the list of slots with the same key in an index of the shadow
+    // copies.
+    template <typename Index>
+    void                                                AddToList(Index& ioIndex,
+                                                                  const typename Index::Key& inKey,
+                                                                  ListMember inList,
+                                                                  Slot* inSlot);
+    template <typename Index>
+    void                                                RemoveFromList(Index& ioIndex,
+                                                                       const typename Index::Key& inKey,
+                                                                       ListMember inList,
+                                                                       Slot* inSlot);
+    
+    // Call inFunction for each of the shadow copies of the clients with the PID/bundle ID.
+    void                                                ForEachShadowClient(pid_t inAppPID,
+                                                                            std::function<void(Slot&, BGM_Client&)> inFunction) const;
+    void                                                ForEachShadowClient(CACFString inAppBundleID,
+                                                                            std::function<void(Slot&, BGM_Client&)> inFunction) const;
+    
+    // Returns the client's mix-minus buffer, allocating it first if necessary. mMutex must be locked
+    // when calling this method.
+    BGM_SampleTimeRingBuffer*                           GetOrCreateMixMinusBuffer(Slot& inSlot);
+    
+    // Have the IO threads read the shadow copies, wait until none of them can still be reading the
+    // old copies and then make those the shadow copies. mMutex must be locked when calling this
+    // method.
+    void                                                PublishShadowCopies();
+    
+    // Returns the published copy of the client, or nullptr. Only call while holding a ReaderRT.
+    BGM_Client* _Nullable                               FindPublishedClientRT(UInt32 inClientID) const;
     
-    std::map<pid_t, BGM_ClientPtrList>                  mClientMapByPID;
-    std::map<pid_t, BGM_ClientPtrList>                  mClientMapByPIDShadow;
-    
-    std::map<CACFString, BGM_ClientPtrList>             mClientMapByBundleID;
-    std::map<CACFString, BGM_ClientPtrList>             mClientMapByBundleIDShadow;
+private:
+    // Must be held to change the clients or to read the shadow copies. Should only be locked by
+    // non-real-time threads. Should not be released until the copies have been made identical
+    // again.
+    CAMutex                                             mMutex;
+    
+    // The copy of the clients (0 or 1) the IO threads read.
+    std::atomic<UInt32>                                 mPublishedCopy;
+    
+    // The number of IO threads holding a ReaderRT, counted in two halves so PublishShadowCopies can
+    // wait for the ones that could be reading the old copies without stopping new ones from
+    // starting. New readers increment the count mReadIndicator selects. (These are the read
+    // indicators of the left-right algorithm.)
+    mutable std::atomic<UInt32>                         mReadIndicator;
+    mutable std::atomic<UInt32>                         mReaders[2];
+    
+    // The indexes of each copy of the clients. Only clients with bundle IDs are in the bundle ID
+    // indexes.
+    ClientIDIndex                                       mClientsByID[2];
+    ProcessIDIndex                                      mClientsByPID[2];
+    BundleIDIndex                                       mClientsByBundleID[2];
+    
+    // The slots. A deque so they never move.
+    std::deque<Slot>                                    mSlots;
+    std::vector<Slot*>                                  mFreeSlots;
     
     // Clients are added to mPastClientMap so we can restore settings specific to them if they get
     // added again.
@@ -207,4 +355,3 @@ private:
 #pragma clang assume_nonnull end
 
 #endif /* __BGMDriver__BGM_ClientMap__ */
-
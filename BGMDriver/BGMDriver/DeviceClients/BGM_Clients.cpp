@@ -31,15 +31,32 @@
 // PublicUtility Includes
 #include "CAException.h"
 #include "CACFDictionary.h"
+#if defined(__APPLE__)
 #include "CADispatchQueue.h"
+#endif
+#include "CAHostTimeBase.h"
+
+// STL Includes
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+// System Includes
+#if defined(__APPLE__)
+#include <Accelerate/Accelerate.h>
+#endif
 
 
 #pragma mark Construction/Destruction
 
-BGM_Clients::BGM_Clients(AudioObjectID inOwnerDeviceID, BGM_TaskQueue* inTaskQueue)
+BGM_Clients::BGM_Clients(AudioObjectID inOwnerDeviceID,
+                         const char* _Nullable inParameterTableName)
 :
     mOwnerDeviceID(inOwnerDeviceID),
-    mClientMap(inTaskQueue)
+    mClientMap(),
+    mParameterTable(inParameterTableName),
+    mHostTicksPerFrame(CAHostTimeBase::GetFrequency() / mSampleRate)
 {
     mRelativeVolumeCurve.AddRange(kAppRelativeVolumeMinRawValue,
                                   kAppRelativeVolumeMaxRawValue,
@@ -53,22 +70,90 @@ void    BGM_Clients::AddClient(BGM_Client inClient)
 {
     CAMutex::Locker theLocker(mMutex);
 
+    // The client might be BGMApp, which creates the shared parameter table when it starts
+    mParameterTable.OpenSharedIfNeeded();
+
     // Check whether this is the music player's client
-    bool pidMatchesMusicPlayerProperty =
-        (mMusicPlayerProcessIDProperty != 0 && inClient.mProcessID == mMusicPlayerProcessIDProperty);
-    bool bundleIDMatchesMusicPlayerProperty =
-        (mMusicPlayerBundleIDProperty != "" &&
-         inClient.mBundleID.IsValid() &&
-         inClient.mBundleID == mMusicPlayerBundleIDProperty);
-    
-    inClient.mIsMusicPlayer = (pidMatchesMusicPlayerProperty || bundleIDMatchesMusicPlayerProperty);
+    inClient.mIsMusicPlayer = IsMusicPlayerClient(inClient);
     
     if(inClient.mIsMusicPlayer)
     {
         DebugMsg("BGM_Clients::AddClient: Adding music player client. mClientID = %u", inClient.mClientID);
     }
     
-    mClientMap.AddClient(inClient);
+    // Check whether the client's app has been set to get mix-minus loopback
+    inClient.mMixMinus =
+        (mMixMinusProcessIDs.count(inClient.mProcessID) != 0) ||
+        (inClient.mBundleID.IsValid() && mMixMinusBundleIDs.count(inClient.mBundleID) != 0);
+    
+    // Check whether the client's app has been given a priority
+    inClient.mPriority = GetAppPriority(inClient);
+    
+    // Check whether the client's app triggers ducking or is ducked
+    inClient.mDuckingRole = mDucker.GetSettings().GetRole(inClient.mBundleID);
+    
+    // Give the new client an automation queue if gain changes have been scheduled for its app. The
+    // events that have already started are scheduled too, so it ramps from where the app's other
+    // clients are.
+    const std::vector<BGM_AppAutomationEvent>* theSchedule = GetAppAutomationSchedule(inClient);
+    
+    if(theSchedule != nullptr)
+    {
+        std::unique_ptr<BGM_ParameterAutomation> theAutomation(new BGM_ParameterAutomation(1.0f));
+        
+        for(const BGM_AppAutomationEvent& theEvent : *theSchedule)
+        {
+            theAutomation->ScheduleEvent(ConvertAppAutomationEvent(theEvent));
+        }
+        
+        inClient.mAutomation = theAutomation.get();
+        mAutomations[inClient.mClientID] = std::move(theAutomation);
+    }
+    
+    // Give the new client a signal classifier
+    std::unique_ptr<BGM_SignalClassifier> theClassifier(new BGM_SignalClassifier(mSampleRate));
+    inClient.mSignalClassifier = theClassifier.get();
+    mSignalClassifiers[inClient.mClientID] = std::move(theClassifier);
+    
+    // And a loudness meter
+    std::unique_ptr<BGM_LoudnessMeter> theLoudnessMeter(new BGM_LoudnessMeter(mSampleRate));
+    theLoudnessMeter->SetNormalization(mLoudnessNormalization);
+    inClient.mLoudnessMeter = theLoudnessMeter.get();
+    mLoudnessMeters[inClient.mClientID] = std::move(theLoudnessMeter);
+    
+    // And a slot in the DSP state pool. The slot isn't keyed by the client ID, so free it if the
+    // client can't be added.
+    inClient.mDSPStateSlot = mDSPStates.AllocateSlot();
+    
+    try
+    {
+        mClientMap.AddClient(inClient);
+    }
+    catch(...)
+    {
+        mDSPStates.FreeSlot(inClient.mDSPStateSlot);
+        throw;
+    }
+    
+    // If the new client is an endpoint of an existing route, e.g. a new helper process of a routed
+    // app, attach it to the route
+    if(IsRouteEndpoint(inClient))
+    {
+        CompileRoutingKernels();
+    }
+    
+    // The new client might be a reader with a capture filter or a source for an existing filtered
+    // submix
+    if(!mCaptureFilters.empty())
+    {
+        UpdateCaptureSubmixes();
+    }
+    
+    // Give the new client a crossfade ramp if its app is in one of the crossfader's groups
+    if(mCrossfader.GetSide(inClient.mBundleID) != BGM_Crossfader::kSideNone)
+    {
+        UpdateCrossfadeRamps();
+    }
     
     // If we're adding BGMApp, update our local copy of its client ID
     if(inClient.mBundleID.IsValid() && inClient.mBundleID == kBGMAppBundleID)
@@ -83,6 +168,51 @@ void    BGM_Clients::RemoveClient(const UInt32 inClientID)
     
     BGM_Client theRemovedClient = mClientMap.RemoveClient(inClientID);
     
+    // Remove the client's kernels from its destinations if it was a routing source
+    if(IsRouteEndpoint(theRemovedClient))
+    {
+        CompileRoutingKernels();
+    }
+    
+    // Free the client's filtered submix if no other reader needs it
+    if(theRemovedClient.mCaptureSubmix != nullptr)
+    {
+        UpdateCaptureSubmixes();
+    }
+    
+    // Free the client's crossfade ramp
+    if(theRemovedClient.mCrossfadeRamp != nullptr)
+    {
+        UpdateCrossfadeRamps();
+    }
+    
+    // Unset the app's values in the shared parameter table if this was its last client, so they
+    // can't be used for a new process that gets the same PID.
+    if(mClientMap.GetClientIDsNonRT(theRemovedClient.mProcessID).empty())
+    {
+        mParameterTable.ClearValues(theRemovedClient.mProcessID);
+    }
+    
+    // Free the client's automation queue. The client has already been removed from the client maps,
+    // so nothing refers to it.
+    if(theRemovedClient.mAutomation != nullptr)
+    {
+        mAutomations.erase(theRemovedClient.mClientID);
+    }
+    
+    // Free its scene morph for the same reason
+    if(theRemovedClient.mSceneMorph != nullptr)
+    {
+        mSceneMorphs.erase(theRemovedClient.mClientID);
+    }
+    
+    // And its signal classifier and loudness meter
+    mSignalClassifiers.erase(theRemovedClient.mClientID);
+    mLoudnessMeters.erase(theRemovedClient.mClientID);
+    
+    // And return its DSP state slot to the pool
+    mDSPStates.FreeSlot(theRemovedClient.mDSPStateSlot);
+    
     // If we're removing BGMApp, clear our local copy of its client ID
     if(theRemovedClient.mClientID == mBGMAppClientID)
     {
@@ -213,7 +343,7 @@ void    BGM_Clients::SendIORunningNotifications(bool sendIsRunningNotification,
 {
     if(sendIsRunningNotification || sendIsRunningSomewhereOtherThanBGMAppNotification)
     {
-        CADispatchQueue::GetGlobalSerialQueue().Dispatch(false, ^{
+        auto theSendNotifications = [=] {
             AudioObjectPropertyAddress theChangedProperties[2];
             UInt32 theNotificationCount = 0;
 
@@ -232,7 +362,15 @@ void    BGM_Clients::SendIORunningNotifications(bool sendIsRunningNotification,
             }
 
             BGM_PlugIn::Host_PropertiesChanged(mOwnerDeviceID, theNotificationCount, theChangedProperties);
-        });
+        };
+
+#if defined(__APPLE__)
+        CADispatchQueue::GetGlobalSerialQueue().Dispatch(false, ^{ theSendNotifications(); });
+#else
+        // Without libdispatch, the portable build's host just sends them from this thread. It
+        // doesn't call into the driver from PropertiesChanged, so that can't deadlock.
+        theSendNotifications();
+#endif
     }
 }
 
@@ -289,25 +427,107 @@ bool    BGM_Clients::SetMusicPlayer(const CACFString inBundleID)
 
 bool    BGM_Clients::IsMusicPlayerRT(const UInt32 inClientID) const
 {
-    BGM_Client theClient;
-    bool didGetClient = mClientMap.GetClientRT(inClientID, &theClient);
-    return didGetClient && theClient.mIsMusicPlayer;
+    // Copying the client with GetClientRT would allocate, since BGM_Client has vectors.
+    BGM_Client* theClient = mClientMap.GetClientPtrRT(inClientID);
+    return theClient != nullptr && theClient->mIsMusicPlayer;
+}
+
+bool    BGM_Clients::IsMusicPlayerClient(const BGM_Client& inClient) const
+{
+    bool pidMatchesMusicPlayerProperty =
+        (mMusicPlayerProcessIDProperty != 0 && inClient.mProcessID == mMusicPlayerProcessIDProperty);
+    bool bundleIDMatchesMusicPlayerProperty =
+        (mMusicPlayerBundleIDProperty != "" &&
+         inClient.mBundleID.IsValid() &&
+         inClient.mBundleID == mMusicPlayerBundleIDProperty);
+    
+    return pidMatchesMusicPlayerProperty || bundleIDMatchesMusicPlayerProperty;
 }
 
 #pragma mark App Volumes
 
 Float32 BGM_Clients::GetClientRelativeVolumeRT(UInt32 inClientID) const
 {
-    BGM_Client theClient;
-    bool didGetClient = mClientMap.GetClientRT(inClientID, &theClient);
-    return (didGetClient ? theClient.mRelativeVolume : 1.0f);
+    BGM_Client* theClient = mClientMap.GetClientPtrRT(inClientID);
+    
+    if(theClient == nullptr)
+    {
+        return 1.0f;
+    }
+    
+    Float32 theRawVolume;
+    
+    if(mParameterTable.GetValueRT(theClient->mProcessID,
+                                  mDSPStates.GetParameterSlotCacheRT(theClient->mDSPStateSlot),
+                                  kBGMParameterRelativeVolume,
+                                  theRawVolume))
+    {
+        return ConvertRawRelativeVolumeToScalarRT(theRawVolume);
+    }
+    
+    return theClient->mRelativeVolume;
 }
 
-SInt32 BGM_Clients::GetClientPanPositionRT(UInt32 inClientID) const
+Float32 BGM_Clients::GetClientPanPositionRT(UInt32 inClientID) const
 {
-    BGM_Client theClient;
-    bool didGetClient = mClientMap.GetClientRT(inClientID, &theClient);
-    return (didGetClient ? theClient.mPanPosition : kAppPanCenterRawValue);
+    BGM_Client* theClient = mClientMap.GetClientPtrRT(inClientID);
+    
+    if(theClient == nullptr)
+    {
+        return kAppPanCenterRawValue;
+    }
+    
+    Float32 thePanPosition;
+    
+    if(mParameterTable.GetValueRT(theClient->mProcessID,
+                                  mDSPStates.GetParameterSlotCacheRT(theClient->mDSPStateSlot),
+                                  kBGMParameterPanPosition,
+                                  thePanPosition))
+    {
+        return std::min(std::max(thePanPosition, static_cast<Float32>(kAppPanLeftRawValue)),
+                        static_cast<Float32>(kAppPanRightRawValue));
+    }
+    
+    return static_cast<Float32>(theClient->mPanPosition);
+}
+
+Float32 BGM_Clients::ConvertRawRelativeVolumeToScalarRT(Float32 inRawVolume) const
+{
+    Float32 theRawVolume = std::min(std::max(inRawVolume, static_cast<Float32>(kAppRelativeVolumeMinRawValue)),
+                                    static_cast<Float32>(kAppRelativeVolumeMaxRawValue));
+    
+    SInt32 theLowerStep = static_cast<SInt32>(std::floor(theRawVolume));
+    SInt32 theUpperStep = std::min(theLowerStep + 1, kAppRelativeVolumeMaxRawValue);
+    Float32 theFraction = theRawVolume - static_cast<Float32>(theLowerStep);
+    
+    Float32 theLowerScalar = mRelativeVolumeCurve.ConvertRawToScalar(theLowerStep);
+    Float32 theUpperScalar = mRelativeVolumeCurve.ConvertRawToScalar(theUpperStep);
+    
+    // Multiply by 4 for the same reason as in SetClientsRelativeVolumes.
+    return (theLowerScalar + (theUpperScalar - theLowerScalar) * theFraction) * 4;
+}
+
+void    BGM_Clients::ClearParameterTableValues(pid_t inAppPID,
+                                               const CACFString& inAppBundleID,
+                                               BGMParameter inParameter)
+{
+    if(inAppPID > 0)
+    {
+        mParameterTable.ClearValue(inAppPID, inParameter);
+    }
+    
+    if(inAppBundleID.IsValid())
+    {
+        for(UInt32 theClientID : mClientMap.GetClientIDsNonRT(inAppBundleID))
+        {
+            BGM_Client theClient;
+            
+            if(mClientMap.GetClientNonRT(theClientID, &theClient))
+            {
+                mParameterTable.ClearValue(theClient.mProcessID, inParameter);
+            }
+        }
+    }
 }
 
 BGM_Client* BGM_Clients::GetClientForEQRT(UInt32 inClientID) const
@@ -315,10 +535,21 @@ BGM_Client* BGM_Clients::GetClientForEQRT(UInt32 inClientID) const
     return mClientMap.GetClientPtrRT(inClientID);
 }
 
+void    BGM_Clients::ApplyClientEQRT(const BGM_Client& inClient,
+                                     const Float32* const inCoeffs[BGM_ClientDSPStatePool::kEQBands],
+                                     Float32* ioBuffer,
+                                     UInt32 inFrameCount) const
+{
+    mDSPStates.ApplyEQRT(inClient.mDSPStateSlot, inCoeffs, ioBuffer, inFrameCount);
+}
+
 bool    BGM_Clients::SetClientsRelativeVolumes(const CACFArray inAppVolumes)
 {
     bool didChangeAppVolumes = false;
     
+    // BGMApp sets this property, so it might have created the shared parameter table by now
+    mParameterTable.OpenSharedIfNeeded();
+    
     // Each element in appVolumes is a CFDictionary containing the process id and/or bundle id of an app, and its
     // new relative volume
     for(UInt32 i = 0; i < inAppVolumes.GetNumberItems(); i++)
@@ -326,156 +557,181 @@ bool    BGM_Clients::SetClientsRelativeVolumes(const CACFArray inAppVolumes)
         CACFDictionary theAppVolume(false);
         inAppVolumes.GetCACFDictionary(i, theAppVolume);
         
-        // Get the app's PID from the dict
-        pid_t theAppPID;
-        bool didFindPID = theAppVolume.GetSInt32(CFSTR(kBGMAppVolumesKey_ProcessID), theAppPID);
-        
-        // Get the app's bundle ID from the dict
-        CACFString theAppBundleID;
-        theAppBundleID.DontAllowRelease();
-        theAppVolume.GetCACFString(CFSTR(kBGMAppVolumesKey_BundleID), theAppBundleID);
+        BGM_AppVolumeSettings theSettings = ParseAppVolumeSettings(theAppVolume);
         
-        ThrowIf(!didFindPID && !theAppBundleID.IsValid(),
-                BGM_InvalidClientRelativeVolumeException(),
-                "BGM_Clients::SetClientsRelativeVolumes: App volume was sent without PID or bundle ID for app");
+        pid_t theAppPID = theSettings.mProcessID;
+        const CACFString& theAppBundleID = theSettings.mBundleID;
         
-        bool didGetVolume;
+        if(theSettings.mHasRelativeVolume)
         {
-            SInt32 theRawRelativeVolume;
-            didGetVolume = theAppVolume.GetSInt32(CFSTR(kBGMAppVolumesKey_RelativeVolume), theRawRelativeVolume);
-            
-            if (didGetVolume) {
-                ThrowIf(didGetVolume && (theRawRelativeVolume < kAppRelativeVolumeMinRawValue || theRawRelativeVolume > kAppRelativeVolumeMaxRawValue),
-                        BGM_InvalidClientRelativeVolumeException(),
-                        "BGM_Clients::SetClientsRelativeVolumes: Relative volume for app out of valid range");
-                
-                // Apply the volume curve to the raw volume
-                //
-                // mRelativeVolumeCurve uses the default kPow2Over1Curve transfer function, so we also multiply by 4 to
-                // keep the middle volume equal to 1 (meaning apps' volumes are unchanged by default).
-                Float32 theRelativeVolume = mRelativeVolumeCurve.ConvertRawToScalar(theRawRelativeVolume) * 4;
-
-                // Try to update the client's volume, first by PID and then by bundle ID. Always try
-                // both because apps can have multiple clients.
-                if(mClientMap.SetClientsRelativeVolume(theAppPID, theRelativeVolume))
-                {
-                    didChangeAppVolumes = true;
-                }
+            // Apply the volume curve to the raw volume
+            //
+            // mRelativeVolumeCurve uses the default kPow2Over1Curve transfer function, so we also multiply by 4 to
+            // keep the middle volume equal to 1 (meaning apps' volumes are unchanged by default).
+            Float32 theRelativeVolume = mRelativeVolumeCurve.ConvertRawToScalar(theSettings.mRawRelativeVolume) * 4;
 
-                if(mClientMap.SetClientsRelativeVolume(theAppBundleID, theRelativeVolume))
-                {
-                    didChangeAppVolumes = true;
-                }
+            // Try to update the client's volume, first by PID and then by bundle ID. Always try
+            // both because apps can have multiple clients.
+            if(mClientMap.SetClientsRelativeVolume(theAppPID, theRelativeVolume))
+            {
+                didChangeAppVolumes = true;
+            }
 
-                // TODO: If the app isn't currently a client, we should add it to the past clients
-                //       map, or update its past volume if it's already in there.
+            if(mClientMap.SetClientsRelativeVolume(theAppBundleID, theRelativeVolume))
+            {
+                didChangeAppVolumes = true;
             }
+
+            // The volume replaces the one the app set in the shared parameter table, if it set
+            // one there.
+            ClearParameterTableValues(theAppPID, theAppBundleID, kBGMParameterRelativeVolume);
+
+            // TODO: If the app isn't currently a client, we should add it to the past clients
+            //       map, or update its past volume if it's already in there.
         }
         
-        bool didGetPanPosition;
+        if(theSettings.mHasPanPosition)
         {
-            SInt32 thePanPosition;
-            didGetPanPosition = theAppVolume.GetSInt32(CFSTR(kBGMAppVolumesKey_PanPosition), thePanPosition);
-            if (didGetPanPosition) {
-                ThrowIf(didGetPanPosition && (thePanPosition < kAppPanLeftRawValue || thePanPosition > kAppPanRightRawValue),
-                                              BGM_InvalidClientPanPositionException(),
-                                              "BGM_Clients::SetClientsRelativeVolumes: Pan position for app out of valid range");
-                
-                if(mClientMap.SetClientsPanPosition(theAppPID, thePanPosition))
-                {
-                    didChangeAppVolumes = true;
-                }
-
-                if(mClientMap.SetClientsPanPosition(theAppBundleID, thePanPosition))
-                {
-                    didChangeAppVolumes = true;
-                }
+            if(mClientMap.SetClientsPanPosition(theAppPID, theSettings.mPanPosition))
+            {
+                didChangeAppVolumes = true;
+            }
 
-                // TODO: If the app isn't currently a client, we should add it to the past clients
-                //       map, or update its past pan position if it's already in there.
+            if(mClientMap.SetClientsPanPosition(theAppBundleID, theSettings.mPanPosition))
+            {
+                didChangeAppVolumes = true;
             }
+
+            ClearParameterTableValues(theAppPID, theAppBundleID, kBGMParameterPanPosition);
+
+            // TODO: If the app isn't currently a client, we should add it to the past clients
+            //       map, or update its past pan position if it's already in there.
         }
         
         // Handle EQ settings (low, mid, high in dB from -12 to +12)
-        bool didGetEQ = false;
-        {
-            SInt32 theEQLow, theEQMid, theEQHigh;
-            bool hasLow = theAppVolume.GetSInt32(CFSTR(kBGMAppVolumesKey_EQLowGain), theEQLow);
-            bool hasMid = theAppVolume.GetSInt32(CFSTR(kBGMAppVolumesKey_EQMidGain), theEQMid);
-            bool hasHigh = theAppVolume.GetSInt32(CFSTR(kBGMAppVolumesKey_EQHighGain), theEQHigh);
-            
-            if (hasLow || hasMid || hasHigh) {
-                // Validate ranges (EQ is stored as SInt32 in 10ths of dB, -120 to 120)
-                if (hasLow) {
-                    ThrowIf(theEQLow < kAppEQGainMinRawValue || theEQLow > kAppEQGainMaxRawValue,
-                            BGM_InvalidClientRelativeVolumeException(),
-                            "BGM_Clients::SetClientsRelativeVolumes: EQ low gain out of valid range");
-                }
-                if (hasMid) {
-                    ThrowIf(theEQMid < kAppEQGainMinRawValue || theEQMid > kAppEQGainMaxRawValue,
-                            BGM_InvalidClientRelativeVolumeException(),
-                            "BGM_Clients::SetClientsRelativeVolumes: EQ mid gain out of valid range");
-                }
-                if (hasHigh) {
-                    ThrowIf(theEQHigh < kAppEQGainMinRawValue || theEQHigh > kAppEQGainMaxRawValue,
-                            BGM_InvalidClientRelativeVolumeException(),
-                            "BGM_Clients::SetClientsRelativeVolumes: EQ high gain out of valid range");
-                }
-                
-                // Convert from 10ths of dB to dB, use kAppEQGainNoValue for missing values
-                Float32 lowDB = hasLow ? static_cast<Float32>(theEQLow) / 10.0f : static_cast<Float32>(kAppEQGainNoValue);
-                Float32 midDB = hasMid ? static_cast<Float32>(theEQMid) / 10.0f : static_cast<Float32>(kAppEQGainNoValue);
-                Float32 highDB = hasHigh ? static_cast<Float32>(theEQHigh) / 10.0f : static_cast<Float32>(kAppEQGainNoValue);
-                
-                // Get sample rate from the device (default to 48kHz)
-                Float64 sampleRate = 48000.0;
-                
-                if(mClientMap.SetClientsEQ(theAppPID, lowDB, midDB, highDB, sampleRate))
-                {
-                    didChangeAppVolumes = true;
-                    didGetEQ = true;
-                }
-                
-                if(mClientMap.SetClientsEQ(theAppBundleID, lowDB, midDB, highDB, sampleRate))
-                {
-                    didChangeAppVolumes = true;
-                    didGetEQ = true;
-                }
+        if(theSettings.HasEQ())
+        {
+            // Get sample rate from the device (default to 48kHz)
+            Float64 sampleRate = 48000.0;
+            
+            if(mClientMap.SetClientsEQ(theAppPID,
+                                       theSettings.mEQGainsDB[0],
+                                       theSettings.mEQGainsDB[1],
+                                       theSettings.mEQGainsDB[2],
+                                       sampleRate))
+            {
+                didChangeAppVolumes = true;
+            }
+            
+            if(mClientMap.SetClientsEQ(theAppBundleID,
+                                       theSettings.mEQGainsDB[0],
+                                       theSettings.mEQGainsDB[1],
+                                       theSettings.mEQGainsDB[2],
+                                       sampleRate))
+            {
+                didChangeAppVolumes = true;
             }
         }
-        
-        ThrowIf(!didGetVolume && !didGetPanPosition && !didGetEQ,
-                BGM_InvalidClientRelativeVolumeException(),
-                "BGM_Clients::SetClientsRelativeVolumes: No volume, pan position, or EQ in request");
     }
     
     return didChangeAppVolumes;
 }
 
+BGM_AppVolumeSettings   BGM_Clients::ParseAppVolumeSettings(const CACFDictionary& inAppVolume)
+{
+    BGM_AppVolumeSettings theSettings;
+    
+    // Get the app's PID and bundle ID from the dict
+    bool didFindPID = inAppVolume.GetSInt32(CFSTR(kBGMAppVolumesKey_ProcessID), theSettings.mProcessID);
+    inAppVolume.GetCACFString(CFSTR(kBGMAppVolumesKey_BundleID), theSettings.mBundleID);
+    
+    ThrowIf(!didFindPID && !theSettings.mBundleID.IsValid(),
+            BGM_InvalidClientRelativeVolumeException(),
+            "BGM_Clients::ParseAppVolumeSettings: App volume was sent without PID or bundle ID for app");
+    
+    theSettings.mHasRelativeVolume =
+        inAppVolume.GetSInt32(CFSTR(kBGMAppVolumesKey_RelativeVolume), theSettings.mRawRelativeVolume);
+    
+    ThrowIf(theSettings.mHasRelativeVolume &&
+                    (theSettings.mRawRelativeVolume < kAppRelativeVolumeMinRawValue ||
+                     theSettings.mRawRelativeVolume > kAppRelativeVolumeMaxRawValue),
+            BGM_InvalidClientRelativeVolumeException(),
+            "BGM_Clients::ParseAppVolumeSettings: Relative volume for app out of valid range");
+    
+    theSettings.mHasPanPosition =
+        inAppVolume.GetSInt32(CFSTR(kBGMAppVolumesKey_PanPosition), theSettings.mPanPosition);
+    
+    ThrowIf(theSettings.mHasPanPosition &&
+                    (theSettings.mPanPosition < kAppPanLeftRawValue ||
+                     theSettings.mPanPosition > kAppPanRightRawValue),
+            BGM_InvalidClientPanPositionException(),
+            "BGM_Clients::ParseAppVolumeSettings: Pan position for app out of valid range");
+    
+    // The EQ gains are in 10ths of dB, from -120 to 120
+    const CFStringRef kEQKeys[BGM_SceneMorph::kEQBands] = {
+        CFSTR(kBGMAppVolumesKey_EQLowGain),
+        CFSTR(kBGMAppVolumesKey_EQMidGain),
+        CFSTR(kBGMAppVolumesKey_EQHighGain)
+    };
+    
+    for(UInt32 i = 0; i < BGM_SceneMorph::kEQBands; i++)
+    {
+        SInt32 theRawGain;
+        
+        if(inAppVolume.GetSInt32(kEQKeys[i], theRawGain))
+        {
+            ThrowIf(theRawGain < kAppEQGainMinRawValue || theRawGain > kAppEQGainMaxRawValue,
+                    BGM_InvalidClientRelativeVolumeException(),
+                    "BGM_Clients::ParseAppVolumeSettings: EQ gain out of valid range");
+            
+            theSettings.mEQGainsDB[i] = static_cast<Float32>(theRawGain) / 10.0f;
+        }
+    }
+    
+    ThrowIf(!theSettings.mHasRelativeVolume && !theSettings.mHasPanPosition && !theSettings.HasEQ(),
+            BGM_InvalidClientRelativeVolumeException(),
+            "BGM_Clients::ParseAppVolumeSettings: No volume, pan position, or EQ in request");
+    
+    return theSettings;
+}
+
 #pragma mark App Routing
 
+// The size of each routing source's buffer. Destinations read it at the sample times they would read
+// BGMDevice's loopback ring buffer, less their routes' delays, so it holds as much as the loopback
+// ring buffer plus the maximum delay.
+static const UInt32 kRoutingBufferFrameSize = 16384 + kBGMAppRoutingMaxDelayFrames;
+
 bool    BGM_Clients::SetRoute(pid_t inSourcePID, pid_t inDestPID, Float32 inGain, bool inEnabled)
 {
     CAMutex::Locker theLocker(mMutex);
     
+    bool changed = false;
+    bool found = false;
+    
+    BGM_AudioRoute theEndpoints;
+    theEndpoints.mSourcePID = inSourcePID;
+    theEndpoints.mDestPID = inDestPID;
+    
     // Look for existing route
     for(auto& route : mRoutes)
     {
-        if(route.mSourcePID == inSourcePID && route.mDestPID == inDestPID)
+        if(route == theEndpoints)
         {
             // Update existing route
-            bool changed = (route.mGain != inGain || route.mEnabled != inEnabled);
+            changed = (route.mGain != inGain || route.mEnabled != inEnabled);
             route.mGain = inGain;
             route.mEnabled = inEnabled;
             
             // If disabling, we could clean up routing buffers, but keep them for quick re-enable
             
-            return changed;
+            found = true;
+            break;
         }
     }
     
     // Add new route
-    if(inEnabled)
+    if(!found && inEnabled)
     {
         BGM_AudioRoute newRoute;
         newRoute.mSourcePID = inSourcePID;
@@ -484,16 +740,18 @@ bool    BGM_Clients::SetRoute(pid_t inSourcePID, pid_t inDestPID, Float32 inGain
         newRoute.mEnabled = inEnabled;
         mRoutes.push_back(newRoute);
         
-        // Allocate routing buffer for source client
-        mClientMap.AllocateRoutingBufferForPID(inSourcePID);
-        
         DebugMsg("BGM_Clients::SetRoute: Added route from PID %d to PID %d, gain=%.2f",
                  inSourcePID, inDestPID, inGain);
         
-        return true;
+        changed = true;
+    }
+    
+    if(changed)
+    {
+        CompileRoutingKernels();
     }
     
-    return false;
+    return changed;
 }
 
 CFArrayRef  BGM_Clients::CopyRoutesAsArray() const
@@ -511,7 +769,7 @@ CFArrayRef  BGM_Clients::CopyRoutesAsArray() const
     for(const auto& route : mRoutes)
     {
         CFMutableDictionaryRef routeDict = CFDictionaryCreateMutable(kCFAllocatorDefault,
-                                                                      4,
+                                                                      0,
                                                                       &kCFTypeDictionaryKeyCallBacks,
                                                                       &kCFTypeDictionaryValueCallBacks);
         if(!routeDict)
@@ -535,6 +793,17 @@ CFArrayRef  BGM_Clients::CopyRoutesAsArray() const
             CFRelease(destPID);
         }
         
+        // Add the bundle IDs of routes between bundle IDs
+        if(route.mSourceBundleID.IsValid())
+        {
+            CFDictionarySetValue(routeDict, CFSTR(kBGMAppRoutingKey_SourceBundleID), route.mSourceBundleID.GetCFString());
+        }
+        
+        if(route.mDestBundleID.IsValid())
+        {
+            CFDictionarySetValue(routeDict, CFSTR(kBGMAppRoutingKey_DestBundleID), route.mDestBundleID.GetCFString());
+        }
+        
         // Add gain
         CFNumberRef gain = CFNumberCreate(kCFAllocatorDefault, kCFNumberFloat32Type, &route.mGain);
         if(gain)
@@ -547,8 +816,51 @@ CFArrayRef  BGM_Clients::CopyRoutesAsArray() const
         CFDictionarySetValue(routeDict, CFSTR(kBGMAppRoutingKey_Enabled), 
                             route.mEnabled ? kCFBooleanTrue : kCFBooleanFalse);
         
+        // Add the delay and the latency it gives the route. Routed audio is otherwise aligned with
+        // the loopback audio, so the latency relative to the loopback is just the delay.
+        SInt32 delayFrames = static_cast<SInt32>(route.mDelayFrames);
+        CFNumberRef delay = CFNumberCreate(kCFAllocatorDefault, kCFNumberSInt32Type, &delayFrames);
+        if(delay)
+        {
+            CFDictionarySetValue(routeDict, CFSTR(kBGMAppRoutingKey_DelayFrames), delay);
+            CFDictionarySetValue(routeDict, CFSTR(kBGMAppRoutingKey_LatencyFrames), delay);
+            CFRelease(delay);
+        }
+        
         CFArrayAppendValue(routesArray, routeDict);
         CFRelease(routeDict);
+        
+        // If the route doesn't just map L->L and R->R, add a dictionary for each entry of its
+        // channel matrix. Zero entries are included so setting the property to this array gives
+        // the same matrix.
+        if(!route.HasDefaultChannelGains())
+        {
+            for(SInt32 destChannel = 0; destChannel < static_cast<SInt32>(BGM_AudioRoute::kChannels); destChannel++)
+            {
+                for(SInt32 sourceChannel = 0; sourceChannel < static_cast<SInt32>(BGM_AudioRoute::kChannels); sourceChannel++)
+                {
+                    CACFDictionary theChannelDict(true);
+                    theChannelDict.AddSInt32(CFSTR(kBGMAppRoutingKey_SourceProcessID), route.mSourcePID);
+                    theChannelDict.AddSInt32(CFSTR(kBGMAppRoutingKey_DestProcessID), route.mDestPID);
+                    
+                    if(route.mSourceBundleID.IsValid())
+                    {
+                        theChannelDict.AddString(CFSTR(kBGMAppRoutingKey_SourceBundleID), route.mSourceBundleID.GetCFString());
+                    }
+                    
+                    if(route.mDestBundleID.IsValid())
+                    {
+                        theChannelDict.AddString(CFSTR(kBGMAppRoutingKey_DestBundleID), route.mDestBundleID.GetCFString());
+                    }
+                    
+                    theChannelDict.AddSInt32(CFSTR(kBGMAppRoutingKey_SourceChannel), sourceChannel);
+                    theChannelDict.AddSInt32(CFSTR(kBGMAppRoutingKey_DestChannel), destChannel);
+                    theChannelDict.AddFloat32(CFSTR(kBGMAppRoutingKey_Gain),
+                                              route.mChannelGains[destChannel][sourceChannel]);
+                    CFArrayAppendValue(routesArray, theChannelDict.GetDict());
+                }
+            }
+        }
     }
     
     return routesArray;
@@ -558,6 +870,18 @@ bool    BGM_Clients::SetRoutesFromArray(const CACFArray inRoutes)
 {
     CAMutex::Locker theLocker(mMutex);
     
+    bool didChange = UpdateRoutes(inRoutes);
+    
+    if(didChange)
+    {
+        CompileRoutingKernels();
+    }
+    
+    return didChange;
+}
+
+bool    BGM_Clients::UpdateRoutes(const CACFArray& inRoutes)
+{
     bool didChange = false;
     
     for(UInt32 i = 0; i < inRoutes.GetNumberItems(); i++)
@@ -570,16 +894,29 @@ bool    BGM_Clients::SetRoutesFromArray(const CACFArray inRoutes)
             continue;
         }
         
-        // Get source PID
-        pid_t sourcePID;
-        if(!theRoute.GetSInt32(CFSTR(kBGMAppRoutingKey_SourceProcessID), sourcePID))
+        // Get the source and destination. Each can be given as a PID or a bundle ID. If a bundle ID
+        // is given, the route applies to every client with that bundle ID.
+        BGM_AudioRoute theEndpoints;
+        
+        bool hasSourcePID = theRoute.GetSInt32(CFSTR(kBGMAppRoutingKey_SourceProcessID), theEndpoints.mSourcePID);
+        bool hasDestPID = theRoute.GetSInt32(CFSTR(kBGMAppRoutingKey_DestProcessID), theEndpoints.mDestPID);
+        theRoute.GetCACFString(CFSTR(kBGMAppRoutingKey_SourceBundleID), theEndpoints.mSourceBundleID);
+        theRoute.GetCACFString(CFSTR(kBGMAppRoutingKey_DestBundleID), theEndpoints.mDestBundleID);
+        
+        if(theEndpoints.mSourceBundleID.IsValid())
+        {
+            theEndpoints.mSourcePID = 0;
+        }
+        else if(!hasSourcePID)
         {
             continue;
         }
         
-        // Get dest PID
-        pid_t destPID;
-        if(!theRoute.GetSInt32(CFSTR(kBGMAppRoutingKey_DestProcessID), destPID))
+        if(theEndpoints.mDestBundleID.IsValid())
+        {
+            theEndpoints.mDestPID = 0;
+        }
+        else if(!hasDestPID)
         {
             continue;
         }
@@ -592,88 +929,279 @@ bool    BGM_Clients::SetRoutesFromArray(const CACFArray inRoutes)
         bool enabled = true;
         theRoute.GetBool(CFSTR(kBGMAppRoutingKey_Enabled), enabled);
         
-        // Use the public SetRoute which will handle locking - but we already hold the lock
-        // So directly manipulate mRoutes here
-        bool found = false;
-        for(auto& existingRoute : mRoutes)
+        // Get the delay, if it's being set
+        SInt32 delayFrames = 0;
+        bool hasDelay = theRoute.GetSInt32(CFSTR(kBGMAppRoutingKey_DelayFrames), delayFrames);
+        
+        if(hasDelay && (delayFrames < 0 || delayFrames > kBGMAppRoutingMaxDelayFrames))
+        {
+            DebugMsg("BGM_Clients::UpdateRoutes: Invalid delay %d", delayFrames);
+            continue;
+        }
+        
+        // If the dictionary has channels, it sets entries of the route's channel matrix rather
+        // than the route's overall gain
+        SInt32 sourceChannel = kBGMAppRoutingChannelAll;
+        SInt32 destChannel = kBGMAppRoutingChannelAll;
+        bool hasSourceChannel = theRoute.GetSInt32(CFSTR(kBGMAppRoutingKey_SourceChannel), sourceChannel);
+        bool hasDestChannel = theRoute.GetSInt32(CFSTR(kBGMAppRoutingKey_DestChannel), destChannel);
+        
+        if(hasSourceChannel || hasDestChannel)
+        {
+            if(!IsValidRoutingChannel(sourceChannel) || !IsValidRoutingChannel(destChannel))
+            {
+                DebugMsg("BGM_Clients::UpdateRoutes: Invalid channel(s) %d -> %d", sourceChannel, destChannel);
+                continue;
+            }
+            
+            didChange = SetRouteChannelGains(theEndpoints, sourceChannel, destChannel,
+                                             (enabled ? gain : 0.0f)) || didChange;
+        }
+        else
         {
-            if(existingRoute.mSourcePID == sourcePID && existingRoute.mDestPID == destPID)
+            // Use the public SetRoute which will handle locking - but we already hold the lock
+            // So directly manipulate mRoutes here
+            bool found = false;
+            for(auto& existingRoute : mRoutes)
             {
-                if(existingRoute.mGain != gain || existingRoute.mEnabled != enabled)
+                if(existingRoute == theEndpoints)
                 {
-                    existingRoute.mGain = gain;
-                    existingRoute.mEnabled = enabled;
-                    didChange = true;
+                    if(existingRoute.mGain != gain || existingRoute.mEnabled != enabled)
+                    {
+                        existingRoute.mGain = gain;
+                        existingRoute.mEnabled = enabled;
+                        didChange = true;
+                    }
+                    found = true;
+                    break;
                 }
-                found = true;
-                break;
+            }
+            
+            if(!found && enabled)
+            {
+                BGM_AudioRoute newRoute = theEndpoints;
+                newRoute.mGain = gain;
+                newRoute.mEnabled = enabled;
+                mRoutes.push_back(newRoute);
+                
+                didChange = true;
             }
         }
         
-        if(!found && enabled)
+        if(hasDelay)
         {
-            BGM_AudioRoute newRoute;
-            newRoute.mSourcePID = sourcePID;
-            newRoute.mDestPID = destPID;
-            newRoute.mGain = gain;
-            newRoute.mEnabled = enabled;
-            mRoutes.push_back(newRoute);
-            
-            // Allocate routing buffer for source client
-            mClientMap.AllocateRoutingBufferForPID(sourcePID);
-            
-            didChange = true;
+            didChange = SetRouteDelay(theEndpoints, static_cast<UInt32>(delayFrames)) || didChange;
         }
     }
     
     return didChange;
 }
 
-void    BGM_Clients::ClearRoutesForClient(pid_t inProcessID)
+bool    BGM_Clients::IsValidRoutingChannel(SInt32 inChannel)
 {
-    CAMutex::Locker theLocker(mMutex);
+    return inChannel == kBGMAppRoutingChannelAll ||
+           (inChannel >= 0 && inChannel < static_cast<SInt32>(BGM_AudioRoute::kChannels));
+}
+
+bool    BGM_Clients::SetRouteChannelGains(const BGM_AudioRoute& inEndpoints,
+                                          SInt32 inSourceChannel,
+                                          SInt32 inDestChannel,
+                                          Float32 inGain)
+{
+    auto theRouteItr = std::find(mRoutes.begin(), mRoutes.end(), inEndpoints);
     
-    // Remove all routes where this process is source or destination
-    auto it = mRoutes.begin();
-    while(it != mRoutes.end())
+    bool didChange = false;
+    
+    if(theRouteItr == mRoutes.end())
     {
-        if(it->mSourcePID == inProcessID || it->mDestPID == inProcessID)
-        {
-            DebugMsg("BGM_Clients::ClearRoutesForClient: Removing route from PID %d to PID %d",
-                     it->mSourcePID, it->mDestPID);
-            it = mRoutes.erase(it);
-        }
-        else
+        if(inGain == 0.0f)
         {
-            ++it;
+            // No need to add a route that wouldn't route anything
+            return false;
         }
+        
+        // A new route only has the channels it's given, rather than L->L and R->R
+        BGM_AudioRoute newRoute = inEndpoints;
+        newRoute.mGain = 1.0f;
+        newRoute.mEnabled = true;
+        memset(newRoute.mChannelGains, 0, sizeof(newRoute.mChannelGains));
+        mRoutes.push_back(newRoute);
+        theRouteItr = mRoutes.end() - 1;
+        
+        didChange = true;
     }
-    
-    // Deallocate routing buffer for this client
-    mClientMap.DeallocateRoutingBufferForPID(inProcessID);
+    else if(inGain != 0.0f && !theRouteItr->mEnabled)
+    {
+        theRouteItr->mEnabled = true;
+        didChange = true;
+    }
+    
+    for(SInt32 theDest = 0; theDest < static_cast<SInt32>(BGM_AudioRoute::kChannels); theDest++)
+    {
+        for(SInt32 theSource = 0; theSource < static_cast<SInt32>(BGM_AudioRoute::kChannels); theSource++)
+        {
+            bool isSelected = (inDestChannel == kBGMAppRoutingChannelAll || inDestChannel == theDest) &&
+                              (inSourceChannel == kBGMAppRoutingChannelAll || inSourceChannel == theSource);
+            
+            if(isSelected && theRouteItr->mChannelGains[theDest][theSource] != inGain)
+            {
+                theRouteItr->mChannelGains[theDest][theSource] = inGain;
+                didChange = true;
+            }
+        }
+    }
+    
+    return didChange;
 }
 
-void    BGM_Clients::StoreClientAudioRT(UInt32 inClientID, const Float32* inBuffer, UInt32 inNumFrames)
+bool    BGM_Clients::SetRouteDelay(const BGM_AudioRoute& inEndpoints, UInt32 inDelayFrames)
 {
-    // Check if this client is a routing source
-    BGM_Client* theClient = mClientMap.GetClientPtrRT(inClientID);
-    if(!theClient)
+    auto theRouteItr = std::find(mRoutes.begin(), mRoutes.end(), inEndpoints);
+    
+    if(theRouteItr == mRoutes.end() || theRouteItr->mDelayFrames == inDelayFrames)
     {
-        return;
+        return false;
     }
     
-    // Check if any routes use this client as source
-    bool isRoutingSource = false;
-    for(const auto& route : mRoutes)
+    theRouteItr->mDelayFrames = inDelayFrames;
+    
+    return true;
+}
+
+void    BGM_Clients::CompileRoutingKernels(std::function<void(BGM_Client&)> inUpdateClient)
+{
+    mRoutedProcessIDs.clear();
+    mRoutedBundleIDs.clear();
+    
+    // The kernels for each destination client, by client ID, and the clients that are sources
+    std::unordered_map<UInt32, std::vector<BGM_RoutingKernel>> theKernels;
+    std::unordered_set<UInt32> theSourceClientIDs;
+    
+    auto theResolveFunc = [&] (pid_t inPID, const CACFString& inBundleID) {
+        if(inBundleID.IsValid())
+        {
+            mRoutedBundleIDs.insert(inBundleID);
+            return mClientMap.GetClientIDsNonRT(inBundleID);
+        }
+        
+        mRoutedProcessIDs.insert(inPID);
+        return mClientMap.GetClientIDsNonRT(inPID);
+    };
+    
+    for(const BGM_AudioRoute& route : mRoutes)
     {
-        if(route.mEnabled && route.mSourcePID == theClient->mProcessID)
+        if(!route.mEnabled)
         {
-            isRoutingSource = true;
-            break;
+            continue;
+        }
+        
+        std::vector<UInt32> theSourceIDs = theResolveFunc(route.mSourcePID, route.mSourceBundleID);
+        std::vector<UInt32> theDestIDs = theResolveFunc(route.mDestPID, route.mDestBundleID);
+        
+        for(UInt32 theDestID : theDestIDs)
+        {
+            for(UInt32 theSourceID : theSourceIDs)
+            {
+                // Don't route a client's audio back to itself
+                if(theSourceID != theDestID)
+                {
+                    theKernels[theDestID].emplace_back(route, theSourceID);
+                    theSourceClientIDs.insert(theSourceID);
+                }
+            }
+        }
+    }
+    
+    // Give each source a routing buffer. Keep the ones we already have so their destinations don't
+    // get a gap in their audio.
+    std::map<UInt32, std::unique_ptr<BGM_SampleTimeRingBuffer>> theRoutingBuffers;
+    
+    for(UInt32 theSourceID : theSourceClientIDs)
+    {
+        auto theExistingBuffer = mRoutingBuffers.find(theSourceID);
+        
+        if(theExistingBuffer != mRoutingBuffers.end())
+        {
+            theRoutingBuffers[theSourceID] = std::move(theExistingBuffer->second);
+        }
+        else
+        {
+            theRoutingBuffers[theSourceID].reset(new BGM_SampleTimeRingBuffer(kRoutingBufferFrameSize));
+        }
+    }
+    
+    // Give each client the kernels for the enabled routes to it. The kernels are stored in the
+    // clients so IO can read them with the client map's real-time safe locking.
+    mClientMap.UpdateClients([&] (BGM_Client& ioClient) {
+        auto theKernelsItr = theKernels.find(ioClient.mClientID);
+        
+        if(theKernelsItr != theKernels.end())
+        {
+            ioClient.mIncomingRoutingKernels = theKernelsItr->second;
+        }
+        else
+        {
+            ioClient.mIncomingRoutingKernels.clear();
+        }
+        
+        auto theBufferItr = theRoutingBuffers.find(ioClient.mClientID);
+        ioClient.mRoutingBuffer =
+            (theBufferItr != theRoutingBuffers.end()) ? theBufferItr->second.get() : nullptr;
+        
+        if(inUpdateClient)
+        {
+            inUpdateClient(ioClient);
+        }
+    });
+    
+    // Neither client map refers to the routing buffers that are no longer needed now, so they can
+    // be freed
+    mRoutingBuffers.swap(theRoutingBuffers);
+}
+
+bool    BGM_Clients::IsRouteEndpoint(const BGM_Client& inClient) const
+{
+    return (mRoutedProcessIDs.count(inClient.mProcessID) != 0) ||
+           (inClient.mBundleID.IsValid() && mRoutedBundleIDs.count(inClient.mBundleID) != 0);
+}
+
+void    BGM_Clients::ClearRoutesForClient(pid_t inProcessID)
+{
+    CAMutex::Locker theLocker(mMutex);
+    
+    // Remove all routes where this process is source or destination
+    auto it = mRoutes.begin();
+    while(it != mRoutes.end())
+    {
+        if(it->mSourcePID == inProcessID || it->mDestPID == inProcessID)
+        {
+            DebugMsg("BGM_Clients::ClearRoutesForClient: Removing route from PID %d to PID %d",
+                     it->mSourcePID, it->mDestPID);
+            it = mRoutes.erase(it);
+        }
+        else
+        {
+            ++it;
         }
     }
     
-    if(isRoutingSource)
+    // This also frees the client's routing buffer
+    CompileRoutingKernels();
+}
+
+void    BGM_Clients::StoreClientAudioRT(UInt32 inClientID,
+                                        const Float32* inBuffer,
+                                        UInt32 inNumFrames,
+                                        Float64 inSampleTime)
+{
+    // Check if this client is a routing source
+    BGM_Client* theClient = mClientMap.GetClientPtrRT(inClientID);
+    if(!theClient)
+    {
+        return;
+    }
+    
+    if(theClient->mRoutingBuffer != nullptr)
     {
         // Debug: log that we're storing audio
         static int storeCount = 0;
@@ -682,112 +1210,1667 @@ void    BGM_Clients::StoreClientAudioRT(UInt32 inClientID, const Float32* inBuff
             DebugMsg("BGM_Clients::StoreClientAudioRT: Storing %u frames from client %u (PID %d)",
                      inNumFrames, inClientID, theClient->mProcessID);
         }
-        theClient->StoreToRoutingBuffer(inBuffer, inNumFrames, 0.0);
+        theClient->mRoutingBuffer->StoreRT(inBuffer, inNumFrames, inSampleTime);
     }
 }
 
-void    BGM_Clients::MixRoutedAudioRT(UInt32 inClientID, Float32* ioBuffer, UInt32 inNumFrames)
+void    BGM_Clients::MixRoutedAudioRT(UInt32 inClientID,
+                                      Float32* ioBuffer,
+                                      UInt32 inNumFrames,
+                                      Float64 inSampleTime)
 {
-    // Get the destination client to find its process ID
+    // Get the destination client to find the routes to it
     BGM_Client* destClient = mClientMap.GetClientPtrRT(inClientID);
     if(!destClient)
     {
         return;
     }
     
-    pid_t destPID = destClient->mProcessID;
-    
-    // Debug: count how many routes we find
-    int routeCount = 0;
-    
-    // Find all routes that target this client
-    for(const auto& route : mRoutes)
+    for(const BGM_RoutingKernel& kernel : destClient->mIncomingRoutingKernels)
     {
-        if(!route.mEnabled || route.mDestPID != destPID)
+        // Find the source client
+        BGM_Client* sourceClient = mClientMap.GetClientPtrRT(kernel.mSourceClientID);
+        if(!sourceClient || !sourceClient->mRoutingBuffer)
         {
             continue;
         }
         
-        routeCount++;
+        // Copy the source's audio for these sample times, less the route's delay, out of its
+        // routing buffer and mix it in. Done in chunks that fit in the scratch buffer.
+        for(UInt32 theOffset = 0; theOffset < inNumFrames; theOffset += BGM_Client::kRoutingBufferFrames)
+        {
+            // (Not std::min, which would odr-use kRoutingBufferFrames.)
+            UInt32 theFrames = (inNumFrames - theOffset < BGM_Client::kRoutingBufferFrames) ?
+                    inNumFrames - theOffset : BGM_Client::kRoutingBufferFrames;
+            
+            sourceClient->mRoutingBuffer->FetchRT(mRoutingScratchBuffer,
+                                                  theFrames,
+                                                  inSampleTime + theOffset - kernel.mDelayFrames);
+            ApplyRoutingKernelRT(kernel,
+                                 mRoutingScratchBuffer,
+                                 ioBuffer + theOffset * BGM_Client::kRoutingBufferChannels,
+                                 theFrames);
+        }
+    }
+}
+
+void    BGM_Clients::ApplyRoutingKernelRT(const BGM_RoutingKernel& inKernel,
+                                          const Float32* inSourceBuffer,
+                                          Float32* ioDestBuffer,
+                                          UInt32 inNumFrames)
+{
+    const UInt32 kStride = BGM_AudioRoute::kChannels;
+    
+    if(inKernel.mIsDenseStereo)
+    {
+        // L->L and R->R with the same gain, so the interleaved buffers can be treated as one
+        // channel: ioDestBuffer += inSourceBuffer * gain
+        MultiplyAddRT(inSourceBuffer, 1,
+                      inKernel.mDenseGain,
+                      ioDestBuffer, 1,
+                      inNumFrames * BGM_AudioRoute::kChannels);
+    }
+    else
+    {
+        // Gather each tap's source channel, scale it and add it to its destination channel
+        for(UInt32 i = 0; i < inKernel.mNumTaps; i++)
+        {
+            const BGM_RoutingKernel::Tap& tap = inKernel.mTaps[i];
+            
+            MultiplyAddRT(inSourceBuffer + tap.mSourceChannel, kStride,
+                          tap.mGain,
+                          ioDestBuffer + tap.mDestChannel, kStride,
+                          inNumFrames);
+        }
+    }
+}
+
+// static
+void    BGM_Clients::MultiplyAddRT(const Float32* inSourceBuffer,
+                                   UInt32 inSourceStride,
+                                   Float32 inGain,
+                                   Float32* ioDestBuffer,
+                                   UInt32 inDestStride,
+                                   UInt32 inNumSamples)
+{
+#if defined(__APPLE__)
+    vDSP_vsma(inSourceBuffer, inSourceStride,
+              &inGain,
+              ioDestBuffer, inDestStride,
+              ioDestBuffer, inDestStride,
+              inNumSamples);
+#else
+    for(UInt32 i = 0; i < inNumSamples; i++)
+    {
+        ioDestBuffer[i * inDestStride] += inSourceBuffer[i * inSourceStride] * inGain;
+    }
+#endif
+}
+
+bool    BGM_Clients::HasIncomingRoutesRT(UInt32 inClientID) const
+{
+    BGM_Client* theClient = mClientMap.GetClientPtrRT(inClientID);
+    
+    return theClient != nullptr && !theClient->mIncomingRoutingKernels.empty();
+}
+
+#pragma mark Mix-Minus
+
+CACFArray   BGM_Clients::CopyMixMinusAppsAsArray() const
+{
+    CAMutex::Locker theLocker(mMutex);
+    
+    CACFArray theMixMinusApps(false);
+    
+    for(pid_t thePID : mMixMinusProcessIDs)
+    {
+        CACFDictionary theApp(true);
+        theApp.AddSInt32(CFSTR(kBGMMixMinusKey_ProcessID), thePID);
+        theApp.AddBool(CFSTR(kBGMMixMinusKey_Enabled), true);
+        theMixMinusApps.AppendDictionary(theApp.GetDict());
+    }
+    
+    for(const CACFString& theBundleID : mMixMinusBundleIDs)
+    {
+        CACFDictionary theApp(true);
+        theApp.AddString(CFSTR(kBGMMixMinusKey_BundleID), theBundleID.GetCFString());
+        theApp.AddBool(CFSTR(kBGMMixMinusKey_Enabled), true);
+        theMixMinusApps.AppendDictionary(theApp.GetDict());
+    }
+    
+    return theMixMinusApps;
+}
+
+bool    BGM_Clients::SetMixMinusApps(const CACFArray inMixMinusApps)
+{
+    CAMutex::Locker theLocker(mMutex);
+    
+    bool didChange = false;
+    
+    for(UInt32 i = 0; i < inMixMinusApps.GetNumberItems(); i++)
+    {
+        CACFDictionary theApp(false);
+        inMixMinusApps.GetCACFDictionary(i, theApp);
+        
+        pid_t theAppPID;
+        bool didFindPID = theApp.IsValid() &&
+                          theApp.GetSInt32(CFSTR(kBGMMixMinusKey_ProcessID), theAppPID);
         
-        // Find the source client
-        BGM_Client* sourceClient = mClientMap.GetClientByPIDRT(route.mSourcePID);
-        if(!sourceClient)
+        CACFString theAppBundleID;
+        theAppBundleID.DontAllowRelease();
+        if(theApp.IsValid())
         {
-            DebugMsg("BGM_Clients::MixRoutedAudioRT: Source client PID %d not found!", route.mSourcePID);
-            continue;
+            theApp.GetCACFString(CFSTR(kBGMMixMinusKey_BundleID), theAppBundleID);
         }
         
-        // Fetch audio from source's routing buffer and mix into destination
-        // The buffer stores frames sequentially. After writing N frames, writePos points
-        // to the next position to write. To read the most recent N frames:
-        // - Frame 0 (oldest of the N) is at writePos - N
-        // - Frame N-1 (newest) is at writePos - 1
-        // We add a small safety margin to avoid reading data that's still being written
-        Float32 gain = route.mGain;
+        ThrowIf(!didFindPID && !theAppBundleID.IsValid(),
+                BGM_InvalidClientException(),
+                "BGM_Clients::SetMixMinusApps: App was sent without PID or bundle ID");
+        
+        // Default to enabling mix-minus for the app
+        bool theEnabled = true;
+        theApp.GetBool(CFSTR(kBGMMixMinusKey_Enabled), theEnabled);
+        
+        if(didFindPID)
+        {
+            bool didChangePID = theEnabled ?
+                    mMixMinusProcessIDs.insert(theAppPID).second :
+                    (mMixMinusProcessIDs.erase(theAppPID) != 0);
+            
+            if(didChangePID)
+            {
+                DebugMsg("BGM_Clients::SetMixMinusApps: %s mix-minus for PID %d",
+                         (theEnabled ? "Enabling" : "Disabling"),
+                         theAppPID);
+                mClientMap.SetClientsMixMinus(theAppPID, theEnabled);
+                didChange = true;
+            }
+        }
         
-        // Read the last inNumFrames that were written, with a small safety margin
-        // Offset of 1 means "the most recently written frame"
-        // Offset of inNumFrames means "the oldest of the last inNumFrames frames"
-        for(UInt32 frame = 0; frame < inNumFrames; frame++)
+        if(theAppBundleID.IsValid())
         {
-            // For frame 0 (first output frame), read the oldest available data
-            // For frame inNumFrames-1 (last output frame), read the newest data
-            // sampleOffset = inNumFrames - frame means:
-            //   frame 0 -> offset inNumFrames (oldest)
-            //   frame inNumFrames-1 -> offset 1 (newest)
-            UInt64 sampleOffset = inNumFrames - frame;
+            // Copy the bundle ID, since the one from the dictionary isn't retained.
+            CACFString theBundleIDCopy(theAppBundleID.CopyCFString());
             
-            // Fetch left and right channels
-            Float32 leftSample = sourceClient->FetchFromRoutingBuffer(0, sampleOffset);
-            Float32 rightSample = sourceClient->FetchFromRoutingBuffer(1, sampleOffset);
+            bool didChangeBundleID = theEnabled ?
+                    mMixMinusBundleIDs.insert(theBundleIDCopy).second :
+                    (mMixMinusBundleIDs.erase(theBundleIDCopy) != 0);
             
-            // Mix with gain
-            ioBuffer[frame * 2] += leftSample * gain;
-            ioBuffer[frame * 2 + 1] += rightSample * gain;
+            if(didChangeBundleID)
+            {
+                DebugMsg("BGM_Clients::SetMixMinusApps: %s mix-minus for bundle ID %s",
+                         (theEnabled ? "Enabling" : "Disabling"),
+                         CFStringGetCStringPtr(theBundleIDCopy.GetCFString(), kCFStringEncodingUTF8));
+                mClientMap.SetClientsMixMinus(theBundleIDCopy, theEnabled);
+                didChange = true;
+            }
+        }
+    }
+    
+    return didChange;
+}
+
+#pragma mark App Priorities
+
+CACFArray   BGM_Clients::CopyAppPrioritiesAsArray() const
+{
+    CAMutex::Locker theLocker(mMutex);
+    
+    CACFArray theAppPriorities(false);
+    
+    for(auto& thePriorityEntry : mPriorityByProcessID)
+    {
+        CACFDictionary theApp(true);
+        theApp.AddSInt32(CFSTR(kBGMAppPriorityKey_ProcessID), thePriorityEntry.first);
+        theApp.AddSInt32(CFSTR(kBGMAppPriorityKey_Priority), thePriorityEntry.second);
+        theAppPriorities.AppendDictionary(theApp.GetDict());
+    }
+    
+    for(auto& thePriorityEntry : mPriorityByBundleID)
+    {
+        CACFDictionary theApp(true);
+        theApp.AddString(CFSTR(kBGMAppPriorityKey_BundleID), thePriorityEntry.first.GetCFString());
+        theApp.AddSInt32(CFSTR(kBGMAppPriorityKey_Priority), thePriorityEntry.second);
+        theAppPriorities.AppendDictionary(theApp.GetDict());
+    }
+    
+    return theAppPriorities;
+}
+
+bool    BGM_Clients::SetAppPriorities(const CACFArray inAppPriorities)
+{
+    CAMutex::Locker theLocker(mMutex);
+    
+    // Parse the whole array before changing anything, so an invalid app doesn't leave the
+    // priorities half set.
+    std::map<pid_t, BGMAppPriority> thePriorityByProcessID = mPriorityByProcessID;
+    std::map<CACFString, BGMAppPriority> thePriorityByBundleID = mPriorityByBundleID;
+    
+    for(UInt32 i = 0; i < inAppPriorities.GetNumberItems(); i++)
+    {
+        CACFDictionary theApp(false);
+        inAppPriorities.GetCACFDictionary(i, theApp);
+        
+        pid_t theAppPID;
+        bool didFindPID = theApp.IsValid() &&
+                          theApp.GetSInt32(CFSTR(kBGMAppPriorityKey_ProcessID), theAppPID);
+        
+        CACFString theAppBundleID;
+        theAppBundleID.DontAllowRelease();
+        if(theApp.IsValid())
+        {
+            theApp.GetCACFString(CFSTR(kBGMAppPriorityKey_BundleID), theAppBundleID);
+        }
+        
+        ThrowIf(!didFindPID && !theAppBundleID.IsValid(),
+                BGM_InvalidClientException(),
+                "BGM_Clients::SetAppPriorities: App was sent without PID or bundle ID");
+        
+        SInt32 thePriority;
+        bool didFindPriority = theApp.GetSInt32(CFSTR(kBGMAppPriorityKey_Priority), thePriority);
+        
+        ThrowIf(!didFindPriority ||
+                (thePriority != kBGMAppPriorityLow &&
+                 thePriority != kBGMAppPriorityNormal &&
+                 thePriority != kBGMAppPriorityHigh),
+                BGM_InvalidClientException(),
+                "BGM_Clients::SetAppPriorities: App was sent without a valid priority");
+        
+        // Normal priority is the default, so it's stored by removing the app.
+        if(didFindPID)
+        {
+            if(thePriority == kBGMAppPriorityNormal)
+            {
+                thePriorityByProcessID.erase(theAppPID);
+            }
+            else
+            {
+                thePriorityByProcessID[theAppPID] = static_cast<BGMAppPriority>(thePriority);
+            }
         }
         
-        // Debug logging
-        static int mixCount = 0;
-        if(mixCount++ % 1000 == 0)
+        if(theAppBundleID.IsValid())
         {
-            DebugMsg("BGM_Clients::MixRoutedAudioRT: Mixed %u frames from PID %d to client %u (PID %d)",
-                     inNumFrames, route.mSourcePID, inClientID, destPID);
+            // Copy the bundle ID, since the one from the dictionary isn't retained.
+            CACFString theBundleIDCopy(theAppBundleID.CopyCFString());
+            
+            if(thePriority == kBGMAppPriorityNormal)
+            {
+                thePriorityByBundleID.erase(theBundleIDCopy);
+            }
+            else
+            {
+                thePriorityByBundleID[theBundleIDCopy] = static_cast<BGMAppPriority>(thePriority);
+            }
         }
     }
     
-    // Debug: if we expected routes but found none
-    static int noRouteCount = 0;
-    if(routeCount == 0 && noRouteCount++ % 1000 == 0)
+    if(thePriorityByProcessID == mPriorityByProcessID && thePriorityByBundleID == mPriorityByBundleID)
     {
-        DebugMsg("BGM_Clients::MixRoutedAudioRT: No routes found for client %u (PID %d), total routes: %zu",
-                 inClientID, destPID, mRoutes.size());
+        return false;
     }
+    
+    mPriorityByProcessID.swap(thePriorityByProcessID);
+    mPriorityByBundleID.swap(thePriorityByBundleID);
+    
+    mClientMap.UpdateClients([&] (BGM_Client& ioClient) {
+        ioClient.mPriority = GetAppPriority(ioClient);
+    });
+    
+    return true;
 }
 
-bool    BGM_Clients::HasIncomingRoutesRT(UInt32 inClientID) const
+BGMAppPriority  BGM_Clients::GetClientPriorityRT(UInt32 inClientID) const
 {
-    // Get the client to find its process ID
     BGM_Client* theClient = mClientMap.GetClientPtrRT(inClientID);
-    if(!theClient)
+    return (theClient != nullptr) ? theClient->mPriority : kBGMAppPriorityNormal;
+}
+
+BGMAppPriority  BGM_Clients::GetAppPriority(const BGM_Client& inClient) const
+{
+    auto thePIDItr = mPriorityByProcessID.find(inClient.mProcessID);
+    
+    if(thePIDItr != mPriorityByProcessID.end())
     {
-        DebugMsg("BGM_Clients::HasIncomingRoutesRT: No client found for clientID %u", inClientID);
-        return false;
+        return thePIDItr->second;
+    }
+    
+    if(inClient.mBundleID.IsValid())
+    {
+        auto theBundleIDItr = mPriorityByBundleID.find(inClient.mBundleID);
+        
+        if(theBundleIDItr != mPriorityByBundleID.end())
+        {
+            return theBundleIDItr->second;
+        }
     }
     
-    pid_t clientPID = theClient->mProcessID;
+    return kBGMAppPriorityNormal;
+}
+
+#pragma mark Capture Filters
+
+// The size of each filtered capture submix. The same as BGMDevice's loopback ring buffer, since
+// readers read their submixes at the same sample times they would read the loopback audio.
+static const UInt32 kCaptureSubmixFrameSize = 16384;
+
+CACFArray   BGM_Clients::CopyCaptureFiltersAsArray() const
+{
+    CAMutex::Locker theLocker(mMutex);
+    
+    CACFArray theCaptureFilters(false);
     
-    // Check if any enabled routes target this client
-    for(const auto& route : mRoutes)
+    for(auto& theFilterEntry : mCaptureFilters)
     {
-        if(route.mEnabled && route.mDestPID == clientPID)
+        CACFArray theApps(true);
+        for(const CACFString& theApp : theFilterEntry.second.mApps)
         {
-            DebugMsg("BGM_Clients::HasIncomingRoutesRT: Client %u (PID %d) HAS incoming route from PID %d",
-                     inClientID, clientPID, route.mSourcePID);
-            return true;
+            theApps.AppendString(theApp.GetCFString());
         }
+        
+        CACFDictionary theFilter(true);
+        theFilter.AddString(CFSTR(kBGMCaptureFilterKey_ReaderBundleID),
+                            theFilterEntry.first.GetCFString());
+        theFilter.AddSInt32(CFSTR(kBGMCaptureFilterKey_Mode), theFilterEntry.second.mMode);
+        theFilter.AddArray(CFSTR(kBGMCaptureFilterKey_Apps), theApps.GetCFArray());
+        theCaptureFilters.AppendDictionary(theFilter.GetDict());
     }
     
-    return false;
+    return theCaptureFilters;
+}
+
+bool    BGM_Clients::SetCaptureFilters(const CACFArray inCaptureFilters)
+{
+    CAMutex::Locker theLocker(mMutex);
+    
+    // Parse and validate every filter before changing anything, so an invalid filter doesn't leave
+    // the property partly set.
+    std::map<CACFString, BGM_CaptureFilter> theNewFilters = mCaptureFilters;
+    
+    for(UInt32 i = 0; i < inCaptureFilters.GetNumberItems(); i++)
+    {
+        CACFDictionary theFilterDict(false);
+        inCaptureFilters.GetCACFDictionary(i, theFilterDict);
+        
+        CACFString theReaderBundleID;
+        theReaderBundleID.DontAllowRelease();
+        SInt32 theMode = kBGMCaptureFilterModeNone;
+        bool didFindMode = false;
+        
+        if(theFilterDict.IsValid())
+        {
+            theFilterDict.GetCACFString(CFSTR(kBGMCaptureFilterKey_ReaderBundleID), theReaderBundleID);
+            didFindMode = theFilterDict.GetSInt32(CFSTR(kBGMCaptureFilterKey_Mode), theMode);
+        }
+        
+        ThrowIf(!theReaderBundleID.IsValid() || !didFindMode,
+                BGM_InvalidClientException(),
+                "BGM_Clients::SetCaptureFilters: Filter was sent without a reader bundle ID or mode");
+        ThrowIf(theMode != kBGMCaptureFilterModeNone &&
+                        theMode != kBGMCaptureFilterModeExclude &&
+                        theMode != kBGMCaptureFilterModeInclude,
+                BGM_InvalidClientException(),
+                "BGM_Clients::SetCaptureFilters: Unknown capture filter mode");
+        
+        // Copy the bundle ID, since the one from the dictionary isn't retained.
+        CACFString theReaderBundleIDCopy(theReaderBundleID.CopyCFString());
+        
+        if(theMode == kBGMCaptureFilterModeNone)
+        {
+            theNewFilters.erase(theReaderBundleIDCopy);
+            continue;
+        }
+        
+        BGM_CaptureFilter theFilter;
+        theFilter.mMode = static_cast<BGMCaptureFilterMode>(theMode);
+        
+        // The array is owned by the dictionary
+        CACFArray theApps(static_cast<CFArrayRef>(nullptr), false);
+        theFilterDict.GetCACFArray(CFSTR(kBGMCaptureFilterKey_Apps), theApps);
+        
+        for(UInt32 j = 0; theApps.IsValid() && j < theApps.GetNumberItems(); j++)
+        {
+            CFStringRef theApp = nullptr;
+            if(theApps.GetString(j, theApp) && theApp != nullptr)
+            {
+                CFRetain(theApp);
+                theFilter.mApps.insert(CACFString(theApp));
+            }
+        }
+        
+        theNewFilters[theReaderBundleIDCopy] = theFilter;
+    }
+    
+    if(theNewFilters == mCaptureFilters)
+    {
+        return false;
+    }
+    
+    DebugMsg("BGM_Clients::SetCaptureFilters: %lu capture filters set", theNewFilters.size());
+    
+    mCaptureFilters.swap(theNewFilters);
+    UpdateCaptureSubmixes();
+    
+    return true;
+}
+
+void    BGM_Clients::UpdateCaptureSubmixes()
+{
+    // Work out which submixes we need. Keep the ones we already have, so their readers don't get a
+    // gap in their audio.
+    std::map<BGM_CaptureFilter, std::unique_ptr<BGM_SampleTimeRingBuffer>> theSubmixes;
+    
+    for(auto& theFilterEntry : mCaptureFilters)
+    {
+        const BGM_CaptureFilter& theFilter = theFilterEntry.second;
+        
+        if(theFilter.IsFiltering() &&
+           theSubmixes.count(theFilter) == 0 &&
+           mClientMap.HasClientWithBundleID(theFilterEntry.first))
+        {
+            auto theExistingSubmix = mCaptureSubmixes.find(theFilter);
+            
+            if(theExistingSubmix != mCaptureSubmixes.end())
+            {
+                theSubmixes[theFilter] = std::move(theExistingSubmix->second);
+            }
+            else
+            {
+                theSubmixes[theFilter].reset(new BGM_SampleTimeRingBuffer(kCaptureSubmixFrameSize));
+            }
+        }
+    }
+    
+    // Point each client at the submix it reads, if it's a reader, and the submixes it contributes to.
+    mClientMap.UpdateClients([&] (BGM_Client& ioClient) {
+        ioClient.mCaptureSubmix = nullptr;
+        
+        if(ioClient.mBundleID.IsValid())
+        {
+            auto theFilterItr = mCaptureFilters.find(ioClient.mBundleID);
+            
+            if(theFilterItr != mCaptureFilters.end())
+            {
+                auto theSubmixItr = theSubmixes.find(theFilterItr->second);
+                
+                if(theSubmixItr != theSubmixes.end())
+                {
+                    ioClient.mCaptureSubmix = theSubmixItr->second.get();
+                }
+            }
+        }
+        
+        ioClient.mCaptureSubmixContributions.clear();
+        
+        for(auto& theSubmixEntry : theSubmixes)
+        {
+            if(theSubmixEntry.first.Accepts(ioClient.mBundleID))
+            {
+                ioClient.mCaptureSubmixContributions.push_back(theSubmixEntry.second.get());
+            }
+        }
+    });
+    
+    // No clients refer to the submixes we don't need anymore now, so they can be freed.
+    mCaptureSubmixes.swap(theSubmixes);
+}
+
+#pragma mark Crossfader
+
+CACFDictionary  BGM_Clients::CopyCrossfaderAsDictionary() const
+{
+    CAMutex::Locker theLocker(mMutex);
+    
+    CACFArray theGroupA(true);
+    for(const CACFString& theApp : mCrossfader.mGroupA)
+    {
+        theGroupA.AppendString(theApp.GetCFString());
+    }
+    
+    CACFArray theGroupB(true);
+    for(const CACFString& theApp : mCrossfader.mGroupB)
+    {
+        theGroupB.AppendString(theApp.GetCFString());
+    }
+    
+    CACFDictionary theCrossfader(false);
+    theCrossfader.AddArray(CFSTR(kBGMCrossfaderKey_GroupA), theGroupA.GetCFArray());
+    theCrossfader.AddArray(CFSTR(kBGMCrossfaderKey_GroupB), theGroupB.GetCFArray());
+    theCrossfader.AddFloat32(CFSTR(kBGMCrossfaderKey_Position), mCrossfader.mPosition);
+    theCrossfader.AddSInt32(CFSTR(kBGMCrossfaderKey_Curve), mCrossfader.mCurve);
+    
+    return theCrossfader;
+}
+
+bool    BGM_Clients::SetCrossfader(const CACFDictionary inCrossfader)
+{
+    CAMutex::Locker theLocker(mMutex);
+    
+    ThrowIf(!inCrossfader.IsValid(),
+            BGM_InvalidClientException(),
+            "BGM_Clients::SetCrossfader: Invalid dictionary");
+    
+    // Parse and validate the new settings before changing anything.
+    BGM_Crossfader theNewCrossfader = mCrossfader;
+    
+    auto theReadGroup = [&] (CFStringRef inKey, std::set<CACFString>& outGroup) {
+        // The array is owned by the dictionary
+        CACFArray theApps(static_cast<CFArrayRef>(nullptr), false);
+        inCrossfader.GetCACFArray(inKey, theApps);
+        
+        if(theApps.IsValid())
+        {
+            outGroup.clear();
+            
+            for(UInt32 i = 0; i < theApps.GetNumberItems(); i++)
+            {
+                CFStringRef theApp = nullptr;
+                if(theApps.GetString(i, theApp) && theApp != nullptr)
+                {
+                    CFRetain(theApp);
+                    outGroup.insert(CACFString(theApp));
+                }
+            }
+        }
+    };
+    
+    theReadGroup(CFSTR(kBGMCrossfaderKey_GroupA), theNewCrossfader.mGroupA);
+    theReadGroup(CFSTR(kBGMCrossfaderKey_GroupB), theNewCrossfader.mGroupB);
+    
+    for(const CACFString& theApp : theNewCrossfader.mGroupA)
+    {
+        ThrowIf(theNewCrossfader.mGroupB.count(theApp) != 0,
+                BGM_InvalidClientException(),
+                "BGM_Clients::SetCrossfader: App is in both groups");
+    }
+    
+    Float32 thePosition;
+    if(inCrossfader.GetFloat32(CFSTR(kBGMCrossfaderKey_Position), thePosition))
+    {
+        theNewCrossfader.mPosition = std::min(1.0f, std::max(-1.0f, thePosition));
+    }
+    
+    SInt32 theCurve;
+    if(inCrossfader.GetSInt32(CFSTR(kBGMCrossfaderKey_Curve), theCurve))
+    {
+        ThrowIf(theCurve != kBGMCrossfaderCurveLinear &&
+                        theCurve != kBGMCrossfaderCurveEqualPower &&
+                        theCurve != kBGMCrossfaderCurveCut,
+                BGM_InvalidClientException(),
+                "BGM_Clients::SetCrossfader: Unknown crossfader curve");
+        
+        theNewCrossfader.mCurve = static_cast<BGMCrossfaderCurve>(theCurve);
+    }
+    
+    if(theNewCrossfader == mCrossfader)
+    {
+        return false;
+    }
+    
+    mCrossfader = theNewCrossfader;
+    UpdateCrossfadeRamps();
+    
+    return true;
+}
+
+void    BGM_Clients::SetSampleRate(Float64 inSampleRate)
+{
+    CAMutex::Locker theLocker(mMutex);
+    
+    mSampleRate = inSampleRate;
+    mHostTicksPerFrame = CAHostTimeBase::GetFrequency() / mSampleRate;
+    
+    for(auto& theRampEntry : mCrossfadeRamps)
+    {
+        theRampEntry.second->SetTimeConstant(kCrossfadeRampTimeConstantSecs, mSampleRate);
+    }
+    
+    mDucker.SetSampleRate(mSampleRate);
+    
+    for(auto& theClassifierEntry : mSignalClassifiers)
+    {
+        theClassifierEntry.second->SetSampleRate(mSampleRate);
+    }
+    
+    for(auto& theMeterEntry : mLoudnessMeters)
+    {
+        theMeterEntry.second->SetSampleRate(mSampleRate);
+    }
+}
+
+void    BGM_Clients::UpdateCrossfadeRamps()
+{
+    Float32 theGainA = mCrossfader.GetGain(BGM_Crossfader::kSideA);
+    Float32 theGainB = mCrossfader.GetGain(BGM_Crossfader::kSideB);
+    
+    // Find the clients in the groups through the bundle ID index. Keep the ramps they already have,
+    // so their gains move smoothly from where they are now.
+    std::map<UInt32, std::unique_ptr<BGM_GainRamp>> theRamps;
+    bool didChangeMembers = false;
+    
+    auto theAddGroup = [&] (const std::set<CACFString>& inGroup, Float32 inGain) {
+        for(const CACFString& theApp : inGroup)
+        {
+            for(UInt32 theClientID : mClientMap.GetClientIDsNonRT(theApp))
+            {
+                auto theExistingRamp = mCrossfadeRamps.find(theClientID);
+                
+                if(theExistingRamp != mCrossfadeRamps.end())
+                {
+                    theRamps[theClientID] = std::move(theExistingRamp->second);
+                }
+                else
+                {
+                    // New members start at their gain instead of fading in from unity.
+                    theRamps[theClientID].reset(new BGM_GainRamp(inGain,
+                                                                 kCrossfadeRampTimeConstantSecs,
+                                                                 mSampleRate));
+                    didChangeMembers = true;
+                }
+                
+                theRamps[theClientID]->SetTargetGain(inGain);
+            }
+        }
+    };
+    
+    theAddGroup(mCrossfader.mGroupA, theGainA);
+    theAddGroup(mCrossfader.mGroupB, theGainB);
+    
+    didChangeMembers = didChangeMembers || (theRamps.size() != mCrossfadeRamps.size());
+    
+    if(didChangeMembers)
+    {
+        mClientMap.UpdateClients([&] (BGM_Client& ioClient) {
+            auto theRampItr = theRamps.find(ioClient.mClientID);
+            ioClient.mCrossfadeRamp = (theRampItr != theRamps.end()) ? theRampItr->second.get() : nullptr;
+        });
+    }
+    
+    // No clients refer to the ramps of clients that have left the groups now, so they can be freed.
+    mCrossfadeRamps.swap(theRamps);
+}
+
+void    BGM_Clients::ApplyCrossfaderGainRT(UInt32 inClientID,
+                                           Float32* ioBuffer,
+                                           UInt32 inNumFrames) const
+{
+    BGM_Client* theClient = mClientMap.GetClientPtrRT(inClientID);
+    
+    if(theClient != nullptr && theClient->mCrossfadeRamp != nullptr)
+    {
+        theClient->mCrossfadeRamp->ApplyRT(ioBuffer, inNumFrames);
+    }
+}
+
+
+#pragma mark Scheduled Automation
+
+CACFArray   BGM_Clients::CopyAppAutomationAsArray() const
+{
+    CAMutex::Locker theLocker(mMutex);
+    
+    UInt64 theNow = CAHostTimeBase::GetCurrentTime();
+    CACFArray theEvents(false);
+    
+    auto theAddEvents = [&] (const std::vector<BGM_AppAutomationEvent>& inSchedule,
+                             const std::function<void(CACFDictionary&)>& inAddApp) {
+        for(const BGM_AppAutomationEvent& theEvent : inSchedule)
+        {
+            if(theEvent.mHostTime > theNow)
+            {
+                CACFDictionary theEventDict(true);
+                inAddApp(theEventDict);
+                theEventDict.AddSInt64(CFSTR(kBGMAppAutomationKey_HostTime),
+                                       static_cast<SInt64>(theEvent.mHostTime));
+                theEventDict.AddFloat32(CFSTR(kBGMAppAutomationKey_GainDB), theEvent.mGainDB);
+                theEventDict.AddFloat32(CFSTR(kBGMAppAutomationKey_RampMillis), theEvent.mRampMillis);
+                theEvents.AppendDictionary(theEventDict.GetDict());
+            }
+        }
+    };
+    
+    for(auto& theScheduleEntry : mAppAutomationByProcessID)
+    {
+        theAddEvents(theScheduleEntry.second, [&] (CACFDictionary& ioEventDict) {
+            ioEventDict.AddSInt32(CFSTR(kBGMAppAutomationKey_ProcessID), theScheduleEntry.first);
+        });
+    }
+    
+    for(auto& theScheduleEntry : mAppAutomationByBundleID)
+    {
+        theAddEvents(theScheduleEntry.second, [&] (CACFDictionary& ioEventDict) {
+            ioEventDict.AddString(CFSTR(kBGMAppAutomationKey_BundleID),
+                                  theScheduleEntry.first.GetCFString());
+        });
+    }
+    
+    return theEvents;
+}
+
+bool    BGM_Clients::SetAppAutomation(const CACFArray inEvents)
+{
+    CAMutex::Locker theLocker(mMutex);
+    
+    UInt64 theNow = CAHostTimeBase::GetCurrentTime();
+    
+    // Parse the events and group them by app.
+    std::map<pid_t, std::vector<BGM_AppAutomationEvent>> theEventsByProcessID;
+    std::map<CACFString, std::vector<BGM_AppAutomationEvent>> theEventsByBundleID;
+    
+    for(UInt32 i = 0; i < inEvents.GetNumberItems(); i++)
+    {
+        CACFDictionary theEventDict(false);
+        inEvents.GetCACFDictionary(i, theEventDict);
+        
+        ThrowIf(!theEventDict.IsValid(),
+                BGM_InvalidClientException(),
+                "BGM_Clients::SetAppAutomation: Event was not a dictionary");
+        
+        pid_t theAppPID;
+        bool didFindPID = theEventDict.GetSInt32(CFSTR(kBGMAppAutomationKey_ProcessID), theAppPID);
+        
+        CACFString theAppBundleID;
+        theAppBundleID.DontAllowRelease();
+        theEventDict.GetCACFString(CFSTR(kBGMAppAutomationKey_BundleID), theAppBundleID);
+        
+        ThrowIf(!didFindPID && !theAppBundleID.IsValid(),
+                BGM_InvalidClientException(),
+                "BGM_Clients::SetAppAutomation: Event was sent without PID or bundle ID");
+        
+        BGM_AppAutomationEvent theEvent;
+        
+        ThrowIf(!theEventDict.GetFloat32(CFSTR(kBGMAppAutomationKey_GainDB), theEvent.mGainDB) ||
+                        std::isnan(theEvent.mGainDB),
+                BGM_InvalidClientException(),
+                "BGM_Clients::SetAppAutomation: Event was sent without a gain");
+        
+        theEvent.mGainDB = std::min(theEvent.mGainDB, kBGMAppAutomationMaxGainDB);
+        
+        // Default to starting the event now
+        SInt64 theHostTime;
+        theEvent.mHostTime = theEventDict.GetSInt64(CFSTR(kBGMAppAutomationKey_HostTime), theHostTime) ?
+                static_cast<UInt64>(std::max(theHostTime, SInt64(0))) :
+                theNow;
+        
+        theEventDict.GetFloat32(CFSTR(kBGMAppAutomationKey_RampMillis), theEvent.mRampMillis);
+        
+        ThrowIf(!(theEvent.mRampMillis >= 0.0f),
+                BGM_InvalidClientException(),
+                "BGM_Clients::SetAppAutomation: Invalid ramp length");
+        
+        if(didFindPID)
+        {
+            theEventsByProcessID[theAppPID].push_back(theEvent);
+        }
+        else
+        {
+            // Copy the bundle ID, since the one from the dictionary isn't retained.
+            theEventsByBundleID[CACFString(theAppBundleID.CopyCFString())].push_back(theEvent);
+        }
+    }
+    
+    // Clients follow their PID's schedule if it has one, including the ones being set now.
+    auto theFollowsBundleIDSchedule = [&] (UInt32 inClientID) {
+        BGM_Client theClient;
+        return mClientMap.GetClientNonRT(inClientID, &theClient) &&
+               mAppAutomationByProcessID.count(theClient.mProcessID) == 0 &&
+               theEventsByProcessID.count(theClient.mProcessID) == 0;
+    };
+    
+    // Check each app's new events against its schedule and its clients' queues before scheduling
+    // any of them, so invalid events don't leave the schedules partly updated.
+    auto theValidate = [&] (std::vector<BGM_AppAutomationEvent>& ioNewEvents,
+                            std::vector<BGM_AppAutomationEvent>* _Nullable ioSchedule,
+                            const std::vector<UInt32>& inClientIDs) {
+        std::stable_sort(ioNewEvents.begin(),
+                         ioNewEvents.end(),
+                         [] (const BGM_AppAutomationEvent& inA, const BGM_AppAutomationEvent& inB) {
+                             return inA.mHostTime < inB.mHostTime;
+                         });
+        
+        size_t theScheduleSize = 0;
+        
+        if(ioSchedule != nullptr)
+        {
+            PruneAppAutomationSchedule(*ioSchedule, theNow);
+            
+            ThrowIf(!ioSchedule->empty() &&
+                            ioNewEvents.front().mHostTime < ioSchedule->back().mHostTime,
+                    BGM_InvalidClientException(),
+                    "BGM_Clients::SetAppAutomation: Event is earlier than one already scheduled");
+            
+            theScheduleSize = ioSchedule->size();
+        }
+        
+        ThrowIf(theScheduleSize + ioNewEvents.size() > BGM_ParameterAutomation::kMaxPendingEvents,
+                BGM_InvalidClientException(),
+                "BGM_Clients::SetAppAutomation: Too many events scheduled");
+        
+        for(UInt32 theClientID : inClientIDs)
+        {
+            auto theAutomation = mAutomations.find(theClientID);
+            
+            ThrowIf(theAutomation != mAutomations.end() &&
+                            (theAutomation->second->GetPendingEventCount() + ioNewEvents.size() >
+                             BGM_ParameterAutomation::kMaxPendingEvents),
+                    BGM_InvalidClientException(),
+                    "BGM_Clients::SetAppAutomation: Too many events queued");
+        }
+    };
+    
+    std::map<pid_t, std::vector<UInt32>> theClientsByProcessID;
+    std::map<CACFString, std::vector<UInt32>> theClientsByBundleID;
+    
+    for(auto& theEventsEntry : theEventsByProcessID)
+    {
+        auto theSchedule = mAppAutomationByProcessID.find(theEventsEntry.first);
+        std::vector<UInt32>& theClientIDs = theClientsByProcessID[theEventsEntry.first];
+        
+        theClientIDs = mClientMap.GetClientIDsNonRT(theEventsEntry.first);
+        theValidate(theEventsEntry.second,
+                    (theSchedule != mAppAutomationByProcessID.end()) ? &theSchedule->second : nullptr,
+                    theClientIDs);
+    }
+    
+    for(auto& theEventsEntry : theEventsByBundleID)
+    {
+        auto theSchedule = mAppAutomationByBundleID.find(theEventsEntry.first);
+        std::vector<UInt32>& theClientIDs = theClientsByBundleID[theEventsEntry.first];
+        
+        for(UInt32 theClientID : mClientMap.GetClientIDsNonRT(theEventsEntry.first))
+        {
+            if(theFollowsBundleIDSchedule(theClientID))
+            {
+                theClientIDs.push_back(theClientID);
+            }
+        }
+        
+        theValidate(theEventsEntry.second,
+                    (theSchedule != mAppAutomationByBundleID.end()) ? &theSchedule->second : nullptr,
+                    theClientIDs);
+    }
+    
+    // Add the events to the schedules and the clients' queues. Clients without queues get the whole
+    // schedule, so they catch up with the events that have already started.
+    bool didAddAutomations = false;
+    
+    auto theAddToSchedule = [&] (const std::vector<BGM_AppAutomationEvent>& inNewEvents,
+                                 std::vector<BGM_AppAutomationEvent>& ioSchedule,
+                                 const std::vector<UInt32>& inClientIDs) {
+        ioSchedule.insert(ioSchedule.end(), inNewEvents.begin(), inNewEvents.end());
+        
+        for(UInt32 theClientID : inClientIDs)
+        {
+            std::unique_ptr<BGM_ParameterAutomation>& theAutomation = mAutomations[theClientID];
+            const std::vector<BGM_AppAutomationEvent>* theEventsToQueue = &inNewEvents;
+            
+            if(!theAutomation)
+            {
+                theAutomation.reset(new BGM_ParameterAutomation(1.0f));
+                theEventsToQueue = &ioSchedule;
+                didAddAutomations = true;
+            }
+            
+            for(const BGM_AppAutomationEvent& theEvent : *theEventsToQueue)
+            {
+                bool didSchedule = theAutomation->ScheduleEvent(ConvertAppAutomationEvent(theEvent));
+                Assert(didSchedule, "BGM_Clients::SetAppAutomation: Queue full");
+                (void)didSchedule;
+            }
+        }
+    };
+    
+    for(auto& theEventsEntry : theEventsByProcessID)
+    {
+        theAddToSchedule(theEventsEntry.second,
+                         mAppAutomationByProcessID[theEventsEntry.first],
+                         theClientsByProcessID[theEventsEntry.first]);
+    }
+    
+    for(auto& theEventsEntry : theEventsByBundleID)
+    {
+        theAddToSchedule(theEventsEntry.second,
+                         mAppAutomationByBundleID[theEventsEntry.first],
+                         theClientsByBundleID[theEventsEntry.first]);
+    }
+    
+    // Give the clients their new queues. Adding to mAutomations doesn't move the existing queues, so
+    // the clients that already had one can keep using it in the meantime.
+    if(didAddAutomations)
+    {
+        mClientMap.UpdateClients([&] (BGM_Client& ioClient) {
+            auto theAutomation = mAutomations.find(ioClient.mClientID);
+            ioClient.mAutomation =
+                    (theAutomation != mAutomations.end()) ? theAutomation->second.get() : nullptr;
+        });
+    }
+    
+    return !theEventsByProcessID.empty() || !theEventsByBundleID.empty();
+}
+
+void    BGM_Clients::ApplyAppAutomationRT(UInt32 inClientID,
+                                          Float32* ioBuffer,
+                                          UInt32 inNumFrames,
+                                          const AudioTimeStamp& inOutputTime) const
+{
+    BGM_Client* theClient = mClientMap.GetClientPtrRT(inClientID);
+    
+    if(theClient != nullptr && theClient->mAutomation != nullptr)
+    {
+        // The HAL should always give us the host time of the first frame, but fall back to the
+        // current time just in case.
+        Float64 theHostTime = (inOutputTime.mFlags & kAudioTimeStampHostTimeValid) ?
+                static_cast<Float64>(inOutputTime.mHostTime) :
+                static_cast<Float64>(CAHostTimeBase::GetCurrentTime());
+        
+        // The rate scalar corrects for the difference between the device's actual and nominal
+        // sample rates.
+        Float64 theHostTicksPerFrame = mHostTicksPerFrame;
+        
+        if((inOutputTime.mFlags & kAudioTimeStampRateScalarValid) && inOutputTime.mRateScalar > 0.0)
+        {
+            theHostTicksPerFrame *= inOutputTime.mRateScalar;
+        }
+        
+        theClient->mAutomation->ApplyGainRT(ioBuffer,
+                                            inNumFrames,
+                                            inOutputTime.mSampleTime,
+                                            theHostTime,
+                                            theHostTicksPerFrame);
+    }
+}
+
+const std::vector<BGM_AppAutomationEvent>* _Nullable
+BGM_Clients::GetAppAutomationSchedule(const BGM_Client& inClient) const
+{
+    auto theProcessIDSchedule = mAppAutomationByProcessID.find(inClient.mProcessID);
+    
+    if(theProcessIDSchedule != mAppAutomationByProcessID.end())
+    {
+        return &theProcessIDSchedule->second;
+    }
+    
+    if(inClient.mBundleID.IsValid())
+    {
+        auto theBundleIDSchedule = mAppAutomationByBundleID.find(inClient.mBundleID);
+        
+        if(theBundleIDSchedule != mAppAutomationByBundleID.end())
+        {
+            return &theBundleIDSchedule->second;
+        }
+    }
+    
+    return nullptr;
+}
+
+void    BGM_Clients::PruneAppAutomationSchedule(std::vector<BGM_AppAutomationEvent>& ioSchedule,
+                                                UInt64 inNow)
+{
+    // Find the first event that hasn't started.
+    auto theFirstPending = std::upper_bound(ioSchedule.begin(),
+                                            ioSchedule.end(),
+                                            inNow,
+                                            [] (UInt64 inTime, const BGM_AppAutomationEvent& inEvent) {
+                                                return inTime < inEvent.mHostTime;
+                                            });
+    
+    if(theFirstPending != ioSchedule.begin())
+    {
+        ioSchedule.erase(ioSchedule.begin(), theFirstPending - 1);
+    }
+}
+
+BGM_ParameterAutomation::Event  BGM_Clients::ConvertAppAutomationEvent(const BGM_AppAutomationEvent& inEvent) const
+{
+    BGM_ParameterAutomation::Event theEvent;
+    
+    theEvent.mTime = static_cast<Float64>(inEvent.mHostTime);
+    theEvent.mValue = (inEvent.mGainDB <= kBGMAppAutomationMinGainDB) ?
+            0.0f :
+            std::pow(10.0f, inEvent.mGainDB / 20.0f);
+    
+    Float64 theRampFrames = std::round(inEvent.mRampMillis / 1000.0 * mSampleRate);
+    theEvent.mRampFrames = static_cast<UInt32>(std::min(theRampFrames, Float64(UINT32_MAX)));
+    
+    return theEvent;
+}
+
+#pragma mark Scenes
+
+CACFDictionary  BGM_Clients::CopySceneAsDictionary() const
+{
+    CACFDictionary theScene(false);
+    
+    // The arrays are retained by the dictionary, so release our references to them.
+    CFArrayRef theAppVolumes = CopyClientRelativeVolumesAsAppVolumes().GetCFArray();
+    theScene.AddArray(CFSTR(kBGMSceneKey_AppVolumes), theAppVolumes);
+    CFRelease(theAppVolumes);
+    
+    CFArrayRef theRoutes = CopyRoutesAsArray();
+    
+    if(theRoutes != nullptr)
+    {
+        theScene.AddArray(CFSTR(kBGMSceneKey_Routes), theRoutes);
+        CFRelease(theRoutes);
+    }
+    
+    CAMutex::Locker theLocker(mMutex);
+    
+    if(mMusicPlayerProcessIDProperty != 0)
+    {
+        theScene.AddSInt32(CFSTR(kBGMSceneKey_MusicPlayerProcessID), mMusicPlayerProcessIDProperty);
+    }
+    else if(mMusicPlayerBundleIDProperty != "")
+    {
+        theScene.AddString(CFSTR(kBGMSceneKey_MusicPlayerBundleID),
+                           mMusicPlayerBundleIDProperty.GetCFString());
+    }
+    
+    return theScene;
+}
+
+bool    BGM_Clients::SetScene(const CACFDictionary inScene)
+{
+    CAMutex::Locker theLocker(mMutex);
+    
+    ThrowIf(!inScene.IsValid(),
+            BGM_InvalidClientException(),
+            "BGM_Clients::SetScene: Invalid dictionary");
+    
+    // Read and validate the whole scene before changing anything.
+    
+    // The apps' settings. The arrays are owned by the dictionary.
+    CACFArray theAppVolumes(static_cast<CFArrayRef>(nullptr), false);
+    inScene.GetCACFArray(CFSTR(kBGMSceneKey_AppVolumes), theAppVolumes);
+    
+    std::vector<BGM_AppVolumeSettings> theAppSettings;
+    
+    for(UInt32 i = 0; theAppVolumes.IsValid() && i < theAppVolumes.GetNumberItems(); i++)
+    {
+        CACFDictionary theAppVolume(false);
+        theAppVolumes.GetCACFDictionary(i, theAppVolume);
+        
+        ThrowIf(!theAppVolume.IsValid(),
+                BGM_InvalidClientException(),
+                "BGM_Clients::SetScene: App settings weren't a dictionary");
+        
+        theAppSettings.push_back(ParseAppVolumeSettings(theAppVolume));
+    }
+    
+    CACFArray theRoutes(static_cast<CFArrayRef>(nullptr), false);
+    inScene.GetCACFArray(CFSTR(kBGMSceneKey_Routes), theRoutes);
+    
+    pid_t theMusicPlayerPID = 0;
+    bool hasMusicPlayerPID =
+        inScene.GetSInt32(CFSTR(kBGMSceneKey_MusicPlayerProcessID), theMusicPlayerPID);
+    
+    CACFString theMusicPlayerBundleID;
+    inScene.GetCACFString(CFSTR(kBGMSceneKey_MusicPlayerBundleID), theMusicPlayerBundleID);
+    bool hasMusicPlayerBundleID = theMusicPlayerBundleID.IsValid();
+    
+    ThrowIf(hasMusicPlayerPID && theMusicPlayerPID < 0,
+            BGM_InvalidClientPIDException(),
+            "BGM_Clients::SetScene: Invalid music player PID");
+    ThrowIf(hasMusicPlayerPID && hasMusicPlayerBundleID,
+            BGM_InvalidClientException(),
+            "BGM_Clients::SetScene: The music player can't be set by both PID and bundle ID");
+    
+    Float32 theMorphMillis = 0.0f;
+    inScene.GetFloat32(CFSTR(kBGMSceneKey_MorphMillis), theMorphMillis);
+    
+    ThrowIf(!(theMorphMillis >= 0.0f && theMorphMillis <= kBGMSceneMaxMorphMillis),
+            BGM_InvalidClientException(),
+            "BGM_Clients::SetScene: Invalid morph time");
+    
+    if(theAppSettings.empty() && !theRoutes.IsValid() && !hasMusicPlayerPID && !hasMusicPlayerBundleID)
+    {
+        return false;
+    }
+    
+    // Work out where each client in the scene is now and where the scene moves it to. An app's
+    // settings apply to its clients with the app's PID or bundle ID. If the scene lists an app
+    // more than once, the later settings win.
+    std::map<UInt32, BGM_SceneMorph::Parameters> theStartParameters;
+    std::map<UInt32, BGM_SceneMorph::Parameters> theTargetParameters;
+    
+    for(const BGM_AppVolumeSettings& theSettings : theAppSettings)
+    {
+        std::vector<UInt32> theClientIDs = mClientMap.GetClientIDsNonRT(theSettings.mProcessID);
+        
+        if(theSettings.mBundleID.IsValid())
+        {
+            for(UInt32 theClientID : mClientMap.GetClientIDsNonRT(theSettings.mBundleID))
+            {
+                if(std::find(theClientIDs.begin(), theClientIDs.end(), theClientID) == theClientIDs.end())
+                {
+                    theClientIDs.push_back(theClientID);
+                }
+            }
+        }
+        
+        for(UInt32 theClientID : theClientIDs)
+        {
+            BGM_Client theClient;
+            
+            if(!mClientMap.GetClientNonRT(theClientID, &theClient))
+            {
+                continue;
+            }
+            
+            if(theTargetParameters.count(theClientID) == 0)
+            {
+                theStartParameters[theClientID] = GetSceneParameters(theClient);
+                theTargetParameters[theClientID] = theStartParameters[theClientID];
+            }
+            
+            BGM_SceneMorph::Parameters& theTarget = theTargetParameters[theClientID];
+            
+            if(theSettings.mHasRelativeVolume)
+            {
+                theTarget.mRawVolume = static_cast<Float32>(theSettings.mRawRelativeVolume);
+            }
+            
+            if(theSettings.mHasPanPosition)
+            {
+                theTarget.mPanPosition = static_cast<Float32>(theSettings.mPanPosition);
+            }
+            
+            for(UInt32 i = 0; i < BGM_SceneMorph::kEQBands; i++)
+            {
+                if(theSettings.mEQGainsDB[i] != kAppEQGainNoValue)
+                {
+                    theTarget.mEQGains[i] = theSettings.mEQGainsDB[i];
+                }
+            }
+        }
+    }
+    
+    // Create the clients' morphs. The clients that aren't in this scene keep the morphs they have.
+    std::map<UInt32, std::unique_ptr<BGM_SceneMorph>> theSceneMorphs;
+    
+    for(auto& theMorphEntry : mSceneMorphs)
+    {
+        if(theTargetParameters.count(theMorphEntry.first) == 0 && !theMorphEntry.second->IsFinished())
+        {
+            theSceneMorphs[theMorphEntry.first] = std::move(theMorphEntry.second);
+        }
+    }
+    
+    UInt32 theMorphFrames =
+        static_cast<UInt32>(std::llround(theMorphMillis / 1000.0 * mSampleRate));
+    
+    if(theMorphFrames > 0)
+    {
+        for(const auto& theTargetEntry : theTargetParameters)
+        {
+            theSceneMorphs[theTargetEntry.first].reset(
+                    new BGM_SceneMorph(theStartParameters[theTargetEntry.first],
+                                       theTargetEntry.second,
+                                       theMorphFrames,
+                                       mSampleRate));
+        }
+    }
+    
+    // Update the music player properties. The clients' flags are updated with everything else.
+    bool didChangeMusicPlayer = false;
+    
+    if(hasMusicPlayerPID && theMusicPlayerPID != mMusicPlayerProcessIDProperty)
+    {
+        mMusicPlayerProcessIDProperty = theMusicPlayerPID;
+        mMusicPlayerBundleIDProperty = "";
+        didChangeMusicPlayer = true;
+    }
+    else if(hasMusicPlayerBundleID && !(theMusicPlayerBundleID == mMusicPlayerBundleIDProperty))
+    {
+        mMusicPlayerBundleIDProperty = theMusicPlayerBundleID;
+        mMusicPlayerProcessIDProperty = 0;
+        didChangeMusicPlayer = true;
+    }
+    
+    // Replace the routes. Their kernels are compiled below.
+    if(theRoutes.IsValid())
+    {
+        mRoutes.clear();
+        UpdateRoutes(theRoutes);
+    }
+    
+    // Publish the scene. The new routing kernels, the clients' settings and morphs and the music
+    // player flags are all published with one update of the client maps, so IO either sees none of
+    // the scene or all of it.
+    CompileRoutingKernels([&] (BGM_Client& ioClient) {
+        auto theTarget = theTargetParameters.find(ioClient.mClientID);
+        
+        if(theTarget != theTargetParameters.end())
+        {
+            SetSceneParameters(theTarget->second, ioClient);
+        }
+        
+        auto theMorph = theSceneMorphs.find(ioClient.mClientID);
+        ioClient.mSceneMorph = (theMorph != theSceneMorphs.end()) ? theMorph->second.get() : nullptr;
+        
+        if(didChangeMusicPlayer)
+        {
+            ioClient.mIsMusicPlayer = IsMusicPlayerClient(ioClient);
+        }
+    });
+    
+    // Neither client map refers to the old morphs now, so they can be freed
+    mSceneMorphs.swap(theSceneMorphs);
+    
+    // Like setting kAudioDeviceCustomPropertyAppVolumes, the scene replaces the values the apps set
+    // in the shared parameter table.
+    for(const BGM_AppVolumeSettings& theSettings : theAppSettings)
+    {
+        if(theSettings.mHasRelativeVolume)
+        {
+            ClearParameterTableValues(theSettings.mProcessID,
+                                      theSettings.mBundleID,
+                                      kBGMParameterRelativeVolume);
+        }
+        
+        if(theSettings.mHasPanPosition)
+        {
+            ClearParameterTableValues(theSettings.mProcessID,
+                                      theSettings.mBundleID,
+                                      kBGMParameterPanPosition);
+        }
+    }
+    
+    return true;
+}
+
+bool    BGM_Clients::GetSceneMorphRT(UInt32 inClientID,
+                                     UInt32 inNumFrames,
+                                     BGM_SceneMorphSegment& outSegment) const
+{
+    BGM_Client* theClient = mClientMap.GetClientPtrRT(inClientID);
+    
+    if(theClient == nullptr || theClient->mSceneMorph == nullptr)
+    {
+        return false;
+    }
+    
+    BGM_SceneMorph::Parameters theStart;
+    BGM_SceneMorph::Parameters theEnd;
+    
+    if(!theClient->mSceneMorph->AdvanceRT(inNumFrames, theStart, theEnd))
+    {
+        return false;
+    }
+    
+    outSegment.mStartVolume = ConvertRawRelativeVolumeToScalarRT(theStart.mRawVolume);
+    outSegment.mEndVolume = ConvertRawRelativeVolumeToScalarRT(theEnd.mRawVolume);
+    outSegment.mStartPan = theStart.mPanPosition / kAppPanRightRawValue;
+    outSegment.mEndPan = theEnd.mPanPosition / kAppPanRightRawValue;
+    
+    // Recalculating the coefficients for every buffer is cheap compared to filtering it, so the EQ
+    // is just stepped. Use the end of the buffer's gains so the last buffer reaches the target.
+    outSegment.mHasEQ = theEnd.mEQGains[0] != 0.0f ||
+                        theEnd.mEQGains[1] != 0.0f ||
+                        theEnd.mEQGains[2] != 0.0f;
+    
+    if(outSegment.mHasEQ)
+    {
+        const Float32 kFrequencies[BGM_SceneMorph::kEQBands] = {
+            BGM_Client::kEQLowFrequency, BGM_Client::kEQMidFrequency, BGM_Client::kEQHighFrequency
+        };
+        
+        for(UInt32 i = 0; i < BGM_SceneMorph::kEQBands; i++)
+        {
+            BGM_Client::ComputeEQCoefficients(theEnd.mEQGains[i],
+                                              kFrequencies[i],
+                                              theClient->mSceneMorph->GetSampleRate(),
+                                              static_cast<int>(i),
+                                              outSegment.mEQCoeffs[i]);
+        }
+    }
+    
+    return true;
+}
+
+BGM_SceneMorph::Parameters  BGM_Clients::GetSceneParameters(const BGM_Client& inClient) const
+{
+    if(inClient.mSceneMorph != nullptr && !inClient.mSceneMorph->IsFinished())
+    {
+        return inClient.mSceneMorph->GetCurrentParameters();
+    }
+    
+    BGM_SceneMorph::Parameters theParameters;
+    
+    // Reverse the volume conversion from SetClientsRelativeVolumes
+    theParameters.mRawVolume =
+        static_cast<Float32>(mRelativeVolumeCurve.ConvertScalarToRaw(inClient.mRelativeVolume / 4));
+    theParameters.mPanPosition = static_cast<Float32>(inClient.mPanPosition);
+    theParameters.mEQGains[0] = inClient.mEQLowGain;
+    theParameters.mEQGains[1] = inClient.mEQMidGain;
+    theParameters.mEQGains[2] = inClient.mEQHighGain;
+    
+    // If the app has set its volume or pan position in the shared parameter table, start from that.
+    BGM_ParameterSlotCache theSlotCache;
+    Float32 theTableValue;
+    
+    if(mParameterTable.GetValueRT(inClient.mProcessID, theSlotCache, kBGMParameterRelativeVolume, theTableValue))
+    {
+        theParameters.mRawVolume = std::min(std::max(theTableValue, static_cast<Float32>(kAppRelativeVolumeMinRawValue)),
+                                            static_cast<Float32>(kAppRelativeVolumeMaxRawValue));
+    }
+    
+    if(mParameterTable.GetValueRT(inClient.mProcessID, theSlotCache, kBGMParameterPanPosition, theTableValue))
+    {
+        theParameters.mPanPosition = std::min(std::max(theTableValue, static_cast<Float32>(kAppPanLeftRawValue)),
+                                              static_cast<Float32>(kAppPanRightRawValue));
+    }
+    
+    return theParameters;
+}
+
+void    BGM_Clients::SetSceneParameters(const BGM_SceneMorph::Parameters& inParameters,
+                                        BGM_Client& ioClient) const
+{
+    ioClient.mRelativeVolume = ConvertRawRelativeVolumeToScalarRT(inParameters.mRawVolume);
+    ioClient.mPanPosition = static_cast<SInt32>(std::lround(inParameters.mPanPosition));
+    
+    ioClient.mEQLowGain = inParameters.mEQGains[0];
+    ioClient.mEQMidGain = inParameters.mEQGains[1];
+    ioClient.mEQHighGain = inParameters.mEQGains[2];
+    
+    BGM_Client::ComputeEQCoefficients(ioClient.mEQLowGain, BGM_Client::kEQLowFrequency, mSampleRate, 0, ioClient.mEQLowCoeffs);
+    BGM_Client::ComputeEQCoefficients(ioClient.mEQMidGain, BGM_Client::kEQMidFrequency, mSampleRate, 1, ioClient.mEQMidCoeffs);
+    BGM_Client::ComputeEQCoefficients(ioClient.mEQHighGain, BGM_Client::kEQHighFrequency, mSampleRate, 2, ioClient.mEQHighCoeffs);
+}
+
+#pragma mark Signal Classification
+
+bool    BGM_Clients::ClassifyClientAudioRT(UInt32 inClientID,
+                                           const Float32* inBuffer,
+                                           UInt32 inNumFrames,
+                                           bool inSkipSpectralFeatures)
+{
+    BGM_Client* theClient = mClientMap.GetClientPtrRT(inClientID);
+    
+    if(theClient == nullptr || theClient->mSignalClassifier == nullptr)
+    {
+        return false;
+    }
+    
+    return theClient->mSignalClassifier->ProcessRT(inBuffer, inNumFrames, inSkipSpectralFeatures) ==
+            BGM_SignalClassifier::kClassSustained;
+}
+
+#pragma mark Loudness
+
+CACFArray   BGM_Clients::CopyLoudnessAsArray() const
+{
+    CAMutex::Locker theLocker(mMutex);
+    
+    CACFArray theLoudness(false);
+    
+    for(auto& theMeterEntry : mLoudnessMeters)
+    {
+        BGM_Client theClient;
+        
+        if(!mClientMap.GetClientNonRT(theMeterEntry.first, &theClient))
+        {
+            continue;
+        }
+        
+        const BGM_LoudnessMeter& theMeter = *theMeterEntry.second;
+        
+        CACFDictionary theClientLoudness(true);
+        theClientLoudness.AddSInt32(CFSTR(kBGMLoudnessKey_ProcessID), theClient.mProcessID);
+        
+        if(theClient.mBundleID.IsValid())
+        {
+            theClientLoudness.AddString(CFSTR(kBGMLoudnessKey_BundleID), theClient.mBundleID.GetCFString());
+        }
+        
+        theClientLoudness.AddFloat32(CFSTR(kBGMLoudnessKey_MomentaryLUFS), theMeter.GetMomentaryLUFS());
+        theClientLoudness.AddFloat32(CFSTR(kBGMLoudnessKey_ShortTermLUFS), theMeter.GetShortTermLUFS());
+        theClientLoudness.AddFloat32(CFSTR(kBGMLoudnessKey_IntegratedLUFS), theMeter.GetIntegratedLUFS());
+        theClientLoudness.AddFloat32(CFSTR(kBGMLoudnessKey_GainDB), theMeter.GetGainDB());
+        
+        theLoudness.AppendDictionary(theClientLoudness.GetDict());
+    }
+    
+    return theLoudness;
+}
+
+CACFDictionary  BGM_Clients::CopyLoudnessNormalizationAsDictionary() const
+{
+    CAMutex::Locker theLocker(mMutex);
+    
+    CACFDictionary theNormalization(false);
+    theNormalization.AddBool(CFSTR(kBGMLoudnessNormalizationKey_Enabled), mLoudnessNormalization.mEnabled);
+    theNormalization.AddFloat32(CFSTR(kBGMLoudnessNormalizationKey_TargetLUFS),
+                                mLoudnessNormalization.mTargetLUFS);
+    theNormalization.AddFloat32(CFSTR(kBGMLoudnessNormalizationKey_MaxSlewDBPerSec),
+                                mLoudnessNormalization.mMaxSlewDBPerSec);
+    theNormalization.AddFloat32(CFSTR(kBGMLoudnessNormalizationKey_MaxGainDB),
+                                mLoudnessNormalization.mMaxGainDB);
+    
+    return theNormalization;
+}
+
+bool    BGM_Clients::SetLoudnessNormalization(const CACFDictionary inNormalization)
+{
+    CAMutex::Locker theLocker(mMutex);
+    
+    ThrowIf(!inNormalization.IsValid(),
+            BGM_InvalidClientException(),
+            "BGM_Clients::SetLoudnessNormalization: Invalid dictionary");
+    
+    // Parse and validate the new settings before changing anything.
+    BGM_LoudnessMeter::Normalization theNewNormalization = mLoudnessNormalization;
+    
+    inNormalization.GetBool(CFSTR(kBGMLoudnessNormalizationKey_Enabled), theNewNormalization.mEnabled);
+    
+    auto theReadNumber = [&] (CFStringRef inKey, Float32 inMin, Float32 inMax, Float32& ioValue) {
+        Float32 theValue;
+        
+        if(inNormalization.GetFloat32(inKey, theValue))
+        {
+            ThrowIf(std::isnan(theValue),
+                    BGM_InvalidClientException(),
+                    "BGM_Clients::SetLoudnessNormalization: Setting was not a number");
+            
+            ioValue = std::min(inMax, std::max(inMin, theValue));
+        }
+    };
+    
+    theReadNumber(CFSTR(kBGMLoudnessNormalizationKey_TargetLUFS),
+                  kBGMLoudnessNormalizationMinTargetLUFS,
+                  0.0f,
+                  theNewNormalization.mTargetLUFS);
+    theReadNumber(CFSTR(kBGMLoudnessNormalizationKey_MaxSlewDBPerSec),
+                  kBGMLoudnessNormalizationMinSlewDBPerSec,
+                  kBGMLoudnessNormalizationMaxSlewDBPerSec,
+                  theNewNormalization.mMaxSlewDBPerSec);
+    theReadNumber(CFSTR(kBGMLoudnessNormalizationKey_MaxGainDB),
+                  0.0f,
+                  kBGMLoudnessNormalizationMaxGainDB,
+                  theNewNormalization.mMaxGainDB);
+    
+    if(theNewNormalization == mLoudnessNormalization)
+    {
+        return false;
+    }
+    
+    mLoudnessNormalization = theNewNormalization;
+    
+    for(auto& theMeterEntry : mLoudnessMeters)
+    {
+        theMeterEntry.second->SetNormalization(mLoudnessNormalization);
+    }
+    
+    return true;
+}
+
+void    BGM_Clients::ApplyLoudnessNormalizationRT(UInt32 inClientID,
+                                                  Float32* ioBuffer,
+                                                  UInt32 inNumFrames)
+{
+    BGM_Client* theClient = mClientMap.GetClientPtrRT(inClientID);
+    
+    if(theClient != nullptr && theClient->mLoudnessMeter != nullptr)
+    {
+        theClient->mLoudnessMeter->ProcessRT(ioBuffer, inNumFrames);
+    }
+}
+
+#pragma mark Ducking
+
+CACFDictionary  BGM_Clients::CopyDuckingAsDictionary() const
+{
+    CAMutex::Locker theLocker(mMutex);
+    
+    const BGM_Ducker::Settings& theSettings = mDucker.GetSettings();
+    
+    CACFArray theTriggers(true);
+    for(const CACFString& theApp : theSettings.mTriggers)
+    {
+        theTriggers.AppendString(theApp.GetCFString());
+    }
+    
+    CACFArray theTargets(true);
+    for(const CACFString& theApp : theSettings.mTargets)
+    {
+        theTargets.AppendString(theApp.GetCFString());
+    }
+    
+    CACFDictionary theDucking(false);
+    theDucking.AddArray(CFSTR(kBGMDuckingKey_Triggers), theTriggers.GetCFArray());
+    theDucking.AddArray(CFSTR(kBGMDuckingKey_Targets), theTargets.GetCFArray());
+    theDucking.AddBool(CFSTR(kBGMDuckingKey_DucksMusicPlayer), theSettings.mDucksMusicPlayer);
+    theDucking.AddBool(CFSTR(kBGMDuckingKey_SustainedTriggersOnly), theSettings.mSustainedTriggersOnly);
+    theDucking.AddFloat32(CFSTR(kBGMDuckingKey_ThresholdDB), theSettings.mThresholdDB);
+    theDucking.AddFloat32(CFSTR(kBGMDuckingKey_DepthDB), theSettings.mDepthDB);
+    theDucking.AddFloat32(CFSTR(kBGMDuckingKey_AttackMillis), theSettings.mAttackMillis);
+    theDucking.AddFloat32(CFSTR(kBGMDuckingKey_HoldMillis), theSettings.mHoldMillis);
+    theDucking.AddFloat32(CFSTR(kBGMDuckingKey_ReleaseMillis), theSettings.mReleaseMillis);
+    
+    return theDucking;
+}
+
+bool    BGM_Clients::SetDucking(const CACFDictionary inDucking)
+{
+    CAMutex::Locker theLocker(mMutex);
+    
+    ThrowIf(!inDucking.IsValid(),
+            BGM_InvalidClientException(),
+            "BGM_Clients::SetDucking: Invalid dictionary");
+    
+    // Parse and validate the new settings before changing anything.
+    BGM_Ducker::Settings theNewSettings = mDucker.GetSettings();
+    
+    auto theReadApps = [&] (CFStringRef inKey, std::set<CACFString>& outApps) {
+        // The array is owned by the dictionary
+        CACFArray theApps(static_cast<CFArrayRef>(nullptr), false);
+        inDucking.GetCACFArray(inKey, theApps);
+        
+        if(theApps.IsValid())
+        {
+            outApps.clear();
+            
+            for(UInt32 i = 0; i < theApps.GetNumberItems(); i++)
+            {
+                CFStringRef theApp = nullptr;
+                if(theApps.GetString(i, theApp) && theApp != nullptr)
+                {
+                    CFRetain(theApp);
+                    outApps.insert(CACFString(theApp));
+                }
+            }
+        }
+    };
+    
+    theReadApps(CFSTR(kBGMDuckingKey_Triggers), theNewSettings.mTriggers);
+    theReadApps(CFSTR(kBGMDuckingKey_Targets), theNewSettings.mTargets);
+    
+    for(const CACFString& theApp : theNewSettings.mTriggers)
+    {
+        ThrowIf(theNewSettings.mTargets.count(theApp) != 0,
+                BGM_InvalidClientException(),
+                "BGM_Clients::SetDucking: App is both a trigger and a target");
+    }
+    
+    inDucking.GetBool(CFSTR(kBGMDuckingKey_DucksMusicPlayer), theNewSettings.mDucksMusicPlayer);
+    inDucking.GetBool(CFSTR(kBGMDuckingKey_SustainedTriggersOnly),
+                      theNewSettings.mSustainedTriggersOnly);
+    
+    auto theReadNumber = [&] (CFStringRef inKey, Float32 inMin, Float32 inMax, Float32& ioValue) {
+        Float32 theValue;
+        
+        if(inDucking.GetFloat32(inKey, theValue))
+        {
+            ThrowIf(std::isnan(theValue),
+                    BGM_InvalidClientException(),
+                    "BGM_Clients::SetDucking: Setting was not a number");
+            
+            ioValue = std::min(inMax, std::max(inMin, theValue));
+        }
+    };
+    
+    theReadNumber(CFSTR(kBGMDuckingKey_ThresholdDB), kBGMDuckingMinDB, 0.0f, theNewSettings.mThresholdDB);
+    theReadNumber(CFSTR(kBGMDuckingKey_DepthDB), kBGMDuckingMinDB, 0.0f, theNewSettings.mDepthDB);
+    theReadNumber(CFSTR(kBGMDuckingKey_AttackMillis), 0.0f, kBGMDuckingMaxMillis, theNewSettings.mAttackMillis);
+    theReadNumber(CFSTR(kBGMDuckingKey_HoldMillis), 0.0f, kBGMDuckingMaxMillis, theNewSettings.mHoldMillis);
+    theReadNumber(CFSTR(kBGMDuckingKey_ReleaseMillis), 0.0f, kBGMDuckingMaxMillis, theNewSettings.mReleaseMillis);
+    
+    if(theNewSettings == mDucker.GetSettings())
+    {
+        return false;
+    }
+    
+    bool didChangeApps = (theNewSettings.mTriggers != mDucker.GetSettings().mTriggers) ||
+                         (theNewSettings.mTargets != mDucker.GetSettings().mTargets);
+    
+    mDucker.SetSettings(theNewSettings);
+    
+    if(didChangeApps)
+    {
+        UpdateDuckingRoles();
+    }
+    
+    return true;
+}
+
+void    BGM_Clients::UpdateDuckingRoles()
+{
+    const BGM_Ducker::Settings& theSettings = mDucker.GetSettings();
+    
+    mClientMap.UpdateClients([&] (BGM_Client& ioClient) {
+        ioClient.mDuckingRole = theSettings.GetRole(ioClient.mBundleID);
+    });
+}
+
+void    BGM_Clients::ApplyDuckingRT(UInt32 inClientID,
+                                    Float32* ioBuffer,
+                                    UInt32 inNumFrames,
+                                    Float64 inOutputSampleTime)
+{
+    BGM_Client* theClient = mClientMap.GetClientPtrRT(inClientID);
+    
+    if(theClient == nullptr)
+    {
+        return;
+    }
+    
+    if(theClient->mDuckingRole == BGM_Ducker::kRoleTrigger)
+    {
+        bool theTriggerIsPlaying =
+                !mDucker.SustainedTriggersOnlyRT() ||
+                (theClient->mSignalClassifier != nullptr &&
+                 theClient->mSignalClassifier->GetClass() == BGM_SignalClassifier::kClassSustained);
+        
+        if(theTriggerIsPlaying)
+        {
+            mDucker.DetectRT(ioBuffer, inNumFrames, inOutputSampleTime);
+        }
+    }
+    else if(theClient->mDuckingRole == BGM_Ducker::kRoleTarget ||
+            (theClient->mIsMusicPlayer && mDucker.DucksMusicPlayerRT()))
+    {
+        mDucker.ApplyRT(ioBuffer, inNumFrames, inOutputSampleTime);
+    }
 }
 
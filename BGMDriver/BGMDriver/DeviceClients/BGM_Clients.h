@@ -25,15 +25,33 @@
 
 // Local Includes
 #include "BGM_Client.h"
+#include "BGM_ClientDSPStatePool.h"
 #include "BGM_ClientMap.h"
+#include "BGM_Crossfader.h"
+#include "BGM_Ducker.h"
+#include "BGM_GainRamp.h"
+#include "BGM_LoudnessMeter.h"
+#include "BGM_ParameterAutomation.h"
+#include "BGM_SampleTimeRingBuffer.h"
+#include "BGM_SceneMorph.h"
+#include "BGM_SharedParameterTable.h"
+#include "BGM_SignalClassifier.h"
+#include "BGM_Types.h"
 
 // PublicUtility Includes
 #include "CAVolumeCurve.h"
 #include "CAMutex.h"
 #include "CACFArray.h"
+#include "CACFDictionary.h"
 
 // STL Includes
+#include <functional>
 #include <vector>
+#include <set>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <unordered_set>
 
 // System Includes
 #include <CoreAudio/AudioServerPlugIn.h>
@@ -45,6 +63,106 @@ class BGM_ClientTasks;
 
 #pragma clang assume_nonnull begin
 
+//==================================================================================================
+//	BGM_CaptureFilter
+//
+//  A reader app's capture filter, i.e. which apps' audio it gets from BGMDevice's input stream.
+//  See kAudioDeviceCustomPropertyCaptureFilters.
+//==================================================================================================
+
+struct BGM_CaptureFilter
+{
+    BGMCaptureFilterMode    mMode = kBGMCaptureFilterModeNone;
+    std::set<CACFString>    mApps;
+    
+    // True if the filter lets through the audio of the app with the given bundle ID.
+    bool Accepts(const CACFString& inBundleID) const {
+        bool isListed = inBundleID.IsValid() && mApps.count(inBundleID) != 0;
+        return (mMode == kBGMCaptureFilterModeExclude) ? !isListed : isListed;
+    }
+    
+    // False if the filter lets every app through, so its reader can just get the full loopback.
+    bool IsFiltering() const {
+        return !(mMode == kBGMCaptureFilterModeExclude && mApps.empty());
+    }
+    
+    bool operator<(const BGM_CaptureFilter& other) const {
+        return std::tie(mMode, mApps) < std::tie(other.mMode, other.mApps);
+    }
+    
+    bool operator==(const BGM_CaptureFilter& other) const {
+        return mMode == other.mMode && mApps == other.mApps;
+    }
+};
+
+//==================================================================================================
+//	BGM_AppAutomationEvent
+//
+//  A gain change scheduled for an app with kAudioDeviceCustomPropertyAppAutomation. BGM_Clients
+//  keeps the events so it can schedule them for clients that are added after them.
+//==================================================================================================
+
+struct BGM_AppAutomationEvent
+{
+    UInt64      mHostTime = 0;
+    Float32     mGainDB = 0.0f;
+    Float32     mRampMillis = 0.0f;
+};
+
+//==================================================================================================
+//	BGM_AppVolumeSettings
+//
+//  The settings for an app in a kAudioDeviceCustomPropertyAppVolumes dictionary, after they've been
+//  validated. Used for that property and for the apps in scenes.
+//==================================================================================================
+
+struct BGM_AppVolumeSettings
+{
+    // 0 if the dictionary only had a bundle ID.
+    pid_t       mProcessID = 0;
+    // Not valid if the dictionary only had a PID.
+    CACFString  mBundleID;
+    
+    bool        mHasRelativeVolume = false;
+    SInt32      mRawRelativeVolume = 0;
+    
+    bool        mHasPanPosition = false;
+    SInt32      mPanPosition = kAppPanCenterRawValue;
+    
+    // The low, mid and high EQ gains in dB, or kAppEQGainNoValue for the bands not being set.
+    Float32     mEQGainsDB[BGM_SceneMorph::kEQBands] = { static_cast<Float32>(kAppEQGainNoValue),
+                                                         static_cast<Float32>(kAppEQGainNoValue),
+                                                         static_cast<Float32>(kAppEQGainNoValue) };
+    
+    bool        HasEQ() const {
+        return mEQGainsDB[0] != kAppEQGainNoValue ||
+               mEQGainsDB[1] != kAppEQGainNoValue ||
+               mEQGainsDB[2] != kAppEQGainNoValue;
+    }
+};
+
+//==================================================================================================
+//	BGM_SceneMorphSegment
+//
+//  What a client's morph to a scene applies to one IO buffer. The volume and pan position ramp
+//  linearly from their start values on the first frame to their end values on the frame after the
+//  last. The EQ is constant for the buffer.
+//==================================================================================================
+
+struct BGM_SceneMorphSegment
+{
+    // Relative volumes, i.e. with the volume curve applied.
+    Float32     mStartVolume = 1.0f;
+    Float32     mEndVolume = 1.0f;
+    // Pan positions in [-1.0, 1.0].
+    Float32     mStartPan = 0.0f;
+    Float32     mEndPan = 0.0f;
+    // False if the EQ is flat, in which case mEQCoeffs aren't set.
+    bool        mHasEQ = false;
+    // The biquad coefficients of the low, mid and high bands. See BGM_Client::mEQLowCoeffs.
+    Float32     mEQCoeffs[BGM_SceneMorph::kEQBands][5];
+};
+
 //==================================================================================================
 //	BGM_Clients
 //
@@ -61,12 +179,26 @@ class BGM_Clients
     friend class BGM_ClientTasks;
     
 public:
-                                        BGM_Clients(AudioObjectID inOwnerDeviceID, BGM_TaskQueue* inTaskQueue);
+    // inParameterTableName is the name of the shared memory object BGMApp creates the shared
+    // parameter table in, e.g. kBGMParameterTableName. If it's null, the table is private.
+                                        BGM_Clients(AudioObjectID inOwnerDeviceID,
+                                                    const char* _Nullable inParameterTableName = nullptr);
                                         ~BGM_Clients() = default;
     // Disallow copying. (It could make sense to implement these in future, but we don't need them currently.)
                                         BGM_Clients(const BGM_Clients&) = delete;
                                         BGM_Clients& operator=(const BGM_Clients&) = delete;
     
+    // IO threads have to hold one of these while they call the methods ending in RT, which read the
+    // clients. See BGM_ClientMap::ReaderRT. Wait-free.
+    class ReaderRT
+    {
+    public:
+                                        ReaderRT(const BGM_Clients& inClients) : mClientMapReader(inClients.mClientMap) { }
+        
+    private:
+        BGM_ClientMap::ReaderRT         mClientMapReader;
+    };
+    
     void                                AddClient(BGM_Client inClient);
     void                                RemoveClient(const UInt32 inClientID);
     
@@ -97,13 +229,49 @@ public:
     
     bool                                IsMusicPlayerRT(const UInt32 inClientID) const;
     
+private:
+    // True if the client belongs to the music player set by the music player properties. mMutex must
+    // be held.
+    bool                                IsMusicPlayerClient(const BGM_Client& inClient) const;
+    
+public:
+    
+    // These return the values from the shared parameter table if the client's app has set them
+    // there, and the values set with kAudioDeviceCustomPropertyAppVolumes otherwise. The pan
+    // position is in the range [kAppPanLeftRawValue, kAppPanRightRawValue].
     Float32                             GetClientRelativeVolumeRT(UInt32 inClientID) const;
-    SInt32                              GetClientPanPositionRT(UInt32 inClientID) const;
+    Float32                             GetClientPanPositionRT(UInt32 inClientID) const;
+    
+    // The table apps can set their volumes and pan positions in instead of setting
+    // kAudioDeviceCustomPropertyAppVolumes. See BGM_ParameterTable.h. Only writable if it's the
+    // private table, i.e. BGMApp hasn't created the shared one.
+    BGMParameterTable*                  GetParameterTable() const { return mParameterTable.GetTable(); }
+    
+private:
+    // Apply mRelativeVolumeCurve to a raw relative volume from the shared parameter table,
+    // interpolating between the curve's steps for fractional values. Real-time safe.
+    Float32                             ConvertRawRelativeVolumeToScalarRT(Float32 inRawVolume) const;
     
-    // Get per-client EQ filter coefficients and delay states for RT processing
+    // Unset a parameter in the shared parameter table for the app with the given PID and the clients
+    // with the given bundle ID, because it's been set with kAudioDeviceCustomPropertyAppVolumes.
+    void                                ClearParameterTableValues(pid_t inAppPID,
+                                                                  const CACFString& inAppBundleID,
+                                                                  BGMParameter inParameter);
+    
+public:
+    // Get per-client EQ filter coefficients for RT processing
     // Returns a pointer to the client's EQ data, or nullptr if not found
     BGM_Client*                         GetClientForEQRT(UInt32 inClientID) const;
     
+    // Run the client's audio through its EQ with the given coefficients (its own or its scene
+    // morph's), using the filter states in its DSP state pool slot. See
+    // BGM_ClientDSPStatePool::ApplyEQRT. Real-time safe. Only one thread may process a client at a
+    // time.
+    void                                ApplyClientEQRT(const BGM_Client& inClient,
+                                                        const Float32* const inCoeffs[BGM_ClientDSPStatePool::kEQBands],
+                                                        Float32* ioBuffer,
+                                                        UInt32 inFrameCount) const;
+    
     // Copies the current and past clients into an array in the format expected for
     // kAudioDeviceCustomPropertyAppVolumes. (Except that CACFArray and CACFDictionary are used instead
     // of unwrapped CFArray and CFDictionary refs.)
@@ -117,6 +285,14 @@ public:
     // Returns true if any clients' relative volumes were changed.
     bool                                SetClientsRelativeVolumes(const CACFArray inAppVolumes);
     
+private:
+    // Read and validate an element of a kAudioDeviceCustomPropertyAppVolumes array. Throws
+    // BGM_InvalidClientRelativeVolumeException or BGM_InvalidClientPanPositionException if it's
+    // invalid or doesn't have any settings.
+    static BGM_AppVolumeSettings        ParseAppVolumeSettings(const CACFDictionary& inAppVolume);
+    
+public:
+    
     // Inter-app audio routing methods
     
     // Set a route from source client to destination client with gain
@@ -131,21 +307,341 @@ public:
     // Returns true if any routes changed
     bool                                SetRoutesFromArray(const CACFArray inRoutes);
     
+private:
+    // Update mRoutes with the routes in inRoutes, which is in the kAudioDeviceCustomPropertyAppRouting
+    // format, without compiling them. Invalid routes are skipped. mMutex must be held. Returns true
+    // if any routes changed.
+    bool                                UpdateRoutes(const CACFArray& inRoutes);
+    
+public:
+    
     // Clear all routes involving a specific client (called when client is removed)
     void                                ClearRoutesForClient(pid_t inProcessID);
     
-    // RT-safe: Store a client's processed audio to its routing buffer
+    // RT-safe: Store a client's processed audio to its routing buffer. inSampleTime is the output
+    // sample time of the first frame.
     void                                StoreClientAudioRT(UInt32 inClientID, const Float32* inBuffer, 
-                                                           UInt32 inNumFrames);
+                                                           UInt32 inNumFrames, Float64 inSampleTime);
     
-    // RT-safe: Mix routed audio into a destination client's buffer
-    // Called before the destination client's audio is processed
+    // RT-safe: Mix routed audio into a destination client's buffer. inSampleTime is the input sample
+    // time of the first frame. Each route's audio is read from its source's routing buffer at that
+    // sample time minus the route's delay, so routes have a fixed latency regardless of the order
+    // the HAL calls the clients in.
     void                                MixRoutedAudioRT(UInt32 inClientID, Float32* ioBuffer, 
-                                                          UInt32 inNumFrames);
+                                                          UInt32 inNumFrames, Float64 inSampleTime);
     
     // RT-safe: Check if a client has any incoming routes (is a routing destination)
     bool                                HasIncomingRoutesRT(UInt32 inClientID) const;
     
+private:
+    static bool                         IsValidRoutingChannel(SInt32 inChannel);
+    
+    // Set the entries of a route's channel matrix from inSourceChannel to inDestChannel (either can
+    // be kBGMAppRoutingChannelAll) to inGain. Adds the route if it doesn't exist. mMutex must be held.
+    // Returns true if the route changed.
+    bool                                SetRouteChannelGains(const BGM_AudioRoute& inEndpoints,
+                                                         SInt32 inSourceChannel,
+                                                         SInt32 inDestChannel,
+                                                         Float32 inGain);
+    
+    // Set the delay of the route between inEndpoints' source and destination, if it exists. mMutex
+    // must be held. Returns true if the route changed.
+    bool                                SetRouteDelay(const BGM_AudioRoute& inEndpoints, UInt32 inDelayFrames);
+    
+    // Compile the enabled routes in mRoutes into the routing kernels of their destination clients.
+    // The routes' endpoints are resolved to clients through BGM_ClientMap's PID and bundle ID
+    // indexes. mMutex must be held.
+    //
+    // If inUpdateClient is given, it's also applied to each client in the same update of the client
+    // maps, so IO sees its changes in the same cycle as the new kernels. It's called twice for each
+    // client, once for each copy.
+    void                                CompileRoutingKernels(std::function<void(BGM_Client&)> inUpdateClient = nullptr);
+    
+    // True if the client is the source or destination of an enabled route, in which case adding or
+    // removing it changes the routing kernels. mMutex must be held.
+    bool                                IsRouteEndpoint(const BGM_Client& inClient) const;
+    
+    // Mix inSourceBuffer into ioDestBuffer according to inKernel. Both buffers are interleaved.
+    static void                         ApplyRoutingKernelRT(const BGM_RoutingKernel& inKernel,
+                                                         const Float32* inSourceBuffer,
+                                                         Float32* ioDestBuffer,
+                                                         UInt32 inNumFrames);
+
+    // ioDestBuffer += inSourceBuffer * inGain, with vDSP where it's available.
+    static void                         MultiplyAddRT(const Float32* inSourceBuffer,
+                                                  UInt32 inSourceStride,
+                                                  Float32 inGain,
+                                                  Float32* ioDestBuffer,
+                                                  UInt32 inDestStride,
+                                                  UInt32 inNumSamples);
+    
+public:
+    // Mix-minus (N-1) loopback
+    
+    // Copies the apps set to get mix-minus loopback into an array in the format expected for
+    // kAudioDeviceCustomPropertyMixMinusApps. (Except that CACFArray is used instead of CFArray.)
+    CACFArray                           CopyMixMinusAppsAsArray() const;
+    
+    // inMixMinusApps is an array of dicts with the keys kBGMMixMinusKey_ProcessID and/or
+    // kBGMMixMinusKey_BundleID and optionally kBGMMixMinusKey_Enabled. The settings are kept for
+    // apps that aren't clients yet and applied when they're added.
+    //
+    // Returns true if the value of kAudioDeviceCustomPropertyMixMinusApps changed. Throws
+    // BGM_InvalidClientException if an app is given without a PID or bundle ID.
+    bool                                SetMixMinusApps(const CACFArray inMixMinusApps);
+    
+    // App priorities
+    
+    // Copies the apps that don't have normal priority into an array in the format expected for
+    // kAudioDeviceCustomPropertyAppPriorities. (Except that CACFArray is used instead of CFArray.)
+    CACFArray                           CopyAppPrioritiesAsArray() const;
+    
+    // inAppPriorities is an array of dicts with the keys kBGMAppPriorityKey_ProcessID and/or
+    // kBGMAppPriorityKey_BundleID and kBGMAppPriorityKey_Priority. Like the mix-minus settings,
+    // priorities are kept for apps that aren't clients yet. If a client's pid and bundle ID both
+    // have priorities, its pid's is used.
+    //
+    // Returns true if the value of kAudioDeviceCustomPropertyAppPriorities changed. Throws
+    // BGM_InvalidClientException if an app is given without a PID or bundle ID or with an invalid
+    // priority.
+    bool                                SetAppPriorities(const CACFArray inAppPriorities);
+    
+    BGMAppPriority                      GetClientPriorityRT(UInt32 inClientID) const;
+    
+private:
+    // The priority the app priorities give the client. mMutex must be held.
+    BGMAppPriority                      GetAppPriority(const BGM_Client& inClient) const;
+    
+public:
+    
+    // Selective loopback capture
+    
+    // Copies the capture filters into an array in the format expected for
+    // kAudioDeviceCustomPropertyCaptureFilters. (Except that CACFArray is used instead of CFArray.)
+    CACFArray                           CopyCaptureFiltersAsArray() const;
+    
+    // inCaptureFilters is an array of dicts with the keys kBGMCaptureFilterKey_ReaderBundleID,
+    // kBGMCaptureFilterKey_Mode and optionally kBGMCaptureFilterKey_Apps. Like the mix-minus
+    // settings, filters are kept for readers that aren't clients yet.
+    //
+    // Returns true if the value of kAudioDeviceCustomPropertyCaptureFilters changed. Throws
+    // BGM_InvalidClientException if a filter is given without a reader bundle ID or with an
+    // unknown mode.
+    bool                                SetCaptureFilters(const CACFArray inCaptureFilters);
+    
+    // Mix a client's audio for the IO cycle, after its volume, pan and EQ have been applied, into
+    // the filtered capture submixes that include it.
+    void                                AccumulateCaptureSubmixesRT(UInt32 inClientID,
+                                                                    const Float32* inBuffer,
+                                                                    UInt32 inNumFrames,
+                                                                    Float64 inOutputSampleTime) const
+                                            { mClientMap.AccumulateCaptureSubmixesRT(inClientID, inBuffer, inNumFrames, inOutputSampleTime); }
+    
+    // If the client's app has a capture filter, copy its filtered submix for the given sample times
+    // into outBuffer and return true. Otherwise, return false.
+    bool                                FetchCaptureSubmixRT(UInt32 inClientID,
+                                                             Float32* outBuffer,
+                                                             UInt32 inNumFrames,
+                                                             Float64 inInputSampleTime) const
+                                            { return mClientMap.FetchCaptureSubmixRT(inClientID, outBuffer, inNumFrames, inInputSampleTime); }
+    
+private:
+    // Works out which filtered submixes are needed, i.e. one for each distinct filter used by a
+    // reader that's currently a client, and which clients read from and mix into each of them.
+    // mMutex must be held when calling this method.
+    void                                UpdateCaptureSubmixes();
+    
+public:
+    // Store a client's audio for the IO cycle, after its volume, pan and EQ have been applied, if
+    // it's a mix-minus client.
+    void                                StoreMixMinusContributionRT(UInt32 inClientID,
+                                                                    const Float32* inBuffer,
+                                                                    UInt32 inNumFrames,
+                                                                    Float64 inOutputSampleTime) const
+                                            { mClientMap.StoreMixMinusContributionRT(inClientID, inBuffer, inNumFrames, inOutputSampleTime); }
+    
+    // If the client is a mix-minus client, subtract the stored audio of its app's clients from the
+    // loopback audio in ioBuffer. inInputSampleTime must be the sample time the loopback audio was read from.
+    void                                SubtractMixMinusContributionRT(UInt32 inClientID,
+                                                                       Float32* ioBuffer,
+                                                                       UInt32 inNumFrames,
+                                                                       Float64 inInputSampleTime) const
+                                            { mClientMap.SubtractMixMinusContributionRT(inClientID, ioBuffer, inNumFrames, inInputSampleTime); }
+    
+    // Crossfader
+    
+    // Copies the crossfader's settings into a dictionary in the format expected for
+    // kAudioDeviceCustomPropertyCrossfader. (Except that CACFDictionary is used instead of
+    // CFDictionary.)
+    CACFDictionary                      CopyCrossfaderAsDictionary() const;
+    
+    // inCrossfader is a dict with any of the kBGMCrossfaderKey keys. The settings it doesn't include
+    // are left as they are.
+    //
+    // Returns true if the value of kAudioDeviceCustomPropertyCrossfader changed. Throws
+    // BGM_InvalidClientException if an app would be in both groups or the curve is unknown.
+    bool                                SetCrossfader(const CACFDictionary inCrossfader);
+    
+    // Set the sample rate of the clients' audio, which the crossfader, the scheduled automation
+    // and the ducking use to time their ramps.
+    void                                SetSampleRate(Float64 inSampleRate);
+    
+    // If the client is in one of the crossfader's groups, apply the crossfader's gain to its audio
+    // for the IO cycle, ramping from the gain it applied last cycle.
+    void                                ApplyCrossfaderGainRT(UInt32 inClientID,
+                                                              Float32* ioBuffer,
+                                                              UInt32 inNumFrames) const;
+    
+private:
+    // Give each client in the crossfader's groups a gain ramp, free the ramps of clients that have
+    // left them and set the ramps' targets to the crossfader's gains. Only updates the client maps
+    // if clients joined or left the groups, so moving the crossfader doesn't swap them. mMutex must
+    // be held when calling this method.
+    void                                UpdateCrossfadeRamps();
+    
+    // How quickly the crossfader's gains follow its position.
+    static constexpr Float64            kCrossfadeRampTimeConstantSecs = 0.02;
+    
+public:
+    // Scheduled gain automation
+    
+    // Copies the events that haven't started yet into an array in the format expected for
+    // kAudioDeviceCustomPropertyAppAutomation. (Except that CACFArray is used instead of CFArray.)
+    CACFArray                           CopyAppAutomationAsArray() const;
+    
+    // inEvents is an array of dicts with the kBGMAppAutomationKey keys. The events are added to
+    // their apps' schedules, and the schedules are kept for apps that aren't clients yet.
+    //
+    // Returns true if any events were scheduled. Throws BGM_InvalidClientException if an event is
+    // invalid, is earlier than an event already scheduled for its app or would overfill its app's
+    // schedule. Nothing is scheduled in that case.
+    bool                                SetAppAutomation(const CACFArray inEvents);
+    
+    // If gain changes have been scheduled for the client's app, apply the gain to its audio for the
+    // IO cycle. inOutputTime is the cycle's output time. The changes start on the frames whose host
+    // times are their scheduled times.
+    void                                ApplyAppAutomationRT(UInt32 inClientID,
+                                                             Float32* ioBuffer,
+                                                             UInt32 inNumFrames,
+                                                             const AudioTimeStamp& inOutputTime) const;
+    
+private:
+    // The schedule the client follows, i.e. its PID's if it has one, otherwise its bundle ID's, or
+    // null. mMutex must be held.
+    const std::vector<BGM_AppAutomationEvent>* _Nullable GetAppAutomationSchedule(const BGM_Client& inClient) const;
+    
+    // Drop the events from a schedule that have started, except the last of them, which new
+    // clients still need to get to the right gain.
+    static void                         PruneAppAutomationSchedule(std::vector<BGM_AppAutomationEvent>& ioSchedule,
+                                                                  UInt64 inNow);
+    
+    BGM_ParameterAutomation::Event      ConvertAppAutomationEvent(const BGM_AppAutomationEvent& inEvent) const;
+    
+public:
+    // Scenes
+    
+    // Copies the current scene, i.e. the apps' settings, the routes and the music player, into a
+    // dictionary in the format expected for kAudioDeviceCustomPropertyScene. (Except that
+    // CACFDictionary is used instead of CFDictionary.)
+    CACFDictionary                      CopySceneAsDictionary() const;
+    
+    // inScene is a dict with any of the kBGMSceneKey keys. The whole scene is read, validated and
+    // staged first, including the new routing kernels, EQ coefficients and morphs, and then it's
+    // published to IO with a single update of the client maps.
+    //
+    // Returns true if the scene had any settings. Throws BGM_InvalidClientException,
+    // BGM_InvalidClientPIDException, BGM_InvalidClientRelativeVolumeException or
+    // BGM_InvalidClientPanPositionException if the scene is invalid, in which case nothing is
+    // changed.
+    bool                                SetScene(const CACFDictionary inScene);
+    
+    // If the client is morphing to a scene, advance its morph by inNumFrames and get what to apply
+    // to its audio for the IO cycle. Returns false if it isn't morphing, in which case its own
+    // volume, pan position and EQ should be used.
+    bool                                GetSceneMorphRT(UInt32 inClientID,
+                                                        UInt32 inNumFrames,
+                                                        BGM_SceneMorphSegment& outSegment) const;
+    
+private:
+    // The client's volume, pan position and EQ gains as they are now, including its morph if it's
+    // part way through one and the values its app has set in the shared parameter table. mMutex
+    // must be held.
+    BGM_SceneMorph::Parameters          GetSceneParameters(const BGM_Client& inClient) const;
+    
+    // Set the client's volume, pan position and EQ (including its coefficients) to inParameters.
+    void                                SetSceneParameters(const BGM_SceneMorph::Parameters& inParameters,
+                                                           BGM_Client& ioClient) const;
+    
+public:
+    // Signal Classification
+    
+    // Update the classification of the client's audio with its buffer for the IO cycle. Returns
+    // true if the client is playing sustained audio, e.g. speech or music, rather than silence or
+    // short sounds like notifications.
+    //
+    // If inSkipSpectralFeatures is true, the classifier doesn't calculate the audio's spectral
+    // features, which is most of its work. See BGM_SignalClassifier::ProcessRT.
+    bool                                ClassifyClientAudioRT(UInt32 inClientID,
+                                                              const Float32* inBuffer,
+                                                              UInt32 inNumFrames,
+                                                              bool inSkipSpectralFeatures = false);
+    
+public:
+    // Loudness
+    
+    // Copies the loudness of each client into an array in the format expected for
+    // kAudioDeviceCustomPropertyLoudness. (Except that CACFArray is used instead of CFArray.)
+    CACFArray                           CopyLoudnessAsArray() const;
+    
+    // Copies the normalization settings into a dictionary in the format expected for
+    // kAudioDeviceCustomPropertyLoudnessNormalization.
+    CACFDictionary                      CopyLoudnessNormalizationAsDictionary() const;
+    
+    // inNormalization is a dict with any of the kBGMLoudnessNormalizationKey keys. The settings it
+    // doesn't include are left as they are.
+    //
+    // Returns true if the value of kAudioDeviceCustomPropertyLoudnessNormalization changed. Throws
+    // BGM_InvalidClientException if a setting isn't a number.
+    bool                                SetLoudnessNormalization(const CACFDictionary inNormalization);
+    
+    // Measure the loudness of the client's audio for the IO cycle and then apply its loudness
+    // normalization gain.
+    void                                ApplyLoudnessNormalizationRT(UInt32 inClientID,
+                                                                     Float32* ioBuffer,
+                                                                     UInt32 inNumFrames);
+    
+public:
+    // Ducking
+    
+    // Copies the ducking settings into a dictionary in the format expected for
+    // kAudioDeviceCustomPropertyDucking. (Except that CACFDictionary is used instead of
+    // CFDictionary.)
+    CACFDictionary                      CopyDuckingAsDictionary() const;
+    
+    // inDucking is a dict with any of the kBGMDuckingKey keys. The settings it doesn't include are
+    // left as they are.
+    //
+    // Returns true if the value of kAudioDeviceCustomPropertyDucking changed. Throws
+    // BGM_InvalidClientException if an app would be both a trigger and a target or a setting isn't
+    // a number.
+    bool                                SetDucking(const CACFDictionary inDucking);
+    
+    // If the client's app is a ducking trigger, measure its audio for the IO cycle. If it's a
+    // target, apply the ducking gain to its audio. inOutputSampleTime is the cycle's output sample
+    // time.
+    //
+    // If kBGMDuckingKey_SustainedTriggersOnly is set, triggers are only measured while their audio
+    // is sustained, so ClassifyClientAudioRT must be called for the client first.
+    void                                ApplyDuckingRT(UInt32 inClientID,
+                                                       Float32* ioBuffer,
+                                                       UInt32 inNumFrames,
+                                                       Float64 inOutputSampleTime);
+    
+private:
+    // Set each client's BGM_Client::mDuckingRole from the ducking settings. Only updates the client
+    // maps if a role changed. mMutex must be held.
+    void                                UpdateDuckingRoles();
+    
 private:
     AudioObjectID                       mOwnerDeviceID;
     BGM_ClientMap                       mClientMap;
@@ -179,10 +675,91 @@ private:
     // The volume curve we apply to raw client volumes before they're used
     CAVolumeCurve                       mRelativeVolumeCurve;
     
+    // The apps' volumes and pan positions set through shared memory.
+    BGM_SharedParameterTable            mParameterTable;
+    
     // Global routing table for inter-app audio routing
     // Maps source PID -> list of routes from that source
     std::vector<BGM_AudioRoute>         mRoutes;
     
+    // The PIDs and bundle IDs of the endpoints of the enabled routes in mRoutes, so clients being
+    // added and removed can be checked against the routes without searching them.
+    std::unordered_set<pid_t>           mRoutedProcessIDs;
+    std::unordered_set<CACFString, BGM_CACFStringHash> mRoutedBundleIDs;
+    
+    // The routing buffers of the clients that are routing sources, by client ID. See
+    // BGM_Client::mRoutingBuffer.
+    std::map<UInt32, std::unique_ptr<BGM_SampleTimeRingBuffer>> mRoutingBuffers;
+    
+    // Used by MixRoutedAudioRT to gather each source's audio before mixing it in. Only accessed
+    // during IO.
+    Float32                             mRoutingScratchBuffer[BGM_Client::kRoutingBufferFrames *
+                                                              BGM_Client::kRoutingBufferChannels];
+    
+    // The apps set to get mix-minus loopback, i.e. the value of kAudioDeviceCustomPropertyMixMinusApps.
+    // Like the music player properties, these are stored separately from the clients because the
+    // apps might not be clients yet.
+    std::set<pid_t>                     mMixMinusProcessIDs;
+    std::set<CACFString>                mMixMinusBundleIDs;
+    
+    // The value of kAudioDeviceCustomPropertyAppPriorities, i.e. the apps that don't have normal
+    // priority. Stored separately from the clients for the same reason.
+    std::map<pid_t, BGMAppPriority>     mPriorityByProcessID;
+    std::map<CACFString, BGMAppPriority> mPriorityByBundleID;
+    
+    // The value of kAudioDeviceCustomPropertyCaptureFilters. Maps readers' bundle IDs to their
+    // filters.
+    std::map<CACFString, BGM_CaptureFilter> mCaptureFilters;
+    
+    // The filtered submixes, one per distinct filter in use, so readers with the same filter share
+    // one. Each client's output is mixed into the submixes that include it once per IO cycle, so
+    // the cost doesn't depend on the number of readers.
+    std::map<BGM_CaptureFilter, std::unique_ptr<BGM_SampleTimeRingBuffer>> mCaptureSubmixes;
+    
+    // The value of kAudioDeviceCustomPropertyCrossfader.
+    BGM_Crossfader                      mCrossfader;
+    
+    // The gain ramps of the clients in the crossfader's groups, by client ID. See
+    // BGM_Client::mCrossfadeRamp.
+    std::map<UInt32, std::unique_ptr<BGM_GainRamp>> mCrossfadeRamps;
+    
+    // The sample rate the crossfade ramps and automation ramps are timed for. Updated by
+    // BGM_Device.
+    Float64                             mSampleRate = 44100.0;
+    // The length of a frame in host ticks at mSampleRate.
+    Float64                             mHostTicksPerFrame;
+    
+    // The value of kAudioDeviceCustomPropertyAppAutomation, i.e. the events scheduled for each app,
+    // in order. Like the mix-minus settings, these are kept separately from the clients because the
+    // apps might not be clients yet.
+    std::map<pid_t, std::vector<BGM_AppAutomationEvent>> mAppAutomationByProcessID;
+    std::map<CACFString, std::vector<BGM_AppAutomationEvent>> mAppAutomationByBundleID;
+    
+    // The automation queues of the clients whose apps have scheduled events, by client ID. See
+    // BGM_Client::mAutomation.
+    std::map<UInt32, std::unique_ptr<BGM_ParameterAutomation>> mAutomations;
+    
+    // The morphs of the clients whose apps were in the last scenes set with a morph time, by client
+    // ID. See BGM_Client::mSceneMorph. They're kept after they finish, until the next scene is set
+    // or the client is removed.
+    std::map<UInt32, std::unique_ptr<BGM_SceneMorph>> mSceneMorphs;
+    
+    // The value of kAudioDeviceCustomPropertyDucking and the envelope that applies it. The settings
+    // are only accessed with mMutex held and the envelope's state only on the IO thread.
+    BGM_Ducker                          mDucker;
+    
+    // The signal classifiers of every client, by client ID. See BGM_Client::mSignalClassifier.
+    std::map<UInt32, std::unique_ptr<BGM_SignalClassifier>> mSignalClassifiers;
+    
+    // The value of kAudioDeviceCustomPropertyLoudnessNormalization and the loudness meters of every
+    // client, by client ID. See BGM_Client::mLoudnessMeter.
+    BGM_LoudnessMeter::Normalization    mLoudnessNormalization;
+    std::map<UInt32, std::unique_ptr<BGM_LoudnessMeter>> mLoudnessMeters;
+    
+    // The state that changes while each client's audio is processed, on the IO thread or a DSP
+    // worker, by slot. See BGM_Client::mDSPStateSlot.
+    BGM_ClientDSPStatePool              mDSPStates;
+    
 };
 
 #pragma clang assume_nonnull end
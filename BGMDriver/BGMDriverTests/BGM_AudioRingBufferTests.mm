@@ -0,0 +1,117 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+
+//
+//
+//  BGM_AudioRingBufferTests.mm
+//  BGMDriverTests
+//
+//  Copyright © 2026 Background Music contributors
+//
+
+// Unit Include
+#include "BGM_AudioRingBuffer.h"
+
+// STL Includes
+#include <vector>
+
+
+static const UInt32 kChannels = 2;
+
+static std::vector<Float32> Frames(UInt32 inFrameCount, Float32 inFirstValue)
+{
+    std::vector<Float32> theFrames(inFrameCount * kChannels);
+
+    for(UInt32 i = 0; i < theFrames.size(); i++)
+    {
+        theFrames[i] = inFirstValue + i;
+    }
+
+    return theFrames;
+}
+
+@interface BGM_AudioRingBufferTests : XCTestCase
+
+@end
+
+@implementation BGM_AudioRingBufferTests
+
+- (void)testCapacityIsRoundedUpToAPowerOfTwo {
+    BGM_SPSCAudioRingBuffer theBuffer;
+    theBuffer.Allocate(kChannels, 1000);
+
+    XCTAssertEqual(theBuffer.GetChannels(), kChannels);
+    XCTAssertEqual(theBuffer.GetCapacityFrames(), 1024);
+}
+
+- (void)testFetchReturnsStoredFrames {
+    BGM_SPSCAudioRingBuffer theBuffer;
+    theBuffer.Allocate(kChannels, 64);
+
+    std::vector<Float32> theInput = Frames(48, 1.0f);
+    XCTAssertEqual(theBuffer.StoreRT(theInput.data(), 48, 100), kCARingBufferError_OK);
+
+    // Wraps around the end of the buffer.
+    std::vector<Float32> theMoreInput = Frames(48, 1000.0f);
+    XCTAssertEqual(theBuffer.StoreRT(theMoreInput.data(), 48, 148), kCARingBufferError_OK);
+
+    BGM_SPSCAudioRingBuffer::SampleTime theStart, theEnd;
+    XCTAssertEqual(theBuffer.GetTimeBoundsRT(theStart, theEnd), kCARingBufferError_OK);
+    XCTAssertEqual(theStart, 196 - 64);
+    XCTAssertEqual(theEnd, 196);
+
+    std::vector<Float32> theOutput(48 * kChannels);
+    XCTAssertEqual(theBuffer.FetchRT(theOutput.data(), 48, 148), kCARingBufferError_OK);
+    XCTAssert(theOutput == theMoreInput);
+}
+
+- (void)testFetchOutsideTheTimeBoundsIsSilent {
+    BGM_MPSCAudioRingBuffer theBuffer;
+    theBuffer.Allocate(kChannels, 64);
+
+    std::vector<Float32> theInput = Frames(16, 1.0f);
+    XCTAssertEqual(theBuffer.StoreRT(theInput.data(), 16, 32), kCARingBufferError_OK);
+
+    // Half before the stored frames and half of them.
+    std::vector<Float32> theOutput(16 * kChannels, -1.0f);
+    XCTAssertEqual(theBuffer.FetchRT(theOutput.data(), 16, 24), kCARingBufferError_OK);
+
+    for(UInt32 i = 0; i < 8 * kChannels; i++)
+    {
+        XCTAssertEqual(theOutput[i], 0.0f);
+        XCTAssertEqual(theOutput[i + 8 * kChannels], theInput[i]);
+    }
+}
+
+- (void)testStoreErrors {
+    BGM_SPSCAudioRingBuffer theBuffer;
+    theBuffer.Allocate(kChannels, 64);
+
+    std::vector<Float32> theInput = Frames(65, 1.0f);
+    XCTAssertEqual(theBuffer.StoreRT(theInput.data(), 65, 0), kCARingBufferError_TooMuch);
+    XCTAssertEqual(theBuffer.StoreRT(theInput.data(), 32, 0), kCARingBufferError_OK);
+
+    // Going backwards empties the buffer.
+    XCTAssertEqual(theBuffer.StoreRT(theInput.data(), 8, 16), kCARingBufferError_OK);
+
+    BGM_SPSCAudioRingBuffer::SampleTime theStart, theEnd;
+    theBuffer.GetTimeBoundsRT(theStart, theEnd);
+    XCTAssertEqual(theStart, 16);
+    XCTAssertEqual(theEnd, 24);
+}
+
+@end
+
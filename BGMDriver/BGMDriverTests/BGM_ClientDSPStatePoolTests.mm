@@ -0,0 +1,136 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+
+//
+//
+//  BGM_ClientDSPStatePoolTests.mm
+//  BGMDriverTests
+//
+//  Copyright © 2026 Background Music contributors
+//
+
+// Unit Include
+#include "BGM_ClientDSPStatePool.h"
+
+// Local Includes
+#include "BGM_TestUtils.h"
+
+// STL Includes
+#include <cmath>
+#include <set>
+#include <vector>
+
+
+static const UInt32 kChannels = 2;
+
+// A 2 dB peak at 1 kHz and 48 kHz, with the coefficients in the order b0, b1, b2, a1, a2.
+static const Float32 kPeakCoeffs[5] = { 1.01599f, -1.96153f, 0.94784f, -1.96153f, 0.96383f };
+static const Float32 kFlatCoeffs[5] = { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+
+@interface BGM_ClientDSPStatePoolTests : XCTestCase
+
+@end
+
+@implementation BGM_ClientDSPStatePoolTests
+
+- (void)testSlotsAreUniqueAndReused {
+    BGM_ClientDSPStatePool pool;
+    std::set<UInt32> slots;
+    
+    // Use more slots than fit in the first block
+    const UInt32 kSlots = BGM_ClientDSPStatePool::kSlotsPerBlock * 2 + 3;
+    
+    for(UInt32 i = 0; i < kSlots; i++)
+    {
+        XCTAssert(slots.insert(pool.AllocateSlot()).second);
+    }
+    
+    XCTAssertEqual(pool.GetSlotsInUse(), kSlots);
+    XCTAssertEqual(*slots.rbegin(), kSlots - 1);
+    
+    // A freed slot should be used again before any new ones
+    pool.FreeSlot(5);
+    XCTAssertEqual(pool.GetSlotsInUse(), kSlots - 1);
+    XCTAssertEqual(pool.AllocateSlot(), 5);
+}
+
+- (void)testReusedSlotsAreReset {
+    BGM_ClientDSPStatePool pool;
+    const Float32* const coeffs[BGM_ClientDSPStatePool::kEQBands] = { kPeakCoeffs, kFlatCoeffs, kFlatCoeffs };
+    
+    // Leave the slot's filters ringing
+    UInt32 slot = pool.AllocateSlot();
+    Float32 buffer[16 * kChannels] = { 1.0f, 1.0f };
+    pool.ApplyEQRT(slot, coeffs, buffer, 16);
+    pool.GetParameterSlotCacheRT(slot).mSlot = 3;
+    
+    pool.FreeSlot(slot);
+    XCTAssertEqual(pool.AllocateSlot(), slot);
+    
+    // The new client's silence should stay silent
+    std::fill(buffer, buffer + 16 * kChannels, 0.0f);
+    pool.ApplyEQRT(slot, coeffs, buffer, 16);
+    
+    for(Float32 sample : buffer)
+    {
+        XCTAssertEqual(sample, 0.0f);
+    }
+    
+    XCTAssertEqual(pool.GetParameterSlotCacheRT(slot).mSlot, -1);
+}
+
+- (void)testEQIsContinuousAcrossBuffers {
+    BGM_ClientDSPStatePool pool;
+    const Float32* const coeffs[BGM_ClientDSPStatePool::kEQBands] = { kPeakCoeffs, kPeakCoeffs, kFlatCoeffs };
+    const UInt32 kFrames = 1000;
+    
+    std::vector<Float32> input(kFrames * kChannels);
+    for(UInt32 i = 0; i < kFrames; i++)
+    {
+        input[i * kChannels] = std::sin(static_cast<Float32>(i) * 0.1f);
+        input[i * kChannels + 1] = std::cos(static_cast<Float32>(i) * 0.03f);
+    }
+    
+    // Process the input in one buffer for one slot and in uneven buffers for another. Another slot
+    // in use in between shouldn't make any difference.
+    UInt32 wholeSlot = pool.AllocateSlot();
+    UInt32 otherSlot = pool.AllocateSlot();
+    UInt32 splitSlot = pool.AllocateSlot();
+    
+    std::vector<Float32> whole = input;
+    pool.ApplyEQRT(wholeSlot, coeffs, whole.data(), kFrames);
+    
+    std::vector<Float32> split = input;
+    std::vector<Float32> other = input;
+    
+    for(UInt32 frame = 0; frame < kFrames; frame += 37)
+    {
+        UInt32 frames = (kFrames - frame < 37) ? kFrames - frame : 37;
+        pool.ApplyEQRT(splitSlot, coeffs, split.data() + frame * kChannels, frames);
+        pool.ApplyEQRT(otherSlot, coeffs, other.data(), frames);
+    }
+    
+    for(UInt32 i = 0; i < whole.size(); i++)
+    {
+        XCTAssertEqual(split[i], whole[i]);
+    }
+    
+    // The EQ should actually have changed the audio
+    XCTAssertNotEqual(whole[500 * kChannels], input[500 * kChannels]);
+}
+
+@end
+
@@ -28,12 +28,9 @@
 
 // BGMDriver Includes
 #include "BGM_Client.h"
-#include "BGM_TaskQueue.h"
 #include "BGM_Types.h"
 
 
-static BGM_TaskQueue taskQueue;
-
 static const AudioServerPlugInClientInfo client1Info = {
     /* mClientID = */ 1,
     /* mProcessID = */ 2291,
@@ -109,7 +106,7 @@ static BGM_Client client2(&client2Info);
 }
 
 - (void)testAddRemoveClient {
-    BGM_ClientMap clientMap(&taskQueue);
+    BGM_ClientMap clientMap;
     
     // Add a client
     clientMap.AddClient(client1);
@@ -155,7 +152,7 @@ static BGM_Client client2(&client2Info);
 }
 
 - (void)testAddRemoveMultipleClients {
-    BGM_ClientMap clientMap(&taskQueue);
+    BGM_ClientMap clientMap;
     
     // Add the clients
     clientMap.AddClient(client1);
@@ -201,7 +198,7 @@ static BGM_Client client2(&client2Info);
 }
 
 - (void)testAddClientSeveralTimes {
-    BGM_ClientMap clientMap(&taskQueue);
+    BGM_ClientMap clientMap;
     
     // Adding a client once should work
     clientMap.AddClient(client2);
@@ -29,8 +29,13 @@
 // BGMDriver Includes
 #include "BGM_Types.h"
 
+// PublicUtility Includes
+#include "CAHostTimeBase.h"
+
+// STL Includes
+#include <algorithm>
+#include <cmath>
 
-static BGM_TaskQueue taskQueue;
 
 static const AudioServerPlugInClientInfo client1Info = {
     /* mClientID = */ 11,
@@ -57,7 +62,7 @@ static const AudioServerPlugInClientInfo client2Info = {
 - (void)setUp {
     [super setUp];
     
-    clients = new BGM_Clients(kAudioObjectUnknown, &taskQueue);
+    clients = new BGM_Clients(kAudioObjectUnknown);
 }
 
 - (void)tearDown {
@@ -126,5 +131,771 @@ static const AudioServerPlugInClientInfo client2Info = {
     });
 }
 
-@end
+- (void)testRoutingChannelMatrix {
+    const UInt32 kFrames = 256;
+    
+    clients->AddClient(&client1Info);
+    clients->AddClient(&client2Info);
+    
+    auto setRoutes = [&](NSArray* routes) {
+        return clients->SetRoutesFromArray(CACFArray((__bridge CFArrayRef)routes, false));
+    };
+    
+    // Route client 1's left channel to client 2's right channel only
+    XCTAssert(setRoutes(@[ @{ @kBGMAppRoutingKey_SourceProcessID: @(client1Info.mProcessID),
+                              @kBGMAppRoutingKey_DestProcessID: @(client2Info.mProcessID),
+                              @kBGMAppRoutingKey_SourceChannel: @0,
+                              @kBGMAppRoutingKey_DestChannel: @1,
+                              @kBGMAppRoutingKey_Gain: @0.5 } ]));
+    XCTAssert(clients->HasIncomingRoutesRT(client2Info.mClientID));
+    XCTAssertFalse(clients->HasIncomingRoutesRT(client1Info.mClientID));
+    
+    Float32 sourceBuffer[kFrames * 2];
+    for(UInt32 i = 0; i < kFrames; i++)
+    {
+        sourceBuffer[i * 2] = 0.5f;       // Left
+        sourceBuffer[i * 2 + 1] = -0.25f; // Right
+    }
+    
+    clients->StoreClientAudioRT(client1Info.mClientID, sourceBuffer, kFrames, 0);
+    
+    Float32 destBuffer[kFrames * 2] = {};
+    clients->MixRoutedAudioRT(client2Info.mClientID, destBuffer, kFrames, 0);
+    
+    for(UInt32 i = 0; i < kFrames; i++)
+    {
+        XCTAssertEqual(destBuffer[i * 2], 0.0f);
+        XCTAssertEqual(destBuffer[i * 2 + 1], 0.25f);
+    }
+    
+    // Change it to a mono sum
+    XCTAssert(setRoutes(@[ @{ @kBGMAppRoutingKey_SourceProcessID: @(client1Info.mProcessID),
+                              @kBGMAppRoutingKey_DestProcessID: @(client2Info.mProcessID),
+                              @kBGMAppRoutingKey_SourceChannel: @(kBGMAppRoutingChannelAll),
+                              @kBGMAppRoutingKey_DestChannel: @(kBGMAppRoutingChannelAll),
+                              @kBGMAppRoutingKey_Gain: @0.5 } ]));
+    
+    clients->StoreClientAudioRT(client1Info.mClientID, sourceBuffer, kFrames, kFrames);
+    memset(destBuffer, 0, sizeof(destBuffer));
+    clients->MixRoutedAudioRT(client2Info.mClientID, destBuffer, kFrames, kFrames);
+    
+    for(UInt32 i = 0; i < kFrames * 2; i++)
+    {
+        XCTAssertEqual(destBuffer[i], 0.125f);
+    }
+    
+    // Setting the same matrix again shouldn't change anything
+    XCTAssertFalse(setRoutes(@[ @{ @kBGMAppRoutingKey_SourceProcessID: @(client1Info.mProcessID),
+                                   @kBGMAppRoutingKey_DestProcessID: @(client2Info.mProcessID),
+                                   @kBGMAppRoutingKey_SourceChannel: @(kBGMAppRoutingChannelAll),
+                                   @kBGMAppRoutingKey_DestChannel: @(kBGMAppRoutingChannelAll),
+                                   @kBGMAppRoutingKey_Gain: @0.5 } ]));
+    
+    // The route should be returned as its overall settings and each matrix entry
+    NSArray* routes = (__bridge_transfer NSArray*)clients->CopyRoutesAsArray();
+    XCTAssertEqual(routes.count, 1 + 4);
+    
+    // Invalid channels should be ignored
+    XCTAssertFalse(setRoutes(@[ @{ @kBGMAppRoutingKey_SourceProcessID: @(client1Info.mProcessID),
+                                   @kBGMAppRoutingKey_DestProcessID: @(client2Info.mProcessID),
+                                   @kBGMAppRoutingKey_SourceChannel: @2,
+                                   @kBGMAppRoutingKey_DestChannel: @0 } ]));
+}
+
+- (void)testRouteSampleTimeAlignmentAndDelay {
+    const UInt32 kFrames = 128;
+    
+    clients->AddClient(&client1Info);
+    clients->AddClient(&client2Info);
+    
+    auto setRoutes = [&](NSArray* routes) {
+        return clients->SetRoutesFromArray(CACFArray((__bridge CFArrayRef)routes, false));
+    };
+    
+    XCTAssert(setRoutes(@[ @{ @kBGMAppRoutingKey_SourceProcessID: @(client1Info.mProcessID),
+                              @kBGMAppRoutingKey_DestProcessID: @(client2Info.mProcessID) } ]));
+    
+    // The source plays a different value in each of two IO cycles
+    Float32 sourceBuffer[kFrames * 2];
+    std::fill(sourceBuffer, sourceBuffer + kFrames * 2, 0.25f);
+    clients->StoreClientAudioRT(client1Info.mClientID, sourceBuffer, kFrames, 0);
+    std::fill(sourceBuffer, sourceBuffer + kFrames * 2, 0.5f);
+    clients->StoreClientAudioRT(client1Info.mClientID, sourceBuffer, kFrames, kFrames);
+    
+    // The destination should get the audio for the sample time it reads, not the most recent audio,
+    // so it doesn't matter whether the source's second cycle ran first
+    Float32 destBuffer[kFrames * 2] = {};
+    clients->MixRoutedAudioRT(client2Info.mClientID, destBuffer, kFrames, 0);
+    
+    for(UInt32 i = 0; i < kFrames * 2; i++)
+    {
+        XCTAssertEqual(destBuffer[i], 0.25f);
+    }
+    
+    // Delay the route by half a cycle
+    XCTAssert(setRoutes(@[ @{ @kBGMAppRoutingKey_SourceProcessID: @(client1Info.mProcessID),
+                              @kBGMAppRoutingKey_DestProcessID: @(client2Info.mProcessID),
+                              @kBGMAppRoutingKey_DelayFrames: @(kFrames / 2) } ]));
+    
+    memset(destBuffer, 0, sizeof(destBuffer));
+    clients->MixRoutedAudioRT(client2Info.mClientID, destBuffer, kFrames, kFrames);
+    
+    for(UInt32 i = 0; i < kFrames; i++)
+    {
+        Float32 expected = (i < kFrames / 2) ? 0.25f : 0.5f;
+        XCTAssertEqual(destBuffer[i * 2], expected);
+        XCTAssertEqual(destBuffer[i * 2 + 1], expected);
+    }
+    
+    // The delay should be reported as the route's latency
+    NSArray* routes = (__bridge_transfer NSArray*)clients->CopyRoutesAsArray();
+    XCTAssertEqual(routes.count, 1);
+    XCTAssertEqualObjects(routes[0][@kBGMAppRoutingKey_DelayFrames], @(kFrames / 2));
+    XCTAssertEqualObjects(routes[0][@kBGMAppRoutingKey_LatencyFrames], @(kFrames / 2));
+    
+    // Delays over the maximum should be ignored
+    XCTAssertFalse(setRoutes(@[ @{ @kBGMAppRoutingKey_SourceProcessID: @(client1Info.mProcessID),
+                                   @kBGMAppRoutingKey_DestProcessID: @(client2Info.mProcessID),
+                                   @kBGMAppRoutingKey_DelayFrames: @(kBGMAppRoutingMaxDelayFrames + 1) } ]));
+}
+
+- (void)testBundleIDRouteAttachesToNewClients {
+    const UInt32 kFrames = 128;
+    
+    clients->AddClient(&client2Info);
+    
+    // Route client 1's app, which has no clients yet, to client 2 by bundle ID
+    NSArray* routes = @[ @{ @kBGMAppRoutingKey_SourceBundleID: (__bridge NSString*)client1Info.mBundleID,
+                            @kBGMAppRoutingKey_DestProcessID: @(client2Info.mProcessID),
+                            @kBGMAppRoutingKey_Gain: @0.5 } ];
+    XCTAssert(clients->SetRoutesFromArray(CACFArray((__bridge CFArrayRef)routes, false)));
+    XCTAssertFalse(clients->HasIncomingRoutesRT(client2Info.mClientID));
+    
+    // A helper process of the source app connects. It should be attached to the route as soon as
+    // it's added.
+    AudioServerPlugInClientInfo helperInfo = client1Info;
+    helperInfo.mClientID = 31;
+    helperInfo.mProcessID = 333;
+    clients->AddClient(&helperInfo);
+    XCTAssert(clients->HasIncomingRoutesRT(client2Info.mClientID));
+    
+    Float32 sourceBuffer[kFrames * 2];
+    std::fill(sourceBuffer, sourceBuffer + kFrames * 2, 0.5f);
+    clients->StoreClientAudioRT(helperInfo.mClientID, sourceBuffer, kFrames, 0);
+    
+    Float32 destBuffer[kFrames * 2] = {};
+    clients->MixRoutedAudioRT(client2Info.mClientID, destBuffer, kFrames, 0);
+    
+    for(UInt32 i = 0; i < kFrames * 2; i++)
+    {
+        XCTAssertEqual(destBuffer[i], 0.25f);
+    }
+    
+    // The route should be returned with its bundle ID
+    NSArray* copiedRoutes = (__bridge_transfer NSArray*)clients->CopyRoutesAsArray();
+    XCTAssertEqual(copiedRoutes.count, 1);
+    XCTAssertEqualObjects(copiedRoutes[0][@kBGMAppRoutingKey_SourceBundleID],
+                          (__bridge NSString*)client1Info.mBundleID);
+    
+    // The route should be detached when the helper disconnects
+    clients->RemoveClient(helperInfo.mClientID);
+    XCTAssertFalse(clients->HasIncomingRoutesRT(client2Info.mClientID));
+}
+
+- (void)testBundleIDRouteClientChurnPerformance {
+    // Simulates an app that keeps starting and stopping helper processes while it's routed, e.g. a
+    // browser opening and closing tabs
+    const UInt32 kConnections = 2000;
+    
+    clients->AddClient(&client2Info);
+    
+    NSArray* routes = @[ @{ @kBGMAppRoutingKey_SourceBundleID: (__bridge NSString*)client1Info.mBundleID,
+                            @kBGMAppRoutingKey_DestProcessID: @(client2Info.mProcessID) } ];
+    XCTAssert(clients->SetRoutesFromArray(CACFArray((__bridge CFArrayRef)routes, false)));
+    
+    // Unrouted clients, which shouldn't slow down connecting the routed ones much
+    for(UInt32 i = 0; i < 200; i++)
+    {
+        AudioServerPlugInClientInfo otherInfo = client2Info;
+        otherInfo.mClientID = 1000 + i;
+        otherInfo.mProcessID = 1000 + static_cast<pid_t>(i);
+        otherInfo.mBundleID = CFSTR("com.bearisdriving.BGMDriver.Unrouted");
+        clients->AddClient(&otherInfo);
+    }
+    
+    __block UInt32 nextClientID = 10000;
+    
+    [self measureBlock:^{
+        for(UInt32 i = 0; i < kConnections; i++)
+        {
+            AudioServerPlugInClientInfo helperInfo = client1Info;
+            helperInfo.mClientID = nextClientID++;
+            helperInfo.mProcessID = static_cast<pid_t>(helperInfo.mClientID);
+            
+            clients->AddClient(&helperInfo);
+            XCTAssert(clients->HasIncomingRoutesRT(client2Info.mClientID));
+            
+            clients->RemoveClient(helperInfo.mClientID);
+        }
+    }];
+    
+    XCTAssertFalse(clients->HasIncomingRoutesRT(client2Info.mClientID));
+}
+
+- (void)testEQStateSurvivesSettingChanges {
+    const UInt32 kFrames = 64;
+    const UInt32 kBuffers = 8;
+    
+    clients->AddClient(&client1Info);
+    clients->SetSampleRate(44100.0);
+    
+    auto setVolume = [&](int volume) {
+        NSArray* appVolumes = @[ @{ @kBGMAppVolumesKey_ProcessID: @(client1Info.mProcessID),
+                                    @kBGMAppVolumesKey_RelativeVolume: @(volume),
+                                    @kBGMAppVolumesKey_EQLowGain: @120 } ];
+        return clients->SetClientsRelativeVolumes(CACFArray((__bridge CFArrayRef)appVolumes, false));
+    };
+    
+    XCTAssert(setVolume(50));
+    
+    // Copy the EQ coefficients, since the client will move between the client maps.
+    BGM_Client* client = clients->GetClientForEQRT(client1Info.mClientID);
+    XCTAssert(client != nullptr);
+    
+    Float32 coeffs[BGM_ClientDSPStatePool::kEQBands][5];
+    std::copy(client->mEQLowCoeffs, client->mEQLowCoeffs + 5, coeffs[0]);
+    std::copy(client->mEQMidCoeffs, client->mEQMidCoeffs + 5, coeffs[1]);
+    std::copy(client->mEQHighCoeffs, client->mEQHighCoeffs + 5, coeffs[2]);
+    const Float32* const coeffPtrs[BGM_ClientDSPStatePool::kEQBands] = { coeffs[0], coeffs[1], coeffs[2] };
+    
+    // The EQ's response to an impulse, processed in one go
+    Float32 expected[kFrames * kBuffers * 2] = {};
+    expected[0] = expected[1] = 1.0f;
+    
+    BGM_ClientDSPStatePool referencePool;
+    referencePool.ApplyEQRT(referencePool.AllocateSlot(), coeffPtrs, expected, kFrames * kBuffers);
+    
+    // Process the impulse in several buffers, changing the client's volume after each one, which
+    // switches the IO thread to the other copy of the client. The EQ should carry on from where it
+    // was, as if nothing had changed.
+    for(UInt32 i = 0; i < kBuffers; i++)
+    {
+        Float32 buffer[kFrames * 2] = {};
+        buffer[0] = buffer[1] = (i == 0) ? 1.0f : 0.0f;
+        
+        client = clients->GetClientForEQRT(client1Info.mClientID);
+        XCTAssert(client != nullptr);
+        clients->ApplyClientEQRT(*client, coeffPtrs, buffer, kFrames);
+        
+        for(UInt32 j = 0; j < kFrames * 2; j++)
+        {
+            XCTAssertEqual(buffer[j], expected[i * kFrames * 2 + j]);
+        }
+        
+        XCTAssert(setVolume((i % 2 == 0) ? 60 : 50));
+    }
+}
+
+- (void)testCrossfaderCurves {
+    Float32 gainA, gainB;
+    
+    for(BGMCrossfaderCurve curve : { kBGMCrossfaderCurveLinear,
+                                     kBGMCrossfaderCurveEqualPower,
+                                     kBGMCrossfaderCurveCut })
+    {
+        // Only group A at one end and only group B at the other
+        BGM_Crossfader::CalculateGains(curve, -1.0f, gainA, gainB);
+        XCTAssertEqual(gainA, 1.0f);
+        XCTAssertEqual(gainB, 0.0f);
+        
+        BGM_Crossfader::CalculateGains(curve, 1.0f, gainA, gainB);
+        XCTAssertEqualWithAccuracy(gainA, 0.0f, 1.0e-6f);
+        XCTAssertEqual(gainB, 1.0f);
+        
+        // Positions outside the range are clamped
+        BGM_Crossfader::CalculateGains(curve, 3.0f, gainA, gainB);
+        XCTAssertEqualWithAccuracy(gainA, 0.0f, 1.0e-6f);
+        XCTAssertEqual(gainB, 1.0f);
+    }
+    
+    BGM_Crossfader::CalculateGains(kBGMCrossfaderCurveLinear, 0.0f, gainA, gainB);
+    XCTAssertEqual(gainA, 0.5f);
+    XCTAssertEqual(gainB, 0.5f);
+    
+    // The equal-power curve keeps the total power constant
+    for(Float32 position = -1.0f; position <= 1.0f; position += 0.125f)
+    {
+        BGM_Crossfader::CalculateGains(kBGMCrossfaderCurveEqualPower, position, gainA, gainB);
+        XCTAssertEqualWithAccuracy(gainA * gainA + gainB * gainB, 1.0f, 1.0e-5f);
+    }
+    
+    // The cut curve only fades out the group on the other side of the centre
+    BGM_Crossfader::CalculateGains(kBGMCrossfaderCurveCut, 0.0f, gainA, gainB);
+    XCTAssertEqual(gainA, 1.0f);
+    XCTAssertEqual(gainB, 1.0f);
+    BGM_Crossfader::CalculateGains(kBGMCrossfaderCurveCut, 0.5f, gainA, gainB);
+    XCTAssertEqual(gainA, 0.5f);
+    XCTAssertEqual(gainB, 1.0f);
+}
+
+- (void)testCrossfaderFadesClientsSmoothly {
+    const UInt32 kFrames = 512;
+    
+    clients->AddClient(&client1Info);
+    clients->SetSampleRate(44100.0);
+    
+    NSDictionary* crossfader = @{ @kBGMCrossfaderKey_GroupA: @[ (__bridge NSString*)client1Info.mBundleID ],
+                                  @kBGMCrossfaderKey_GroupB: @[ (__bridge NSString*)client2Info.mBundleID ],
+                                  @kBGMCrossfaderKey_Curve: @(kBGMCrossfaderCurveLinear),
+                                  @kBGMCrossfaderKey_Position: @-1.0f };
+    XCTAssert(clients->SetCrossfader(CACFDictionary((__bridge CFDictionaryRef)crossfader, false)));
+    XCTAssertFalse(clients->SetCrossfader(CACFDictionary((__bridge CFDictionaryRef)crossfader, false)));
+    
+    // Client 2 joins group B after the crossfader is set. It should start at group B's gain instead
+    // of fading in.
+    clients->AddClient(&client2Info);
+    
+    Float32 buffer1[kFrames * 2];
+    Float32 buffer2[kFrames * 2];
+    
+    std::fill(buffer1, buffer1 + kFrames * 2, 0.5f);
+    std::fill(buffer2, buffer2 + kFrames * 2, 0.5f);
+    clients->ApplyCrossfaderGainRT(client1Info.mClientID, buffer1, kFrames);
+    clients->ApplyCrossfaderGainRT(client2Info.mClientID, buffer2, kFrames);
+    XCTAssertEqual(buffer1[kFrames * 2 - 1], 0.5f);
+    XCTAssertEqual(buffer2[kFrames * 2 - 1], 0.0f);
+    
+    // Move the crossfader to group B's end by setting only the position
+    XCTAssert(clients->SetCrossfader(CACFDictionary((__bridge CFDictionaryRef)@{ @kBGMCrossfaderKey_Position: @1.0f }, false)));
+    
+    // The gains should change gradually, without jumps, and reach the new position's gains
+    Float32 previousSample1 = 0.5f;
+    Float32 previousSample2 = 0.0f;
+    
+    for(UInt32 cycle = 0; cycle < 200; cycle++)
+    {
+        std::fill(buffer1, buffer1 + kFrames * 2, 0.5f);
+        std::fill(buffer2, buffer2 + kFrames * 2, 0.5f);
+        clients->ApplyCrossfaderGainRT(client1Info.mClientID, buffer1, kFrames);
+        clients->ApplyCrossfaderGainRT(client2Info.mClientID, buffer2, kFrames);
+        
+        for(UInt32 i = 0; i < kFrames * 2; i += 2)
+        {
+            XCTAssertLessThanOrEqual(buffer1[i], previousSample1);
+            XCTAssertGreaterThanOrEqual(buffer2[i], previousSample2);
+            XCTAssertLessThan(std::fabs(buffer1[i] - previousSample1), 0.01f);
+            XCTAssertLessThan(std::fabs(buffer2[i] - previousSample2), 0.01f);
+            previousSample1 = buffer1[i];
+            previousSample2 = buffer2[i];
+        }
+    }
+    
+    XCTAssertEqual(previousSample1, 0.0f);
+    XCTAssertEqual(previousSample2, 0.5f);
+    
+    // Setting the position shouldn't have changed the groups
+    CACFDictionary copiedCrossfader = clients->CopyCrossfaderAsDictionary();
+    NSDictionary* copied = (__bridge_transfer NSDictionary*)copiedCrossfader.GetDict();
+    XCTAssertEqualObjects(copied[@kBGMCrossfaderKey_GroupA], crossfader[@kBGMCrossfaderKey_GroupA]);
+    XCTAssertEqualObjects(copied[@kBGMCrossfaderKey_GroupB], crossfader[@kBGMCrossfaderKey_GroupB]);
+    XCTAssertEqualObjects(copied[@kBGMCrossfaderKey_Position], @1.0f);
+    XCTAssertEqualObjects(copied[@kBGMCrossfaderKey_Curve], @(kBGMCrossfaderCurveLinear));
+    
+    // Clients that aren't in either group aren't changed
+    clients->RemoveClient(client2Info.mClientID);
+    clients->SetCrossfader(CACFDictionary((__bridge CFDictionaryRef)@{ @kBGMCrossfaderKey_GroupB: @[] }, false));
+    clients->AddClient(&client2Info);
+    std::fill(buffer2, buffer2 + kFrames * 2, 0.5f);
+    clients->ApplyCrossfaderGainRT(client2Info.mClientID, buffer2, kFrames);
+    XCTAssertEqual(buffer2[0], 0.5f);
+}
+
+- (void)testCrossfaderInvalidSettings {
+    NSString* app = (__bridge NSString*)client1Info.mBundleID;
+    
+    // An app can't be in both groups
+    BGMShouldThrow<BGM_InvalidClientException>(self, [&](){
+        NSDictionary* crossfader = @{ @kBGMCrossfaderKey_GroupA: @[ app ], @kBGMCrossfaderKey_GroupB: @[ app ] };
+        clients->SetCrossfader(CACFDictionary((__bridge CFDictionaryRef)crossfader, false));
+    });
+    
+    BGMShouldThrow<BGM_InvalidClientException>(self, [&](){
+        NSDictionary* crossfader = @{ @kBGMCrossfaderKey_Curve: @1234 };
+        clients->SetCrossfader(CACFDictionary((__bridge CFDictionaryRef)crossfader, false));
+    });
+    
+    // Neither should have changed the settings
+    NSDictionary* copied = (__bridge_transfer NSDictionary*)clients->CopyCrossfaderAsDictionary().GetDict();
+    XCTAssertEqualObjects(copied[@kBGMCrossfaderKey_GroupA], @[]);
+    XCTAssertEqualObjects(copied[@kBGMCrossfaderKey_Curve], @(kBGMCrossfaderCurveEqualPower));
+}
+
+- (void)testAppAutomation {
+    const UInt32 kFrames = 512;
+    const UInt32 kEventFrame = 100;
+    
+    clients->AddClient(&client1Info);
+    clients->AddClient(&client2Info);
+    clients->SetSampleRate(44100.0);
+    
+    // Schedule the event far enough in the future that it's still pending when we check for it
+    Float64 hostTicksPerFrame = CAHostTimeBase::GetFrequency() / 44100.0;
+    UInt64 eventHostTime = CAHostTimeBase::GetCurrentTime() +
+                           static_cast<UInt64>(CAHostTimeBase::GetFrequency() * 60.0);
+    
+    NSArray* events = @[ @{ @kBGMAppAutomationKey_BundleID: (__bridge NSString*)client1Info.mBundleID,
+                            @kBGMAppAutomationKey_HostTime: @(eventHostTime),
+                            @kBGMAppAutomationKey_GainDB: @-6.0f } ];
+    XCTAssert(clients->SetAppAutomation(CACFArray((__bridge CFArrayRef)events, false)));
+    
+    NSArray* copied = (__bridge_transfer NSArray*)clients->CopyAppAutomationAsArray().GetCFArray();
+    XCTAssertEqual(copied.count, 1);
+    XCTAssertEqualObjects(copied[0][@kBGMAppAutomationKey_GainDB], @-6.0f);
+    XCTAssertEqualObjects(copied[0][@kBGMAppAutomationKey_HostTime], @(eventHostTime));
+    
+    // Events can't be scheduled before one that's already scheduled for the same app
+    BGMShouldThrow<BGM_InvalidClientException>(self, [&](){
+        NSArray* earlierEvents = @[ @{ @kBGMAppAutomationKey_BundleID: (__bridge NSString*)client1Info.mBundleID,
+                                       @kBGMAppAutomationKey_HostTime: @(eventHostTime - 1),
+                                       @kBGMAppAutomationKey_GainDB: @0.0f } ];
+        clients->SetAppAutomation(CACFArray((__bridge CFArrayRef)earlierEvents, false));
+    });
+    
+    // Events need a gain
+    BGMShouldThrow<BGM_InvalidClientException>(self, [&](){
+        NSArray* invalidEvents = @[ @{ @kBGMAppAutomationKey_ProcessID: @(client2Info.mProcessID) } ];
+        clients->SetAppAutomation(CACFArray((__bridge CFArrayRef)invalidEvents, false));
+    });
+    
+    // Simulate an IO cycle with the event on its 100th frame
+    AudioTimeStamp outputTime = {};
+    outputTime.mSampleTime = 0.0;
+    outputTime.mHostTime = eventHostTime - static_cast<UInt64>(std::llround(kEventFrame * hostTicksPerFrame));
+    outputTime.mFlags = kAudioTimeStampSampleHostTimeValid;
+    
+    Float32 buffer1[kFrames * 2];
+    Float32 buffer2[kFrames * 2];
+    std::fill(buffer1, buffer1 + kFrames * 2, 0.5f);
+    std::fill(buffer2, buffer2 + kFrames * 2, 0.5f);
+    
+    clients->ApplyAppAutomationRT(client1Info.mClientID, buffer1, kFrames, outputTime);
+    clients->ApplyAppAutomationRT(client2Info.mClientID, buffer2, kFrames, outputTime);
+    
+    // The gain should change on exactly the event's frame
+    XCTAssertEqual(buffer1[(kEventFrame - 1) * 2], 0.5f);
+    XCTAssertEqualWithAccuracy(buffer1[kEventFrame * 2], 0.5f * std::pow(10.0f, -6.0f / 20.0f), 1.0e-6f);
+    XCTAssertEqualWithAccuracy(buffer1[kFrames * 2 - 1], 0.5f * std::pow(10.0f, -6.0f / 20.0f), 1.0e-6f);
+    
+    // Other apps' clients shouldn't be affected
+    XCTAssertEqual(buffer2[kFrames * 2 - 1], 0.5f);
+}
+
+- (void)testSharedParameterTable {
+    clients->AddClient(&client1Info);
+    clients->AddClient(&client2Info);
+    
+    BGMParameterTable* table = clients->GetParameterTable();
+    XCTAssert(table != nullptr);
+    
+    // Nothing's been set in the table, so the defaults should be used
+    XCTAssertEqual(clients->GetClientRelativeVolumeRT(client1Info.mClientID), 1.0f);
+    XCTAssertEqual(clients->GetClientPanPositionRT(client1Info.mClientID), 0.0f);
+    
+    // Values in the table should override the client's
+    XCTAssert(BGMParameterTableSetValue(table, client1Info.mProcessID, kBGMParameterRelativeVolume, 25.0f));
+    XCTAssert(BGMParameterTableSetValue(table, client1Info.mProcessID, kBGMParameterPanPosition, -40.5f));
+    
+    Float32 lowerVolume = clients->GetClientRelativeVolumeRT(client1Info.mClientID);
+    XCTAssertLessThan(lowerVolume, 1.0f);
+    XCTAssertEqual(clients->GetClientPanPositionRT(client1Info.mClientID), -40.5f);
+    
+    // Fractional volumes should be between the steps either side of them
+    XCTAssert(BGMParameterTableSetValue(table, client1Info.mProcessID, kBGMParameterRelativeVolume, 26.0f));
+    Float32 upperVolume = clients->GetClientRelativeVolumeRT(client1Info.mClientID);
+    XCTAssert(BGMParameterTableSetValue(table, client1Info.mProcessID, kBGMParameterRelativeVolume, 25.5f));
+    Float32 midVolume = clients->GetClientRelativeVolumeRT(client1Info.mClientID);
+    XCTAssertGreaterThan(midVolume, lowerVolume);
+    XCTAssertLessThan(midVolume, upperVolume);
+    
+    // Out-of-range pan positions should be clamped
+    XCTAssert(BGMParameterTableSetValue(table, client1Info.mProcessID, kBGMParameterPanPosition, 1000.0f));
+    XCTAssertEqual(clients->GetClientPanPositionRT(client1Info.mClientID), static_cast<Float32>(kAppPanRightRawValue));
+    
+    // Other apps' clients shouldn't be affected
+    XCTAssertEqual(clients->GetClientRelativeVolumeRT(client2Info.mClientID), 1.0f);
+    
+    // Setting the volume with the property should clear the table's value, but not the pan position
+    NSArray* appVolumes = @[ @{ @kBGMAppVolumesKey_ProcessID: @(client1Info.mProcessID),
+                                @kBGMAppVolumesKey_RelativeVolume: @(kAppRelativeVolumeMaxRawValue / 2) } ];
+    XCTAssert(clients->SetClientsRelativeVolumes(CACFArray((__bridge CFArrayRef)appVolumes, false)));
+    XCTAssertEqualWithAccuracy(clients->GetClientRelativeVolumeRT(client1Info.mClientID), 1.0f, 1.0e-4f);
+    XCTAssertEqual(clients->GetClientPanPositionRT(client1Info.mClientID), static_cast<Float32>(kAppPanRightRawValue));
+    
+    // The app's values should be unset when its last client is removed, so a new process with the
+    // same PID doesn't get them
+    clients->RemoveClient(client1Info.mClientID);
+    clients->AddClient(&client1Info);
+    XCTAssertEqualWithAccuracy(clients->GetClientRelativeVolumeRT(client1Info.mClientID), 1.0f, 1.0e-4f);
+    XCTAssertEqual(clients->GetClientPanPositionRT(client1Info.mClientID), 0.0f);
+    
+    // Until it sets them again
+    XCTAssert(BGMParameterTableSetValue(table, client1Info.mProcessID, kBGMParameterPanPosition, -40.5f));
+    XCTAssertEqual(clients->GetClientPanPositionRT(client1Info.mClientID), -40.5f);
+}
 
+- (void)testScene {
+    const UInt32 kFrames = 441;
+    
+    clients->AddClient(&client1Info);
+    clients->AddClient(&client2Info);
+    clients->SetSampleRate(44100.0);
+    
+    auto setScene = [&](NSDictionary* scene) {
+        return clients->SetScene(CACFDictionary((__bridge CFDictionaryRef)scene, false));
+    };
+    
+    // Apply a scene immediately
+    XCTAssert(setScene(@{ @kBGMSceneKey_AppVolumes: @[ @{ @kBGMAppVolumesKey_ProcessID: @(client1Info.mProcessID),
+                                                          @kBGMAppVolumesKey_RelativeVolume: @(kAppRelativeVolumeMinRawValue),
+                                                          @kBGMAppVolumesKey_PanPosition: @(kAppPanLeftRawValue) } ],
+                          @kBGMSceneKey_Routes: @[ @{ @kBGMAppRoutingKey_SourceProcessID: @(client1Info.mProcessID),
+                                                      @kBGMAppRoutingKey_DestProcessID: @(client2Info.mProcessID) } ],
+                          @kBGMSceneKey_MusicPlayerProcessID: @(client2Info.mProcessID) }));
+    
+    BGM_SceneMorphSegment segment;
+    XCTAssertFalse(clients->GetSceneMorphRT(client1Info.mClientID, kFrames, segment));
+    XCTAssertLessThan(clients->GetClientRelativeVolumeRT(client1Info.mClientID), 1.0f);
+    XCTAssertEqual(clients->GetClientPanPositionRT(client1Info.mClientID), static_cast<Float32>(kAppPanLeftRawValue));
+    XCTAssert(clients->HasIncomingRoutesRT(client2Info.mClientID));
+    XCTAssert(clients->IsMusicPlayerRT(client2Info.mClientID));
+    
+    // Morph to another scene over 100 ms, i.e. 10 buffers. The routes and the music player should
+    // change immediately.
+    XCTAssert(setScene(@{ @kBGMSceneKey_AppVolumes: @[ @{ @kBGMAppVolumesKey_ProcessID: @(client1Info.mProcessID),
+                                                          @kBGMAppVolumesKey_RelativeVolume: @(kAppRelativeVolumeMaxRawValue),
+                                                          @kBGMAppVolumesKey_PanPosition: @(kAppPanRightRawValue),
+                                                          @kBGMAppVolumesKey_EQMidGain: @60 } ],
+                          @kBGMSceneKey_Routes: @[],
+                          @kBGMSceneKey_MusicPlayerBundleID: (__bridge NSString*)client1Info.mBundleID,
+                          @kBGMSceneKey_MorphMillis: @100 }));
+    
+    XCTAssertFalse(clients->HasIncomingRoutesRT(client2Info.mClientID));
+    XCTAssert(clients->IsMusicPlayerRT(client1Info.mClientID));
+    XCTAssertFalse(clients->IsMusicPlayerRT(client2Info.mClientID));
+    
+    Float32 previousPan = -1.0f;
+    Float32 previousVolume = clients->GetClientRelativeVolumeRT(client1Info.mClientID);
+    
+    for(int i = 0; i < 10; i++)
+    {
+        XCTAssert(clients->GetSceneMorphRT(client1Info.mClientID, kFrames, segment));
+        XCTAssertEqualWithAccuracy(segment.mStartPan, previousPan, 1.0e-5f);
+        XCTAssertEqualWithAccuracy(segment.mStartVolume, previousVolume, 1.0e-5f);
+        XCTAssertGreaterThan(segment.mEndPan, segment.mStartPan);
+        XCTAssertGreaterThan(segment.mEndVolume, segment.mStartVolume);
+        XCTAssert(segment.mHasEQ);
+        previousPan = segment.mEndPan;
+        previousVolume = segment.mEndVolume;
+    }
+    
+    XCTAssertEqual(previousPan, 1.0f);
+    
+    // The morph has finished, so the client's own settings, which are the scene's, should be used
+    XCTAssertFalse(clients->GetSceneMorphRT(client1Info.mClientID, kFrames, segment));
+    XCTAssertEqual(clients->GetClientPanPositionRT(client1Info.mClientID), static_cast<Float32>(kAppPanRightRawValue));
+    XCTAssertEqualWithAccuracy(clients->GetClientRelativeVolumeRT(client1Info.mClientID), previousVolume, 1.0e-5f);
+    
+    // Clients the scene doesn't mention shouldn't morph
+    XCTAssertFalse(clients->GetSceneMorphRT(client2Info.mClientID, kFrames, segment));
+    
+    // Getting the scene should return what was set
+    NSDictionary* scene = (__bridge_transfer NSDictionary*)clients->CopySceneAsDictionary().GetDict();
+    XCTAssertEqualObjects(scene[@kBGMSceneKey_MusicPlayerBundleID], (__bridge NSString*)client1Info.mBundleID);
+    XCTAssertEqual([scene[@kBGMSceneKey_Routes] count], 0);
+    XCTAssertEqual([scene[@kBGMSceneKey_AppVolumes] count], 1);
+    XCTAssertEqualObjects(scene[@kBGMSceneKey_AppVolumes][0][@kBGMAppVolumesKey_EQMidGain], @60);
+    
+    // Invalid scenes shouldn't change anything
+    BGMShouldThrow<BGM_InvalidClientException>(self, [&](){
+        setScene(@{ @kBGMSceneKey_AppVolumes: @[ @{ @kBGMAppVolumesKey_ProcessID: @(client1Info.mProcessID),
+                                                    @kBGMAppVolumesKey_RelativeVolume: @(kAppRelativeVolumeMinRawValue) } ],
+                    @kBGMSceneKey_MorphMillis: @(kBGMSceneMaxMorphMillis + 1) });
+    });
+    BGMShouldThrow<BGM_InvalidClientRelativeVolumeException>(self, [&](){
+        setScene(@{ @kBGMSceneKey_AppVolumes: @[ @{ @kBGMAppVolumesKey_ProcessID: @(client1Info.mProcessID),
+                                                    @kBGMAppVolumesKey_RelativeVolume: @(kAppRelativeVolumeMaxRawValue + 1) } ],
+                    @kBGMSceneKey_MusicPlayerProcessID: @(client2Info.mProcessID) });
+    });
+    XCTAssertEqual(clients->GetClientPanPositionRT(client1Info.mClientID), static_cast<Float32>(kAppPanRightRawValue));
+    XCTAssert(clients->IsMusicPlayerRT(client1Info.mClientID));
+    
+    // Empty scenes don't change anything either
+    XCTAssertFalse(setScene(@{}));
+}
+
+- (void)testDucking {
+    const UInt32 kFrames = 512;
+    
+    clients->AddClient(&client1Info);
+    clients->AddClient(&client2Info);
+    
+    auto setDucking = [&](NSDictionary* ducking) {
+        return clients->SetDucking(CACFDictionary((__bridge CFDictionaryRef)ducking, false));
+    };
+    
+    // Client two's app ducks client one's with no attack time
+    XCTAssert(setDucking(@{ @kBGMDuckingKey_Triggers: @[ (__bridge NSString*)client2Info.mBundleID ],
+                            @kBGMDuckingKey_Targets: @[ (__bridge NSString*)client1Info.mBundleID ],
+                            @kBGMDuckingKey_DepthDB: @-20.0f,
+                            @kBGMDuckingKey_AttackMillis: @0.0f }));
+    XCTAssertFalse(setDucking(@{ @kBGMDuckingKey_DepthDB: @-20.0f }));
+    
+    NSDictionary* ducking = (__bridge_transfer NSDictionary*)clients->CopyDuckingAsDictionary().GetDict();
+    XCTAssertEqualObjects(ducking[@kBGMDuckingKey_Triggers], @[ (__bridge NSString*)client2Info.mBundleID ]);
+    XCTAssertEqualObjects(ducking[@kBGMDuckingKey_DepthDB], @-20.0f);
+    XCTAssertEqualObjects(ducking[@kBGMDuckingKey_HoldMillis], @(kBGMDuckingDefaultHoldMillis));
+    
+    Float32 buffer1[kFrames * 2];
+    Float32 buffer2[kFrames * 2];
+    std::fill(buffer1, buffer1 + kFrames * 2, 0.5f);
+    std::fill(buffer2, buffer2 + kFrames * 2, 0.5f);
+    
+    // The trigger's audio is measured, but not changed, and the target is ducked in the same cycle
+    clients->ApplyDuckingRT(client2Info.mClientID, buffer2, kFrames, 0.0);
+    clients->ApplyDuckingRT(client1Info.mClientID, buffer1, kFrames, 0.0);
+    
+    XCTAssertEqual(buffer2[kFrames * 2 - 1], 0.5f);
+    XCTAssertEqual(buffer1[0], 0.5f);
+    XCTAssertLessThan(buffer1[kFrames * 2 - 1], 0.5f);
+    
+    // A new client of the target app should be ducked as well
+    AudioServerPlugInClientInfo client3Info = client1Info;
+    client3Info.mClientID = 33;
+    clients->AddClient(&client3Info);
+    
+    Float32 buffer3[kFrames * 2];
+    std::fill(buffer3, buffer3 + kFrames * 2, 0.5f);
+    clients->ApplyDuckingRT(client3Info.mClientID, buffer3, kFrames, kFrames);
+    XCTAssertEqualWithAccuracy(buffer3[0], 0.05f, 1.0e-6f);
+    
+    // Apps can't be both triggers and targets
+    BGMShouldThrow<BGM_InvalidClientException>(self, [&](){
+        setDucking(@{ @kBGMDuckingKey_Targets: @[ (__bridge NSString*)client2Info.mBundleID ] });
+    });
+}
+
+- (void)testDuckingSustainedTriggersOnly {
+    const UInt32 kFrames = 512;
+    
+    clients->SetSampleRate(44100.0);
+    clients->AddClient(&client1Info);
+    clients->AddClient(&client2Info);
+    
+    XCTAssert(clients->SetDucking(CACFDictionary((__bridge CFDictionaryRef)@{
+        @kBGMDuckingKey_Triggers: @[ (__bridge NSString*)client2Info.mBundleID ],
+        @kBGMDuckingKey_Targets: @[ (__bridge NSString*)client1Info.mBundleID ],
+        @kBGMDuckingKey_SustainedTriggersOnly: @YES,
+        @kBGMDuckingKey_AttackMillis: @0.0f }, false)));
+    
+    Float32 buffer1[kFrames * 2];
+    Float32 buffer2[kFrames * 2];
+    std::fill(buffer2, buffer2 + kFrames * 2, 0.5f);
+    
+    // The trigger's audio should only duck the target once it's been playing long enough to be
+    // classified as sustained
+    Float64 sampleTime = 0.0;
+    bool wasSustained = false;
+    
+    while(!wasSustained)
+    {
+        XCTAssertLessThan(sampleTime / 44100.0, 1.0);
+        
+        wasSustained = clients->ClassifyClientAudioRT(client2Info.mClientID, buffer2, kFrames);
+        clients->ApplyDuckingRT(client2Info.mClientID, buffer2, kFrames, sampleTime);
+        
+        std::fill(buffer1, buffer1 + kFrames * 2, 0.5f);
+        clients->ApplyDuckingRT(client1Info.mClientID, buffer1, kFrames, sampleTime);
+        
+        if(wasSustained)
+        {
+            XCTAssertLessThan(buffer1[kFrames * 2 - 1], 0.5f);
+        }
+        else
+        {
+            XCTAssertEqual(buffer1[kFrames * 2 - 1], 0.5f);
+        }
+        
+        sampleTime += kFrames;
+    }
+    
+    XCTAssertGreaterThanOrEqual(sampleTime / 44100.0, BGM_SignalClassifier::kMinSustainedSecs);
+}
+
+- (void)testLoudness {
+    const UInt32 kFrames = 512;
+    
+    clients->SetSampleRate(44100.0);
+    clients->AddClient(&client1Info);
+    clients->AddClient(&client2Info);
+    
+    // Every client should be in the loudness array, with nothing measured yet
+    NSArray* loudness = (__bridge_transfer NSArray*)clients->CopyLoudnessAsArray().GetCFArray();
+    XCTAssertEqual(loudness.count, 2);
+    XCTAssertEqualObjects(loudness[0][@kBGMLoudnessKey_IntegratedLUFS], @(kBGMLoudnessMinLUFS));
+    XCTAssertEqualObjects(loudness[0][@kBGMLoudnessKey_GainDB], @0.0f);
+    
+    // Turn normalization on with a target far above client one's level
+    NSDictionary* normalization = @{ @kBGMLoudnessNormalizationKey_Enabled: @YES,
+                                     @kBGMLoudnessNormalizationKey_TargetLUFS: @-10.0f,
+                                     @kBGMLoudnessNormalizationKey_MaxSlewDBPerSec: @100.0f };
+    XCTAssert(clients->SetLoudnessNormalization(CACFDictionary((__bridge CFDictionaryRef)normalization, false)));
+    XCTAssertFalse(clients->SetLoudnessNormalization(CACFDictionary((__bridge CFDictionaryRef)normalization, false)));
+    
+    // The slew rate is clamped
+    NSDictionary* settings =
+            (__bridge_transfer NSDictionary*)clients->CopyLoudnessNormalizationAsDictionary().GetDict();
+    XCTAssertEqualObjects(settings[@kBGMLoudnessNormalizationKey_MaxSlewDBPerSec],
+                          @(kBGMLoudnessNormalizationMaxSlewDBPerSec));
+    XCTAssertEqualObjects(settings[@kBGMLoudnessNormalizationKey_MaxGainDB],
+                          @(kBGMLoudnessNormalizationDefaultMaxGainDB));
+    
+    // One second of a quiet sine should be measured and boosted
+    Float32 buffer[kFrames * 2];
+    
+    for(UInt32 frame = 0; frame < 44100; frame += kFrames)
+    {
+        for(UInt32 i = 0; i < kFrames; i++)
+        {
+            buffer[i * 2] = buffer[i * 2 + 1] = 0.01f * std::sin(2.0f * M_PI * 1000.0f * (frame + i) / 44100.0f);
+        }
+        
+        clients->ApplyLoudnessNormalizationRT(client1Info.mClientID, buffer, kFrames);
+    }
+    
+    loudness = (__bridge_transfer NSArray*)clients->CopyLoudnessAsArray().GetCFArray();
+    
+    for(NSDictionary* clientLoudness in loudness)
+    {
+        if([clientLoudness[@kBGMLoudnessKey_ProcessID] isEqual:@(client1Info.mProcessID)])
+        {
+            // -40 dBFS
+            XCTAssertEqualWithAccuracy([clientLoudness[@kBGMLoudnessKey_ShortTermLUFS] floatValue], -40.0f, 0.1f);
+            XCTAssertEqualWithAccuracy([clientLoudness[@kBGMLoudnessKey_GainDB] floatValue],
+                                       kBGMLoudnessNormalizationDefaultMaxGainDB,
+                                       0.001f);
+        }
+        else
+        {
+            XCTAssertEqualObjects(clientLoudness[@kBGMLoudnessKey_GainDB], @0.0f);
+        }
+    }
+    
+    // Settings that aren't numbers should be rejected
+    BGMShouldThrow<BGM_InvalidClientException>(self, [&](){
+        clients->SetLoudnessNormalization(
+                CACFDictionary((__bridge CFDictionaryRef)@{ @kBGMLoudnessNormalizationKey_TargetLUFS: @(NAN) },
+                               false));
+    });
+}
+
+@end
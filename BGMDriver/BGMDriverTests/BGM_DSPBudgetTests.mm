@@ -0,0 +1,225 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+
+//
+//
+//  BGM_DSPBudgetTests.mm
+//  BGMDriverTests
+//
+//  Copyright © 2026 Background Music contributors
+//
+
+// Unit Include
+#include "BGM_DSPBudget.h"
+
+// System Includes
+#include <mach/mach_time.h>
+
+
+static const Float64 kSampleRate = 48000.0;
+static const UInt32 kBufferFrames = 480;
+
+// The time the budgets' clock reads, so the tests can step it.
+static UInt64 sNow;
+
+static UInt64 GetNow(void* inRefCon)
+{
+    #pragma unused (inRefCon)
+    return sNow;
+}
+
+@interface BGM_DSPBudgetTests : XCTestCase
+
+@end
+
+@implementation BGM_DSPBudgetTests {
+    // The length of a kBufferFrames cycle in host ticks.
+    Float64 mBudgetTicks;
+    // The output sample time of the next cycle.
+    Float64 mSampleTime;
+}
+
+- (void) setUp {
+    [super setUp];
+
+    mach_timebase_info_data_t theTimebase;
+    mach_timebase_info(&theTimebase);
+    const Float64 theHostTicksPerSecond = 1.0e9 * theTimebase.denom / theTimebase.numer;
+
+    mBudgetTicks = kBufferFrames / kSampleRate * theHostTicksPerSecond;
+    mSampleTime = 0.0;
+    sNow = mach_absolute_time();
+}
+
+// The output time of the next cycle if its budget starts at inCycleStart, i.e. its deadline is one
+// buffer later.
+- (AudioTimeStamp) outputTimeStartingAt:(UInt64)inCycleStart {
+    AudioTimeStamp theOutputTime = {};
+    theOutputTime.mSampleTime = mSampleTime;
+    theOutputTime.mHostTime = inCycleStart + static_cast<UInt64>(mBudgetTicks);
+    theOutputTime.mFlags = kAudioTimeStampSampleHostTimeValid;
+    return theOutputTime;
+}
+
+// Run a cycle that starts on time and uses inLoad of its budget. The cycles are back to back.
+- (void) runCycle:(BGM_DSPBudget&)ioBudget load:(Float64)inLoad {
+    const UInt64 theCycleStart = sNow;
+    ioBudget.BeginOperationRT(kBufferFrames, [self outputTimeStartingAt:theCycleStart]);
+    sNow += static_cast<UInt64>(inLoad * mBudgetTicks);
+    ioBudget.EndCycleRT();
+    sNow = theCycleStart + static_cast<UInt64>(mBudgetTicks);
+    mSampleTime += kBufferFrames;
+}
+
+// Make a budget that reads sNow.
+- (void) setUpBudget:(BGM_DSPBudget&)ioBudget {
+    ioBudget.SetSampleRate(kSampleRate);
+    ioBudget.SetClock(&GetNow, nullptr);
+}
+
+- (void) testLevelRisesWithinAnOverloadedCycle {
+    BGM_DSPBudget theBudget;
+    [self setUpBudget:theBudget];
+
+    const UInt64 theCycleStart = sNow;
+    const AudioTimeStamp theOutputTime = [self outputTimeStartingAt:theCycleStart];
+    theBudget.BeginOperationRT(kBufferFrames, theOutputTime);
+    XCTAssertEqual(theBudget.GetShedLevelRT(), BGM_DSPBudget::kShedNothing);
+    sNow = theCycleStart + static_cast<UInt64>(0.65 * mBudgetTicks);
+    XCTAssertEqual(theBudget.GetShedLevelRT(), BGM_DSPBudget::kShedSpectralFeatures);
+    sNow = theCycleStart + static_cast<UInt64>(0.8 * mBudgetTicks);
+    XCTAssertEqual(theBudget.GetShedLevelRT(), BGM_DSPBudget::kShedLowPriorityEQ);
+    sNow = theCycleStart + static_cast<UInt64>(0.95 * mBudgetTicks);
+    XCTAssertEqual(theBudget.GetShedLevelRT(), BGM_DSPBudget::kShedRouteMixing);
+
+    // The operations later in the cycle don't restart it.
+    theBudget.BeginOperationRT(kBufferFrames, theOutputTime);
+    XCTAssertEqual(theBudget.GetShedLevelRT(), BGM_DSPBudget::kShedRouteMixing);
+}
+
+- (void) testLateCycleIsShedSooner {
+    BGM_DSPBudget theBudget;
+    [self setUpBudget:theBudget];
+
+    // The HAL starts the cycle when most of its budget has already gone.
+    const UInt64 theCycleStart = sNow;
+    sNow = theCycleStart + static_cast<UInt64>(0.8 * mBudgetTicks);
+    theBudget.BeginOperationRT(kBufferFrames, [self outputTimeStartingAt:theCycleStart]);
+    XCTAssertEqual(theBudget.GetShedLevelRT(), BGM_DSPBudget::kShedLowPriorityEQ);
+
+    theBudget.EndCycleRT();
+    XCTAssertEqualWithAccuracy(theBudget.GetLastCycleLoad(), 0.8, 1.0e-3);
+    XCTAssertEqual(theBudget.GetSustainedShedLevel(), BGM_DSPBudget::kShedSpectralFeatures);
+}
+
+- (void) testEarlyCycleHasNoLoad {
+    BGM_DSPBudget theBudget;
+    [self setUpBudget:theBudget];
+
+    // The IO thread can wake before the cycle's budget starts.
+    const UInt64 theCycleStart = sNow;
+    sNow = theCycleStart - static_cast<UInt64>(0.5 * mBudgetTicks);
+    theBudget.BeginOperationRT(kBufferFrames, [self outputTimeStartingAt:theCycleStart]);
+    XCTAssertEqual(theBudget.GetShedLevelRT(), BGM_DSPBudget::kShedNothing);
+
+    theBudget.EndCycleRT();
+    XCTAssertEqual(theBudget.GetLastCycleLoad(), 0.0);
+}
+
+- (void) testCycleWithoutHostTimeIsTimedFromItsFirstOperation {
+    BGM_DSPBudget theBudget;
+    [self setUpBudget:theBudget];
+
+    AudioTimeStamp theOutputTime = {};
+    theOutputTime.mSampleTime = mSampleTime;
+    theOutputTime.mFlags = kAudioTimeStampSampleTimeValid;
+
+    theBudget.BeginOperationRT(kBufferFrames, theOutputTime);
+    sNow += static_cast<UInt64>(0.2 * mBudgetTicks);
+    theBudget.EndCycleRT();
+    XCTAssertEqualWithAccuracy(theBudget.GetLastCycleLoad(), 0.2, 1.0e-3);
+}
+
+- (void) testSustainedLevelHasHysteresis {
+    BGM_DSPBudget theBudget;
+    [self setUpBudget:theBudget];
+
+    // Each overloaded cycle raises the level by one.
+    [self runCycle:theBudget load:0.8];
+    XCTAssertEqual(theBudget.GetSustainedShedLevel(), BGM_DSPBudget::kShedSpectralFeatures);
+    [self runCycle:theBudget load:0.8];
+    [self runCycle:theBudget load:0.8];
+    [self runCycle:theBudget load:0.8];
+    XCTAssertEqual(theBudget.GetSustainedShedLevel(), BGM_DSPBudget::kShedRouteMixing);
+    XCTAssertEqualWithAccuracy(theBudget.GetLastCycleLoad(), 0.8, 1.0e-3);
+
+    // The level is used from the start of each cycle.
+    theBudget.BeginOperationRT(kBufferFrames, [self outputTimeStartingAt:sNow]);
+    XCTAssertEqual(theBudget.GetShedLevelRT(), BGM_DSPBudget::kShedRouteMixing);
+    theBudget.EndCycleRT();
+    sNow += static_cast<UInt64>(mBudgetTicks);
+    mSampleTime += kBufferFrames;
+
+    // Loads between the thresholds neither raise nor lower it.
+    for(UInt32 i = 0; i < 200; i++)
+    {
+        [self runCycle:theBudget load:0.6];
+    }
+
+    XCTAssertEqual(theBudget.GetSustainedShedLevel(), BGM_DSPBudget::kShedRouteMixing);
+
+    // Light loads lower it by one level per kRecoverySecs.
+    const UInt32 theCyclesPerRecovery =
+            static_cast<UInt32>(BGM_DSPBudget::kRecoverySecs * kSampleRate / kBufferFrames);
+
+    for(UInt32 i = 0; i < theCyclesPerRecovery - 2; i++)
+    {
+        [self runCycle:theBudget load:0.1];
+    }
+
+    XCTAssertEqual(theBudget.GetSustainedShedLevel(), BGM_DSPBudget::kShedRouteMixing);
+
+    for(UInt32 i = 0; i < 4; i++)
+    {
+        [self runCycle:theBudget load:0.1];
+    }
+
+    XCTAssertEqual(theBudget.GetSustainedShedLevel(), BGM_DSPBudget::kShedLowPriorityEQ);
+
+    theBudget.Reset();
+    XCTAssertEqual(theBudget.GetSustainedShedLevel(), BGM_DSPBudget::kShedNothing);
+}
+
+- (void) testAbandonedCycleIsRestarted {
+    BGM_DSPBudget theBudget;
+    [self setUpBudget:theBudget];
+
+    // A cycle that never wrote its mix, e.g. because IO stopped.
+    theBudget.BeginOperationRT(kBufferFrames, [self outputTimeStartingAt:sNow]);
+    sNow += static_cast<UInt64>(10 * mBudgetTicks);
+    mSampleTime += 10 * kBufferFrames;
+
+    // The next cycle's first operation starts a new budget.
+    const UInt64 theCycleStart = sNow;
+    theBudget.BeginOperationRT(kBufferFrames, [self outputTimeStartingAt:theCycleStart]);
+    XCTAssertEqual(theBudget.GetShedLevelRT(), BGM_DSPBudget::kShedNothing);
+    sNow += static_cast<UInt64>(0.2 * mBudgetTicks);
+    theBudget.EndCycleRT();
+    XCTAssertEqualWithAccuracy(theBudget.GetLastCycleLoad(), 0.2, 1.0e-3);
+}
+
+@end
+
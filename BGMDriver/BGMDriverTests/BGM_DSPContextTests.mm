@@ -0,0 +1,113 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+
+//
+//
+//  BGM_DSPContextTests.mm
+//  BGMDriverTests
+//
+//  Copyright © 2026 Background Music contributors
+//
+
+// Unit Include
+#include "BGM_DSPContext.h"
+
+// Local Includes
+#include "BGM_TestUtils.h"
+
+// STL Includes
+#include <limits>
+#include <vector>
+
+
+// Halve a number in a way the compiler can't do at compile time, so the CPU's mode applies.
+static Float32 Halve(Float32 inValue)
+{
+    volatile Float32 theValue = inValue;
+    return theValue * 0.5f;
+}
+
+@interface BGM_DSPContextTests : XCTestCase
+
+@end
+
+@implementation BGM_DSPContextTests
+
+- (void)testFlushesDenormalsInScope {
+#if defined(__x86_64__) || defined(__i386__) || defined(__arm64__) || defined(__aarch64__)
+    const Float32 kSmallestNormal = std::numeric_limits<Float32>::min();
+
+    XCTAssertFalse(BGM_DSPContext::FlushesDenormals());
+    XCTAssertNotEqual(Halve(kSmallestNormal), 0.0f);
+
+    {
+        BGM_DSPContext theDSPContext;
+
+        XCTAssertTrue(BGM_DSPContext::FlushesDenormals());
+        XCTAssertEqual(Halve(kSmallestNormal), 0.0f);
+    }
+
+    // The mode should be restored when the context goes out of scope.
+    XCTAssertFalse(BGM_DSPContext::FlushesDenormals());
+    XCTAssertNotEqual(Halve(kSmallestNormal), 0.0f);
+#endif
+}
+
+- (void)testNestedContextsRestoreOuterMode {
+#if defined(__x86_64__) || defined(__i386__) || defined(__arm64__) || defined(__aarch64__)
+    {
+        BGM_DSPContext theOuterContext;
+
+        {
+            BGM_DSPContext theInnerContext;
+            XCTAssertTrue(BGM_DSPContext::FlushesDenormals());
+        }
+
+        // The inner context didn't change the mode, so it shouldn't have restored it either.
+        XCTAssertTrue(BGM_DSPContext::FlushesDenormals());
+    }
+
+    XCTAssertFalse(BGM_DSPContext::FlushesDenormals());
+#endif
+}
+
+- (void)testIsSilent {
+    std::vector<Float32> theBuffer(1031, 0.0f);  // Not a multiple of the SIMD width.
+    XCTAssertTrue(BGM_DSPContext::IsSilentRT(theBuffer.data(), static_cast<UInt32>(theBuffer.size())));
+
+    theBuffer.back() = -1.0e-30f;
+    XCTAssertFalse(BGM_DSPContext::IsSilentRT(theBuffer.data(), static_cast<UInt32>(theBuffer.size())));
+}
+
+- (void)testFlushState {
+    Float32 theState[4] = { 1.0e-20f, -1.0e-16f, 0.0f, 1.0e-20f };
+    XCTAssertTrue(BGM_DSPContext::FlushStateRT(theState, 4));
+
+    for(Float32 theValue : theState)
+    {
+        XCTAssertEqual(theValue, 0.0f);
+    }
+
+    // Values that could still affect the filter's output should be left alone.
+    Float64 theDoubleState[3] = { 1.0e-200, 1.0e-6, -0.5 };
+    XCTAssertFalse(BGM_DSPContext::FlushStateRT(theDoubleState, 3));
+    XCTAssertEqual(theDoubleState[0], 0.0);
+    XCTAssertEqual(theDoubleState[1], 1.0e-6);
+    XCTAssertEqual(theDoubleState[2], -0.5);
+}
+
+@end
+
@@ -0,0 +1,119 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+
+//
+//
+//  BGM_DSPWorkerPoolTests.mm
+//  BGMDriverTests
+//
+//  Copyright © 2026 Background Music contributors
+//
+
+// Unit Include
+#include "BGM_DSPWorkerPool.h"
+
+// PublicUtility Includes
+#include "CAException.h"
+
+// STL Includes
+#include <atomic>
+
+
+static const UInt32 kJobs = 64;
+
+// Counts the times each job has run.
+static std::atomic<UInt32> sJobRuns[kJobs];
+
+static void CountJob(void* inRefCon, UInt32 inJob)
+{
+    #pragma unused (inRefCon)
+    sJobRuns[inJob].fetch_add(1, std::memory_order_relaxed);
+}
+
+@interface BGM_DSPWorkerPoolTests : XCTestCase
+
+@end
+
+@implementation BGM_DSPWorkerPoolTests
+
+- (void) setUp {
+    [super setUp];
+
+    for(std::atomic<UInt32>& theRuns : sJobRuns)
+    {
+        theRuns = 0;
+    }
+}
+
+- (void) testEveryJobRunsOncePerCycle {
+    BGM_DSPWorkerPool thePool(4, CountJob, nullptr);
+    XCTAssertEqual(thePool.GetWorkerCount(), 4u);
+
+    // Enough cycles for the queues to wrap around a few times.
+    const UInt32 theCycles = 4 * BGM_DSPWorkerPool::kMaxJobsPerCycle / kJobs + 1;
+
+    for(UInt32 theCycle = 1; theCycle <= theCycles; theCycle++)
+    {
+        for(UInt32 i = 0; i < kJobs; i++)
+        {
+            XCTAssert(thePool.SubmitRT(i));
+        }
+
+        thePool.JoinRT();
+
+        for(UInt32 i = 0; i < kJobs; i++)
+        {
+            XCTAssertEqual(sJobRuns[i].load(), theCycle);
+        }
+    }
+}
+
+- (void) testSubmitFailsWhenTheQueuesAreFull {
+    BGM_DSPWorkerPool thePool(2, CountJob, nullptr);
+
+    for(UInt32 i = 0; i < BGM_DSPWorkerPool::kMaxJobsPerCycle; i++)
+    {
+        XCTAssert(thePool.SubmitRT(i % kJobs));
+    }
+
+    XCTAssertFalse(thePool.SubmitRT(0));
+    thePool.JoinRT();
+
+    // The join frees the queues for the next cycle.
+    XCTAssert(thePool.SubmitRT(0));
+    thePool.JoinRT();
+}
+
+- (void) testInvalidWorkerCounts {
+    for(UInt32 theWorkerCount : { 0u, BGM_DSPWorkerPool::kMaxWorkers + 1 })
+    {
+        bool didThrow = false;
+
+        try
+        {
+            BGM_DSPWorkerPool thePool(theWorkerCount, CountJob, nullptr);
+        }
+        catch(const CAException&)
+        {
+            didThrow = true;
+        }
+
+        XCTAssert(didThrow);
+    }
+}
+
+@end
+
@@ -34,6 +34,7 @@
 
 // STL Includes
 #include <stdexcept>
+#include <utility>
 
 
 // Subclass BGM_Device to add some test-only functions.
@@ -133,6 +134,288 @@ TestBGM_Device::TestBGM_Device()
     }
 }
 
+- (void) testDoIOOperation_mixMinus {
+    const int kFrameSize = 512;
+
+    AudioServerPlugInClientInfo conferencingClientInfo = {
+        /* mClientID = */ 11,
+        /* mProcessID = */ 1181,
+        /* mIsNativeEndian = */ true,
+        /* mBundleID = */ CFSTR("com.bearisdriving.BGMDriver.Conferencing")
+    };
+    AudioServerPlugInClientInfo otherClientInfo = {
+        /* mClientID = */ 22,
+        /* mProcessID = */ 222,
+        /* mIsNativeEndian = */ true,
+        /* mBundleID = */ CFSTR("com.bearisdriving.BGMDriver.Other")
+    };
+
+    testDevice->AddClient(&conferencingClientInfo);
+    testDevice->AddClient(&otherClientInfo);
+
+    // Enable mix-minus for the conferencing app.
+    CFArrayRef mixMinusApps =
+            (__bridge_retained CFArrayRef)@[ @{ @kBGMMixMinusKey_ProcessID: @1181,
+                                                @kBGMMixMinusKey_Enabled: @YES } ];
+    testDevice->SetPropertyData(kObjectID_Device, 0, kBGMMixMinusAppsAddress, 0, nullptr,
+                                sizeof(CFArrayRef), &mixMinusApps);
+    CFRelease(mixMinusApps);
+
+    // Wrap around the end of the loopback buffer, as in testDoIOOperation_writeMix_readInput.
+    AudioServerPlugInIOCycleInfo cycleInfo {};
+    cycleInfo.mOutputTime.mSampleTime = kLoopbackRingBufferFrameSize - 25.0;
+
+    Float32 conferencingBuffer[kFrameSize * 2];
+    Float32 otherBuffer[kFrameSize * 2];
+    Float32 mixBuffer[kFrameSize * 2];
+
+    for(int i = 0; i < kFrameSize * 2; i++)
+    {
+        conferencingBuffer[i] = 0.25f * sinf(i * 0.01f);
+        otherBuffer[i] = 0.25f * cosf(i * 0.03f);
+    }
+
+    // Both clients send their audio. The device processes it in place, so mix the processed audio.
+    for(auto clientAndBuffer : { std::make_pair(conferencingClientInfo.mClientID, conferencingBuffer),
+                                 std::make_pair(otherClientInfo.mClientID, otherBuffer) })
+    {
+        testDevice->DoIOOperation(kObjectID_Stream_Output,
+                                  clientAndBuffer.first,
+                                  kAudioServerPlugInIOOperationProcessOutput,
+                                  kFrameSize,
+                                  cycleInfo,
+                                  clientAndBuffer.second,
+                                  nullptr);
+    }
+
+    for(int i = 0; i < kFrameSize * 2; i++)
+    {
+        mixBuffer[i] = conferencingBuffer[i] + otherBuffer[i];
+    }
+
+    testDevice->DoIOOperation(kObjectID_Stream_Output, 0, kAudioServerPlugInIOOperationWriteMix,
+                              kFrameSize, cycleInfo, mixBuffer, nullptr);
+
+    cycleInfo.mInputTime.mSampleTime = cycleInfo.mOutputTime.mSampleTime;
+
+    // The conferencing app should get the mix without its own audio.
+    Float32 outputBuffer[kFrameSize * 2];
+    testDevice->DoIOOperation(kObjectID_Stream_Input, conferencingClientInfo.mClientID,
+                              kAudioServerPlugInIOOperationReadInput, kFrameSize, cycleInfo,
+                              outputBuffer, nullptr);
+
+    for(int i = 0; i < kFrameSize * 2; i++)
+    {
+        XCTAssertEqualWithAccuracy(outputBuffer[i], otherBuffer[i], 1e-6);
+    }
+
+    // Other apps should still get the full mix.
+    testDevice->DoIOOperation(kObjectID_Stream_Input, otherClientInfo.mClientID,
+                              kAudioServerPlugInIOOperationReadInput, kFrameSize, cycleInfo,
+                              outputBuffer, nullptr);
+
+    for(int i = 0; i < kFrameSize * 2; i++)
+    {
+        XCTAssertEqual(outputBuffer[i], mixBuffer[i]);
+    }
+
+    testDevice->RemoveClient(&conferencingClientInfo);
+    testDevice->RemoveClient(&otherClientInfo);
+}
+
+- (void) testDoIOOperation_mixMinusWithSeparateInputAndOutputClients {
+    const int kFrameSize = 512;
+
+    // Like many conferencing apps, this one plays its audio through one client and reads input
+    // through another, which never sends any output.
+    AudioServerPlugInClientInfo conferencingOutputClientInfo = {
+        /* mClientID = */ 11,
+        /* mProcessID = */ 1181,
+        /* mIsNativeEndian = */ true,
+        /* mBundleID = */ CFSTR("com.bearisdriving.BGMDriver.Conferencing")
+    };
+    AudioServerPlugInClientInfo conferencingInputClientInfo = {
+        /* mClientID = */ 12,
+        /* mProcessID = */ 1181,
+        /* mIsNativeEndian = */ true,
+        /* mBundleID = */ CFSTR("com.bearisdriving.BGMDriver.Conferencing")
+    };
+    // E.g. a helper process the app plays its audio through, which has the same bundle ID.
+    AudioServerPlugInClientInfo conferencingHelperClientInfo = {
+        /* mClientID = */ 13,
+        /* mProcessID = */ 1182,
+        /* mIsNativeEndian = */ true,
+        /* mBundleID = */ CFSTR("com.bearisdriving.BGMDriver.Conferencing")
+    };
+    AudioServerPlugInClientInfo otherClientInfo = {
+        /* mClientID = */ 22,
+        /* mProcessID = */ 222,
+        /* mIsNativeEndian = */ true,
+        /* mBundleID = */ CFSTR("com.bearisdriving.BGMDriver.Other")
+    };
+
+    testDevice->AddClient(&conferencingOutputClientInfo);
+    testDevice->AddClient(&conferencingInputClientInfo);
+    testDevice->AddClient(&conferencingHelperClientInfo);
+    testDevice->AddClient(&otherClientInfo);
+
+    CFArrayRef mixMinusApps =
+            (__bridge_retained CFArrayRef)@[ @{ @kBGMMixMinusKey_BundleID: @"com.bearisdriving.BGMDriver.Conferencing",
+                                                @kBGMMixMinusKey_Enabled: @YES } ];
+    testDevice->SetPropertyData(kObjectID_Device, 0, kBGMMixMinusAppsAddress, 0, nullptr,
+                                sizeof(CFArrayRef), &mixMinusApps);
+    CFRelease(mixMinusApps);
+
+    AudioServerPlugInIOCycleInfo cycleInfo {};
+    cycleInfo.mOutputTime.mSampleTime = kLoopbackRingBufferFrameSize - 25.0;
+
+    Float32 conferencingBuffer[kFrameSize * 2];
+    Float32 helperBuffer[kFrameSize * 2];
+    Float32 otherBuffer[kFrameSize * 2];
+    Float32 mixBuffer[kFrameSize * 2];
+
+    for(int i = 0; i < kFrameSize * 2; i++)
+    {
+        conferencingBuffer[i] = 0.25f * sinf(i * 0.01f);
+        helperBuffer[i] = 0.125f * sinf(i * 0.07f);
+        otherBuffer[i] = 0.25f * cosf(i * 0.03f);
+    }
+
+    for(auto clientAndBuffer : { std::make_pair(conferencingOutputClientInfo.mClientID, conferencingBuffer),
+                                 std::make_pair(conferencingHelperClientInfo.mClientID, helperBuffer),
+                                 std::make_pair(otherClientInfo.mClientID, otherBuffer) })
+    {
+        testDevice->DoIOOperation(kObjectID_Stream_Output,
+                                  clientAndBuffer.first,
+                                  kAudioServerPlugInIOOperationProcessOutput,
+                                  kFrameSize,
+                                  cycleInfo,
+                                  clientAndBuffer.second,
+                                  nullptr);
+    }
+
+    for(int i = 0; i < kFrameSize * 2; i++)
+    {
+        mixBuffer[i] = conferencingBuffer[i] + helperBuffer[i] + otherBuffer[i];
+    }
+
+    testDevice->DoIOOperation(kObjectID_Stream_Output, 0, kAudioServerPlugInIOOperationWriteMix,
+                              kFrameSize, cycleInfo, mixBuffer, nullptr);
+
+    cycleInfo.mInputTime.mSampleTime = cycleInfo.mOutputTime.mSampleTime;
+
+    // The input client should get the mix without any of its app's audio.
+    Float32 outputBuffer[kFrameSize * 2];
+    testDevice->DoIOOperation(kObjectID_Stream_Input, conferencingInputClientInfo.mClientID,
+                              kAudioServerPlugInIOOperationReadInput, kFrameSize, cycleInfo,
+                              outputBuffer, nullptr);
+
+    for(int i = 0; i < kFrameSize * 2; i++)
+    {
+        XCTAssertEqualWithAccuracy(outputBuffer[i], otherBuffer[i], 1e-6);
+    }
+
+    testDevice->RemoveClient(&conferencingOutputClientInfo);
+    testDevice->RemoveClient(&conferencingInputClientInfo);
+    testDevice->RemoveClient(&conferencingHelperClientInfo);
+    testDevice->RemoveClient(&otherClientInfo);
+}
+
+- (void) testDoIOOperation_captureFilters {
+    const int kFrameSize = 512;
+
+    AudioServerPlugInClientInfo excludedClientInfo = {
+        /* mClientID = */ 11,
+        /* mProcessID = */ 1181,
+        /* mIsNativeEndian = */ true,
+        /* mBundleID = */ CFSTR("com.bearisdriving.BGMDriver.Excluded")
+    };
+    AudioServerPlugInClientInfo otherClientInfo = {
+        /* mClientID = */ 22,
+        /* mProcessID = */ 222,
+        /* mIsNativeEndian = */ true,
+        /* mBundleID = */ CFSTR("com.bearisdriving.BGMDriver.Other")
+    };
+    AudioServerPlugInClientInfo readerClientInfo = {
+        /* mClientID = */ 33,
+        /* mProcessID = */ 333,
+        /* mIsNativeEndian = */ true,
+        /* mBundleID = */ CFSTR("com.bearisdriving.BGMDriver.Recorder")
+    };
+
+    testDevice->AddClient(&excludedClientInfo);
+    testDevice->AddClient(&otherClientInfo);
+    testDevice->AddClient(&readerClientInfo);
+
+    // The reader should capture everything except the excluded app.
+    CFArrayRef captureFilters =
+            (__bridge_retained CFArrayRef)@[ @{ @kBGMCaptureFilterKey_ReaderBundleID: @"com.bearisdriving.BGMDriver.Recorder",
+                                                @kBGMCaptureFilterKey_Mode: @(kBGMCaptureFilterModeExclude),
+                                                @kBGMCaptureFilterKey_Apps: @[ @"com.bearisdriving.BGMDriver.Excluded" ] } ];
+    testDevice->SetPropertyData(kObjectID_Device, 0, kBGMCaptureFiltersAddress, 0, nullptr,
+                                sizeof(CFArrayRef), &captureFilters);
+    CFRelease(captureFilters);
+
+    AudioServerPlugInIOCycleInfo cycleInfo {};
+    cycleInfo.mOutputTime.mSampleTime = kLoopbackRingBufferFrameSize - 25.0;
+
+    Float32 excludedBuffer[kFrameSize * 2];
+    Float32 otherBuffer[kFrameSize * 2];
+
+    for(int i = 0; i < kFrameSize * 2; i++)
+    {
+        excludedBuffer[i] = 0.25f * sinf(i * 0.01f);
+        otherBuffer[i] = 0.25f * cosf(i * 0.03f);
+    }
+
+    for(auto clientAndBuffer : { std::make_pair(excludedClientInfo.mClientID, excludedBuffer),
+                                 std::make_pair(otherClientInfo.mClientID, otherBuffer) })
+    {
+        testDevice->DoIOOperation(kObjectID_Stream_Output,
+                                  clientAndBuffer.first,
+                                  kAudioServerPlugInIOOperationProcessOutput,
+                                  kFrameSize,
+                                  cycleInfo,
+                                  clientAndBuffer.second,
+                                  nullptr);
+    }
+
+    cycleInfo.mInputTime.mSampleTime = cycleInfo.mOutputTime.mSampleTime;
+
+    // The reader should only get the other app's (processed) audio.
+    Float32 outputBuffer[kFrameSize * 2];
+    testDevice->DoIOOperation(kObjectID_Stream_Input, readerClientInfo.mClientID,
+                              kAudioServerPlugInIOOperationReadInput, kFrameSize, cycleInfo,
+                              outputBuffer, nullptr);
+
+    for(int i = 0; i < kFrameSize * 2; i++)
+    {
+        XCTAssertEqual(outputBuffer[i], otherBuffer[i]);
+    }
+
+    // Getting the property should return the filter.
+    CFArrayRef filtersRef = nullptr;
+    UInt32 outDataSize;
+    testDevice->GetPropertyData(kObjectID_Device, 0, kBGMCaptureFiltersAddress, 0, nullptr,
+                                sizeof(CFArrayRef), outDataSize, &filtersRef);
+    NSArray* filters = (__bridge_transfer NSArray*)filtersRef;
+    XCTAssertEqual(filters.count, 1);
+    XCTAssertEqualObjects(filters[0][@kBGMCaptureFilterKey_Apps],
+                          @[ @"com.bearisdriving.BGMDriver.Excluded" ]);
+
+    // Filters without a reader should be rejected.
+    BGMShouldThrow<CAException>(self, [&](){
+        CFArrayRef invalidFilters =
+                (__bridge_retained CFArrayRef)@[ @{ @kBGMCaptureFilterKey_Mode: @(kBGMCaptureFilterModeInclude) } ];
+        testDevice->SetPropertyData(kObjectID_Device, 0, kBGMCaptureFiltersAddress, 0, nullptr,
+                                    sizeof(CFArrayRef), &invalidFilters);
+    });
+
+    testDevice->RemoveClient(&readerClientInfo);
+    testDevice->RemoveClient(&otherClientInfo);
+    testDevice->RemoveClient(&excludedClientInfo);
+}
+
 - (void) testCustomPropertyMusicPlayerBundleID {
     // Convenience wrappers
     auto getBundleID = [&](UInt32 inDataSize = sizeof(CFStringRef)){
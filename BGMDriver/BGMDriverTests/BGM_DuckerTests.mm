@@ -0,0 +1,161 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_DuckerTests.mm
+//  BGMDriverTests
+//
+//  Copyright © 2026 Background Music contributors
+//
+
+// Unit Include
+#include "BGM_Ducker.h"
+
+// Local Includes
+#include "BGM_TestUtils.h"
+
+// STL Includes
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+
+static const UInt32 kChannels = 2;
+
+@interface BGM_DuckerTests : XCTestCase
+
+@end
+
+@implementation BGM_DuckerTests
+
+- (void)testAttackHoldRelease {
+    const UInt32 kFrames = 5;
+    
+    // At 1 kHz, attack and release in 10 and 100 frames and hold for 100 frames.
+    BGM_Ducker::Settings settings;
+    settings.mDepthDB = -20.0f;
+    settings.mAttackMillis = 10.0f;
+    settings.mHoldMillis = 100.0f;
+    settings.mReleaseMillis = 100.0f;
+    
+    BGM_Ducker ducker;
+    ducker.SetSampleRate(1000.0);
+    ducker.SetSettings(settings);
+    
+    std::vector<Float32> trigger(kFrames * kChannels, 0.5f);
+    std::vector<Float32> target(kFrames * kChannels);
+    
+    auto duckOnes = [&] (Float64 sampleTime) {
+        std::fill(target.begin(), target.end(), 1.0f);
+        ducker.ApplyRT(target.data(), kFrames, sampleTime);
+        return target[0];
+    };
+    
+    // Not ducking yet, so the target's audio shouldn't change
+    XCTAssertEqual(duckOnes(0.0), 1.0f);
+    XCTAssertEqual(ducker.GetGainDBRT(), 0.0f);
+    
+    // The trigger plays for 10 cycles. It's measured before the target, so the target should be
+    // ducked in the same cycle and reach the depth after the attack time.
+    Float64 sampleTime = kFrames;
+    
+    for(int i = 0; i < 10; i++)
+    {
+        ducker.DetectRT(trigger.data(), kFrames, sampleTime);
+        duckOnes(sampleTime);
+        
+        // Every target should get the same gain in a cycle
+        std::vector<Float32> secondTarget(kFrames * kChannels, 1.0f);
+        ducker.ApplyRT(secondTarget.data(), kFrames, sampleTime);
+        XCTAssert(std::equal(target.begin(), target.end(), secondTarget.begin()));
+        
+        sampleTime += kFrames;
+    }
+    
+    XCTAssertEqual(ducker.GetGainDBRT(), -20.0f);
+    
+    // The gain should stay at the depth for the hold time and then ramp back up smoothly
+    int heldCycles = 0;
+    Float32 previousGain;
+    
+    while(true)
+    {
+        previousGain = duckOnes(sampleTime);
+        sampleTime += kFrames;
+        
+        if(ducker.GetGainDBRT() != -20.0f)
+        {
+            break;
+        }
+        
+        heldCycles++;
+    }
+    
+    // The hold time starts at the end of the trigger's last buffer, so the release starts in the
+    // cycle after the hold time has passed.
+    XCTAssertEqual(heldCycles, 100 / kFrames + 1);
+    
+    for(int i = 0; i < 30; i++)
+    {
+        Float32 gain = duckOnes(sampleTime);
+        XCTAssertGreaterThanOrEqual(gain, previousGain);
+        XCTAssertLessThan(gain - previousGain, 0.15f);
+        previousGain = gain;
+        sampleTime += kFrames;
+    }
+    
+    XCTAssertEqual(ducker.GetGainDBRT(), 0.0f);
+    XCTAssertEqual(duckOnes(sampleTime), 1.0f);
+}
+
+- (void)testQuietTriggerDoesNotDuck {
+    const UInt32 kFrames = 64;
+    
+    BGM_Ducker::Settings settings;
+    settings.mThresholdDB = -20.0f;
+    
+    BGM_Ducker ducker;
+    ducker.SetSettings(settings);
+    
+    // -26 dBFS is under the threshold
+    std::vector<Float32> trigger(kFrames * kChannels, 0.05f);
+    std::vector<Float32> target(kFrames * kChannels, 1.0f);
+    
+    ducker.DetectRT(trigger.data(), kFrames, 0.0);
+    ducker.ApplyRT(target.data(), kFrames, 0.0);
+    
+    XCTAssertEqual(ducker.GetGainDBRT(), 0.0f);
+    XCTAssertEqual(target[kFrames * kChannels - 1], 1.0f);
+}
+
+- (void)testPeakLevelMatchesReference {
+    const UInt32 kSamples = 1031;  // Not a multiple of the SIMD width.
+    
+    std::vector<Float32> buffer(kSamples);
+    for(UInt32 i = 0; i < kSamples; i++)
+    {
+        buffer[i] = std::sin(static_cast<Float32>(i) * 0.37f) * 0.5f;
+    }
+    
+    buffer[kSamples - 1] = -0.75f;
+    
+    XCTAssertEqual(BGM_Ducker::PeakLevelRT(buffer.data(), kSamples), 0.75f);
+    XCTAssertEqual(BGM_Ducker::PeakLevelReferenceRT(buffer.data(), kSamples), 0.75f);
+    XCTAssertEqual(BGM_Ducker::PeakLevelRT(buffer.data(), 0), 0.0f);
+}
+
+@end
+
@@ -0,0 +1,174 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_GainRampTests.mm
+//  BGMDriverTests
+//
+//  Copyright © 2026 Background Music contributors
+//
+
+// Unit Include
+#include "BGM_GainRamp.h"
+
+// Local Includes
+#include "BGM_TestUtils.h"
+
+// STL Includes
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+
+static const UInt32 kChannels = 2;
+
+@interface BGM_GainRampTests : XCTestCase
+
+@end
+
+@implementation BGM_GainRampTests
+
+- (void)testRampMatchesReference {
+    const UInt32 kFrames = 517;  // Not a multiple of the SIMD width.
+
+    std::vector<Float32> theInput(kFrames * kChannels);
+    for(UInt32 i = 0; i < theInput.size(); i++)
+    {
+        theInput[i] = std::sin(static_cast<Float32>(i) * 0.1f);
+    }
+
+    std::vector<Float32> theOutput = theInput;
+    std::vector<Float32> theReferenceOutput = theInput;
+
+    BGM_GainRamp::RampMultiplyRT(theOutput.data(), kFrames, kChannels, 0.25f, 0.75f);
+    BGM_GainRamp::RampMultiplyReferenceRT(theReferenceOutput.data(), kFrames, kChannels, 0.25f, 0.75f);
+
+    for(UInt32 i = 0; i < theOutput.size(); i++)
+    {
+        XCTAssertEqualWithAccuracy(theOutput[i], theReferenceOutput[i], 1.0e-5f);
+    }
+
+    // The ramp should start at the start gain and stop one step short of the end gain.
+    XCTAssertEqualWithAccuracy(theReferenceOutput[0], theInput[0] * 0.25f, 1.0e-6f);
+    Float32 theLastGain = 0.25f + 0.5f * (kFrames - 1) / kFrames;
+    XCTAssertEqualWithAccuracy(theReferenceOutput[(kFrames - 1) * kChannels],
+                               theInput[(kFrames - 1) * kChannels] * theLastGain,
+                               1.0e-5f);
+}
+
+- (void)testRampIsContinuousAndReachesTarget {
+    const UInt32 kFrames = 512;
+    const Float64 kSampleRate = 48000.0;
+
+    BGM_GainRamp theRamp(0.0f, 0.01, kSampleRate);
+    theRamp.SetTargetGain(1.0f);
+
+    std::vector<Float32> theBuffer(kFrames * kChannels);
+    Float32 thePreviousGain = 0.0f;
+
+    // Apply the ramp to a buffer of ones so the output is the gain for each sample. The gain
+    // should never jump by more than a small step.
+    for(int theCycle = 0; theCycle < 100; theCycle++)
+    {
+        std::fill(theBuffer.begin(), theBuffer.end(), 1.0f);
+        theRamp.ApplyRT(theBuffer.data(), kFrames);
+
+        for(UInt32 i = 0; i < kFrames; i++)
+        {
+            XCTAssertEqual(theBuffer[i * kChannels], theBuffer[i * kChannels + 1]);
+            XCTAssertGreaterThanOrEqual(theBuffer[i * kChannels], thePreviousGain);
+            XCTAssertLessThan(theBuffer[i * kChannels] - thePreviousGain, 0.01f);
+            thePreviousGain = theBuffer[i * kChannels];
+        }
+    }
+
+    // 100 cycles is more than 100 time constants, so the gain should have reached the target.
+    XCTAssertEqual(thePreviousGain, 1.0f);
+}
+
+- (void)testRampTimeDoesNotDependOnSampleRate {
+    const Float64 kTimeConstantSecs = 0.01;
+
+    // Ramp for one time constant at two sample rates and with different buffer sizes.
+    auto theGainAfterOneTimeConstant = [&] (Float64 inSampleRate, UInt32 inFramesPerBuffer) {
+        BGM_GainRamp theRamp(1.0f, kTimeConstantSecs, inSampleRate);
+        theRamp.SetTargetGain(0.0f);
+
+        UInt32 theFramesLeft = static_cast<UInt32>(kTimeConstantSecs * inSampleRate);
+        std::vector<Float32> theBuffer(inFramesPerBuffer * kChannels);
+
+        while(theFramesLeft > 0)
+        {
+            UInt32 theFrames = std::min(theFramesLeft, inFramesPerBuffer);
+            std::fill(theBuffer.begin(), theBuffer.end(), 1.0f);
+            theRamp.ApplyRT(theBuffer.data(), theFrames);
+            theFramesLeft -= theFrames;
+        }
+
+        // The next buffer starts at the current gain.
+        std::fill(theBuffer.begin(), theBuffer.end(), 1.0f);
+        theRamp.ApplyRT(theBuffer.data(), 1);
+        return theBuffer[0];
+    };
+
+    Float32 theExpectedGain = std::exp(-1.0f);
+
+    XCTAssertEqualWithAccuracy(theGainAfterOneTimeConstant(44100.0, 512), theExpectedGain, 1.0e-3f);
+    XCTAssertEqualWithAccuracy(theGainAfterOneTimeConstant(96000.0, 128), theExpectedGain, 1.0e-3f);
+}
+
+- (void)testUnityGainLeavesAudioUnchanged {
+    const UInt32 kFrames = 64;
+
+    BGM_GainRamp theRamp(1.0f, 0.01, 44100.0);
+
+    std::vector<Float32> theBuffer(kFrames * kChannels, 0.3f);
+    theRamp.ApplyRT(theBuffer.data(), kFrames);
+
+    for(Float32 theSample : theBuffer)
+    {
+        XCTAssertEqual(theSample, 0.3f);
+    }
+}
+
+- (void)testRampPerformance {
+    const UInt32 kFrames = 512;
+
+    std::vector<Float32> theBuffer(kFrames * kChannels, 0.5f);
+
+    [self measureBlock:^{
+        for(int i = 0; i < 10000; i++)
+        {
+            BGM_GainRamp::RampMultiplyRT(theBuffer.data(), kFrames, kChannels, 0.999f, 1.0f);
+        }
+    }];
+}
+
+- (void)testRampReferencePerformance {
+    const UInt32 kFrames = 512;
+
+    std::vector<Float32> theBuffer(kFrames * kChannels, 0.5f);
+
+    [self measureBlock:^{
+        for(int i = 0; i < 10000; i++)
+        {
+            BGM_GainRamp::RampMultiplyReferenceRT(theBuffer.data(), kFrames, kChannels, 0.999f, 1.0f);
+        }
+    }];
+}
+
+@end
+
@@ -0,0 +1,116 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+
+//
+//
+//  BGM_GlitchTelemetryTests.mm
+//  BGMDriverTests
+//
+//  Copyright © 2026 Background Music contributors
+//
+
+// Unit Include
+#include "BGM_GlitchTelemetry.h"
+
+// Local Includes
+#include "BGM_Types.h"
+
+// System Includes
+#include <mach/mach_time.h>
+
+
+@interface BGM_GlitchTelemetryTests : XCTestCase
+
+@end
+
+@implementation BGM_GlitchTelemetryTests {
+    UInt64 mHostTicksPerSecond;
+}
+
+- (void) setUp {
+    [super setUp];
+    
+    mach_timebase_info_data_t theTimebase;
+    mach_timebase_info(&theTimebase);
+    mHostTicksPerSecond = 1000000000ULL * theTimebase.denom / theTimebase.numer;
+}
+
+- (void) testWindowsOnlyCountRecentGlitches {
+    BGM_GlitchTelemetry theTelemetry;
+    const UInt64 theStart = (mach_absolute_time() / mHostTicksPerSecond) * mHostTicksPerSecond;
+    theTelemetry.Reset(theStart);
+    
+    theTelemetry.CountRT(kBGMGlitchUnderrun, theStart);
+    theTelemetry.CountRT(kBGMGlitchUnderrun, theStart + 20 * mHostTicksPerSecond);
+    theTelemetry.CountRT(kBGMGlitchUnderrun, theStart + 55 * mHostTicksPerSecond);
+    
+    BGM_GlitchTelemetrySnapshot theSnapshot = theTelemetry.GetSnapshot(theStart + 62 * mHostTicksPerSecond);
+    XCTAssertEqual(theSnapshot.mTotal[kBGMGlitchUnderrun], 3);
+    XCTAssertEqual(theSnapshot.mLast10Seconds[kBGMGlitchUnderrun], 1);
+    XCTAssertEqual(theSnapshot.mLast60Seconds[kBGMGlitchUnderrun], 2);
+    XCTAssertEqual(theSnapshot.mTotal[kBGMGlitchOverrun], 0);
+    XCTAssertEqualWithAccuracy(theSnapshot.mSeconds, 62.0, 1.0e-6);
+}
+
+- (void) testResetZeroesTheCounts {
+    BGM_GlitchTelemetry theTelemetry;
+    
+    theTelemetry.CountCycleRT();
+    theTelemetry.CountRT(kBGMGlitchLateCycle);
+    theTelemetry.RecordOffsetRT(512.0);
+    theTelemetry.Reset();
+    
+    BGM_GlitchTelemetrySnapshot theSnapshot = theTelemetry.GetSnapshot();
+    XCTAssertEqual(theSnapshot.mCycles, 0);
+    XCTAssertEqual(theSnapshot.mTotal[kBGMGlitchLateCycle], 0);
+    XCTAssertEqual(theSnapshot.mLast10Seconds[kBGMGlitchLateCycle], 0);
+    XCTAssertEqual(theSnapshot.mOffsetHistogram[10], 0);
+}
+
+- (void) testOffsetHistogramBuckets {
+    XCTAssertEqual(BGM_GlitchTelemetry::GetOffsetHistogramBucket(-1.0), 0);
+    XCTAssertEqual(BGM_GlitchTelemetry::GetOffsetHistogramBucket(1.0), 1);
+    XCTAssertEqual(BGM_GlitchTelemetry::GetOffsetHistogramBucket(3.0), 2);
+    XCTAssertEqual(BGM_GlitchTelemetry::GetOffsetHistogramBucket(512.0), 10);
+    XCTAssertEqual(BGM_GlitchTelemetry::GetOffsetHistogramBucket(1.0e9), kBGMGlitchOffsetHistogramBuckets - 1);
+    XCTAssertEqual(BGM_GlitchTelemetry::GetOffsetHistogramBucketStart(10), 512);
+}
+
+- (void) testDictionaryRoundTrips {
+    BGM_GlitchTelemetry theTelemetry;
+    
+    theTelemetry.CountCycleRT();
+    theTelemetry.CountRT(kBGMGlitchResync);
+    theTelemetry.RecordOffsetRT(300.0);
+    
+    BGM_GlitchTelemetrySnapshot theSnapshot = theTelemetry.GetSnapshot();
+    CACFDictionary theDictionary = BGM_GlitchTelemetry::CopyAsDictionary(theSnapshot);
+    
+    UInt64 theResyncs = 0;
+    CFDictionaryRef theTotal = nullptr;
+    XCTAssert(theDictionary.GetDictionary(CFSTR(kBGMGlitchTelemetryKey_Total), theTotal));
+    XCTAssert(CACFDictionary(theTotal, false).GetUInt64(CFSTR("resyncs"), theResyncs));
+    XCTAssertEqual(theResyncs, 1);
+    
+    BGM_GlitchTelemetrySnapshot theReadSnapshot;
+    XCTAssert(BGM_GlitchTelemetry::ReadDictionary(theDictionary, theReadSnapshot));
+    XCTAssertEqual(memcmp(&theSnapshot, &theReadSnapshot, sizeof(theSnapshot)), 0);
+    
+    CFRelease(theDictionary.GetDict());
+}
+
+@end
+
@@ -0,0 +1,163 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_IOTraceTests.mm
+//  BGMDriverTests
+//
+//  Copyright © 2026 Background Music contributors
+//
+
+// Unit Include
+#include "BGM_IOTrace.h"
+
+// Local Includes
+#include "BGM_TestUtils.h"
+
+// PublicUtility Includes
+#include "CAException.h"
+
+// System Includes
+#include <unistd.h>
+
+// STL Includes
+#include <string>
+#include <vector>
+
+
+static const UInt32 kFrames = 64;
+
+static std::string TemporaryTracePath()
+{
+    std::string thePath = std::string(NSTemporaryDirectory().UTF8String) + "BGM_IOTraceTests.bgmtrace";
+    unlink(thePath.c_str());
+    return thePath;
+}
+
+static AudioServerPlugInIOCycleInfo CycleInfo(UInt64 inCycle)
+{
+    AudioServerPlugInIOCycleInfo theCycleInfo = {};
+    theCycleInfo.mIOCycleCounter = inCycle;
+    theCycleInfo.mInputTime.mSampleTime = (inCycle - 1) * kFrames;
+    theCycleInfo.mOutputTime.mSampleTime = inCycle * kFrames;
+    theCycleInfo.mOutputTime.mFlags = kAudioTimeStampSampleTimeValid;
+    return theCycleInfo;
+}
+
+@interface BGM_IOTraceTests : XCTestCase
+
+@end
+
+@implementation BGM_IOTraceTests
+
+- (void)testRecordsAreReadBackInOrder {
+    std::string thePath = TemporaryTracePath();
+    std::vector<Float32> theAudio(kFrames * 2);
+
+    for(UInt32 i = 0; i < theAudio.size(); i++)
+    {
+        theAudio[i] = i / 128.0f;
+    }
+
+    {
+        BGM_IOTraceRecorder theRecorder;
+
+        // Not recording yet, so these should be ignored.
+        theRecorder.RecordClientAdded(1, 100, nullptr);
+        theRecorder.RecordOperationRT(kBGMIOTraceRecordDoOperation,
+                                      1,
+                                      kAudioServerPlugInIOOperationWriteMix,
+                                      kFrames,
+                                      CycleInfo(0),
+                                      theAudio.data());
+
+        theRecorder.Start(thePath.c_str(), true, 48000.0);
+        XCTAssert(theRecorder.IsRecording());
+
+        theRecorder.RecordClientAdded(2, 200, CFSTR("com.example.app"));
+        theRecorder.RecordOperationRT(kBGMIOTraceRecordBeginOperation,
+                                      2,
+                                      kAudioServerPlugInIOOperationThread,
+                                      kFrames,
+                                      CycleInfo(1),
+                                      nullptr);
+        theRecorder.RecordOperationRT(kBGMIOTraceRecordDoOperation,
+                                      2,
+                                      kAudioServerPlugInIOOperationProcessOutput,
+                                      kFrames,
+                                      CycleInfo(1),
+                                      theAudio.data());
+        theRecorder.RecordClientRemoved(2);
+
+        theRecorder.Stop();
+        XCTAssertFalse(theRecorder.IsRecording());
+        XCTAssertEqual(theRecorder.GetDroppedRecordCount(), 0);
+    }
+
+    BGM_IOTraceReader theReader(thePath.c_str());
+    XCTAssertEqual(theReader.GetFileHeader().mSampleRate, 48000.0);
+    XCTAssertEqual(theReader.GetFileHeader().mFlags, kBGMIOTraceFileFlagHasAudio);
+
+    BGM_IOTraceRecord theRecord;
+    std::vector<UInt8> thePayload;
+
+    // The client's record should come before its IO operations, even though it's written to the
+    // file by a different path.
+    XCTAssert(theReader.ReadRecord(theRecord, thePayload));
+    XCTAssertEqual(theRecord.mType, kBGMIOTraceRecordClientAdded);
+    XCTAssertEqual(theRecord.mClientID, 2);
+    XCTAssertEqual(std::string(thePayload.begin() + sizeof(SInt32), thePayload.end()), "com.example.app");
+
+    XCTAssert(theReader.ReadRecord(theRecord, thePayload));
+    XCTAssertEqual(theRecord.mType, kBGMIOTraceRecordBeginOperation);
+    XCTAssertEqual(theRecord.mOperationID, kAudioServerPlugInIOOperationThread);
+    XCTAssertEqual(thePayload.size(), 0);
+
+    XCTAssert(theReader.ReadRecord(theRecord, thePayload));
+    XCTAssertEqual(theRecord.mType, kBGMIOTraceRecordDoOperation);
+    XCTAssertEqual(theRecord.mOutputSampleTime, kFrames);
+    XCTAssertEqual(thePayload.size(), theAudio.size() * sizeof(Float32));
+    XCTAssertEqual(memcmp(thePayload.data(), theAudio.data(), thePayload.size()), 0);
+
+    XCTAssert(theReader.ReadRecord(theRecord, thePayload));
+    XCTAssertEqual(theRecord.mType, kBGMIOTraceRecordClientRemoved);
+
+    XCTAssertFalse(theReader.ReadRecord(theRecord, thePayload));
+
+    unlink(thePath.c_str());
+}
+
+- (void)testDoesntOverwriteFiles {
+    std::string thePath = TemporaryTracePath();
+    FILE* theFile = fopen(thePath.c_str(), "w");
+    fclose(theFile);
+
+    BGM_IOTraceRecorder theRecorder;
+    BGMShouldThrow<CAException>(self, [&](){
+        theRecorder.Start(thePath.c_str(), false, 44100.0);
+    });
+    XCTAssertFalse(theRecorder.IsRecording());
+
+    // The existing file isn't a trace.
+    BGMShouldThrow<CAException>(self, [&](){
+        BGM_IOTraceReader theReader(thePath.c_str());
+    });
+
+    unlink(thePath.c_str());
+}
+
+@end
+
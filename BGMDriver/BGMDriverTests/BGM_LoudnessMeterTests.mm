@@ -0,0 +1,175 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_LoudnessMeterTests.mm
+//  BGMDriverTests
+//
+//  Copyright © 2026 Background Music contributors
+//
+
+// Unit Include
+#include "BGM_LoudnessMeter.h"
+
+// Local Includes
+#include "BGM_TestUtils.h"
+
+// STL Includes
+#include <cmath>
+#include <vector>
+
+
+static const Float64 kSampleRate = 44100.0;
+static const UInt32 kFrames = 512;
+static const UInt32 kChannels = 2;
+
+// Feed the meter inSecs of a 1 kHz sine at inLevelDBFS in both channels. Returns the gain it
+// applied to the last frame, in dB.
+static Float32 PlaySine(BGM_LoudnessMeter& meter, Float64 inLevelDBFS, Float64 inSecs)
+{
+    static UInt64 sFrame = 0;
+    
+    const Float64 amplitude = (inLevelDBFS > -200.0) ? std::pow(10.0, inLevelDBFS / 20.0) : 0.0;
+    std::vector<Float32> buffer(kFrames * kChannels);
+    Float32 lastSample = 0.0f;
+    
+    for(UInt32 frame = 0; frame < inSecs * kSampleRate; frame += kFrames)
+    {
+        for(UInt32 i = 0; i < kFrames; i++)
+        {
+            buffer[i * kChannels] = buffer[i * kChannels + 1] =
+                    static_cast<Float32>(amplitude * std::sin(2.0 * M_PI * 1000.0 * sFrame++ / kSampleRate));
+        }
+        
+        lastSample = buffer[(kFrames - 1) * kChannels];
+        meter.ProcessRT(buffer.data(), kFrames);
+    }
+    
+    return (lastSample != 0.0f) ? 20.0f * std::log10(buffer[(kFrames - 1) * kChannels] / lastSample) : 0.0f;
+}
+
+@interface BGM_LoudnessMeterTests : XCTestCase
+
+@end
+
+@implementation BGM_LoudnessMeterTests
+
+- (void)testKWeightingCoefficients {
+    // The 48 kHz coefficients given in ITU-R BS.1770
+    const BGM_LoudnessMeter::Coefficients expectedHighShelf = {
+        1.53512485958697, -2.69169618940638, 1.19839281085285, -1.69065929318241, 0.73248077421585
+    };
+    const BGM_LoudnessMeter::Coefficients expectedHighPass = {
+        1.0, -2.0, 1.0, -1.99004745483398, 0.99007225036621
+    };
+    
+    BGM_LoudnessMeter::Coefficients highShelf;
+    BGM_LoudnessMeter::Coefficients highPass;
+    BGM_LoudnessMeter::CalculateKWeighting(48000.0, highShelf, highPass);
+    
+    for(int i = 0; i < 5; i++)
+    {
+        XCTAssertEqualWithAccuracy(highShelf[i], expectedHighShelf[i], 1.0e-8);
+        XCTAssertEqualWithAccuracy(highPass[i], expectedHighPass[i], 1.0e-8);
+    }
+}
+
+- (void)testSineLoudness {
+    BGM_LoudnessMeter meter(kSampleRate);
+    
+    // Nothing to measure yet
+    XCTAssertEqual(meter.GetMomentaryLUFS(), kBGMLoudnessMinLUFS);
+    XCTAssertEqual(meter.GetIntegratedLUFS(), kBGMLoudnessMinLUFS);
+    
+    // A 1 kHz sine at -23 dBFS in both channels is -23 LUFS (EBU Tech 3341, test 1)
+    PlaySine(meter, -23.0, 5.0);
+    
+    XCTAssertEqualWithAccuracy(meter.GetMomentaryLUFS(), -23.0f, 0.1f);
+    XCTAssertEqualWithAccuracy(meter.GetShortTermLUFS(), -23.0f, 0.1f);
+    XCTAssertEqualWithAccuracy(meter.GetIntegratedLUFS(), -23.0f, 0.1f);
+    
+    // Normalization is off, so the meter shouldn't change the audio
+    XCTAssertEqual(meter.GetGainDB(), 0.0f);
+}
+
+- (void)testGating {
+    BGM_LoudnessMeter meter(kSampleRate);
+    
+    // EBU Tech 3341, test 4. The quiet parts are under the absolute or relative gates, so they
+    // shouldn't affect the integrated loudness.
+    PlaySine(meter, -72.0, 10.0);
+    PlaySine(meter, -36.0, 10.0);
+    PlaySine(meter, -23.0, 60.0);
+    PlaySine(meter, -36.0, 10.0);
+    PlaySine(meter, -72.0, 10.0);
+    
+    XCTAssertEqualWithAccuracy(meter.GetIntegratedLUFS(), -23.0f, 0.1f);
+    XCTAssertLessThan(meter.GetShortTermLUFS(), -60.0f);
+}
+
+- (void)testNormalization {
+    BGM_LoudnessMeter meter(kSampleRate);
+    
+    BGM_LoudnessMeter::Normalization normalization;
+    normalization.mEnabled = true;
+    normalization.mTargetLUFS = -23.0f;
+    normalization.mMaxSlewDBPerSec = 2.0f;
+    normalization.mMaxGainDB = 6.0f;
+    meter.SetNormalization(normalization);
+    
+    // The app is 10 LU too quiet. The gain should rise at the maximum slew rate once the meter has a
+    // 400 ms block to measure.
+    PlaySine(meter, -33.0, 1.0);
+    XCTAssertGreaterThan(meter.GetGainDB(), 1.0f);
+    XCTAssertLessThanOrEqual(meter.GetGainDB(), 2.0f + 0.1f);
+    
+    // And stop at the largest gain
+    Float32 appliedGainDB = PlaySine(meter, -33.0, 4.0);
+    XCTAssertEqual(meter.GetGainDB(), 6.0f);
+    XCTAssertEqualWithAccuracy(appliedGainDB, 6.0f, 0.01f);
+    
+    // The meter measures the audio before the gain is applied
+    XCTAssertEqualWithAccuracy(meter.GetShortTermLUFS(), -33.0f, 0.1f);
+    
+    // The gain should be held while the app is silent
+    PlaySine(meter, -300.0, 5.0);
+    XCTAssertEqual(meter.GetGainDB(), 6.0f);
+    
+    // A loud app should be turned down
+    PlaySine(meter, -20.0, 8.0);
+    XCTAssertEqualWithAccuracy(meter.GetGainDB(), -3.0f, 0.1f);
+    
+    // And the gain should slew back to unity when normalization is turned off
+    normalization.mEnabled = false;
+    meter.SetNormalization(normalization);
+    PlaySine(meter, -20.0, 1.0);
+    XCTAssertEqualWithAccuracy(meter.GetGainDB(), -1.0f, 0.1f);
+    PlaySine(meter, -20.0, 1.0);
+    XCTAssertEqual(meter.GetGainDB(), 0.0f);
+}
+
+- (void)testPerformance {
+    BGM_LoudnessMeter meter(kSampleRate);
+    BGM_LoudnessMeter* meterPtr = &meter;
+    
+    // Ten seconds of IO cycles
+    [self measureBlock:^{
+        PlaySine(*meterPtr, -23.0, 10.0);
+    }];
+}
+
+@end
+
@@ -0,0 +1,158 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_ParameterAutomationTests.mm
+//  BGMDriverTests
+//
+//  Copyright © 2026 Background Music contributors
+//
+
+// Unit Include
+#include "BGM_ParameterAutomation.h"
+
+// Local Includes
+#include "BGM_TestUtils.h"
+
+// STL Includes
+#include <cmath>
+#include <vector>
+
+
+static const UInt32 kChannels = 2;
+
+// The clock the events are scheduled in, e.g. host time, starts at this time at sample time 0 and
+// advances this much per frame.
+static const Float64 kTimeOffset = 5.0;
+static const Float64 kTimeUnitsPerFrame = 10.0;
+
+static Float64 TimeOfFrame(SInt64 inSampleTime)
+{
+    return inSampleTime * kTimeUnitsPerFrame + kTimeOffset;
+}
+
+// Event has default member initializers, so it isn't an aggregate in C++11.
+static BGM_ParameterAutomation::Event MakeEvent(Float64 inTime, Float32 inValue, UInt32 inRampFrames)
+{
+    BGM_ParameterAutomation::Event theEvent;
+    theEvent.mTime = inTime;
+    theEvent.mValue = inValue;
+    theEvent.mRampFrames = inRampFrames;
+    return theEvent;
+}
+
+// Simulate the IO cycles from sample time 0 to inTotalFrames, with inBufferFrames frames per cycle,
+// applying inAutomation's gain to a signal of ones. Returns the gain applied to each frame. Fails
+// the test if the channels get different gains.
+static std::vector<Float32> RunIOCycles(XCTestCase* self,
+                                        BGM_ParameterAutomation& inAutomation,
+                                        UInt32 inBufferFrames,
+                                        UInt32 inTotalFrames)
+{
+    std::vector<Float32> theGains;
+    
+    for(UInt32 theSampleTime = 0; theSampleTime < inTotalFrames; theSampleTime += inBufferFrames)
+    {
+        std::vector<Float32> theBuffer(inBufferFrames * kChannels, 1.0f);
+        
+        inAutomation.ApplyGainRT(theBuffer.data(),
+                                 inBufferFrames,
+                                 theSampleTime,
+                                 TimeOfFrame(theSampleTime),
+                                 kTimeUnitsPerFrame);
+        
+        for(UInt32 i = 0; i < inBufferFrames; i++)
+        {
+            XCTAssertEqual(theBuffer[i * kChannels], theBuffer[i * kChannels + 1]);
+            theGains.push_back(theBuffer[i * kChannels]);
+        }
+    }
+    
+    return theGains;
+}
+
+@interface BGM_ParameterAutomationTests : XCTestCase
+
+@end
+
+@implementation BGM_ParameterAutomationTests
+
+- (void)testEventsStartOnTheirFramesForAnyBufferSize {
+    for(UInt32 theBufferFrames : { 1u, 7u, 64u, 512u, 1000u, 1001u })
+    {
+        BGM_ParameterAutomation theAutomation(1.0f);
+        
+        // Step to 0.5 at frame 1000, ramp to 0 over 100 frames from frame 2000 and interrupt that
+        // ramp at frame 2050 to ramp back up to 1 over 10 frames.
+        XCTAssert(theAutomation.ScheduleEvent(MakeEvent(TimeOfFrame(1000), 0.5f, 0)));
+        XCTAssert(theAutomation.ScheduleEvent(MakeEvent(TimeOfFrame(2000), 0.0f, 100)));
+        XCTAssert(theAutomation.ScheduleEvent(MakeEvent(TimeOfFrame(2050), 1.0f, 10)));
+        
+        std::vector<Float32> theGains = RunIOCycles(self, theAutomation, theBufferFrames, 3000);
+        
+        // The step
+        XCTAssertEqual(theGains[999], 1.0f);
+        XCTAssertEqual(theGains[1000], 0.5f);
+        XCTAssertEqual(theGains[1999], 0.5f);
+        
+        // The first ramp starts moving on its event's frame and would reach 0 on frame 2099
+        XCTAssertEqualWithAccuracy(theGains[2000], 0.495f, 1e-6);
+        XCTAssertEqualWithAccuracy(theGains[2049], 0.25f, 1e-5);
+        
+        // The second ramp starts from where the first had got to and reaches 1 on its last frame
+        Float32 theInterruptedGain = 0.245f;
+        XCTAssertEqualWithAccuracy(theGains[2050],
+                                   theInterruptedGain + (1.0f - theInterruptedGain) / 10.0f,
+                                   1e-5);
+        XCTAssertLessThan(theGains[2058], 1.0f);
+        XCTAssertEqual(theGains[2059], 1.0f);
+        XCTAssertEqual(theGains[2999], 1.0f);
+    }
+}
+
+- (void)testLateEventsContinueFromWhereTheyWouldHaveBeen {
+    BGM_ParameterAutomation theAutomation(1.0f);
+    
+    // Schedule a ramp that should have started 50 frames before the first IO cycle.
+    XCTAssert(theAutomation.ScheduleEvent(MakeEvent(TimeOfFrame(-50), 0.0f, 100)));
+    
+    std::vector<Float32> theGains = RunIOCycles(self, theAutomation, 64, 128);
+    
+    XCTAssertEqualWithAccuracy(theGains[0], 1.0f - 51.0f / 100.0f, 1e-6);
+    XCTAssertEqual(theGains[49], 0.0f);
+    XCTAssertEqual(theGains[127], 0.0f);
+}
+
+- (void)testQueueCapacity {
+    BGM_ParameterAutomation theAutomation(1.0f);
+    
+    for(UInt32 i = 0; i < BGM_ParameterAutomation::kMaxPendingEvents; i++)
+    {
+        XCTAssert(theAutomation.ScheduleEvent(MakeEvent(TimeOfFrame(i), 0.5f, 0)));
+    }
+    
+    XCTAssertEqual(theAutomation.GetPendingEventCount(), BGM_ParameterAutomation::kMaxPendingEvents);
+    XCTAssertFalse(theAutomation.ScheduleEvent(MakeEvent(TimeOfFrame(1000), 0.5f, 0)));
+    
+    // Running the IO cycles past the events' times should make room for more.
+    RunIOCycles(self, theAutomation, 512, 512);
+    
+    XCTAssertEqual(theAutomation.GetPendingEventCount(), 0);
+    XCTAssert(theAutomation.ScheduleEvent(MakeEvent(TimeOfFrame(1000), 0.5f, 0)));
+}
+
+@end
+
@@ -0,0 +1,120 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+
+//
+//
+//  BGM_RTEventLogTests.mm
+//  BGMDriverTests
+//
+//  Copyright © 2026 Background Music contributors
+//
+
+// Unit Include
+#include "BGM_RTEventLog.h"
+
+// STL Includes
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+static const BGM_RTEventType kTestEventTypes[] = {
+    {
+        "Test event",
+        kBGMRTEventSeverityWarning,
+        "caller",
+        { "count", "time", "status", nullptr },
+        { kBGMRTEventArgInteger, kBGMRTEventArgFloat, kBGMRTEventArgOSStatus, kBGMRTEventArgUnused }
+    }
+};
+
+@interface BGM_RTEventLogTests : XCTestCase
+
+@end
+
+@implementation BGM_RTEventLogTests {
+    std::mutex mMessagesMutex;
+    std::vector<std::string> mMessages;
+}
+
+- (BGM_RTEventLog*) newLogWithEventsPerChannel:(UInt32)inEventsPerChannel {
+    return new BGM_RTEventLog(kTestEventTypes,
+                              1,
+                              1,
+                              inEventsPerChannel,
+                              [self] (BGMRTEventSeverity inSeverity, const char* inMessage) {
+                                  std::lock_guard<std::mutex> theLock(mMessagesMutex);
+                                  mMessages.push_back(inMessage);
+                              });
+}
+
+- (void) testLoggedEventIsPrinted {
+    BGM_RTEventLog* theLog = [self newLogWithEventsPerChannel:16];
+
+    theLog->LogDetailRT(0, 0, "DoIOOperation", 3, 1.5, 'nope');
+    XCTAssert(theLog->WaitUntilDrained(5000));
+    delete theLog;
+
+    XCTAssertEqual(mMessages.size(), 1);
+    XCTAssertEqual(mMessages[0],
+                   "Test event caller=DoIOOperation count=3 time=1.500000 status=1852797029 (nope)");
+}
+
+- (void) testInvalidChannelsAndTypesAreIgnored {
+    BGM_RTEventLog* theLog = [self newLogWithEventsPerChannel:16];
+
+    theLog->LogRT(1, 0);
+    theLog->LogRT(0, 1);
+    XCTAssertEqual(theLog->GetPendingEventCount(), 0);
+    delete theLog;
+
+    XCTAssertEqual(mMessages.size(), 0);
+}
+
+- (void) testFullChannelDropsAndCountsEvents {
+    BGM_RTEventLog* theLog = [self newLogWithEventsPerChannel:4];
+
+    // The logging thread has to be woken before it can drain the channel, so most of these should
+    // be dropped.
+    for(int i = 0; i < 1000; i++)
+    {
+        theLog->LogRT(0, 0, i);
+    }
+
+    XCTAssertGreaterThan(theLog->GetDroppedEventCount(), 0);
+    XCTAssertLessThanOrEqual(theLog->GetPendingEventCount(), 4);
+    XCTAssert(theLog->WaitUntilDrained(5000));
+    delete theLog;
+}
+
+- (void) testMessagesAreRateLimited {
+    BGM_RTEventLog* theLog = [self newLogWithEventsPerChannel:1024];
+
+    for(int i = 0; i < 100; i++)
+    {
+        theLog->LogRT(0, 0, i);
+    }
+
+    XCTAssert(theLog->WaitUntilDrained(5000));
+    // Deleting the log reports the suppressed messages.
+    delete theLog;
+
+    XCTAssertEqual(mMessages.size(), BGM_RTEventLog::kMaxMessagesPerSecond + 1);
+    XCTAssertEqual(mMessages.back(), "BGM_RTEventLog: Suppressed 80 \"Test event\" messages");
+}
+
+@end
+
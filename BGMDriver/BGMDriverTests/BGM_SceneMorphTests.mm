@@ -0,0 +1,112 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_SceneMorphTests.mm
+//  BGMDriverTests
+//
+//  Copyright © 2026 Background Music contributors
+//
+
+// Unit Include
+#include "BGM_SceneMorph.h"
+
+// Local Includes
+#include "BGM_TestUtils.h"
+
+
+@interface BGM_SceneMorphTests : XCTestCase
+
+@end
+
+@implementation BGM_SceneMorphTests
+
+- (void)testMorphIsLinearAcrossBuffers {
+    BGM_SceneMorph::Parameters from;
+    from.mRawVolume = 0.0f;
+    from.mPanPosition = -100.0f;
+    
+    BGM_SceneMorph::Parameters to;
+    to.mRawVolume = 100.0f;
+    to.mPanPosition = 100.0f;
+    to.mEQGains[1] = 6.0f;
+    
+    BGM_SceneMorph morph(from, to, 1000, 48000.0);
+    XCTAssert(morph.MorphsEQ());
+    XCTAssertFalse(morph.IsFinished());
+    
+    BGM_SceneMorph::Parameters start;
+    BGM_SceneMorph::Parameters end;
+    
+    // Each buffer should start where the last one ended
+    XCTAssert(morph.AdvanceRT(250, start, end));
+    XCTAssertEqual(start.mRawVolume, 0.0f);
+    XCTAssertEqual(end.mRawVolume, 25.0f);
+    XCTAssertEqual(end.mPanPosition, -50.0f);
+    XCTAssertEqual(end.mEQGains[1], 1.5f);
+    
+    XCTAssert(morph.AdvanceRT(250, start, end));
+    XCTAssertEqual(start.mRawVolume, 25.0f);
+    XCTAssertEqual(end.mRawVolume, 50.0f);
+    
+    // Other threads should see the values at the end of the last buffer
+    XCTAssertEqual(morph.GetCurrentParameters().mRawVolume, 50.0f);
+    XCTAssertEqual(morph.GetCurrentParameters().mPanPosition, 0.0f);
+}
+
+- (void)testMorphFinishesOnTarget {
+    BGM_SceneMorph::Parameters from;
+    BGM_SceneMorph::Parameters to;
+    to.mRawVolume = 10.0f;
+    
+    BGM_SceneMorph morph(from, to, 300, 44100.0);
+    XCTAssertFalse(morph.MorphsEQ());
+    
+    BGM_SceneMorph::Parameters start;
+    BGM_SceneMorph::Parameters end;
+    
+    XCTAssert(morph.AdvanceRT(256, start, end));
+    XCTAssertFalse(morph.IsFinished());
+    
+    // The morph ends part way through this buffer, so the end of the buffer should be the target
+    XCTAssert(morph.AdvanceRT(256, start, end));
+    XCTAssertEqual(end.mRawVolume, 10.0f);
+    XCTAssert(morph.IsFinished());
+    
+    // After that, the client's own settings should be used
+    XCTAssertFalse(morph.AdvanceRT(256, start, end));
+    XCTAssertEqual(morph.GetCurrentParameters().mRawVolume, 10.0f);
+}
+
+- (void)testZeroLengthMorph {
+    BGM_SceneMorph::Parameters from;
+    BGM_SceneMorph::Parameters to;
+    to.mPanPosition = 100.0f;
+    
+    // Morphs are at least one frame long
+    BGM_SceneMorph morph(from, to, 0, 44100.0);
+    
+    BGM_SceneMorph::Parameters start;
+    BGM_SceneMorph::Parameters end;
+    
+    XCTAssert(morph.AdvanceRT(512, start, end));
+    XCTAssertEqual(start.mPanPosition, 0.0f);
+    XCTAssertEqual(end.mPanPosition, 100.0f);
+    XCTAssert(morph.IsFinished());
+}
+
+@end
+
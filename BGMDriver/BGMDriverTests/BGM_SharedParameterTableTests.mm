@@ -0,0 +1,312 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_SharedParameterTableTests.mm
+//  BGMDriverTests
+//
+//  Copyright © 2026 Background Music contributors
+//
+
+// Unit Include
+#include "BGM_SharedParameterTable.h"
+
+// Local Includes
+#include "BGM_Clients.h"
+#include "BGM_Types.h"
+
+// PublicUtility Includes
+#include "CACFArray.h"
+#include "CACFDictionary.h"
+#include "CACFNumber.h"
+
+// System Includes
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// STL Includes
+#include <cmath>
+#include <string>
+
+
+// The number of updates each benchmark sends. Roughly a minute of 1 kHz control data for each of 20
+// apps.
+static const UInt32 kBenchmarkUpdates = 20 * 60 * 1000;
+
+@interface BGM_SharedParameterTableTests : XCTestCase
+
+@end
+
+@implementation BGM_SharedParameterTableTests {
+    std::string tableName;
+}
+
+- (void)setUp {
+    [super setUp];
+    
+    // Use a name no other test (or the installed driver) uses
+    tableName = "/BGMTest." + std::to_string(getpid());
+}
+
+- (void)tearDown {
+    shm_unlink(tableName.c_str());
+    
+    [super tearDown];
+}
+
+- (void)testPrivateTable {
+    BGM_SharedParameterTable table(nullptr);
+    
+    XCTAssertFalse(table.IsShared());
+    XCTAssertEqual(table.GetTable()->mMagic, kBGMParameterTableMagic);
+    XCTAssertEqual(table.GetTable()->mSlotCount, kBGMParameterTableSlotCount);
+}
+
+- (void)testDriverSeesAppsTable {
+    BGM_SharedParameterTable driverTable(tableName.c_str());
+    
+    // BGMApp hasn't created the table yet
+    XCTAssertFalse(driverTable.IsShared());
+    
+    // Create the table the way BGMApp does
+    BGMParameterTable* appTable = BGMParameterTableCreate(tableName.c_str());
+    
+    if(!appTable)
+    {
+        // E.g. if the tests are sandboxed.
+        NSLog(@"Skipping testDriverSeesAppsTable: Couldn't create the shared memory object");
+        return;
+    }
+    
+    // Only other users should be locked out
+    struct stat fileInfo;
+    int file = shm_open(tableName.c_str(), O_RDONLY, 0);
+    XCTAssert(file >= 0);
+    XCTAssertEqual(fstat(file, &fileInfo), 0);
+    XCTAssertEqual(fileInfo.st_uid, geteuid());
+    XCTAssertEqual(fileInfo.st_mode & (S_IWGRP | S_IWOTH), 0);
+    close(file);
+    
+    // The driver should only map the table if the user it expects BGMApp to run as owns it
+    XCTAssert(BGMParameterTableOpenReadOnly(tableName.c_str(), geteuid() + 1) == nullptr);
+    
+    BGM_ParameterSlotCache cache;
+    Float32 value;
+    XCTAssertFalse(driverTable.GetValueRT(1234, cache, kBGMParameterRelativeVolume, value));
+    
+    XCTAssert(BGMParameterTableSetValue(appTable, 1234, kBGMParameterRelativeVolume, 75.5f));
+    
+    driverTable.OpenSharedIfNeeded();
+    
+    if(!driverTable.IsShared())
+    {
+        // The tests aren't running as the console user.
+        NSLog(@"Skipping testDriverSeesAppsTable: The driver didn't map the table");
+        BGMParameterTableClose(appTable);
+        return;
+    }
+    
+    XCTAssert(driverTable.GetValueRT(1234, cache, kBGMParameterRelativeVolume, value));
+    XCTAssertEqual(value, 75.5f);
+    
+    // Only the parameter that was set should be found
+    XCTAssertFalse(driverTable.GetValueRT(1234, cache, kBGMParameterPanPosition, value));
+    
+    // Clearing a value should unset it until the app sets it again, without writing to the table
+    driverTable.ClearValue(1234, kBGMParameterRelativeVolume);
+    XCTAssertFalse(driverTable.GetValueRT(1234, cache, kBGMParameterRelativeVolume, value));
+    XCTAssertEqual(appTable->mSlots[1234 % kBGMParameterTableSlotCount].mValues[kBGMParameterRelativeVolume], 75.5f);
+    
+    XCTAssert(BGMParameterTableSetValue(appTable, 1234, kBGMParameterRelativeVolume, 70.0f));
+    XCTAssert(driverTable.GetValueRT(1234, cache, kBGMParameterRelativeVolume, value));
+    XCTAssertEqual(value, 70.0f);
+    
+    // Clearing all of the app's values, e.g. because it's exited
+    XCTAssert(BGMParameterTableSetValue(appTable, 1234, kBGMParameterPanPosition, 10.0f));
+    driverTable.ClearValues(1234);
+    XCTAssertFalse(driverTable.GetValueRT(1234, cache, kBGMParameterRelativeVolume, value));
+    XCTAssertFalse(driverTable.GetValueRT(1234, cache, kBGMParameterPanPosition, value));
+    
+    // Releasing the slot should invalidate the cached slot
+    XCTAssert(BGMParameterTableSetValue(appTable, 1234, kBGMParameterPanPosition, 20.0f));
+    XCTAssert(driverTable.GetValueRT(1234, cache, kBGMParameterPanPosition, value));
+    BGMParameterTableReleaseSlot(appTable, 1234);
+    XCTAssertFalse(driverTable.GetValueRT(1234, cache, kBGMParameterPanPosition, value));
+    
+    BGMParameterTableClose(appTable);
+}
+
+- (void)testRecreatingKeepsTheTable {
+    BGMParameterTable* appTable = BGMParameterTableCreate(tableName.c_str());
+    
+    if(!appTable)
+    {
+        NSLog(@"Skipping testRecreatingKeepsTheTable: Couldn't create the shared memory object");
+        return;
+    }
+    
+    XCTAssert(BGMParameterTableSetValue(appTable, 1234, kBGMParameterRelativeVolume, 20.0f));
+    
+    // E.g. when BGMApp restarts. The driver should keep reading the same table.
+    BGMParameterTable* restartedAppTable = BGMParameterTableCreate(tableName.c_str());
+    XCTAssert(restartedAppTable != nullptr);
+    
+    if(restartedAppTable)
+    {
+        Float32 value;
+        XCTAssert(BGMParameterTableGetValue(BGMParameterTableFindSlot(restartedAppTable, 1234),
+                                            1234,
+                                            kBGMParameterRelativeVolume,
+                                            &value));
+        XCTAssertEqual(value, 20.0f);
+        BGMParameterTableClose(restartedAppTable);
+    }
+    
+    BGMParameterTableClose(appTable);
+}
+
+- (void)testWorldWritableTableIsReplaced {
+    // E.g. one created by an older version of the driver, or by another process to get BGMApp to
+    // use a table it can write to
+    int file = shm_open(tableName.c_str(), O_RDWR | O_CREAT | O_EXCL, 0666);
+    
+    if(file < 0)
+    {
+        NSLog(@"Skipping testWorldWritableTableIsReplaced: Couldn't create the shared memory object");
+        return;
+    }
+    
+    fchmod(file, 0666);
+    close(file);
+    
+    XCTAssert(BGMParameterTableOpenReadOnly(tableName.c_str(), geteuid()) == nullptr);
+    
+    BGMParameterTable* appTable = BGMParameterTableCreate(tableName.c_str());
+    XCTAssert(appTable != nullptr);
+    
+    if(appTable)
+    {
+        BGMParameterTable* driverTable = BGMParameterTableOpenReadOnly(tableName.c_str(), geteuid());
+        XCTAssert(driverTable != nullptr);
+        
+        if(driverTable)
+        {
+            BGMParameterTableClose(driverTable);
+        }
+        
+        BGMParameterTableClose(appTable);
+    }
+}
+
+- (void)testOpeningMissingTableFails {
+    XCTAssert(BGMParameterTableOpenReadOnly(tableName.c_str(), geteuid()) == nullptr);
+}
+
+- (void)testFullTable {
+    BGM_SharedParameterTable table(nullptr);
+    
+    // Fill the table with a process that's still running, so its slots can't be reclaimed
+    for(UInt32 i = 0; i < kBGMParameterTableSlotCount; i++)
+    {
+        table.GetTable()->mSlots[i].mProcessID = getpid();
+    }
+    
+    // No slots left, so the app would have to fall back to the property
+    pid_t extraPID = getppid();
+    XCTAssertFalse(BGMParameterTableSetValue(table.GetTable(), extraPID, kBGMParameterRelativeVolume, 1.0f));
+    
+    // Released slots should be reused
+    table.GetTable()->mSlots[7].mProcessID = kBGMParameterSlotFree;
+    XCTAssert(BGMParameterTableSetValue(table.GetTable(), extraPID, kBGMParameterRelativeVolume, 2.0f));
+    
+    BGM_ParameterSlotCache cache;
+    Float32 value;
+    XCTAssert(table.GetValueRT(extraPID, cache, kBGMParameterRelativeVolume, value));
+    XCTAssertEqual(value, 2.0f);
+}
+
+- (void)testExitedAppsSlotsAreReclaimed {
+    BGM_SharedParameterTable table(nullptr);
+    
+    // PIDs above 99999 aren't used on macOS, so these processes can't be running
+    for(pid_t pid = 100000; pid < 100000 + static_cast<pid_t>(kBGMParameterTableSlotCount); pid++)
+    {
+        XCTAssert(BGMParameterTableSetValue(table.GetTable(), pid, kBGMParameterRelativeVolume, 1.0f));
+    }
+    
+    XCTAssert(BGMParameterTableSetValue(table.GetTable(), getpid(), kBGMParameterRelativeVolume, 2.0f));
+    
+    // The reclaimed slot's old values shouldn't be used
+    BGM_ParameterSlotCache cache;
+    Float32 value;
+    XCTAssertFalse(table.GetValueRT(getpid(), cache, kBGMParameterPanPosition, value));
+    XCTAssert(table.GetValueRT(getpid(), cache, kBGMParameterRelativeVolume, value));
+    XCTAssertEqual(value, 2.0f);
+}
+
+#pragma mark Benchmarks
+
+// Measures the cost of sending volume updates through the table and reading them on the IO thread.
+// Compare with testPerformanceOfPropertyUpdates.
+- (void)testPerformanceOfTableUpdates {
+    BGM_SharedParameterTable table(nullptr);
+    BGM_ParameterSlotCache caches[20];
+    
+    [self measureBlock:^{
+        Float32 value;
+        
+        for(UInt32 i = 0; i < kBenchmarkUpdates; i++)
+        {
+            pid_t pid = 100 + (i % 20);
+            BGMParameterTableSetValue(table.GetTable(), pid, kBGMParameterRelativeVolume, i % 100);
+            table.GetValueRT(pid, caches[i % 20], kBGMParameterRelativeVolume, value);
+        }
+    }];
+}
+
+// The same updates as testPerformanceOfTableUpdates, but sent the way kAudioDeviceCustomPropertyAppVolumes
+// is handled. This doesn't include the IPC to coreaudiod, so the real difference is larger.
+- (void)testPerformanceOfPropertyUpdates {
+    BGM_Clients clients(kAudioObjectUnknown);
+    
+    for(UInt32 i = 0; i < 20; i++)
+    {
+        AudioServerPlugInClientInfo clientInfo = { 100 + i, static_cast<pid_t>(100 + i), true, CFSTR("") };
+        clients.AddClient(&clientInfo);
+    }
+    
+    [self measureBlock:^{
+        // Only a fraction of the updates, or the test would take too long. Scale the result up
+        // by the same factor to compare it.
+        for(UInt32 i = 0; i < kBenchmarkUpdates / 100; i++)
+        {
+            CACFDictionary appVolume(true);
+            appVolume.AddSInt32(CFSTR(kBGMAppVolumesKey_ProcessID), 100 + (i % 20));
+            appVolume.AddSInt32(CFSTR(kBGMAppVolumesKey_RelativeVolume), i % 100);
+            
+            CACFArray appVolumes(true);
+            appVolumes.AppendDictionary(appVolume.GetDict());
+            
+            clients.SetClientsRelativeVolumes(appVolumes);
+            clients.GetClientRelativeVolumeRT(100 + (i % 20));
+        }
+    }];
+}
+
+@end
+
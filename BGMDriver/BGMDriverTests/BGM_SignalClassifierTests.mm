@@ -0,0 +1,225 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_SignalClassifierTests.mm
+//  BGMDriverTests
+//
+//  Copyright © 2026 Background Music contributors
+//
+
+// Unit Include
+#include "BGM_SignalClassifier.h"
+
+// Local Includes
+#include "BGM_TestUtils.h"
+
+// STL Includes
+#include <cmath>
+#include <functional>
+#include <vector>
+
+
+static const Float64 kSampleRate = 44100.0;
+static const UInt32 kFrames = 512;
+static const UInt32 kChannels = 2;
+
+// Classify inSecs of the signal inSignal(t) in kFrames buffers and return the class after each
+// buffer.
+static std::vector<BGM_SignalClassifier::Class> Classify(BGM_SignalClassifier& classifier,
+                                                         Float64 inSecs,
+                                                         std::function<Float32(Float64)> inSignal)
+{
+    std::vector<BGM_SignalClassifier::Class> classes;
+    std::vector<Float32> buffer(kFrames * kChannels);
+    
+    for(UInt32 frame = 0; frame < inSecs * kSampleRate; frame += kFrames)
+    {
+        for(UInt32 i = 0; i < kFrames; i++)
+        {
+            buffer[i * kChannels] = buffer[i * kChannels + 1] = inSignal((frame + i) / kSampleRate);
+        }
+        
+        classes.push_back(classifier.ProcessRT(buffer.data(), kFrames));
+    }
+    
+    return classes;
+}
+
+// The time of the first buffer classified as sustained, or -1 if none were.
+static Float64 FirstSustainedSecs(const std::vector<BGM_SignalClassifier::Class>& inClasses)
+{
+    for(size_t i = 0; i < inClasses.size(); i++)
+    {
+        if(inClasses[i] == BGM_SignalClassifier::kClassSustained)
+        {
+            return i * kFrames / kSampleRate;
+        }
+    }
+    
+    return -1.0;
+}
+
+@interface BGM_SignalClassifierTests : XCTestCase
+
+@end
+
+@implementation BGM_SignalClassifierTests
+
+- (void)testSilence {
+    BGM_SignalClassifier classifier(kSampleRate);
+    
+    for(BGM_SignalClassifier::Class theClass : Classify(classifier, 1.0, [] (Float64) { return 0.0f; }))
+    {
+        XCTAssertEqual(theClass, BGM_SignalClassifier::kClassSilent);
+    }
+    
+    XCTAssertEqual(classifier.GetFeatures().mEnergyDB, BGM_SignalClassifier::kSilentEnergyDB);
+}
+
+- (void)testPingIsTransient {
+    BGM_SignalClassifier classifier(kSampleRate);
+    
+    // A notification-like ping that decays quickly
+    auto classes = Classify(classifier, 1.5, [] (Float64 t) {
+        return static_cast<Float32>(0.5 * std::exp(-t / 0.1) * std::sin(2.0 * M_PI * 1000.0 * t));
+    });
+    
+    XCTAssertEqual(classes.front(), BGM_SignalClassifier::kClassTransient);
+    XCTAssertEqual(FirstSustainedSecs(classes), -1.0);
+    
+    // It should have ended by the time it's inaudible
+    XCTAssertEqual(classes.back(), BGM_SignalClassifier::kClassSilent);
+}
+
+- (void)testHeldToneIsSustained {
+    BGM_SignalClassifier classifier(kSampleRate);
+    
+    auto classes = Classify(classifier, 1.0, [] (Float64 t) {
+        return static_cast<Float32>(0.3 * std::sin(2.0 * M_PI * 440.0 * t));
+    });
+    
+    // It doesn't decay, so it should be sustained as soon as it's lasted long enough
+    Float64 firstSustainedSecs = FirstSustainedSecs(classes);
+    XCTAssertGreaterThanOrEqual(firstSustainedSecs + kFrames / kSampleRate,
+                                BGM_SignalClassifier::kMinSustainedSecs);
+    XCTAssertLessThan(firstSustainedSecs, BGM_SignalClassifier::kMinSustainedSecs);
+    XCTAssertEqual(classes.back(), BGM_SignalClassifier::kClassSustained);
+}
+
+- (void)testSyllablesAreSustained {
+    BGM_SignalClassifier classifier(kSampleRate);
+    
+    // Speech-like bursts of a harmonic complex, four per second with short gaps between them
+    auto classes = Classify(classifier, 2.0, [] (Float64 t) {
+        const Float64 position = std::fmod(t, 0.25) / 0.18;
+        const Float64 envelope = (position < 1.0) ? std::sin(M_PI * position) : 0.0;
+        const Float64 pitch = (t < 1.0) ? 150.0 : 200.0;
+        
+        Float64 voice = 0.0;
+        for(int harmonic = 1; harmonic <= 8; harmonic++)
+        {
+            voice += std::sin(2.0 * M_PI * harmonic * pitch * t) / harmonic;
+        }
+        
+        return static_cast<Float32>(0.2 * envelope * voice);
+    });
+    
+    Float64 firstSustainedSecs = FirstSustainedSecs(classes);
+    XCTAssertGreaterThan(firstSustainedSecs, 0.0);
+    XCTAssertLessThan(firstSustainedSecs, 0.75);
+    XCTAssertGreaterThanOrEqual(classifier.GetFeatures().mOnsets, BGM_SignalClassifier::kMinOnsets);
+    
+    // The gaps between syllables shouldn't end the sound
+    for(size_t i = static_cast<size_t>(firstSustainedSecs * kSampleRate / kFrames); i < classes.size(); i++)
+    {
+        XCTAssertEqual(classes[i], BGM_SignalClassifier::kClassSustained);
+    }
+}
+
+- (void)testSoundEndsAfterGap {
+    BGM_SignalClassifier classifier(kSampleRate);
+    
+    // A tone for 0.6 seconds and then silence
+    auto classes = Classify(classifier, 1.5, [] (Float64 t) {
+        return static_cast<Float32>((t < 0.6) ? 0.3 * std::sin(2.0 * M_PI * 440.0 * t) : 0.0);
+    });
+    
+    // Still sustained during a short gap
+    XCTAssertEqual(classes[static_cast<size_t>(0.7 * kSampleRate / kFrames)],
+                   BGM_SignalClassifier::kClassSustained);
+    // But not once the gap is longer than kMaxGapSecs
+    XCTAssertEqual(classes.back(), BGM_SignalClassifier::kClassSilent);
+    
+    // So a ping after the gap is a new, transient sound
+    auto pingClasses = Classify(classifier, 0.2, [] (Float64 t) {
+        return static_cast<Float32>(0.5 * std::exp(-t / 0.05) * std::sin(2.0 * M_PI * 1000.0 * t));
+    });
+    
+    XCTAssertEqual(pingClasses.front(), BGM_SignalClassifier::kClassTransient);
+}
+
+- (void)testKernelsMatchReference {
+    const UInt32 kSamples = 1031;  // Not a multiple of the SIMD width.
+    
+    std::vector<Float32> buffer(kSamples);
+    for(UInt32 i = 0; i < kSamples; i++)
+    {
+        buffer[i] = std::sin(static_cast<Float32>(i) * 0.37f) * 0.5f;
+    }
+    
+    XCTAssertEqualWithAccuracy(BGM_SignalClassifier::MeanSquareRT(buffer.data(), kSamples),
+                               BGM_SignalClassifier::MeanSquareReferenceRT(buffer.data(), kSamples),
+                               1e-6f);
+    XCTAssertEqualWithAccuracy(BGM_SignalClassifier::MeanSquareRT(buffer.data(), kSamples), 0.125f, 0.001f);
+    XCTAssertEqual(BGM_SignalClassifier::MeanSquareRT(buffer.data(), 0), 0.0f);
+    
+    for(UInt32 stride = 1; stride <= 2; stride++)
+    {
+        XCTAssertEqual(BGM_SignalClassifier::ZeroCrossingsRT(buffer.data(), stride, kSamples / stride),
+                       BGM_SignalClassifier::ZeroCrossingsReferenceRT(buffer.data(), stride, kSamples / stride));
+    }
+    
+    // sin(0.37 i) changes sign about every 8.5 samples
+    XCTAssertEqualWithAccuracy(BGM_SignalClassifier::ZeroCrossingsRT(buffer.data(), 1, kSamples),
+                               kSamples * 0.37 / M_PI,
+                               2.0);
+}
+
+- (void)testPerformance {
+    BGM_SignalClassifier classifier(kSampleRate);
+    
+    std::vector<Float32> buffer(kFrames * kChannels);
+    for(UInt32 i = 0; i < buffer.size(); i++)
+    {
+        buffer[i] = std::sin(static_cast<Float32>(i) * 0.05f) * 0.3f;
+    }
+    
+    // Blocks capture C++ objects by const copy.
+    BGM_SignalClassifier* classifierPtr = &classifier;
+    const Float32* bufferPtr = buffer.data();
+    
+    // One second of IO cycles. Each should take a tiny fraction of the cycle's duration.
+    [self measureBlock:^{
+        for(UInt32 cycle = 0; cycle < kSampleRate / kFrames; cycle++)
+        {
+            classifierPtr->ProcessRT(bufferPtr, kFrames);
+        }
+    }];
+}
+
+@end
+
@@ -0,0 +1,207 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  CAVolumeCurveTests.mm
+//  BGMDriverTests
+//
+//  Copyright © 2026 Background Music contributors
+//
+
+// Unit Include
+#include "CAVolumeCurve.h"
+
+// Local Includes
+#include "BGM_TestUtils.h"
+
+// STL Includes
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+
+// The raw to dB and raw to scalar conversions as CAVolumeCurve calculated them before it had
+// lookup tables. The tables should give exactly the same answers.
+typedef std::vector<std::pair<CARawPoint, CADBPoint>> ReferenceRanges;
+
+static Float32 ReferenceRawToDB(const ReferenceRanges& inRanges, SInt32 inRaw)
+{
+    SInt32 theRawMin = inRanges.front().first.mMinimum;
+    SInt32 theRawMax = inRanges.back().first.mMaximum;
+    inRaw = std::min(std::max(inRaw, theRawMin), theRawMax);
+
+    SInt32 theNumberRawSteps = inRaw - theRawMin;
+    Float32 theAnswer = inRanges.front().second.mMinimum;
+
+    for(auto theRange = inRanges.begin(); (theNumberRawSteps > 0) && (theRange != inRanges.end()); theRange++)
+    {
+        SInt32 theRawRange = theRange->first.mMaximum - theRange->first.mMinimum;
+        Float32 theDBRange = theRange->second.mMaximum - theRange->second.mMinimum;
+        Float32 theDBPerRaw = theDBRange / static_cast<Float32>(theRawRange);
+
+        SInt32 theRawStepsToAdd = std::min(theRawRange, theNumberRawSteps);
+        theAnswer += theRawStepsToAdd * theDBPerRaw;
+        theNumberRawSteps -= theRawStepsToAdd;
+    }
+
+    return theAnswer;
+}
+
+static Float32 ReferenceRawToScalar(const ReferenceRanges& inRanges,
+                                    bool inIsApplyingTransferFunction,
+                                    Float32 inExponent,
+                                    SInt32 inRaw)
+{
+    SInt32 theRawMin = inRanges.front().first.mMinimum;
+    SInt32 theRawMax = inRanges.back().first.mMaximum;
+    Float32 theDBRange = inRanges.back().second.mMaximum - inRanges.front().second.mMinimum;
+    inRaw = std::min(std::max(inRaw, theRawMin), theRawMax);
+
+    Float32 theAnswer =
+            static_cast<Float32>(inRaw - theRawMin) / static_cast<Float32>(theRawMax - theRawMin);
+
+    if(inIsApplyingTransferFunction && (theDBRange > 30.0f))
+    {
+        theAnswer = powf(theAnswer, inExponent);
+    }
+
+    return theAnswer;
+}
+
+static bool BitwiseEqual(Float32 inA, Float32 inB)
+{
+    return memcmp(&inA, &inB, sizeof(Float32)) == 0;
+}
+
+@interface CAVolumeCurveTests : XCTestCase
+
+@end
+
+@implementation CAVolumeCurveTests
+
+- (void)testLookupTablesMatchCalculatedConversions {
+    const std::vector<ReferenceRanges> theCurves = {
+        // The curve BGM_VolumeControl uses.
+        { { CARawPoint(0, 96), CADBPoint(-96.0f, 0.0f) } },
+        // Multiple ranges with different slopes.
+        { { CARawPoint(0, 50), CADBPoint(-96.0f, -30.0f) }, { CARawPoint(50, 100), CADBPoint(-30.0f, 0.0f) } },
+        // Negative raw values and a dB range too small for the transfer function to be applied.
+        { { CARawPoint(-20, 20), CADBPoint(-10.0f, 6.0f) } }
+    };
+
+    // The exponents for kLinearCurve to kPow12Over1Curve.
+    const Float32 theExponents[] = {
+        1.0f, 1.0f / 3.0f, 1.0f / 2.0f, 3.0f / 4.0f, 3.0f / 2.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f,
+        9.0f, 10.0f, 11.0f, 12.0f
+    };
+
+    for(const ReferenceRanges& theRanges : theCurves)
+    {
+        for(UInt32 theTransferFunction = CAVolumeCurve::kLinearCurve;
+            theTransferFunction <= CAVolumeCurve::kPow12Over1Curve;
+            theTransferFunction++)
+        {
+            for(bool isApplyingTransferFunction : { true, false })
+            {
+                // Set the transfer function both before and after adding the ranges to check the
+                // tables are rebuilt when either changes.
+                CAVolumeCurve theCurve;
+                theCurve.SetTransferFunction(theTransferFunction);
+
+                for(const auto& theRange : theRanges)
+                {
+                    theCurve.AddRange(theRange.first.mMinimum,
+                                      theRange.first.mMaximum,
+                                      theRange.second.mMinimum,
+                                      theRange.second.mMaximum);
+                }
+
+                bool theExpectedIsApplying =
+                        isApplyingTransferFunction && (theTransferFunction != CAVolumeCurve::kLinearCurve);
+                theCurve.SetIsApplyingTransferFunction(theExpectedIsApplying);
+
+                // Include raw values outside the curve to check they're clamped.
+                for(SInt32 theRaw = theRanges.front().first.mMinimum - 10;
+                    theRaw <= theRanges.back().first.mMaximum + 10;
+                    theRaw++)
+                {
+                    Float32 theExpectedDB = ReferenceRawToDB(theRanges, theRaw);
+                    Float32 theExpectedScalar = ReferenceRawToScalar(theRanges,
+                                                                     theExpectedIsApplying,
+                                                                     theExponents[theTransferFunction],
+                                                                     theRaw);
+
+                    XCTAssert(BitwiseEqual(theCurve.ConvertRawToDB(theRaw), theExpectedDB));
+                    XCTAssert(BitwiseEqual(theCurve.ConvertRawToScalar(theRaw), theExpectedScalar));
+                }
+            }
+        }
+    }
+}
+
+- (void)testLookupTablesAreRebuiltWhenRangesChange {
+    CAVolumeCurve theCurve;
+    theCurve.AddRange(0, 96, -96.0f, 0.0f);
+    XCTAssertEqual(theCurve.ConvertRawToDB(48), -48.0f);
+
+    theCurve.ResetRange();
+    theCurve.AddRange(0, 10, -20.0f, 0.0f);
+    XCTAssertEqual(theCurve.ConvertRawToDB(48), 0.0f);
+    XCTAssertEqual(theCurve.ConvertRawToDB(5), -10.0f);
+    XCTAssertEqual(theCurve.ConvertRawToScalar(10), 1.0f);
+}
+
+- (void)testLargeCurvesAreCalculated {
+    // Too many raw steps to tabulate, so the conversions should be calculated instead.
+    CAVolumeCurve theCurve;
+    theCurve.AddRange(0, 1 << 20, -96.0f, 0.0f);
+
+    ReferenceRanges theRanges = { { CARawPoint(0, 1 << 20), CADBPoint(-96.0f, 0.0f) } };
+
+    for(SInt32 theRaw : { 0, 1, 12345, 1 << 19, (1 << 20) - 1, 1 << 20 })
+    {
+        XCTAssert(BitwiseEqual(theCurve.ConvertRawToDB(theRaw), ReferenceRawToDB(theRanges, theRaw)));
+        XCTAssert(BitwiseEqual(theCurve.ConvertRawToScalar(theRaw),
+                               ReferenceRawToScalar(theRanges, true, 2.0f, theRaw)));
+    }
+}
+
+- (void)testConversionPerformance {
+    // 10 million conversions per iteration. Divide by the measured time to get conversions per
+    // second.
+    const UInt32 kConversions = 10000000;
+
+    CAVolumeCurve theCurve;
+    theCurve.AddRange(0, 96, -96.0f, 0.0f);
+
+    [self measureBlock:^{
+        Float32 theSum = 0.0f;
+
+        for(UInt32 i = 0; i < kConversions / 2; i++)
+        {
+            SInt32 theRaw = static_cast<SInt32>(i % 97);
+            theSum += theCurve.ConvertRawToScalar(theRaw);
+            theSum += theCurve.ConvertRawToDB(theRaw);
+        }
+
+        XCTAssert(std::isfinite(theSum));
+    }];
+}
+
+@end
+
@@ -0,0 +1,1218 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_PortableCoreFoundation.cpp
+//  BGMDriver Portable
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  The CoreFoundation functions declared in include/CoreFoundation, for building the driver's core
+//  without macOS. Every object is a BGM_CFObject, which keeps its own retain count.
+//
+
+// Local Includes
+#include <CoreFoundation/CoreFoundation.h>
+
+// STL Includes
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+
+#pragma mark Objects
+
+namespace
+{
+
+enum BGM_CFTypeIDs : CFTypeID
+{
+    kBGM_CFStringTypeID = 7,
+    kBGM_CFNumberTypeID,
+    kBGM_CFBooleanTypeID,
+    kBGM_CFArrayTypeID,
+    kBGM_CFDictionaryTypeID,
+    kBGM_CFDataTypeID,
+    kBGM_CFURLTypeID,
+    kBGM_CFUUIDTypeID
+};
+
+class BGM_CFObject
+{
+
+public:
+    explicit                BGM_CFObject(CFTypeID inTypeID, bool inIsImmortal = false)
+                            : mTypeID(inTypeID), mRetainCount(1), mIsImmortal(inIsImmortal) { }
+    virtual                 ~BGM_CFObject() = default;
+
+    CFTypeID                GetTypeID() const { return mTypeID; }
+
+    void                    Retain()
+    {
+        if(!mIsImmortal)
+        {
+            mRetainCount.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void                    Release()
+    {
+        if(!mIsImmortal && mRetainCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            delete this;
+        }
+    }
+
+    CFIndex                 GetRetainCount() const
+    {
+        return mIsImmortal ? LONG_MAX : mRetainCount.load(std::memory_order_relaxed);
+    }
+
+    // Only called with objects of the same type.
+    virtual bool            Equals(const BGM_CFObject& inOther) const { return this == &inOther; }
+    virtual CFHashCode      Hash() const { return reinterpret_cast<CFHashCode>(this); }
+    virtual std::string     Describe() const = 0;
+
+private:
+    const CFTypeID          mTypeID;
+    std::atomic<CFIndex>    mRetainCount;
+    const bool              mIsImmortal;
+
+};
+
+inline BGM_CFObject* ToObject(CFTypeRef inRef)
+{
+    return const_cast<BGM_CFObject*>(reinterpret_cast<const BGM_CFObject*>(inRef));
+}
+
+inline CFTypeRef ToRef(const BGM_CFObject* inObject)
+{
+    return reinterpret_cast<CFTypeRef>(inObject);
+}
+
+// Retains the value if the collection's callbacks are the kCFType ones.
+inline void RetainIf(bool inRetains, const void* inValue)
+{
+    if(inRetains && inValue != nullptr)
+    {
+        CFRetain(inValue);
+    }
+}
+
+inline void ReleaseIf(bool inRetains, const void* inValue)
+{
+    if(inRetains && inValue != nullptr)
+    {
+        CFRelease(inValue);
+    }
+}
+
+#pragma mark Strings
+
+class BGM_CFString
+:
+    public BGM_CFObject
+{
+
+public:
+    explicit                BGM_CFString(std::string inUTF8, bool inIsImmortal = false)
+                            : BGM_CFObject(kBGM_CFStringTypeID, inIsImmortal), mUTF8(std::move(inUTF8)) { }
+
+    bool                    Equals(const BGM_CFObject& inOther) const override
+    {
+        return mUTF8 == static_cast<const BGM_CFString&>(inOther).mUTF8;
+    }
+
+    CFHashCode              Hash() const override { return std::hash<std::string>()(mUTF8); }
+    std::string             Describe() const override { return mUTF8; }
+
+    // The string in UTF-16, which is what CFString's lengths and ranges are measured in.
+    std::vector<UniChar>    GetUTF16() const
+    {
+        std::vector<UniChar> theUTF16;
+        theUTF16.reserve(mUTF8.size());
+        
+        for(size_t i = 0; i < mUTF8.size(); )
+        {
+            UInt8 theLead = static_cast<UInt8>(mUTF8[i]);
+            UInt32 theCodePoint;
+            size_t theLength;
+            
+            if(theLead < 0x80)
+            {
+                theCodePoint = theLead;
+                theLength = 1;
+            }
+            else if((theLead >> 5) == 0x6)
+            {
+                theCodePoint = theLead & 0x1F;
+                theLength = 2;
+            }
+            else if((theLead >> 4) == 0xE)
+            {
+                theCodePoint = theLead & 0x0F;
+                theLength = 3;
+            }
+            else
+            {
+                theCodePoint = theLead & 0x07;
+                theLength = 4;
+            }
+            
+            for(size_t j = 1; j < theLength && i + j < mUTF8.size(); j++)
+            {
+                theCodePoint = (theCodePoint << 6) | (static_cast<UInt8>(mUTF8[i + j]) & 0x3F);
+            }
+            
+            if(theCodePoint >= 0x10000)
+            {
+                theCodePoint -= 0x10000;
+                theUTF16.push_back(static_cast<UniChar>(0xD800 + (theCodePoint >> 10)));
+                theUTF16.push_back(static_cast<UniChar>(0xDC00 + (theCodePoint & 0x3FF)));
+            }
+            else
+            {
+                theUTF16.push_back(static_cast<UniChar>(theCodePoint));
+            }
+            
+            i += theLength;
+        }
+        
+        return theUTF16;
+    }
+
+    std::string             mUTF8;
+
+};
+
+inline BGM_CFString& ToString(CFTypeRef inRef)
+{
+    return *static_cast<BGM_CFString*>(ToObject(inRef));
+}
+
+std::string UTF16ToUTF8(const UniChar* inCharacters, size_t inLength)
+{
+    std::string theUTF8;
+    
+    for(size_t i = 0; i < inLength; i++)
+    {
+        UInt32 theCodePoint = inCharacters[i];
+        
+        if(theCodePoint >= 0xD800 && theCodePoint < 0xDC00 && i + 1 < inLength)
+        {
+            theCodePoint = 0x10000 + ((theCodePoint - 0xD800) << 10) + (inCharacters[++i] - 0xDC00);
+        }
+        
+        if(theCodePoint < 0x80)
+        {
+            theUTF8 += static_cast<char>(theCodePoint);
+        }
+        else if(theCodePoint < 0x800)
+        {
+            theUTF8 += static_cast<char>(0xC0 | (theCodePoint >> 6));
+            theUTF8 += static_cast<char>(0x80 | (theCodePoint & 0x3F));
+        }
+        else if(theCodePoint < 0x10000)
+        {
+            theUTF8 += static_cast<char>(0xE0 | (theCodePoint >> 12));
+            theUTF8 += static_cast<char>(0x80 | ((theCodePoint >> 6) & 0x3F));
+            theUTF8 += static_cast<char>(0x80 | (theCodePoint & 0x3F));
+        }
+        else
+        {
+            theUTF8 += static_cast<char>(0xF0 | (theCodePoint >> 18));
+            theUTF8 += static_cast<char>(0x80 | ((theCodePoint >> 12) & 0x3F));
+            theUTF8 += static_cast<char>(0x80 | ((theCodePoint >> 6) & 0x3F));
+            theUTF8 += static_cast<char>(0x80 | (theCodePoint & 0x3F));
+        }
+    }
+    
+    return theUTF8;
+}
+
+bool IsSupportedEncoding(CFStringEncoding inEncoding)
+{
+    return inEncoding == kCFStringEncodingUTF8 || inEncoding == kCFStringEncodingASCII;
+}
+
+#pragma mark Numbers and Booleans
+
+class BGM_CFNumber
+:
+    public BGM_CFObject
+{
+
+public:
+                            BGM_CFNumber(CFNumberType inType, const void* inValuePtr)
+                            : BGM_CFObject(kBGM_CFNumberTypeID), mType(inType), mInteger(0), mFloat(0.0)
+    {
+        switch(inType)
+        {
+            case kCFNumberSInt8Type:    mInteger = *static_cast<const SInt8*>(inValuePtr);      break;
+            case kCFNumberCharType:     mInteger = *static_cast<const char*>(inValuePtr);       break;
+            case kCFNumberSInt16Type:   mInteger = *static_cast<const SInt16*>(inValuePtr);     break;
+            case kCFNumberShortType:    mInteger = *static_cast<const short*>(inValuePtr);      break;
+            case kCFNumberSInt32Type:   mInteger = *static_cast<const SInt32*>(inValuePtr);     break;
+            case kCFNumberIntType:      mInteger = *static_cast<const int*>(inValuePtr);        break;
+            case kCFNumberSInt64Type:   mInteger = *static_cast<const SInt64*>(inValuePtr);     break;
+            case kCFNumberLongType:     mInteger = *static_cast<const long*>(inValuePtr);       break;
+            case kCFNumberLongLongType: mInteger = *static_cast<const long long*>(inValuePtr);  break;
+            case kCFNumberCFIndexType:  mInteger = *static_cast<const CFIndex*>(inValuePtr);    break;
+            case kCFNumberFloat32Type:
+            case kCFNumberFloatType:    mFloat = *static_cast<const Float32*>(inValuePtr);      break;
+            case kCFNumberFloat64Type:
+            case kCFNumberDoubleType:   mFloat = *static_cast<const Float64*>(inValuePtr);      break;
+            default:                    break;
+        }
+    }
+
+    bool                    IsFloat() const
+    {
+        return mType == kCFNumberFloat32Type || mType == kCFNumberFloatType ||
+               mType == kCFNumberFloat64Type || mType == kCFNumberDoubleType;
+    }
+
+    Float64                 GetFloat() const { return IsFloat() ? mFloat : static_cast<Float64>(mInteger); }
+    SInt64                  GetInteger() const { return IsFloat() ? static_cast<SInt64>(mFloat) : mInteger; }
+
+    // CFNumbers are equal if their values are, whatever their types.
+    bool                    Equals(const BGM_CFObject& inOther) const override
+    {
+        const BGM_CFNumber& theOther = static_cast<const BGM_CFNumber&>(inOther);
+        
+        if(IsFloat() || theOther.IsFloat())
+        {
+            return GetFloat() == theOther.GetFloat();
+        }
+        
+        return mInteger == theOther.mInteger;
+    }
+
+    CFHashCode              Hash() const override
+    {
+        return (IsFloat() && GetFloat() != static_cast<Float64>(GetInteger())) ?
+                std::hash<Float64>()(mFloat) :
+                static_cast<CFHashCode>(GetInteger());
+    }
+
+    std::string             Describe() const override
+    {
+        return IsFloat() ? std::to_string(mFloat) : std::to_string(mInteger);
+    }
+
+    const CFNumberType      mType;
+    SInt64                  mInteger;
+    Float64                 mFloat;
+
+};
+
+template <typename T>
+Boolean StoreNumber(const BGM_CFNumber& inNumber, void* outValuePtr)
+{
+    T theValue = inNumber.IsFloat() ? static_cast<T>(inNumber.mFloat) : static_cast<T>(inNumber.mInteger);
+    *static_cast<T*>(outValuePtr) = theValue;
+    
+    // Like CFNumberGetValue, return false if the conversion was lossy.
+    return inNumber.IsFloat() ?
+            static_cast<Float64>(theValue) == inNumber.mFloat :
+            static_cast<SInt64>(theValue) == inNumber.mInteger;
+}
+
+class BGM_CFBoolean
+:
+    public BGM_CFObject
+{
+
+public:
+    explicit                BGM_CFBoolean(bool inValue)
+                            : BGM_CFObject(kBGM_CFBooleanTypeID, true), mValue(inValue) { }
+
+    std::string             Describe() const override { return mValue ? "true" : "false"; }
+
+    const bool              mValue;
+
+};
+
+#pragma mark Collections
+
+class BGM_CFArray
+:
+    public BGM_CFObject
+{
+
+public:
+    explicit                BGM_CFArray(bool inRetainsValues)
+                            : BGM_CFObject(kBGM_CFArrayTypeID), mRetainsValues(inRetainsValues) { }
+
+                            ~BGM_CFArray() override
+    {
+        for(const void* theValue : mValues)
+        {
+            ReleaseIf(mRetainsValues, theValue);
+        }
+    }
+
+    bool                    Equals(const BGM_CFObject& inOther) const override
+    {
+        const BGM_CFArray& theOther = static_cast<const BGM_CFArray&>(inOther);
+        
+        return mValues.size() == theOther.mValues.size() &&
+               std::equal(mValues.begin(), mValues.end(), theOther.mValues.begin(),
+                          [] (const void* inA, const void* inB) { return CFEqual(inA, inB); });
+    }
+
+    CFHashCode              Hash() const override { return mValues.size(); }
+
+    std::string             Describe() const override
+    {
+        std::string theDescription = "(";
+        
+        for(size_t i = 0; i < mValues.size(); i++)
+        {
+            theDescription += (i == 0 ? "" : ", ") + ToObject(mValues[i])->Describe();
+        }
+        
+        return theDescription + ")";
+    }
+
+    const bool              mRetainsValues;
+    std::vector<const void*> mValues;
+
+};
+
+inline BGM_CFArray& ToArray(CFTypeRef inRef)
+{
+    return *static_cast<BGM_CFArray*>(ToObject(inRef));
+}
+
+class BGM_CFDictionary
+:
+    public BGM_CFObject
+{
+
+public:
+                            BGM_CFDictionary(bool inRetainsKeys, bool inRetainsValues)
+                            : BGM_CFObject(kBGM_CFDictionaryTypeID),
+                              mRetainsKeys(inRetainsKeys),
+                              mRetainsValues(inRetainsValues) { }
+
+                            ~BGM_CFDictionary() override
+    {
+        for(const auto& theEntry : mEntries)
+        {
+            ReleaseIf(mRetainsKeys, theEntry.first);
+            ReleaseIf(mRetainsValues, theEntry.second);
+        }
+    }
+
+    // The dictionaries are small, so a linear search is fine.
+    ssize_t                 Find(const void* inKey) const
+    {
+        for(size_t i = 0; i < mEntries.size(); i++)
+        {
+            if(CFEqual(mEntries[i].first, inKey))
+            {
+                return static_cast<ssize_t>(i);
+            }
+        }
+        
+        return -1;
+    }
+
+    bool                    Equals(const BGM_CFObject& inOther) const override
+    {
+        const BGM_CFDictionary& theOther = static_cast<const BGM_CFDictionary&>(inOther);
+        
+        if(mEntries.size() != theOther.mEntries.size())
+        {
+            return false;
+        }
+        
+        for(const auto& theEntry : mEntries)
+        {
+            ssize_t theIndex = theOther.Find(theEntry.first);
+            
+            if(theIndex < 0 || !CFEqual(theEntry.second, theOther.mEntries[theIndex].second))
+            {
+                return false;
+            }
+        }
+        
+        return true;
+    }
+
+    CFHashCode              Hash() const override { return mEntries.size(); }
+
+    std::string             Describe() const override
+    {
+        std::string theDescription = "{";
+        
+        for(size_t i = 0; i < mEntries.size(); i++)
+        {
+            theDescription += (i == 0 ? "" : ", ") +
+                              ToObject(mEntries[i].first)->Describe() + " = " +
+                              ToObject(mEntries[i].second)->Describe();
+        }
+        
+        return theDescription + "}";
+    }
+
+    const bool              mRetainsKeys;
+    const bool              mRetainsValues;
+    std::vector<std::pair<const void*, const void*>> mEntries;
+
+};
+
+inline BGM_CFDictionary& ToDictionary(CFTypeRef inRef)
+{
+    return *static_cast<BGM_CFDictionary*>(ToObject(inRef));
+}
+
+}
+
+#pragma mark Base
+
+const CFAllocatorRef kCFAllocatorDefault = nullptr;
+const CFAllocatorRef kCFAllocatorSystemDefault = nullptr;
+
+// Claim to be the CoreFoundation from the SDK the Xcode project targets (10.13).
+const double kCFCoreFoundationVersionNumber = 1450.14;
+
+CFTypeRef CFRetain(CFTypeRef inObject)
+{
+    if(inObject == nullptr)
+    {
+        std::fprintf(stderr, "CFRetain called with NULL\n");
+        std::abort();
+    }
+    
+    ToObject(inObject)->Retain();
+    return inObject;
+}
+
+void CFRelease(CFTypeRef inObject)
+{
+    if(inObject == nullptr)
+    {
+        std::fprintf(stderr, "CFRelease called with NULL\n");
+        std::abort();
+    }
+    
+    ToObject(inObject)->Release();
+}
+
+CFIndex CFGetRetainCount(CFTypeRef inObject)
+{
+    return ToObject(inObject)->GetRetainCount();
+}
+
+CFTypeID CFGetTypeID(CFTypeRef inObject)
+{
+    return ToObject(inObject)->GetTypeID();
+}
+
+Boolean CFEqual(CFTypeRef inObject1, CFTypeRef inObject2)
+{
+    if(inObject1 == inObject2)
+    {
+        return true;
+    }
+    
+    if(inObject1 == nullptr || inObject2 == nullptr || CFGetTypeID(inObject1) != CFGetTypeID(inObject2))
+    {
+        return false;
+    }
+    
+    return ToObject(inObject1)->Equals(*ToObject(inObject2));
+}
+
+CFHashCode CFHash(CFTypeRef inObject)
+{
+    return ToObject(inObject)->Hash();
+}
+
+CFStringRef CFCopyDescription(CFTypeRef inObject)
+{
+    std::string theDescription = (inObject == nullptr) ? "(null)" : ToObject(inObject)->Describe();
+    return CFStringCreateWithCString(kCFAllocatorDefault, theDescription.c_str(), kCFStringEncodingUTF8);
+}
+
+void CFShow(CFTypeRef inObject)
+{
+    std::fprintf(stderr, "%s\n", (inObject == nullptr) ? "(null)" : ToObject(inObject)->Describe().c_str());
+}
+
+#pragma mark Strings
+
+CFStringRef __CFStringMakeConstantString(const char* inCString)
+{
+    // Interned so each literal is only allocated once. The strings are never freed, like the
+    // constant strings the compiler emits on macOS.
+    static std::mutex sMutex;
+    static std::unordered_map<std::string, BGM_CFString*>* sStrings =
+            new std::unordered_map<std::string, BGM_CFString*>();
+    
+    std::lock_guard<std::mutex> theLock(sMutex);
+    BGM_CFString*& theString = (*sStrings)[inCString];
+    
+    if(theString == nullptr)
+    {
+        theString = new BGM_CFString(inCString, true);
+    }
+    
+    return reinterpret_cast<CFStringRef>(ToRef(theString));
+}
+
+CFTypeID CFStringGetTypeID(void)
+{
+    return kBGM_CFStringTypeID;
+}
+
+CFStringRef CFStringCreateWithCString(CFAllocatorRef inAllocator,
+                                      const char* inCString,
+                                      CFStringEncoding inEncoding)
+{
+    (void)inAllocator;
+    
+    if(inCString == nullptr || !IsSupportedEncoding(inEncoding))
+    {
+        return nullptr;
+    }
+    
+    return reinterpret_cast<CFStringRef>(ToRef(new BGM_CFString(inCString)));
+}
+
+CFStringRef CFStringCreateWithBytes(CFAllocatorRef inAllocator,
+                                    const UInt8* inBytes,
+                                    CFIndex inNumberBytes,
+                                    CFStringEncoding inEncoding,
+                                    Boolean inIsExternalRepresentation)
+{
+    (void)inAllocator;
+    (void)inIsExternalRepresentation;
+    
+    if(inBytes == nullptr || inNumberBytes < 0 || !IsSupportedEncoding(inEncoding))
+    {
+        return nullptr;
+    }
+    
+    std::string theString(reinterpret_cast<const char*>(inBytes), static_cast<size_t>(inNumberBytes));
+    return reinterpret_cast<CFStringRef>(ToRef(new BGM_CFString(std::move(theString))));
+}
+
+CFStringRef CFStringCreateCopy(CFAllocatorRef inAllocator, CFStringRef inString)
+{
+    (void)inAllocator;
+    return reinterpret_cast<CFStringRef>(ToRef(new BGM_CFString(ToString(inString).mUTF8)));
+}
+
+CFMutableStringRef CFStringCreateMutable(CFAllocatorRef inAllocator, CFIndex inMaxLength)
+{
+    (void)inAllocator;
+    (void)inMaxLength;
+    return reinterpret_cast<CFMutableStringRef>(const_cast<void*>(ToRef(new BGM_CFString(""))));
+}
+
+CFMutableStringRef CFStringCreateMutableCopy(CFAllocatorRef inAllocator,
+                                             CFIndex inMaxLength,
+                                             CFStringRef inString)
+{
+    (void)inAllocator;
+    (void)inMaxLength;
+    return reinterpret_cast<CFMutableStringRef>(const_cast<void*>(ToRef(new BGM_CFString(ToString(inString).mUTF8))));
+}
+
+CFIndex CFStringGetLength(CFStringRef inString)
+{
+    return static_cast<CFIndex>(ToString(inString).GetUTF16().size());
+}
+
+void CFStringGetCharacters(CFStringRef inString, CFRange inRange, UniChar* outBuffer)
+{
+    std::vector<UniChar> theUTF16 = ToString(inString).GetUTF16();
+    std::copy(theUTF16.begin() + inRange.location,
+              theUTF16.begin() + inRange.location + inRange.length,
+              outBuffer);
+}
+
+const char* CFStringGetCStringPtr(CFStringRef inString, CFStringEncoding inEncoding)
+{
+    return IsSupportedEncoding(inEncoding) ? ToString(inString).mUTF8.c_str() : nullptr;
+}
+
+Boolean CFStringGetCString(CFStringRef inString,
+                           char* outBuffer,
+                           CFIndex inBufferSize,
+                           CFStringEncoding inEncoding)
+{
+    const std::string& theString = ToString(inString).mUTF8;
+    
+    if(!IsSupportedEncoding(inEncoding) ||
+       inBufferSize <= 0 ||
+       theString.size() + 1 > static_cast<size_t>(inBufferSize))
+    {
+        return false;
+    }
+    
+    std::memcpy(outBuffer, theString.c_str(), theString.size() + 1);
+    return true;
+}
+
+CFIndex CFStringGetBytes(CFStringRef inString,
+                         CFRange inRange,
+                         CFStringEncoding inEncoding,
+                         UInt8 inLossByte,
+                         Boolean inIsExternalRepresentation,
+                         UInt8* outBuffer,
+                         CFIndex inMaxBufferLength,
+                         CFIndex* outUsedBufferLength)
+{
+    (void)inLossByte;
+    (void)inIsExternalRepresentation;
+    
+    if(!IsSupportedEncoding(inEncoding))
+    {
+        return 0;
+    }
+    
+    std::vector<UniChar> theUTF16 = ToString(inString).GetUTF16();
+    std::string theBytes = UTF16ToUTF8(theUTF16.data() + inRange.location,
+                                       static_cast<size_t>(inRange.length));
+    
+    CFIndex theUsedLength = static_cast<CFIndex>(theBytes.size());
+    
+    if(outBuffer != nullptr)
+    {
+        theUsedLength = std::min(theUsedLength, inMaxBufferLength);
+        std::memcpy(outBuffer, theBytes.data(), static_cast<size_t>(theUsedLength));
+    }
+    
+    if(outUsedBufferLength != nullptr)
+    {
+        *outUsedBufferLength = theUsedLength;
+    }
+    
+    // Every character was converted.
+    return inRange.length;
+}
+
+CFIndex CFStringGetMaximumSizeForEncoding(CFIndex inLength, CFStringEncoding inEncoding)
+{
+    return (inEncoding == kCFStringEncodingUTF8) ? inLength * 3 : inLength;
+}
+
+CFComparisonResult CFStringCompare(CFStringRef inString1,
+                                   CFStringRef inString2,
+                                   CFStringCompareFlags inCompareOptions)
+{
+    std::string theString1 = ToString(inString1).mUTF8;
+    std::string theString2 = ToString(inString2).mUTF8;
+    
+    if((inCompareOptions & kCFCompareCaseInsensitive) != 0)
+    {
+        auto theToLower = [] (std::string& ioString) {
+            std::transform(ioString.begin(), ioString.end(), ioString.begin(),
+                           [] (char c) { return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c; });
+        };
+        
+        theToLower(theString1);
+        theToLower(theString2);
+    }
+    
+    int theComparison = theString1.compare(theString2);
+    return (theComparison < 0) ? kCFCompareLessThan :
+           (theComparison > 0) ? kCFCompareGreaterThan :
+           kCFCompareEqualTo;
+}
+
+Boolean CFStringHasPrefix(CFStringRef inString, CFStringRef inPrefix)
+{
+    const std::string& theString = ToString(inString).mUTF8;
+    const std::string& thePrefix = ToString(inPrefix).mUTF8;
+    
+    return theString.compare(0, thePrefix.size(), thePrefix) == 0;
+}
+
+Boolean CFStringHasSuffix(CFStringRef inString, CFStringRef inSuffix)
+{
+    const std::string& theString = ToString(inString).mUTF8;
+    const std::string& theSuffix = ToString(inSuffix).mUTF8;
+    
+    return theString.size() >= theSuffix.size() &&
+           theString.compare(theString.size() - theSuffix.size(), theSuffix.size(), theSuffix) == 0;
+}
+
+SInt32 CFStringGetIntValue(CFStringRef inString)
+{
+    return static_cast<SInt32>(std::strtol(ToString(inString).mUTF8.c_str(), nullptr, 10));
+}
+
+double CFStringGetDoubleValue(CFStringRef inString)
+{
+    return std::strtod(ToString(inString).mUTF8.c_str(), nullptr);
+}
+
+void CFStringAppend(CFMutableStringRef ioString, CFStringRef inAppendedString)
+{
+    ToString(ioString).mUTF8 += ToString(inAppendedString).mUTF8;
+}
+
+void CFStringAppendCString(CFMutableStringRef ioString,
+                           const char* inCString,
+                           CFStringEncoding inEncoding)
+{
+    if(IsSupportedEncoding(inEncoding))
+    {
+        ToString(ioString).mUTF8 += inCString;
+    }
+}
+
+#pragma mark Numbers and Booleans
+
+static const BGM_CFBoolean sTrue(true);
+static const BGM_CFBoolean sFalse(false);
+
+const CFBooleanRef kCFBooleanTrue = reinterpret_cast<CFBooleanRef>(ToRef(&sTrue));
+const CFBooleanRef kCFBooleanFalse = reinterpret_cast<CFBooleanRef>(ToRef(&sFalse));
+
+CFTypeID CFBooleanGetTypeID(void)
+{
+    return kBGM_CFBooleanTypeID;
+}
+
+Boolean CFBooleanGetValue(CFBooleanRef inBoolean)
+{
+    return static_cast<const BGM_CFBoolean*>(ToObject(inBoolean))->mValue;
+}
+
+CFTypeID CFNumberGetTypeID(void)
+{
+    return kBGM_CFNumberTypeID;
+}
+
+CFNumberRef CFNumberCreate(CFAllocatorRef inAllocator, CFNumberType inType, const void* inValuePtr)
+{
+    (void)inAllocator;
+    
+    if(inValuePtr == nullptr || inType < kCFNumberSInt8Type || inType > kCFNumberMaxType)
+    {
+        return nullptr;
+    }
+    
+    return reinterpret_cast<CFNumberRef>(ToRef(new BGM_CFNumber(inType, inValuePtr)));
+}
+
+CFNumberType CFNumberGetType(CFNumberRef inNumber)
+{
+    return static_cast<const BGM_CFNumber*>(ToObject(inNumber))->mType;
+}
+
+Boolean CFNumberIsFloatType(CFNumberRef inNumber)
+{
+    return static_cast<const BGM_CFNumber*>(ToObject(inNumber))->IsFloat();
+}
+
+Boolean CFNumberGetValue(CFNumberRef inNumber, CFNumberType inType, void* outValuePtr)
+{
+    const BGM_CFNumber& theNumber = *static_cast<const BGM_CFNumber*>(ToObject(inNumber));
+    
+    switch(inType)
+    {
+        case kCFNumberSInt8Type:    return StoreNumber<SInt8>(theNumber, outValuePtr);
+        case kCFNumberCharType:     return StoreNumber<char>(theNumber, outValuePtr);
+        case kCFNumberSInt16Type:   return StoreNumber<SInt16>(theNumber, outValuePtr);
+        case kCFNumberShortType:    return StoreNumber<short>(theNumber, outValuePtr);
+        case kCFNumberSInt32Type:   return StoreNumber<SInt32>(theNumber, outValuePtr);
+        case kCFNumberIntType:      return StoreNumber<int>(theNumber, outValuePtr);
+        case kCFNumberSInt64Type:   return StoreNumber<SInt64>(theNumber, outValuePtr);
+        case kCFNumberLongType:     return StoreNumber<long>(theNumber, outValuePtr);
+        case kCFNumberLongLongType: return StoreNumber<long long>(theNumber, outValuePtr);
+        case kCFNumberCFIndexType:  return StoreNumber<CFIndex>(theNumber, outValuePtr);
+        case kCFNumberFloat32Type:
+        case kCFNumberFloatType:    return StoreNumber<Float32>(theNumber, outValuePtr);
+        case kCFNumberFloat64Type:
+        case kCFNumberDoubleType:   return StoreNumber<Float64>(theNumber, outValuePtr);
+        default:                    return false;
+    }
+}
+
+CFComparisonResult CFNumberCompare(CFNumberRef inNumber1, CFNumberRef inNumber2, void* inContext)
+{
+    (void)inContext;
+    
+    const BGM_CFNumber& theNumber1 = *static_cast<const BGM_CFNumber*>(ToObject(inNumber1));
+    const BGM_CFNumber& theNumber2 = *static_cast<const BGM_CFNumber*>(ToObject(inNumber2));
+    
+    if(theNumber1.IsFloat() || theNumber2.IsFloat())
+    {
+        return (theNumber1.GetFloat() < theNumber2.GetFloat()) ? kCFCompareLessThan :
+               (theNumber1.GetFloat() > theNumber2.GetFloat()) ? kCFCompareGreaterThan :
+               kCFCompareEqualTo;
+    }
+    
+    return (theNumber1.mInteger < theNumber2.mInteger) ? kCFCompareLessThan :
+           (theNumber1.mInteger > theNumber2.mInteger) ? kCFCompareGreaterThan :
+           kCFCompareEqualTo;
+}
+
+#pragma mark Arrays
+
+const CFArrayCallBacks kCFTypeArrayCallBacks = { 0 };
+
+CFTypeID CFArrayGetTypeID(void)
+{
+    return kBGM_CFArrayTypeID;
+}
+
+CFArrayRef CFArrayCreate(CFAllocatorRef inAllocator,
+                         const void** inValues,
+                         CFIndex inNumberValues,
+                         const CFArrayCallBacks* inCallBacks)
+{
+    CFMutableArrayRef theArray = CFArrayCreateMutable(inAllocator, inNumberValues, inCallBacks);
+    
+    for(CFIndex i = 0; i < inNumberValues; i++)
+    {
+        CFArrayAppendValue(theArray, inValues[i]);
+    }
+    
+    return theArray;
+}
+
+CFArrayRef CFArrayCreateCopy(CFAllocatorRef inAllocator, CFArrayRef inArray)
+{
+    return CFArrayCreateMutableCopy(inAllocator, 0, inArray);
+}
+
+CFMutableArrayRef CFArrayCreateMutable(CFAllocatorRef inAllocator,
+                                       CFIndex inCapacity,
+                                       const CFArrayCallBacks* inCallBacks)
+{
+    (void)inAllocator;
+    
+    BGM_CFArray* theArray = new BGM_CFArray(inCallBacks != nullptr);
+    theArray->mValues.reserve(static_cast<size_t>(std::max<CFIndex>(inCapacity, 0)));
+    
+    return reinterpret_cast<CFMutableArrayRef>(const_cast<void*>(ToRef(theArray)));
+}
+
+CFMutableArrayRef CFArrayCreateMutableCopy(CFAllocatorRef inAllocator,
+                                           CFIndex inCapacity,
+                                           CFArrayRef inArray)
+{
+    const BGM_CFArray& theSource = ToArray(inArray);
+    CFMutableArrayRef theCopy =
+            CFArrayCreateMutable(inAllocator,
+                                 inCapacity,
+                                 theSource.mRetainsValues ? &kCFTypeArrayCallBacks : nullptr);
+    
+    for(const void* theValue : theSource.mValues)
+    {
+        CFArrayAppendValue(theCopy, theValue);
+    }
+    
+    return theCopy;
+}
+
+CFIndex CFArrayGetCount(CFArrayRef inArray)
+{
+    return static_cast<CFIndex>(ToArray(inArray).mValues.size());
+}
+
+const void* CFArrayGetValueAtIndex(CFArrayRef inArray, CFIndex inIndex)
+{
+    return ToArray(inArray).mValues.at(static_cast<size_t>(inIndex));
+}
+
+CFIndex CFArrayGetFirstIndexOfValue(CFArrayRef inArray, CFRange inRange, const void* inValue)
+{
+    const BGM_CFArray& theArray = ToArray(inArray);
+    
+    for(CFIndex i = inRange.location; i < inRange.location + inRange.length; i++)
+    {
+        if(CFEqual(theArray.mValues.at(static_cast<size_t>(i)), inValue))
+        {
+            return i;
+        }
+    }
+    
+    return kCFNotFound;
+}
+
+Boolean CFArrayContainsValue(CFArrayRef inArray, CFRange inRange, const void* inValue)
+{
+    return CFArrayGetFirstIndexOfValue(inArray, inRange, inValue) != kCFNotFound;
+}
+
+void CFArrayAppendValue(CFMutableArrayRef ioArray, const void* inValue)
+{
+    CFArrayInsertValueAtIndex(ioArray, CFArrayGetCount(ioArray), inValue);
+}
+
+void CFArrayInsertValueAtIndex(CFMutableArrayRef ioArray, CFIndex inIndex, const void* inValue)
+{
+    BGM_CFArray& theArray = ToArray(ioArray);
+    RetainIf(theArray.mRetainsValues, inValue);
+    theArray.mValues.insert(theArray.mValues.begin() + inIndex, inValue);
+}
+
+void CFArraySetValueAtIndex(CFMutableArrayRef ioArray, CFIndex inIndex, const void* inValue)
+{
+    BGM_CFArray& theArray = ToArray(ioArray);
+    
+    if(inIndex == static_cast<CFIndex>(theArray.mValues.size()))
+    {
+        CFArrayAppendValue(ioArray, inValue);
+        return;
+    }
+    
+    RetainIf(theArray.mRetainsValues, inValue);
+    ReleaseIf(theArray.mRetainsValues, theArray.mValues.at(static_cast<size_t>(inIndex)));
+    theArray.mValues[static_cast<size_t>(inIndex)] = inValue;
+}
+
+void CFArrayRemoveValueAtIndex(CFMutableArrayRef ioArray, CFIndex inIndex)
+{
+    BGM_CFArray& theArray = ToArray(ioArray);
+    ReleaseIf(theArray.mRetainsValues, theArray.mValues.at(static_cast<size_t>(inIndex)));
+    theArray.mValues.erase(theArray.mValues.begin() + inIndex);
+}
+
+void CFArrayRemoveAllValues(CFMutableArrayRef ioArray)
+{
+    BGM_CFArray& theArray = ToArray(ioArray);
+    
+    for(const void* theValue : theArray.mValues)
+    {
+        ReleaseIf(theArray.mRetainsValues, theValue);
+    }
+    
+    theArray.mValues.clear();
+}
+
+void CFArraySortValues(CFMutableArrayRef ioArray,
+                       CFRange inRange,
+                       CFComparatorFunction inComparator,
+                       void* inContext)
+{
+    BGM_CFArray& theArray = ToArray(ioArray);
+    std::stable_sort(theArray.mValues.begin() + inRange.location,
+                     theArray.mValues.begin() + inRange.location + inRange.length,
+                     [inComparator, inContext] (const void* inA, const void* inB) {
+                         return inComparator(inA, inB, inContext) == kCFCompareLessThan;
+                     });
+}
+
+#pragma mark Dictionaries
+
+const CFDictionaryKeyCallBacks kCFTypeDictionaryKeyCallBacks = { 0 };
+const CFDictionaryKeyCallBacks kCFCopyStringDictionaryKeyCallBacks = { 0 };
+const CFDictionaryValueCallBacks kCFTypeDictionaryValueCallBacks = { 0 };
+
+CFTypeID CFDictionaryGetTypeID(void)
+{
+    return kBGM_CFDictionaryTypeID;
+}
+
+CFDictionaryRef CFDictionaryCreate(CFAllocatorRef inAllocator,
+                                   const void** inKeys,
+                                   const void** inValues,
+                                   CFIndex inNumberValues,
+                                   const CFDictionaryKeyCallBacks* inKeyCallBacks,
+                                   const CFDictionaryValueCallBacks* inValueCallBacks)
+{
+    CFMutableDictionaryRef theDictionary =
+            CFDictionaryCreateMutable(inAllocator, inNumberValues, inKeyCallBacks, inValueCallBacks);
+    
+    for(CFIndex i = 0; i < inNumberValues; i++)
+    {
+        CFDictionarySetValue(theDictionary, inKeys[i], inValues[i]);
+    }
+    
+    return theDictionary;
+}
+
+CFMutableDictionaryRef CFDictionaryCreateMutable(CFAllocatorRef inAllocator,
+                                                 CFIndex inCapacity,
+                                                 const CFDictionaryKeyCallBacks* inKeyCallBacks,
+                                                 const CFDictionaryValueCallBacks* inValueCallBacks)
+{
+    (void)inAllocator;
+    (void)inCapacity;
+    
+    BGM_CFDictionary* theDictionary =
+            new BGM_CFDictionary(inKeyCallBacks != nullptr, inValueCallBacks != nullptr);
+    
+    return reinterpret_cast<CFMutableDictionaryRef>(const_cast<void*>(ToRef(theDictionary)));
+}
+
+CFMutableDictionaryRef CFDictionaryCreateMutableCopy(CFAllocatorRef inAllocator,
+                                                     CFIndex inCapacity,
+                                                     CFDictionaryRef inDictionary)
+{
+    const BGM_CFDictionary& theSource = ToDictionary(inDictionary);
+    CFMutableDictionaryRef theCopy =
+            CFDictionaryCreateMutable(inAllocator,
+                                      inCapacity,
+                                      theSource.mRetainsKeys ? &kCFTypeDictionaryKeyCallBacks : nullptr,
+                                      theSource.mRetainsValues ? &kCFTypeDictionaryValueCallBacks : nullptr);
+    
+    for(const auto& theEntry : theSource.mEntries)
+    {
+        CFDictionarySetValue(theCopy, theEntry.first, theEntry.second);
+    }
+    
+    return theCopy;
+}
+
+CFIndex CFDictionaryGetCount(CFDictionaryRef inDictionary)
+{
+    return static_cast<CFIndex>(ToDictionary(inDictionary).mEntries.size());
+}
+
+const void* CFDictionaryGetValue(CFDictionaryRef inDictionary, const void* inKey)
+{
+    const void* theValue = nullptr;
+    CFDictionaryGetValueIfPresent(inDictionary, inKey, &theValue);
+    return theValue;
+}
+
+Boolean CFDictionaryGetValueIfPresent(CFDictionaryRef inDictionary,
+                                      const void* inKey,
+                                      const void** outValue)
+{
+    const BGM_CFDictionary& theDictionary = ToDictionary(inDictionary);
+    ssize_t theIndex = theDictionary.Find(inKey);
+    
+    if(theIndex < 0)
+    {
+        return false;
+    }
+    
+    if(outValue != nullptr)
+    {
+        *outValue = theDictionary.mEntries[static_cast<size_t>(theIndex)].second;
+    }
+    
+    return true;
+}
+
+Boolean CFDictionaryContainsKey(CFDictionaryRef inDictionary, const void* inKey)
+{
+    return ToDictionary(inDictionary).Find(inKey) >= 0;
+}
+
+void CFDictionaryGetKeysAndValues(CFDictionaryRef inDictionary,
+                                  const void** outKeys,
+                                  const void** outValues)
+{
+    const BGM_CFDictionary& theDictionary = ToDictionary(inDictionary);
+    
+    for(size_t i = 0; i < theDictionary.mEntries.size(); i++)
+    {
+        if(outKeys != nullptr)
+        {
+            outKeys[i] = theDictionary.mEntries[i].first;
+        }
+        
+        if(outValues != nullptr)
+        {
+            outValues[i] = theDictionary.mEntries[i].second;
+        }
+    }
+}
+
+void CFDictionarySetValue(CFMutableDictionaryRef ioDictionary, const void* inKey, const void* inValue)
+{
+    BGM_CFDictionary& theDictionary = ToDictionary(ioDictionary);
+    ssize_t theIndex = theDictionary.Find(inKey);
+    
+    RetainIf(theDictionary.mRetainsValues, inValue);
+    
+    if(theIndex >= 0)
+    {
+        auto& theEntry = theDictionary.mEntries[static_cast<size_t>(theIndex)];
+        ReleaseIf(theDictionary.mRetainsValues, theEntry.second);
+        theEntry.second = inValue;
+    }
+    else
+    {
+        RetainIf(theDictionary.mRetainsKeys, inKey);
+        theDictionary.mEntries.emplace_back(inKey, inValue);
+    }
+}
+
+void CFDictionaryAddValue(CFMutableDictionaryRef ioDictionary, const void* inKey, const void* inValue)
+{
+    if(!CFDictionaryContainsKey(ioDictionary, inKey))
+    {
+        CFDictionarySetValue(ioDictionary, inKey, inValue);
+    }
+}
+
+void CFDictionaryRemoveValue(CFMutableDictionaryRef ioDictionary, const void* inKey)
+{
+    BGM_CFDictionary& theDictionary = ToDictionary(ioDictionary);
+    ssize_t theIndex = theDictionary.Find(inKey);
+    
+    if(theIndex >= 0)
+    {
+        auto theEntry = theDictionary.mEntries.begin() + theIndex;
+        ReleaseIf(theDictionary.mRetainsKeys, theEntry->first);
+        ReleaseIf(theDictionary.mRetainsValues, theEntry->second);
+        theDictionary.mEntries.erase(theEntry);
+    }
+}
+
+void CFDictionaryRemoveAllValues(CFMutableDictionaryRef ioDictionary)
+{
+    BGM_CFDictionary& theDictionary = ToDictionary(ioDictionary);
+    
+    for(const auto& theEntry : theDictionary.mEntries)
+    {
+        ReleaseIf(theDictionary.mRetainsKeys, theEntry.first);
+        ReleaseIf(theDictionary.mRetainsValues, theEntry.second);
+    }
+    
+    theDictionary.mEntries.clear();
+}
+
+#pragma mark Other Types
+
+CFTypeID CFDataGetTypeID(void)
+{
+    return kBGM_CFDataTypeID;
+}
+
+CFTypeID CFURLGetTypeID(void)
+{
+    return kBGM_CFURLTypeID;
+}
+
+CFTypeID CFUUIDGetTypeID(void)
+{
+    return kBGM_CFUUIDTypeID;
+}
+
@@ -0,0 +1,249 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_PortableMach.cpp
+//  BGMDriver Portable
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  The Mach functions declared in include/mach, for building the driver's core without macOS.
+//
+
+// Local Includes
+#include "BGM_RTSafety.h"
+#include <MacTypes.h>
+#include <mach/mach.h>
+
+// STL Includes
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <new>
+
+
+#pragma mark Semaphores
+
+struct BGM_PortableSemaphore
+{
+    std::mutex              mMutex;
+    std::condition_variable mCondition;
+    int                     mCount;
+    // Incremented by semaphore_signal_all, which wakes the threads that started waiting before.
+    UInt64                  mSignalAllGeneration;
+};
+
+kern_return_t semaphore_create(task_t inTask, semaphore_t* outSemaphore, int inPolicy, int inValue)
+{
+    (void)inTask;
+    (void)inPolicy;
+    
+    if(outSemaphore == nullptr || inValue < 0)
+    {
+        return KERN_INVALID_ARGUMENT;
+    }
+    
+    BGM_PortableSemaphore* theSemaphore = new (std::nothrow) BGM_PortableSemaphore();
+    
+    if(theSemaphore == nullptr)
+    {
+        return KERN_RESOURCE_SHORTAGE;
+    }
+    
+    theSemaphore->mCount = inValue;
+    theSemaphore->mSignalAllGeneration = 0;
+    
+    *outSemaphore = theSemaphore;
+    return KERN_SUCCESS;
+}
+
+kern_return_t semaphore_destroy(task_t inTask, semaphore_t inSemaphore)
+{
+    (void)inTask;
+    
+    if(inSemaphore == SEMAPHORE_NULL)
+    {
+        return KERN_INVALID_ARGUMENT;
+    }
+    
+    delete inSemaphore;
+    return KERN_SUCCESS;
+}
+
+kern_return_t semaphore_signal(semaphore_t inSemaphore)
+{
+    if(inSemaphore == SEMAPHORE_NULL)
+    {
+        return KERN_INVALID_ARGUMENT;
+    }
+    
+    // IO operations signal semaphores to queue tasks, which is real-time safe on macOS, where
+    // semaphore_signal is a Mach trap.
+    BGMRTSafetyExempt("Only the portable semaphores lock");
+    
+    {
+        std::lock_guard<std::mutex> theLock(inSemaphore->mMutex);
+        inSemaphore->mCount++;
+    }
+    
+    inSemaphore->mCondition.notify_one();
+    return KERN_SUCCESS;
+}
+
+kern_return_t semaphore_signal_all(semaphore_t inSemaphore)
+{
+    if(inSemaphore == SEMAPHORE_NULL)
+    {
+        return KERN_INVALID_ARGUMENT;
+    }
+    
+    BGMRTSafetyExempt("Only the portable semaphores lock");
+    
+    {
+        std::lock_guard<std::mutex> theLock(inSemaphore->mMutex);
+        // Only the threads waiting now are woken, as on macOS.
+        inSemaphore->mSignalAllGeneration++;
+    }
+    
+    inSemaphore->mCondition.notify_all();
+    return KERN_SUCCESS;
+}
+
+// Waits until the semaphore is signalled or, if inTimeout isn't null, the timeout passes.
+static kern_return_t BGM_PortableSemaphoreWait(semaphore_t inSemaphore,
+                                               const std::chrono::nanoseconds* inTimeout)
+{
+    if(inSemaphore == SEMAPHORE_NULL)
+    {
+        return KERN_INVALID_ARGUMENT;
+    }
+    
+    std::unique_lock<std::mutex> theLock(inSemaphore->mMutex);
+    
+    const UInt64 theGeneration = inSemaphore->mSignalAllGeneration;
+    
+    auto isSignalled = [inSemaphore, theGeneration] {
+        return inSemaphore->mCount > 0 || inSemaphore->mSignalAllGeneration != theGeneration;
+    };
+    
+    bool wasSignalled = true;
+    
+    if(inTimeout == nullptr)
+    {
+        inSemaphore->mCondition.wait(theLock, isSignalled);
+    }
+    else
+    {
+        wasSignalled = inSemaphore->mCondition.wait_for(theLock, *inTimeout, isSignalled);
+    }
+    
+    if(!wasSignalled)
+    {
+        return KERN_OPERATION_TIMED_OUT;
+    }
+    
+    // Threads woken by semaphore_signal_all don't take a count.
+    if(inSemaphore->mSignalAllGeneration == theGeneration)
+    {
+        inSemaphore->mCount--;
+    }
+    
+    return KERN_SUCCESS;
+}
+
+kern_return_t semaphore_wait(semaphore_t inSemaphore)
+{
+    return BGM_PortableSemaphoreWait(inSemaphore, nullptr);
+}
+
+kern_return_t semaphore_timedwait(semaphore_t inSemaphore, mach_timespec_t inWaitTime)
+{
+    std::chrono::nanoseconds theTimeout =
+            std::chrono::seconds(inWaitTime.tv_sec) + std::chrono::nanoseconds(inWaitTime.tv_nsec);
+    
+    return BGM_PortableSemaphoreWait(inSemaphore, &theTimeout);
+}
+
+#pragma mark Thread Policies
+
+kern_return_t thread_policy_set(thread_act_t inThread,
+                                thread_policy_flavor_t inFlavor,
+                                thread_policy_t inPolicyInfo,
+                                mach_msg_type_number_t inCount)
+{
+    (void)inThread;
+    (void)inFlavor;
+    (void)inPolicyInfo;
+    (void)inCount;
+    
+    return KERN_SUCCESS;
+}
+
+kern_return_t thread_info(thread_act_t inThread,
+                          thread_flavor_t inFlavor,
+                          thread_info_t outInfo,
+                          mach_msg_type_number_t* ioCount)
+{
+    (void)inThread;
+    
+    switch(inFlavor)
+    {
+        case THREAD_BASIC_INFO:
+            {
+                thread_basic_info_data_t theInfo = {};
+                theInfo.policy = POLICY_TIMESHARE;
+                *reinterpret_cast<thread_basic_info_data_t*>(outInfo) = theInfo;
+                *ioCount = THREAD_BASIC_INFO_COUNT;
+            }
+            return KERN_SUCCESS;
+            
+        case THREAD_SCHED_TIMESHARE_INFO:
+            {
+                // CAPThread's kDefaultThreadPriority.
+                policy_timeshare_info_data_t theInfo = { 63, 31, 31, false, 0 };
+                *reinterpret_cast<policy_timeshare_info_data_t*>(outInfo) = theInfo;
+                *ioCount = POLICY_TIMESHARE_INFO_COUNT;
+            }
+            return KERN_SUCCESS;
+            
+        default:
+            return KERN_INVALID_ARGUMENT;
+    }
+}
+
+#pragma mark Errors
+
+char* mach_error_string(mach_error_t inError)
+{
+    switch(inError)
+    {
+        case KERN_SUCCESS:
+            return const_cast<char*>("(os/kern) successful");
+        case KERN_INVALID_ARGUMENT:
+            return const_cast<char*>("(os/kern) invalid argument");
+        case KERN_FAILURE:
+            return const_cast<char*>("(os/kern) failure");
+        case KERN_RESOURCE_SHORTAGE:
+            return const_cast<char*>("(os/kern) resource shortage");
+        case KERN_ABORTED:
+            return const_cast<char*>("(os/kern) operation aborted");
+        case KERN_OPERATION_TIMED_OUT:
+            return const_cast<char*>("(os/kern) operation timed out");
+        default:
+            return const_cast<char*>("(os/kern) unknown error code");
+    }
+}
+
@@ -0,0 +1,33 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_PortablePlugIn.cpp
+//  BGMDriver Portable
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  The parts of BGM_PlugIn the driver's core needs. BGM_PlugIn.cpp isn't built for the portable
+//  core because it creates the devices, but BGM_TaskQueue and BGM_Clients send notifications
+//  through BGM_PlugIn::Host_PropertiesChanged, which uses the host BGM_SimulatedHost installs.
+//
+
+// Self Include
+#include "BGM_PlugIn.h"
+
+
+AudioServerPlugInHostRef BGM_PlugIn::sHost = NULL;
+
@@ -0,0 +1,369 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_RTSafetyInterposers.cpp
+//  BGMDriver
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  Replaces the C library's allocation, locking and blocking IO functions with versions that
+//  report calls made in a BGMRTScope (see BGM_RTSafety.h) and then call the originals. This
+//  replaces them for the whole process, so it's only linked into bgm-rt-safety-check.
+//
+//  Requires glibc. The allocation functions call glibc's __libc_* versions. The rest look up the
+//  originals with dlsym(RTLD_NEXT). Defining malloc in an executable doesn't replace it on macOS,
+//  so there this file is empty and bgm-rt-safety-check skips its checks. Only calls through the
+//  C library's exported symbols are caught. For example, the locks glibc takes internally aren't.
+//
+
+// Local Includes
+#include "BGM_RTSafety.h"
+
+#if BGM_RTSafetyChecks && BGM_RTSafetyInterposersAvailable
+
+// STL Includes
+#include <atomic>
+
+// System Includes
+#include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <syslog.h>
+#include <time.h>
+#include <unistd.h>
+
+
+extern "C" {
+    void*   __libc_malloc(size_t inSize);
+    void*   __libc_calloc(size_t inCount, size_t inSize);
+    void*   __libc_realloc(void* inPtr, size_t inSize);
+    void*   __libc_memalign(size_t inAlignment, size_t inSize);
+    void    __libc_free(void* inPtr);
+}
+
+#define BGMCheckRT(inType, inFunction)                                      \
+    if(BGM_RTSafety::IsCheckedRT())                                         \
+    {                                                                       \
+        BGM_RTSafety::ReportViolation(inType, inFunction);                  \
+    }
+
+// Finds the function the interposer replaced the first time it's called. dlsym can allocate, so
+// the checks are off while it runs.
+static void* RealFunction(std::atomic<void*>& ioFunction, const char* inName)
+{
+    void* theFunction = ioFunction.load(std::memory_order_acquire);
+    
+    if(theFunction == nullptr)
+    {
+        BGMRTSafetyExempt("Looking up the real function");
+        theFunction = dlsym(RTLD_NEXT, inName);
+        ioFunction.store(theFunction, std::memory_order_release);
+    }
+    
+    return theFunction;
+}
+
+#define BGMRealFunction(inName)                                             \
+    static std::atomic<void*> sReal_##inName { nullptr };                   \
+    auto theReal_##inName = reinterpret_cast<decltype(&inName)>(RealFunction(sReal_##inName, #inName))
+
+#pragma mark Allocation
+
+extern "C" void* malloc(size_t inSize) noexcept
+{
+    BGMCheckRT(kBGMRTSafetyViolationAllocation, "malloc");
+    return __libc_malloc(inSize);
+}
+
+extern "C" void* calloc(size_t inCount, size_t inSize) noexcept
+{
+    BGMCheckRT(kBGMRTSafetyViolationAllocation, "calloc");
+    return __libc_calloc(inCount, inSize);
+}
+
+extern "C" void* realloc(void* inPtr, size_t inSize) noexcept
+{
+    BGMCheckRT(kBGMRTSafetyViolationAllocation, "realloc");
+    return __libc_realloc(inPtr, inSize);
+}
+
+extern "C" void* memalign(size_t inAlignment, size_t inSize) noexcept
+{
+    BGMCheckRT(kBGMRTSafetyViolationAllocation, "memalign");
+    return __libc_memalign(inAlignment, inSize);
+}
+
+extern "C" void* aligned_alloc(size_t inAlignment, size_t inSize) noexcept
+{
+    BGMCheckRT(kBGMRTSafetyViolationAllocation, "aligned_alloc");
+    return __libc_memalign(inAlignment, inSize);
+}
+
+extern "C" int posix_memalign(void** outPtr, size_t inAlignment, size_t inSize) noexcept
+{
+    BGMCheckRT(kBGMRTSafetyViolationAllocation, "posix_memalign");
+    
+    if(inAlignment == 0 ||
+       (inAlignment % sizeof(void*)) != 0 ||
+       (inAlignment & (inAlignment - 1)) != 0)
+    {
+        return EINVAL;
+    }
+    
+    void* thePtr = __libc_memalign(inAlignment, inSize);
+    
+    if(thePtr == nullptr)
+    {
+        return ENOMEM;
+    }
+    
+    *outPtr = thePtr;
+    return 0;
+}
+
+extern "C" void free(void* inPtr) noexcept
+{
+    if(inPtr != nullptr)
+    {
+        BGMCheckRT(kBGMRTSafetyViolationAllocation, "free");
+    }
+    
+    __libc_free(inPtr);
+}
+
+#pragma mark Locks
+
+extern "C" int pthread_mutex_lock(pthread_mutex_t* inMutex) noexcept
+{
+    BGMRealFunction(pthread_mutex_lock);
+    BGMCheckRT(kBGMRTSafetyViolationLock, "pthread_mutex_lock");
+    return theReal_pthread_mutex_lock(inMutex);
+}
+
+extern "C" int pthread_rwlock_rdlock(pthread_rwlock_t* inLock) noexcept
+{
+    BGMRealFunction(pthread_rwlock_rdlock);
+    BGMCheckRT(kBGMRTSafetyViolationLock, "pthread_rwlock_rdlock");
+    return theReal_pthread_rwlock_rdlock(inLock);
+}
+
+extern "C" int pthread_rwlock_wrlock(pthread_rwlock_t* inLock) noexcept
+{
+    BGMRealFunction(pthread_rwlock_wrlock);
+    BGMCheckRT(kBGMRTSafetyViolationLock, "pthread_rwlock_wrlock");
+    return theReal_pthread_rwlock_wrlock(inLock);
+}
+
+extern "C" int pthread_join(pthread_t inThread, void** outValue)
+{
+    BGMRealFunction(pthread_join);
+    BGMCheckRT(kBGMRTSafetyViolationLock, "pthread_join");
+    return theReal_pthread_join(inThread, outValue);
+}
+
+#pragma mark System Calls
+
+extern "C" int open(const char* inPath, int inFlags, ...)
+{
+    BGMRealFunction(open);
+    BGMCheckRT(kBGMRTSafetyViolationSystemCall, "open");
+    
+    mode_t theMode = 0;
+    
+    if(inFlags & O_CREAT)
+    {
+        va_list theArgs;
+        va_start(theArgs, inFlags);
+        theMode = static_cast<mode_t>(va_arg(theArgs, int));
+        va_end(theArgs);
+    }
+    
+    return theReal_open(inPath, inFlags, theMode);
+}
+
+extern "C" ssize_t read(int inFile, void* outBuffer, size_t inBytes)
+{
+    BGMRealFunction(read);
+    BGMCheckRT(kBGMRTSafetyViolationSystemCall, "read");
+    return theReal_read(inFile, outBuffer, inBytes);
+}
+
+extern "C" ssize_t write(int inFile, const void* inBuffer, size_t inBytes)
+{
+    BGMRealFunction(write);
+    BGMCheckRT(kBGMRTSafetyViolationSystemCall, "write");
+    return theReal_write(inFile, inBuffer, inBytes);
+}
+
+extern "C" int close(int inFile)
+{
+    BGMRealFunction(close);
+    BGMCheckRT(kBGMRTSafetyViolationSystemCall, "close");
+    return theReal_close(inFile);
+}
+
+extern "C" int fsync(int inFile)
+{
+    BGMRealFunction(fsync);
+    BGMCheckRT(kBGMRTSafetyViolationSystemCall, "fsync");
+    return theReal_fsync(inFile);
+}
+
+extern "C" void* mmap(void* inAddress, size_t inLength, int inProtection, int inFlags, int inFile, off_t inOffset) noexcept
+{
+    BGMRealFunction(mmap);
+    BGMCheckRT(kBGMRTSafetyViolationSystemCall, "mmap");
+    return theReal_mmap(inAddress, inLength, inProtection, inFlags, inFile, inOffset);
+}
+
+extern "C" int munmap(void* inAddress, size_t inLength) noexcept
+{
+    BGMRealFunction(munmap);
+    BGMCheckRT(kBGMRTSafetyViolationSystemCall, "munmap");
+    return theReal_munmap(inAddress, inLength);
+}
+
+extern "C" int usleep(useconds_t inMicroseconds)
+{
+    BGMRealFunction(usleep);
+    BGMCheckRT(kBGMRTSafetyViolationSystemCall, "usleep");
+    return theReal_usleep(inMicroseconds);
+}
+
+extern "C" int nanosleep(const struct timespec* inDuration, struct timespec* outRemaining)
+{
+    BGMRealFunction(nanosleep);
+    BGMCheckRT(kBGMRTSafetyViolationSystemCall, "nanosleep");
+    return theReal_nanosleep(inDuration, outRemaining);
+}
+
+extern "C" int clock_nanosleep(clockid_t inClock,
+                               int inFlags,
+                               const struct timespec* inTime,
+                               struct timespec* outRemaining)
+{
+    BGMRealFunction(clock_nanosleep);
+    BGMCheckRT(kBGMRTSafetyViolationSystemCall, "clock_nanosleep");
+    return theReal_clock_nanosleep(inClock, inFlags, inTime, outRemaining);
+}
+
+extern "C" int pthread_create(pthread_t* outThread,
+                              const pthread_attr_t* inAttributes,
+                              void* (*inStartRoutine)(void*),
+                              void* inArg) noexcept
+{
+    BGMRealFunction(pthread_create);
+    BGMCheckRT(kBGMRTSafetyViolationSystemCall, "pthread_create");
+    return theReal_pthread_create(outThread, inAttributes, inStartRoutine, inArg);
+}
+
+#pragma mark Printing
+
+// DebugMsg, LogWarning, etc. print with these. (The compiler turns some printf calls into puts.)
+
+extern "C" int vfprintf(FILE* inStream, const char* inFormat, va_list inArgs)
+{
+    BGMRealFunction(vfprintf);
+    BGMCheckRT(kBGMRTSafetyViolationSystemCall, "vfprintf");
+    return theReal_vfprintf(inStream, inFormat, inArgs);
+}
+
+extern "C" int fprintf(FILE* inStream, const char* inFormat, ...)
+{
+    BGMRealFunction(vfprintf);
+    BGMCheckRT(kBGMRTSafetyViolationSystemCall, "fprintf");
+    
+    va_list theArgs;
+    va_start(theArgs, inFormat);
+    int theResult = theReal_vfprintf(inStream, inFormat, theArgs);
+    va_end(theArgs);
+    
+    return theResult;
+}
+
+extern "C" int vprintf(const char* inFormat, va_list inArgs)
+{
+    BGMRealFunction(vprintf);
+    BGMCheckRT(kBGMRTSafetyViolationSystemCall, "vprintf");
+    return theReal_vprintf(inFormat, inArgs);
+}
+
+extern "C" int printf(const char* inFormat, ...)
+{
+    BGMRealFunction(vprintf);
+    BGMCheckRT(kBGMRTSafetyViolationSystemCall, "printf");
+    
+    va_list theArgs;
+    va_start(theArgs, inFormat);
+    int theResult = theReal_vprintf(inFormat, theArgs);
+    va_end(theArgs);
+    
+    return theResult;
+}
+
+extern "C" int puts(const char* inString)
+{
+    BGMRealFunction(puts);
+    BGMCheckRT(kBGMRTSafetyViolationSystemCall, "puts");
+    return theReal_puts(inString);
+}
+
+extern "C" int fputs(const char* inString, FILE* inStream)
+{
+    BGMRealFunction(fputs);
+    BGMCheckRT(kBGMRTSafetyViolationSystemCall, "fputs");
+    return theReal_fputs(inString, inStream);
+}
+
+extern "C" size_t fwrite(const void* inBuffer, size_t inSize, size_t inCount, FILE* inStream)
+{
+    BGMRealFunction(fwrite);
+    BGMCheckRT(kBGMRTSafetyViolationSystemCall, "fwrite");
+    return theReal_fwrite(inBuffer, inSize, inCount, inStream);
+}
+
+extern "C" int fflush(FILE* inStream)
+{
+    BGMRealFunction(fflush);
+    BGMCheckRT(kBGMRTSafetyViolationSystemCall, "fflush");
+    return theReal_fflush(inStream);
+}
+
+extern "C" void vsyslog(int inPriority, const char* inFormat, va_list inArgs)
+{
+    BGMRealFunction(vsyslog);
+    BGMCheckRT(kBGMRTSafetyViolationSystemCall, "vsyslog");
+    theReal_vsyslog(inPriority, inFormat, inArgs);
+}
+
+extern "C" void syslog(int inPriority, const char* inFormat, ...)
+{
+    BGMRealFunction(vsyslog);
+    BGMCheckRT(kBGMRTSafetyViolationSystemCall, "syslog");
+    
+    va_list theArgs;
+    va_start(theArgs, inFormat);
+    theReal_vsyslog(inPriority, inFormat, theArgs);
+    va_end(theArgs);
+}
+
+#endif /* BGM_RTSafetyChecks && BGM_RTSafetyInterposersAvailable */
@@ -0,0 +1,548 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_SimulatedHost.cpp
+//  BGMDriver Portable
+//
+//  Copyright © 2026 Background Music contributors
+//
+
+// Self Include
+#include "BGM_SimulatedHost.h"
+
+// Local Includes
+#include "BGM_DSPContext.h"
+#include "BGM_PlugIn.h"
+#include "BGM_RTSafety.h"
+#include "BGM_Types.h"
+
+// PublicUtility Includes
+#include "CAException.h"
+#include "CAHostTimeBase.h"
+
+// STL Includes
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+// System Includes
+#include <CoreFoundation/CoreFoundation.h>
+
+
+#pragma clang assume_nonnull begin
+
+BGM_SimulatedHost::BGM_SimulatedHost(Float64 inSampleRate, UInt32 inIOBufferFrameSize)
+:
+    mSampleRate(inSampleRate),
+    mIOBufferFrameSize(inIOBufferFrameSize),
+    mHostInterface(),
+    mTaskQueue(),
+    mClients(kObjectID_Device),
+    mIOMutex("BGM_SimulatedHost IO"),
+    mIOPipeline(mClients, mIOMutex),
+    mIOTraceRecorder(),
+    mMix(inIOBufferFrameSize * 2, 0.0f),
+    mSampleTime(0.0),
+    mStartHostTime(CAHostTimeBase::GetTheCurrentTime()),
+    mHostTicksPerFrame(CAHostTimeBase::GetFrequency() / inSampleRate),
+    mUsesSimulatedTime(false),
+    mCycleHostTime(mStartHostTime),
+    mCycleStartRealHostTime(mStartHostTime),
+    mCycles(0),
+    mTotalCycleNanos(0),
+    mMaxCycleNanos(0),
+    mOverloadedCycles(0)
+{
+    ThrowIf(inIOBufferFrameSize == 0 || inIOBufferFrameSize > kLoopbackRingBufferFrameSize,
+            CAException(kAudioHardwareIllegalOperationError),
+            "BGM_SimulatedHost::BGM_SimulatedHost: Invalid IO buffer size");
+    
+    mHostInterface.mInterface.PropertiesChanged = &BGM_SimulatedHost::Host_PropertiesChanged;
+    mHostInterface.mInterface.CopyFromStorage = &BGM_SimulatedHost::Host_CopyFromStorage;
+    mHostInterface.mInterface.WriteToStorage = &BGM_SimulatedHost::Host_WriteToStorage;
+    mHostInterface.mInterface.DeleteFromStorage = &BGM_SimulatedHost::Host_DeleteFromStorage;
+    mHostInterface.mInterface.RequestDeviceConfigurationChange =
+            &BGM_SimulatedHost::Host_RequestDeviceConfigurationChange;
+    mHostInterface.mHost = this;
+    
+    BGM_PlugIn::SetHost(&mHostInterface.mInterface);
+    
+    mClients.SetSampleRate(inSampleRate);
+    mIOPipeline.SetSampleRate(inSampleRate);
+    mIOPipeline.AllocateLoopback();
+    mIOPipeline.GetDSPBudget().SetClock(&BGM_SimulatedHost::GetCycleClockTime, this);
+}
+
+BGM_SimulatedHost::~BGM_SimulatedHost()
+{
+    // Stop IO and remove the clients before the task queue is destroyed, so it doesn't send
+    // notifications to a host that no longer exists.
+    for(auto& theClient : mSimulatedClients)
+    {
+        if(theClient.second.mDoingIO)
+        {
+            mTaskQueue.QueueSync_StopClientIO(&mClients, theClient.first);
+        }
+        
+        mClients.RemoveClient(theClient.first);
+    }
+    
+    BGM_PlugIn::SetHost(nullptr);
+}
+
+#pragma mark Clients
+
+void    BGM_SimulatedHost::AddClient(UInt32 inClientID,
+                                     pid_t inProcessID,
+                                     const char* _Nullable inBundleID,
+                                     BGM_OutputGenerator inGenerator)
+{
+    ThrowIf(mSimulatedClients.count(inClientID) != 0,
+            BGM_InvalidClientException(),
+            "BGM_SimulatedHost::AddClient: Client already added");
+    
+    AudioServerPlugInClientInfo theClientInfo;
+    theClientInfo.mClientID = inClientID;
+    theClientInfo.mProcessID = inProcessID;
+    theClientInfo.mIsNativeEndian = true;
+    theClientInfo.mBundleID = (inBundleID == nullptr) ?
+            nullptr :
+            CFStringCreateWithCString(kCFAllocatorDefault, inBundleID, kCFStringEncodingUTF8);
+    
+    mClients.AddClient(&theClientInfo);
+    mIOTraceRecorder.RecordClientAdded(inClientID, inProcessID, theClientInfo.mBundleID);
+    
+    if(theClientInfo.mBundleID != nullptr)
+    {
+        CFRelease(theClientInfo.mBundleID);
+    }
+    
+    BGM_SimulatedClient& theClient = mSimulatedClients[inClientID];
+    theClient.mGenerator = inGenerator;
+    theClient.mInput.assign(mIOBufferFrameSize * 2, 0.0f);
+    theClient.mOutput.assign(mIOBufferFrameSize * 2, 0.0f);
+}
+
+void    BGM_SimulatedHost::RemoveClient(UInt32 inClientID)
+{
+    auto theClient = mSimulatedClients.find(inClientID);
+    
+    ThrowIf(theClient == mSimulatedClients.end(),
+            BGM_InvalidClientException(),
+            "BGM_SimulatedHost::RemoveClient: Client not found");
+    
+    if(theClient->second.mDoingIO)
+    {
+        StopIO(inClientID);
+    }
+    
+    mClients.RemoveClient(inClientID);
+    mIOTraceRecorder.RecordClientRemoved(inClientID);
+    mSimulatedClients.erase(theClient);
+}
+
+void    BGM_SimulatedHost::StartIO(UInt32 inClientID)
+{
+    auto theClient = mSimulatedClients.find(inClientID);
+    
+    ThrowIf(theClient == mSimulatedClients.end(),
+            BGM_InvalidClientException(),
+            "BGM_SimulatedHost::StartIO: Client not found");
+    
+    bool didStartIO = mTaskQueue.QueueSync_StartClientIO(&mClients, inClientID);
+    
+    // BGM_Device resets the audible state and the offloaded DSP when the first client starts IO.
+    if(didStartIO)
+    {
+        mIOPipeline.ResetAudibleState();
+        mIOPipeline.ResetDSPOffload();
+    }
+    
+    // Then the HAL starts the client's IO thread, which begins the
+    // kAudioServerPlugInIOOperationThread operation. BGM_Device updates the client's IO state
+    // again then, since the HAL only calls StartIO for the first client.
+    {
+        BGMRTScope("BGM_SimulatedHost::StartIO");
+        
+        AudioServerPlugInIOCycleInfo theCycleInfo = MakeCycleInfo();
+        mIOTraceRecorder.RecordOperationRT(kBGMIOTraceRecordBeginOperation,
+                                           inClientID,
+                                           kAudioServerPlugInIOOperationThread,
+                                           mIOBufferFrameSize,
+                                           theCycleInfo,
+                                           nullptr);
+        mTaskQueue.QueueAsync_StartClientIO(&mClients, inClientID);
+    }
+    
+    theClient->second.mDoingIO = true;
+}
+
+void    BGM_SimulatedHost::StopIO(UInt32 inClientID)
+{
+    auto theClient = mSimulatedClients.find(inClientID);
+    
+    ThrowIf(theClient == mSimulatedClients.end(),
+            BGM_InvalidClientException(),
+            "BGM_SimulatedHost::StopIO: Client not found");
+    
+    // The IO thread ends the kAudioServerPlugInIOOperationThread operation before the HAL calls
+    // StopIO.
+    {
+        BGMRTScope("BGM_SimulatedHost::StopIO");
+        
+        AudioServerPlugInIOCycleInfo theCycleInfo = MakeCycleInfo();
+        mIOTraceRecorder.RecordOperationRT(kBGMIOTraceRecordEndOperation,
+                                           inClientID,
+                                           kAudioServerPlugInIOOperationThread,
+                                           mIOBufferFrameSize,
+                                           theCycleInfo,
+                                           nullptr);
+        mTaskQueue.QueueAsync_StopClientIO(&mClients, inClientID);
+    }
+    mTaskQueue.QueueSync_StopClientIO(&mClients, inClientID);
+    
+    theClient->second.mDoingIO = false;
+}
+
+const std::vector<Float32>& BGM_SimulatedHost::GetClientInput(UInt32 inClientID) const
+{
+    auto theClient = mSimulatedClients.find(inClientID);
+    
+    ThrowIf(theClient == mSimulatedClients.end(),
+            BGM_InvalidClientException(),
+            "BGM_SimulatedHost::GetClientInput: Client not found");
+    
+    return theClient->second.mInput;
+}
+
+const std::vector<Float32>& BGM_SimulatedHost::GetClientOutput(UInt32 inClientID) const
+{
+    auto theClient = mSimulatedClients.find(inClientID);
+    
+    ThrowIf(theClient == mSimulatedClients.end(),
+            BGM_InvalidClientException(),
+            "BGM_SimulatedHost::GetClientOutput: Client not found");
+    
+    return theClient->second.mOutput;
+}
+
+#pragma mark IO
+
+void    BGM_SimulatedHost::RunCycle()
+{
+    auto theStartTime = std::chrono::steady_clock::now();
+    
+    AudioServerPlugInIOCycleInfo theCycleInfo = MakeCycleInfo();
+    StartCycleClock(theCycleInfo.mInputTime.mHostTime);
+    
+    std::fill(mMix.begin(), mMix.end(), 0.0f);
+    
+    {
+        // BGM_Device creates one for each IO operation.
+        BGM_DSPContext theDSPContext;
+        
+        for(auto& theClientEntry : mSimulatedClients)
+        {
+            const UInt32 theClientID = theClientEntry.first;
+            BGM_SimulatedClient& theClient = theClientEntry.second;
+            
+            if(!theClient.mDoingIO)
+            {
+                continue;
+            }
+            
+            {
+                // The IO operations are checked for RT safety like BGM_Device's, but the
+                // generators aren't.
+                BGMRTScope("BGM_SimulatedHost::RunCycle ReadInput");
+                
+                mIOPipeline.ReadInputRT(theClientID,
+                                        mIOBufferFrameSize,
+                                        theCycleInfo.mInputTime.mSampleTime,
+                                        theCycleInfo.mOutputTime,
+                                        theClient.mInput.data());
+                mIOTraceRecorder.RecordOperationRT(kBGMIOTraceRecordDoOperation,
+                                                   theClientID,
+                                                   kAudioServerPlugInIOOperationReadInput,
+                                                   mIOBufferFrameSize,
+                                                   theCycleInfo,
+                                                   theClient.mInput.data());
+            }
+            
+            if(theClient.mGenerator)
+            {
+                theClient.mGenerator(mIOBufferFrameSize, mSampleTime, theClient.mOutput.data());
+            }
+            else
+            {
+                std::fill(theClient.mOutput.begin(), theClient.mOutput.end(), 0.0f);
+            }
+            
+            {
+                BGMRTScope("BGM_SimulatedHost::RunCycle ProcessOutput");
+                
+                mIOTraceRecorder.RecordOperationRT(kBGMIOTraceRecordDoOperation,
+                                                   theClientID,
+                                                   kAudioServerPlugInIOOperationProcessOutput,
+                                                   mIOBufferFrameSize,
+                                                   theCycleInfo,
+                                                   theClient.mOutput.data());
+                mIOPipeline.ProcessOutputRT(theClientID,
+                                            mIOBufferFrameSize,
+                                            theCycleInfo.mOutputTime,
+                                            theClient.mOutput.data());
+                mIOTraceRecorder.RecordOperationRT(kBGMIOTraceRecordOperationResult,
+                                                   theClientID,
+                                                   kAudioServerPlugInIOOperationProcessOutput,
+                                                   mIOBufferFrameSize,
+                                                   theCycleInfo,
+                                                   theClient.mOutput.data());
+                
+                // The HAL mixes the clients' processed output before WriteMix.
+                for(size_t i = 0; i < mMix.size(); i++)
+                {
+                    mMix[i] += theClient.mOutput[i];
+                }
+            }
+        }
+        
+        BGMRTScope("BGM_SimulatedHost::RunCycle WriteMix");
+        
+        mIOTraceRecorder.RecordOperationRT(kBGMIOTraceRecordDoOperation,
+                                           0,
+                                           kAudioServerPlugInIOOperationWriteMix,
+                                           mIOBufferFrameSize,
+                                           theCycleInfo,
+                                           mMix.data());
+        
+        bool didChangeState = mIOPipeline.WriteMixRT(mIOBufferFrameSize, mSampleTime, mMix.data());
+        
+        if(didChangeState)
+        {
+            mTaskQueue.QueueAsync_SendPropertyNotification(kAudioDeviceCustomPropertyDeviceAudibleState,
+                                                           kObjectID_Device);
+        }
+        
+        // Like BGM_Device::DoIOOperation.
+        mIOPipeline.GetGlitchTelemetry().RecordOffsetRT(theCycleInfo.mOutputTime.mSampleTime -
+                                                        theCycleInfo.mInputTime.mSampleTime);
+    }
+    
+    UInt64 theCycleNanos = static_cast<UInt64>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+                                                                 theStartTime).count());
+    
+    mCycles++;
+    mTotalCycleNanos += theCycleNanos;
+    mMaxCycleNanos = std::max(mMaxCycleNanos, theCycleNanos);
+    
+    if(theCycleNanos > static_cast<UInt64>(mIOBufferFrameSize / mSampleRate * NSEC_PER_SEC))
+    {
+        mOverloadedCycles++;
+        // BGM_Device compares the time to the cycle's output host time instead.
+        mIOPipeline.GetGlitchTelemetry().CountRT(kBGMGlitchLateCycle);
+    }
+    
+    mSampleTime += mIOBufferFrameSize;
+}
+
+AudioServerPlugInIOCycleInfo BGM_SimulatedHost::MakeCycleInfo() const
+{
+    // The input is one buffer behind the output, so each client reads the mix from the previous
+    // cycle.
+    AudioServerPlugInIOCycleInfo theCycleInfo = {};
+    theCycleInfo.mIOCycleCounter = mCycles;
+    theCycleInfo.mNominalIOBufferFrameSize = mIOBufferFrameSize;
+    theCycleInfo.mInputTime.mSampleTime = mSampleTime - mIOBufferFrameSize;
+    theCycleInfo.mInputTime.mHostTime = GetHostTime(theCycleInfo.mInputTime.mSampleTime);
+    theCycleInfo.mInputTime.mFlags = kAudioTimeStampSampleHostTimeValid;
+    theCycleInfo.mOutputTime.mSampleTime = mSampleTime;
+    theCycleInfo.mOutputTime.mHostTime = GetHostTime(mSampleTime);
+    theCycleInfo.mOutputTime.mFlags = kAudioTimeStampSampleHostTimeValid;
+    
+    return theCycleInfo;
+}
+
+UInt64  BGM_SimulatedHost::GetHostTime(Float64 inSampleTime) const
+{
+    return static_cast<UInt64>(static_cast<SInt64>(mStartHostTime) +
+                               std::llround(inSampleTime * mHostTicksPerFrame));
+}
+
+void    BGM_SimulatedHost::SetUsesSimulatedTime(bool inUsesSimulatedTime)
+{
+    mUsesSimulatedTime = inUsesSimulatedTime;
+}
+
+void    BGM_SimulatedHost::AdvanceSimulatedTime(Float64 inFrames)
+{
+    mCycleHostTime += static_cast<UInt64>(std::llround(inFrames * mHostTicksPerFrame));
+}
+
+void    BGM_SimulatedHost::StartCycleClock(UInt64 inHostTime)
+{
+    mCycleHostTime = inHostTime;
+    mCycleStartRealHostTime = CAHostTimeBase::GetTheCurrentTime();
+}
+
+// static
+UInt64  BGM_SimulatedHost::GetCycleClockTime(void* _Nullable inRefCon)
+{
+    const BGM_SimulatedHost* theHost = static_cast<const BGM_SimulatedHost*>(inRefCon);
+    
+    if(theHost->mUsesSimulatedTime)
+    {
+        return theHost->mCycleHostTime;
+    }
+    
+    return theHost->mCycleHostTime +
+            (CAHostTimeBase::GetTheCurrentTime() - theHost->mCycleStartRealHostTime);
+}
+
+void    BGM_SimulatedHost::Run(UInt32 inCycles, bool inRealTime)
+{
+    const auto theCycleDuration =
+            std::chrono::nanoseconds(static_cast<SInt64>(mIOBufferFrameSize / mSampleRate * NSEC_PER_SEC));
+    auto theDeadline = std::chrono::steady_clock::now();
+    
+    for(UInt32 i = 0; i < inCycles; i++)
+    {
+        RunCycle();
+        
+        if(inRealTime)
+        {
+            theDeadline += theCycleDuration;
+            std::this_thread::sleep_until(theDeadline);
+        }
+    }
+}
+
+BGM_SimulatedHost::BGM_CycleStats BGM_SimulatedHost::GetCycleStats() const
+{
+    BGM_CycleStats theStats;
+    theStats.mCycles = mCycles;
+    theStats.mMeanCycleNanos = (mCycles == 0) ? 0.0 : static_cast<Float64>(mTotalCycleNanos) / mCycles;
+    theStats.mMaxCycleNanos = mMaxCycleNanos;
+    theStats.mOverloadedCycles = mOverloadedCycles;
+    
+    return theStats;
+}
+
+#pragma mark Notifications
+
+UInt64  BGM_SimulatedHost::GetNotificationCount(AudioObjectPropertySelector inSelector) const
+{
+    std::lock_guard<std::mutex> theLock(mNotificationsMutex);
+    
+    auto theCount = mNotificationCounts.find(inSelector);
+    return (theCount == mNotificationCounts.end()) ? 0 : theCount->second;
+}
+
+bool    BGM_SimulatedHost::WaitForNotificationCount(AudioObjectPropertySelector inSelector,
+                                                    UInt64 inCount,
+                                                    UInt32 inTimeoutMS) const
+{
+    std::unique_lock<std::mutex> theLock(mNotificationsMutex);
+    
+    return mNotificationsChanged.wait_for(theLock,
+                                          std::chrono::milliseconds(inTimeoutMS),
+                                          [&] {
+                                              auto theCount = mNotificationCounts.find(inSelector);
+                                              return theCount != mNotificationCounts.end() &&
+                                                     theCount->second >= inCount;
+                                          });
+}
+
+#pragma mark Host Interface
+
+// static
+OSStatus    BGM_SimulatedHost::Host_PropertiesChanged(AudioServerPlugInHostRef inHost,
+                                                      AudioObjectID inObjectID,
+                                                      UInt32 inNumberAddresses,
+                                                      const AudioObjectPropertyAddress* inAddresses)
+{
+    (void)inObjectID;
+    
+    BGM_SimulatedHost* theHost = reinterpret_cast<const BGM_HostInterface*>(inHost)->mHost;
+    
+    {
+        std::lock_guard<std::mutex> theLock(theHost->mNotificationsMutex);
+        
+        for(UInt32 i = 0; i < inNumberAddresses; i++)
+        {
+            theHost->mNotificationCounts[inAddresses[i].mSelector]++;
+        }
+    }
+    
+    theHost->mNotificationsChanged.notify_all();
+    
+    return kAudioHardwareNoError;
+}
+
+// The simulated host has no persistent storage.
+
+// static
+OSStatus    BGM_SimulatedHost::Host_CopyFromStorage(AudioServerPlugInHostRef inHost,
+                                                    CFStringRef inKey,
+                                                    CFPropertyListRef _Nullable * _Nonnull outData)
+{
+    (void)inHost;
+    (void)inKey;
+    
+    *outData = nullptr;
+    return kAudioHardwareUnspecifiedError;
+}
+
+// static
+OSStatus    BGM_SimulatedHost::Host_WriteToStorage(AudioServerPlugInHostRef inHost,
+                                                   CFStringRef inKey,
+                                                   CFPropertyListRef inData)
+{
+    (void)inHost;
+    (void)inKey;
+    (void)inData;
+    return kAudioHardwareUnspecifiedError;
+}
+
+// static
+OSStatus    BGM_SimulatedHost::Host_DeleteFromStorage(AudioServerPlugInHostRef inHost,
+                                                      CFStringRef inKey)
+{
+    (void)inHost;
+    (void)inKey;
+    return kAudioHardwareUnspecifiedError;
+}
+
+// static
+OSStatus    BGM_SimulatedHost::Host_RequestDeviceConfigurationChange(AudioServerPlugInHostRef inHost,
+                                                                     AudioObjectID inDeviceObjectID,
+                                                                     UInt64 inChangeAction,
+                                                                     void* _Nullable inChangeInfo)
+{
+    (void)inHost;
+    (void)inDeviceObjectID;
+    (void)inChangeAction;
+    (void)inChangeInfo;
+    
+    // Config changes are requested when the sample rate changes, which the simulated host doesn't
+    // support.
+    return kAudioHardwareUnsupportedOperationError;
+}
+
+#pragma clang assume_nonnull end
+
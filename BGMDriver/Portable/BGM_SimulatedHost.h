@@ -0,0 +1,245 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_SimulatedHost.h
+//  BGMDriver Portable
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  Stands in for the HAL so the driver's core (BGM_Clients, BGM_TaskQueue and the IO operations
+//  in BGM_IOPipeline) can be run without coreaudiod, e.g. on Linux.
+//
+//  Each IO cycle is run the way the HAL runs one for BGM_Device: for each client doing IO, read its
+//  input and process its output, then mix the clients' outputs and write the mix. The clients'
+//  output comes from generator functions. Cycles can be run in real time, sleeping until each cycle's deadline like the HAL's
+//  IO thread, or back to back to simulate hours of IO in seconds.
+//
+//  The host also implements AudioServerPlugInHostInterface and installs itself with
+//  BGM_PlugIn::SetHost, so it records the property notifications the core sends. Only one
+//  BGM_SimulatedHost should exist at a time.
+//
+
+#ifndef BGMDriver_Portable__BGM_SimulatedHost
+#define BGMDriver_Portable__BGM_SimulatedHost
+
+// Local Includes
+#include "BGM_Clients.h"
+#include "BGM_IOPipeline.h"
+#include "BGM_IOTrace.h"
+#include "BGM_TaskQueue.h"
+
+// PublicUtility Includes
+#include "CAMutex.h"
+
+// STL Includes
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <vector>
+
+// System Includes
+#include <CoreAudio/AudioServerPlugIn.h>
+#include <sys/types.h>
+
+
+#pragma clang assume_nonnull begin
+
+class BGM_SimulatedHost
+{
+
+public:
+    // Writes a client's output for an IO cycle to outBuffer, which is interleaved stereo.
+    typedef std::function<void(UInt32 inIOBufferFrameSize,
+                               Float64 inSampleTime,
+                               Float32* outBuffer)>   BGM_OutputGenerator;
+    
+    struct BGM_CycleStats
+    {
+        UInt64                  mCycles;
+        // The time spent processing, not including the time spent waiting for deadlines.
+        Float64                 mMeanCycleNanos;
+        UInt64                  mMaxCycleNanos;
+        // Cycles that took longer than a buffer's worth of audio.
+        UInt64                  mOverloadedCycles;
+    };
+
+                                BGM_SimulatedHost(Float64 inSampleRate = 44100.0,
+                                                  UInt32 inIOBufferFrameSize = 512);
+                                ~BGM_SimulatedHost();
+                                BGM_SimulatedHost(const BGM_SimulatedHost&) = delete;
+                                BGM_SimulatedHost& operator=(const BGM_SimulatedHost&) = delete;
+
+#pragma mark Clients
+
+    /*! Add a client, like the HAL does when a process opens the device. */
+    void                        AddClient(UInt32 inClientID,
+                                          pid_t inProcessID,
+                                          const char* _Nullable inBundleID,
+                                          BGM_OutputGenerator inGenerator);
+    void                        RemoveClient(UInt32 inClientID);
+
+    /*!
+     The HAL's StartIO/StopIO. Clients only take part in IO cycles between them. StartIO and StopIO
+     wait for BGM_TaskQueue to update the client, like BGM_Device's do.
+     */
+    void                        StartIO(UInt32 inClientID);
+    void                        StopIO(UInt32 inClientID);
+
+    BGM_Clients&                GetClients() { return mClients; }
+    BGM_IOPipeline&             GetIOPipeline() { return mIOPipeline; }
+    /*! Records the IO operations the host performs, like BGM_Device's does. */
+    BGM_IOTraceRecorder&        GetIOTraceRecorder() { return mIOTraceRecorder; }
+
+#pragma mark IO
+
+    /*! Run one IO cycle. Not real-time safe, since the generators may not be. */
+    void                        RunCycle();
+    
+    /*! Run inCycles IO cycles, sleeping until each one's deadline if inRealTime is true. */
+    void                        Run(UInt32 inCycles, bool inRealTime);
+
+    UInt32                      GetIOBufferFrameSize() const { return mIOBufferFrameSize; }
+    Float64                     GetSampleRate() const { return mSampleRate; }
+    /*! The output sample time of the next cycle. */
+    Float64                     GetSampleTime() const { return mSampleTime; }
+    /*!
+     The host time the cycles' timestamps give for a sample time. Sample time 0 is at the host time
+     the host was created, so the timestamps don't depend on how long the cycles take to run.
+     */
+    UInt64                      GetHostTime(Float64 inSampleTime) const;
+    
+    /*!
+     Time the IO cycles' budgets (see BGM_DSPBudget) in simulated time instead of real time, so the
+     processing they shed doesn't depend on how fast the machine is or what else it's running. The
+     simulated time only moves when AdvanceSimulatedTime is called, e.g. by a generator simulating
+     slow processing. Off by default.
+
+     Either way, the budget's clock reads the cycle's timeline, which the cycles' timestamps are
+     in: each cycle starts at the host time of its first input frame, which is its deadline minus
+     one buffer, so the budget measures how long the cycle itself takes rather than how far the
+     host has got ahead of real time.
+     */
+    void                        SetUsesSimulatedTime(bool inUsesSimulatedTime);
+    /*! Move the simulated time forward by inFrames frames at the sample rate. */
+    void                        AdvanceSimulatedTime(Float64 inFrames);
+    /*!
+     Start the budget's clock for a cycle that isn't run by RunCycle, e.g. one replayed from an IO
+     trace, at inHostTime in the cycle's timeline.
+     */
+    void                        StartCycleClock(UInt64 inHostTime);
+    BGM_CycleStats              GetCycleStats() const;
+
+    /*! The mix the last cycle wrote. Interleaved stereo. */
+    const std::vector<Float32>& GetMix() const { return mMix; }
+    /*! The audio the client read in the last cycle, or an empty buffer if it didn't do IO. */
+    const std::vector<Float32>& GetClientInput(UInt32 inClientID) const;
+    /*! The client's output from the last cycle after BGM_IOPipeline processed it. */
+    const std::vector<Float32>& GetClientOutput(UInt32 inClientID) const;
+
+#pragma mark Notifications
+
+    /*! The number of notifications the core has sent for the property. */
+    UInt64                      GetNotificationCount(AudioObjectPropertySelector inSelector) const;
+    
+    /*!
+     Wait until the core has sent at least inCount notifications for the property. Notifications
+     sent from BGM_TaskQueue are asynchronous.
+     
+     @return False if it timed out.
+     */
+    bool                        WaitForNotificationCount(AudioObjectPropertySelector inSelector,
+                                                         UInt64 inCount,
+                                                         UInt32 inTimeoutMS) const;
+
+private:
+    /*! The timestamps of the next cycle. */
+    AudioServerPlugInIOCycleInfo MakeCycleInfo() const;
+    
+    /*! The BGM_DSPBudget::Clock that reads the cycle's timeline. */
+    static UInt64               GetCycleClockTime(void* _Nullable inRefCon);
+    
+    struct BGM_SimulatedClient
+    {
+        BGM_OutputGenerator     mGenerator;
+        bool                    mDoingIO = false;
+        std::vector<Float32>    mInput;
+        std::vector<Float32>    mOutput;
+    };
+    
+    // AudioServerPlugInHostInterface with a pointer back to the host, so the callbacks can find it.
+    struct BGM_HostInterface
+    {
+        AudioServerPlugInHostInterface  mInterface;
+        BGM_SimulatedHost*              mHost;
+    };
+    
+    static OSStatus             Host_PropertiesChanged(AudioServerPlugInHostRef inHost,
+                                                       AudioObjectID inObjectID,
+                                                       UInt32 inNumberAddresses,
+                                                       const AudioObjectPropertyAddress* inAddresses);
+    static OSStatus             Host_CopyFromStorage(AudioServerPlugInHostRef inHost,
+                                                     CFStringRef inKey,
+                                                     CFPropertyListRef _Nullable * _Nonnull outData);
+    static OSStatus             Host_WriteToStorage(AudioServerPlugInHostRef inHost,
+                                                    CFStringRef inKey,
+                                                    CFPropertyListRef inData);
+    static OSStatus             Host_DeleteFromStorage(AudioServerPlugInHostRef inHost,
+                                                       CFStringRef inKey);
+    static OSStatus             Host_RequestDeviceConfigurationChange(AudioServerPlugInHostRef inHost,
+                                                                      AudioObjectID inDeviceObjectID,
+                                                                      UInt64 inChangeAction,
+                                                                      void* _Nullable inChangeInfo);
+
+private:
+    const Float64               mSampleRate;
+    const UInt32                mIOBufferFrameSize;
+    
+    BGM_HostInterface           mHostInterface;
+    
+    BGM_TaskQueue               mTaskQueue;
+    BGM_Clients                 mClients;
+    CAMutex                     mIOMutex;
+    BGM_IOPipeline              mIOPipeline;
+    BGM_IOTraceRecorder         mIOTraceRecorder;
+    
+    std::map<UInt32, BGM_SimulatedClient> mSimulatedClients;
+    std::vector<Float32>        mMix;
+    Float64                     mSampleTime;
+    const UInt64                mStartHostTime;
+    const Float64               mHostTicksPerFrame;
+    // The time the current cycle started in its timeline and the real host time it started at, for
+    // the DSP budget's clock. If the host uses simulated time, mCycleHostTime is the current time.
+    bool                        mUsesSimulatedTime;
+    UInt64                      mCycleHostTime;
+    UInt64                      mCycleStartRealHostTime;
+    
+    UInt64                      mCycles;
+    UInt64                      mTotalCycleNanos;
+    UInt64                      mMaxCycleNanos;
+    UInt64                      mOverloadedCycles;
+    
+    mutable std::mutex          mNotificationsMutex;
+    mutable std::condition_variable mNotificationsChanged;
+    std::map<AudioObjectPropertySelector, UInt64> mNotificationCounts;
+
+};
+
+#pragma clang assume_nonnull end
+
+#endif /* BGMDriver_Portable__BGM_SimulatedHost */
+
@@ -0,0 +1,40 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  AvailabilityMacros.h
+//  BGMDriver Portable
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  Part of the platform layer for building the driver's core without macOS. Claims the same SDK
+//  version as the Xcode project's deployment target.
+//
+
+#ifndef BGMDriver_Portable__AvailabilityMacros
+#define BGMDriver_Portable__AvailabilityMacros
+
+#define MAC_OS_X_VERSION_10_5       1050
+#define MAC_OS_X_VERSION_10_6       1060
+#define MAC_OS_X_VERSION_10_9       1090
+#define MAC_OS_X_VERSION_10_10      101000
+#define MAC_OS_X_VERSION_10_13      101300
+
+#define MAC_OS_X_VERSION_MIN_REQUIRED   MAC_OS_X_VERSION_10_13
+#define MAC_OS_X_VERSION_MAX_ALLOWED    MAC_OS_X_VERSION_10_13
+
+#endif /* BGMDriver_Portable__AvailabilityMacros */
+
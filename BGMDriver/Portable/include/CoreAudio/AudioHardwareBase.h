@@ -0,0 +1,120 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  AudioHardwareBase.h
+//  BGMDriver Portable
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  Part of the platform layer for building the driver's core without macOS. The HAL's object
+//  model types and the constants the core uses, with the same values as the macOS SDK.
+//
+
+#ifndef BGMDriver_Portable__AudioHardwareBase
+#define BGMDriver_Portable__AudioHardwareBase
+
+// Local Includes
+#include <CoreAudio/CoreAudioTypes.h>
+
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+typedef UInt32  AudioObjectID;
+typedef UInt32  AudioClassID;
+typedef UInt32  AudioObjectPropertySelector;
+typedef UInt32  AudioObjectPropertyScope;
+typedef UInt32  AudioObjectPropertyElement;
+
+struct AudioObjectPropertyAddress
+{
+    AudioObjectPropertySelector mSelector;
+    AudioObjectPropertyScope    mScope;
+    AudioObjectPropertyElement  mElement;
+};
+typedef struct AudioObjectPropertyAddress AudioObjectPropertyAddress;
+
+enum
+{
+    kAudioHardwareNoError                   = 0,
+    kAudioHardwareNotRunningError           = 'stop',
+    kAudioHardwareUnspecifiedError          = 'what',
+    kAudioHardwareUnknownPropertyError      = 'who?',
+    kAudioHardwareBadPropertySizeError      = '!siz',
+    kAudioHardwareIllegalOperationError     = 'nope',
+    kAudioHardwareBadObjectError            = '!obj',
+    kAudioHardwareBadDeviceError            = '!dev',
+    kAudioHardwareBadStreamError            = '!str',
+    kAudioHardwareUnsupportedOperationError = 'unop',
+    kAudioDeviceUnsupportedFormatError      = '!dat',
+    kAudioDevicePermissionsError            = '!hog'
+};
+
+enum
+{
+    kAudioObjectUnknown                     = 0
+};
+
+enum
+{
+    kAudioObjectPropertyScopeGlobal         = 'glob',
+    kAudioObjectPropertyScopeInput          = 'inpt',
+    kAudioObjectPropertyScopeOutput         = 'outp',
+    kAudioObjectPropertyScopePlayThrough    = 'ptru',
+    kAudioObjectPropertyElementMaster       = 0,
+    kAudioObjectPropertyElementMain         = kAudioObjectPropertyElementMaster
+};
+
+enum
+{
+    kAudioObjectPropertySelectorWildcard    = '****',
+    kAudioObjectPropertyScopeWildcard       = '****',
+    kAudioObjectPropertyElementWildcard     = 0xFFFFFFFF,
+    kAudioObjectClassIDWildcard             = '****'
+};
+
+enum
+{
+    kAudioObjectClassID                     = 'aobj',
+    kAudioPlugInClassID                     = 'aplg',
+    kAudioDeviceClassID                     = 'adev',
+    kAudioStreamClassID                     = 'astr',
+    kAudioControlClassID                    = 'actl',
+    kAudioLevelControlClassID               = 'levl',
+    kAudioVolumeControlClassID              = 'vlme',
+    kAudioBooleanControlClassID             = 'togl',
+    kAudioMuteControlClassID                = 'mute'
+};
+
+enum
+{
+    kAudioObjectPropertyBaseClass           = 'bcls',
+    kAudioObjectPropertyClass               = 'clas',
+    kAudioObjectPropertyOwner               = 'stdv',
+    kAudioObjectPropertyName                = 'lnam',
+    kAudioObjectPropertyCustomPropertyInfoList = 'cust',
+    kAudioDevicePropertyDeviceIsRunning     = 'goin',
+    kAudioDevicePropertyNominalSampleRate   = 'nsrt'
+};
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* BGMDriver_Portable__AudioHardwareBase */
+
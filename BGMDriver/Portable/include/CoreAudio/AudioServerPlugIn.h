@@ -0,0 +1,123 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  AudioServerPlugIn.h
+//  BGMDriver Portable
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  Part of the platform layer for building the driver's core without macOS. The plug-in types the
+//  core uses, with the same layouts and values as the macOS SDK. BGM_SimulatedHost implements
+//  AudioServerPlugInHostInterface in place of the HAL.
+//
+
+#ifndef BGMDriver_Portable__AudioServerPlugIn
+#define BGMDriver_Portable__AudioServerPlugIn
+
+// Local Includes
+#include <CoreAudio/AudioHardwareBase.h>
+
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+enum
+{
+    kAudioObjectPlugInObject                        = 1
+};
+
+struct AudioServerPlugInClientInfo
+{
+    UInt32                  mClientID;
+    pid_t                   mProcessID;
+    Boolean                 mIsNativeEndian;
+    CFStringRef             mBundleID;
+};
+typedef struct AudioServerPlugInClientInfo AudioServerPlugInClientInfo;
+
+struct AudioServerPlugInIOCycleInfo
+{
+    UInt64                  mIOCycleCounter;
+    UInt32                  mNominalIOBufferFrameSize;
+    AudioTimeStamp          mCurrentTime;
+    AudioTimeStamp          mInputTime;
+    AudioTimeStamp          mOutputTime;
+    AudioTimeStamp          mMainTime;
+    AudioTimeStamp          mDeviceTime;
+};
+typedef struct AudioServerPlugInIOCycleInfo AudioServerPlugInIOCycleInfo;
+
+enum
+{
+    kAudioServerPlugInIOOperationThread             = 'thrd',
+    kAudioServerPlugInIOOperationCycle              = 'cycl',
+    kAudioServerPlugInIOOperationReadInput          = 'read',
+    kAudioServerPlugInIOOperationConvertInput       = 'cinp',
+    kAudioServerPlugInIOOperationProcessInput       = 'pinp',
+    kAudioServerPlugInIOOperationProcessOutput      = 'pout',
+    kAudioServerPlugInIOOperationMixOutput          = 'mixo',
+    kAudioServerPlugInIOOperationProcessMix         = 'pmix',
+    kAudioServerPlugInIOOperationConvertMix         = 'cmix',
+    kAudioServerPlugInIOOperationWriteMix           = 'rite'
+};
+
+typedef UInt32 AudioServerPlugInCustomPropertyDataType;
+enum
+{
+    kAudioServerPlugInCustomPropertyDataTypeNone            = 0,
+    kAudioServerPlugInCustomPropertyDataTypeCFString        = 'cfst',
+    kAudioServerPlugInCustomPropertyDataTypeCFPropertyList  = 'plst'
+};
+
+struct AudioServerPlugInCustomPropertyInfo
+{
+    AudioObjectPropertySelector                 mSelector;
+    AudioServerPlugInCustomPropertyDataType     mPropertyDataType;
+    AudioServerPlugInCustomPropertyDataType     mQualifierDataType;
+};
+typedef struct AudioServerPlugInCustomPropertyInfo AudioServerPlugInCustomPropertyInfo;
+
+typedef struct AudioServerPlugInHostInterface   AudioServerPlugInHostInterface;
+typedef const AudioServerPlugInHostInterface*   AudioServerPlugInHostRef;
+
+struct AudioServerPlugInHostInterface
+{
+    OSStatus    (*PropertiesChanged)(AudioServerPlugInHostRef inHost,
+                                     AudioObjectID inObjectID,
+                                     UInt32 inNumberAddresses,
+                                     const AudioObjectPropertyAddress* inAddresses);
+    OSStatus    (*CopyFromStorage)(AudioServerPlugInHostRef inHost,
+                                   CFStringRef inKey,
+                                   CFPropertyListRef* outData);
+    OSStatus    (*WriteToStorage)(AudioServerPlugInHostRef inHost,
+                                  CFStringRef inKey,
+                                  CFPropertyListRef inData);
+    OSStatus    (*DeleteFromStorage)(AudioServerPlugInHostRef inHost,
+                                     CFStringRef inKey);
+    OSStatus    (*RequestDeviceConfigurationChange)(AudioServerPlugInHostRef inHost,
+                                                    AudioObjectID inDeviceObjectID,
+                                                    UInt64 inChangeAction,
+                                                    void* inChangeInfo);
+};
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* BGMDriver_Portable__AudioServerPlugIn */
+
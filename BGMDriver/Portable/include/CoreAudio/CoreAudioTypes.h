@@ -0,0 +1,145 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  CoreAudioTypes.h
+//  BGMDriver Portable
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  Part of the platform layer for building the driver's core without macOS. The CoreAudio types
+//  the core uses, with the same layouts and values as the macOS SDK.
+//
+
+#ifndef BGMDriver_Portable__CoreAudioTypes
+#define BGMDriver_Portable__CoreAudioTypes
+
+// Local Includes
+#include <MacTypes.h>
+#include <CoreFoundation/CoreFoundation.h>
+
+// The macOS SDK's CoreAudio headers include CoreFoundation and mach, which the driver relies on
+// for NSEC_PER_SEC, etc.
+#include <mach/clock_types.h>
+
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+struct SMPTETime
+{
+    SInt16                  mSubframes;
+    SInt16                  mSubframeDivisor;
+    UInt32                  mCounter;
+    UInt32                  mType;
+    UInt32                  mFlags;
+    SInt16                  mHours;
+    SInt16                  mMinutes;
+    SInt16                  mSeconds;
+    SInt16                  mFrames;
+};
+typedef struct SMPTETime SMPTETime;
+
+typedef UInt32 AudioTimeStampFlags;
+enum
+{
+    kAudioTimeStampNothingValid         = 0,
+    kAudioTimeStampSampleTimeValid      = (1U << 0),
+    kAudioTimeStampHostTimeValid        = (1U << 1),
+    kAudioTimeStampRateScalarValid      = (1U << 2),
+    kAudioTimeStampWordClockTimeValid   = (1U << 3),
+    kAudioTimeStampSMPTETimeValid       = (1U << 4),
+    kAudioTimeStampSampleHostTimeValid  = (kAudioTimeStampSampleTimeValid | kAudioTimeStampHostTimeValid)
+};
+
+struct AudioTimeStamp
+{
+    Float64                 mSampleTime;
+    UInt64                  mHostTime;
+    Float64                 mRateScalar;
+    UInt64                  mWordClockTime;
+    SMPTETime               mSMPTETime;
+    AudioTimeStampFlags     mFlags;
+    UInt32                  mReserved;
+};
+typedef struct AudioTimeStamp AudioTimeStamp;
+
+struct AudioBuffer
+{
+    UInt32                  mNumberChannels;
+    UInt32                  mDataByteSize;
+    void*                   mData;
+};
+typedef struct AudioBuffer AudioBuffer;
+
+struct AudioBufferList
+{
+    UInt32                  mNumberBuffers;
+    AudioBuffer             mBuffers[1];
+};
+typedef struct AudioBufferList AudioBufferList;
+
+struct AudioValueRange
+{
+    Float64                 mMinimum;
+    Float64                 mMaximum;
+};
+typedef struct AudioValueRange AudioValueRange;
+
+typedef UInt32 AudioFormatID;
+typedef UInt32 AudioFormatFlags;
+
+struct AudioStreamBasicDescription
+{
+    Float64                 mSampleRate;
+    AudioFormatID           mFormatID;
+    AudioFormatFlags        mFormatFlags;
+    UInt32                  mBytesPerPacket;
+    UInt32                  mFramesPerPacket;
+    UInt32                  mBytesPerFrame;
+    UInt32                  mChannelsPerFrame;
+    UInt32                  mBitsPerChannel;
+    UInt32                  mReserved;
+};
+typedef struct AudioStreamBasicDescription AudioStreamBasicDescription;
+
+enum
+{
+    kAudioFormatLinearPCM               = 'lpcm'
+};
+
+enum
+{
+    kAudioFormatFlagIsFloat             = (1U << 0),
+    kAudioFormatFlagIsBigEndian         = (1U << 1),
+    kAudioFormatFlagIsSignedInteger     = (1U << 2),
+    kAudioFormatFlagIsPacked            = (1U << 3),
+    kAudioFormatFlagIsNonInterleaved    = (1U << 5),
+#if TARGET_RT_BIG_ENDIAN
+    kAudioFormatFlagsNativeEndian       = kAudioFormatFlagIsBigEndian,
+#else
+    kAudioFormatFlagsNativeEndian       = 0,
+#endif
+    kAudioFormatFlagsNativeFloatPacked  = kAudioFormatFlagIsFloat | kAudioFormatFlagsNativeEndian | kAudioFormatFlagIsPacked
+};
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* BGMDriver_Portable__CoreAudioTypes */
+
@@ -0,0 +1,87 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  CFArray.h
+//  BGMDriver Portable
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  Part of the platform layer for building the driver's core without macOS.
+//
+
+#ifndef BGMDriver_Portable__CFArray
+#define BGMDriver_Portable__CFArray
+
+// Local Includes
+#include <CoreFoundation/CFBase.h>
+
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+typedef const struct __CFArray*     CFArrayRef;
+typedef struct __CFArray*           CFMutableArrayRef;
+
+// Only NULL, which doesn't retain the values, and kCFTypeArrayCallBacks are supported.
+typedef struct
+{
+    CFIndex                         version;
+} CFArrayCallBacks;
+
+extern const CFArrayCallBacks kCFTypeArrayCallBacks;
+
+CFTypeID            CFArrayGetTypeID(void);
+CFArrayRef          CFArrayCreate(CFAllocatorRef inAllocator,
+                                  const void** inValues,
+                                  CFIndex inNumberValues,
+                                  const CFArrayCallBacks* inCallBacks);
+CFArrayRef          CFArrayCreateCopy(CFAllocatorRef inAllocator, CFArrayRef inArray);
+CFMutableArrayRef   CFArrayCreateMutable(CFAllocatorRef inAllocator,
+                                         CFIndex inCapacity,
+                                         const CFArrayCallBacks* inCallBacks);
+CFMutableArrayRef   CFArrayCreateMutableCopy(CFAllocatorRef inAllocator,
+                                             CFIndex inCapacity,
+                                             CFArrayRef inArray);
+
+CFIndex             CFArrayGetCount(CFArrayRef inArray);
+const void*         CFArrayGetValueAtIndex(CFArrayRef inArray, CFIndex inIndex);
+Boolean             CFArrayContainsValue(CFArrayRef inArray, CFRange inRange, const void* inValue);
+CFIndex             CFArrayGetFirstIndexOfValue(CFArrayRef inArray,
+                                                CFRange inRange,
+                                                const void* inValue);
+
+void                CFArrayAppendValue(CFMutableArrayRef ioArray, const void* inValue);
+void                CFArrayInsertValueAtIndex(CFMutableArrayRef ioArray,
+                                              CFIndex inIndex,
+                                              const void* inValue);
+void                CFArraySetValueAtIndex(CFMutableArrayRef ioArray,
+                                           CFIndex inIndex,
+                                           const void* inValue);
+void                CFArrayRemoveValueAtIndex(CFMutableArrayRef ioArray, CFIndex inIndex);
+void                CFArrayRemoveAllValues(CFMutableArrayRef ioArray);
+void                CFArraySortValues(CFMutableArrayRef ioArray,
+                                      CFRange inRange,
+                                      CFComparatorFunction inComparator,
+                                      void* inContext);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* BGMDriver_Portable__CFArray */
+
@@ -0,0 +1,101 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  CFBase.h
+//  BGMDriver Portable
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  Part of the platform layer for building the driver's core without macOS. A minimal
+//  CoreFoundation: reference-counted strings, numbers, booleans, arrays and dictionaries, which is
+//  all the core uses. Implemented in BGM_PortableCoreFoundation.cpp.
+//
+//  Only what the core needs is declared. Allocators are ignored and the array and dictionary
+//  callbacks are either NULL or the kCFType ones, which retain and release their values.
+//
+
+#ifndef BGMDriver_Portable__CFBase
+#define BGMDriver_Portable__CFBase
+
+// Local Includes
+#include <MacTypes.h>
+
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+typedef const void*                         CFTypeRef;
+typedef unsigned long                       CFTypeID;
+typedef unsigned long                       CFOptionFlags;
+typedef unsigned long                       CFHashCode;
+typedef signed long                         CFIndex;
+
+typedef const struct __CFAllocator*         CFAllocatorRef;
+typedef const struct __CFString*            CFStringRef;
+typedef struct __CFString*                  CFMutableStringRef;
+typedef CFTypeRef                           CFPropertyListRef;
+
+typedef struct
+{
+    CFIndex                                 location;
+    CFIndex                                 length;
+} CFRange;
+
+static inline CFRange CFRangeMake(CFIndex inLocation, CFIndex inLength)
+{
+    CFRange theRange = { inLocation, inLength };
+    return theRange;
+}
+
+typedef CFIndex CFComparisonResult;
+enum
+{
+    kCFCompareLessThan      = -1,
+    kCFCompareEqualTo       = 0,
+    kCFCompareGreaterThan   = 1
+};
+
+typedef CFComparisonResult (*CFComparatorFunction)(const void* inValue1,
+                                                   const void* inValue2,
+                                                   void* inContext);
+
+enum
+{
+    kCFNotFound = -1
+};
+
+extern const CFAllocatorRef kCFAllocatorDefault;
+extern const CFAllocatorRef kCFAllocatorSystemDefault;
+
+extern const double kCFCoreFoundationVersionNumber;
+
+CFTypeRef           CFRetain(CFTypeRef inObject);
+void                CFRelease(CFTypeRef inObject);
+CFIndex             CFGetRetainCount(CFTypeRef inObject);
+CFTypeID            CFGetTypeID(CFTypeRef inObject);
+Boolean             CFEqual(CFTypeRef inObject1, CFTypeRef inObject2);
+CFHashCode          CFHash(CFTypeRef inObject);
+CFStringRef         CFCopyDescription(CFTypeRef inObject);
+void                CFShow(CFTypeRef inObject);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* BGMDriver_Portable__CFBase */
+
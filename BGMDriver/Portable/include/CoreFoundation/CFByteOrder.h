@@ -0,0 +1,53 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  CFByteOrder.h
+//  BGMDriver Portable
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  Part of the platform layer for building the driver's core without macOS.
+//
+
+#ifndef BGMDriver_Portable__CFByteOrder
+#define BGMDriver_Portable__CFByteOrder
+
+// Local Includes
+#include <CoreFoundation/CFBase.h>
+
+
+static inline UInt32 CFSwapInt32(UInt32 inValue)
+{
+    return __builtin_bswap32(inValue);
+}
+
+static inline UInt32 CFSwapInt32BigToHost(UInt32 inValue)
+{
+#if TARGET_RT_BIG_ENDIAN
+    return inValue;
+#else
+    return CFSwapInt32(inValue);
+#endif
+}
+
+static inline UInt32 CFSwapInt32HostToBig(UInt32 inValue)
+{
+    return CFSwapInt32BigToHost(inValue);
+}
+
+#endif /* BGMDriver_Portable__CFByteOrder */
+
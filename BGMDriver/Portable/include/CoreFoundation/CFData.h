@@ -0,0 +1,52 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  CFData.h
+//  BGMDriver Portable
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  Part of the platform layer for building the driver's core without macOS. The core only checks
+//  property list values' types, so the types it doesn't otherwise use are declared here without
+//  any functions. Nothing creates them, so their type IDs never match.
+//
+
+#ifndef BGMDriver_Portable__CFData
+#define BGMDriver_Portable__CFData
+
+// Local Includes
+#include <CoreFoundation/CFBase.h>
+
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+typedef const struct __CFData*      CFDataRef;
+typedef const struct __CFURL*       CFURLRef;
+typedef const struct __CFUUID*      CFUUIDRef;
+
+CFTypeID            CFDataGetTypeID(void);
+CFTypeID            CFURLGetTypeID(void);
+CFTypeID            CFUUIDGetTypeID(void);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* BGMDriver_Portable__CFData */
+
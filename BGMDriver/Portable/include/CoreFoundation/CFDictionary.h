@@ -0,0 +1,96 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  CFDictionary.h
+//  BGMDriver Portable
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  Part of the platform layer for building the driver's core without macOS. Keys are compared
+//  with CFEqual.
+//
+
+#ifndef BGMDriver_Portable__CFDictionary
+#define BGMDriver_Portable__CFDictionary
+
+// Local Includes
+#include <CoreFoundation/CFBase.h>
+
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+typedef const struct __CFDictionary*    CFDictionaryRef;
+typedef struct __CFDictionary*          CFMutableDictionaryRef;
+
+// Only NULL, which doesn't retain the keys/values, and the kCFType callbacks are supported.
+typedef struct
+{
+    CFIndex                             version;
+} CFDictionaryKeyCallBacks;
+
+typedef struct
+{
+    CFIndex                             version;
+} CFDictionaryValueCallBacks;
+
+extern const CFDictionaryKeyCallBacks kCFTypeDictionaryKeyCallBacks;
+extern const CFDictionaryKeyCallBacks kCFCopyStringDictionaryKeyCallBacks;
+extern const CFDictionaryValueCallBacks kCFTypeDictionaryValueCallBacks;
+
+CFTypeID                CFDictionaryGetTypeID(void);
+CFDictionaryRef         CFDictionaryCreate(CFAllocatorRef inAllocator,
+                                           const void** inKeys,
+                                           const void** inValues,
+                                           CFIndex inNumberValues,
+                                           const CFDictionaryKeyCallBacks* inKeyCallBacks,
+                                           const CFDictionaryValueCallBacks* inValueCallBacks);
+CFMutableDictionaryRef  CFDictionaryCreateMutable(CFAllocatorRef inAllocator,
+                                                  CFIndex inCapacity,
+                                                  const CFDictionaryKeyCallBacks* inKeyCallBacks,
+                                                  const CFDictionaryValueCallBacks* inValueCallBacks);
+CFMutableDictionaryRef  CFDictionaryCreateMutableCopy(CFAllocatorRef inAllocator,
+                                                      CFIndex inCapacity,
+                                                      CFDictionaryRef inDictionary);
+
+CFIndex                 CFDictionaryGetCount(CFDictionaryRef inDictionary);
+const void*             CFDictionaryGetValue(CFDictionaryRef inDictionary, const void* inKey);
+Boolean                 CFDictionaryGetValueIfPresent(CFDictionaryRef inDictionary,
+                                                      const void* inKey,
+                                                      const void** outValue);
+Boolean                 CFDictionaryContainsKey(CFDictionaryRef inDictionary, const void* inKey);
+void                    CFDictionaryGetKeysAndValues(CFDictionaryRef inDictionary,
+                                                     const void** outKeys,
+                                                     const void** outValues);
+
+void                    CFDictionarySetValue(CFMutableDictionaryRef ioDictionary,
+                                             const void* inKey,
+                                             const void* inValue);
+void                    CFDictionaryAddValue(CFMutableDictionaryRef ioDictionary,
+                                             const void* inKey,
+                                             const void* inValue);
+void                    CFDictionaryRemoveValue(CFMutableDictionaryRef ioDictionary,
+                                                const void* inKey);
+void                    CFDictionaryRemoveAllValues(CFMutableDictionaryRef ioDictionary);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* BGMDriver_Portable__CFDictionary */
+
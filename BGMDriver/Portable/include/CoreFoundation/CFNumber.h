@@ -0,0 +1,84 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  CFNumber.h
+//  BGMDriver Portable
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  Part of the platform layer for building the driver's core without macOS. CFNumbers keep
+//  integers as SInt64 and floating-point values as Float64.
+//
+
+#ifndef BGMDriver_Portable__CFNumber
+#define BGMDriver_Portable__CFNumber
+
+// Local Includes
+#include <CoreFoundation/CFBase.h>
+
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+typedef const struct __CFBoolean*   CFBooleanRef;
+typedef const struct __CFNumber*    CFNumberRef;
+
+extern const CFBooleanRef kCFBooleanTrue;
+extern const CFBooleanRef kCFBooleanFalse;
+
+CFTypeID            CFBooleanGetTypeID(void);
+Boolean             CFBooleanGetValue(CFBooleanRef inBoolean);
+
+typedef CFIndex CFNumberType;
+enum
+{
+    kCFNumberSInt8Type      = 1,
+    kCFNumberSInt16Type     = 2,
+    kCFNumberSInt32Type     = 3,
+    kCFNumberSInt64Type     = 4,
+    kCFNumberFloat32Type    = 5,
+    kCFNumberFloat64Type    = 6,
+    kCFNumberCharType       = 7,
+    kCFNumberShortType      = 8,
+    kCFNumberIntType        = 9,
+    kCFNumberLongType       = 10,
+    kCFNumberLongLongType   = 11,
+    kCFNumberFloatType      = 12,
+    kCFNumberDoubleType     = 13,
+    kCFNumberCFIndexType    = 14,
+    kCFNumberMaxType        = 14
+};
+
+CFTypeID            CFNumberGetTypeID(void);
+CFNumberRef         CFNumberCreate(CFAllocatorRef inAllocator,
+                                   CFNumberType inType,
+                                   const void* inValuePtr);
+CFNumberType        CFNumberGetType(CFNumberRef inNumber);
+Boolean             CFNumberIsFloatType(CFNumberRef inNumber);
+// Returns false if the conversion to inType was lossy, as on macOS.
+Boolean             CFNumberGetValue(CFNumberRef inNumber, CFNumberType inType, void* outValuePtr);
+CFComparisonResult  CFNumberCompare(CFNumberRef inNumber1,
+                                    CFNumberRef inNumber2,
+                                    void* inContext);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* BGMDriver_Portable__CFNumber */
+
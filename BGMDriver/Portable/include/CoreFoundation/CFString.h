@@ -0,0 +1,108 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  CFString.h
+//  BGMDriver Portable
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  Part of the platform layer for building the driver's core without macOS. CFStrings are stored
+//  as UTF-8 and only the UTF-8 and ASCII encodings are supported.
+//
+
+#ifndef BGMDriver_Portable__CFString
+#define BGMDriver_Portable__CFString
+
+// Local Includes
+#include <CoreFoundation/CFBase.h>
+
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+typedef UInt32 CFStringEncoding;
+enum
+{
+    kCFStringEncodingMacRoman   = 0,
+    kCFStringEncodingASCII      = 0x0600,
+    kCFStringEncodingUTF8       = 0x08000100
+};
+
+typedef CFOptionFlags CFStringCompareFlags;
+enum
+{
+    kCFCompareCaseInsensitive   = 1
+};
+
+// Returns an immortal string, interned so each literal is only allocated once.
+CFStringRef         __CFStringMakeConstantString(const char* inCString);
+#define CFSTR(cStr) __CFStringMakeConstantString("" cStr "")
+
+CFTypeID            CFStringGetTypeID(void);
+
+CFStringRef         CFStringCreateWithCString(CFAllocatorRef inAllocator,
+                                              const char* inCString,
+                                              CFStringEncoding inEncoding);
+CFStringRef         CFStringCreateWithBytes(CFAllocatorRef inAllocator,
+                                            const UInt8* inBytes,
+                                            CFIndex inNumberBytes,
+                                            CFStringEncoding inEncoding,
+                                            Boolean inIsExternalRepresentation);
+CFStringRef         CFStringCreateCopy(CFAllocatorRef inAllocator, CFStringRef inString);
+CFMutableStringRef  CFStringCreateMutable(CFAllocatorRef inAllocator, CFIndex inMaxLength);
+CFMutableStringRef  CFStringCreateMutableCopy(CFAllocatorRef inAllocator,
+                                              CFIndex inMaxLength,
+                                              CFStringRef inString);
+
+// The length in UTF-16 code units, as on macOS.
+CFIndex             CFStringGetLength(CFStringRef inString);
+void                CFStringGetCharacters(CFStringRef inString, CFRange inRange, UniChar* outBuffer);
+const char*         CFStringGetCStringPtr(CFStringRef inString, CFStringEncoding inEncoding);
+Boolean             CFStringGetCString(CFStringRef inString,
+                                       char* outBuffer,
+                                       CFIndex inBufferSize,
+                                       CFStringEncoding inEncoding);
+CFIndex             CFStringGetBytes(CFStringRef inString,
+                                     CFRange inRange,
+                                     CFStringEncoding inEncoding,
+                                     UInt8 inLossByte,
+                                     Boolean inIsExternalRepresentation,
+                                     UInt8* outBuffer,
+                                     CFIndex inMaxBufferLength,
+                                     CFIndex* outUsedBufferLength);
+CFIndex             CFStringGetMaximumSizeForEncoding(CFIndex inLength, CFStringEncoding inEncoding);
+
+CFComparisonResult  CFStringCompare(CFStringRef inString1,
+                                    CFStringRef inString2,
+                                    CFStringCompareFlags inCompareOptions);
+Boolean             CFStringHasPrefix(CFStringRef inString, CFStringRef inPrefix);
+Boolean             CFStringHasSuffix(CFStringRef inString, CFStringRef inSuffix);
+SInt32              CFStringGetIntValue(CFStringRef inString);
+double              CFStringGetDoubleValue(CFStringRef inString);
+
+void                CFStringAppend(CFMutableStringRef ioString, CFStringRef inAppendedString);
+void                CFStringAppendCString(CFMutableStringRef ioString,
+                                          const char* inCString,
+                                          CFStringEncoding inEncoding);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* BGMDriver_Portable__CFString */
+
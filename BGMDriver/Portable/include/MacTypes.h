@@ -0,0 +1,85 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  MacTypes.h
+//  BGMDriver Portable
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  Part of the platform layer for building the driver's core without macOS. The basic types from
+//  the CarbonCore MacTypes.h.
+//
+
+#ifndef BGMDriver_Portable__MacTypes
+#define BGMDriver_Portable__MacTypes
+
+// Local Includes
+#include "TargetConditionals.h"
+#include "AvailabilityMacros.h"
+
+// System Includes
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <sys/types.h>
+#include <sys/cdefs.h>
+#include <limits.h>
+
+// Clang's nullability qualifiers. GCC doesn't have them.
+#if !defined(__clang__)
+    #define _Nonnull
+    #define _Nullable
+    #define _Null_unspecified
+#endif
+
+// From the macOS SDK's sys/cdefs.h.
+#if !defined(__printflike)
+    #define __printflike(fmtarg, firstvararg) __attribute__((__format__(__printf__, fmtarg, firstvararg)))
+#endif
+
+typedef uint8_t         UInt8;
+typedef int8_t          SInt8;
+typedef uint16_t        UInt16;
+typedef int16_t         SInt16;
+typedef uint32_t        UInt32;
+typedef int32_t         SInt32;
+// long long, like the macOS SDK, rather than int64_t, which is long on 64-bit Linux.
+typedef unsigned long long  UInt64;
+typedef signed long long    SInt64;
+typedef float           Float32;
+typedef double          Float64;
+
+typedef unsigned char   Boolean;
+typedef UInt8           Byte;
+typedef SInt8           SignedByte;
+typedef UInt16          UniChar;
+typedef SInt32          OSStatus;
+typedef SInt16          OSErr;
+typedef UInt32          FourCharCode;
+typedef FourCharCode    OSType;
+typedef char*           Ptr;
+
+enum
+{
+    noErr       = 0,
+    unimpErr    = -4,
+    paramErr    = -50,
+    memFullErr  = -108
+};
+
+#endif /* BGMDriver_Portable__MacTypes */
+
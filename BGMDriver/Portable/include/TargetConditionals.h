@@ -0,0 +1,54 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  TargetConditionals.h
+//  BGMDriver Portable
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  Part of the platform layer for building the driver's core without macOS. (See "The Portable
+//  Core" in DEVELOPING.md.)
+//
+//  The shims provide the small subset of the Mac APIs the core uses on top of POSIX, so the core
+//  is compiled as a Mac target, which makes PublicUtility take its pthread paths.
+//
+
+#ifndef BGMDriver_Portable__TargetConditionals
+#define BGMDriver_Portable__TargetConditionals
+
+#define TARGET_OS_MAC           1
+#define TARGET_OS_OSX           1
+#define TARGET_OS_IPHONE        0
+#define TARGET_OS_WIN32         0
+#define TARGET_API_MAC_CARBON   0
+
+#if defined(__LP64__) || defined(_LP64)
+    #define TARGET_RT_64_BIT    1
+#else
+    #define TARGET_RT_64_BIT    0
+#endif
+
+#if defined(__BIG_ENDIAN__) || (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    #define TARGET_RT_BIG_ENDIAN    1
+    #define TARGET_RT_LITTLE_ENDIAN 0
+#else
+    #define TARGET_RT_BIG_ENDIAN    0
+    #define TARGET_RT_LITTLE_ENDIAN 1
+#endif
+
+#endif /* BGMDriver_Portable__TargetConditionals */
+
@@ -0,0 +1,225 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  OSAtomic.h
+//  BGMDriver Portable
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  Part of the platform layer for building the driver's core without macOS. Darwin's deprecated
+//  OSAtomic functions, which PublicUtility's CAAtomic and CAAtomicStack are built on, implemented
+//  with the compiler's atomic builtins.
+//
+//  The "Barrier" variants are sequentially consistent and the others are relaxed, as on macOS.
+//
+
+#ifndef BGMDriver_Portable__OSAtomic
+#define BGMDriver_Portable__OSAtomic
+
+// Local Includes
+#include <MacTypes.h>
+
+// System Includes
+#include <sched.h>
+
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+static inline void OSMemoryBarrier(void)
+{
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+#pragma mark Arithmetic
+
+static inline int32_t OSAtomicAdd32(int32_t inAmount, volatile int32_t* ioValue)
+{
+    return __atomic_add_fetch(ioValue, inAmount, __ATOMIC_RELAXED);
+}
+
+static inline int32_t OSAtomicAdd32Barrier(int32_t inAmount, volatile int32_t* ioValue)
+{
+    return __atomic_add_fetch(ioValue, inAmount, __ATOMIC_SEQ_CST);
+}
+
+static inline int32_t OSAtomicIncrement32(volatile int32_t* ioValue)
+{
+    return OSAtomicAdd32(1, ioValue);
+}
+
+static inline int32_t OSAtomicIncrement32Barrier(volatile int32_t* ioValue)
+{
+    return OSAtomicAdd32Barrier(1, ioValue);
+}
+
+static inline int32_t OSAtomicDecrement32(volatile int32_t* ioValue)
+{
+    return OSAtomicAdd32(-1, ioValue);
+}
+
+static inline int32_t OSAtomicDecrement32Barrier(volatile int32_t* ioValue)
+{
+    return OSAtomicAdd32Barrier(-1, ioValue);
+}
+
+static inline int64_t OSAtomicAdd64Barrier(int64_t inAmount, volatile int64_t* ioValue)
+{
+    return __atomic_add_fetch(ioValue, inAmount, __ATOMIC_SEQ_CST);
+}
+
+static inline int32_t OSAtomicOr32Barrier(uint32_t inMask, volatile uint32_t* ioValue)
+{
+    return (int32_t)__atomic_or_fetch(ioValue, inMask, __ATOMIC_SEQ_CST);
+}
+
+static inline int32_t OSAtomicAnd32Barrier(uint32_t inMask, volatile uint32_t* ioValue)
+{
+    return (int32_t)__atomic_and_fetch(ioValue, inMask, __ATOMIC_SEQ_CST);
+}
+
+#pragma mark Compare and Swap
+
+static inline bool OSAtomicCompareAndSwap32(int32_t inOldValue,
+                                            int32_t inNewValue,
+                                            volatile int32_t* ioValue)
+{
+    return __atomic_compare_exchange_n(ioValue, &inOldValue, inNewValue, false,
+                                       __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+}
+
+static inline bool OSAtomicCompareAndSwap32Barrier(int32_t inOldValue,
+                                                   int32_t inNewValue,
+                                                   volatile int32_t* ioValue)
+{
+    return __atomic_compare_exchange_n(ioValue, &inOldValue, inNewValue, false,
+                                       __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+static inline bool OSAtomicCompareAndSwap64Barrier(int64_t inOldValue,
+                                                   int64_t inNewValue,
+                                                   volatile int64_t* ioValue)
+{
+    return __atomic_compare_exchange_n(ioValue, &inOldValue, inNewValue, false,
+                                       __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+static inline bool OSAtomicCompareAndSwapPtrBarrier(void* inOldValue,
+                                                    void* inNewValue,
+                                                    void* volatile* ioValue)
+{
+    return __atomic_compare_exchange_n(ioValue, &inOldValue, inNewValue, false,
+                                       __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+#pragma mark Bit Operations
+
+// Bit 0 is the most significant bit of the first byte, as on macOS.
+static inline bool OSAtomicTestAndSetBarrier(uint32_t inBit, volatile void* ioAddress)
+{
+    volatile uint8_t* theByte = (volatile uint8_t*)ioAddress + (inBit >> 3);
+    uint8_t theMask = (uint8_t)(0x80u >> (inBit & 7u));
+    return (__atomic_fetch_or(theByte, theMask, __ATOMIC_SEQ_CST) & theMask) != 0;
+}
+
+static inline bool OSAtomicTestAndClearBarrier(uint32_t inBit, volatile void* ioAddress)
+{
+    volatile uint8_t* theByte = (volatile uint8_t*)ioAddress + (inBit >> 3);
+    uint8_t theMask = (uint8_t)(0x80u >> (inBit & 7u));
+    return (__atomic_fetch_and(theByte, (uint8_t)~theMask, __ATOMIC_SEQ_CST) & theMask) != 0;
+}
+
+static inline bool OSAtomicTestAndClear(uint32_t inBit, volatile void* ioAddress)
+{
+    volatile uint8_t* theByte = (volatile uint8_t*)ioAddress + (inBit >> 3);
+    uint8_t theMask = (uint8_t)(0x80u >> (inBit & 7u));
+    return (__atomic_fetch_and(theByte, (uint8_t)~theMask, __ATOMIC_RELAXED) & theMask) != 0;
+}
+
+#pragma mark Spin Locks
+
+typedef int32_t OSSpinLock;
+#define OS_SPINLOCK_INIT    0
+
+static inline bool OSSpinLockTry(volatile OSSpinLock* ioLock)
+{
+    return __atomic_exchange_n(ioLock, 1, __ATOMIC_ACQUIRE) == 0;
+}
+
+static inline void OSSpinLockLock(volatile OSSpinLock* ioLock)
+{
+    while(!OSSpinLockTry(ioLock))
+    {
+        // Yield rather than just spinning, like Darwin's implementation does after a while.
+        while(__atomic_load_n(ioLock, __ATOMIC_RELAXED) != 0)
+        {
+            sched_yield();
+        }
+    }
+}
+
+static inline void OSSpinLockUnlock(volatile OSSpinLock* ioLock)
+{
+    __atomic_store_n(ioLock, 0, __ATOMIC_RELEASE);
+}
+
+#pragma mark Queues
+
+// A LIFO queue of elements that each have a pointer to the next element at inOffset bytes.
+// Darwin's implementation is lock-free. This one guards the head with a spin lock in opaque2, which
+// is only held for a few instructions.
+typedef struct
+{
+    void* volatile      opaque1;
+    volatile long       opaque2;
+} OSQueueHead;
+
+#define OS_ATOMIC_QUEUE_INIT    { NULL, 0 }
+
+static inline void OSAtomicEnqueue(OSQueueHead* ioList, void* inNewElement, size_t inOffset)
+{
+    volatile OSSpinLock* theLock = (volatile OSSpinLock*)&ioList->opaque2;
+    
+    OSSpinLockLock(theLock);
+    *(void**)((char*)inNewElement + inOffset) = ioList->opaque1;
+    ioList->opaque1 = inNewElement;
+    OSSpinLockUnlock(theLock);
+}
+
+static inline void* OSAtomicDequeue(OSQueueHead* ioList, size_t inOffset)
+{
+    volatile OSSpinLock* theLock = (volatile OSSpinLock*)&ioList->opaque2;
+    
+    OSSpinLockLock(theLock);
+    void* theElement = ioList->opaque1;
+    
+    if(theElement != NULL)
+    {
+        ioList->opaque1 = *(void**)((char*)theElement + inOffset);
+    }
+    
+    OSSpinLockUnlock(theLock);
+    return theElement;
+}
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* BGMDriver_Portable__OSAtomic */
+
@@ -0,0 +1,40 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  kern_return.h
+//  BGMDriver Portable
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  Part of the platform layer for building the driver's core without macOS.
+//
+
+#ifndef BGMDriver_Portable__kern_return
+#define BGMDriver_Portable__kern_return
+
+typedef int kern_return_t;
+
+#define KERN_SUCCESS                0
+#define KERN_INVALID_ADDRESS        1
+#define KERN_INVALID_ARGUMENT       4
+#define KERN_FAILURE                5
+#define KERN_RESOURCE_SHORTAGE      6
+#define KERN_ABORTED                14
+#define KERN_OPERATION_TIMED_OUT    49
+
+#endif /* BGMDriver_Portable__kern_return */
+
@@ -0,0 +1,43 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  mach.h
+//  BGMDriver Portable
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  Part of the platform layer for building the driver's core without macOS. Only the parts of Mach
+//  the core uses: host time, semaphores and thread policies.
+//
+
+#ifndef BGMDriver_Portable__mach
+#define BGMDriver_Portable__mach
+
+#include <mach/kern_return.h>
+#include <mach/mach_types.h>
+#include <mach/mach_init.h>
+#include <mach/clock_types.h>
+#include <mach/mach_time.h>
+#include <mach/semaphore.h>
+#include <mach/thread_policy.h>
+#include <mach/mach_error.h>
+
+// Darwin's <pthread.h> extensions (e.g. pthread_mach_thread_np) are in the pthread.h shim.
+#include <pthread.h>
+
+#endif /* BGMDriver_Portable__mach */
+
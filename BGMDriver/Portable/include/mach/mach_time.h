@@ -0,0 +1,70 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  mach_time.h
+//  BGMDriver Portable
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  Part of the platform layer for building the driver's core without macOS. Host time is
+//  CLOCK_MONOTONIC in nanoseconds, so the timebase is 1/1.
+//
+
+#ifndef BGMDriver_Portable__mach_time
+#define BGMDriver_Portable__mach_time
+
+// Local Includes
+#include <mach/kern_return.h>
+
+// System Includes
+#include <stdint.h>
+#include <time.h>
+
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+struct mach_timebase_info
+{
+    uint32_t                numer;
+    uint32_t                denom;
+};
+
+typedef struct mach_timebase_info*  mach_timebase_info_t;
+typedef struct mach_timebase_info   mach_timebase_info_data_t;
+
+static inline kern_return_t mach_timebase_info(mach_timebase_info_t outInfo)
+{
+    outInfo->numer = 1;
+    outInfo->denom = 1;
+    return KERN_SUCCESS;
+}
+
+static inline uint64_t mach_absolute_time(void)
+{
+    struct timespec theTime;
+    clock_gettime(CLOCK_MONOTONIC, &theTime);
+    return (uint64_t)theTime.tv_sec * 1000000000ULL + (uint64_t)theTime.tv_nsec;
+}
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* BGMDriver_Portable__mach_time */
+
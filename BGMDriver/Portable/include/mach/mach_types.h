@@ -0,0 +1,51 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  mach_types.h
+//  BGMDriver Portable
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  Part of the platform layer for building the driver's core without macOS.
+//
+
+#ifndef BGMDriver_Portable__mach_types
+#define BGMDriver_Portable__mach_types
+
+// Local Includes
+#include <mach/kern_return.h>
+
+// System Includes
+#include <stdint.h>
+
+
+typedef int                         integer_t;
+typedef unsigned int                natural_t;
+typedef int                         boolean_t;
+typedef natural_t                   mach_port_t;
+typedef mach_port_t                 task_t;
+typedef mach_port_t                 thread_act_t;
+typedef natural_t                   mach_msg_type_number_t;
+
+// Semaphores are pointers to BGM_PortableMach.cpp's implementation instead of Mach ports.
+typedef struct BGM_PortableSemaphore*   semaphore_t;
+
+#define MACH_PORT_NULL              0
+#define SEMAPHORE_NULL              ((semaphore_t)0)
+
+#endif /* BGMDriver_Portable__mach_types */
+
@@ -0,0 +1,71 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  semaphore.h
+//  BGMDriver Portable
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  Part of the platform layer for building the driver's core without macOS. Mach semaphores,
+//  implemented with a pthread mutex and condition variable in BGM_PortableMach.cpp.
+//
+//  Signalling a Mach semaphore is real-time safe. Signalling these only briefly takes a mutex that
+//  the waiting threads hold for a few instructions, which is close enough for the simulated host.
+//
+
+#ifndef BGMDriver_Portable__semaphore
+#define BGMDriver_Portable__semaphore
+
+// Local Includes
+#include <mach/mach_types.h>
+
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+typedef int sync_policy_t;
+#define SYNC_POLICY_FIFO            0x0
+#define SYNC_POLICY_LIFO            0x2
+
+typedef int clock_res_t;
+
+struct mach_timespec
+{
+    unsigned int            tv_sec;
+    clock_res_t             tv_nsec;
+};
+typedef struct mach_timespec mach_timespec_t;
+
+kern_return_t   semaphore_create(task_t inTask,
+                                 semaphore_t* outSemaphore,
+                                 int inPolicy,
+                                 int inValue);
+kern_return_t   semaphore_destroy(task_t inTask, semaphore_t inSemaphore);
+kern_return_t   semaphore_signal(semaphore_t inSemaphore);
+// Wakes all the threads waiting on the semaphore. Doesn't change its count if none are.
+kern_return_t   semaphore_signal_all(semaphore_t inSemaphore);
+kern_return_t   semaphore_wait(semaphore_t inSemaphore);
+// Returns KERN_OPERATION_TIMED_OUT if the semaphore isn't signalled in time.
+kern_return_t   semaphore_timedwait(semaphore_t inSemaphore, mach_timespec_t inWaitTime);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* BGMDriver_Portable__semaphore */
+
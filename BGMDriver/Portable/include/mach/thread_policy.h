@@ -0,0 +1,140 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  thread_policy.h
+//  BGMDriver Portable
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  Part of the platform layer for building the driver's core without macOS. The thread policy and
+//  scheduling info calls CAPThread makes.
+//
+//  Policies are accepted and ignored, since the simulated host doesn't need real-time scheduling
+//  and CI machines usually don't allow it. Every thread reports the default timesharing priority.
+//
+
+#ifndef BGMDriver_Portable__thread_policy
+#define BGMDriver_Portable__thread_policy
+
+// Local Includes
+#include <mach/mach_types.h>
+
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+typedef natural_t       thread_policy_flavor_t;
+typedef integer_t*      thread_policy_t;
+
+#define THREAD_EXTENDED_POLICY          1
+#define THREAD_TIME_CONSTRAINT_POLICY   2
+#define THREAD_PRECEDENCE_POLICY        3
+
+typedef struct { boolean_t timeshare; }     thread_extended_policy_data_t;
+typedef struct { integer_t importance; }    thread_precedence_policy_data_t;
+typedef struct
+{
+    uint32_t                period;
+    uint32_t                computation;
+    uint32_t                constraint;
+    boolean_t               preemptible;
+} thread_time_constraint_policy_data_t;
+
+#define THREAD_EXTENDED_POLICY_COUNT \
+        ((mach_msg_type_number_t)(sizeof(thread_extended_policy_data_t) / sizeof(integer_t)))
+#define THREAD_PRECEDENCE_POLICY_COUNT \
+        ((mach_msg_type_number_t)(sizeof(thread_precedence_policy_data_t) / sizeof(integer_t)))
+#define THREAD_TIME_CONSTRAINT_POLICY_COUNT \
+        ((mach_msg_type_number_t)(sizeof(thread_time_constraint_policy_data_t) / sizeof(integer_t)))
+
+kern_return_t   thread_policy_set(thread_act_t inThread,
+                                  thread_policy_flavor_t inFlavor,
+                                  thread_policy_t inPolicyInfo,
+                                  mach_msg_type_number_t inCount);
+
+typedef natural_t       thread_flavor_t;
+typedef integer_t*      thread_info_t;
+
+#define THREAD_BASIC_INFO               3
+#define THREAD_SCHED_TIMESHARE_INFO     10
+#define THREAD_SCHED_RR_INFO            11
+#define THREAD_SCHED_FIFO_INFO          12
+
+#define POLICY_TIMESHARE                1
+#define POLICY_RR                       2
+#define POLICY_FIFO                     4
+
+typedef struct
+{
+    integer_t               user_time[2];
+    integer_t               system_time[2];
+    integer_t               cpu_usage;
+    integer_t               policy;
+    integer_t               run_state;
+    integer_t               flags;
+    integer_t               suspend_count;
+    integer_t               sleep_time;
+} thread_basic_info_data_t;
+
+typedef struct
+{
+    integer_t               max_priority;
+    integer_t               base_priority;
+    integer_t               cur_priority;
+    boolean_t               depressed;
+    integer_t               depress_priority;
+} policy_timeshare_info_data_t;
+
+typedef struct
+{
+    integer_t               max_priority;
+    integer_t               base_priority;
+    integer_t               quantum;
+    boolean_t               depressed;
+    integer_t               depress_priority;
+} policy_rr_info_data_t;
+
+typedef policy_rr_info_data_t policy_fifo_info_data_t;
+
+typedef struct
+{
+    policy_timeshare_info_data_t    ts;
+    policy_rr_info_data_t           rr;
+    policy_fifo_info_data_t         fifo;
+} policy_info_data_t;
+
+#define THREAD_BASIC_INFO_COUNT \
+        ((mach_msg_type_number_t)(sizeof(thread_basic_info_data_t) / sizeof(integer_t)))
+#define POLICY_TIMESHARE_INFO_COUNT \
+        ((mach_msg_type_number_t)(sizeof(policy_timeshare_info_data_t) / sizeof(integer_t)))
+#define POLICY_RR_INFO_COUNT \
+        ((mach_msg_type_number_t)(sizeof(policy_rr_info_data_t) / sizeof(integer_t)))
+#define POLICY_FIFO_INFO_COUNT \
+        ((mach_msg_type_number_t)(sizeof(policy_fifo_info_data_t) / sizeof(integer_t)))
+
+kern_return_t   thread_info(thread_act_t inThread,
+                            thread_flavor_t inFlavor,
+                            thread_info_t outInfo,
+                            mach_msg_type_number_t* ioCount);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* BGMDriver_Portable__thread_policy */
+
@@ -0,0 +1,59 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  pthread.h
+//  BGMDriver Portable
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  Part of the platform layer for building the driver's core without macOS. Adds Darwin's
+//  extensions to the system's <pthread.h>.
+//
+
+#include_next <pthread.h>
+
+#ifndef BGMDriver_Portable__pthread
+#define BGMDriver_Portable__pthread
+
+// Local Includes
+#include <mach/mach_types.h>
+
+
+#if defined(__cplusplus)
+// Threads don't have Mach ports, but the thread policy shims ignore them anyway.
+static inline mach_port_t pthread_mach_thread_np(pthread_t inThread)
+{
+    return static_cast<mach_port_t>(reinterpret_cast<uintptr_t>(reinterpret_cast<void*>(inThread)));
+}
+
+// Darwin's version only names the calling thread.
+static inline int pthread_setname_np(const char* inName)
+{
+    // Linux limits thread names to 15 characters.
+    char theName[16] = { 0 };
+    
+    for(int i = 0; i < 15 && inName[i] != '\0'; i++)
+    {
+        theName[i] = inName[i];
+    }
+    
+    return pthread_setname_np(pthread_self(), theName);
+}
+#endif
+
+#endif /* BGMDriver_Portable__pthread */
+
@@ -0,0 +1,47 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  stdlib.h
+//  BGMDriver Portable
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  Part of the platform layer for building the driver's core without macOS. Adds the BSD
+//  functions from macOS's stdlib.h that the PublicUtility classes use.
+//
+
+#include_next <stdlib.h>
+
+#ifndef BGMDriver_Portable__stdlib
+#define BGMDriver_Portable__stdlib
+
+#if !defined(__APPLE__)
+// Like realloc, but frees the original allocation if it fails.
+static inline void* reallocf(void* inPtr, size_t inSize)
+{
+    void* theNewPtr = realloc(inPtr, inSize);
+    
+    if(theNewPtr == NULL && inSize != 0)
+    {
+        free(inPtr);
+    }
+    
+    return theNewPtr;
+}
+#endif
+
+#endif /* BGMDriver_Portable__stdlib */
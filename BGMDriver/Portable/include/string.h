@@ -0,0 +1,49 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  string.h
+//  BGMDriver Portable
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  Part of the platform layer for building the driver's core without macOS. Adds the BSD string
+//  functions glibc didn't have before 2.38.
+//
+
+#include_next <string.h>
+
+#ifndef BGMDriver_Portable__string
+#define BGMDriver_Portable__string
+
+#if defined(__GLIBC__) && (__GLIBC__ < 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ < 38))
+static inline size_t strlcpy(char* outDest, const char* inSource, size_t inDestSize)
+{
+    size_t theSourceLength = strlen(inSource);
+    
+    if(inDestSize > 0)
+    {
+        size_t theCopyLength = (theSourceLength < inDestSize - 1) ? theSourceLength : inDestSize - 1;
+        memcpy(outDest, inSource, theCopyLength);
+        outDest[theCopyLength] = '\0';
+    }
+    
+    return theSourceLength;
+}
+#endif
+
+#endif /* BGMDriver_Portable__string */
+
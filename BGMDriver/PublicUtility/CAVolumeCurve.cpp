@@ -63,7 +63,9 @@ CAVolumeCurve::CAVolumeCurve()
 	mIsApplyingTransferFunction(true),
 	mTransferFunction(kPow2Over1Curve),
 	mRawToScalarExponentNumerator(2.0f),
-	mRawToScalarExponentDenominator(1.0f)
+	mRawToScalarExponentDenominator(1.0f),
+	mRawToDBTable(),
+	mRawToScalarTable()
 {
 }
 
@@ -125,6 +127,12 @@ Float32	CAVolumeCurve::GetMaximumDB() const
 	return theAnswer;
 }
 
+void	CAVolumeCurve::SetIsApplyingTransferFunction(bool inIsApplyingTransferFunction)
+{
+	mIsApplyingTransferFunction = inIsApplyingTransferFunction;
+	UpdateTables();
+}
+
 void	CAVolumeCurve::SetTransferFunction(UInt32 inTransferFunction)
 {
 	mTransferFunction = inTransferFunction;
@@ -234,6 +242,8 @@ void	CAVolumeCurve::SetTransferFunction(UInt32 inTransferFunction)
 			mRawToScalarExponentDenominator = 1.0f;
 			break;
 	};
+	
+	UpdateTables();
 }
 
 void	CAVolumeCurve::AddRange(SInt32 inMinRaw, SInt32 inMaxRaw, Float32 inMinDB, Float32 inMaxDB)
@@ -258,6 +268,7 @@ void	CAVolumeCurve::AddRange(SInt32 inMinRaw, SInt32 inMaxRaw, Float32 inMinDB,
 	if(!isOverlapped)
 	{
 		mCurveMap.insert(CurveMap::value_type(theRaw, theDB));
+		UpdateTables();
 	}
 	else
 	{
@@ -268,6 +279,7 @@ void	CAVolumeCurve::AddRange(SInt32 inMinRaw, SInt32 inMaxRaw, Float32 inMinDB,
 void	CAVolumeCurve::ResetRange()
 {
 	mCurveMap.clear();
+	UpdateTables();
 }
 
 bool	CAVolumeCurve::CheckForContinuity() const
@@ -363,6 +375,68 @@ SInt32	CAVolumeCurve::ConvertDBToRaw(Float32 inDB) const
 }
 
 Float32	CAVolumeCurve::ConvertRawToDB(SInt32 inRaw) const
+{
+	if(mRawToDBTable.empty())
+	{
+		return CalculateRawToDB(inRaw);
+	}
+	
+	//	clamp the raw value and look it up
+	SInt32 theRawMin = mCurveMap.begin()->first.mMinimum;
+	SInt32 theRawMax = theRawMin + static_cast<SInt32>(mRawToDBTable.size() - 1);
+	
+	if(inRaw < theRawMin) inRaw = theRawMin;
+	if(inRaw > theRawMax) inRaw = theRawMax;
+	
+	return mRawToDBTable[static_cast<size_t>(inRaw - theRawMin)];
+}
+
+Float32	CAVolumeCurve::ConvertRawToScalar(SInt32 inRaw) const
+{
+	if(mRawToScalarTable.empty())
+	{
+		return CalculateRawToScalar(inRaw);
+	}
+	
+	//	clamp the raw value and look it up
+	SInt32 theRawMin = mCurveMap.begin()->first.mMinimum;
+	SInt32 theRawMax = theRawMin + static_cast<SInt32>(mRawToScalarTable.size() - 1);
+	
+	if(inRaw < theRawMin) inRaw = theRawMin;
+	if(inRaw > theRawMax) inRaw = theRawMax;
+	
+	return mRawToScalarTable[static_cast<size_t>(inRaw - theRawMin)];
+}
+
+void	CAVolumeCurve::UpdateTables()
+{
+	mRawToDBTable.clear();
+	mRawToScalarTable.clear();
+	
+	if(!mCurveMap.empty())
+	{
+		//	the tables have an entry for every raw value from the minimum to the maximum, inclusive
+		SInt64 theTableSize = static_cast<SInt64>(GetMaximumRaw()) - static_cast<SInt64>(GetMinimumRaw()) + 1;
+		
+		if((theTableSize > 0) && (theTableSize <= kMaximumTableSize))
+		{
+			SInt32 theRawMin = GetMinimumRaw();
+			
+			mRawToDBTable.resize(static_cast<size_t>(theTableSize));
+			mRawToScalarTable.resize(static_cast<size_t>(theTableSize));
+			
+			//	fill them in with the calculated conversions so the lookups give exactly the same
+			//	answers
+			for(SInt32 theIndex = 0; theIndex < static_cast<SInt32>(theTableSize); ++theIndex)
+			{
+				mRawToDBTable[theIndex] = CalculateRawToDB(theRawMin + theIndex);
+				mRawToScalarTable[theIndex] = CalculateRawToScalar(theRawMin + theIndex);
+			}
+		}
+	}
+}
+
+Float32	CAVolumeCurve::CalculateRawToDB(SInt32 inRaw) const
 {
 	Float32 theAnswer = 0;
 	
@@ -412,7 +486,7 @@ Float32	CAVolumeCurve::ConvertRawToDB(SInt32 inRaw) const
 	return theAnswer;
 }
 
-Float32	CAVolumeCurve::ConvertRawToScalar(SInt32 inRaw) const
+Float32	CAVolumeCurve::CalculateRawToScalar(SInt32 inRaw) const
 {
 	//	get some important values
 	Float32	theDBMin = GetMinimumDB();
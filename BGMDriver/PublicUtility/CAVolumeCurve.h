@@ -57,6 +57,7 @@
 	#include <CoreAudioTypes.h>
 #endif
 #include <map>
+#include <vector>
 
 //=============================================================================
 //	Types
@@ -145,7 +146,7 @@ public:
 	Float32			GetMinimumDB() const;
 	Float32			GetMaximumDB() const;
 	
-	void			SetIsApplyingTransferFunction(bool inIsApplyingTransferFunction)  { mIsApplyingTransferFunction = inIsApplyingTransferFunction; }
+	void			SetIsApplyingTransferFunction(bool inIsApplyingTransferFunction);
 	UInt32			GetTransferFunction() const { return mTransferFunction; }
 	void			SetTransferFunction(UInt32 inTransferFunction);
 
@@ -164,7 +165,15 @@ public:
 
 //	Implementation
 private:
+	void			UpdateTables();
+	Float32			CalculateRawToDB(SInt32 inRaw) const;
+	Float32			CalculateRawToScalar(SInt32 inRaw) const;
+
 	typedef	std::map<CARawPoint, CADBPoint>	CurveMap;
+	typedef std::vector<Float32>			ConversionTable;
+	
+	//	curves with more raw steps than this compute each conversion instead of using the tables
+	static const SInt32	kMaximumTableSize = 65536;
 	
 	UInt32			mTag;
 	CurveMap		mCurveMap;
@@ -172,6 +181,12 @@ private:
 	UInt32			mTransferFunction;
 	Float32			mRawToScalarExponentNumerator;
 	Float32			mRawToScalarExponentDenominator;
+	
+	//	the raw to dB and raw to scalar conversions for every raw value in the curve, indexed by
+	//	the raw value minus the minimum raw value. They're rebuilt whenever the ranges or the
+	//	transfer function change and are empty if there's no curve or it's too large to tabulate.
+	ConversionTable	mRawToDBTable;
+	ConversionTable	mRawToScalarTable;
 
 };
 
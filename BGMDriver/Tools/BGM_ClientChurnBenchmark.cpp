@@ -0,0 +1,511 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+
+//
+//
+//  BGM_ClientChurnBenchmark.cpp
+//  BGMDriver
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  Adds and removes clients from BGM_ClientMap while another thread reads the clients the way the
+//  IO thread does. Built by the portable CMake build (see DEVELOPING.md) as
+//  bgm-client-churn-benchmark.
+//
+//  Usage:
+//
+//      bgm-client-churn-benchmark check
+//          Adds and removes clients at random and checks the lookups by client ID, PID and bundle
+//          ID match a reference model, while a reader thread checks every client it finds is
+//          intact. Exits with an error if anything fails.
+//
+//      bgm-client-churn-benchmark benchmark [clients] [operations per second] [seconds]
+//          With the given number of long-lived clients, adds and removes short-lived clients at
+//          the given rate (by default 10000 a second, like a few Chromium or Electron apps
+//          opening and closing the device) and prints the time each AddClient and RemoveClient
+//          took and the time the IO thread spent reading the clients each cycle.
+//
+
+// Local Includes
+#include "BGM_ClientMap.h"
+#include "BGM_Client.h"
+
+// PublicUtility Includes
+#include "CACFString.h"
+
+// STL Includes
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+static const UInt32 kCheckOperations = 200000;
+// Check the whole registry against the model this often.
+static const UInt32 kCheckFullEvery = 1000;
+static const UInt32 kCheckPIDs = 37;
+static const UInt32 kCheckBundleIDs = 23;
+static const UInt32 kDefaultClients = 200;
+static const UInt32 kDefaultOperationsPerSecond = 10000;
+static const UInt32 kDefaultSeconds = 5;
+// The number of short-lived clients the benchmark keeps around before removing the oldest.
+static const UInt32 kShortLivedClients = 32;
+// The IO thread's cycle, 512 frames at 44.1 kHz.
+static const std::chrono::microseconds kIOCycle(11610);
+
+// Each client's PID and bundle ID are derived from its ID so the reader thread can check them.
+static pid_t PIDForClient(UInt32 inClientID)
+{
+    return static_cast<pid_t>(1000 + inClientID % kCheckPIDs);
+}
+
+// Every seventh PID has no bundle ID, like command-line tools.
+static bool HasBundleID(UInt32 inClientID)
+{
+    return PIDForClient(inClientID) % 7 != 0;
+}
+
+static std::string BundleIDForClient(UInt32 inClientID)
+{
+    return "com.example.app" + std::to_string(PIDForClient(inClientID) % kCheckBundleIDs);
+}
+
+static BGM_Client MakeClient(UInt32 inClientID)
+{
+    AudioServerPlugInClientInfo theClientInfo;
+    theClientInfo.mClientID = inClientID;
+    theClientInfo.mProcessID = PIDForClient(inClientID);
+    theClientInfo.mIsNativeEndian = true;
+    theClientInfo.mBundleID = HasBundleID(inClientID) ?
+            CFStringCreateWithCString(kCFAllocatorDefault,
+                                      BundleIDForClient(inClientID).c_str(),
+                                      kCFStringEncodingUTF8) :
+            nullptr;
+    
+    BGM_Client theClient(&theClientInfo);
+    
+    if(theClientInfo.mBundleID != nullptr)
+    {
+        CFRelease(theClientInfo.mBundleID);
+    }
+    
+    return theClient;
+}
+
+static bool Check(const char* inName, bool inPassed)
+{
+    std::printf("%s: %s\n", inPassed ? "PASS" : "FAIL", inName);
+    return inPassed;
+}
+
+static UInt64 NanosSince(std::chrono::steady_clock::time_point inStart)
+{
+    return static_cast<UInt64>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+                                                                 inStart).count());
+}
+
+#pragma mark Check
+
+// Reads random clients until told to stop, like the IO thread would, and counts the clients it
+// found that didn't have the fields their IDs imply.
+static void ReadClientsUntilStopped(const BGM_ClientMap& inClientMap,
+                                    UInt32 inMaxClientID,
+                                    const std::atomic<bool>& inStop,
+                                    std::atomic<UInt64>& outReads,
+                                    std::atomic<UInt64>& outBadReads)
+{
+    std::mt19937 theRandom(1);
+    
+    while(!inStop)
+    {
+        {
+            BGM_ClientMap::ReaderRT theReader(inClientMap);
+            
+            for(UInt32 i = 0; i < 64; i++)
+            {
+                UInt32 theClientID = 1 + theRandom() % inMaxClientID;
+                const BGM_Client* theClient = inClientMap.GetClientPtrRT(theClientID);
+                
+                if(theClient != nullptr)
+                {
+                    outReads++;
+                    
+                    if(theClient->mClientID != theClientID ||
+                       theClient->mProcessID != PIDForClient(theClientID) ||
+                       theClient->mBundleID.IsValid() != HasBundleID(theClientID))
+                    {
+                        outBadReads++;
+                    }
+                }
+            }
+        }
+        
+        // Let the config thread run between "IO cycles", which matters with only one CPU core.
+        std::this_thread::yield();
+    }
+}
+
+static bool SameIDs(std::vector<UInt32> inActual, std::vector<UInt32> inExpected)
+{
+    std::sort(inActual.begin(), inActual.end());
+    std::sort(inExpected.begin(), inExpected.end());
+    return inActual == inExpected;
+}
+
+// Checks every lookup the config thread can make against the model.
+static bool MatchesModel(const BGM_ClientMap& inClientMap, const std::map<UInt32, bool>& inModel, UInt32 inMaxClientID)
+{
+    if(inClientMap.GetClientCountNonRT() != inModel.size())
+    {
+        std::fprintf(stderr, "%u clients, expected %zu\n", inClientMap.GetClientCountNonRT(), inModel.size());
+        return false;
+    }
+    
+    for(UInt32 theClientID = 1; theClientID <= inMaxClientID; theClientID++)
+    {
+        BGM_Client theClient;
+        bool theFound = inClientMap.GetClientNonRT(theClientID, &theClient);
+        
+        if(theFound != (inModel.count(theClientID) != 0) ||
+           (theFound && theClient.mProcessID != PIDForClient(theClientID)))
+        {
+            std::fprintf(stderr, "Client %u %s\n", theClientID, theFound ? "is wrong" : "is missing");
+            return false;
+        }
+    }
+    
+    for(UInt32 thePID = 0; thePID < kCheckPIDs; thePID++)
+    {
+        std::vector<UInt32> theExpected;
+        
+        for(const auto& theEntry : inModel)
+        {
+            if(PIDForClient(theEntry.first) == static_cast<pid_t>(1000 + thePID))
+            {
+                theExpected.push_back(theEntry.first);
+            }
+        }
+        
+        if(!SameIDs(inClientMap.GetClientIDsNonRT(static_cast<pid_t>(1000 + thePID)), theExpected))
+        {
+            std::fprintf(stderr, "Wrong clients for PID %u\n", 1000 + thePID);
+            return false;
+        }
+    }
+    
+    for(UInt32 theBundle = 0; theBundle < kCheckBundleIDs; theBundle++)
+    {
+        std::string theBundleID = "com.example.app" + std::to_string(theBundle);
+        std::vector<UInt32> theExpected;
+        
+        for(const auto& theEntry : inModel)
+        {
+            if(HasBundleID(theEntry.first) && BundleIDForClient(theEntry.first) == theBundleID)
+            {
+                theExpected.push_back(theEntry.first);
+            }
+        }
+        
+        CACFString theCFBundleID(theBundleID.c_str());
+        
+        if(!SameIDs(inClientMap.GetClientIDsNonRT(theCFBundleID), theExpected) ||
+           inClientMap.HasClientWithBundleID(theCFBundleID) != !theExpected.empty())
+        {
+            std::fprintf(stderr, "Wrong clients for bundle ID %s\n", theBundleID.c_str());
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+static int RunChecks()
+{
+    bool thePassed = true;
+    
+    BGM_ClientMap theClientMap;
+    // The client IDs in the registry. The value is unused.
+    std::map<UInt32, bool> theModel;
+    std::mt19937 theRandom(42);
+    // Enough IDs that the indexes grow and the slots get reused many times.
+    const UInt32 theMaxClientID = 2000;
+    bool theMatched = true;
+    bool theThrew = false;
+    
+    std::atomic<bool> theStop(false);
+    std::atomic<UInt64> theReads(0);
+    std::atomic<UInt64> theBadReads(0);
+    std::thread theReaderThread(ReadClientsUntilStopped,
+                                std::cref(theClientMap),
+                                theMaxClientID,
+                                std::cref(theStop),
+                                std::ref(theReads),
+                                std::ref(theBadReads));
+    
+    try
+    {
+        for(UInt32 i = 0; i < kCheckOperations && theMatched; i++)
+        {
+            UInt32 theClientID = 1 + theRandom() % theMaxClientID;
+            
+            // Grow to about half the IDs, then churn.
+            if(theModel.count(theClientID) == 0)
+            {
+                theClientMap.AddClient(MakeClient(theClientID));
+                theModel[theClientID] = true;
+            }
+            else
+            {
+                BGM_Client theRemoved = theClientMap.RemoveClient(theClientID);
+                theModel.erase(theClientID);
+                
+                if(theRemoved.mClientID != theClientID)
+                {
+                    std::fprintf(stderr, "Removed client %u instead of %u\n", theRemoved.mClientID, theClientID);
+                    theMatched = false;
+                }
+            }
+            
+            if(i % kCheckFullEvery == 0)
+            {
+                theMatched = theMatched && MatchesModel(theClientMap, theModel, theMaxClientID);
+            }
+        }
+        
+        theMatched = theMatched && MatchesModel(theClientMap, theModel, theMaxClientID);
+        
+        // Remove everything, which should leave the indexes empty.
+        while(theMatched && !theModel.empty())
+        {
+            theClientMap.RemoveClient(theModel.begin()->first);
+            theModel.erase(theModel.begin());
+        }
+        
+        theMatched = theMatched && MatchesModel(theClientMap, theModel, theMaxClientID);
+    }
+    catch(...)
+    {
+        theThrew = true;
+    }
+    
+    theStop = true;
+    theReaderThread.join();
+    
+    thePassed &= Check("the registry never threw", !theThrew);
+    thePassed &= Check("the lookups by client ID, PID and bundle ID match the model", theMatched);
+    thePassed &= Check("the reader thread found clients", theReads > 0);
+    thePassed &= Check("every client the reader thread found was intact", theBadReads == 0);
+    
+    // Adding a client twice and removing one that isn't there are errors.
+    bool theDuplicateThrew = false;
+    bool theMissingThrew = false;
+    
+    theClientMap.AddClient(MakeClient(1));
+    
+    try
+    {
+        theClientMap.AddClient(MakeClient(1));
+    }
+    catch(const BGM_InvalidClientException&)
+    {
+        theDuplicateThrew = true;
+    }
+    
+    try
+    {
+        theClientMap.RemoveClient(2);
+    }
+    catch(const BGM_InvalidClientException&)
+    {
+        theMissingThrew = true;
+    }
+    
+    thePassed &= Check("adding a client twice throws", theDuplicateThrew);
+    thePassed &= Check("removing a missing client throws", theMissingThrew);
+    thePassed &= Check("the failed add and remove left the client", theClientMap.GetClientCountNonRT() == 1);
+    
+    return thePassed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#pragma mark Benchmark
+
+static void PrintLatencies(const char* inName, std::vector<UInt64>& ioNanos)
+{
+    if(ioNanos.empty())
+    {
+        return;
+    }
+    
+    std::sort(ioNanos.begin(), ioNanos.end());
+    
+    UInt64 theTotalNanos = 0;
+    
+    for(UInt64 theNanos : ioNanos)
+    {
+        theTotalNanos += theNanos;
+    }
+    
+    auto percentile = [&] (Float64 inPercentile) {
+        return ioNanos[std::min(ioNanos.size() - 1, static_cast<size_t>(ioNanos.size() * inPercentile))];
+    };
+    
+    std::printf("  %-13s %8zu, mean %7llu ns, median %7llu ns, p99 %7llu ns, max %8llu ns\n",
+                inName,
+                ioNanos.size(),
+                theTotalNanos / ioNanos.size(),
+                percentile(0.5),
+                percentile(0.99),
+                ioNanos.back());
+}
+
+static int RunBenchmark(UInt32 inClients, UInt32 inOperationsPerSecond, UInt32 inSeconds)
+{
+    BGM_ClientMap theClientMap;
+    
+    for(UInt32 theClientID = 1; theClientID <= inClients; theClientID++)
+    {
+        theClientMap.AddClient(MakeClient(theClientID));
+    }
+    
+    // The IO thread looks up each long-lived client every cycle, like ProcessOutput does for the
+    // clients doing IO.
+    std::atomic<bool> theStop(false);
+    std::vector<UInt64> theCycleNanos;
+    
+    std::thread theIOThread([&] {
+        auto theNextCycle = std::chrono::steady_clock::now();
+        
+        while(!theStop)
+        {
+            auto theStart = std::chrono::steady_clock::now();
+            {
+                BGM_ClientMap::ReaderRT theReader(theClientMap);
+                
+                for(UInt32 theClientID = 1; theClientID <= inClients; theClientID++)
+                {
+                    if(theClientMap.GetClientPtrRT(theClientID) == nullptr)
+                    {
+                        std::fprintf(stderr, "Client %u is missing\n", theClientID);
+                        std::abort();
+                    }
+                }
+            }
+            theCycleNanos.push_back(NanosSince(theStart));
+            
+            theNextCycle += kIOCycle;
+            std::this_thread::sleep_until(theNextCycle);
+        }
+    });
+    
+    // The config thread alternates between adding a short-lived client and removing the oldest
+    // one, at the given rate.
+    std::vector<UInt64> theAddNanos;
+    std::vector<UInt64> theRemoveNanos;
+    std::deque<UInt32> theShortLivedClients;
+    UInt32 theNextClientID = inClients + 1;
+    const UInt64 theOperations = static_cast<UInt64>(inOperationsPerSecond) * inSeconds;
+    const std::chrono::nanoseconds theInterval(1000000000ULL / std::max(inOperationsPerSecond, 1U));
+    
+    theAddNanos.reserve(theOperations);
+    theRemoveNanos.reserve(theOperations);
+    
+    auto theBenchmarkStart = std::chrono::steady_clock::now();
+    auto theNextOperation = theBenchmarkStart;
+    
+    for(UInt64 i = 0; i < theOperations; i++)
+    {
+        bool theAdd = theShortLivedClients.size() < kShortLivedClients && (i % 2 == 0 || theShortLivedClients.empty());
+        
+        if(theAdd)
+        {
+            BGM_Client theClient = MakeClient(theNextClientID);
+            auto theStart = std::chrono::steady_clock::now();
+            theClientMap.AddClient(theClient);
+            theAddNanos.push_back(NanosSince(theStart));
+            theShortLivedClients.push_back(theNextClientID++);
+        }
+        else
+        {
+            auto theStart = std::chrono::steady_clock::now();
+            theClientMap.RemoveClient(theShortLivedClients.front());
+            theRemoveNanos.push_back(NanosSince(theStart));
+            theShortLivedClients.pop_front();
+        }
+        
+        theNextOperation += theInterval;
+        std::this_thread::sleep_until(theNextOperation);
+    }
+    
+    Float64 theElapsedSeconds = NanosSince(theBenchmarkStart) / 1.0e9;
+    
+    theStop = true;
+    theIOThread.join();
+    
+    UInt64 theLateCycles = 0;
+    const UInt64 theCycleNanosBudget =
+            static_cast<UInt64>(std::chrono::duration_cast<std::chrono::nanoseconds>(kIOCycle).count());
+    
+    for(UInt64 theNanos : theCycleNanos)
+    {
+        theLateCycles += (theNanos > theCycleNanosBudget) ? 1 : 0;
+    }
+    
+    std::printf("%u long-lived clients, %.0f add/remove operations a second for %.1f s:\n",
+                inClients,
+                theOperations / theElapsedSeconds,
+                theElapsedSeconds);
+    PrintLatencies("AddClient", theAddNanos);
+    PrintLatencies("RemoveClient", theRemoveNanos);
+    PrintLatencies("IO cycle", theCycleNanos);
+    std::printf("  %llu IO cycles took longer than their buffer\n", theLateCycles);
+    
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, const char* argv[])
+{
+    const std::string theCommand = (argc > 1) ? argv[1] : "benchmark";
+    
+    if(theCommand == "check" && argc == 2)
+    {
+        return RunChecks();
+    }
+    else if(theCommand == "benchmark" && argc <= 5)
+    {
+        UInt32 theClients =
+                (argc > 2) ? static_cast<UInt32>(std::max(1, std::atoi(argv[2]))) : kDefaultClients;
+        UInt32 theOperationsPerSecond =
+                (argc > 3) ? static_cast<UInt32>(std::max(1, std::atoi(argv[3]))) : kDefaultOperationsPerSecond;
+        UInt32 theSeconds =
+                (argc > 4) ? static_cast<UInt32>(std::max(1, std::atoi(argv[4]))) : kDefaultSeconds;
+        
+        return RunBenchmark(theClients, theOperationsPerSecond, theSeconds);
+    }
+    
+    std::fprintf(stderr,
+                 "Usage: %s check\n"
+                 "       %s benchmark [clients] [operations per second] [seconds]\n",
+                 argv[0], argv[0]);
+    return EXIT_FAILURE;
+}
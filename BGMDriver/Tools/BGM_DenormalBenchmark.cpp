@@ -0,0 +1,308 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+
+//
+//
+//  BGM_DenormalBenchmark.cpp
+//  BGMDriver
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  A portable benchmark showing the cost of subnormal numbers in the driver's per-client DSP, and
+//  that BGM_DSPContext and flushing filter states on silence keep the cost per IO cycle flat when
+//  an app goes quiet. Doesn't need CoreAudio. On macOS:
+//
+//      clang++ -std=c++11 -O2 -I BGMDriver/BGMDriver -I SharedSource -framework Accelerate
+//          BGMDriver/Tools/BGM_DenormalBenchmark.cpp BGMDriver/BGMDriver/BGM_DSPContext.cpp
+//          BGMDriver/BGMDriver/BGM_LoudnessMeter.cpp BGMDriver/BGMDriver/BGM_GainRamp.cpp
+//          -o bgm-denormal-benchmark
+//
+//  Usage:
+//
+//      bgm-denormal-benchmark [buffer frames]
+//
+//  Simulates one client playing a 1 kHz tone that decays exponentially until its samples become
+//  subnormal and then zero, followed by digital silence. Each IO cycle runs a stereo 3-band EQ
+//  (the same filter structure as the per-client EQ in BGM_Device::ApplyClientRelativeVolume) and a
+//  BGM_LoudnessMeter. Prints the average time per cycle over each quarter second of the signal,
+//
+//      - with no protection,
+//      - with a BGM_DSPContext in scope for each cycle, as in BGM_Device::DoIOOperation,
+//      - with the EQ's states flushed while the input is silent, and
+//      - with both, which is what the driver does.
+//
+//  Subnormals are only slow on some CPUs, e.g. most x86 ones, so the unprotected column may be
+//  flat on others. The loudness meter always flushes its states on silence, so that part of the
+//  unprotected cost only comes from its input.
+//
+
+// Local Includes
+#include "BGM_DSPContext.h"
+#include "BGM_LoudnessMeter.h"
+
+// STL Includes
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+
+static const UInt32 kDefaultBufferFrames = 512;
+static const Float64 kSampleRate = 48000.0;
+static const UInt32 kChannels = 2;
+
+// The lengths of the parts of the signal.
+static const Float64 kToneSecs = 1.0;
+static const Float64 kDecaySecs = 2.0;
+static const Float64 kSilenceSecs = 5.0;
+// How often to print the time per cycle.
+static const Float64 kWindowSecs = 0.25;
+// The whole signal is processed this many times and the fastest time for each window is used, to
+// filter out noise from other processes.
+static const UInt32 kRuns = 15;
+
+enum Protection
+{
+    kProtectionNone = 0,
+    kProtectionContext = 1 << 0,
+    kProtectionFlush = 1 << 1,
+    kProtectionBoth = kProtectionContext | kProtectionFlush
+};
+
+// The EQ's filters, in transposed direct form II with the coefficients in the order b0, b1, b2,
+// a1, a2, like BGM_Client's EQ.
+struct EQ
+{
+    static const UInt32 kBands = 3;
+
+    Float32 mCoeffs[kBands][5];
+    Float32 mDelays[kBands][kChannels][2];
+
+    EQ()
+    {
+        // Peaking filters at BGM_Client's EQ frequencies.
+        const Float64 kFrequencies[kBands] = { 250.0, 1000.0, 3000.0 };
+        const Float64 kGainsDB[kBands] = { 6.0, -3.0, 6.0 };
+
+        for(UInt32 theBand = 0; theBand < kBands; theBand++)
+        {
+            const Float64 A = std::pow(10.0, kGainsDB[theBand] / 40.0);
+            const Float64 w0 = 2.0 * M_PI * kFrequencies[theBand] / kSampleRate;
+            const Float64 alpha = std::sin(w0) / (2.0 * 0.5);
+            const Float64 a0 = 1.0 + alpha / A;
+
+            mCoeffs[theBand][0] = static_cast<Float32>((1.0 + alpha * A) / a0);
+            mCoeffs[theBand][1] = static_cast<Float32>(-2.0 * std::cos(w0) / a0);
+            mCoeffs[theBand][2] = static_cast<Float32>((1.0 - alpha * A) / a0);
+            mCoeffs[theBand][3] = mCoeffs[theBand][1];
+            mCoeffs[theBand][4] = static_cast<Float32>((1.0 - alpha / A) / a0);
+        }
+
+        std::fill(&mDelays[0][0][0], &mDelays[0][0][0] + kBands * kChannels * 2, 0.0f);
+    }
+
+    void Process(Float32* ioBuffer, UInt32 inFrameCount, bool inFlushOnSilence)
+    {
+        if(inFlushOnSilence &&
+           BGM_DSPContext::IsSilentRT(ioBuffer, inFrameCount * kChannels) &&
+           BGM_DSPContext::FlushStateRT(&mDelays[0][0][0], kBands * kChannels * 2))
+        {
+            return;
+        }
+
+        for(UInt32 theFrame = 0; theFrame < inFrameCount; theFrame++)
+        {
+            for(UInt32 theChannel = 0; theChannel < kChannels; theChannel++)
+            {
+                Float32 theSample = ioBuffer[theFrame * kChannels + theChannel];
+
+                for(UInt32 theBand = 0; theBand < kBands; theBand++)
+                {
+                    const Float32* c = mCoeffs[theBand];
+                    Float32* d = mDelays[theBand][theChannel];
+
+                    const Float32 theOut = c[0] * theSample + d[0];
+                    d[0] = c[1] * theSample - c[3] * theOut + d[1];
+                    d[1] = c[2] * theSample - c[4] * theOut;
+                    theSample = theOut;
+                }
+
+                ioBuffer[theFrame * kChannels + theChannel] = theSample;
+            }
+        }
+    }
+};
+
+// Fill the buffer with the signal, starting at inStartFrame.
+static void Synthesize(Float32* outBuffer, UInt32 inFrameCount, UInt64 inStartFrame)
+{
+    const UInt64 kToneFrames = static_cast<UInt64>(kToneSecs * kSampleRate);
+    const UInt64 kDecayFrames = static_cast<UInt64>(kDecaySecs * kSampleRate);
+    // Decay from 0 dBFS to below the smallest subnormal Float32, about 1.4e-45, by the end.
+    const Float64 kDecayPerFrame = std::log(1.0e-46) / kDecayFrames;
+
+    for(UInt32 theFrame = 0; theFrame < inFrameCount; theFrame++)
+    {
+        const UInt64 theFrameNumber = inStartFrame + theFrame;
+        Float64 theLevel = 0.0;
+
+        if(theFrameNumber < kToneFrames)
+        {
+            theLevel = 0.5;
+        }
+        else if(theFrameNumber < kToneFrames + kDecayFrames)
+        {
+            theLevel = 0.5 * std::exp(kDecayPerFrame * (theFrameNumber - kToneFrames));
+        }
+
+        const Float32 theSample = static_cast<Float32>(
+                theLevel * std::sin(2.0 * M_PI * 1000.0 * theFrameNumber / kSampleRate));
+
+        for(UInt32 theChannel = 0; theChannel < kChannels; theChannel++)
+        {
+            outBuffer[theFrame * kChannels + theChannel] = theSample;
+        }
+    }
+}
+
+// Process the signal once and add the time taken by each window's cycles to ioWindowNanos, which
+// holds the fastest time seen so far for each window.
+static void Run(UInt32 inBufferFrames,
+                int inProtection,
+                const std::vector<Float32>& inSignal,
+                std::vector<Float64>& ioWindowNanos)
+{
+    EQ theEQ;
+    BGM_LoudnessMeter theMeter(kSampleRate);
+    std::vector<Float32> theBuffer(inBufferFrames * kChannels);
+
+    const UInt32 theCycles = static_cast<UInt32>(inSignal.size() / kChannels / inBufferFrames);
+    const UInt32 theCyclesPerWindow =
+            static_cast<UInt32>(kWindowSecs * kSampleRate / inBufferFrames);
+
+    for(UInt32 theWindow = 0; theWindow < ioWindowNanos.size(); theWindow++)
+    {
+        auto theStart = std::chrono::steady_clock::now();
+
+        for(UInt32 theCycle = theWindow * theCyclesPerWindow;
+            theCycle < (theWindow + 1) * theCyclesPerWindow && theCycle < theCycles;
+            theCycle++)
+        {
+            const Float32* theSource = &inSignal[theCycle * inBufferFrames * kChannels];
+            std::copy(theSource, theSource + inBufferFrames * kChannels, theBuffer.begin());
+
+            if(inProtection & kProtectionContext)
+            {
+                BGM_DSPContext theDSPContext;
+                theEQ.Process(theBuffer.data(), inBufferFrames, inProtection & kProtectionFlush);
+                theMeter.ProcessRT(theBuffer.data(), inBufferFrames);
+            }
+            else
+            {
+                theEQ.Process(theBuffer.data(), inBufferFrames, inProtection & kProtectionFlush);
+                theMeter.ProcessRT(theBuffer.data(), inBufferFrames);
+            }
+        }
+
+        auto theEnd = std::chrono::steady_clock::now();
+
+        const Float64 theNanos =
+                std::chrono::duration<Float64, std::nano>(theEnd - theStart).count() /
+                        theCyclesPerWindow;
+
+        ioWindowNanos[theWindow] = std::min(ioWindowNanos[theWindow], theNanos);
+    }
+}
+
+int main(int argc, const char* argv[])
+{
+    const UInt32 theBufferFrames =
+            (argc > 1) ? static_cast<UInt32>(std::atoi(argv[1])) : kDefaultBufferFrames;
+
+    if(theBufferFrames == 0)
+    {
+        std::fprintf(stderr, "Usage: %s [buffer frames]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    const UInt32 theCyclesPerWindow = static_cast<UInt32>(kWindowSecs * kSampleRate / theBufferFrames);
+    const Float64 theSignalSecs = kToneSecs + kDecaySecs + kSilenceSecs;
+    const UInt32 theWindows = static_cast<UInt32>(theSignalSecs / kWindowSecs);
+
+    if(theCyclesPerWindow == 0)
+    {
+        std::fprintf(stderr, "The buffer is longer than a window (%.2f s)\n", kWindowSecs);
+        return EXIT_FAILURE;
+    }
+
+    std::vector<Float32> theSignal(theWindows * theCyclesPerWindow * theBufferFrames * kChannels);
+    Synthesize(theSignal.data(), theWindows * theCyclesPerWindow * theBufferFrames, 0);
+
+    const int kProtections[] = { kProtectionNone, kProtectionContext, kProtectionFlush, kProtectionBoth };
+    const UInt32 kProtectionCount = sizeof(kProtections) / sizeof(kProtections[0]);
+
+    std::vector<std::vector<Float64>> theWindowNanos(
+            kProtectionCount, std::vector<Float64>(theWindows, HUGE_VAL));
+
+    for(UInt32 theRun = 0; theRun < kRuns; theRun++)
+    {
+        for(UInt32 i = 0; i < kProtectionCount; i++)
+        {
+            Run(theBufferFrames, kProtections[i], theSignal, theWindowNanos[i]);
+        }
+    }
+
+    std::printf("%u-frame buffers at %.0f Hz, ns per cycle:\n\n", theBufferFrames, kSampleRate);
+    std::printf("  time (s)  signal      none   context     flush      both\n");
+
+    for(UInt32 theWindow = 0; theWindow < theWindows; theWindow++)
+    {
+        const Float64 theTime = theWindow * kWindowSecs;
+        const char* theSignalPart = (theTime < kToneSecs) ? "tone" :
+                                    (theTime < kToneSecs + kDecaySecs) ? "decay" : "silence";
+
+        std::printf("  %8.2f  %-7s", theTime, theSignalPart);
+
+        for(UInt32 i = 0; i < kProtectionCount; i++)
+        {
+            std::printf("  %8.0f", theWindowNanos[i][theWindow]);
+        }
+
+        std::printf("\n");
+    }
+
+    // Compare the slowest window to the tone, which has no subnormals.
+    std::printf("\nslowest / tone:   ");
+
+    const UInt32 theToneWindows = static_cast<UInt32>(kToneSecs / kWindowSecs);
+
+    for(UInt32 i = 0; i < kProtectionCount; i++)
+    {
+        const std::vector<Float64>& theNanos = theWindowNanos[i];
+        const Float64 theToneNanos =
+                *std::min_element(theNanos.begin(), theNanos.begin() + theToneWindows);
+        const Float64 theSlowestNanos = *std::max_element(theNanos.begin(), theNanos.end());
+
+        std::printf("  %7.2fx", theSlowestNanos / theToneNanos);
+    }
+
+    std::printf("\n");
+
+    return EXIT_SUCCESS;
+}
+
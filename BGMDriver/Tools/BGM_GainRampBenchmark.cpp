@@ -0,0 +1,304 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_GainRampBenchmark.cpp
+//  BGMDriver
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  Checks and benchmarks BGM_GainRamp. Built by the portable CMake build (see DEVELOPING.md) as
+//  bgm-gain-ramp-benchmark. RampMultiplyRT only uses vDSP on macOS, so elsewhere this exercises
+//  RampMultiplyReferenceRT, the path the XCTests can't run.
+//
+//  Usage:
+//
+//      bgm-gain-ramp-benchmark check
+//          Checks RampMultiplyRT matches RampMultiplyReferenceRT and the per-frame gains the
+//          reference defines, for buffers that aren't a multiple of the SIMD width, and that
+//          ApplyRT's ramps are continuous, reach their targets, take the same time at any sample
+//          rate or buffer size and leave audio at unity gain unchanged. Exits with an error if
+//          anything fails.
+//
+//      bgm-gain-ramp-benchmark benchmark [buffer frames]
+//          Prints the time per stereo buffer of RampMultiplyRT and RampMultiplyReferenceRT with a
+//          ramping and a constant gain, and of ApplyRT while a volume change is ramping.
+//
+
+// Local Includes
+#include "BGM_DSPContext.h"
+#include "BGM_GainRamp.h"
+
+// STL Includes
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <vector>
+
+
+static const UInt32 kChannels = 2;
+static const UInt32 kDefaultBufferFrames = 512;
+// About a minute of audio at 44.1 kHz with 512-frame buffers.
+static const UInt32 kBenchmarkBuffers = 5000;
+static const UInt32 kBenchmarkRuns = 15;
+
+static bool Check(const char* inName, bool inPassed)
+{
+    std::printf("%-6s %s\n", inPassed ? "ok" : "FAILED", inName);
+    return inPassed;
+}
+
+static std::vector<Float32> MakeSignal(UInt32 inFrames)
+{
+    std::vector<Float32> theSignal(inFrames * kChannels);
+
+    for(UInt32 i = 0; i < theSignal.size(); i++)
+    {
+        theSignal[i] = std::sin(static_cast<Float32>(i) * 0.1f);
+    }
+
+    return theSignal;
+}
+
+static bool CheckRampMultiply(UInt32 inFrames)
+{
+    std::vector<Float32> theInput = MakeSignal(inFrames);
+    std::vector<Float32> theOutput = theInput;
+    std::vector<Float32> theReferenceOutput = theInput;
+
+    BGM_GainRamp::RampMultiplyRT(theOutput.data(), inFrames, kChannels, 0.25f, 0.75f);
+    BGM_GainRamp::RampMultiplyReferenceRT(theReferenceOutput.data(), inFrames, kChannels, 0.25f, 0.75f);
+
+    bool theMatchesReference = true;
+    bool theMatchesDefinition = true;
+
+    for(UInt32 theFrame = 0; theFrame < inFrames; theFrame++)
+    {
+        // The gain goes from the start gain to one step short of the end gain.
+        const Float64 theGain = 0.25 + 0.5 * theFrame / inFrames;
+
+        for(UInt32 theChannel = 0; theChannel < kChannels; theChannel++)
+        {
+            const UInt32 i = theFrame * kChannels + theChannel;
+
+            theMatchesReference &= std::fabs(theOutput[i] - theReferenceOutput[i]) <= 1.0e-5f;
+            theMatchesDefinition &= std::fabs(theReferenceOutput[i] - theInput[i] * theGain) <= 1.0e-5;
+        }
+    }
+
+    char theName[128];
+    std::snprintf(theName, sizeof(theName), "RampMultiplyRT matches the reference for %u frames", inFrames);
+    bool thePassed = Check(theName, theMatchesReference);
+    std::snprintf(theName, sizeof(theName), "the reference ramps the gain linearly for %u frames", inFrames);
+    thePassed &= Check(theName, theMatchesDefinition);
+
+    return thePassed;
+}
+
+static bool CheckRampIsContinuousAndReachesTarget()
+{
+    const UInt32 kFrames = 512;
+
+    BGM_GainRamp theRamp(0.0f, 0.01, 48000.0);
+    theRamp.SetTargetGain(1.0f);
+
+    std::vector<Float32> theBuffer(kFrames * kChannels);
+    Float32 thePreviousGain = 0.0f;
+    bool theChannelsMatch = true;
+    bool theIsContinuous = true;
+
+    // Apply the ramp to a buffer of ones so the output is the gain for each sample. The gain should
+    // never jump by more than a small step.
+    for(int theCycle = 0; theCycle < 100; theCycle++)
+    {
+        std::fill(theBuffer.begin(), theBuffer.end(), 1.0f);
+        theRamp.ApplyRT(theBuffer.data(), kFrames);
+
+        for(UInt32 i = 0; i < kFrames; i++)
+        {
+            theChannelsMatch &= (theBuffer[i * kChannels] == theBuffer[i * kChannels + 1]);
+            theIsContinuous &= (theBuffer[i * kChannels] >= thePreviousGain) &&
+                    (theBuffer[i * kChannels] - thePreviousGain < 0.01f);
+            thePreviousGain = theBuffer[i * kChannels];
+        }
+    }
+
+    bool thePassed = Check("both channels get the same gain", theChannelsMatch);
+    thePassed &= Check("the gain is continuous", theIsContinuous);
+    // 100 cycles is more than 100 time constants.
+    thePassed &= Check("the gain reaches its target", thePreviousGain == 1.0f);
+
+    return thePassed;
+}
+
+static bool CheckRampTimeDoesNotDependOnSampleRate()
+{
+    const Float64 kTimeConstantSecs = 0.01;
+
+    // Ramp for one time constant and return the gain at the start of the next buffer.
+    auto theGainAfterOneTimeConstant = [&] (Float64 inSampleRate, UInt32 inFramesPerBuffer) {
+        BGM_GainRamp theRamp(1.0f, kTimeConstantSecs, inSampleRate);
+        theRamp.SetTargetGain(0.0f);
+
+        UInt32 theFramesLeft = static_cast<UInt32>(kTimeConstantSecs * inSampleRate);
+        std::vector<Float32> theBuffer(inFramesPerBuffer * kChannels);
+
+        while(theFramesLeft > 0)
+        {
+            UInt32 theFrames = std::min(theFramesLeft, inFramesPerBuffer);
+            std::fill(theBuffer.begin(), theBuffer.end(), 1.0f);
+            theRamp.ApplyRT(theBuffer.data(), theFrames);
+            theFramesLeft -= theFrames;
+        }
+
+        std::fill(theBuffer.begin(), theBuffer.end(), 1.0f);
+        theRamp.ApplyRT(theBuffer.data(), 1);
+        return theBuffer[0];
+    };
+
+    const Float32 theExpectedGain = std::exp(-1.0f);
+
+    return Check("the ramp time doesn't depend on the sample rate or buffer size",
+                 std::fabs(theGainAfterOneTimeConstant(44100.0, 512) - theExpectedGain) <= 1.0e-3f &&
+                 std::fabs(theGainAfterOneTimeConstant(96000.0, 128) - theExpectedGain) <= 1.0e-3f &&
+                 std::fabs(theGainAfterOneTimeConstant(48000.0, 1) - theExpectedGain) <= 1.0e-3f);
+}
+
+static bool CheckUnityGainLeavesAudioUnchanged()
+{
+    const UInt32 kFrames = 64;
+
+    BGM_GainRamp theRamp(1.0f, 0.01, 44100.0);
+
+    std::vector<Float32> theBuffer(kFrames * kChannels, 0.3f);
+    theRamp.ApplyRT(theBuffer.data(), kFrames);
+
+    return Check("unity gain leaves the audio unchanged",
+                 std::all_of(theBuffer.begin(), theBuffer.end(), [] (Float32 inSample) {
+                     return inSample == 0.3f;
+                 }));
+}
+
+static int RunChecks()
+{
+    bool thePassed = true;
+
+    // Not multiples of the SIMD width, and a single frame.
+    for(UInt32 theFrames : { 1u, 517u, 4096u + 3u })
+    {
+        thePassed &= CheckRampMultiply(theFrames);
+    }
+
+    thePassed &= CheckRampIsContinuousAndReachesTarget();
+    thePassed &= CheckRampTimeDoesNotDependOnSampleRate();
+    thePassed &= CheckUnityGainLeavesAudioUnchanged();
+
+    return thePassed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// Print the median time per buffer of kBenchmarkRuns runs of kBenchmarkBuffers calls to inApply.
+static void Benchmark(const char* inName,
+                      UInt32 inBufferFrames,
+                      const std::function<void(Float32*, UInt32)>& inApply)
+{
+    std::vector<Float32> theBuffer(inBufferFrames * kChannels, 0.5f);
+    std::vector<Float64> theRunNanos;
+
+    // The gains are applied to the same buffer over and over, so its samples can become subnormal.
+    // Flush them to zero like the IO thread does. (See BGM_Device::DoIOOperation.)
+    BGM_DSPContext theDSPContext;
+
+    for(UInt32 theRun = 0; theRun < kBenchmarkRuns; theRun++)
+    {
+        auto theStart = std::chrono::steady_clock::now();
+
+        for(UInt32 i = 0; i < kBenchmarkBuffers; i++)
+        {
+            inApply(theBuffer.data(), inBufferFrames);
+        }
+
+        auto theEnd = std::chrono::steady_clock::now();
+        theRunNanos.push_back(std::chrono::duration<Float64, std::nano>(theEnd - theStart).count() /
+                              kBenchmarkBuffers);
+    }
+
+    std::sort(theRunNanos.begin(), theRunNanos.end());
+    const Float64 theNanos = theRunNanos[theRunNanos.size() / 2];
+
+    std::printf("  %-36s %10.0f %12.2f\n", inName, theNanos, theNanos / inBufferFrames);
+}
+
+static void RunBenchmark(UInt32 inBufferFrames)
+{
+    std::printf("%u-frame stereo buffers (RampMultiplyRT %s):\n\n",
+                inBufferFrames,
+#if defined(__APPLE__)
+                "uses vDSP"
+#else
+                "is the reference"
+#endif
+                );
+    std::printf("  %-36s %10s %12s\n", "", "ns/buffer", "ns/frame");
+
+    Benchmark("RampMultiplyRT, ramping", inBufferFrames, [] (Float32* ioBuffer, UInt32 inFrames) {
+        BGM_GainRamp::RampMultiplyRT(ioBuffer, inFrames, kChannels, 0.999f, 1.0f);
+    });
+    Benchmark("RampMultiplyReferenceRT, ramping", inBufferFrames, [] (Float32* ioBuffer, UInt32 inFrames) {
+        BGM_GainRamp::RampMultiplyReferenceRT(ioBuffer, inFrames, kChannels, 0.999f, 1.0f);
+    });
+    Benchmark("RampMultiplyRT, constant", inBufferFrames, [] (Float32* ioBuffer, UInt32 inFrames) {
+        BGM_GainRamp::RampMultiplyRT(ioBuffer, inFrames, kChannels, 0.999f, 0.999f);
+    });
+    Benchmark("RampMultiplyReferenceRT, constant", inBufferFrames, [] (Float32* ioBuffer, UInt32 inFrames) {
+        BGM_GainRamp::RampMultiplyReferenceRT(ioBuffer, inFrames, kChannels, 0.999f, 0.999f);
+    });
+
+    // Move the target every buffer, so the ramp never settles.
+    BGM_GainRamp theRamp(1.0f, 0.01, 44100.0);
+    bool theGoingDown = true;
+
+    Benchmark("ApplyRT, ramping", inBufferFrames, [&] (Float32* ioBuffer, UInt32 inFrames) {
+        theRamp.SetTargetGain(theGoingDown ? 0.5f : 1.0f);
+        theGoingDown = !theGoingDown;
+        theRamp.ApplyRT(ioBuffer, inFrames);
+    });
+}
+
+int main(int argc, const char* argv[])
+{
+    const std::string theCommand = (argc > 1) ? argv[1] : "benchmark";
+
+    if(theCommand == "check" && argc == 2)
+    {
+        return RunChecks();
+    }
+    else if(theCommand == "benchmark" && argc <= 3)
+    {
+        RunBenchmark((argc > 2) ? static_cast<UInt32>(std::max(1, std::atoi(argv[2]))) : kDefaultBufferFrames);
+        return EXIT_SUCCESS;
+    }
+
+    std::fprintf(stderr,
+                 "Usage: %s check\n"
+                 "       %s benchmark [buffer frames]\n",
+                 argv[0], argv[0]);
+    return EXIT_FAILURE;
+}
+
@@ -0,0 +1,525 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+
+//
+//
+//  BGM_GlitchTelemetryTool.cpp
+//  BGMDriver
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  Prints the glitch telemetry BGMDevice publishes as kAudioDeviceCustomPropertyGlitchTelemetry.
+//  (See BGM_GlitchTelemetry.h.) The JSON output uses the property's dictionary keys, so it can be
+//  collected by monitoring scripts, e.g. to alert on the rate of underruns.
+//
+//  Usage:
+//
+//      bgm-glitch-telemetry [reset] [json]
+//          Prints BGMDevice's telemetry, as JSON with "json". With "reset", resets the counts after
+//          printing them. Only on macOS.
+//
+//      bgm-glitch-telemetry simulate [seconds] [clients] [buffer frames] [json]
+//          Runs IO in real time with the simulated host (see BGM_SimulatedHost.h) and prints its
+//          telemetry.
+//
+//      bgm-glitch-telemetry check
+//          Checks the counters, their windows, the offset histogram and the dictionary format, and
+//          that BGM_IOPipeline counts the glitches it's given. Exits with an error if anything
+//          fails.
+//
+
+// Local Includes
+#include "BGM_GlitchTelemetry.h"
+#include "BGM_SimulatedHost.h"
+#include "BGM_Types.h"
+
+// PublicUtility Includes
+#include "CACFDictionary.h"
+
+// STL Includes
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+// System Includes
+#include <mach/mach_time.h>
+#if __APPLE__
+#include <CoreAudio/AudioHardware.h>
+#endif
+
+
+static const Float64 kSampleRate = 44100.0;
+static const UInt32 kDefaultBufferFrames = 512;
+static const UInt32 kDefaultClients = 4;
+static const UInt32 kCheckThreads = 4;
+static const UInt32 kCheckCountsPerThread = 100000;
+
+#pragma mark Printing
+
+static void PrintCounts(const char* inName, const UInt64* inCounts, bool inLast)
+{
+    std::printf("  \"%s\": {", inName);
+    
+    for(UInt32 i = 0; i < kBGMGlitchCounterCount; i++)
+    {
+        std::printf("%s\"%s\": %llu",
+                    i == 0 ? " " : ", ",
+                    BGM_GlitchTelemetry::GetCounterName(static_cast<BGMGlitchCounter>(i)),
+                    inCounts[i]);
+    }
+    
+    std::printf(" }%s\n", inLast ? "" : ",");
+}
+
+static void PrintJSON(const BGM_GlitchTelemetrySnapshot& inSnapshot)
+{
+    std::printf("{\n");
+    std::printf("  \"%s\": %.3f,\n", kBGMGlitchTelemetryKey_Seconds, inSnapshot.mSeconds);
+    std::printf("  \"%s\": %llu,\n", kBGMGlitchTelemetryKey_Cycles, inSnapshot.mCycles);
+    PrintCounts(kBGMGlitchTelemetryKey_Total, inSnapshot.mTotal, false);
+    PrintCounts(kBGMGlitchTelemetryKey_Last10Seconds, inSnapshot.mLast10Seconds, false);
+    PrintCounts(kBGMGlitchTelemetryKey_Last60Seconds, inSnapshot.mLast60Seconds, false);
+    std::printf("  \"%s\": [", kBGMGlitchTelemetryKey_OffsetHistogram);
+    
+    for(UInt32 i = 0; i < kBGMGlitchOffsetHistogramBuckets; i++)
+    {
+        std::printf("%s%llu", i == 0 ? " " : ", ", inSnapshot.mOffsetHistogram[i]);
+    }
+    
+    std::printf(" ]\n}\n");
+}
+
+static void PrintTable(const BGM_GlitchTelemetrySnapshot& inSnapshot)
+{
+    std::printf("%.1f seconds since reset, %llu IO cycles\n\n", inSnapshot.mSeconds, inSnapshot.mCycles);
+    std::printf("%-20s %12s %12s %12s %16s\n", "", "total", "last 10 s", "last 60 s", "per 1000 cycles");
+    
+    for(UInt32 i = 0; i < kBGMGlitchCounterCount; i++)
+    {
+        std::printf("%-20s %12llu %12llu %12llu %16.3f\n",
+                    BGM_GlitchTelemetry::GetCounterName(static_cast<BGMGlitchCounter>(i)),
+                    inSnapshot.mTotal[i],
+                    inSnapshot.mLast10Seconds[i],
+                    inSnapshot.mLast60Seconds[i],
+                    inSnapshot.mCycles > 0 ? 1000.0 * inSnapshot.mTotal[i] / inSnapshot.mCycles : 0.0);
+    }
+    
+    std::printf("\nInput to output offset (frames):\n");
+    
+    for(UInt32 i = 0; i < kBGMGlitchOffsetHistogramBuckets; i++)
+    {
+        if(inSnapshot.mOffsetHistogram[i] == 0)
+        {
+            continue;
+        }
+        
+        const SInt64 theStart = BGM_GlitchTelemetry::GetOffsetHistogramBucketStart(i);
+        
+        if(i == 0)
+        {
+            std::printf("  %15s %12llu\n", "< 1", inSnapshot.mOffsetHistogram[i]);
+        }
+        else if(i == kBGMGlitchOffsetHistogramBuckets - 1)
+        {
+            std::printf("  %14lld+ %12llu\n", theStart, inSnapshot.mOffsetHistogram[i]);
+        }
+        else
+        {
+            std::string theRange = std::to_string(theStart) + " - " + std::to_string(theStart * 2 - 1);
+            std::printf("  %15s %12llu\n", theRange.c_str(), inSnapshot.mOffsetHistogram[i]);
+        }
+    }
+}
+
+static void Print(const BGM_GlitchTelemetrySnapshot& inSnapshot, bool inJSON)
+{
+    if(inJSON)
+    {
+        PrintJSON(inSnapshot);
+    }
+    else
+    {
+        PrintTable(inSnapshot);
+    }
+}
+
+#pragma mark Device
+
+#if __APPLE__
+static int PrintDevice(bool inJSON, bool inReset)
+{
+    AudioObjectPropertyAddress theAddress = {
+        kAudioHardwarePropertyTranslateUIDToDevice,
+        kAudioObjectPropertyScopeGlobal,
+        kAudioObjectPropertyElementMaster
+    };
+    CFStringRef theUID = CFSTR(kBGMDeviceUID);
+    AudioObjectID theDevice = kAudioObjectUnknown;
+    UInt32 theSize = sizeof(theDevice);
+    
+    OSStatus err = AudioObjectGetPropertyData(kAudioObjectSystemObject,
+                                              &theAddress,
+                                              sizeof(CFStringRef),
+                                              &theUID,
+                                              &theSize,
+                                              &theDevice);
+    
+    if(err != kAudioHardwareNoError || theDevice == kAudioObjectUnknown)
+    {
+        std::fprintf(stderr, "BGMDevice not found (%d)\n", err);
+        return EXIT_FAILURE;
+    }
+    
+    CFDictionaryRef theTelemetryRef = nullptr;
+    theSize = sizeof(theTelemetryRef);
+    err = AudioObjectGetPropertyData(theDevice,
+                                     &kBGMGlitchTelemetryAddress,
+                                     0,
+                                     nullptr,
+                                     &theSize,
+                                     &theTelemetryRef);
+    
+    if(err != kAudioHardwareNoError || theTelemetryRef == nullptr)
+    {
+        std::fprintf(stderr, "Couldn't read the glitch telemetry (%d)\n", err);
+        return EXIT_FAILURE;
+    }
+    
+    CACFDictionary theTelemetry(theTelemetryRef, true);
+    BGM_GlitchTelemetrySnapshot theSnapshot;
+    
+    if(!BGM_GlitchTelemetry::ReadDictionary(theTelemetry, theSnapshot))
+    {
+        std::fprintf(stderr, "The glitch telemetry isn't in the expected format\n");
+        return EXIT_FAILURE;
+    }
+    
+    Print(theSnapshot, inJSON);
+    
+    if(inReset)
+    {
+        CFBooleanRef theReset = kCFBooleanTrue;
+        err = AudioObjectSetPropertyData(theDevice,
+                                         &kBGMGlitchTelemetryAddress,
+                                         0,
+                                         nullptr,
+                                         sizeof(theReset),
+                                         &theReset);
+        
+        if(err != kAudioHardwareNoError)
+        {
+            std::fprintf(stderr, "Couldn't reset the glitch telemetry (%d)\n", err);
+            return EXIT_FAILURE;
+        }
+    }
+    
+    return EXIT_SUCCESS;
+}
+#endif
+
+#pragma mark Simulate
+
+static BGM_SimulatedHost::BGM_OutputGenerator MakeSine(Float64 inFrequency)
+{
+    return [=] (UInt32 inIOBufferFrameSize, Float64 inSampleTime, Float32* outBuffer) {
+        for(UInt32 i = 0; i < inIOBufferFrameSize; i++)
+        {
+            Float32 theSample = 0.1f *
+                    static_cast<Float32>(std::sin(2.0 * M_PI * inFrequency * (inSampleTime + i) / kSampleRate));
+            outBuffer[i * 2] = theSample;
+            outBuffer[i * 2 + 1] = theSample;
+        }
+    };
+}
+
+static void AddClients(BGM_SimulatedHost& ioHost, UInt32 inClients)
+{
+    for(UInt32 i = 1; i <= inClients; i++)
+    {
+        std::string theBundleID = "com.example.client" + std::to_string(i);
+        ioHost.AddClient(i, static_cast<pid_t>(1000 + i), theBundleID.c_str(), MakeSine(110.0 * i));
+        ioHost.StartIO(i);
+    }
+}
+
+static void RemoveClients(BGM_SimulatedHost& ioHost, UInt32 inClients)
+{
+    for(UInt32 i = 1; i <= inClients; i++)
+    {
+        ioHost.RemoveClient(i);
+    }
+}
+
+static int Simulate(Float64 inSeconds, UInt32 inClients, UInt32 inBufferFrames, bool inJSON)
+{
+    BGM_SimulatedHost theHost(kSampleRate, inBufferFrames);
+    AddClients(theHost, inClients);
+    
+    theHost.Run(static_cast<UInt32>(inSeconds * kSampleRate / inBufferFrames), true);
+    Print(theHost.GetIOPipeline().GetGlitchTelemetry().GetSnapshot(), inJSON);
+    
+    RemoveClients(theHost, inClients);
+    
+    return EXIT_SUCCESS;
+}
+
+#pragma mark Check
+
+static bool Check(const char* inName, bool inPassed)
+{
+    std::printf("%-6s %s\n", inPassed ? "ok" : "FAILED", inName);
+    return inPassed;
+}
+
+static bool CheckWindows()
+{
+    bool thePassed = true;
+    
+    mach_timebase_info_data_t theTimebase;
+    mach_timebase_info(&theTimebase);
+    const UInt64 theSecond = 1000000000ULL * theTimebase.denom / theTimebase.numer;
+    // Start on a whole second so the counts are in the seconds they look like they're in.
+    const UInt64 theStart = (mach_absolute_time() / theSecond) * theSecond;
+    
+    BGM_GlitchTelemetry theTelemetry;
+    theTelemetry.Reset(theStart);
+    
+    theTelemetry.CountRT(kBGMGlitchUnderrun, theStart);
+    theTelemetry.CountRT(kBGMGlitchUnderrun, theStart + 5 * theSecond);
+    theTelemetry.CountRT(kBGMGlitchUnderrun, theStart + 30 * theSecond);
+    theTelemetry.CountRT(kBGMGlitchUnderrun, theStart + 30 * theSecond + theSecond / 2);
+    theTelemetry.CountRT(kBGMGlitchLateCycle, theStart + 31 * theSecond);
+    
+    BGM_GlitchTelemetrySnapshot theSnapshot = theTelemetry.GetSnapshot(theStart + 35 * theSecond);
+    thePassed &= Check("the total counts every glitch", theSnapshot.mTotal[kBGMGlitchUnderrun] == 4);
+    thePassed &= Check("the last 10 seconds only count recent glitches",
+                       theSnapshot.mLast10Seconds[kBGMGlitchUnderrun] == 2 &&
+                       theSnapshot.mLast10Seconds[kBGMGlitchLateCycle] == 1);
+    thePassed &= Check("the last 60 seconds count every glitch",
+                       theSnapshot.mLast60Seconds[kBGMGlitchUnderrun] == 4);
+    thePassed &= Check("counters are separate", theSnapshot.mTotal[kBGMGlitchOverrun] == 0);
+    thePassed &= Check("the seconds since reset", std::fabs(theSnapshot.mSeconds - 35.0) < 1.0e-6);
+    
+    // 90 seconds in, the first four underruns are at least a minute old. The windows' slots are
+    // reused after 64 seconds, so the one at 69 seconds also checks that the count from 5 seconds,
+    // which was in the same slot, is replaced.
+    theTelemetry.CountRT(kBGMGlitchUnderrun, theStart + 69 * theSecond);
+    theSnapshot = theTelemetry.GetSnapshot(theStart + 90 * theSecond);
+    thePassed &= Check("old glitches leave the windows",
+                       theSnapshot.mTotal[kBGMGlitchUnderrun] == 5 &&
+                       theSnapshot.mLast10Seconds[kBGMGlitchUnderrun] == 0 &&
+                       theSnapshot.mLast60Seconds[kBGMGlitchUnderrun] == 1);
+    
+    theTelemetry.Reset(theStart + 90 * theSecond);
+    theSnapshot = theTelemetry.GetSnapshot(theStart + 90 * theSecond);
+    thePassed &= Check("reset zeroes the counts",
+                       theSnapshot.mTotal[kBGMGlitchUnderrun] == 0 &&
+                       theSnapshot.mLast60Seconds[kBGMGlitchUnderrun] == 0 &&
+                       theSnapshot.mSeconds == 0.0);
+    
+    return thePassed;
+}
+
+static bool CheckHistogramAndDictionary()
+{
+    bool thePassed = true;
+    
+    thePassed &= Check("offset buckets",
+                       BGM_GlitchTelemetry::GetOffsetHistogramBucket(-512.0) == 0 &&
+                       BGM_GlitchTelemetry::GetOffsetHistogramBucket(0.5) == 0 &&
+                       BGM_GlitchTelemetry::GetOffsetHistogramBucket(1.0) == 1 &&
+                       BGM_GlitchTelemetry::GetOffsetHistogramBucket(511.0) == 9 &&
+                       BGM_GlitchTelemetry::GetOffsetHistogramBucket(512.0) == 10 &&
+                       BGM_GlitchTelemetry::GetOffsetHistogramBucket(1.0e12) ==
+                               kBGMGlitchOffsetHistogramBuckets - 1 &&
+                       BGM_GlitchTelemetry::GetOffsetHistogramBucketStart(10) == 512);
+    
+    BGM_GlitchTelemetry theTelemetry;
+    
+    for(UInt32 i = 0; i < 100; i++)
+    {
+        theTelemetry.CountCycleRT();
+        theTelemetry.RecordOffsetRT(512.0 + i);
+        theTelemetry.CountRT(static_cast<BGMGlitchCounter>(i % kBGMGlitchCounterCount));
+    }
+    
+    BGM_GlitchTelemetrySnapshot theSnapshot = theTelemetry.GetSnapshot();
+    thePassed &= Check("the histogram counts the offsets",
+                       theSnapshot.mOffsetHistogram[10] == 100 && theSnapshot.mCycles == 100);
+    
+    CACFDictionary theDictionary = BGM_GlitchTelemetry::CopyAsDictionary(theSnapshot);
+    BGM_GlitchTelemetrySnapshot theReadSnapshot;
+    bool theRead = BGM_GlitchTelemetry::ReadDictionary(theDictionary, theReadSnapshot);
+    CFRelease(theDictionary.GetDict());
+    
+    thePassed &= Check("the dictionary round trips",
+                       theRead && std::memcmp(&theSnapshot, &theReadSnapshot, sizeof(theSnapshot)) == 0);
+    
+    BGM_GlitchTelemetrySnapshot theSum = theSnapshot;
+    theSum.Add(theSnapshot);
+    thePassed &= Check("snapshots add up",
+                       theSum.mCycles == 200 &&
+                       theSum.mTotal[kBGMGlitchResync] == 2 * theSnapshot.mTotal[kBGMGlitchResync] &&
+                       theSum.mOffsetHistogram[10] == 200);
+    
+    return thePassed;
+}
+
+static bool CheckConcurrentCounts()
+{
+    BGM_GlitchTelemetry theTelemetry;
+    std::vector<std::thread> theThreads;
+    
+    for(UInt32 i = 0; i < kCheckThreads; i++)
+    {
+        theThreads.emplace_back([&theTelemetry] {
+            for(UInt32 j = 0; j < kCheckCountsPerThread; j++)
+            {
+                theTelemetry.CountRT(kBGMGlitchCPUOverload);
+            }
+        });
+    }
+    
+    for(std::thread& theThread : theThreads)
+    {
+        theThread.join();
+    }
+    
+    BGM_GlitchTelemetrySnapshot theSnapshot = theTelemetry.GetSnapshot();
+    
+    return Check("threads counting at the same time aren't lost",
+                 theSnapshot.mTotal[kBGMGlitchCPUOverload] == kCheckThreads * kCheckCountsPerThread &&
+                 theSnapshot.mLast60Seconds[kBGMGlitchCPUOverload] == kCheckThreads * kCheckCountsPerThread);
+}
+
+static bool CheckIOPipeline()
+{
+    bool thePassed = true;
+    
+    BGM_SimulatedHost theHost(kSampleRate, kDefaultBufferFrames);
+    AddClients(theHost, kDefaultClients);
+    
+    // Normal IO shouldn't count any glitches. (Except late cycles, which depend on the machine.)
+    const UInt32 theCycles = 200;
+    theHost.Run(theCycles, false);
+    
+    BGM_GlitchTelemetry& theTelemetry = theHost.GetIOPipeline().GetGlitchTelemetry();
+    BGM_GlitchTelemetrySnapshot theSnapshot = theTelemetry.GetSnapshot();
+    
+    thePassed &= Check("the pipeline counts its cycles", theSnapshot.mCycles == theCycles);
+    thePassed &= Check("normal IO doesn't glitch",
+                       theSnapshot.mTotal[kBGMGlitchUnderrun] == 0 &&
+                       theSnapshot.mTotal[kBGMGlitchOverrun] == 0 &&
+                       theSnapshot.mTotal[kBGMGlitchResync] == 0 &&
+                       theSnapshot.mTotal[kBGMGlitchCPUOverload] == 0);
+    thePassed &= Check("the offsets are one buffer",
+                       theSnapshot.mOffsetHistogram[BGM_GlitchTelemetry::GetOffsetHistogramBucket(kDefaultBufferFrames)] ==
+                               theCycles);
+    
+    // Read ahead of the mix and from long before it.
+    std::vector<Float32> theBuffer(kDefaultBufferFrames * 2);
+    AudioTimeStamp theOutputTime = {};
+    theOutputTime.mSampleTime = theHost.GetSampleTime();
+    theOutputTime.mFlags = kAudioTimeStampSampleTimeValid;
+    theHost.GetIOPipeline().ReadInputRT(1,
+                                        kDefaultBufferFrames,
+                                        theHost.GetSampleTime(),
+                                        theOutputTime,
+                                        theBuffer.data());
+    theHost.GetIOPipeline().ReadInputRT(1,
+                                        kDefaultBufferFrames,
+                                        theHost.GetSampleTime() - 2 * kLoopbackRingBufferFrameSize,
+                                        theOutputTime,
+                                        theBuffer.data());
+    // Skip a cycle.
+    theHost.GetIOPipeline().WriteMixRT(kDefaultBufferFrames,
+                                       theHost.GetSampleTime() + kDefaultBufferFrames,
+                                       theBuffer.data());
+    
+    theSnapshot = theTelemetry.GetSnapshot();
+    thePassed &= Check("reading ahead of the mix is an underrun", theSnapshot.mTotal[kBGMGlitchUnderrun] == 1);
+    thePassed &= Check("reading overwritten audio is an overrun", theSnapshot.mTotal[kBGMGlitchOverrun] == 1);
+    thePassed &= Check("skipping a cycle is a resync", theSnapshot.mTotal[kBGMGlitchResync] == 1);
+    
+    RemoveClients(theHost, kDefaultClients);
+    
+    return thePassed;
+}
+
+static int RunChecks()
+{
+    bool thePassed = true;
+    
+    thePassed &= CheckWindows();
+    thePassed &= CheckHistogramAndDictionary();
+    thePassed &= CheckConcurrentCounts();
+    thePassed &= CheckIOPipeline();
+    
+    return thePassed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int main(int argc, const char* argv[])
+{
+    std::vector<std::string> theArgs(argv + 1, argv + argc);
+    
+    // "json" can go at the end of any of the commands that print.
+    const bool theJSON = !theArgs.empty() && theArgs.back() == "json";
+    
+    if(theJSON)
+    {
+        theArgs.pop_back();
+    }
+    
+    auto theNumberArg = [&] (size_t inArgIndex, UInt32 inDefault) {
+        return (theArgs.size() > inArgIndex) ?
+                static_cast<UInt32>(std::max(1, std::atoi(theArgs[inArgIndex].c_str()))) :
+                inDefault;
+    };
+    
+    if(theArgs.empty() || (theArgs.size() == 1 && theArgs[0] == "reset"))
+    {
+#if __APPLE__
+        return PrintDevice(theJSON, !theArgs.empty());
+#else
+        std::fprintf(stderr, "Reading BGMDevice's telemetry is only supported on macOS. Try \"simulate\".\n");
+        return EXIT_FAILURE;
+#endif
+    }
+    else if(theArgs[0] == "simulate" && theArgs.size() <= 4)
+    {
+        return Simulate((theArgs.size() > 1) ? std::atof(theArgs[1].c_str()) : 5.0,
+                        theNumberArg(2, kDefaultClients),
+                        theNumberArg(3, kDefaultBufferFrames),
+                        theJSON);
+    }
+    else if(theArgs[0] == "check" && theArgs.size() == 1 && !theJSON)
+    {
+        return RunChecks();
+    }
+    
+    std::fprintf(stderr,
+                 "Usage: %s [reset] [json]\n"
+                 "       %s simulate [seconds] [clients] [buffer frames] [json]\n"
+                 "       %s check\n",
+                 argv[0], argv[0], argv[0]);
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,388 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_IOTraceReplay.cpp
+//  BGMDriver
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  Replays a trace recorded by BGM_IOTraceRecorder (see BGM_IOTrace.h) through the driver's core
+//  under BGM_SimulatedHost. The operations are replayed back to back in the order they were
+//  recorded, with the recorded buffer sizes, sample times and audio, so the replay is the same
+//  every time. That makes it useful for profiling a problem with perf or valgrind, and as a
+//  regression test.
+//
+//  Usage:
+//
+//      bgm-io-trace-replay <trace file> [verify]
+//          Prints the time spent in each type of IO operation and a checksum of the audio the core
+//          produced. With "verify", also checks the audio matches the audio in the trace exactly,
+//          which requires a trace recorded with audio, and exits with an error if it doesn't.
+//
+
+// Local Includes
+#include "BGM_DSPContext.h"
+#include "BGM_IOTrace.h"
+#include "BGM_SimulatedHost.h"
+
+// PublicUtility Includes
+#include "CAException.h"
+#include "CAHostTimeBase.h"
+
+// STL Includes
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+
+// The time spent replaying one type of IO operation.
+struct BGM_OperationStats
+{
+    UInt64  mCount = 0;
+    UInt64  mTotalNanos = 0;
+    UInt64  mMaxNanos = 0;
+};
+
+struct BGM_ReplayState
+{
+    BGM_ReplayState(Float64 inSampleRate, bool inVerify) : mHost(inSampleRate), mVerify(inVerify) { }
+    
+    BGM_SimulatedHost                       mHost;
+    const bool                              mVerify;
+    std::set<UInt32>                        mClients;
+    std::set<UInt32>                        mClientsDoingIO;
+    std::vector<Float32>                    mBuffer;
+    std::map<UInt32, BGM_OperationStats>    mStats;
+    // The output sample time of the cycle being replayed.
+    Float64                                 mCycleOutputSampleTime = -1.0;
+    // FNV-1a of the audio the core produced.
+    UInt64                                  mChecksum = 14695981039346656037ULL;
+    UInt64                                  mComparisons = 0;
+    UInt64                                  mMismatches = 0;
+};
+
+static const char* OperationName(UInt32 inOperationID)
+{
+    switch(inOperationID)
+    {
+        case kAudioServerPlugInIOOperationReadInput: return "ReadInput";
+        case kAudioServerPlugInIOOperationProcessOutput: return "ProcessOutput";
+        case kAudioServerPlugInIOOperationProcessMix: return "ProcessMix";
+        case kAudioServerPlugInIOOperationWriteMix: return "WriteMix";
+        default: return "other";
+    }
+}
+
+static void UpdateChecksum(BGM_ReplayState& ioState, const std::vector<Float32>& inAudio)
+{
+    const UInt8* theBytes = reinterpret_cast<const UInt8*>(inAudio.data());
+    
+    for(size_t i = 0; i < inAudio.size() * sizeof(Float32); i++)
+    {
+        ioState.mChecksum = (ioState.mChecksum ^ theBytes[i]) * 1099511628211ULL;
+    }
+}
+
+// Compare the audio the core produced with the recorded audio, bit for bit.
+static void Verify(BGM_ReplayState& ioState,
+                   const BGM_IOTraceRecord& inRecord,
+                   const std::vector<UInt8>& inPayload)
+{
+    if(!ioState.mVerify || inPayload.empty())
+    {
+        return;
+    }
+    
+    ioState.mComparisons++;
+    
+    if(inPayload.size() != ioState.mBuffer.size() * sizeof(Float32) ||
+       memcmp(inPayload.data(), ioState.mBuffer.data(), inPayload.size()) != 0)
+    {
+        if(ioState.mMismatches == 0)
+        {
+            std::fprintf(stderr,
+                         "%s for client %u at sample time %.0f doesn't match the trace\n",
+                         OperationName(inRecord.mOperationID),
+                         inRecord.mClientID,
+                         inRecord.mOutputSampleTime);
+        }
+        
+        ioState.mMismatches++;
+    }
+}
+
+// Clients that were added before the trace started recording won't have ClientAdded records.
+static void AddClientIfNeeded(BGM_ReplayState& ioState, UInt32 inClientID, pid_t inProcessID, const char* inBundleID)
+{
+    if(ioState.mClients.insert(inClientID).second)
+    {
+        ioState.mHost.AddClient(inClientID, inProcessID, inBundleID, nullptr);
+    }
+}
+
+static void StartIOIfNeeded(BGM_ReplayState& ioState, UInt32 inClientID)
+{
+    AddClientIfNeeded(ioState, inClientID, 0, nullptr);
+    
+    if(ioState.mClientsDoingIO.insert(inClientID).second)
+    {
+        ioState.mHost.StartIO(inClientID);
+    }
+}
+
+static void ReplayOperation(BGM_ReplayState& ioState,
+                            const BGM_IOTraceRecord& inRecord,
+                            const std::vector<UInt8>& inPayload)
+{
+    AudioServerPlugInIOCycleInfo theCycleInfo = {};
+    theCycleInfo.mIOCycleCounter = inRecord.mIOCycleCounter;
+    theCycleInfo.mNominalIOBufferFrameSize = inRecord.mIOBufferFrameSize;
+    theCycleInfo.mInputTime.mSampleTime = inRecord.mInputSampleTime;
+    theCycleInfo.mInputTime.mFlags = kAudioTimeStampSampleTimeValid;
+    theCycleInfo.mOutputTime.mSampleTime = inRecord.mOutputSampleTime;
+    theCycleInfo.mOutputTime.mHostTime = inRecord.mOutputHostTime;
+    theCycleInfo.mOutputTime.mFlags = inRecord.mOutputTimeFlags;
+    
+    // The operation's input audio, or silence if the trace doesn't have audio.
+    ioState.mBuffer.assign(inRecord.mIOBufferFrameSize * 2, 0.0f);
+    
+    if(inRecord.mOperationID != kAudioServerPlugInIOOperationReadInput &&
+       inPayload.size() == ioState.mBuffer.size() * sizeof(Float32))
+    {
+        memcpy(ioState.mBuffer.data(), inPayload.data(), inPayload.size());
+    }
+    
+    if(inRecord.mOperationID == kAudioServerPlugInIOOperationReadInput ||
+       inRecord.mOperationID == kAudioServerPlugInIOOperationProcessOutput)
+    {
+        StartIOIfNeeded(ioState, inRecord.mClientID);
+    }
+    
+    if(inRecord.mOutputSampleTime != ioState.mCycleOutputSampleTime)
+    {
+        // Replay the cycle as if it had started on time, i.e. one buffer before its deadline, so
+        // its DSP budget only counts the time the replay takes. The recorded host times are long
+        // past.
+        ioState.mCycleOutputSampleTime = inRecord.mOutputSampleTime;
+        
+        const UInt64 theBufferHostTicks = static_cast<UInt64>(
+                inRecord.mIOBufferFrameSize / ioState.mHost.GetSampleRate() * CAHostTimeBase::GetFrequency());
+        const bool theTraceHasHostTime = (inRecord.mOutputTimeFlags & kAudioTimeStampHostTimeValid) &&
+                inRecord.mOutputHostTime > theBufferHostTicks;
+        
+        ioState.mHost.StartCycleClock(theTraceHasHostTime ? inRecord.mOutputHostTime - theBufferHostTicks : 0);
+    }
+    
+    BGM_IOPipeline& thePipeline = ioState.mHost.GetIOPipeline();
+    auto theStartTime = std::chrono::steady_clock::now();
+    
+    {
+        // Like BGM_Device::DoIOOperation.
+        BGM_DSPContext theDSPContext;
+        
+        switch(inRecord.mOperationID)
+        {
+            case kAudioServerPlugInIOOperationReadInput:
+                thePipeline.ReadInputRT(inRecord.mClientID,
+                                        inRecord.mIOBufferFrameSize,
+                                        inRecord.mInputSampleTime,
+                                        theCycleInfo.mOutputTime,
+                                        ioState.mBuffer.data());
+                break;
+                
+            case kAudioServerPlugInIOOperationProcessOutput:
+                thePipeline.ProcessOutputRT(inRecord.mClientID,
+                                            inRecord.mIOBufferFrameSize,
+                                            theCycleInfo.mOutputTime,
+                                            ioState.mBuffer.data());
+                break;
+                
+            case kAudioServerPlugInIOOperationWriteMix:
+                thePipeline.WriteMixRT(inRecord.mIOBufferFrameSize,
+                                       inRecord.mOutputSampleTime,
+                                       ioState.mBuffer.data());
+                break;
+                
+            default:
+                // ProcessMix only applies the device's volume control, which isn't part of the
+                // core.
+                return;
+        }
+    }
+    
+    UInt64 theNanos = static_cast<UInt64>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+                                                                 theStartTime).count());
+    
+    BGM_OperationStats& theStats = ioState.mStats[inRecord.mOperationID];
+    theStats.mCount++;
+    theStats.mTotalNanos += theNanos;
+    theStats.mMaxNanos = std::max(theStats.mMaxNanos, theNanos);
+    
+    if(inRecord.mOperationID == kAudioServerPlugInIOOperationReadInput)
+    {
+        UpdateChecksum(ioState, ioState.mBuffer);
+        Verify(ioState, inRecord, inPayload);
+    }
+    else if(inRecord.mOperationID == kAudioServerPlugInIOOperationProcessOutput)
+    {
+        UpdateChecksum(ioState, ioState.mBuffer);
+    }
+}
+
+static int Replay(const char* inTracePath, bool inVerify)
+{
+    try
+    {
+        BGM_IOTraceReader theReader(inTracePath);
+        const BGM_IOTraceFileHeader& theHeader = theReader.GetFileHeader();
+        const bool theTraceHasAudio = (theHeader.mFlags & kBGMIOTraceFileFlagHasAudio) != 0;
+        
+        if(inVerify && !theTraceHasAudio)
+        {
+            std::fprintf(stderr, "%s was recorded without audio, so it can't be verified\n", inTracePath);
+            return EXIT_FAILURE;
+        }
+        
+        if(theHeader.mDroppedRecords > 0)
+        {
+            std::fprintf(stderr,
+                         "Warning: %u records were dropped while recording %s\n",
+                         theHeader.mDroppedRecords,
+                         inTracePath);
+        }
+        
+        BGM_ReplayState theState(theHeader.mSampleRate, inVerify);
+        BGM_IOTraceRecord theRecord;
+        std::vector<UInt8> thePayload;
+        UInt64 theRecords = 0;
+        
+        while(theReader.ReadRecord(theRecord, thePayload))
+        {
+            theRecords++;
+            
+            switch(theRecord.mType)
+            {
+                case kBGMIOTraceRecordClientAdded:
+                    {
+                        SInt32 theProcessID = 0;
+                        
+                        if(thePayload.size() >= sizeof(theProcessID))
+                        {
+                            memcpy(&theProcessID, thePayload.data(), sizeof(theProcessID));
+                        }
+                        
+                        std::string theBundleID(thePayload.begin() + std::min(thePayload.size(), sizeof(theProcessID)),
+                                                thePayload.end());
+                        
+                        AddClientIfNeeded(theState,
+                                          theRecord.mClientID,
+                                          theProcessID,
+                                          theBundleID.empty() ? nullptr : theBundleID.c_str());
+                    }
+                    break;
+                    
+                case kBGMIOTraceRecordClientRemoved:
+                    if(theState.mClients.erase(theRecord.mClientID) != 0)
+                    {
+                        theState.mClientsDoingIO.erase(theRecord.mClientID);
+                        theState.mHost.RemoveClient(theRecord.mClientID);
+                    }
+                    break;
+                    
+                case kBGMIOTraceRecordBeginOperation:
+                    if(theRecord.mOperationID == kAudioServerPlugInIOOperationThread)
+                    {
+                        StartIOIfNeeded(theState, theRecord.mClientID);
+                    }
+                    break;
+                    
+                case kBGMIOTraceRecordEndOperation:
+                    if(theRecord.mOperationID == kAudioServerPlugInIOOperationThread &&
+                       theState.mClientsDoingIO.erase(theRecord.mClientID) != 0)
+                    {
+                        theState.mHost.StopIO(theRecord.mClientID);
+                    }
+                    break;
+                    
+                case kBGMIOTraceRecordDoOperation:
+                    ReplayOperation(theState, theRecord, thePayload);
+                    break;
+                    
+                case kBGMIOTraceRecordOperationResult:
+                    // Compare with the audio the last ProcessOutput produced.
+                    Verify(theState, theRecord, thePayload);
+                    break;
+            }
+        }
+        
+        std::printf("%llu records, %.0f Hz%s\n",
+                    theRecords,
+                    theHeader.mSampleRate,
+                    theTraceHasAudio ? ", with audio" : "");
+        
+        for(const auto& theStats : theState.mStats)
+        {
+            std::printf("  %-14s %8llu ops, %8.0f ns mean, %8llu ns worst\n",
+                        OperationName(theStats.first),
+                        theStats.second.mCount,
+                        static_cast<Float64>(theStats.second.mTotalNanos) / theStats.second.mCount,
+                        theStats.second.mMaxNanos);
+        }
+        
+        std::printf("Checksum: %016llx\n", theState.mChecksum);
+        
+        if(inVerify)
+        {
+            std::printf("Verified %llu buffers, %llu mismatched\n", theState.mComparisons, theState.mMismatches);
+            
+            if(theState.mMismatches > 0 || theState.mComparisons == 0)
+            {
+                return EXIT_FAILURE;
+            }
+        }
+    }
+    catch(const CAException& inException)
+    {
+        std::fprintf(stderr, "Couldn't replay %s (error %d)\n", inTracePath, static_cast<int>(inException.GetError()));
+        return EXIT_FAILURE;
+    }
+    
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, const char* argv[])
+{
+    if(argc == 2)
+    {
+        return Replay(argv[1], false);
+    }
+    else if(argc == 3 && std::string(argv[2]) == "verify")
+    {
+        return Replay(argv[1], true);
+    }
+    
+    std::fprintf(stderr, "Usage: %s <trace file> [verify]\n", argv[0]);
+    return EXIT_FAILURE;
+}
+
@@ -0,0 +1,356 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_LoudnessConformance.cpp
+//  BGMDriver
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  A portable conformance test and benchmark for BGM_LoudnessMeter. Doesn't need CoreAudio. On
+//  macOS:
+//
+//      clang++ -std=c++11 -O2 -I BGMDriver/BGMDriver -I SharedSource -framework Accelerate
+//          BGMDriver/Tools/BGM_LoudnessConformance.cpp BGMDriver/BGMDriver/BGM_LoudnessMeter.cpp
+//          BGMDriver/BGMDriver/BGM_GainRamp.cpp BGMDriver/BGMDriver/BGM_DSPContext.cpp
+//          -o bgm-loudness-conformance
+//
+//  Usage:
+//
+//      bgm-loudness-conformance [test]
+//          Measures the EBU Tech 3341 minimum requirements test signals that can be synthesized
+//          (1 kHz stereo sine sequences) at 44.1 kHz and 48 kHz, and checks the results are within
+//          the specification's +/-0.1 LU tolerance. Also checks the K-weighting filters against
+//          the 48 kHz coefficients given in ITU-R BS.1770. Exits with an error if anything fails.
+//
+//      bgm-loudness-conformance measure <WAV file> [buffer frames]
+//          Prints the maximum momentary and short-term loudness and the integrated loudness of the
+//          file, e.g. one of the EBU's reference files, which can't be redistributed here.
+//
+//      bgm-loudness-conformance benchmark [buffer frames]
+//          Prints the average time ProcessRT takes per IO cycle.
+//
+
+// Local Includes
+#include "BGM_LoudnessMeter.h"
+#include "BGM_WAVFile.h"
+
+// STL Includes
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+
+static const UInt32 kDefaultBufferFrames = 512;
+static const Float32 kToleranceLU = 0.1f;
+
+// The loudness values after a whole signal has been measured.
+struct Measurement
+{
+    Float32 mMaxMomentaryLUFS = kBGMLoudnessMinLUFS;
+    Float32 mMaxShortTermLUFS = kBGMLoudnessMinLUFS;
+    // The range of the short-term loudness once the short-term window was full.
+    Float32 mMinFullShortTermLUFS = -kBGMLoudnessMinLUFS;
+    Float32 mMaxFullShortTermLUFS = kBGMLoudnessMinLUFS;
+    Float32 mIntegratedLUFS = kBGMLoudnessMinLUFS;
+};
+
+static Measurement Measure(const Clip& inClip, UInt32 inBufferFrames)
+{
+    BGM_LoudnessMeter theMeter(inClip.mSampleRate);
+    Measurement theMeasurement;
+
+    // The meter applies the normalization gain in place, so measure a copy.
+    std::vector<Float32> theBuffer(inBufferFrames * 2);
+
+    for(UInt32 theFrame = 0; theFrame < inClip.GetFrameCount(); theFrame += inBufferFrames)
+    {
+        const UInt32 theFrames = std::min(inBufferFrames, inClip.GetFrameCount() - theFrame);
+        std::copy(inClip.mSamples.begin() + theFrame * 2,
+                  inClip.mSamples.begin() + (theFrame + theFrames) * 2,
+                  theBuffer.begin());
+
+        theMeter.ProcessRT(theBuffer.data(), theFrames);
+
+        theMeasurement.mMaxMomentaryLUFS = std::max(theMeasurement.mMaxMomentaryLUFS,
+                                                    theMeter.GetMomentaryLUFS());
+        theMeasurement.mMaxShortTermLUFS = std::max(theMeasurement.mMaxShortTermLUFS,
+                                                    theMeter.GetShortTermLUFS());
+
+        if(theFrame + theFrames >= 3.0 * inClip.mSampleRate)
+        {
+            theMeasurement.mMinFullShortTermLUFS = std::min(theMeasurement.mMinFullShortTermLUFS,
+                                                            theMeter.GetShortTermLUFS());
+            theMeasurement.mMaxFullShortTermLUFS = std::max(theMeasurement.mMaxFullShortTermLUFS,
+                                                            theMeter.GetShortTermLUFS());
+        }
+    }
+
+    theMeasurement.mIntegratedLUFS = theMeter.GetIntegratedLUFS();
+    return theMeasurement;
+}
+
+#pragma mark Test Signals
+
+// A 1 kHz sine in both channels, as a sequence of levels in dBFS and their durations.
+struct Segment
+{
+    Float64 mLevelDBFS;
+    Float64 mSecs;
+};
+
+static Clip MakeSineSequence(Float64 inSampleRate, const std::vector<Segment>& inSegments)
+{
+    Clip theClip;
+    theClip.mSampleRate = inSampleRate;
+
+    UInt64 theFrame = 0;
+
+    for(const Segment& theSegment : inSegments)
+    {
+        const Float64 theAmplitude = std::pow(10.0, theSegment.mLevelDBFS / 20.0);
+        const UInt64 theEndFrame = theFrame + static_cast<UInt64>(std::llround(theSegment.mSecs * inSampleRate));
+
+        for(; theFrame < theEndFrame; theFrame++)
+        {
+            const Float32 theSample =
+                    static_cast<Float32>(theAmplitude * std::sin(2.0 * M_PI * 1000.0 * theFrame / inSampleRate));
+            theClip.mSamples.push_back(theSample);
+            theClip.mSamples.push_back(theSample);
+        }
+    }
+
+    return theClip;
+}
+
+static bool Check(const char* inName, const char* inValueName, Float32 inValue, Float32 inExpected)
+{
+    const bool thePassed = std::fabs(inValue - inExpected) <= kToleranceLU;
+
+    std::printf("%-6s %-44s %-14s %7.2f (expected %.1f)\n",
+                thePassed ? "ok" : "FAILED",
+                inName,
+                inValueName,
+                inValue,
+                inExpected);
+
+    return thePassed;
+}
+
+static int Test(UInt32 inBufferFrames)
+{
+    bool thePassed = true;
+
+    // The 48 kHz coefficients from ITU-R BS.1770-4, table 1 and table 2.
+    {
+        const BGM_LoudnessMeter::Coefficients theExpectedHighShelf = {
+            1.53512485958697, -2.69169618940638, 1.19839281085285, -1.69065929318241, 0.73248077421585
+        };
+        const BGM_LoudnessMeter::Coefficients theExpectedHighPass = {
+            1.0, -2.0, 1.0, -1.99004745483398, 0.99007225036621
+        };
+
+        BGM_LoudnessMeter::Coefficients theHighShelf;
+        BGM_LoudnessMeter::Coefficients theHighPass;
+        BGM_LoudnessMeter::CalculateKWeighting(48000.0, theHighShelf, theHighPass);
+
+        Float64 theMaxError = 0.0;
+        for(int i = 0; i < 5; i++)
+        {
+            theMaxError = std::max(theMaxError, std::fabs(theHighShelf[i] - theExpectedHighShelf[i]));
+            theMaxError = std::max(theMaxError, std::fabs(theHighPass[i] - theExpectedHighPass[i]));
+        }
+
+        const bool theCoefficientsPassed = theMaxError < 1.0e-8;
+        std::printf("%-6s %-44s %-14s %7.1e\n",
+                    theCoefficientsPassed ? "ok" : "FAILED",
+                    "BS.1770 K-weighting coefficients at 48 kHz",
+                    "max error",
+                    theMaxError);
+        thePassed = thePassed && theCoefficientsPassed;
+    }
+
+    struct TestCase
+    {
+        const char*             mName;
+        std::vector<Segment>    mSegments;
+        Float32                 mExpectedLUFS;
+        bool                    mChecksMomentary;
+        bool                    mChecksShortTerm;
+        bool                    mChecksIntegrated;
+    };
+
+    // A 1 kHz sine at -23 dBFS in both channels is -23 LUFS.
+    const std::vector<TestCase> theTestCases = {
+        { "Tech 3341 #1: -23 dBFS, 20 s",
+          { { -23.0, 20.0 } }, -23.0f, true, true, true },
+        { "Tech 3341 #2: -33 dBFS, 20 s",
+          { { -33.0, 20.0 } }, -33.0f, true, true, true },
+        { "Tech 3341 #3: relative gate",
+          { { -36.0, 10.0 }, { -23.0, 60.0 }, { -36.0, 10.0 } }, -23.0f, false, false, true },
+        { "Tech 3341 #4: absolute and relative gates",
+          { { -72.0, 10.0 }, { -36.0, 10.0 }, { -23.0, 60.0 }, { -36.0, 10.0 }, { -72.0, 10.0 } },
+          -23.0f, false, false, true },
+        { "Tech 3341 #5: -26, -20, -26 dBFS",
+          { { -26.0, 20.0 }, { -20.0, 20.1 }, { -26.0, 20.0 } }, -23.0f, false, false, true },
+    };
+
+    for(Float64 theSampleRate : { 44100.0, 48000.0 })
+    {
+        std::printf("\n%.1f kHz, %u-frame buffers\n", theSampleRate / 1000.0, inBufferFrames);
+
+        for(const TestCase& theCase : theTestCases)
+        {
+            const Measurement theMeasurement =
+                    Measure(MakeSineSequence(theSampleRate, theCase.mSegments), inBufferFrames);
+
+            if(theCase.mChecksMomentary)
+            {
+                thePassed = Check(theCase.mName, "momentary", theMeasurement.mMaxMomentaryLUFS, theCase.mExpectedLUFS) && thePassed;
+            }
+
+            if(theCase.mChecksShortTerm)
+            {
+                thePassed = Check(theCase.mName, "short-term", theMeasurement.mMaxShortTermLUFS, theCase.mExpectedLUFS) && thePassed;
+            }
+
+            if(theCase.mChecksIntegrated)
+            {
+                thePassed = Check(theCase.mName, "integrated", theMeasurement.mIntegratedLUFS, theCase.mExpectedLUFS) && thePassed;
+            }
+        }
+
+        // Tech 3341 #9: 1.34 s at -20 dBFS and 1.66 s at -30 dBFS, 5 times. Every 3 s short-term
+        // window has the same mix of the two, so the short-term loudness should stay at -23 LUFS.
+        std::vector<Segment> theAlternating;
+        for(int i = 0; i < 5; i++)
+        {
+            theAlternating.push_back({ -20.0, 1.34 });
+            theAlternating.push_back({ -30.0, 1.66 });
+        }
+
+        const Measurement theMeasurement = Measure(MakeSineSequence(theSampleRate, theAlternating), inBufferFrames);
+        thePassed = Check("Tech 3341 #9: alternating -20, -30 dBFS", "short-term min", theMeasurement.mMinFullShortTermLUFS, -23.0f) && thePassed;
+        thePassed = Check("Tech 3341 #9: alternating -20, -30 dBFS", "short-term max", theMeasurement.mMaxFullShortTermLUFS, -23.0f) && thePassed;
+    }
+
+    std::printf("\n%s\n", thePassed ? "All tests passed" : "Some tests FAILED");
+    return thePassed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#pragma mark Measure
+
+static int MeasureFile(const std::string& inPath, UInt32 inBufferFrames)
+{
+    Clip theClip;
+
+    if(!ReadWAV(inPath, theClip))
+    {
+        std::fprintf(stderr, "Couldn't read %s\n", inPath.c_str());
+        return EXIT_FAILURE;
+    }
+
+    const Measurement theMeasurement = Measure(theClip, inBufferFrames);
+
+    std::printf("max momentary:  %7.2f LUFS\n", theMeasurement.mMaxMomentaryLUFS);
+    std::printf("max short-term: %7.2f LUFS\n", theMeasurement.mMaxShortTermLUFS);
+    std::printf("integrated:     %7.2f LUFS\n", theMeasurement.mIntegratedLUFS);
+
+    return EXIT_SUCCESS;
+}
+
+#pragma mark Benchmark
+
+static int Benchmark(UInt32 inBufferFrames)
+{
+    const UInt32 kCycles = 20000;
+    const Float64 kSampleRate = 48000.0;
+
+    Clip theClip = MakeSineSequence(kSampleRate, { { -20.0, 1.0 }, { -30.0, 1.0 } });
+    BGM_LoudnessMeter theMeter(kSampleRate);
+
+    BGM_LoudnessMeter::Normalization theNormalization;
+    theNormalization.mEnabled = true;
+    theMeter.SetNormalization(theNormalization);
+
+    std::vector<Float32> theBuffer(inBufferFrames * 2);
+    UInt32 theFrame = 0;
+
+    auto theStart = std::chrono::steady_clock::now();
+
+    for(UInt32 theCycle = 0; theCycle < kCycles; theCycle++)
+    {
+        if(theFrame + inBufferFrames > theClip.GetFrameCount())
+        {
+            theFrame = 0;
+        }
+
+        std::copy(theClip.mSamples.begin() + theFrame * 2,
+                  theClip.mSamples.begin() + (theFrame + inBufferFrames) * 2,
+                  theBuffer.begin());
+        theMeter.ProcessRT(theBuffer.data(), inBufferFrames);
+
+        theFrame += inBufferFrames;
+    }
+
+    auto theEnd = std::chrono::steady_clock::now();
+
+    const Float64 theNanosPerCycle =
+            std::chrono::duration<Float64, std::nano>(theEnd - theStart).count() / kCycles;
+    const Float64 theCycleNanos = inBufferFrames / kSampleRate * 1.0e9;
+
+    std::printf("%u-frame buffers: %.0f ns per cycle (including a copy), %.3f%% of the cycle at %.0f Hz\n",
+                inBufferFrames,
+                theNanosPerCycle,
+                100.0 * theNanosPerCycle / theCycleNanos,
+                kSampleRate);
+
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, const char* argv[])
+{
+    const std::string theCommand = (argc > 1) ? argv[1] : "test";
+
+    auto theBufferFrames = [&] (int inArgIndex) {
+        return (argc > inArgIndex) ? static_cast<UInt32>(std::max(1, std::atoi(argv[inArgIndex]))) : kDefaultBufferFrames;
+    };
+
+    if(theCommand == "test" && argc <= 3)
+    {
+        return Test(theBufferFrames(2));
+    }
+    else if(theCommand == "measure" && (argc == 3 || argc == 4))
+    {
+        return MeasureFile(argv[2], theBufferFrames(3));
+    }
+    else if(theCommand == "benchmark" && argc <= 3)
+    {
+        return Benchmark(theBufferFrames(2));
+    }
+
+    std::fprintf(stderr,
+                 "Usage: %s [test [buffer frames]]\n"
+                 "       %s measure <WAV file> [buffer frames]\n"
+                 "       %s benchmark [buffer frames]\n",
+                 argv[0], argv[0], argv[0]);
+    return EXIT_FAILURE;
+}
+
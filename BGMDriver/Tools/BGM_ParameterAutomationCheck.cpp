@@ -0,0 +1,220 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_ParameterAutomationCheck.cpp
+//  BGMDriver
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  Checks BGM_ParameterAutomation's timing is sample-accurate, the same checks as
+//  BGM_ParameterAutomationTests.mm, so they also run outside Xcode. Built by the portable CMake
+//  build (see DEVELOPING.md) as bgm-parameter-automation-check.
+//
+//  Usage:
+//
+//      bgm-parameter-automation-check check
+//          Simulates IO cycles with a few buffer sizes and checks the scheduled steps and ramps
+//          start on exactly the frames they were scheduled for, that late events continue from
+//          where they would have been and that the event queue holds kMaxPendingEvents. Exits
+//          with an error if anything fails.
+//
+
+// Local Includes
+#include "BGM_ParameterAutomation.h"
+
+// STL Includes
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+
+static const UInt32 kChannels = 2;
+
+// The clock the events are scheduled in, e.g. host time, starts at this time at sample time 0 and
+// advances this much per frame.
+static const Float64 kTimeOffset = 5.0;
+static const Float64 kTimeUnitsPerFrame = 10.0;
+
+static Float64 TimeOfFrame(SInt64 inSampleTime)
+{
+    return inSampleTime * kTimeUnitsPerFrame + kTimeOffset;
+}
+
+// Event has default member initializers, so it isn't an aggregate in C++11.
+static BGM_ParameterAutomation::Event MakeEvent(Float64 inTime, Float32 inValue, UInt32 inRampFrames)
+{
+    BGM_ParameterAutomation::Event theEvent;
+    theEvent.mTime = inTime;
+    theEvent.mValue = inValue;
+    theEvent.mRampFrames = inRampFrames;
+    return theEvent;
+}
+
+static bool Check(const char* inName, bool inPassed)
+{
+    std::printf("%-6s %s\n", inPassed ? "ok" : "FAILED", inName);
+    return inPassed;
+}
+
+static bool IsClose(Float32 inValue, Float32 inExpected, Float32 inAccuracy)
+{
+    return std::fabs(inValue - inExpected) <= inAccuracy;
+}
+
+// Simulate the IO cycles from sample time 0 to inTotalFrames, with inBufferFrames frames per cycle,
+// applying ioAutomation's gain to a signal of ones. Returns the gain applied to each frame. Sets
+// outChannelsMatch to false if the channels get different gains.
+static std::vector<Float32> RunIOCycles(BGM_ParameterAutomation& ioAutomation,
+                                        UInt32 inBufferFrames,
+                                        UInt32 inTotalFrames,
+                                        bool& outChannelsMatch)
+{
+    std::vector<Float32> theGains;
+    outChannelsMatch = true;
+
+    for(UInt32 theSampleTime = 0; theSampleTime < inTotalFrames; theSampleTime += inBufferFrames)
+    {
+        std::vector<Float32> theBuffer(inBufferFrames * kChannels, 1.0f);
+
+        ioAutomation.ApplyGainRT(theBuffer.data(),
+                                 inBufferFrames,
+                                 theSampleTime,
+                                 TimeOfFrame(theSampleTime),
+                                 kTimeUnitsPerFrame);
+
+        for(UInt32 i = 0; i < inBufferFrames; i++)
+        {
+            outChannelsMatch &= (theBuffer[i * kChannels] == theBuffer[i * kChannels + 1]);
+            theGains.push_back(theBuffer[i * kChannels]);
+        }
+    }
+
+    return theGains;
+}
+
+static bool CheckEventsStartOnTheirFrames(UInt32 inBufferFrames)
+{
+    bool thePassed = true;
+
+    BGM_ParameterAutomation theAutomation(1.0f);
+
+    // Step to 0.5 at frame 1000, ramp to 0 over 100 frames from frame 2000 and interrupt that ramp
+    // at frame 2050 to ramp back up to 1 over 10 frames.
+    bool theScheduled = theAutomation.ScheduleEvent(MakeEvent(TimeOfFrame(1000), 0.5f, 0));
+    theScheduled &= theAutomation.ScheduleEvent(MakeEvent(TimeOfFrame(2000), 0.0f, 100));
+    theScheduled &= theAutomation.ScheduleEvent(MakeEvent(TimeOfFrame(2050), 1.0f, 10));
+    thePassed &= Check("the events are scheduled", theScheduled);
+
+    bool theChannelsMatch;
+    std::vector<Float32> theGains = RunIOCycles(theAutomation, inBufferFrames, 3000, theChannelsMatch);
+    thePassed &= Check("both channels get the same gain", theChannelsMatch);
+
+    thePassed &= Check("the step starts on its event's frame",
+                       theGains[999] == 1.0f && theGains[1000] == 0.5f && theGains[1999] == 0.5f);
+
+    // The first ramp would reach 0 on frame 2099.
+    thePassed &= Check("the ramp starts moving on its event's frame",
+                       IsClose(theGains[2000], 0.495f, 1e-6f) && IsClose(theGains[2049], 0.25f, 1e-5f));
+
+    // The second ramp starts from where the first had got to and reaches 1 on its last frame.
+    const Float32 theInterruptedGain = 0.245f;
+    thePassed &= Check("the interrupting ramp starts from the interrupted ramp's gain",
+                       IsClose(theGains[2050], theInterruptedGain + (1.0f - theInterruptedGain) / 10.0f, 1e-5f));
+    thePassed &= Check("the interrupting ramp reaches its gain on its last frame",
+                       theGains[2058] < 1.0f && theGains[2059] == 1.0f && theGains[2999] == 1.0f);
+
+    return thePassed;
+}
+
+static bool CheckLateEvents()
+{
+    BGM_ParameterAutomation theAutomation(1.0f);
+
+    // Schedule a ramp that should have started 50 frames before the first IO cycle.
+    bool thePassed = Check("the late event is scheduled",
+                           theAutomation.ScheduleEvent(MakeEvent(TimeOfFrame(-50), 0.0f, 100)));
+
+    bool theChannelsMatch;
+    std::vector<Float32> theGains = RunIOCycles(theAutomation, 64, 128, theChannelsMatch);
+
+    thePassed &= Check("late events continue from where they would have been",
+                       theChannelsMatch &&
+                       IsClose(theGains[0], 1.0f - 51.0f / 100.0f, 1e-6f) &&
+                       theGains[49] == 0.0f &&
+                       theGains[127] == 0.0f);
+
+    return thePassed;
+}
+
+static bool CheckQueueCapacity()
+{
+    BGM_ParameterAutomation theAutomation(1.0f);
+    bool theScheduled = true;
+
+    for(UInt32 i = 0; i < BGM_ParameterAutomation::kMaxPendingEvents; i++)
+    {
+        theScheduled &= theAutomation.ScheduleEvent(MakeEvent(TimeOfFrame(i), 0.5f, 0));
+    }
+
+    bool thePassed = Check("the queue holds kMaxPendingEvents events",
+                           theScheduled &&
+                           theAutomation.GetPendingEventCount() == BGM_ParameterAutomation::kMaxPendingEvents);
+    thePassed &= Check("scheduling fails when the queue is full",
+                       !theAutomation.ScheduleEvent(MakeEvent(TimeOfFrame(1000), 0.5f, 0)));
+
+    // Running the IO cycles past the events' times should make room for more.
+    bool theChannelsMatch;
+    RunIOCycles(theAutomation, 512, 512, theChannelsMatch);
+
+    thePassed &= Check("the IO cycles empty the queue", theAutomation.GetPendingEventCount() == 0);
+    thePassed &= Check("events can be scheduled again",
+                       theAutomation.ScheduleEvent(MakeEvent(TimeOfFrame(1000), 0.5f, 0)));
+
+    return thePassed;
+}
+
+static int RunChecks()
+{
+    bool thePassed = true;
+
+    for(UInt32 theBufferFrames : { 1u, 7u, 64u, 512u, 1000u, 1001u })
+    {
+        std::printf("%u-frame buffers:\n", theBufferFrames);
+        thePassed &= CheckEventsStartOnTheirFrames(theBufferFrames);
+    }
+
+    thePassed &= CheckLateEvents();
+    thePassed &= CheckQueueCapacity();
+
+    return thePassed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int main(int argc, const char* argv[])
+{
+    const std::string theCommand = (argc > 1) ? argv[1] : "";
+
+    if(theCommand == "check" && argc == 2)
+    {
+        return RunChecks();
+    }
+
+    std::fprintf(stderr, "Usage: %s check\n", argv[0]);
+    return EXIT_FAILURE;
+}
+
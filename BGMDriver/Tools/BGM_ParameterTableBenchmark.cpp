@@ -0,0 +1,433 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_ParameterTableBenchmark.cpp
+//  BGMDriver
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  Checks BGM_SharedParameterTable with a table in shared memory and compares the cost of sending
+//  apps' volumes through it with sending them as kAudioDeviceCustomPropertyAppVolumes, like
+//  BGM_SharedParameterTableTests' benchmarks. Built by the portable CMake build (see
+//  DEVELOPING.md) as bgm-parameter-table-benchmark.
+//
+//  Usage:
+//
+//      bgm-parameter-table-benchmark check
+//          Creates a table the way BGMApp does and checks only its owner can write to it, that the
+//          driver reads the values a child process writes to it, that values the property has
+//          overridden stay unset until they're written again and that the driver won't read a
+//          table other users can write to. Exits with an error if anything fails.
+//
+//      bgm-parameter-table-benchmark benchmark [apps]
+//          Prints the time per update of writing an app's volume to the table, of reading it the
+//          way the IO thread does and of setting it with kAudioDeviceCustomPropertyAppVolumes and
+//          reading it back, with updates spread over the given number of apps (20 by default). The
+//          property's time doesn't include the IPC to coreaudiod, so the real difference is larger.
+//
+
+// Local Includes
+#include "BGM_Clients.h"
+#include "BGM_SharedParameterTable.h"
+#include "BGM_Types.h"
+
+// PublicUtility Includes
+#include "CACFArray.h"
+#include "CACFDictionary.h"
+
+// STL Includes
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// System Includes
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+
+static const pid_t kAppProcessID = 1234;
+static const UInt32 kDefaultApps = 20;
+// The first app's PID in the benchmark.
+static const pid_t kBenchmarkFirstProcessID = 100;
+// Roughly a minute of 1 kHz control data for each of 20 apps.
+static const UInt32 kBenchmarkUpdates = 20 * 60 * 1000;
+// The property is much slower, so only send a fraction of the updates through it.
+static const UInt32 kBenchmarkPropertyUpdates = kBenchmarkUpdates / 100;
+static const UInt32 kBenchmarkRuns = 5;
+
+static bool Check(const char* inName, bool inPassed)
+{
+    std::printf("%-6s %s\n", inPassed ? "ok" : "FAILED", inName);
+    return inPassed;
+}
+
+// A name no other process, e.g. the installed driver, uses.
+static std::string UniqueTableName(const char* inPurpose)
+{
+    return std::string("/BGM") + inPurpose + "." + std::to_string(getpid());
+}
+
+static bool SetRelativeVolume(BGM_Clients& ioClients, pid_t inProcessID, SInt32 inRawVolume)
+{
+    CACFDictionary theAppVolume(true);
+    theAppVolume.AddSInt32(CFSTR(kBGMAppVolumesKey_ProcessID), inProcessID);
+    theAppVolume.AddSInt32(CFSTR(kBGMAppVolumesKey_RelativeVolume), inRawVolume);
+
+    CACFArray theAppVolumes(true);
+    theAppVolumes.AppendDictionary(theAppVolume.GetDict());
+
+    return ioClients.SetClientsRelativeVolumes(theAppVolumes);
+}
+
+static void AddClient(BGM_Clients& ioClients, UInt32 inClientID, pid_t inProcessID)
+{
+    AudioServerPlugInClientInfo theClientInfo;
+    theClientInfo.mClientID = inClientID;
+    theClientInfo.mProcessID = inProcessID;
+    theClientInfo.mIsNativeEndian = true;
+    theClientInfo.mBundleID = nullptr;
+
+    ioClients.AddClient(&theClientInfo);
+}
+
+// Set an app's volume from a child process, like BGMApp would. Returns false if the child couldn't
+// create the table or set the value.
+static bool SetValueFromChildProcess(const std::string& inTableName, pid_t inProcessID, Float32 inValue)
+{
+    pid_t theChild = fork();
+
+    if(theChild == 0)
+    {
+        BGMParameterTable* theTable = BGMParameterTableCreate(inTableName.c_str());
+        bool didSet = (theTable != nullptr) &&
+                BGMParameterTableSetValue(theTable, inProcessID, kBGMParameterRelativeVolume, inValue);
+        _exit(didSet ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+    int theStatus = 0;
+
+    return (theChild > 0) &&
+           (waitpid(theChild, &theStatus, 0) == theChild) &&
+           WIFEXITED(theStatus) &&
+           (WEXITSTATUS(theStatus) == EXIT_SUCCESS);
+}
+
+static bool CheckOnlyTheOwnerCanWrite(const std::string& inTableName)
+{
+    bool thePassed = true;
+
+    int theFile = shm_open(inTableName.c_str(), O_RDONLY, 0);
+    struct stat theFileInfo;
+
+    thePassed &= Check("the table belongs to the user that created it",
+                       theFile >= 0 &&
+                       fstat(theFile, &theFileInfo) == 0 &&
+                       theFileInfo.st_uid == geteuid());
+    thePassed &= Check("no other user can write to the table",
+                       theFile >= 0 && (theFileInfo.st_mode & (S_IWGRP | S_IWOTH)) == 0);
+
+    if(theFile >= 0)
+    {
+        close(theFile);
+    }
+
+    thePassed &= Check("the driver doesn't read a table another user owns",
+                       BGMParameterTableOpenReadOnly(inTableName.c_str(), geteuid() + 1) == nullptr);
+
+    return thePassed;
+}
+
+static bool CheckDriverReadsTheTable(const std::string& inTableName)
+{
+    bool thePassed = true;
+
+    BGM_SharedParameterTable theDriverTable(inTableName.c_str());
+    thePassed &= Check("the driver uses its private table until the table is created",
+                       !theDriverTable.IsShared());
+
+    BGMParameterTable* theAppTable = BGMParameterTableCreate(inTableName.c_str());
+
+    if(!Check("the table can be created", theAppTable != nullptr))
+    {
+        return false;
+    }
+
+    thePassed &= CheckOnlyTheOwnerCanWrite(inTableName);
+
+    thePassed &= Check("another process can write to the table",
+                       SetValueFromChildProcess(inTableName, kAppProcessID, 75.5f));
+
+    theDriverTable.OpenSharedIfNeeded();
+    thePassed &= Check("the driver maps the table", theDriverTable.IsShared());
+
+    BGM_ParameterSlotCache theCache;
+    Float32 theValue = 0.0f;
+    bool didGet = theDriverTable.GetValueRT(kAppProcessID, theCache, kBGMParameterRelativeVolume, theValue);
+    thePassed &= Check("the driver reads the other process's value", didGet && theValue == 75.5f);
+    thePassed &= Check("parameters that weren't set aren't found",
+                       !theDriverTable.GetValueRT(kAppProcessID, theCache, kBGMParameterPanPosition, theValue));
+
+    theDriverTable.ClearValue(kAppProcessID, kBGMParameterRelativeVolume);
+    thePassed &= Check("a cleared value isn't read",
+                       !theDriverTable.GetValueRT(kAppProcessID, theCache, kBGMParameterRelativeVolume, theValue));
+    thePassed &= Check("clearing a value doesn't change the table",
+                       theAppTable->mSlots[kAppProcessID % kBGMParameterTableSlotCount]
+                               .mValues[kBGMParameterRelativeVolume] == 75.5f);
+
+    BGMParameterTableSetValue(theAppTable, kAppProcessID, kBGMParameterRelativeVolume, 70.0f);
+    didGet = theDriverTable.GetValueRT(kAppProcessID, theCache, kBGMParameterRelativeVolume, theValue);
+    thePassed &= Check("a cleared value is read again once it's set again", didGet && theValue == 70.0f);
+
+    BGMParameterTableReleaseSlot(theAppTable, kAppProcessID);
+    thePassed &= Check("a released slot's values aren't read",
+                       !theDriverTable.GetValueRT(kAppProcessID, theCache, kBGMParameterRelativeVolume, theValue));
+
+    BGMParameterTableClose(theAppTable);
+
+    return thePassed;
+}
+
+static bool CheckClientsUseTheTable(const std::string& inTableName)
+{
+    bool thePassed = true;
+
+    BGMParameterTable* theAppTable = BGMParameterTableCreate(inTableName.c_str());
+
+    if(!Check("the table can be created for the clients", theAppTable != nullptr))
+    {
+        return false;
+    }
+
+    BGM_Clients theClients(kAudioObjectUnknown, inTableName.c_str());
+    AddClient(theClients, 1, kAppProcessID);
+
+    BGMParameterTableSetValue(theAppTable, kAppProcessID, kBGMParameterPanPosition, -40.0f);
+    thePassed &= Check("the table's values override the clients'",
+                       theClients.GetClientPanPositionRT(1) == -40.0f);
+
+    BGMParameterTableSetValue(theAppTable, kAppProcessID, kBGMParameterRelativeVolume, 75.0f);
+    thePassed &= Check("the table's volumes are used", theClients.GetClientRelativeVolumeRT(1) > 1.0f);
+
+    // Half the raw range is unity gain. (See BGM_Clients::SetClientsRelativeVolumes.)
+    SetRelativeVolume(theClients, kAppProcessID, kAppRelativeVolumeMaxRawValue / 2);
+    thePassed &= Check("the property overrides the table's volume",
+                       std::fabs(theClients.GetClientRelativeVolumeRT(1) - 1.0f) < 1.0e-4f);
+    thePassed &= Check("the property only overrides the parameter it sets",
+                       theClients.GetClientPanPositionRT(1) == -40.0f);
+
+    // A new process with the same PID shouldn't get the old one's values.
+    theClients.RemoveClient(1);
+    AddClient(theClients, 1, kAppProcessID);
+    thePassed &= Check("an exited app's values aren't used", theClients.GetClientPanPositionRT(1) == 0.0f);
+
+    BGMParameterTableClose(theAppTable);
+
+    return thePassed;
+}
+
+static bool CheckWorldWritableTableIsReplaced(const std::string& inTableName)
+{
+    bool thePassed = true;
+
+    // E.g. one left by an older version of the driver, or created by another process to get BGMApp
+    // to write to a table anyone can change.
+    int theFile = shm_open(inTableName.c_str(), O_RDWR | O_CREAT | O_EXCL, 0666);
+
+    if(!Check("a world-writable object can be created", theFile >= 0))
+    {
+        return false;
+    }
+
+    thePassed &= Check("the object is world-writable", fchmod(theFile, 0666) == 0);
+    close(theFile);
+
+    thePassed &= Check("the driver doesn't read a world-writable table",
+                       BGMParameterTableOpenReadOnly(inTableName.c_str(), geteuid()) == nullptr);
+
+    BGMParameterTable* theAppTable = BGMParameterTableCreate(inTableName.c_str());
+    thePassed &= Check("the writer replaces a world-writable table", theAppTable != nullptr);
+
+    if(theAppTable != nullptr)
+    {
+        BGMParameterTable* theDriverTable = BGMParameterTableOpenReadOnly(inTableName.c_str(), geteuid());
+        thePassed &= Check("the driver reads the replacement", theDriverTable != nullptr);
+
+        if(theDriverTable != nullptr)
+        {
+            BGMParameterTableClose(theDriverTable);
+        }
+
+        BGMParameterTableClose(theAppTable);
+    }
+
+    return thePassed;
+}
+
+static int RunChecks()
+{
+    const std::string theTableName = UniqueTableName("Check");
+    const std::string theClientsTableName = UniqueTableName("CheckClients");
+    const std::string theReplacedTableName = UniqueTableName("CheckReplaced");
+
+    bool thePassed = true;
+
+    thePassed &= CheckDriverReadsTheTable(theTableName);
+    thePassed &= CheckClientsUseTheTable(theClientsTableName);
+    thePassed &= CheckWorldWritableTableIsReplaced(theReplacedTableName);
+
+    shm_unlink(theTableName.c_str());
+    shm_unlink(theClientsTableName.c_str());
+    shm_unlink(theReplacedTableName.c_str());
+
+    return thePassed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// Returns the median time per update of kBenchmarkRuns runs of inUpdates calls to inUpdate. A
+// template rather than a std::function, since the table's updates only take a few nanoseconds.
+template <typename UpdateFunction>
+static Float64 TimePerUpdate(UInt32 inUpdates, UpdateFunction inUpdate)
+{
+    std::vector<Float64> theRunNanos;
+
+    for(UInt32 theRun = 0; theRun < kBenchmarkRuns; theRun++)
+    {
+        auto theStart = std::chrono::steady_clock::now();
+
+        for(UInt32 i = 0; i < inUpdates; i++)
+        {
+            inUpdate(i);
+        }
+
+        auto theEnd = std::chrono::steady_clock::now();
+        theRunNanos.push_back(std::chrono::duration<Float64, std::nano>(theEnd - theStart).count() /
+                              inUpdates);
+    }
+
+    std::sort(theRunNanos.begin(), theRunNanos.end());
+
+    return theRunNanos[theRunNanos.size() / 2];
+}
+
+static void PrintTime(const char* inName, Float64 inNanos)
+{
+    std::printf("  %-40s %10.1f %14.0f\n", inName, inNanos, 1.0e9 / inNanos);
+}
+
+static int RunBenchmark(UInt32 inApps)
+{
+    const std::string theTableName = UniqueTableName("Benchmark");
+
+    BGMParameterTable* theAppTable = BGMParameterTableCreate(theTableName.c_str());
+    BGM_SharedParameterTable theDriverTable(theTableName.c_str());
+
+    if(theAppTable == nullptr || !theDriverTable.IsShared())
+    {
+        std::fprintf(stderr, "Couldn't create the table in shared memory\n");
+        shm_unlink(theTableName.c_str());
+        return EXIT_FAILURE;
+    }
+
+    std::vector<BGM_ParameterSlotCache> theCaches(inApps);
+    // Stops the reads being optimised away.
+    volatile Float32 theSink = 0.0f;
+
+    auto thePIDForUpdate = [inApps] (UInt32 inUpdate) {
+        return static_cast<pid_t>(kBenchmarkFirstProcessID + inUpdate % inApps);
+    };
+
+    std::printf("Volume updates for %u apps:\n\n", inApps);
+    std::printf("  %-40s %10s %14s\n", "", "ns/update", "updates/s");
+
+    PrintTime("table, write", TimePerUpdate(kBenchmarkUpdates, [&] (UInt32 inUpdate) {
+        BGMParameterTableSetValue(theAppTable,
+                                  thePIDForUpdate(inUpdate),
+                                  kBGMParameterRelativeVolume,
+                                  static_cast<Float32>(inUpdate % 100));
+    }));
+
+    PrintTime("table, IO thread read", TimePerUpdate(kBenchmarkUpdates, [&] (UInt32 inUpdate) {
+        Float32 theValue = 0.0f;
+        theDriverTable.GetValueRT(thePIDForUpdate(inUpdate),
+                                  theCaches[inUpdate % inApps],
+                                  kBGMParameterRelativeVolume,
+                                  theValue);
+        theSink = theValue;
+    }));
+
+    PrintTime("table, write and read", TimePerUpdate(kBenchmarkUpdates, [&] (UInt32 inUpdate) {
+        Float32 theValue = 0.0f;
+        BGMParameterTableSetValue(theAppTable,
+                                  thePIDForUpdate(inUpdate),
+                                  kBGMParameterRelativeVolume,
+                                  static_cast<Float32>(inUpdate % 100));
+        theDriverTable.GetValueRT(thePIDForUpdate(inUpdate),
+                                  theCaches[inUpdate % inApps],
+                                  kBGMParameterRelativeVolume,
+                                  theValue);
+        theSink = theValue;
+    }));
+
+    // The clients don't use the table, so the property's values aren't overridden.
+    BGM_Clients theClients(kAudioObjectUnknown);
+
+    for(UInt32 i = 0; i < inApps; i++)
+    {
+        AddClient(theClients, kBenchmarkFirstProcessID + i, thePIDForUpdate(i));
+    }
+
+    PrintTime("property, set and read (without IPC)", TimePerUpdate(kBenchmarkPropertyUpdates, [&] (UInt32 inUpdate) {
+        SetRelativeVolume(theClients, thePIDForUpdate(inUpdate), inUpdate % 100);
+        theSink = theClients.GetClientRelativeVolumeRT(kBenchmarkFirstProcessID + inUpdate % inApps);
+    }));
+
+    BGMParameterTableClose(theAppTable);
+    shm_unlink(theTableName.c_str());
+
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, const char* argv[])
+{
+    const std::string theCommand = (argc > 1) ? argv[1] : "benchmark";
+
+    if(theCommand == "check" && argc == 2)
+    {
+        return RunChecks();
+    }
+    else if(theCommand == "benchmark" && argc <= 3)
+    {
+        return RunBenchmark((argc > 2) ?
+                            static_cast<UInt32>(std::min(std::max(1, std::atoi(argv[2])),
+                                                         static_cast<int>(kBGMParameterTableSlotCount))) :
+                            kDefaultApps);
+    }
+
+    std::fprintf(stderr,
+                 "Usage: %s check\n"
+                 "       %s benchmark [apps]\n",
+                 argv[0],
+                 argv[0]);
+    return EXIT_FAILURE;
+}
+
@@ -0,0 +1,373 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_RTEventDecode.cpp
+//  BGMDriver
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  Prints the events recorded by BGM_RTEventLog (see BGM_RTEventLog.h). BGMDevice records its IO
+//  thread's events next to its IO traces, as <trace file>.events, and BGMApp records its IOProcs'
+//  events if it's started with BGMRTEventLogPath set in its environment.
+//
+//  Usage:
+//
+//      bgm-rt-event-decode <events file> [summary]
+//          Prints every event with the time since the first event, its channel and its sequence
+//          number, and where events were dropped. With "summary", prints how many of each type of
+//          event there were and the most in any one second instead.
+//
+//      bgm-rt-event-decode check <events file>
+//          Logs events from several threads, some of them sharing a channel, records them to the
+//          file (deleting it first) and checks every event was either recorded or counted as
+//          dropped. Exits with an error if not.
+//
+
+// Local Includes
+#include "BGM_RTEventLog.h"
+
+// PublicUtility Includes
+#include "CAException.h"
+
+// STL Includes
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+// System Includes
+#include <unistd.h>
+
+
+static const BGM_RTEventType kDroppedEventType = {
+    "Dropped events",
+    kBGMRTEventSeverityWarning,
+    nullptr,
+    { "count", "channel", nullptr, nullptr },
+    { kBGMRTEventArgInteger, kBGMRTEventArgInteger, kBGMRTEventArgUnused, kBGMRTEventArgUnused }
+};
+
+static const char* SeverityName(BGMRTEventSeverity inSeverity)
+{
+    switch(inSeverity)
+    {
+        case kBGMRTEventSeverityDebug:   return "debug";
+        case kBGMRTEventSeverityWarning: return "warning";
+        default:                         return "error";
+    }
+}
+
+#pragma mark Decode
+
+static int Decode(const char* inPath, bool inSummary)
+{
+    BGM_RTEventReader theReader(inPath);
+    const BGM_RTEventFileHeader& theHeader = theReader.GetFileHeader();
+    const std::vector<BGM_RTEventType>& theTypes = theReader.GetTypes();
+
+    auto getType = [&] (UInt16 inType) -> const BGM_RTEventType& {
+        return (inType < theTypes.size()) ? theTypes[inType] : kDroppedEventType;
+    };
+
+    auto toSeconds = [&] (UInt64 inHostTicks) {
+        return static_cast<Float64>(inHostTicks) * theHeader.mTimebaseNumerator /
+               theHeader.mTimebaseDenominator / 1e9;
+    };
+
+    struct BGM_TypeSummary
+    {
+        UInt64              mCount = 0;
+        UInt64              mMaxPerSecond = 0;
+        // The times of the events in the last second, to find mMaxPerSecond.
+        std::vector<UInt64> mRecentTimes;
+    };
+
+    std::map<UInt16, BGM_TypeSummary> theSummaries;
+    // The next sequence number expected on each channel, to find gaps.
+    std::map<UInt16, UInt64> theNextSequenceNumbers;
+    UInt64 theFirstHostTime = 0;
+    UInt64 theEventCount = 0;
+    UInt64 theDroppedEventCount = 0;
+    BGM_RTEvent theEvent;
+
+    while(theReader.ReadEvent(theEvent))
+    {
+        if(theEventCount++ == 0)
+        {
+            theFirstHostTime = theEvent.mHostTime;
+        }
+
+        const BGM_RTEventType& theType = getType(theEvent.mType);
+        // Events from different channels can be slightly out of order.
+        Float64 theSeconds = (theEvent.mHostTime >= theFirstHostTime) ?
+                toSeconds(theEvent.mHostTime - theFirstHostTime) :
+                -toSeconds(theFirstHostTime - theEvent.mHostTime);
+
+        if(theEvent.mType == kBGMRTEventTypeDropped)
+        {
+            theDroppedEventCount += static_cast<UInt64>(theEvent.mArgs[0].GetInteger());
+        }
+        else
+        {
+            auto theNextSequenceNumber = theNextSequenceNumbers.find(theEvent.mChannel);
+
+            if(!inSummary &&
+               theNextSequenceNumber != theNextSequenceNumbers.end() &&
+               theEvent.mSequenceNumber > theNextSequenceNumber->second)
+            {
+                std::printf("%+12.6f [%u]           (%llu events not recorded)\n",
+                            theSeconds,
+                            theEvent.mChannel,
+                            theEvent.mSequenceNumber - theNextSequenceNumber->second);
+            }
+
+            theNextSequenceNumbers[theEvent.mChannel] = theEvent.mSequenceNumber + 1;
+        }
+
+        if(inSummary)
+        {
+            BGM_TypeSummary& theSummary = theSummaries[theEvent.mType];
+            theSummary.mCount++;
+            theSummary.mRecentTimes.push_back(theEvent.mHostTime);
+
+            // Forget the events more than a second before this one.
+            auto theOldest = std::find_if(theSummary.mRecentTimes.begin(),
+                                          theSummary.mRecentTimes.end(),
+                                          [&] (UInt64 inHostTime) {
+                                              return inHostTime + 1 > theEvent.mHostTime ||
+                                                     toSeconds(theEvent.mHostTime - inHostTime) < 1.0;
+                                          });
+            theSummary.mRecentTimes.erase(theSummary.mRecentTimes.begin(), theOldest);
+            theSummary.mMaxPerSecond = std::max(theSummary.mMaxPerSecond,
+                                                static_cast<UInt64>(theSummary.mRecentTimes.size()));
+        }
+        else
+        {
+            std::printf("%+12.6f [%u] %8llu %-7s %s\n",
+                        theSeconds,
+                        theEvent.mChannel,
+                        static_cast<unsigned long long>(theEvent.mSequenceNumber),
+                        SeverityName(theType.mSeverity),
+                        BGM_RTEventLog::FormatEvent(theType, theEvent).c_str());
+        }
+    }
+
+    if(inSummary)
+    {
+        std::printf("%10s %12s  %s\n", "events", "max per sec", "type");
+
+        for(const auto& theSummary : theSummaries)
+        {
+            std::printf("%10llu %12llu  %s\n",
+                        static_cast<unsigned long long>(theSummary.second.mCount),
+                        static_cast<unsigned long long>(theSummary.second.mMaxPerSecond),
+                        getType(theSummary.first).mMessage);
+        }
+    }
+
+    std::printf("%llu events recorded, %llu dropped\n",
+                static_cast<unsigned long long>(theEventCount),
+                static_cast<unsigned long long>(theDroppedEventCount));
+
+    return EXIT_SUCCESS;
+}
+
+#pragma mark Check
+
+static const BGM_RTEventType kCheckEventTypes[] = {
+    {
+        "Check: Integer event",
+        kBGMRTEventSeverityDebug,
+        "thread",
+        { "index", "negative", nullptr, nullptr },
+        { kBGMRTEventArgInteger, kBGMRTEventArgInteger, kBGMRTEventArgUnused, kBGMRTEventArgUnused }
+    },
+    {
+        "Check: Float event",
+        kBGMRTEventSeverityWarning,
+        nullptr,
+        { "index", "half", "status", nullptr },
+        { kBGMRTEventArgInteger, kBGMRTEventArgFloat, kBGMRTEventArgOSStatus, kBGMRTEventArgUnused }
+    }
+};
+
+static const UInt16 kCheckChannels = 2;
+static const UInt32 kCheckThreads = 3;
+static const UInt32 kCheckEventsPerThread = 20000;
+
+static int Check(const char* inPath)
+{
+    unlink(inPath);
+
+    std::atomic<UInt64> theMessagesPrinted(0);
+    // The total logged to each channel, including the ones dropped.
+    UInt64 theEventsLogged[kCheckChannels] = {};
+
+    {
+        // Small channels, so some events are dropped.
+        BGM_RTEventLog theLog(kCheckEventTypes,
+                              2,
+                              kCheckChannels,
+                              256,
+                              [&] (BGMRTEventSeverity, const char*) { theMessagesPrinted++; });
+        theLog.StartRecording(inPath);
+
+        // Threads 1 and 2 share channel 1, so some of their events are dropped because the channel
+        // is busy.
+        std::vector<std::thread> theThreads;
+
+        for(UInt32 t = 0; t < kCheckThreads; t++)
+        {
+            UInt16 theChannel = static_cast<UInt16>(std::min(t, static_cast<UInt32>(kCheckChannels - 1)));
+            theEventsLogged[theChannel] += kCheckEventsPerThread;
+
+            theThreads.emplace_back([&theLog, t, theChannel] {
+                const char* theName = (t == 0) ? "first" : ((t == 1) ? "second" : "third");
+
+                for(UInt32 i = 0; i < kCheckEventsPerThread; i++)
+                {
+                    if(i % 2 == 0)
+                    {
+                        theLog.LogDetailRT(theChannel, 0, theName, i, -static_cast<SInt64>(i));
+                    }
+                    else
+                    {
+                        theLog.LogRT(theChannel, 1, i, i / 2.0, 'abcd');
+                    }
+
+                    // Give the logging thread a chance to keep up, most of the time.
+                    if(i % 128 == 0)
+                    {
+                        std::this_thread::sleep_for(std::chrono::microseconds(500));
+                    }
+                }
+            });
+        }
+
+        for(std::thread& theThread : theThreads)
+        {
+            theThread.join();
+        }
+
+        if(!theLog.WaitUntilDrained(5000))
+        {
+            std::fprintf(stderr, "FAIL: The logging thread didn't drain the channels\n");
+            return EXIT_FAILURE;
+        }
+
+        theLog.StopRecording();
+    }
+
+    BGM_RTEventReader theReader(inPath);
+    UInt64 theEventsRecorded[kCheckChannels] = {};
+    UInt64 theEventsDropped[kCheckChannels] = {};
+    UInt64 theNextSequenceNumbers[kCheckChannels] = {};
+    bool thePassed = true;
+    BGM_RTEvent theEvent;
+
+    while(theReader.ReadEvent(theEvent))
+    {
+        if(theEvent.mChannel >= kCheckChannels)
+        {
+            std::fprintf(stderr, "FAIL: Event on channel %u\n", theEvent.mChannel);
+            return EXIT_FAILURE;
+        }
+
+        if(theEvent.mType == kBGMRTEventTypeDropped)
+        {
+            theEventsDropped[theEvent.mChannel] += static_cast<UInt64>(theEvent.mArgs[0].GetInteger());
+            continue;
+        }
+
+        theEventsRecorded[theEvent.mChannel]++;
+
+        // Sequence numbers only increase on a channel.
+        thePassed &= theEvent.mSequenceNumber >= theNextSequenceNumbers[theEvent.mChannel];
+        theNextSequenceNumbers[theEvent.mChannel] = theEvent.mSequenceNumber + 1;
+
+        // The arguments and detail survived.
+        SInt64 theIndex = theEvent.mArgs[0].GetInteger();
+
+        if(theEvent.mType == 0)
+        {
+            thePassed &= theEvent.mArgs[1].GetInteger() == -theIndex;
+            thePassed &= (theEvent.mChannel == 0) == (std::string(theEvent.mDetail) == "first");
+        }
+        else
+        {
+            thePassed &= theEvent.mArgs[1].GetFloat() == theIndex / 2.0;
+            thePassed &= theEvent.mArgs[2].GetInteger() == 'abcd';
+        }
+    }
+
+    std::printf("%-8s %10s %10s %10s\n", "channel", "logged", "recorded", "dropped");
+
+    for(UInt16 i = 0; i < kCheckChannels; i++)
+    {
+        std::printf("%-8u %10llu %10llu %10llu\n",
+                    i,
+                    static_cast<unsigned long long>(theEventsLogged[i]),
+                    static_cast<unsigned long long>(theEventsRecorded[i]),
+                    static_cast<unsigned long long>(theEventsDropped[i]));
+
+        // Every event was either recorded or counted as dropped.
+        thePassed &= theEventsRecorded[i] + theEventsDropped[i] == theEventsLogged[i];
+    }
+
+    std::printf("%llu messages printed\n", static_cast<unsigned long long>(theMessagesPrinted.load()));
+
+    if(!thePassed)
+    {
+        std::fprintf(stderr, "FAIL: The recording didn't match the events logged\n");
+        return EXIT_FAILURE;
+    }
+
+    std::printf("PASS\n");
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, const char* argv[])
+{
+    try
+    {
+        if(argc == 3 && std::string(argv[1]) == "check")
+        {
+            return Check(argv[2]);
+        }
+        else if(argc == 2 || (argc == 3 && std::string(argv[2]) == "summary"))
+        {
+            return Decode(argv[1], argc == 3);
+        }
+    }
+    catch(const CAException& e)
+    {
+        std::fprintf(stderr, "Error: %d\n", static_cast<int>(e.GetError()));
+        return EXIT_FAILURE;
+    }
+
+    std::fprintf(stderr,
+                 "Usage: %s <events file> [summary]\n"
+                 "       %s check <events file>\n",
+                 argv[0], argv[0]);
+    return EXIT_FAILURE;
+}
+
@@ -0,0 +1,454 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_RTSafetyCheck.cpp
+//  BGMDriver
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  Runs the simulated IO workloads with the RT-safety interposers (see BGM_RTSafety.h) and fails if
+//  the driver's real-time code allocates, locks or makes a blocking system call. Built by the
+//  portable CMake build as bgm-rt-safety-check and run by ctest.
+//
+//  Usage:
+//
+//      bgm-rt-safety-check [check [buffer frames]]
+//          Checks the interposers catch a deliberate violation of each type, then runs every
+//          workload. Prints each new violation with a stack trace. Exits with an error if there
+//          were any that aren't known problems (see kKnownViolations).
+//
+//      bgm-rt-safety-check run <workload> [buffer frames] [known]
+//          Runs one workload: playback, features, offload, churn or trace. With "known", the known problems
+//          are printed as well.
+//
+//  Only works where BGM_RTSafetyInterposersAvailable is true, i.e. glibc without ASan or TSan.
+//  Otherwise it exits with kSkippedExitCode, which ctest counts as skipped.
+//
+
+// Local Includes
+#include "BGM_RTSafety.h"
+#include "BGM_SimulatedHost.h"
+#include "BGM_Types.h"
+
+// PublicUtility Includes
+#include "CACFArray.h"
+#include "CACFDictionary.h"
+#include "CACFString.h"
+#include "CAException.h"
+
+// STL Includes
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// System Includes
+#include <unistd.h>
+
+
+static const Float64 kSampleRate = 44100.0;
+static const UInt32 kDefaultBufferFrames = 512;
+static const Float64 kWorkloadSeconds = 2.0;
+// ctest's SKIP_RETURN_CODE.
+static const int kSkippedExitCode = 77;
+
+#if BGM_RTSafetyChecks && BGM_RTSafetyInterposersAvailable
+
+// Problems already known about, which are counted but don't fail the check. Each is the function
+// that makes the unsafe call, or calls the function that does, like CAMutex::Lock. (See
+// BGM_RTSafety::AddSuppression.) Remove an entry once it's fixed, so the problem can't come back.
+struct BGM_KnownViolation
+{
+    const char* mFunction;
+    const char* mProblem;
+};
+
+static const BGM_KnownViolation kKnownViolations[] = {
+    // The IO operations lock the device's IO mutex, which StartIO and StopIO also lock.
+    { "BGM_IOPipeline::ReadInputRT",                    "locks the IO mutex" },
+    { "BGM_IOPipeline::ProcessOutputRT",                "locks the IO mutex" },
+    { "BGM_IOPipeline::WriteMixRT",                     "locks the IO mutex" }
+};
+
+#pragma mark Workloads
+
+// A sine tone at inFrequency for each client.
+static BGM_SimulatedHost::BGM_OutputGenerator MakeSine(Float64 inFrequency, Float32 inAmplitude)
+{
+    return [=] (UInt32 inIOBufferFrameSize, Float64 inSampleTime, Float32* outBuffer) {
+        for(UInt32 i = 0; i < inIOBufferFrameSize; i++)
+        {
+            Float32 theSample = inAmplitude *
+                    static_cast<Float32>(std::sin(2.0 * M_PI * inFrequency * (inSampleTime + i) / kSampleRate));
+            outBuffer[i * 2] = theSample;
+            outBuffer[i * 2 + 1] = theSample;
+        }
+    };
+}
+
+static std::string BundleID(UInt32 inClient)
+{
+    return "com.example.client" + std::to_string(inClient);
+}
+
+static void AddClients(BGM_SimulatedHost& ioHost, UInt32 inFirstClient, UInt32 inClients)
+{
+    for(UInt32 i = inFirstClient; i < inFirstClient + inClients; i++)
+    {
+        ioHost.AddClient(i, static_cast<pid_t>(1000 + i), BundleID(i).c_str(), MakeSine(110.0 * i, 0.1f));
+        ioHost.StartIO(i);
+    }
+}
+
+static UInt32 WorkloadCycles(const BGM_SimulatedHost& inHost)
+{
+    return static_cast<UInt32>(kWorkloadSeconds * kSampleRate / inHost.GetIOBufferFrameSize());
+}
+
+// Clients playing with their volumes, pans and EQ set.
+static void RunPlayback(UInt32 inBufferFrames)
+{
+    BGM_SimulatedHost theHost(kSampleRate, inBufferFrames);
+    AddClients(theHost, 1, 8);
+    
+    CACFArray theAppVolumes(true);
+    
+    for(UInt32 i = 1; i <= 8; i += 2)
+    {
+        CACFDictionary theAppVolume(true);
+        theAppVolume.AddSInt32(CFSTR(kBGMAppVolumesKey_ProcessID), static_cast<SInt32>(1000 + i));
+        theAppVolume.AddSInt32(CFSTR(kBGMAppVolumesKey_RelativeVolume), 30);
+        theAppVolume.AddSInt32(CFSTR(kBGMAppVolumesKey_PanPosition), -50);
+        theAppVolume.AddSInt32(CFSTR(kBGMAppVolumesKey_EQLowGain), 60);
+        theAppVolume.AddSInt32(CFSTR(kBGMAppVolumesKey_EQHighGain), -60);
+        theAppVolumes.AppendDictionary(theAppVolume.GetDict());
+    }
+    
+    theHost.GetClients().SetClientsRelativeVolumes(theAppVolumes);
+    theHost.Run(WorkloadCycles(theHost), false);
+}
+
+static CACFArray BundleIDs(std::initializer_list<UInt32> inClients)
+{
+    CACFArray theBundleIDs(true);
+    
+    for(UInt32 theClient : inClients)
+    {
+        theBundleIDs.AppendString(CACFString(BundleID(theClient).c_str()).GetCFString());
+    }
+    
+    return theBundleIDs;
+}
+
+// The music player, routes, mix-minus, capture filters, the crossfader, ducking and loudness
+// normalization all turned on at once. The DSP is offloaded to inDSPOffloadWorkers worker threads
+// unless it's 0.
+static void RunFeatures(UInt32 inBufferFrames, UInt32 inDSPOffloadWorkers)
+{
+    BGM_SimulatedHost theHost(kSampleRate, inBufferFrames);
+    BGM_Clients& theClients = theHost.GetClients();
+    theHost.GetIOPipeline().SetDSPOffloadWorkerCount(inDSPOffloadWorkers);
+    AddClients(theHost, 1, 8);
+    
+    theClients.SetMusicPlayer(static_cast<pid_t>(1001));
+    theClients.SetRoute(static_cast<pid_t>(1002), static_cast<pid_t>(1003), 0.5f, true);
+    theClients.SetRoute(static_cast<pid_t>(1004), static_cast<pid_t>(1003), 0.5f, true);
+    
+    CACFDictionary theMixMinus(true);
+    theMixMinus.AddSInt32(CFSTR(kBGMMixMinusKey_ProcessID), 1005);
+    CACFArray theMixMinusApps(true);
+    theMixMinusApps.AppendDictionary(theMixMinus.GetDict());
+    theClients.SetMixMinusApps(theMixMinusApps);
+    
+    CACFDictionary theCaptureFilter(true);
+    theCaptureFilter.AddString(CFSTR(kBGMCaptureFilterKey_ReaderBundleID),
+                               CACFString(BundleID(6).c_str()).GetCFString());
+    theCaptureFilter.AddSInt32(CFSTR(kBGMCaptureFilterKey_Mode), kBGMCaptureFilterModeExclude);
+    theCaptureFilter.AddArray(CFSTR(kBGMCaptureFilterKey_Apps), BundleIDs({ 7 }).GetCFArray());
+    CACFArray theCaptureFilters(true);
+    theCaptureFilters.AppendDictionary(theCaptureFilter.GetDict());
+    theClients.SetCaptureFilters(theCaptureFilters);
+    
+    CACFDictionary theCrossfader(true);
+    theCrossfader.AddArray(CFSTR(kBGMCrossfaderKey_GroupA), BundleIDs({ 2 }).GetCFArray());
+    theCrossfader.AddArray(CFSTR(kBGMCrossfaderKey_GroupB), BundleIDs({ 4 }).GetCFArray());
+    theCrossfader.AddFloat32(CFSTR(kBGMCrossfaderKey_Position), 0.25f);
+    theClients.SetCrossfader(theCrossfader);
+    
+    CACFDictionary theDucking(true);
+    theDucking.AddArray(CFSTR(kBGMDuckingKey_Triggers), BundleIDs({ 7 }).GetCFArray());
+    theDucking.AddArray(CFSTR(kBGMDuckingKey_Targets), BundleIDs({ 8 }).GetCFArray());
+    theDucking.AddBool(CFSTR(kBGMDuckingKey_DucksMusicPlayer), true);
+    theClients.SetDucking(theDucking);
+    
+    CACFDictionary theNormalization(true);
+    theNormalization.AddBool(CFSTR(kBGMLoudnessNormalizationKey_Enabled), true);
+    theClients.SetLoudnessNormalization(theNormalization);
+    
+    theHost.Run(WorkloadCycles(theHost), false);
+}
+
+// Clients starting and stopping IO and being added and removed between cycles, which makes
+// BGM_ClientMap publish new copies of the clients.
+static void RunChurn(UInt32 inBufferFrames)
+{
+    BGM_SimulatedHost theHost(kSampleRate, inBufferFrames);
+    AddClients(theHost, 1, 4);
+    
+    const UInt32 theCycles = WorkloadCycles(theHost);
+    UInt32 theNextClient = 5;
+    
+    for(UInt32 i = 0; i < theCycles; i += 4)
+    {
+        theHost.Run(4, false);
+        
+        // Replace the oldest client with a new one.
+        const UInt32 theOldestClient = theNextClient - 4;
+        theHost.RemoveClient(theOldestClient);
+        AddClients(theHost, theNextClient, 1);
+        theNextClient++;
+        
+        // And restart one of the others.
+        theHost.StopIO(theOldestClient + 1);
+        theHost.Run(1, false);
+        theHost.StartIO(theOldestClient + 1);
+    }
+}
+
+// Playback while recording an IO trace with audio.
+static void RunTrace(UInt32 inBufferFrames)
+{
+    char thePath[] = "/tmp/bgm-rt-safety-check-XXXXXX";
+    int theFile = mkstemp(thePath);
+    
+    if(theFile < 0)
+    {
+        std::fprintf(stderr, "Couldn't create a file for the trace\n");
+        return;
+    }
+    
+    // The recorder won't overwrite a file, so only the name is kept.
+    close(theFile);
+    unlink(thePath);
+    
+    {
+        BGM_SimulatedHost theHost(kSampleRate, inBufferFrames);
+        theHost.GetIOTraceRecorder().Start(thePath, /* inRecordAudio = */ true, kSampleRate);
+        AddClients(theHost, 1, 4);
+        theHost.Run(WorkloadCycles(theHost), false);
+        theHost.GetIOTraceRecorder().Stop();
+    }
+    
+    unlink(thePath);
+}
+
+struct BGM_Workload
+{
+    const char* mName;
+    std::function<void(UInt32 inBufferFrames)> mRun;
+};
+
+static const std::vector<BGM_Workload> kWorkloads = {
+    { "playback", RunPlayback },
+    { "features", [] (UInt32 inBufferFrames) { RunFeatures(inBufferFrames, 0); } },
+    { "offload",  [] (UInt32 inBufferFrames) { RunFeatures(inBufferFrames, 4); } },
+    { "churn",    RunChurn },
+    { "trace",    RunTrace }
+};
+
+#pragma mark Checks
+
+static bool Check(const char* inName, bool inPassed)
+{
+    std::printf("%-6s %s\n", inPassed ? "ok" : "FAILED", inName);
+    return inPassed;
+}
+
+static UInt64 CountUnsuppressed(const BGM_RTSafety::Counts& inCounts)
+{
+    UInt64 theTotal = 0;
+    
+    for(UInt32 i = 0; i < kBGMRTSafetyViolationTypeCount; i++)
+    {
+        theTotal += inCounts.mViolations[i];
+    }
+    
+    return theTotal - inCounts.mSuppressed;
+}
+
+static void PrintCounts(const char* inName, const BGM_RTSafety::Counts& inCounts)
+{
+    std::printf("%s: ", inName);
+    
+    for(UInt32 i = 0; i < kBGMRTSafetyViolationTypeCount; i++)
+    {
+        std::printf("%llu %s, ",
+                    inCounts.mViolations[i],
+                    BGM_RTSafety::GetViolationTypeName(static_cast<BGMRTSafetyViolation>(i)));
+    }
+    
+    std::printf("%llu known (%llu distinct stack traces)\n", inCounts.mSuppressed, inCounts.mDistinct);
+}
+
+// Check the interposers catch one violation of each type, so a broken build can't pass by
+// catching nothing.
+static bool CheckInterposers()
+{
+    bool thePassed = true;
+    
+    BGM_RTSafety::ResetCounts();
+    
+    {
+        BGMRTScope("CheckInterposers");
+        
+        // Volatile so the compiler can't remove the allocation.
+        void* volatile theBlock = std::malloc(64);
+        std::free(theBlock);
+        
+        std::mutex theMutex;
+        theMutex.lock();
+        theMutex.unlock();
+        
+        usleep(0);
+    }
+    
+    BGM_RTSafety::Counts theCounts = BGM_RTSafety::GetCounts();
+    thePassed &= Check("an allocation is caught", theCounts.mViolations[kBGMRTSafetyViolationAllocation] == 2);
+    thePassed &= Check("a lock is caught", theCounts.mViolations[kBGMRTSafetyViolationLock] == 1);
+    thePassed &= Check("a system call is caught", theCounts.mViolations[kBGMRTSafetyViolationSystemCall] == 1);
+    
+    // And that they don't catch anything outside a real-time scope.
+    BGM_RTSafety::ResetCounts();
+    
+    {
+        void* volatile theBlock = std::malloc(64);
+        std::free(theBlock);
+        
+        {
+            BGMRTScope("CheckInterposers");
+            BGMRTSafetyExempt("Checking exemptions work");
+            
+            theBlock = std::malloc(64);
+            std::free(theBlock);
+        }
+    }
+    
+    theCounts = BGM_RTSafety::GetCounts();
+    thePassed &= Check("nothing is caught outside a real-time scope", CountUnsuppressed(theCounts) == 0);
+    
+    BGM_RTSafety::ResetCounts();
+    
+    return thePassed;
+}
+
+static bool RunWorkload(const BGM_Workload& inWorkload, UInt32 inBufferFrames)
+{
+    BGM_RTSafety::ResetCounts();
+    
+    try
+    {
+        inWorkload.mRun(inBufferFrames);
+    }
+    catch(const CAException& inException)
+    {
+        std::fprintf(stderr, "The %s workload failed (%d)\n", inWorkload.mName, inException.GetError());
+        return false;
+    }
+    
+    BGM_RTSafety::Counts theCounts = BGM_RTSafety::GetCounts();
+    PrintCounts(inWorkload.mName, theCounts);
+    
+    std::string theName = std::string("no new violations in the ") + inWorkload.mName + " workload";
+    return Check(theName.c_str(), CountUnsuppressed(theCounts) == 0);
+}
+
+static void AddKnownViolations(bool inPrintKnown)
+{
+    for(const BGM_KnownViolation& theKnownViolation : kKnownViolations)
+    {
+        BGM_RTSafety::AddSuppression(theKnownViolation.mFunction);
+    }
+    
+    BGM_RTSafety::SetPrintSuppressed(inPrintKnown);
+}
+
+static int RunChecks(UInt32 inBufferFrames)
+{
+    AddKnownViolations(false);
+    
+    bool thePassed = CheckInterposers();
+    
+    for(const BGM_Workload& theWorkload : kWorkloads)
+    {
+        thePassed &= RunWorkload(theWorkload, inBufferFrames);
+    }
+    
+    return thePassed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#endif /* BGM_RTSafetyChecks && BGM_RTSafetyInterposersAvailable */
+
+int main(int argc, const char* argv[])
+{
+#if BGM_RTSafetyChecks && BGM_RTSafetyInterposersAvailable
+    std::vector<std::string> theArgs(argv + 1, argv + argc);
+    
+    // "known" can go at the end of "run".
+    const bool thePrintKnown = !theArgs.empty() && theArgs.back() == "known";
+    
+    if(thePrintKnown)
+    {
+        theArgs.pop_back();
+    }
+    
+    auto theNumberArg = [&] (size_t inArgIndex) {
+        return (theArgs.size() > inArgIndex) ?
+                static_cast<UInt32>(std::max(1, std::atoi(theArgs[inArgIndex].c_str()))) :
+                kDefaultBufferFrames;
+    };
+    
+    if(!thePrintKnown && (theArgs.empty() || (theArgs[0] == "check" && theArgs.size() <= 2)))
+    {
+        return RunChecks(theNumberArg(1));
+    }
+    else if(theArgs.size() >= 2 && theArgs.size() <= 3 && theArgs[0] == "run")
+    {
+        for(const BGM_Workload& theWorkload : kWorkloads)
+        {
+            if(theArgs[1] == theWorkload.mName)
+            {
+                AddKnownViolations(thePrintKnown);
+                return RunWorkload(theWorkload, theNumberArg(2)) ? EXIT_SUCCESS : EXIT_FAILURE;
+            }
+        }
+    }
+    
+    std::fprintf(stderr,
+                 "Usage: %s [check [buffer frames]]\n"
+                 "       %s run <playback|features|churn|trace> [buffer frames] [known]\n",
+                 argv[0], argv[0]);
+    return EXIT_FAILURE;
+#else
+    #pragma unused(argc, argv)
+    std::printf("The RT-safety checks aren't supported in this build. Skipping.\n");
+    return kSkippedExitCode;
+#endif
+}
@@ -0,0 +1,516 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_RingBufferBenchmark.cpp
+//  BGMDriver
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  Compares BGM_AudioRingBuffer with the CARingBuffer it replaced. Built by the portable CMake
+//  build (see DEVELOPING.md) as bgm-ring-buffer-benchmark.
+//
+//  Usage:
+//
+//      bgm-ring-buffer-benchmark check
+//          Runs random sequences of stores and fetches (including gaps, going backwards and
+//          stores that are too large) on both and checks BGM_AudioRingBuffer returns the same
+//          errors, time bounds and audio as CARingBuffer. Then stores and fetches from two threads
+//          and checks every fetch that succeeded got the right audio. Exits with an error if
+//          anything fails.
+//
+//      bgm-ring-buffer-benchmark benchmark [buffer frames]
+//          Prints the throughput and the latency percentiles of storing and fetching stereo audio
+//          the way BGMDevice's loopback does, for each ring buffer, on one thread and with the
+//          stores and fetches on different threads.
+//
+
+// Local Includes
+#include "BGM_AudioRingBuffer.h"
+
+// PublicUtility Includes
+#include "CARingBuffer.h"
+
+// STL Includes
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+static const UInt32 kChannels = 2;
+static const UInt32 kCapacityFrames = 16384;  // kLoopbackRingBufferFrameSize
+static const UInt32 kDefaultBufferFrames = 512;
+static const UInt32 kCheckOperations = 200000;
+// About ten minutes of audio at 44.1 kHz with 512-frame buffers.
+static const UInt32 kBenchmarkCycles = 50000;
+
+// Gives CARingBuffer the same interface, wrapping the buffers in AudioBufferLists like
+// BGM_IOPipeline used to.
+class CARingBufferAdapter
+{
+
+public:
+    typedef CARingBuffer::SampleTime SampleTime;
+
+    void Allocate(UInt32 inChannels, UInt32 inCapacityFrames)
+    {
+        mChannels = inChannels;
+        mBuffer.Allocate(1, inChannels * sizeof(Float32), inCapacityFrames);
+    }
+
+    CARingBufferError StoreRT(const Float32* inFrames, UInt32 inFrameCount, SampleTime inSampleTime)
+    {
+        AudioBufferList theABL = MakeABL(const_cast<Float32*>(inFrames), inFrameCount);
+        return mBuffer.Store(&theABL, inFrameCount, inSampleTime);
+    }
+
+    CARingBufferError FetchRT(Float32* outFrames, UInt32 inFrameCount, SampleTime inSampleTime)
+    {
+        AudioBufferList theABL = MakeABL(outFrames, inFrameCount);
+        return mBuffer.Fetch(&theABL, inFrameCount, inSampleTime);
+    }
+
+    CARingBufferError GetTimeBoundsRT(SampleTime& outStartTime, SampleTime& outEndTime)
+    {
+        return mBuffer.GetTimeBounds(outStartTime, outEndTime);
+    }
+
+private:
+    AudioBufferList MakeABL(Float32* inData, UInt32 inFrameCount) const
+    {
+        AudioBufferList theABL;
+        theABL.mNumberBuffers = 1;
+        theABL.mBuffers[0].mNumberChannels = mChannels;
+        theABL.mBuffers[0].mDataByteSize = inFrameCount * mChannels * sizeof(Float32);
+        theABL.mBuffers[0].mData = inData;
+        return theABL;
+    }
+
+    CARingBuffer    mBuffer;
+    UInt32          mChannels = 0;
+
+};
+
+// A signal where every sample identifies its sample time and channel, so torn reads can be found.
+static Float32 SampleValue(SInt64 inSampleTime, UInt32 inChannel)
+{
+    return static_cast<Float32>((inSampleTime * kChannels + inChannel) % 16000000 + 1);
+}
+
+static void Synthesize(Float32* outFrames, UInt32 inFrameCount, SInt64 inSampleTime)
+{
+    for(UInt32 i = 0; i < inFrameCount; i++)
+    {
+        for(UInt32 ch = 0; ch < kChannels; ch++)
+        {
+            outFrames[i * kChannels + ch] = SampleValue(inSampleTime + i, ch);
+        }
+    }
+}
+
+static bool Check(const char* inName, bool inPassed)
+{
+    std::printf("%s: %s\n", inPassed ? "PASS" : "FAIL", inName);
+    return inPassed;
+}
+
+#pragma mark Conformance
+
+template <typename RingBuffer>
+static bool CheckMatchesCARingBuffer(UInt32 inSeed)
+{
+    std::mt19937 theRandom(inSeed);
+    CARingBufferAdapter theReference;
+    RingBuffer theBuffer;
+
+    theReference.Allocate(kChannels, kCapacityFrames);
+    theBuffer.Allocate(kChannels, kCapacityFrames);
+
+    const UInt32 theMaxFrames = kCapacityFrames + 64;
+    std::vector<Float32> theInput(theMaxFrames * kChannels);
+    std::vector<Float32> theExpected(theMaxFrames * kChannels);
+    std::vector<Float32> theActual(theMaxFrames * kChannels);
+    SInt64 theWriteTime = 0;
+
+    for(UInt32 i = 0; i < kCheckOperations; i++)
+    {
+        UInt32 theOperation = theRandom() % 16;
+        // Mostly IO-sized buffers, sometimes anything up to a bit more than the capacity.
+        UInt32 theFrames = (theRandom() % 8 == 0) ? theRandom() % theMaxFrames : theRandom() % 1024;
+
+        if(theOperation < 8)
+        {
+            // Store, usually right after the last store but sometimes with a gap or going back.
+            SInt64 theSampleTime = theWriteTime;
+
+            if(theOperation == 0)
+            {
+                theSampleTime += theRandom() % (2 * kCapacityFrames);
+            }
+            else if(theOperation == 1)
+            {
+                theSampleTime = std::max(static_cast<SInt64>(0),
+                                         theSampleTime - static_cast<SInt64>(theRandom() % 4096));
+            }
+
+            Synthesize(theInput.data(), theFrames, theSampleTime);
+
+            CARingBufferError theReferenceError =
+                    theReference.StoreRT(theInput.data(), theFrames, theSampleTime);
+            CARingBufferError theError = theBuffer.StoreRT(theInput.data(), theFrames, theSampleTime);
+
+            if(theError != theReferenceError)
+            {
+                std::fprintf(stderr, "Store %u: error %d, expected %d\n", i, theError, theReferenceError);
+                return false;
+            }
+
+            if(theError == kCARingBufferError_OK && theFrames > 0)
+            {
+                theWriteTime = theSampleTime + theFrames;
+            }
+        }
+        else
+        {
+            // Fetch from somewhere around the time bounds.
+            SInt64 theSampleTime = theWriteTime - static_cast<SInt64>(theRandom() % (kCapacityFrames + 2048));
+
+            if(theOperation == 8)
+            {
+                theSampleTime = theWriteTime + (theRandom() % 1024) - 512;
+            }
+
+            std::fill(theExpected.begin(), theExpected.end(), -1.0f);
+            std::fill(theActual.begin(), theActual.end(), -1.0f);
+
+            CARingBufferError theReferenceError =
+                    theReference.FetchRT(theExpected.data(), theFrames, theSampleTime);
+            CARingBufferError theError = theBuffer.FetchRT(theActual.data(), theFrames, theSampleTime);
+
+            if(theError != theReferenceError ||
+               memcmp(theExpected.data(), theActual.data(), theFrames * kChannels * sizeof(Float32)) != 0)
+            {
+                std::fprintf(stderr,
+                             "Fetch %u of %u frames at %lld: error %d, expected %d, or the audio differed\n",
+                             i,
+                             theFrames,
+                             static_cast<long long>(theSampleTime),
+                             theError,
+                             theReferenceError);
+                return false;
+            }
+        }
+
+        SInt64 theReferenceStart, theReferenceEnd, theStart, theEnd;
+        theReference.GetTimeBoundsRT(theReferenceStart, theReferenceEnd);
+        theBuffer.GetTimeBoundsRT(theStart, theEnd);
+
+        if(theStart != theReferenceStart || theEnd != theReferenceEnd)
+        {
+            std::fprintf(stderr,
+                         "After operation %u: time bounds [%lld, %lld), expected [%lld, %lld)\n",
+                         i,
+                         static_cast<long long>(theStart),
+                         static_cast<long long>(theEnd),
+                         static_cast<long long>(theReferenceStart),
+                         static_cast<long long>(theReferenceEnd));
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Store on one thread and fetch recent audio on another, with the reader sometimes falling so far
+// behind that the writer overwrites what it's reading. Every fetch that succeeds should get exactly
+// the audio that was stored.
+template <typename RingBuffer>
+static UInt64 CountTornFetches(RingBuffer& ioBuffer, UInt32 inBufferFrames, UInt64& outFailedFetches)
+{
+    std::atomic<bool> theWriterDone(false);
+    std::atomic<SInt64> theWriteTime(0);
+
+    std::thread theWriter([&] {
+        std::vector<Float32> theInput(inBufferFrames * kChannels);
+
+        for(UInt32 i = 0; i < kBenchmarkCycles; i++)
+        {
+            SInt64 theSampleTime = static_cast<SInt64>(i) * inBufferFrames;
+            Synthesize(theInput.data(), inBufferFrames, theSampleTime);
+            ioBuffer.StoreRT(theInput.data(), inBufferFrames, theSampleTime);
+            theWriteTime.store(theSampleTime + inBufferFrames, std::memory_order_release);
+        }
+
+        theWriterDone = true;
+    });
+
+    std::vector<Float32> theOutput(kCapacityFrames * kChannels);
+    UInt64 theTornFetches = 0;
+    UInt64 theFetches = 0;
+    outFailedFetches = 0;
+
+    while(!theWriterDone)
+    {
+        // Read most of the buffer from its oldest end, which the writer is about to overwrite.
+        const UInt32 theFrames = kCapacityFrames / 2;
+        SInt64 theSampleTime = theWriteTime.load(std::memory_order_acquire) - kCapacityFrames + inBufferFrames;
+
+        if(theSampleTime < 0)
+        {
+            continue;
+        }
+
+        theFetches++;
+
+        if(ioBuffer.FetchRT(theOutput.data(), theFrames, theSampleTime) != kCARingBufferError_OK)
+        {
+            outFailedFetches++;
+            continue;
+        }
+
+        for(UInt32 i = 0; i < theFrames * kChannels; i++)
+        {
+            // Silence is fine, since the frames might have been outside the time bounds.
+            if(theOutput[i] != 0.0f && theOutput[i] != SampleValue(theSampleTime + i / kChannels, i % kChannels))
+            {
+                theTornFetches++;
+                break;
+            }
+        }
+    }
+
+    theWriter.join();
+
+    return theTornFetches;
+}
+
+static int RunChecks()
+{
+    bool thePassed = true;
+
+    thePassed &= Check("SPSC matches CARingBuffer", CheckMatchesCARingBuffer<BGM_SPSCAudioRingBuffer>(1));
+    thePassed &= Check("MPSC matches CARingBuffer", CheckMatchesCARingBuffer<BGM_MPSCAudioRingBuffer>(2));
+
+    BGM_SPSCAudioRingBuffer theBuffer;
+    theBuffer.Allocate(kChannels, kCapacityFrames);
+    UInt64 theFailedFetches = 0;
+    UInt64 theTornFetches = CountTornFetches(theBuffer, kDefaultBufferFrames, theFailedFetches);
+
+    std::printf("Concurrent fetches: %llu torn, %llu detected as overwritten\n",
+                theTornFetches,
+                theFailedFetches);
+    thePassed &= Check("No torn fetches", theTornFetches == 0);
+
+    // One store at a time for MPSC.
+    BGM_MPSCAudioRingBuffer theMPSCBuffer;
+    theMPSCBuffer.Allocate(kChannels, kCapacityFrames);
+    std::atomic<UInt64> theOverloads(0);
+    std::vector<std::thread> theWriters;
+
+    for(UInt32 w = 0; w < 4; w++)
+    {
+        theWriters.emplace_back([&] {
+            std::vector<Float32> theInput(kDefaultBufferFrames * kChannels, 0.5f);
+
+            for(UInt32 i = 0; i < 20000; i++)
+            {
+                if(theMPSCBuffer.StoreRT(theInput.data(), kDefaultBufferFrames, 0) ==
+                   kCARingBufferError_CPUOverload)
+                {
+                    theOverloads++;
+                }
+            }
+        });
+    }
+
+    for(std::thread& theWriter : theWriters)
+    {
+        theWriter.join();
+    }
+
+    SInt64 theStart, theEnd;
+    thePassed &= Check("MPSC time bounds stay consistent",
+                       theMPSCBuffer.GetTimeBoundsRT(theStart, theEnd) == kCARingBufferError_OK &&
+                       theStart == 0 &&
+                       theEnd == kDefaultBufferFrames);
+    std::printf("MPSC: %llu stores refused while another thread was storing\n", theOverloads.load());
+
+    return thePassed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#pragma mark Benchmark
+
+static void PrintLatencies(const char* inName, std::vector<UInt64>& ioNanos, UInt64 inFrames)
+{
+    std::sort(ioNanos.begin(), ioNanos.end());
+
+    UInt64 theTotalNanos = 0;
+
+    for(UInt64 theNanos : ioNanos)
+    {
+        theTotalNanos += theNanos;
+    }
+
+    auto percentile = [&] (Float64 inPercentile) {
+        return ioNanos[std::min(ioNanos.size() - 1, static_cast<size_t>(ioNanos.size() * inPercentile))];
+    };
+
+    std::printf("  %-6s %9.1f Mframes/s, median %6llu ns, p99 %6llu ns, p99.9 %6llu ns, max %7llu ns\n",
+                inName,
+                1000.0 * inFrames / std::max(theTotalNanos, static_cast<UInt64>(1)),
+                percentile(0.5),
+                percentile(0.99),
+                percentile(0.999),
+                ioNanos.back());
+}
+
+static UInt64 NanosSince(std::chrono::steady_clock::time_point inStart)
+{
+    return static_cast<UInt64>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+                                                                 inStart).count());
+}
+
+template <typename RingBuffer>
+static void Benchmark(const char* inName, UInt32 inBufferFrames)
+{
+    std::printf("%s, %u-frame buffers:\n", inName, inBufferFrames);
+
+    // One thread, like BGMDevice's IO thread, which stores the mix in WriteMix and fetches it in
+    // the next cycle's ReadInput.
+    {
+        RingBuffer theBuffer;
+        theBuffer.Allocate(kChannels, kCapacityFrames);
+
+        std::vector<Float32> theInput(inBufferFrames * kChannels);
+        std::vector<Float32> theOutput(inBufferFrames * kChannels);
+        std::vector<UInt64> theStoreNanos, theFetchNanos;
+        theStoreNanos.reserve(kBenchmarkCycles);
+        theFetchNanos.reserve(kBenchmarkCycles);
+
+        Synthesize(theInput.data(), inBufferFrames, 0);
+
+        for(UInt32 i = 0; i < kBenchmarkCycles; i++)
+        {
+            SInt64 theSampleTime = static_cast<SInt64>(i) * inBufferFrames;
+
+            auto theStart = std::chrono::steady_clock::now();
+            theBuffer.FetchRT(theOutput.data(), inBufferFrames, theSampleTime - inBufferFrames);
+            theFetchNanos.push_back(NanosSince(theStart));
+
+            theStart = std::chrono::steady_clock::now();
+            theBuffer.StoreRT(theInput.data(), inBufferFrames, theSampleTime);
+            theStoreNanos.push_back(NanosSince(theStart));
+        }
+
+        std::printf(" One thread\n");
+        PrintLatencies("Store", theStoreNanos, static_cast<UInt64>(kBenchmarkCycles) * inBufferFrames);
+        PrintLatencies("Fetch", theFetchNanos, static_cast<UInt64>(kBenchmarkCycles) * inBufferFrames);
+    }
+
+    // Two threads, like BGMPlayThrough's input and output IOProcs, with the reader following the
+    // writer as closely as it can.
+    {
+        RingBuffer theBuffer;
+        theBuffer.Allocate(kChannels, kCapacityFrames);
+
+        std::atomic<bool> theWriterDone(false);
+        std::atomic<SInt64> theWriteTime(0);
+        std::vector<UInt64> theStoreNanos, theFetchNanos;
+        theStoreNanos.reserve(kBenchmarkCycles);
+        theFetchNanos.reserve(kBenchmarkCycles * 4);
+
+        std::thread theWriter([&] {
+            std::vector<Float32> theInput(inBufferFrames * kChannels);
+            Synthesize(theInput.data(), inBufferFrames, 0);
+
+            for(UInt32 i = 0; i < kBenchmarkCycles; i++)
+            {
+                SInt64 theSampleTime = static_cast<SInt64>(i) * inBufferFrames;
+
+                auto theStart = std::chrono::steady_clock::now();
+                theBuffer.StoreRT(theInput.data(), inBufferFrames, theSampleTime);
+                theStoreNanos.push_back(NanosSince(theStart));
+
+                theWriteTime.store(theSampleTime + inBufferFrames, std::memory_order_release);
+            }
+
+            theWriterDone = true;
+        });
+
+        std::vector<Float32> theOutput(inBufferFrames * kChannels);
+        UInt64 theFailedFetches = 0;
+        UInt64 theFetchedFrames = 0;
+
+        while(!theWriterDone)
+        {
+            SInt64 theSampleTime = theWriteTime.load(std::memory_order_acquire) - inBufferFrames;
+
+            auto theStart = std::chrono::steady_clock::now();
+            CARingBufferError theError = theBuffer.FetchRT(theOutput.data(), inBufferFrames, theSampleTime);
+            theFetchNanos.push_back(NanosSince(theStart));
+
+            theFetchedFrames += inBufferFrames;
+            theFailedFetches += (theError != kCARingBufferError_OK) ? 1 : 0;
+        }
+
+        theWriter.join();
+
+        std::printf(" Two threads (%llu of %zu fetches failed)\n", theFailedFetches, theFetchNanos.size());
+        PrintLatencies("Store", theStoreNanos, static_cast<UInt64>(kBenchmarkCycles) * inBufferFrames);
+
+        if(!theFetchNanos.empty())
+        {
+            PrintLatencies("Fetch", theFetchNanos, theFetchedFrames);
+        }
+    }
+}
+
+int main(int argc, const char* argv[])
+{
+    const std::string theCommand = (argc > 1) ? argv[1] : "benchmark";
+
+    if(theCommand == "check" && argc == 2)
+    {
+        return RunChecks();
+    }
+    else if(theCommand == "benchmark" && argc <= 3)
+    {
+        UInt32 theBufferFrames =
+                (argc > 2) ? static_cast<UInt32>(std::max(1, std::atoi(argv[2]))) : kDefaultBufferFrames;
+        theBufferFrames = std::min(theBufferFrames, kCapacityFrames / 4);
+
+        Benchmark<CARingBufferAdapter>("CARingBuffer", theBufferFrames);
+        Benchmark<BGM_SPSCAudioRingBuffer>("BGM_SPSCAudioRingBuffer", theBufferFrames);
+        Benchmark<BGM_MPSCAudioRingBuffer>("BGM_MPSCAudioRingBuffer", theBufferFrames);
+
+        return EXIT_SUCCESS;
+    }
+
+    std::fprintf(stderr,
+                 "Usage: %s check\n"
+                 "       %s benchmark [buffer frames]\n",
+                 argv[0], argv[0]);
+    return EXIT_FAILURE;
+}
+
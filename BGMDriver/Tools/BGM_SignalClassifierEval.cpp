@@ -0,0 +1,448 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_SignalClassifierEval.cpp
+//  BGMDriver
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  An offline evaluation harness and benchmark for BGM_SignalClassifier. Doesn't need CoreAudio,
+//  so it can be built on any platform with a C++11 compiler and MacTypes.h (or a stand-in for it).
+//  On macOS:
+//
+//      clang++ -std=c++11 -O2 -I BGMDriver/BGMDriver -framework Accelerate
+//          BGMDriver/Tools/BGM_SignalClassifierEval.cpp BGMDriver/BGMDriver/BGM_SignalClassifier.cpp
+//          -o bgm-classifier-eval
+//
+//  Usage:
+//
+//      bgm-classifier-eval generate <dir>
+//          Writes a set of synthetic labelled clips (speech-like, music-like, notification pings,
+//          clicks and short alerts) to <dir> as WAV files, and <dir>/labels.txt.
+//
+//      bgm-classifier-eval evaluate <labels file> [buffer frames]
+//          Classifies each clip in the labels file, which has a line for each clip with its path
+//          (relative to the labels file) and its label, "sustained" or "transient", separated by
+//          whitespace. A clip is classified as sustained if the classifier reports kClassSustained
+//          at any point in it. Prints the results and exits with an error if any clip is
+//          misclassified. The clips can be 16-bit integer or 32-bit float WAV files, mono or
+//          stereo.
+//
+//      bgm-classifier-eval benchmark [buffer frames]
+//          Prints the average time ProcessRT takes per IO cycle.
+//
+
+// Local Includes
+#include "BGM_SignalClassifier.h"
+#include "BGM_WAVFile.h"
+
+// STL Includes
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+static const Float64 kSampleRate = 48000.0;
+static const UInt32 kDefaultBufferFrames = 512;
+static const Float64 kPi = 3.14159265358979323846;
+
+#pragma mark Synthetic Clips
+
+// A deterministic noise source, so the generated clips are the same every time.
+class Noise
+{
+public:
+    explicit Noise(uint32_t inSeed) : mState(inSeed) { }
+
+    // Uniform in [-1, 1).
+    Float32 Next()
+    {
+        mState = mState * 1664525u + 1013904223u;
+        return static_cast<Float32>(mState >> 8) / static_cast<Float32>(1 << 23) - 1.0f;
+    }
+
+private:
+    uint32_t mState;
+};
+
+static Clip MakeSilence(Float64 inSecs)
+{
+    Clip theClip;
+    theClip.mSamples.assign(static_cast<size_t>(inSecs * kSampleRate) * 2, 0.0f);
+    return theClip;
+}
+
+static void Append(Clip& ioClip, const Clip& inOther)
+{
+    ioClip.mSamples.insert(ioClip.mSamples.end(), inOther.mSamples.begin(), inOther.mSamples.end());
+}
+
+// Syllable-like bursts of a voiced harmonic complex with a wandering pitch and breathy noise,
+// separated by short pauses.
+static Clip MakeSpeechLike(Float64 inSecs, Float32 inPitch, uint32_t inSeed)
+{
+    Noise theNoise(inSeed);
+    Clip theClip = MakeSilence(inSecs);
+    const UInt32 theFrames = theClip.GetFrameCount();
+
+    Float64 thePhase = 0.0;
+    Float64 theSyllableStart = 0.0;
+    Float64 theSyllableLength = 0.18;
+
+    for(UInt32 i = 0; i < theFrames; i++)
+    {
+        const Float64 t = i / kSampleRate;
+
+        // Each syllable is followed by a pause of a third of its length.
+        if(t > theSyllableStart + theSyllableLength * 1.33)
+        {
+            theSyllableStart = t;
+            theSyllableLength = 0.12 + 0.1 * (theNoise.Next() + 1.0f);
+        }
+
+        const Float64 thePosition = (t - theSyllableStart) / theSyllableLength;
+        const Float64 theEnvelope = (thePosition < 1.0) ? std::sin(kPi * thePosition) : 0.0;
+
+        const Float64 thePitch = inPitch * (1.0 + 0.1 * std::sin(2.0 * kPi * 0.7 * t));
+        thePhase += 2.0 * kPi * thePitch / kSampleRate;
+
+        Float64 theVoice = 0.0;
+        for(int theHarmonic = 1; theHarmonic <= 12; theHarmonic++)
+        {
+            // Emphasise the harmonics near a formant that moves from syllable to syllable.
+            const Float64 theFormant = 500.0 + 1500.0 * std::fmod(theSyllableStart * 3.7, 1.0);
+            const Float64 theDistance = std::fabs(theHarmonic * thePitch - theFormant) / 400.0;
+            theVoice += std::sin(theHarmonic * thePhase) / (1.0 + theDistance * theDistance) / theHarmonic;
+        }
+
+        const Float32 theSample =
+                static_cast<Float32>(0.25 * theEnvelope * (theVoice + 0.05 * theNoise.Next()));
+
+        theClip.mSamples[i * 2] = theSample;
+        theClip.mSamples[i * 2 + 1] = theSample;
+    }
+
+    return theClip;
+}
+
+// A sequence of chords of harmonic tones, each held for a beat, with a soft attack.
+static Clip MakeMusicLike(Float64 inSecs, Float64 inBeatSecs, uint32_t inSeed)
+{
+    Noise theNoise(inSeed);
+    Clip theClip = MakeSilence(inSecs);
+    const UInt32 theFrames = theClip.GetFrameCount();
+
+    Float64 theRoot = 220.0;
+    Float64 thePhases[3] = { 0.0, 0.0, 0.0 };
+
+    for(UInt32 i = 0; i < theFrames; i++)
+    {
+        const Float64 t = i / kSampleRate;
+        const Float64 theBeatPosition = std::fmod(t, inBeatSecs);
+
+        // Change chord on each beat.
+        if(i > 0 && theBeatPosition < 1.0 / kSampleRate)
+        {
+            theRoot = 196.0 * std::pow(2.0, std::floor((theNoise.Next() + 1.0f) * 6.0) / 12.0);
+        }
+
+        const Float64 theEnvelope = std::min(1.0, theBeatPosition / 0.01) * (0.7 + 0.3 * std::exp(-theBeatPosition * 4.0));
+        const Float64 theRatios[3] = { 1.0, 1.25, 1.5 };
+
+        Float64 theSample = 0.0;
+        for(int theNote = 0; theNote < 3; theNote++)
+        {
+            thePhases[theNote] += 2.0 * kPi * theRoot * theRatios[theNote] / kSampleRate;
+            theSample += std::sin(thePhases[theNote]) + 0.3 * std::sin(2.0 * thePhases[theNote]);
+        }
+
+        theClip.mSamples[i * 2] = static_cast<Float32>(0.12 * theEnvelope * theSample);
+        theClip.mSamples[i * 2 + 1] = static_cast<Float32>(0.1 * theEnvelope * theSample);
+    }
+
+    return theClip;
+}
+
+// A notification ping: a couple of partials with a fast attack and an exponential decay.
+static Clip MakePing(Float64 inSecs, Float64 inFrequency, Float64 inDecaySecs)
+{
+    Clip theClip = MakeSilence(inSecs);
+    const UInt32 theFrames = theClip.GetFrameCount();
+
+    for(UInt32 i = 0; i < theFrames; i++)
+    {
+        const Float64 t = i / kSampleRate;
+        const Float64 theEnvelope = std::min(1.0, t / 0.003) * std::exp(-t / inDecaySecs);
+        const Float32 theSample = static_cast<Float32>(0.4 * theEnvelope *
+                (std::sin(2.0 * kPi * inFrequency * t) + 0.5 * std::sin(2.0 * kPi * inFrequency * 2.76 * t)));
+
+        theClip.mSamples[i * 2] = theSample;
+        theClip.mSamples[i * 2 + 1] = theSample;
+    }
+
+    return theClip;
+}
+
+// A short click of noise, like a UI sound.
+static Clip MakeClick(Float64 inClickSecs, uint32_t inSeed)
+{
+    Noise theNoise(inSeed);
+    Clip theClip = MakeSilence(inClickSecs);
+
+    for(Float32& theSample : theClip.mSamples)
+    {
+        theSample = 0.5f * theNoise.Next();
+    }
+
+    return theClip;
+}
+
+static int Generate(const std::string& inDirectory)
+{
+    struct LabelledClip
+    {
+        std::string mName;
+        Clip        mClip;
+        bool        mIsSustained;
+    };
+
+    std::vector<LabelledClip> theClips;
+
+    auto thePadded = [] (const Clip& inClip) {
+        Clip thePaddedClip = MakeSilence(0.25);
+        Append(thePaddedClip, inClip);
+        Append(thePaddedClip, MakeSilence(0.5));
+        return thePaddedClip;
+    };
+
+    theClips.push_back({ "speech-low.wav", thePadded(MakeSpeechLike(3.0, 110.0f, 1)), true });
+    theClips.push_back({ "speech-high.wav", thePadded(MakeSpeechLike(2.0, 210.0f, 2)), true });
+    theClips.push_back({ "speech-short.wav", thePadded(MakeSpeechLike(1.0, 160.0f, 3)), true });
+    theClips.push_back({ "music-slow.wav", thePadded(MakeMusicLike(3.0, 0.75, 4)), true });
+    theClips.push_back({ "music-fast.wav", thePadded(MakeMusicLike(2.0, 0.25, 5)), true });
+    theClips.push_back({ "ping-short.wav", thePadded(MakePing(0.4, 1318.5, 0.06)), false });
+    theClips.push_back({ "ping-long.wav", thePadded(MakePing(1.2, 880.0, 0.12)), false });
+    theClips.push_back({ "ping-low.wav", thePadded(MakePing(0.8, 523.3, 0.09)), false });
+    theClips.push_back({ "click.wav", thePadded(MakeClick(0.005, 6)), false });
+
+    // Two quick alert tones.
+    Clip theAlert = MakePing(0.15, 1046.5, 0.05);
+    Append(theAlert, MakePing(0.3, 1568.0, 0.07));
+    theClips.push_back({ "alert-two-tone.wav", thePadded(theAlert), false });
+
+    // Clicks spaced far enough apart that they're separate sounds.
+    Clip theClicks;
+    for(uint32_t i = 0; i < 4; i++)
+    {
+        Append(theClicks, MakeClick(0.005, 7 + i));
+        Append(theClicks, MakeSilence(0.4));
+    }
+    theClips.push_back({ "clicks.wav", thePadded(theClicks), false });
+
+    std::ofstream theLabels((inDirectory + "/labels.txt").c_str());
+
+    if(!theLabels)
+    {
+        std::fprintf(stderr, "Couldn't write %s/labels.txt\n", inDirectory.c_str());
+        return EXIT_FAILURE;
+    }
+
+    theLabels << "# Synthetic clips generated by bgm-classifier-eval\n";
+
+    for(const LabelledClip& theClip : theClips)
+    {
+        if(!WriteWAV(inDirectory + "/" + theClip.mName, theClip.mClip))
+        {
+            std::fprintf(stderr, "Couldn't write %s/%s\n", inDirectory.c_str(), theClip.mName.c_str());
+            return EXIT_FAILURE;
+        }
+
+        theLabels << theClip.mName << " " << (theClip.mIsSustained ? "sustained" : "transient") << "\n";
+    }
+
+    std::printf("Wrote %zu clips to %s\n", theClips.size(), inDirectory.c_str());
+    return EXIT_SUCCESS;
+}
+
+#pragma mark Evaluation
+
+static bool ClassifyClip(const Clip& inClip, UInt32 inBufferFrames)
+{
+    BGM_SignalClassifier theClassifier(inClip.mSampleRate);
+    bool wasSustained = false;
+
+    for(UInt32 theFrame = 0; theFrame < inClip.GetFrameCount(); theFrame += inBufferFrames)
+    {
+        const UInt32 theFrames = std::min(inBufferFrames, inClip.GetFrameCount() - theFrame);
+        BGM_SignalClassifier::Class theClass =
+                theClassifier.ProcessRT(inClip.mSamples.data() + theFrame * 2, theFrames);
+
+        wasSustained = wasSustained || (theClass == BGM_SignalClassifier::kClassSustained);
+    }
+
+    return wasSustained;
+}
+
+static int Evaluate(const std::string& inLabelsPath, UInt32 inBufferFrames)
+{
+    std::ifstream theLabels(inLabelsPath.c_str());
+
+    if(!theLabels)
+    {
+        std::fprintf(stderr, "Couldn't read %s\n", inLabelsPath.c_str());
+        return EXIT_FAILURE;
+    }
+
+    const size_t theSlash = inLabelsPath.find_last_of('/');
+    const std::string theDirectory = (theSlash == std::string::npos) ? "." : inLabelsPath.substr(0, theSlash);
+
+    // [actual][predicted], where 1 is sustained.
+    UInt32 theConfusion[2][2] = { { 0, 0 }, { 0, 0 } };
+    std::string theLine;
+
+    while(std::getline(theLabels, theLine))
+    {
+        std::istringstream theFields(theLine);
+        std::string thePath;
+        std::string theLabel;
+
+        if(!(theFields >> thePath >> theLabel) || thePath[0] == '#')
+        {
+            continue;
+        }
+
+        if(theLabel != "sustained" && theLabel != "transient")
+        {
+            std::fprintf(stderr, "Unknown label \"%s\" for %s\n", theLabel.c_str(), thePath.c_str());
+            return EXIT_FAILURE;
+        }
+
+        Clip theClip;
+
+        if(!ReadWAV(thePath[0] == '/' ? thePath : theDirectory + "/" + thePath, theClip))
+        {
+            std::fprintf(stderr, "Couldn't read %s\n", thePath.c_str());
+            return EXIT_FAILURE;
+        }
+
+        const bool isSustained = (theLabel == "sustained");
+        const bool wasClassifiedSustained = ClassifyClip(theClip, inBufferFrames);
+
+        theConfusion[isSustained][wasClassifiedSustained]++;
+
+        std::printf("%-6s %-30s %-10s %s\n",
+                    (isSustained == wasClassifiedSustained) ? "ok" : "WRONG",
+                    thePath.c_str(),
+                    theLabel.c_str(),
+                    wasClassifiedSustained ? "sustained" : "transient");
+    }
+
+    const UInt32 theTotal = theConfusion[0][0] + theConfusion[0][1] + theConfusion[1][0] + theConfusion[1][1];
+    const UInt32 theCorrect = theConfusion[0][0] + theConfusion[1][1];
+
+    std::printf("\n                     predicted transient   predicted sustained\n");
+    std::printf("actually transient   %19u   %19u\n", theConfusion[0][0], theConfusion[0][1]);
+    std::printf("actually sustained   %19u   %19u\n", theConfusion[1][0], theConfusion[1][1]);
+    std::printf("\n%u/%u correct with %u-frame buffers\n", theCorrect, theTotal, inBufferFrames);
+
+    return (theTotal > 0 && theCorrect == theTotal) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#pragma mark Benchmark
+
+static int Benchmark(UInt32 inBufferFrames)
+{
+    const UInt32 kCycles = 20000;
+
+    Clip theClip = MakeSpeechLike(2.0, 150.0f, 1);
+    BGM_SignalClassifier theClassifier(kSampleRate);
+
+    // Loop over the clip so the classifier sees onsets and gaps like it would with real audio.
+    UInt32 theFrame = 0;
+    UInt32 theSustainedCycles = 0;
+
+    auto theStart = std::chrono::steady_clock::now();
+
+    for(UInt32 theCycle = 0; theCycle < kCycles; theCycle++)
+    {
+        if(theFrame + inBufferFrames > theClip.GetFrameCount())
+        {
+            theFrame = 0;
+        }
+
+        if(theClassifier.ProcessRT(theClip.mSamples.data() + theFrame * 2, inBufferFrames) ==
+                BGM_SignalClassifier::kClassSustained)
+        {
+            theSustainedCycles++;
+        }
+
+        theFrame += inBufferFrames;
+    }
+
+    auto theEnd = std::chrono::steady_clock::now();
+
+    const Float64 theNanosPerCycle =
+            std::chrono::duration<Float64, std::nano>(theEnd - theStart).count() / kCycles;
+    const Float64 theCycleNanos = inBufferFrames / kSampleRate * 1.0e9;
+
+    std::printf("%u-frame buffers: %.0f ns per cycle, %.3f%% of the cycle at %.0f Hz (%u sustained)\n",
+                inBufferFrames,
+                theNanosPerCycle,
+                100.0 * theNanosPerCycle / theCycleNanos,
+                kSampleRate,
+                theSustainedCycles);
+
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, const char* argv[])
+{
+    const std::string theCommand = (argc > 1) ? argv[1] : "";
+
+    auto theBufferFrames = [&] (int inArgIndex) {
+        return (argc > inArgIndex) ? static_cast<UInt32>(std::max(1, std::atoi(argv[inArgIndex]))) : kDefaultBufferFrames;
+    };
+
+    if(theCommand == "generate" && argc == 3)
+    {
+        return Generate(argv[2]);
+    }
+    else if(theCommand == "evaluate" && (argc == 3 || argc == 4))
+    {
+        return Evaluate(argv[2], theBufferFrames(3));
+    }
+    else if(theCommand == "benchmark" && argc <= 3)
+    {
+        return Benchmark(theBufferFrames(2));
+    }
+
+    std::fprintf(stderr,
+                 "Usage: %s generate <dir>\n"
+                 "       %s evaluate <labels file> [buffer frames]\n"
+                 "       %s benchmark [buffer frames]\n",
+                 argv[0], argv[0], argv[0]);
+    return EXIT_FAILURE;
+}
+
@@ -0,0 +1,767 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_SimulatedHostTool.cpp
+//  BGMDriver
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  Runs the driver's core under BGM_SimulatedHost, without coreaudiod. Built by the portable CMake
+//  build (see DEVELOPING.md) as bgm-simulated-host.
+//
+//  Usage:
+//
+//      bgm-simulated-host [check [buffer frames]]
+//          Runs IO cycles with a few clients and checks the loopback audio, per-client volumes,
+//          audible state and IO running notifications behave like they do in coreaudiod, and that
+//          processing is shed by priority when the cycles are overloaded or start late and that
+//          offloading the DSP to worker threads only delays the clients' output by one cycle,
+//          without moving their automation. Exits with an error if anything fails.
+//
+//      bgm-simulated-host benchmark [clients] [buffer frames]
+//          Prints the average and worst time per IO cycle with the given number of clients
+//          playing, running the cycles back to back.
+//
+//      bgm-simulated-host scaling [clients] [buffer frames]
+//          Runs the benchmark for a few seconds of audio with the DSP on the IO thread and then
+//          offloaded to 1, 2, 4, 8 and 16 worker threads, and prints how the time per cycle scales.
+//          The clients all have EQ, so there's some DSP to offload. Only meaningful with at least as
+//          many free cores as workers.
+//
+//      bgm-simulated-host run <seconds> [clients] [buffer frames]
+//          Runs IO in real time and prints the cycle times, e.g. to check for overloads while
+//          profiling.
+//
+//      bgm-simulated-host record <trace file> [seconds] [clients] [buffer frames]
+//          Runs IO in real time with clients starting and stopping IO at different times and
+//          records a trace of the IO operations, including the audio, for bgm-io-trace-replay.
+//
+
+// Local Includes
+#include "BGM_SimulatedHost.h"
+#include "BGM_Types.h"
+
+// PublicUtility Includes
+#include "CACFArray.h"
+#include "CACFDictionary.h"
+#include "CAException.h"
+#include "CAHostTimeBase.h"
+
+// STL Includes
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+static const Float64 kSampleRate = 44100.0;
+static const UInt32 kDefaultBufferFrames = 512;
+static const UInt32 kDefaultClients = 8;
+static const Float32 kTolerance = 1.0e-5f;
+static const UInt32 kNotificationTimeoutMS = 2000;
+
+// A generator for a sine tone, which the signal classifier considers sustained.
+static BGM_SimulatedHost::BGM_OutputGenerator MakeSine(Float64 inFrequency, Float32 inAmplitude)
+{
+    return [=] (UInt32 inIOBufferFrameSize, Float64 inSampleTime, Float32* outBuffer) {
+        for(UInt32 i = 0; i < inIOBufferFrameSize; i++)
+        {
+            Float32 theSample = inAmplitude *
+                    static_cast<Float32>(std::sin(2.0 * M_PI * inFrequency * (inSampleTime + i) / kSampleRate));
+            outBuffer[i * 2] = theSample;
+            outBuffer[i * 2 + 1] = theSample;
+        }
+    };
+}
+
+// A generator for silence that takes ioLoad times the IO buffer's duration to run in the host's
+// simulated time, to overload the IO cycles. ioLoad can be changed between cycles.
+static BGM_SimulatedHost::BGM_OutputGenerator MakeSlowSilence(BGM_SimulatedHost& ioHost, const Float64& ioLoad)
+{
+    return [&ioHost, &ioLoad] (UInt32 inIOBufferFrameSize, Float64 inSampleTime, Float32* outBuffer) {
+        (void)inSampleTime;
+        
+        ioHost.AdvanceSimulatedTime(ioLoad * inIOBufferFrameSize);
+        std::fill(outBuffer, outBuffer + inIOBufferFrameSize * 2, 0.0f);
+    };
+}
+
+static Float32 MaxDifference(const std::vector<Float32>& inA, const std::vector<Float32>& inB)
+{
+    Float32 theMax = 0.0f;
+    
+    for(size_t i = 0; i < std::min(inA.size(), inB.size()); i++)
+    {
+        theMax = std::max(theMax, std::fabs(inA[i] - inB[i]));
+    }
+    
+    return theMax;
+}
+
+static bool Check(const char* inName, bool inPassed)
+{
+    std::printf("%-6s %s\n", inPassed ? "ok" : "FAILED", inName);
+    return inPassed;
+}
+
+static bool SetRelativeVolume(BGM_SimulatedHost& ioHost, pid_t inProcessID, SInt32 inRawVolume)
+{
+    CACFDictionary theAppVolume(true);
+    theAppVolume.AddSInt32(CFSTR(kBGMAppVolumesKey_ProcessID), inProcessID);
+    theAppVolume.AddSInt32(CFSTR(kBGMAppVolumesKey_RelativeVolume), inRawVolume);
+    
+    CACFArray theAppVolumes(true);
+    theAppVolumes.AppendDictionary(theAppVolume.GetDict());
+    
+    return ioHost.GetClients().SetClientsRelativeVolumes(theAppVolumes);
+}
+
+static bool SetAppPriority(BGM_SimulatedHost& ioHost, pid_t inProcessID, BGMAppPriority inPriority)
+{
+    CACFDictionary theAppPriority(true);
+    theAppPriority.AddSInt32(CFSTR(kBGMAppPriorityKey_ProcessID), inProcessID);
+    theAppPriority.AddSInt32(CFSTR(kBGMAppPriorityKey_Priority), inPriority);
+    
+    CACFArray theAppPriorities(true);
+    theAppPriorities.AppendDictionary(theAppPriority.GetDict());
+    
+    return ioHost.GetClients().SetAppPriorities(theAppPriorities);
+}
+
+// Set the EQ of each of the apps to the same gains, so they all have some DSP to offload.
+static bool SetEQ(BGM_SimulatedHost& ioHost, const std::vector<pid_t>& inProcessIDs)
+{
+    CACFArray theAppEQs(true);
+    
+    for(pid_t theProcessID : inProcessIDs)
+    {
+        CACFDictionary theAppEQ(true);
+        theAppEQ.AddSInt32(CFSTR(kBGMAppVolumesKey_ProcessID), theProcessID);
+        theAppEQ.AddSInt32(CFSTR(kBGMAppVolumesKey_EQLowGain), 60);
+        theAppEQ.AddSInt32(CFSTR(kBGMAppVolumesKey_EQMidGain), -30);
+        theAppEQ.AddSInt32(CFSTR(kBGMAppVolumesKey_EQHighGain), 40);
+        theAppEQs.AppendDictionary(theAppEQ.GetDict());
+    }
+    
+    return ioHost.GetClients().SetClientsRelativeVolumes(theAppEQs);
+}
+
+// The output of each client and the mix for each of inCycles cycles with the DSP offloaded to
+// inWorkers worker threads, or not offloaded if it's 0, and the latency the pipeline reported for
+// the offloading afterwards.
+struct BGM_RecordedIO
+{
+    std::vector<std::vector<Float32>> mClientOutputs[2];
+    std::vector<std::vector<Float32>> mMixes;
+    UInt32 mLatencyFrames = 0;
+};
+
+static BGM_RecordedIO RecordIO(UInt32 inBufferFrames, UInt32 inWorkers, UInt32 inCycles)
+{
+    BGM_SimulatedHost theHost(kSampleRate, inBufferFrames);
+    theHost.GetIOPipeline().SetDSPOffloadWorkerCount(inWorkers);
+    
+    theHost.AddClient(1, 101, "com.example.one", MakeSine(440.0, 0.25f));
+    theHost.AddClient(2, 202, "com.example.two", MakeSine(660.0, 0.25f));
+    SetRelativeVolume(theHost, 101, 40);
+    SetEQ(theHost, { 101, 202 });
+    theHost.StartIO(1);
+    theHost.StartIO(2);
+    
+    BGM_RecordedIO theRecordedIO;
+    
+    for(UInt32 i = 0; i < inCycles; i++)
+    {
+        theHost.RunCycle();
+        theRecordedIO.mClientOutputs[0].push_back(theHost.GetClientOutput(1));
+        theRecordedIO.mClientOutputs[1].push_back(theHost.GetClientOutput(2));
+        theRecordedIO.mMixes.push_back(theHost.GetMix());
+    }
+    
+    theRecordedIO.mLatencyFrames = theHost.GetIOPipeline().GetDSPOffloadLatencyFrames();
+    
+    theHost.StopIO(1);
+    theHost.StopIO(2);
+    theHost.RemoveClient(1);
+    theHost.RemoveClient(2);
+    
+    return theRecordedIO;
+}
+
+// The mix of a client playing a constant signal, with its gain automated down to -20 dB at
+// inOnsetSampleTime and the DSP offloaded to inWorkers worker threads (or not if it's 0). Returns
+// the frame of the mix the gain changed on, not counting the first cycle, which is silent when the
+// DSP is offloaded.
+static UInt64 RecordAutomationOnset(UInt32 inBufferFrames, UInt32 inWorkers, Float64 inOnsetSampleTime)
+{
+    BGM_SimulatedHost theHost(kSampleRate, inBufferFrames);
+    theHost.GetIOPipeline().SetDSPOffloadWorkerCount(inWorkers);
+    
+    theHost.AddClient(1, 101, "com.example.one",
+                      [] (UInt32 inIOBufferFrameSize, Float64 inSampleTime, Float32* outBuffer) {
+                          (void)inSampleTime;
+                          std::fill(outBuffer, outBuffer + inIOBufferFrameSize * 2, 0.25f);
+                      });
+    
+    // The host's timestamps are in simulated time, so the event's host time maps to the same
+    // sample time however long the cycles take to run.
+    CACFDictionary theEvent(true);
+    theEvent.AddSInt32(CFSTR(kBGMAppAutomationKey_ProcessID), 101);
+    theEvent.AddSInt64(CFSTR(kBGMAppAutomationKey_HostTime),
+                       static_cast<SInt64>(theHost.GetHostTime(inOnsetSampleTime)));
+    theEvent.AddFloat32(CFSTR(kBGMAppAutomationKey_GainDB), -20.0f);
+    
+    CACFArray theEvents(true);
+    theEvents.AppendDictionary(theEvent.GetDict());
+    theHost.GetClients().SetAppAutomation(theEvents);
+    
+    theHost.StartIO(1);
+    
+    UInt64 theOnset = UINT64_MAX;
+    const UInt32 theCycles = static_cast<UInt32>(inOnsetSampleTime / inBufferFrames) + 3;
+    
+    for(UInt32 i = 0; i < theCycles && theOnset == UINT64_MAX; i++)
+    {
+        theHost.RunCycle();
+        
+        for(UInt32 theFrame = 0; theFrame < inBufferFrames && i > 0; theFrame++)
+        {
+            if(theHost.GetMix()[theFrame * 2] < 0.1f)
+            {
+                theOnset = static_cast<UInt64>(i) * inBufferFrames + theFrame;
+                break;
+            }
+        }
+    }
+    
+    theHost.StopIO(1);
+    theHost.RemoveClient(1);
+    
+    return theOnset;
+}
+
+// Checks offloading the DSP delays the clients' output by exactly one cycle and doesn't change it
+// otherwise, and that automation still starts on the frame it was scheduled for. Run separately from RunChecks, since only one BGM_SimulatedHost can exist at a time.
+static bool RunDSPOffloadChecks(UInt32 inBufferFrames)
+{
+    bool thePassed = true;
+    const UInt32 theCycles = 32;
+    
+    BGM_RecordedIO theInline = RecordIO(inBufferFrames, 0, theCycles);
+    BGM_RecordedIO theOffloaded = RecordIO(inBufferFrames, 4, theCycles);
+    
+    const std::vector<Float32> theSilence(inBufferFrames * 2, 0.0f);
+    bool theFirstCycleIsSilent = true;
+    bool theOutputIsDelayed = true;
+    
+    for(UInt32 theClient = 0; theClient < 2; theClient++)
+    {
+        theFirstCycleIsSilent &=
+                MaxDifference(theOffloaded.mClientOutputs[theClient][0], theSilence) == 0.0f;
+        
+        for(UInt32 i = 1; i < theCycles; i++)
+        {
+            theOutputIsDelayed &= MaxDifference(theOffloaded.mClientOutputs[theClient][i],
+                                                theInline.mClientOutputs[theClient][i - 1]) < kTolerance;
+        }
+    }
+    
+    bool theMixIsDelayed = true;
+    
+    for(UInt32 i = 1; i < theCycles; i++)
+    {
+        theMixIsDelayed &= MaxDifference(theOffloaded.mMixes[i], theInline.mMixes[i - 1]) < kTolerance;
+    }
+    
+    thePassed &= Check("offloaded DSP outputs silence in the first cycle", theFirstCycleIsSilent);
+    thePassed &= Check("offloaded DSP output is the inline output one cycle later", theOutputIsDelayed);
+    thePassed &= Check("offloaded DSP mix is the inline mix one cycle later", theMixIsDelayed);
+    thePassed &= Check("inline DSP reports no latency", theInline.mLatencyFrames == 0);
+    thePassed &= Check("offloaded DSP reports one buffer of latency",
+                       theOffloaded.mLatencyFrames == inBufferFrames);
+    
+    // Start the automation part of the way through a buffer.
+    const Float64 theOnsetSampleTime = 8 * inBufferFrames + inBufferFrames / 2 + 3;
+    thePassed &= Check("automation starts on its scheduled frame",
+                       RecordAutomationOnset(inBufferFrames, 0, theOnsetSampleTime) ==
+                               static_cast<UInt64>(theOnsetSampleTime));
+    thePassed &= Check("offloaded automation starts on the same frame",
+                       RecordAutomationOnset(inBufferFrames, 4, theOnsetSampleTime) ==
+                               static_cast<UInt64>(theOnsetSampleTime));
+    
+    return thePassed;
+}
+
+// The time BGM_DSPBudget reads in RunDSPBudgetDeadlineChecks.
+static UInt64 sBudgetNow = 0;
+
+static UInt64 GetBudgetNow(void* _Nullable inRefCon)
+{
+    (void)inRefCon;
+    return sBudgetNow;
+}
+
+// Checks the DSP budget measures the cycles' load against their deadlines, using a fake clock so
+// the results are exact.
+static bool RunDSPBudgetDeadlineChecks(UInt32 inBufferFrames)
+{
+    bool thePassed = true;
+    
+    BGM_DSPBudget theBudget;
+    theBudget.SetSampleRate(kSampleRate);
+    theBudget.SetClock(&GetBudgetNow, nullptr);
+    
+    const Float64 theBudgetTicks = inBufferFrames / kSampleRate * CAHostTimeBase::GetFrequency();
+    
+    // The output time of the nth cycle, which is its deadline. The cycles start at 100 buffers so the
+    // budgets don't start before host time 0.
+    auto theOutputTime = [&] (UInt32 inCycle, bool inHasHostTime) {
+        AudioTimeStamp theTime = {};
+        theTime.mSampleTime = static_cast<Float64>(inCycle) * inBufferFrames;
+        theTime.mHostTime = static_cast<UInt64>((100 + inCycle) * theBudgetTicks);
+        theTime.mFlags = inHasHostTime ? kAudioTimeStampSampleHostTimeValid : kAudioTimeStampSampleTimeValid;
+        return theTime;
+    };
+    
+    // Set the clock to a fraction of the way through the nth cycle's budget.
+    auto theSetNow = [&] (UInt32 inCycle, Float64 inLoad) {
+        sBudgetNow = static_cast<UInt64>((100 + inCycle - 1 + inLoad) * theBudgetTicks);
+    };
+    
+    // A cycle the HAL starts on time.
+    theSetNow(0, 0.0);
+    theBudget.BeginOperationRT(inBufferFrames, theOutputTime(0, true));
+    theSetNow(0, 0.1);
+    theBudget.EndCycleRT();
+    thePassed &= Check("a cycle is timed from one buffer before its deadline",
+                       std::abs(theBudget.GetLastCycleLoad() - 0.1) < 0.01);
+    
+    // A cycle the HAL starts late has already used most of its budget.
+    theSetNow(1, 0.8);
+    theBudget.BeginOperationRT(inBufferFrames, theOutputTime(1, true));
+    thePassed &= Check("a cycle that starts late is shed sooner",
+                       theBudget.GetShedLevelRT() == BGM_DSPBudget::kShedLowPriorityEQ);
+    theBudget.EndCycleRT();
+    thePassed &= Check("a cycle that starts late raises the shed level",
+                       theBudget.GetSustainedShedLevel() == BGM_DSPBudget::kShedSpectralFeatures);
+    
+    // The HAL can wake the IO thread before the budget starts.
+    theBudget.Reset();
+    theSetNow(2, -0.5);
+    theBudget.BeginOperationRT(inBufferFrames, theOutputTime(2, true));
+    thePassed &= Check("a cycle that starts early isn't shed",
+                       theBudget.GetShedLevelRT() == BGM_DSPBudget::kShedNothing);
+    theBudget.EndCycleRT();
+    thePassed &= Check("a cycle that ends before its budget starts has no load",
+                       theBudget.GetLastCycleLoad() == 0.0);
+    
+    // Without a host time, the budget starts at the cycle's first operation.
+    theSetNow(3, 0.8);
+    theBudget.BeginOperationRT(inBufferFrames, theOutputTime(3, false));
+    theSetNow(3, 1.0);
+    theBudget.EndCycleRT();
+    thePassed &= Check("a cycle without a host time is timed from its first operation",
+                       std::abs(theBudget.GetLastCycleLoad() - 0.2) < 0.01);
+    
+    // The HAL can stop IO before a cycle's mix is written.
+    theSetNow(4, 0.95);
+    theBudget.BeginOperationRT(inBufferFrames, theOutputTime(4, true));
+    theSetNow(5, 0.0);
+    theBudget.BeginOperationRT(inBufferFrames, theOutputTime(5, true));
+    thePassed &= Check("the next cycle's first operation starts a new budget",
+                       theBudget.GetShedLevelRT() == BGM_DSPBudget::kShedNothing);
+    
+    return thePassed;
+}
+
+static int RunChecks(UInt32 inBufferFrames)
+{
+    bool thePassed = true;
+    
+    // Time the cycles in simulated time, so the processing they shed doesn't depend on the machine
+    // or whatever else it's running.
+    BGM_SimulatedHost theHost(kSampleRate, inBufferFrames);
+    theHost.SetUsesSimulatedTime(true);
+    
+    theHost.AddClient(1, 101, "com.example.one", MakeSine(440.0, 0.25f));
+    theHost.AddClient(2, 202, "com.example.two", MakeSine(660.0, 0.25f));
+    
+    // Starting IO should make the device running.
+    theHost.StartIO(1);
+    theHost.StartIO(2);
+    thePassed &= Check("StartIO sends kAudioDevicePropertyDeviceIsRunning",
+                       theHost.WaitForNotificationCount(kAudioDevicePropertyDeviceIsRunning,
+                                                        1,
+                                                        kNotificationTimeoutMS));
+    thePassed &= Check("clients are running IO", theHost.GetClients().ClientsRunningIO());
+    
+    // Each client should read the mix from the previous cycle.
+    bool theLoopbackMatched = true;
+    
+    for(UInt32 i = 0; i < 16; i++)
+    {
+        std::vector<Float32> thePreviousMix = theHost.GetMix();
+        theHost.RunCycle();
+        
+        if(i > 0)
+        {
+            theLoopbackMatched &= MaxDifference(theHost.GetClientInput(1), thePreviousMix) < kTolerance;
+            theLoopbackMatched &= MaxDifference(theHost.GetClientInput(2), thePreviousMix) < kTolerance;
+        }
+    }
+    
+    thePassed &= Check("clients read the previous cycle's mix", theLoopbackMatched);
+    
+    // A couple of seconds of tones should make the device audible.
+    theHost.Run(static_cast<UInt32>(2.0 * kSampleRate / inBufferFrames), false);
+    thePassed &= Check("playing audio sends kAudioDeviceCustomPropertyDeviceAudibleState",
+                       theHost.WaitForNotificationCount(kAudioDeviceCustomPropertyDeviceAudibleState,
+                                                        1,
+                                                        kNotificationTimeoutMS));
+    thePassed &= Check("the device is audible",
+                       theHost.GetIOPipeline().GetAudibleState() == kBGMDeviceIsAudible);
+    
+    // Turning client 2 all the way down should leave only client 1 in the mix once the volume has
+    // ramped down.
+    thePassed &= Check("set client 2's volume", SetRelativeVolume(theHost, 202, kAppRelativeVolumeMinRawValue));
+    theHost.Run(static_cast<UInt32>(0.5 * kSampleRate / inBufferFrames), false);
+    thePassed &= Check("client 2 is (almost) silent after its volume is turned down",
+                       MaxDifference(theHost.GetMix(), theHost.GetClientOutput(1)) < 1.0e-4f);
+    
+    // Client 1 is at unity gain, so its processed output should match its generator.
+    std::vector<Float32> theExpected(inBufferFrames * 2);
+    MakeSine(440.0, 0.25f)(inBufferFrames, theHost.GetSampleTime() - inBufferFrames, theExpected.data());
+    thePassed &= Check("client 1 is unchanged at unity gain",
+                       MaxDifference(theHost.GetClientOutput(1), theExpected) < kTolerance);
+    
+    // Overload the IO cycles with a slow client that has audio routed to it. Client 2 is low
+    // priority and has EQ, so its EQ should be bypassed. Client 1 is high priority, so none of its
+    // processing should be shed.
+    thePassed &= Check("set client 1's priority", SetAppPriority(theHost, 101, kBGMAppPriorityHigh));
+    thePassed &= Check("set client 2's priority", SetAppPriority(theHost, 202, kBGMAppPriorityLow));
+    thePassed &= Check("the app priorities are stored",
+                       theHost.GetClients().CopyAppPrioritiesAsArray().GetNumberItems() == 2);
+    
+    CACFDictionary theAppEQ(true);
+    theAppEQ.AddSInt32(CFSTR(kBGMAppVolumesKey_ProcessID), 202);
+    theAppEQ.AddSInt32(CFSTR(kBGMAppVolumesKey_EQLowGain), 60);
+    CACFArray theAppEQs(true);
+    theAppEQs.AppendDictionary(theAppEQ.GetDict());
+    thePassed &= Check("set client 2's EQ", theHost.GetClients().SetClientsRelativeVolumes(theAppEQs));
+    
+    Float64 theSlowClientLoad = 0.0;
+    theHost.AddClient(3, 303, "com.example.slow", MakeSlowSilence(theHost, theSlowClientLoad));
+    theHost.GetClients().SetRoute(101, 303, 1.0f, true);
+    theHost.StartIO(3);
+    
+    const BGM_DSPBudget& theBudget = theHost.GetIOPipeline().GetDSPBudget();
+    
+    // The sustained level only rises after cycles that use more than kRaiseLoad of their budgets,
+    // by one level per cycle.
+    theSlowClientLoad = BGM_DSPBudget::kRaiseLoad - 0.05;
+    theHost.Run(8, false);
+    thePassed &= Check("loads under the raise threshold don't raise the shed level",
+                       theBudget.GetSustainedShedLevel() == BGM_DSPBudget::kShedNothing);
+    
+    theSlowClientLoad = BGM_DSPBudget::kRaiseLoad + 0.05;
+    theHost.RunCycle();
+    thePassed &= Check("a load over the raise threshold raises the shed level by one",
+                       theBudget.GetSustainedShedLevel() == BGM_DSPBudget::kShedSpectralFeatures);
+    
+    theSlowClientLoad = 1.5;
+    BGM_GlitchTelemetrySnapshot theShedBefore = theHost.GetIOPipeline().GetGlitchTelemetry().GetSnapshot();
+    const UInt32 theOverloadedCycles = static_cast<UInt32>(0.5 * kSampleRate / inBufferFrames);
+    theHost.Run(theOverloadedCycles, false);
+    BGM_GlitchTelemetrySnapshot theShedAfter = theHost.GetIOPipeline().GetGlitchTelemetry().GetSnapshot();
+    
+    auto theShedCount = [&] (BGMGlitchCounter inCounter) {
+        return theShedAfter.mTotal[inCounter] - theShedBefore.mTotal[inCounter];
+    };
+    
+    thePassed &= Check("sustained overload sheds everything it can",
+                       theBudget.GetSustainedShedLevel() == BGM_DSPBudget::kShedRouteMixing);
+    // Only clients 2 and 3 can have their spectral features shed.
+    thePassed &= Check("spectral features are shed for clients that aren't high priority",
+                       theShedCount(kBGMGlitchShedSpectralFeatures) > 0 &&
+                       theShedCount(kBGMGlitchShedSpectralFeatures) <= 2 * theOverloadedCycles);
+    thePassed &= Check("the low-priority client's EQ is bypassed",
+                       theShedCount(kBGMGlitchShedEQ) > 0 &&
+                       theShedCount(kBGMGlitchShedEQ) <= theOverloadedCycles);
+    thePassed &= Check("route mixing is shed",
+                       theShedCount(kBGMGlitchShedRouteMixing) > 0 &&
+                       MaxDifference(theHost.GetClientInput(3),
+                                     std::vector<Float32>(inBufferFrames * 2, 0.0f)) == 0.0f);
+    
+    MakeSine(440.0, 0.25f)(inBufferFrames, theHost.GetSampleTime() - inBufferFrames, theExpected.data());
+    thePassed &= Check("the high-priority client is still fully processed",
+                       MaxDifference(theHost.GetClientOutput(1), theExpected) < kTolerance);
+    
+    // The level only falls after kRecoverySecs of cycles using less than kLowerLoad of their
+    // budgets, by one level at a time rather than all at once.
+    const UInt32 theRecoveryCycles =
+            static_cast<UInt32>(std::ceil(BGM_DSPBudget::kRecoverySecs * kSampleRate / inBufferFrames));
+    
+    theSlowClientLoad = (BGM_DSPBudget::kLowerLoad + BGM_DSPBudget::kRaiseLoad) / 2;
+    theHost.Run(2 * theRecoveryCycles, false);
+    thePassed &= Check("loads between the thresholds hold the shed level",
+                       theBudget.GetSustainedShedLevel() == BGM_DSPBudget::kShedRouteMixing);
+    
+    theSlowClientLoad = BGM_DSPBudget::kLowerLoad - 0.05;
+    theHost.Run(theRecoveryCycles - 1, false);
+    thePassed &= Check("the shed level holds until the recovery time has passed",
+                       theBudget.GetSustainedShedLevel() == BGM_DSPBudget::kShedRouteMixing);
+    theHost.RunCycle();
+    thePassed &= Check("the shed level falls gradually",
+                       theBudget.GetSustainedShedLevel() == BGM_DSPBudget::kShedLowPriorityEQ);
+    
+    theHost.StopIO(3);
+    theHost.RemoveClient(3);
+    theHost.Run(2 * theRecoveryCycles, false);
+    thePassed &= Check("the shed level recovers once the overload ends",
+                       theBudget.GetSustainedShedLevel() == BGM_DSPBudget::kShedNothing);
+    
+    // Stopping IO should stop the device.
+    UInt64 theRunningNotifications = theHost.GetNotificationCount(kAudioDevicePropertyDeviceIsRunning);
+    theHost.StopIO(1);
+    theHost.StopIO(2);
+    thePassed &= Check("StopIO sends kAudioDevicePropertyDeviceIsRunning",
+                       theHost.WaitForNotificationCount(kAudioDevicePropertyDeviceIsRunning,
+                                                        theRunningNotifications + 1,
+                                                        kNotificationTimeoutMS));
+    thePassed &= Check("clients have stopped IO", !theHost.GetClients().ClientsRunningIO());
+    
+    theHost.RemoveClient(1);
+    theHost.RemoveClient(2);
+    
+    return thePassed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static void PrintStats(const BGM_SimulatedHost& inHost, UInt32 inClients)
+{
+    BGM_SimulatedHost::BGM_CycleStats theStats = inHost.GetCycleStats();
+    const Float64 theCycleNanos = inHost.GetIOBufferFrameSize() / inHost.GetSampleRate() * 1.0e9;
+    
+    std::printf("%u clients, %u-frame buffers, %llu cycles: %.0f ns per cycle (%.3f%% of the cycle), "
+                "worst %llu ns, %llu overloaded\n",
+                inClients,
+                inHost.GetIOBufferFrameSize(),
+                theStats.mCycles,
+                theStats.mMeanCycleNanos,
+                100.0 * theStats.mMeanCycleNanos / theCycleNanos,
+                theStats.mMaxCycleNanos,
+                theStats.mOverloadedCycles);
+}
+
+static int Run(Float64 inSeconds, UInt32 inClients, UInt32 inBufferFrames, bool inRealTime)
+{
+    BGM_SimulatedHost theHost(kSampleRate, inBufferFrames);
+    
+    for(UInt32 i = 1; i <= inClients; i++)
+    {
+        std::string theBundleID = "com.example.client" + std::to_string(i);
+        theHost.AddClient(i, static_cast<pid_t>(1000 + i), theBundleID.c_str(), MakeSine(110.0 * i, 0.1f));
+        theHost.StartIO(i);
+    }
+    
+    theHost.Run(static_cast<UInt32>(inSeconds * kSampleRate / inBufferFrames), inRealTime);
+    PrintStats(theHost, inClients);
+    
+    for(UInt32 i = 1; i <= inClients; i++)
+    {
+        theHost.RemoveClient(i);
+    }
+    
+    return EXIT_SUCCESS;
+}
+
+static int RunScaling(UInt32 inClients, UInt32 inBufferFrames)
+{
+    const UInt32 kWorkerCounts[] = { 0, 1, 2, 4, 8, 16 };
+    // Five seconds of audio for each worker count.
+    const UInt32 theCycles = static_cast<UInt32>(5.0 * kSampleRate / inBufferFrames);
+    
+    std::printf("%u clients, %u-frame buffers, %u cycles, %u hardware threads\n",
+                inClients,
+                inBufferFrames,
+                theCycles,
+                std::thread::hardware_concurrency());
+    std::printf("%-8s %12s %8s %12s %11s\n", "workers", "ns/cycle", "speedup", "worst ns", "overloaded");
+    
+    Float64 theInlineNanos = 0.0;
+    
+    for(UInt32 theWorkers : kWorkerCounts)
+    {
+        BGM_SimulatedHost theHost(kSampleRate, inBufferFrames);
+        theHost.GetIOPipeline().SetDSPOffloadWorkerCount(theWorkers);
+        
+        std::vector<pid_t> theProcessIDs;
+        
+        for(UInt32 i = 1; i <= inClients; i++)
+        {
+            std::string theBundleID = "com.example.client" + std::to_string(i);
+            theHost.AddClient(i, static_cast<pid_t>(1000 + i), theBundleID.c_str(), MakeSine(110.0 * i, 0.1f));
+            theProcessIDs.push_back(static_cast<pid_t>(1000 + i));
+        }
+        
+        SetEQ(theHost, theProcessIDs);
+        
+        for(UInt32 i = 1; i <= inClients; i++)
+        {
+            theHost.StartIO(i);
+        }
+        
+        theHost.Run(theCycles, false);
+        
+        BGM_SimulatedHost::BGM_CycleStats theStats = theHost.GetCycleStats();
+        
+        if(theWorkers == 0)
+        {
+            theInlineNanos = theStats.mMeanCycleNanos;
+        }
+        
+        std::printf("%-8s %12.0f %7.2fx %12llu %11llu\n",
+                    (theWorkers == 0) ? "inline" : std::to_string(theWorkers).c_str(),
+                    theStats.mMeanCycleNanos,
+                    (theStats.mMeanCycleNanos > 0.0) ? theInlineNanos / theStats.mMeanCycleNanos : 0.0,
+                    theStats.mMaxCycleNanos,
+                    theStats.mOverloadedCycles);
+        
+        for(UInt32 i = 1; i <= inClients; i++)
+        {
+            theHost.RemoveClient(i);
+        }
+    }
+    
+    return EXIT_SUCCESS;
+}
+
+static int Record(const char* inTracePath, Float64 inSeconds, UInt32 inClients, UInt32 inBufferFrames)
+{
+    BGM_SimulatedHost theHost(kSampleRate, inBufferFrames);
+    
+    try
+    {
+        theHost.GetIOTraceRecorder().Start(inTracePath, /* inRecordAudio = */ true, kSampleRate);
+    }
+    catch(const CAException&)
+    {
+        std::fprintf(stderr, "Couldn't create %s\n", inTracePath);
+        return EXIT_FAILURE;
+    }
+    
+    const UInt32 theCycles = static_cast<UInt32>(inSeconds * kSampleRate / inBufferFrames);
+    
+    for(UInt32 i = 1; i <= inClients; i++)
+    {
+        std::string theBundleID = "com.example.client" + std::to_string(i);
+        theHost.AddClient(i, static_cast<pid_t>(1000 + i), theBundleID.c_str(), MakeSine(110.0 * i, 0.1f));
+    }
+    
+    // Stagger the clients' IO over the first half of the run, then stop the even-numbered ones, so
+    // the trace covers clients joining and leaving the IO cycles.
+    const UInt32 theStagger = std::max(1U, theCycles / (2 * inClients));
+    
+    for(UInt32 i = 1; i <= inClients; i++)
+    {
+        theHost.StartIO(i);
+        theHost.Run(theStagger, true);
+    }
+    
+    for(UInt32 i = 2; i <= inClients; i += 2)
+    {
+        theHost.StopIO(i);
+    }
+    
+    theHost.Run(theCycles - std::min(theCycles, theStagger * inClients), true);
+    
+    for(UInt32 i = 1; i <= inClients; i++)
+    {
+        theHost.RemoveClient(i);
+    }
+    
+    theHost.GetIOTraceRecorder().Stop();
+    PrintStats(theHost, inClients);
+    
+    UInt32 theDroppedRecords = theHost.GetIOTraceRecorder().GetDroppedRecordCount();
+    
+    if(theDroppedRecords > 0)
+    {
+        std::fprintf(stderr, "%u records were dropped from the trace\n", theDroppedRecords);
+        return EXIT_FAILURE;
+    }
+    
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, const char* argv[])
+{
+    const std::string theCommand = (argc > 1) ? argv[1] : "check";
+    
+    auto theNumberArg = [&] (int inArgIndex, UInt32 inDefault) {
+        return (argc > inArgIndex) ? static_cast<UInt32>(std::max(1, std::atoi(argv[inArgIndex]))) : inDefault;
+    };
+    
+    if(theCommand == "check" && argc <= 3)
+    {
+        int theResult = RunChecks(theNumberArg(2, kDefaultBufferFrames));
+        
+        if(!RunDSPOffloadChecks(theNumberArg(2, kDefaultBufferFrames)))
+        {
+            theResult = EXIT_FAILURE;
+        }
+        
+        if(!RunDSPBudgetDeadlineChecks(theNumberArg(2, kDefaultBufferFrames)))
+        {
+            theResult = EXIT_FAILURE;
+        }
+        
+        return theResult;
+    }
+    else if(theCommand == "benchmark" && argc <= 4)
+    {
+        // Ten minutes of audio.
+        return Run(600.0, theNumberArg(2, kDefaultClients), theNumberArg(3, kDefaultBufferFrames), false);
+    }
+    else if(theCommand == "scaling" && argc <= 4)
+    {
+        return RunScaling(theNumberArg(2, kDefaultClients), theNumberArg(3, kDefaultBufferFrames));
+    }
+    else if(theCommand == "run" && argc >= 3 && argc <= 5)
+    {
+        return Run(std::atof(argv[2]), theNumberArg(3, kDefaultClients), theNumberArg(4, kDefaultBufferFrames), true);
+    }
+    else if(theCommand == "record" && argc >= 3 && argc <= 6)
+    {
+        return Record(argv[2],
+                      (argc > 3) ? std::atof(argv[3]) : 2.0,
+                      theNumberArg(4, 4),
+                      theNumberArg(5, kDefaultBufferFrames));
+    }
+    
+    std::fprintf(stderr,
+                 "Usage: %s [check [buffer frames]]\n"
+                 "       %s benchmark [clients] [buffer frames]\n"
+                 "       %s scaling [clients] [buffer frames]\n"
+                 "       %s run <seconds> [clients] [buffer frames]\n"
+                 "       %s record <trace file> [seconds] [clients] [buffer frames]\n",
+                 argv[0], argv[0], argv[0], argv[0], argv[0]);
+    return EXIT_FAILURE;
+}
+
@@ -0,0 +1,197 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_WAVFile.h
+//  BGMDriver
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  Minimal WAV file reading and writing for the offline tools. Reads 16-bit integer and 32-bit
+//  float files, mono or stereo, and writes 16-bit stereo files. Audio is kept as interleaved
+//  stereo Float32, the format BGMDevice's clients use.
+//
+
+#ifndef BGMDriver__BGM_WAVFile
+#define BGMDriver__BGM_WAVFile
+
+// System Includes
+#include <MacTypes.h>
+
+// STL Includes
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+
+struct Clip
+{
+    Float64                 mSampleRate = 48000.0;
+    // Interleaved stereo.
+    std::vector<Float32>    mSamples;
+
+    UInt32 GetFrameCount() const { return static_cast<UInt32>(mSamples.size() / 2); }
+};
+
+inline void WriteLE(std::ofstream& ioFile, uint32_t inValue, int inBytes)
+{
+    for(int i = 0; i < inBytes; i++)
+    {
+        ioFile.put(static_cast<char>((inValue >> (8 * i)) & 0xFF));
+    }
+}
+
+inline uint32_t ReadLE(const std::vector<uint8_t>& inData, size_t inOffset, int inBytes)
+{
+    uint32_t theValue = 0;
+
+    for(int i = 0; i < inBytes; i++)
+    {
+        theValue |= static_cast<uint32_t>(inData[inOffset + i]) << (8 * i);
+    }
+
+    return theValue;
+}
+
+// Writes the clip as a 16-bit stereo WAV file.
+inline bool WriteWAV(const std::string& inPath, const Clip& inClip)
+{
+    std::ofstream theFile(inPath.c_str(), std::ios::binary);
+
+    if(!theFile)
+    {
+        return false;
+    }
+
+    const uint32_t theDataSize = static_cast<uint32_t>(inClip.mSamples.size() * 2);
+
+    theFile.write("RIFF", 4);
+    WriteLE(theFile, 36 + theDataSize, 4);
+    theFile.write("WAVEfmt ", 8);
+    WriteLE(theFile, 16, 4);
+    WriteLE(theFile, 1, 2);  // PCM
+    WriteLE(theFile, 2, 2);  // Channels
+    WriteLE(theFile, static_cast<uint32_t>(inClip.mSampleRate), 4);
+    WriteLE(theFile, static_cast<uint32_t>(inClip.mSampleRate) * 4, 4);
+    WriteLE(theFile, 4, 2);
+    WriteLE(theFile, 16, 2);
+    theFile.write("data", 4);
+    WriteLE(theFile, theDataSize, 4);
+
+    for(Float32 theSample : inClip.mSamples)
+    {
+        Float32 theClamped = std::min(1.0f, std::max(-1.0f, theSample));
+        WriteLE(theFile, static_cast<uint32_t>(static_cast<int16_t>(std::lround(theClamped * 32767.0f))), 2);
+    }
+
+    return static_cast<bool>(theFile);
+}
+
+inline bool ReadWAV(const std::string& inPath, Clip& outClip)
+{
+    std::ifstream theFile(inPath.c_str(), std::ios::binary);
+
+    if(!theFile)
+    {
+        return false;
+    }
+
+    std::vector<uint8_t> theData((std::istreambuf_iterator<char>(theFile)), std::istreambuf_iterator<char>());
+
+    if(theData.size() < 12 || std::memcmp(theData.data(), "RIFF", 4) != 0 || std::memcmp(theData.data() + 8, "WAVE", 4) != 0)
+    {
+        return false;
+    }
+
+    uint32_t theFormat = 0;
+    uint32_t theChannels = 0;
+    uint32_t theBitsPerSample = 0;
+    size_t theOffset = 12;
+
+    while(theOffset + 8 <= theData.size())
+    {
+        const uint32_t theChunkSize = ReadLE(theData, theOffset + 4, 4);
+        const size_t theChunkStart = theOffset + 8;
+
+        if(theChunkStart + theChunkSize > theData.size())
+        {
+            return false;
+        }
+
+        if(std::memcmp(theData.data() + theOffset, "fmt ", 4) == 0 && theChunkSize >= 16)
+        {
+            theFormat = ReadLE(theData, theChunkStart, 2);
+            theChannels = ReadLE(theData, theChunkStart + 2, 2);
+            outClip.mSampleRate = ReadLE(theData, theChunkStart + 4, 4);
+            theBitsPerSample = ReadLE(theData, theChunkStart + 14, 2);
+        }
+        else if(std::memcmp(theData.data() + theOffset, "data", 4) == 0)
+        {
+            const bool isInt16 = (theFormat == 1 && theBitsPerSample == 16);
+            const bool isFloat32 = (theFormat == 3 && theBitsPerSample == 32);
+
+            if((!isInt16 && !isFloat32) || (theChannels != 1 && theChannels != 2))
+            {
+                return false;
+            }
+
+            const uint32_t theBytesPerFrame = theChannels * theBitsPerSample / 8;
+            const uint32_t theFrames = theChunkSize / theBytesPerFrame;
+
+            outClip.mSamples.resize(theFrames * 2);
+
+            for(uint32_t theFrame = 0; theFrame < theFrames; theFrame++)
+            {
+                for(uint32_t theChannel = 0; theChannel < 2; theChannel++)
+                {
+                    // Mono files are copied to both channels.
+                    const uint32_t theSourceChannel = std::min(theChannel, theChannels - 1);
+                    const size_t theSampleOffset =
+                            theChunkStart + theFrame * theBytesPerFrame + theSourceChannel * theBitsPerSample / 8;
+
+                    Float32 theSample;
+
+                    if(isInt16)
+                    {
+                        theSample = static_cast<int16_t>(ReadLE(theData, theSampleOffset, 2)) / 32768.0f;
+                    }
+                    else
+                    {
+                        uint32_t theBits = ReadLE(theData, theSampleOffset, 4);
+                        std::memcpy(&theSample, &theBits, sizeof(theSample));
+                    }
+
+                    outClip.mSamples[theFrame * 2 + theChannel] = theSample;
+                }
+            }
+
+            return true;
+        }
+
+        // Chunks are padded to an even size.
+        theOffset = theChunkStart + theChunkSize + (theChunkSize & 1);
+    }
+
+    return false;
+}
+
+#endif /* BGMDriver__BGM_WAVFile */
+
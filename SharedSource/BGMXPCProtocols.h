@@ -54,6 +54,17 @@ static NSString* kBGMXPCHelperMachServiceName = @kBGMXPCHelperBundleID;
 // This is so BGMDevice isn't left as the default device if BGMApp crashes or otherwise terminates
 // abnormally. If audio is played to BGMDevice and BGMApp isn't running, the user won't hear it.
 - (void) setOutputDeviceToMakeDefaultOnAbnormalTermination:(AudioObjectID)deviceID;
+
+// Gets BGMApp's playthrough glitch telemetry, i.e. the counts of the underruns, overruns, etc. in
+// playthrough, from BGMApp. If reset is YES, BGMApp resets the counts after reading them. BGMDriver's
+// own counts are in kAudioDeviceCustomPropertyGlitchTelemetry.
+//
+// The reply block is passed the telemetry in the kAudioDeviceCustomPropertyGlitchTelemetry format
+// (see BGM_Types.h) or, if BGMApp couldn't be reached, nil and an error with one of the kBGMXPC_*
+// error codes.
+- (void) bgmAppPlayThroughGlitchTelemetryResetting:(BOOL)reset
+                                         withReply:(void (^)(NSDictionary* __nullable telemetry,
+                                                             NSError* __nullable error))reply;
     
 @end
 
@@ -63,6 +74,9 @@ static NSString* kBGMXPCHelperMachServiceName = @kBGMXPCHelperBundleID;
 
 - (void) startPlayThroughSyncWithReply:(void (^)(NSError*))reply forUISoundsDevice:(BOOL)isUI;
 
+// See bgmAppPlayThroughGlitchTelemetryResetting:withReply: in BGMXPCHelperXPCProtocol.
+- (void) playThroughGlitchTelemetryResetting:(BOOL)reset withReply:(void (^)(NSDictionary*))reply;
+
 @end
 
 #pragma clang assume_nonnull end
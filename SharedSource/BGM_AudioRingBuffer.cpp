@@ -0,0 +1,294 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_AudioRingBuffer.cpp
+//  SharedSource
+//
+//  Copyright © 2026 Background Music contributors
+//
+
+// Self Include
+#include "BGM_AudioRingBuffer.h"
+
+// STL Includes
+#include <algorithm>
+
+// System Includes
+#include <string.h>
+
+
+#pragma clang assume_nonnull begin
+
+#pragma mark Construction/Destruction
+
+template <BGMRingBufferProducers tProducers>
+BGM_AudioRingBuffer<tProducers>::BGM_AudioRingBuffer()
+:
+    mChannels(0),
+    mCapacityFrames(0),
+    mCapacityFramesMask(0),
+    mSamples(),
+    mTimeBoundsSequence(0),
+    mStartTime(0),
+    mEndTime(0)
+{
+    mStoring.clear();
+}
+
+template <BGMRingBufferProducers tProducers>
+void    BGM_AudioRingBuffer<tProducers>::Allocate(UInt32 inChannels, UInt32 inCapacityFrames)
+{
+    // Round the capacity up to a power of two so sample times can be masked instead of divided.
+    UInt32 theCapacityFrames = 1;
+
+    while(theCapacityFrames < inCapacityFrames)
+    {
+        theCapacityFrames <<= 1;
+    }
+
+    mChannels = inChannels;
+    mCapacityFrames = theCapacityFrames;
+    mCapacityFramesMask = theCapacityFrames - 1;
+    mSamples.reset(new Float32[static_cast<size_t>(theCapacityFrames) * inChannels]());
+
+    SetTimeBoundsRT(0, 0);
+}
+
+template <BGMRingBufferProducers tProducers>
+void    BGM_AudioRingBuffer<tProducers>::Deallocate()
+{
+    mSamples.reset();
+    mChannels = 0;
+    mCapacityFrames = 0;
+    mCapacityFramesMask = 0;
+
+    SetTimeBoundsRT(0, 0);
+}
+
+#pragma mark Store/Fetch
+
+template <BGMRingBufferProducers tProducers>
+CARingBufferError   BGM_AudioRingBuffer<tProducers>::StoreRT(const Float32* inFrames,
+                                                             UInt32 inFrameCount,
+                                                             SampleTime inSampleTime)
+{
+    if(inFrameCount == 0)
+    {
+        return kCARingBufferError_OK;
+    }
+
+    if(inFrameCount > mCapacityFrames)
+    {
+        return kCARingBufferError_TooMuch;
+    }
+
+    if(tProducers == kBGMRingBufferMultipleProducers &&
+       mStoring.test_and_set(std::memory_order_acquire))
+    {
+        // Another thread is storing. Waiting for it wouldn't be real-time safe.
+        return kCARingBufferError_CPUOverload;
+    }
+
+    // Only storing changes the time bounds, so they can be read without the seqlock here.
+    SampleTime theStartTime = mStartTime.load(std::memory_order_relaxed);
+    SampleTime theEndTime = mEndTime.load(std::memory_order_relaxed);
+    const SampleTime theEndWrite = inSampleTime + inFrameCount;
+
+    if(inSampleTime < theEndTime)
+    {
+        // Going backwards, so throw everything out.
+        theStartTime = theEndTime = inSampleTime;
+        SetTimeBoundsRT(theStartTime, theEndTime);
+    }
+    else if(theEndWrite - theStartTime > mCapacityFrames)
+    {
+        // Move the start time past the frames that are about to be overwritten before overwriting
+        // them, so a fetch that reads the new time bounds won't read them.
+        theStartTime = theEndWrite - mCapacityFrames;
+        theEndTime = std::max(theStartTime, theEndTime);
+        SetTimeBoundsRT(theStartTime, theEndTime);
+    }
+
+    // Fill any frames that were skipped with silence.
+    if(inSampleTime > theEndTime)
+    {
+        WriteFramesRT(theEndTime, nullptr, static_cast<UInt32>(inSampleTime - theEndTime));
+    }
+
+    WriteFramesRT(inSampleTime, inFrames, inFrameCount);
+
+    SetTimeBoundsRT(theStartTime, theEndWrite);
+
+    if(tProducers == kBGMRingBufferMultipleProducers)
+    {
+        mStoring.clear(std::memory_order_release);
+    }
+
+    return kCARingBufferError_OK;
+}
+
+template <BGMRingBufferProducers tProducers>
+CARingBufferError   BGM_AudioRingBuffer<tProducers>::FetchRT(Float32* outFrames,
+                                                             UInt32 inFrameCount,
+                                                             SampleTime inSampleTime) const
+{
+    if(inFrameCount == 0)
+    {
+        return kCARingBufferError_OK;
+    }
+
+    // CARingBuffer treats negative sample times as zero.
+    const SampleTime theStartRead = std::max(static_cast<SampleTime>(0), inSampleTime);
+    const SampleTime theEndRead = theStartRead + inFrameCount;
+
+    SampleTime theStartTime, theEndTime;
+    CARingBufferError theError = GetTimeBoundsRT(theStartTime, theEndTime);
+
+    if(theError != kCARingBufferError_OK)
+    {
+        return theError;
+    }
+
+    // Clip the range to the time bounds and write silence for the frames outside them.
+    SampleTime theClippedStart = std::max(theStartRead, theStartTime);
+    SampleTime theClippedEnd = std::max(theClippedStart, std::min(theEndRead, theEndTime));
+
+    if(theStartRead > theEndTime || theEndRead < theStartTime)
+    {
+        theClippedStart = theClippedEnd = theStartRead;
+    }
+
+    const UInt32 theLeadingFrames = static_cast<UInt32>(theClippedStart - theStartRead);
+    const UInt32 theFrames = static_cast<UInt32>(theClippedEnd - theClippedStart);
+    const UInt32 theTrailingFrames = inFrameCount - theLeadingFrames - theFrames;
+
+    memset(outFrames, 0, sizeof(Float32) * theLeadingFrames * mChannels);
+    memset(outFrames + (theLeadingFrames + theFrames) * mChannels,
+           0,
+           sizeof(Float32) * theTrailingFrames * mChannels);
+
+    if(theFrames == 0)
+    {
+        return kCARingBufferError_OK;
+    }
+
+    ReadFramesRT(theClippedStart, outFrames + theLeadingFrames * mChannels, theFrames);
+
+    // Make sure the copy happens before the time bounds are read again.
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    // If a store moved the start time past the first frame we copied, it might have overwritten
+    // some of them while we were copying.
+    theError = GetTimeBoundsRT(theStartTime, theEndTime);
+
+    if(theError != kCARingBufferError_OK || theStartTime > theClippedStart)
+    {
+        return kCARingBufferError_CPUOverload;
+    }
+
+    return kCARingBufferError_OK;
+}
+
+#pragma mark Time Bounds
+
+template <BGMRingBufferProducers tProducers>
+CARingBufferError   BGM_AudioRingBuffer<tProducers>::GetTimeBoundsRT(SampleTime& outStartTime,
+                                                                     SampleTime& outEndTime) const
+{
+    for(UInt32 i = 0; i < kMaxTimeBoundsReadAttempts; i++)
+    {
+        UInt32 theSequence = mTimeBoundsSequence.load(std::memory_order_acquire);
+
+        // Skip the read if a store is changing the time bounds.
+        if((theSequence & 1) == 0)
+        {
+            outStartTime = mStartTime.load(std::memory_order_relaxed);
+            outEndTime = mEndTime.load(std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if(mTimeBoundsSequence.load(std::memory_order_relaxed) == theSequence)
+            {
+                return kCARingBufferError_OK;
+            }
+        }
+    }
+
+    return kCARingBufferError_CPUOverload;
+}
+
+template <BGMRingBufferProducers tProducers>
+void    BGM_AudioRingBuffer<tProducers>::SetTimeBoundsRT(SampleTime inStartTime, SampleTime inEndTime)
+{
+    // Only one thread stores at a time, so the sequence can't change under us.
+    UInt32 theSequence = mTimeBoundsSequence.load(std::memory_order_relaxed);
+
+    mTimeBoundsSequence.store(theSequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    mStartTime.store(inStartTime, std::memory_order_relaxed);
+    mEndTime.store(inEndTime, std::memory_order_relaxed);
+
+    mTimeBoundsSequence.store(theSequence + 2, std::memory_order_release);
+}
+
+#pragma mark Frames
+
+template <BGMRingBufferProducers tProducers>
+void    BGM_AudioRingBuffer<tProducers>::WriteFramesRT(SampleTime inSampleTime,
+                                                       const Float32* _Nullable inFrames,
+                                                       UInt32 inFrameCount)
+{
+    const UInt32 theOffset = static_cast<UInt32>(inSampleTime & mCapacityFramesMask);
+    const UInt32 theFirstPart = std::min(inFrameCount, mCapacityFrames - theOffset);
+    const UInt32 theSecondPart = inFrameCount - theFirstPart;
+    Float32* const theSamples = mSamples.get();
+
+    if(inFrames != nullptr)
+    {
+        memcpy(theSamples + theOffset * mChannels, inFrames, sizeof(Float32) * theFirstPart * mChannels);
+        memcpy(theSamples,
+               inFrames + theFirstPart * mChannels,
+               sizeof(Float32) * theSecondPart * mChannels);
+    }
+    else
+    {
+        memset(theSamples + theOffset * mChannels, 0, sizeof(Float32) * theFirstPart * mChannels);
+        memset(theSamples, 0, sizeof(Float32) * theSecondPart * mChannels);
+    }
+}
+
+template <BGMRingBufferProducers tProducers>
+void    BGM_AudioRingBuffer<tProducers>::ReadFramesRT(SampleTime inSampleTime,
+                                                      Float32* outFrames,
+                                                      UInt32 inFrameCount) const
+{
+    const UInt32 theOffset = static_cast<UInt32>(inSampleTime & mCapacityFramesMask);
+    const UInt32 theFirstPart = std::min(inFrameCount, mCapacityFrames - theOffset);
+    const Float32* const theSamples = mSamples.get();
+
+    memcpy(outFrames, theSamples + theOffset * mChannels, sizeof(Float32) * theFirstPart * mChannels);
+    memcpy(outFrames + theFirstPart * mChannels,
+           theSamples,
+           sizeof(Float32) * (inFrameCount - theFirstPart) * mChannels);
+}
+
+template class BGM_AudioRingBuffer<kBGMRingBufferSingleProducer>;
+template class BGM_AudioRingBuffer<kBGMRingBufferMultipleProducers>;
+
+#pragma clang assume_nonnull end
+
@@ -0,0 +1,154 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_AudioRingBuffer.h
+//  SharedSource
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  A ring buffer of interleaved Float32 audio indexed by sample time, which replaces CARingBuffer
+//  for BGMDevice's loopback audio and BGMPlayThrough. It has the same semantics as CARingBuffer
+//  and returns the same kCARingBufferError_* codes, but
+//
+//    - it stores interleaved frames, so storing and fetching are one or two memcpys and take
+//      Float32 pointers directly instead of AudioBufferLists,
+//    - offsets are found by masking the sample time, since the capacity is always a power of two,
+//    - the time bounds are a seqlock, so reading them never takes more than a few retries, and
+//    - Fetch checks the frames it copied weren't overwritten while it copied them, which
+//      CARingBuffer doesn't.
+//
+//  BGM_SPSCAudioRingBuffer allows one thread to store while another fetches.
+//  BGM_MPSCAudioRingBuffer also allows several threads to store, but only one at a time. If a
+//  thread tries to store while another is, it fails with kCARingBufferError_CPUOverload instead
+//  of waiting. In both, only one thread can fetch at a time.
+//
+//  Allocate and Deallocate aren't real-time safe or thread-safe. The other methods are both.
+//
+
+#ifndef SharedSource__BGM_AudioRingBuffer
+#define SharedSource__BGM_AudioRingBuffer
+
+// PublicUtility Includes
+#include "CARingBuffer.h"
+
+// STL Includes
+#include <atomic>
+#include <memory>
+
+// System Includes
+#include <MacTypes.h>
+
+
+#pragma clang assume_nonnull begin
+
+enum BGMRingBufferProducers
+{
+    kBGMRingBufferSingleProducer,
+    kBGMRingBufferMultipleProducers
+};
+
+template <BGMRingBufferProducers tProducers>
+class BGM_AudioRingBuffer
+{
+
+public:
+    typedef SInt64              SampleTime;
+
+                                BGM_AudioRingBuffer();
+                                ~BGM_AudioRingBuffer() = default;
+                                BGM_AudioRingBuffer(const BGM_AudioRingBuffer&) = delete;
+                                BGM_AudioRingBuffer& operator=(const BGM_AudioRingBuffer&) = delete;
+
+    /*!
+     Allocate the buffer, replacing any audio it held.
+
+     @param inChannels The number of interleaved channels in each frame.
+     @param inCapacityFrames The number of frames the buffer can hold. Will be rounded up to a power
+                             of two.
+     */
+    void                        Allocate(UInt32 inChannels, UInt32 inCapacityFrames);
+    void                        Deallocate();
+
+    UInt32                      GetChannels() const { return mChannels; }
+    UInt32                      GetCapacityFrames() const { return mCapacityFrames; }
+
+    /*!
+     Copy inFrameCount frames into the buffer at inSampleTime. Like CARingBuffer::Store, any frames
+     skipped since the last store are filled with silence and storing at an earlier sample time
+     than the end of the last store empties the buffer first.
+
+     @return kCARingBufferError_TooMuch if inFrameCount is larger than the buffer.
+             kCARingBufferError_CPUOverload if another thread was storing (MPSC only).
+     */
+    CARingBufferError           StoreRT(const Float32* inFrames,
+                                        UInt32 inFrameCount,
+                                        SampleTime inSampleTime);
+
+    /*!
+     Copy the frames for the sample times [inSampleTime, inSampleTime + inFrameCount) into
+     outFrames. Frames outside the buffer's time bounds are written as silence.
+
+     @return kCARingBufferError_CPUOverload if the time bounds couldn't be read or the frames were
+             overwritten while they were being copied, in which case outFrames should be treated as
+             silence.
+     */
+    CARingBufferError           FetchRT(Float32* outFrames,
+                                        UInt32 inFrameCount,
+                                        SampleTime inSampleTime) const;
+
+    /*!
+     Get the range of sample times held by the buffer, [outStartTime, outEndTime).
+
+     @return kCARingBufferError_CPUOverload if a store kept changing them while they were read.
+     */
+    CARingBufferError           GetTimeBoundsRT(SampleTime& outStartTime, SampleTime& outEndTime) const;
+
+private:
+    void                        SetTimeBoundsRT(SampleTime inStartTime, SampleTime inEndTime);
+    /*! Copy frames into the buffer, or write silence if inFrames is null. */
+    void                        WriteFramesRT(SampleTime inSampleTime,
+                                              const Float32* _Nullable inFrames,
+                                              UInt32 inFrameCount);
+    void                        ReadFramesRT(SampleTime inSampleTime,
+                                             Float32* outFrames,
+                                             UInt32 inFrameCount) const;
+
+    // The number of times GetTimeBoundsRT tries to read the time bounds before giving up.
+    static const UInt32         kMaxTimeBoundsReadAttempts = 8;
+
+    UInt32                      mChannels;
+    UInt32                      mCapacityFrames;
+    UInt32                      mCapacityFramesMask;
+    std::unique_ptr<Float32[]>  mSamples;
+
+    // The time bounds. mTimeBoundsSequence is odd while they're being changed.
+    std::atomic<UInt32>         mTimeBoundsSequence;
+    std::atomic<SampleTime>     mStartTime;
+    std::atomic<SampleTime>     mEndTime;
+
+    // Held while storing. Only used by BGM_MPSCAudioRingBuffer.
+    std::atomic_flag            mStoring;
+
+};
+
+typedef BGM_AudioRingBuffer<kBGMRingBufferSingleProducer>      BGM_SPSCAudioRingBuffer;
+typedef BGM_AudioRingBuffer<kBGMRingBufferMultipleProducers>   BGM_MPSCAudioRingBuffer;
+
+#pragma clang assume_nonnull end
+
+#endif /* SharedSource__BGM_AudioRingBuffer */
+
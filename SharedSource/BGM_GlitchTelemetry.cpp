@@ -0,0 +1,333 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+
+//
+//
+//  BGM_GlitchTelemetry.cpp
+//  SharedSource
+//
+//  Copyright © 2026 Background Music contributors
+//
+
+// Self Include
+#include "BGM_GlitchTelemetry.h"
+
+// Local Includes
+#include "BGM_Types.h"
+#include "BGM_Utils.h"
+
+// PublicUtility Includes
+#include "CACFArray.h"
+#include "CACFString.h"
+
+// STL Includes
+#include <algorithm>
+#include <cmath>
+
+// System Includes
+#include <mach/mach_time.h>
+
+
+#pragma clang assume_nonnull begin
+
+static const char* const kCounterNames[kBGMGlitchCounterCount] = {
+    "underruns",
+    "overruns",
+    "resyncs",
+    "overloads",
+    "lateCycles",
+    "shedSpectralFeatures",
+    "shedEQ",
+    "shedRouteMixing"
+};
+
+#pragma mark BGM_GlitchTelemetrySnapshot
+
+void    BGM_GlitchTelemetrySnapshot::Add(const BGM_GlitchTelemetrySnapshot& inOther)
+{
+    // Both snapshots should cover about the same time, but use the longer one just in case.
+    mSeconds = std::max(mSeconds, inOther.mSeconds);
+    mCycles += inOther.mCycles;
+    
+    for(UInt32 i = 0; i < kBGMGlitchCounterCount; i++)
+    {
+        mTotal[i] += inOther.mTotal[i];
+        mLast10Seconds[i] += inOther.mLast10Seconds[i];
+        mLast60Seconds[i] += inOther.mLast60Seconds[i];
+    }
+    
+    for(UInt32 i = 0; i < kBGMGlitchOffsetHistogramBuckets; i++)
+    {
+        mOffsetHistogram[i] += inOther.mOffsetHistogram[i];
+    }
+}
+
+#pragma mark BGM_GlitchTelemetry
+
+BGM_GlitchTelemetry::BGM_GlitchTelemetry()
+:
+    mHostTicksPerSecond(0),
+    mResetHostTime(0),
+    mCycles(0)
+{
+    mach_timebase_info_data_t theTimebase;
+    mach_timebase_info(&theTimebase);
+    mHostTicksPerSecond = 1000000000ULL * theTimebase.denom / theTimebase.numer;
+    
+    Reset();
+}
+
+#pragma mark Real-time
+
+void    BGM_GlitchTelemetry::CountRT(BGMGlitchCounter inCounter, UInt64 inHostTime)
+{
+    BGMAssert(inCounter < kBGMGlitchCounterCount, "BGM_GlitchTelemetry::CountRT: Invalid counter");
+    
+    mTotal[inCounter].fetch_add(1, std::memory_order_relaxed);
+    
+    // Count the glitch in this second's slot, moving the slot to this second if it was counting an
+    // earlier one.
+    const UInt64 theSecond = GetSecond(inHostTime) & 0xFFFFFFFF;
+    std::atomic<UInt64>& theSlot = mWindow[inCounter][theSecond % kWindowSlots];
+    UInt64 theSlotValue = theSlot.load(std::memory_order_relaxed);
+    UInt64 theNewSlotValue;
+    
+    do
+    {
+        if((theSlotValue >> 32) == theSecond)
+        {
+            theNewSlotValue = theSlotValue + 1;
+        }
+        else
+        {
+            theNewSlotValue = (theSecond << 32) | 1;
+        }
+    }
+    while(!theSlot.compare_exchange_weak(theSlotValue, theNewSlotValue, std::memory_order_relaxed));
+}
+
+void    BGM_GlitchTelemetry::CountRT(BGMGlitchCounter inCounter)
+{
+    CountRT(inCounter, mach_absolute_time());
+}
+
+void    BGM_GlitchTelemetry::CountCycleRT()
+{
+    mCycles.fetch_add(1, std::memory_order_relaxed);
+}
+
+void    BGM_GlitchTelemetry::RecordOffsetRT(Float64 inOffsetFrames)
+{
+    mOffsetHistogram[GetOffsetHistogramBucket(inOffsetFrames)].fetch_add(1, std::memory_order_relaxed);
+}
+
+#pragma mark Snapshots
+
+BGM_GlitchTelemetrySnapshot BGM_GlitchTelemetry::GetSnapshot(UInt64 inHostTime) const
+{
+    BGM_GlitchTelemetrySnapshot theSnapshot = {};
+    
+    const UInt64 theResetHostTime = mResetHostTime.load(std::memory_order_relaxed);
+    theSnapshot.mSeconds = inHostTime > theResetHostTime ?
+            static_cast<Float64>(inHostTime - theResetHostTime) / mHostTicksPerSecond : 0.0;
+    theSnapshot.mCycles = mCycles.load(std::memory_order_relaxed);
+    
+    const UInt64 theSecond = GetSecond(inHostTime) & 0xFFFFFFFF;
+    
+    for(UInt32 i = 0; i < kBGMGlitchCounterCount; i++)
+    {
+        theSnapshot.mTotal[i] = mTotal[i].load(std::memory_order_relaxed);
+        
+        for(UInt32 j = 0; j < kWindowSlots; j++)
+        {
+            const UInt64 theSlotValue = mWindow[i][j].load(std::memory_order_relaxed);
+            // How many seconds before inHostTime the slot's count is from. Wraps around if the
+            // slot is from the future, e.g. if another thread counted a glitch after
+            // inHostTime, which leaves it out of the windows.
+            const UInt64 theAge = (theSecond - (theSlotValue >> 32)) & 0xFFFFFFFF;
+            const UInt64 theCount = theSlotValue & 0xFFFFFFFF;
+            
+            if(theAge < kBGMGlitchTelemetryShortWindowSeconds)
+            {
+                theSnapshot.mLast10Seconds[i] += theCount;
+            }
+            
+            if(theAge < kBGMGlitchTelemetryWindowSeconds)
+            {
+                theSnapshot.mLast60Seconds[i] += theCount;
+            }
+        }
+    }
+    
+    for(UInt32 i = 0; i < kBGMGlitchOffsetHistogramBuckets; i++)
+    {
+        theSnapshot.mOffsetHistogram[i] = mOffsetHistogram[i].load(std::memory_order_relaxed);
+    }
+    
+    return theSnapshot;
+}
+
+BGM_GlitchTelemetrySnapshot BGM_GlitchTelemetry::GetSnapshot() const
+{
+    return GetSnapshot(mach_absolute_time());
+}
+
+void    BGM_GlitchTelemetry::Reset(UInt64 inHostTime)
+{
+    mResetHostTime.store(inHostTime, std::memory_order_relaxed);
+    mCycles.store(0, std::memory_order_relaxed);
+    
+    for(UInt32 i = 0; i < kBGMGlitchCounterCount; i++)
+    {
+        mTotal[i].store(0, std::memory_order_relaxed);
+        
+        for(UInt32 j = 0; j < kWindowSlots; j++)
+        {
+            mWindow[i][j].store(0, std::memory_order_relaxed);
+        }
+    }
+    
+    for(UInt32 i = 0; i < kBGMGlitchOffsetHistogramBuckets; i++)
+    {
+        mOffsetHistogram[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void    BGM_GlitchTelemetry::Reset()
+{
+    Reset(mach_absolute_time());
+}
+
+#pragma mark Dictionaries
+
+// static
+CACFDictionary  BGM_GlitchTelemetry::CopyAsDictionary(const BGM_GlitchTelemetrySnapshot& inSnapshot)
+{
+    CACFDictionary theDictionary(false);
+    
+    theDictionary.AddFloat64(CFSTR(kBGMGlitchTelemetryKey_Seconds), inSnapshot.mSeconds);
+    theDictionary.AddUInt64(CFSTR(kBGMGlitchTelemetryKey_Cycles), inSnapshot.mCycles);
+    
+    auto AddCounts = [&] (CFStringRef inKey, const UInt64* inCounts) {
+        CACFDictionary theCounts(true);
+        
+        for(UInt32 i = 0; i < kBGMGlitchCounterCount; i++)
+        {
+            theCounts.AddUInt64(CACFString(kCounterNames[i]).GetCFString(), inCounts[i]);
+        }
+        
+        theDictionary.AddDictionary(inKey, theCounts.GetDict());
+    };
+    
+    AddCounts(CFSTR(kBGMGlitchTelemetryKey_Total), inSnapshot.mTotal);
+    AddCounts(CFSTR(kBGMGlitchTelemetryKey_Last10Seconds), inSnapshot.mLast10Seconds);
+    AddCounts(CFSTR(kBGMGlitchTelemetryKey_Last60Seconds), inSnapshot.mLast60Seconds);
+    
+    CACFArray theHistogram(true);
+    
+    for(UInt32 i = 0; i < kBGMGlitchOffsetHistogramBuckets; i++)
+    {
+        theHistogram.AppendUInt64(inSnapshot.mOffsetHistogram[i]);
+    }
+    
+    theDictionary.AddArray(CFSTR(kBGMGlitchTelemetryKey_OffsetHistogram), theHistogram.GetCFArray());
+    
+    return theDictionary;
+}
+
+// static
+bool    BGM_GlitchTelemetry::ReadDictionary(const CACFDictionary& inDictionary,
+                                            BGM_GlitchTelemetrySnapshot& outSnapshot)
+{
+    outSnapshot = {};
+    
+    if(!inDictionary.GetFloat64(CFSTR(kBGMGlitchTelemetryKey_Seconds), outSnapshot.mSeconds) ||
+       !inDictionary.GetUInt64(CFSTR(kBGMGlitchTelemetryKey_Cycles), outSnapshot.mCycles))
+    {
+        return false;
+    }
+    
+    auto ReadCounts = [&] (CFStringRef inKey, UInt64* outCounts) {
+        CFDictionaryRef theCountsRef = nullptr;
+        
+        if(!inDictionary.GetDictionary(inKey, theCountsRef))
+        {
+            return false;
+        }
+        
+        CACFDictionary theCounts(theCountsRef, false);
+        
+        for(UInt32 i = 0; i < kBGMGlitchCounterCount; i++)
+        {
+            theCounts.GetUInt64(CACFString(kCounterNames[i]).GetCFString(), outCounts[i]);
+        }
+        
+        return true;
+    };
+    
+    if(!ReadCounts(CFSTR(kBGMGlitchTelemetryKey_Total), outSnapshot.mTotal) ||
+       !ReadCounts(CFSTR(kBGMGlitchTelemetryKey_Last10Seconds), outSnapshot.mLast10Seconds) ||
+       !ReadCounts(CFSTR(kBGMGlitchTelemetryKey_Last60Seconds), outSnapshot.mLast60Seconds))
+    {
+        return false;
+    }
+    
+    CFArrayRef theHistogramRef = nullptr;
+    
+    if(!inDictionary.GetArray(CFSTR(kBGMGlitchTelemetryKey_OffsetHistogram), theHistogramRef))
+    {
+        return false;
+    }
+    
+    CACFArray theHistogram(theHistogramRef, false);
+    
+    for(UInt32 i = 0; i < std::min(theHistogram.GetNumberItems(), UInt32(kBGMGlitchOffsetHistogramBuckets)); i++)
+    {
+        theHistogram.GetUInt64(i, outSnapshot.mOffsetHistogram[i]);
+    }
+    
+    return true;
+}
+
+// static
+const char*     BGM_GlitchTelemetry::GetCounterName(BGMGlitchCounter inCounter)
+{
+    return inCounter < kBGMGlitchCounterCount ? kCounterNames[inCounter] : "unknown";
+}
+
+// static
+UInt32  BGM_GlitchTelemetry::GetOffsetHistogramBucket(Float64 inOffsetFrames)
+{
+    if(!(inOffsetFrames >= 1.0))  // Also catches NaN.
+    {
+        return 0;
+    }
+    
+    // Offsets from 2^(n-1) up to 2^n go in bucket n.
+    int theExponent;
+    std::frexp(inOffsetFrames, &theExponent);
+    
+    return std::min(static_cast<UInt32>(theExponent), UInt32(kBGMGlitchOffsetHistogramBuckets - 1));
+}
+
+// static
+SInt64  BGM_GlitchTelemetry::GetOffsetHistogramBucketStart(UInt32 inBucket)
+{
+    return inBucket == 0 ? 0 : (SInt64(1) << (inBucket - 1));
+}
+
+#pragma clang assume_nonnull end
+
@@ -0,0 +1,170 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+
+//
+//
+//  BGM_GlitchTelemetry.h
+//  SharedSource
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  Counts the audio glitches on a real-time IO path, so they can be monitored instead of only
+//  being logged. BGM_IOPipeline keeps one for BGMDevice, which it publishes as
+//  kAudioDeviceCustomPropertyGlitchTelemetry, and BGMPlayThrough keeps one for each playthrough,
+//  which BGMApp publishes through BGMXPCHelper.
+//
+//  Each counter is kept since the telemetry was last reset and for each of the last
+//  kBGMGlitchTelemetryWindowSeconds seconds, so rates over the last 10 and 60 seconds can be read
+//  without polling. The telemetry also has a histogram of the offset between the input and output
+//  sample times, i.e. the IO path's latency, which shows how close the reads run to the writes.
+//
+//  The RT functions are wait-free apart from a compare-and-swap loop on the windowed counters,
+//  which only retries if another thread counts the same glitch at the same time. Any number of
+//  threads can count glitches. Reset isn't synchronised with them, so counts from the moment it's
+//  called can be lost.
+//
+
+#ifndef SharedSource__BGM_GlitchTelemetry
+#define SharedSource__BGM_GlitchTelemetry
+
+// PublicUtility Includes
+#include "CACFDictionary.h"
+
+// STL Includes
+#include <atomic>
+
+// System Includes
+#include <MacTypes.h>
+
+
+#pragma clang assume_nonnull begin
+
+enum BGMGlitchCounter : UInt32
+{
+    // The reader asked for audio that hadn't been written yet and got silence for some of it.
+    kBGMGlitchUnderrun,
+    // The reader asked for audio that had already been overwritten.
+    kBGMGlitchOverrun,
+    // The read or write position had to be moved, e.g. because the sample times jumped.
+    kBGMGlitchResync,
+    // A ring buffer's reader and writer raced (kCARingBufferError_CPUOverload), so the reader got
+    // silence.
+    kBGMGlitchCPUOverload,
+    // An IO cycle finished after its deadline.
+    kBGMGlitchLateCycle,
+    // Optional processing a client's audio skipped because the IO cycle was running out of time.
+    // (See BGM_DSPBudget.h.) Only counted by BGMDevice. These are counted once per client per
+    // cycle, in the order the processing is shed: the spectral features of the signal
+    // classification, the EQ of low-priority apps and the mixing of routed audio.
+    kBGMGlitchShedSpectralFeatures,
+    kBGMGlitchShedEQ,
+    kBGMGlitchShedRouteMixing,
+    kBGMGlitchCounterCount
+};
+
+// The seconds the windowed counts are kept for.
+#define kBGMGlitchTelemetryWindowSeconds        60
+#define kBGMGlitchTelemetryShortWindowSeconds   10
+
+// Bucket 0 counts offsets of less than one frame and bucket n counts offsets from 2^(n-1) up to
+// 2^n frames. The last bucket also counts anything larger.
+#define kBGMGlitchOffsetHistogramBuckets        16
+
+struct BGM_GlitchTelemetrySnapshot
+{
+    // The seconds since the telemetry was reset (or created).
+    Float64                     mSeconds;
+    UInt64                      mCycles;
+    UInt64                      mTotal[kBGMGlitchCounterCount];
+    UInt64                      mLast10Seconds[kBGMGlitchCounterCount];
+    UInt64                      mLast60Seconds[kBGMGlitchCounterCount];
+    UInt64                      mOffsetHistogram[kBGMGlitchOffsetHistogramBuckets];
+    
+    /*! Add another snapshot's counts to this one's, e.g. to combine two playthroughs'. */
+    void                        Add(const BGM_GlitchTelemetrySnapshot& inOther);
+};
+
+class BGM_GlitchTelemetry
+{
+
+public:
+                                BGM_GlitchTelemetry();
+                                BGM_GlitchTelemetry(const BGM_GlitchTelemetry&) = delete;
+                                BGM_GlitchTelemetry& operator=(const BGM_GlitchTelemetry&) = delete;
+
+#pragma mark Real-time
+
+    /*! @param inHostTime The time of the glitch, from mach_absolute_time. */
+    void                        CountRT(BGMGlitchCounter inCounter, UInt64 inHostTime);
+    void                        CountRT(BGMGlitchCounter inCounter);
+    
+    /*! Count an IO cycle, so the glitch counts can be read as a rate. */
+    void                        CountCycleRT();
+    
+    /*! Add the offset between the input and output sample times in a cycle to the histogram. */
+    void                        RecordOffsetRT(Float64 inOffsetFrames);
+
+#pragma mark Snapshots
+
+    BGM_GlitchTelemetrySnapshot GetSnapshot(UInt64 inHostTime) const;
+    BGM_GlitchTelemetrySnapshot GetSnapshot() const;
+    
+    /*! Zero the counters and histogram. */
+    void                        Reset(UInt64 inHostTime);
+    void                        Reset();
+    
+    /*!
+     Copy a snapshot into a dictionary in the kAudioDeviceCustomPropertyGlitchTelemetry format.
+     See the kBGMGlitchTelemetryKey_* keys in BGM_Types.h.
+     */
+    static CACFDictionary       CopyAsDictionary(const BGM_GlitchTelemetrySnapshot& inSnapshot);
+    
+    /*!
+     The reverse of CopyAsDictionary. Counters missing from the dictionary are read as zero.
+     
+     @return False if the dictionary isn't in the kAudioDeviceCustomPropertyGlitchTelemetry format.
+     */
+    static bool                 ReadDictionary(const CACFDictionary& inDictionary,
+                                               BGM_GlitchTelemetrySnapshot& outSnapshot);
+    
+    /*! The counter's key in the dictionaries, e.g. "underruns". */
+    static const char*          GetCounterName(BGMGlitchCounter inCounter);
+    
+    static UInt32               GetOffsetHistogramBucket(Float64 inOffsetFrames);
+    /*! The smallest offset counted by the bucket, in frames. (Bucket 0 also counts negative ones.) */
+    static SInt64               GetOffsetHistogramBucketStart(UInt32 inBucket);
+
+private:
+    UInt64                      GetSecond(UInt64 inHostTime) const { return inHostTime / mHostTicksPerSecond; }
+    
+    // Each slot holds the second it's counting in its high 32 bits and the count in its low 32, so
+    // a slot can be moved to a new second and counted in one atomic operation.
+    static const UInt32         kWindowSlots = 64;
+    static_assert(kWindowSlots >= kBGMGlitchTelemetryWindowSeconds,
+                  "BGM_GlitchTelemetry: Not enough slots for the window");
+
+    UInt64                      mHostTicksPerSecond;
+    std::atomic<UInt64>         mResetHostTime;
+    std::atomic<UInt64>         mCycles;
+    std::atomic<UInt64>         mTotal[kBGMGlitchCounterCount];
+    std::atomic<UInt64>         mWindow[kBGMGlitchCounterCount][kWindowSlots];
+    std::atomic<UInt64>         mOffsetHistogram[kBGMGlitchOffsetHistogramBuckets];
+
+};
+
+#pragma clang assume_nonnull end
+
+#endif /* SharedSource__BGM_GlitchTelemetry */
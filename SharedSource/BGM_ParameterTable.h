@@ -0,0 +1,408 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_ParameterTable.h
+//  SharedSource
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  A table of per-app parameters in shared memory, so apps can change them at high rates (e.g.
+//  from MIDI controllers) without sending kAudioDeviceCustomPropertyAppVolumes through the HAL for
+//  each change. BGMApp creates the table with BGMParameterTableCreate and writes to it with
+//  BGMParameterTableSetValue. BGMDriver maps it with BGMParameterTableOpenReadOnly and reads it
+//  from its IO thread.
+//
+//  The table has a slot for each app (by PID) with a value for each parameter. Each value is a
+//  single 32-bit word, read and written atomically, so neither side needs a lock. A value in the
+//  table overrides the one set with the property until the property is set again for that app, so
+//  apps should still set the property once the parameter settles, e.g. when a fader is released,
+//  to update the value BGMDriver reports and persists.
+//
+//  Trust model: the table is only writable by the user that created it, and BGMDriver only reads a
+//  table that's owned by the user logged in at the console and can't be written by anyone else.
+//  So only the console user's processes, i.e. BGMApp, can change apps' volumes through it. Any
+//  process can read it, which only reveals the volumes BGMApp has set. The writer can set the
+//  values of any PID, which is no more than the console user can already do with the property. If
+//  another user has created an object with the table's name, BGMApp can't create the table and
+//  BGMDriver won't read it, so BGMApp falls back to the property.
+//
+//  BGMDriver never writes to the table. It keeps track of the values it's overridden with the
+//  property itself, using the write counts in each slot. (See BGM_SharedParameterTable.)
+//
+//  Only uses C and the compiler's atomic builtins, so it can be included from C, Objective-C and
+//  C++.
+//
+
+#ifndef SharedSource__BGM_ParameterTable
+#define SharedSource__BGM_ParameterTable
+
+// System Includes
+#include <MacTypes.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <math.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+
+#pragma clang assume_nonnull begin
+
+#pragma mark Layout
+
+// The names of the shared memory objects for BGMDevice's and the UI sounds device's tables. (POSIX
+// shared memory names can only be 31 characters long on macOS.)
+#define kBGMParameterTableName              "/FloDevice.params"
+#define kBGMParameterTableName_UISounds     "/FloDevice_UISounds.params"
+
+#define kBGMParameterTableMagic             'bgmp'
+// Increment this whenever the layout changes. Apps should only use tables with the version they
+// were built with.
+#define kBGMParameterTableVersion           2
+#define kBGMParameterTableSlotCount         128
+
+// The values of a slot's mProcessID that aren't PIDs.
+#define kBGMParameterSlotFree               0
+#define kBGMParameterSlotBusy               -1
+
+// The parameters, i.e. the indexes of the values in each slot.
+enum BGMParameter
+{
+    // The app's volume in the same range as kBGMAppVolumesKey_RelativeVolume, i.e. from
+    // kAppRelativeVolumeMinRawValue to kAppRelativeVolumeMaxRawValue, but with fractional values
+    // allowed so high-resolution controllers can use their full range.
+    kBGMParameterRelativeVolume = 0,
+    // The app's pan position in the same range as kBGMAppVolumesKey_PanPosition.
+    kBGMParameterPanPosition    = 1,
+    kBGMParameterCount          = 2
+};
+
+typedef struct BGMParameterTableSlot
+{
+    // The PID of the app whose parameters are in this slot, kBGMParameterSlotFree or
+    // kBGMParameterSlotBusy while the slot is being claimed or released.
+    pid_t       mProcessID;
+    // The values of the parameters, or NaN for the ones that haven't been set.
+    Float32     mValues[kBGMParameterCount];
+    // The number of times each value has been set, incremented after the value is stored. Only
+    // ever increases, so readers can tell whether a value has been set since they last looked.
+    UInt32      mWriteCounts[kBGMParameterCount];
+} BGMParameterTableSlot;
+
+typedef struct BGMParameterTable
+{
+    // Set to kBGMParameterTableMagic after the rest of the table has been initialised.
+    UInt32      mMagic;
+    UInt32      mVersion;
+    UInt32      mSlotCount;
+    // Incremented every time a slot is claimed or released, so readers know when the slots they've
+    // found for their apps might have moved.
+    UInt32      mAllocationCount;
+    BGMParameterTableSlot mSlots[kBGMParameterTableSlotCount];
+} BGMParameterTable;
+
+#pragma mark Access
+
+// Returns the slot with the app's parameters or NULL if it doesn't have one. Slots are searched
+// from a position based on the PID, so finding one usually only takes one comparison.
+static inline BGMParameterTableSlot* _Nullable BGMParameterTableFindSlot(BGMParameterTable* inTable,
+                                                                         pid_t inProcessID)
+{
+    if(inProcessID <= 0)
+    {
+        return NULL;
+    }
+    
+    for(UInt32 i = 0; i < kBGMParameterTableSlotCount; i++)
+    {
+        BGMParameterTableSlot* theSlot =
+                &inTable->mSlots[((UInt32)inProcessID + i) % kBGMParameterTableSlotCount];
+        
+        if(__atomic_load_n(&theSlot->mProcessID, __ATOMIC_ACQUIRE) == inProcessID)
+        {
+            return theSlot;
+        }
+    }
+    
+    return NULL;
+}
+
+// Take the slot from inOwner, which is kBGMParameterSlotFree or the PID of an app that has exited,
+// and give it to inProcessID with its values unset. Returns false if the slot has changed owner.
+static inline bool BGMParameterTableTakeSlot(BGMParameterTable* inTable,
+                                             BGMParameterTableSlot* inSlot,
+                                             pid_t inOwner,
+                                             pid_t inProcessID)
+{
+    // Mark the slot busy while we clear it, so readers can't match it with stale values.
+    if(!__atomic_compare_exchange_n(&inSlot->mProcessID,
+                                    &inOwner,
+                                    kBGMParameterSlotBusy,
+                                    false,
+                                    __ATOMIC_ACQ_REL,
+                                    __ATOMIC_RELAXED))
+    {
+        return false;
+    }
+    
+    for(UInt32 theParameter = 0; theParameter < kBGMParameterCount; theParameter++)
+    {
+        Float32 theUnset = NAN;
+        __atomic_store(&inSlot->mValues[theParameter], &theUnset, __ATOMIC_RELAXED);
+    }
+    
+    __atomic_store_n(&inSlot->mProcessID, inProcessID, __ATOMIC_RELEASE);
+    __atomic_fetch_add(&inTable->mAllocationCount, 1, __ATOMIC_RELEASE);
+    
+    return true;
+}
+
+// Returns the app's slot, claiming a free one for it if it doesn't have one yet, or NULL if the
+// table is full. If no slot is free, takes one from an app that has exited without its slot being
+// released.
+static inline BGMParameterTableSlot* _Nullable BGMParameterTableClaimSlot(BGMParameterTable* inTable,
+                                                                          pid_t inProcessID)
+{
+    BGMParameterTableSlot* theSlot = BGMParameterTableFindSlot(inTable, inProcessID);
+    
+    for(UInt32 i = 0; theSlot == NULL && inProcessID > 0 && i < kBGMParameterTableSlotCount; i++)
+    {
+        BGMParameterTableSlot* theCandidate =
+                &inTable->mSlots[((UInt32)inProcessID + i) % kBGMParameterTableSlotCount];
+        
+        if(BGMParameterTableTakeSlot(inTable, theCandidate, kBGMParameterSlotFree, inProcessID))
+        {
+            theSlot = theCandidate;
+        }
+    }
+    
+    for(UInt32 i = 0; theSlot == NULL && inProcessID > 0 && i < kBGMParameterTableSlotCount; i++)
+    {
+        BGMParameterTableSlot* theCandidate =
+                &inTable->mSlots[((UInt32)inProcessID + i) % kBGMParameterTableSlotCount];
+        pid_t theOwner = __atomic_load_n(&theCandidate->mProcessID, __ATOMIC_ACQUIRE);
+        
+        if(theOwner > 0 &&
+           kill(theOwner, 0) != 0 &&
+           errno == ESRCH &&
+           BGMParameterTableTakeSlot(inTable, theCandidate, theOwner, inProcessID))
+        {
+            theSlot = theCandidate;
+        }
+    }
+    
+    return theSlot;
+}
+
+// Free the app's slot, if it has one.
+static inline void BGMParameterTableReleaseSlot(BGMParameterTable* inTable, pid_t inProcessID)
+{
+    BGMParameterTableSlot* theSlot = BGMParameterTableFindSlot(inTable, inProcessID);
+    
+    if(theSlot != NULL)
+    {
+        BGMParameterTableTakeSlot(inTable, theSlot, inProcessID, kBGMParameterSlotFree);
+    }
+}
+
+// Set one of an app's parameters. Pass NAN to unset it. Returns false if the app has no slot and
+// the table is full.
+static inline bool BGMParameterTableSetValue(BGMParameterTable* inTable,
+                                             pid_t inProcessID,
+                                             enum BGMParameter inParameter,
+                                             Float32 inValue)
+{
+    BGMParameterTableSlot* theSlot = BGMParameterTableClaimSlot(inTable, inProcessID);
+    
+    if(theSlot == NULL || inParameter >= kBGMParameterCount)
+    {
+        return false;
+    }
+    
+    __atomic_store(&theSlot->mValues[inParameter], &inValue, __ATOMIC_RELEASE);
+    __atomic_fetch_add(&theSlot->mWriteCounts[inParameter], 1, __ATOMIC_RELEASE);
+    
+    return true;
+}
+
+// Get one of an app's parameters from its slot. Returns false if it isn't set or the slot has been
+// given to another app. Real-time safe.
+static inline bool BGMParameterTableGetValue(const BGMParameterTableSlot* inSlot,
+                                             pid_t inProcessID,
+                                             enum BGMParameter inParameter,
+                                             Float32* outValue)
+{
+    Float32 theValue;
+    __atomic_load(&inSlot->mValues[inParameter], &theValue, __ATOMIC_ACQUIRE);
+    
+    // Check the slot still belongs to the app after reading the value, rather than before, so we
+    // can't return a value written for another app.
+    if(__atomic_load_n(&inSlot->mProcessID, __ATOMIC_ACQUIRE) != inProcessID || isnan(theValue))
+    {
+        return false;
+    }
+    
+    *outValue = theValue;
+    
+    return true;
+}
+
+#pragma mark Mapping
+
+// Initialise a new table. The magic number is set last, so it can't be used before then.
+static inline void BGMParameterTableInitialize(BGMParameterTable* outTable)
+{
+    memset(outTable, 0, sizeof(BGMParameterTable));
+    
+    outTable->mVersion = kBGMParameterTableVersion;
+    outTable->mSlotCount = kBGMParameterTableSlotCount;
+    outTable->mAllocationCount = 1;
+    
+    for(UInt32 i = 0; i < kBGMParameterTableSlotCount; i++)
+    {
+        outTable->mSlots[i].mProcessID = kBGMParameterSlotFree;
+        
+        for(UInt32 theParameter = 0; theParameter < kBGMParameterCount; theParameter++)
+        {
+            outTable->mSlots[i].mValues[theParameter] = NAN;
+        }
+    }
+    
+    __atomic_store_n(&outTable->mMagic, kBGMParameterTableMagic, __ATOMIC_RELEASE);
+}
+
+// Returns true if the table has been initialised with this version's layout.
+static inline bool BGMParameterTableIsValid(const BGMParameterTable* inTable)
+{
+    return __atomic_load_n(&inTable->mMagic, __ATOMIC_ACQUIRE) == kBGMParameterTableMagic &&
+           inTable->mVersion == kBGMParameterTableVersion &&
+           inTable->mSlotCount == kBGMParameterTableSlotCount;
+}
+
+// Create the table with the given name, writable only by this process's user, and map it into this
+// process. If this user has already created it, e.g. in an earlier run, the existing table is
+// reused so BGMDriver keeps reading the same one. Returns NULL if it fails, e.g. because another
+// user has created the table. Unmap it with BGMParameterTableClose.
+static inline BGMParameterTable* _Nullable BGMParameterTableCreate(const char* inName)
+{
+    void* theMemory = MAP_FAILED;
+    
+    for(int theAttempt = 0; theMemory == MAP_FAILED && theAttempt < 2; theAttempt++)
+    {
+        // Fails if another user created the table, since only they can write to it.
+        int theFile = shm_open(inName, O_RDWR | O_CREAT | (theAttempt > 0 ? O_EXCL : 0), 0644);
+        
+        if(theFile < 0)
+        {
+            break;
+        }
+        
+        struct stat theFileInfo;
+        
+        // Set the mode in case the umask changed it.
+        if(fstat(theFile, &theFileInfo) == 0 &&
+           theFileInfo.st_uid == geteuid() &&
+           fchmod(theFile, 0644) == 0 &&
+           (theFileInfo.st_size == (off_t)sizeof(BGMParameterTable) ||
+            (theFileInfo.st_size == 0 && ftruncate(theFile, sizeof(BGMParameterTable)) == 0)))
+        {
+            theMemory = mmap(NULL, sizeof(BGMParameterTable), PROT_READ | PROT_WRITE, MAP_SHARED, theFile, 0);
+        }
+        
+        close(theFile);
+        
+        // We could write to it but can't use it, e.g. because an older version created it with a
+        // different size or another user created it writable by everyone. Shared memory objects
+        // can't be resized on macOS or chowned, so replace it.
+        if(theMemory == MAP_FAILED && theAttempt == 0)
+        {
+            shm_unlink(inName);
+        }
+    }
+    
+    if(theMemory == MAP_FAILED)
+    {
+        return NULL;
+    }
+    
+    BGMParameterTable* theTable = (BGMParameterTable*)theMemory;
+    
+    if(!BGMParameterTableIsValid(theTable))
+    {
+        BGMParameterTableInitialize(theTable);
+    }
+    
+    return theTable;
+}
+
+// Map the table with the given name into this process read-only, if it's owned by inOwner and no
+// other user can write to it. Returns NULL otherwise, or if it hasn't been created or has a
+// different version. The returned table must not be written to. Unmap it with
+// BGMParameterTableClose.
+static inline BGMParameterTable* _Nullable BGMParameterTableOpenReadOnly(const char* inName,
+                                                                         uid_t inOwner)
+{
+    int theFile = shm_open(inName, O_RDONLY, 0);
+    
+    if(theFile < 0)
+    {
+        return NULL;
+    }
+    
+    struct stat theFileInfo;
+    void* theMemory = MAP_FAILED;
+    
+    if(fstat(theFile, &theFileInfo) == 0 &&
+       theFileInfo.st_uid == inOwner &&
+       (theFileInfo.st_mode & (S_IWGRP | S_IWOTH)) == 0 &&
+       theFileInfo.st_size >= (off_t)sizeof(BGMParameterTable))
+    {
+        theMemory = mmap(NULL, sizeof(BGMParameterTable), PROT_READ, MAP_SHARED, theFile, 0);
+    }
+    
+    close(theFile);
+    
+    if(theMemory == MAP_FAILED)
+    {
+        return NULL;
+    }
+    
+    BGMParameterTable* theTable = (BGMParameterTable*)theMemory;
+    
+    if(!BGMParameterTableIsValid(theTable))
+    {
+        munmap(theMemory, sizeof(BGMParameterTable));
+        return NULL;
+    }
+    
+    return theTable;
+}
+
+static inline void BGMParameterTableClose(BGMParameterTable* inTable)
+{
+    munmap(inTable, sizeof(BGMParameterTable));
+}
+
+#pragma clang assume_nonnull end
+
+#endif /* SharedSource__BGM_ParameterTable */
+
@@ -0,0 +1,737 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_RTEventLog.cpp
+//  SharedSource
+//
+//  Copyright © 2026 Background Music contributors
+//
+
+// Self Include
+#include "BGM_RTEventLog.h"
+
+// Local Includes
+#include "BGM_Utils.h"
+
+// PublicUtility Includes
+#include "CADebugMacros.h"
+#include "CAException.h"
+
+// STL Includes
+#include <algorithm>
+#include <chrono>
+
+// System Includes
+#include <CoreAudio/AudioHardwareBase.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <mach/mach_init.h>
+#include <mach/mach_time.h>
+#include <mach/task.h>
+#include <unistd.h>
+
+
+#pragma clang assume_nonnull begin
+
+// While messages are being suppressed, the logging thread also wakes this often to report them,
+// even if nothing else is logged.
+static const UInt32 kSuppressedMessagesReportPeriodMS = 1000;
+
+static const BGM_RTEventType kDroppedEventType = {
+    "BGM_RTEventLog: Dropped events because their channel was full or busy",
+    kBGMRTEventSeverityWarning,
+    nullptr,
+    { "count", "channel", nullptr, nullptr },
+    { kBGMRTEventArgInteger, kBGMRTEventArgInteger, kBGMRTEventArgUnused, kBGMRTEventArgUnused }
+};
+
+#pragma mark Log
+
+BGM_RTEventLog::BGM_RTEventLog(const BGM_RTEventType* inTypes,
+                               UInt16 inTypeCount,
+                               UInt16 inChannelCount,
+                               UInt32 inEventsPerChannel,
+                               MessageHandler _Nullable inMessageHandler)
+:
+    mTypes(inTypes),
+    mTypeCount(inTypeCount),
+    mChannelCount(inChannelCount),
+    // Round up to a power of two so positions can be masked.
+    mEventsPerChannel([inEventsPerChannel] {
+        UInt32 theEvents = 1;
+
+        while(theEvents < inEventsPerChannel && theEvents < (1U << 31))
+        {
+            theEvents <<= 1;
+        }
+
+        return theEvents;
+    }()),
+    mChannels(new BGM_RTEventChannel[inChannelCount]),
+    mMessageHandler(inMessageHandler),
+    mDrainedEvents(),
+    mRateLimits(inTypeCount + 1),  // The last is for kBGMRTEventTypeDropped.
+    mHostTicksPerSecond(0),
+    mLoggingThreadSemaphore(SEMAPHORE_NULL),
+    mStopLoggingThread(false),
+    mFile(nullptr)
+{
+    kern_return_t theError =
+            semaphore_create(mach_task_self(), &mLoggingThreadSemaphore, SYNC_POLICY_FIFO, 0);
+    BGM_Utils::ThrowIfMachError("BGM_RTEventLog::BGM_RTEventLog", "semaphore_create", theError);
+
+    for(UInt16 i = 0; i < mChannelCount; i++)
+    {
+        mChannels[i].mEvents.reset(new BGM_RTEvent[mEventsPerChannel]);
+    }
+
+    mDrainedEvents.reserve(mEventsPerChannel * mChannelCount);
+
+    mach_timebase_info_data_t theTimebase;
+    mach_timebase_info(&theTimebase);
+    mHostTicksPerSecond = 1000000000ULL * theTimebase.denom / theTimebase.numer;
+
+    // Create the logging thread last because it starts immediately.
+    mLoggingThread = std::thread(&BGM_RTEventLog::LoggingThreadProc, this);
+}
+
+BGM_RTEventLog::~BGM_RTEventLog()
+{
+    mStopLoggingThread = true;
+
+    kern_return_t theError = semaphore_signal(mLoggingThreadSemaphore);
+    BGM_Utils::LogIfMachError("BGM_RTEventLog::~BGM_RTEventLog", "semaphore_signal", theError);
+
+    mLoggingThread.join();
+
+    // The logging thread drained the channels before it stopped, so this just closes the file.
+    StopRecording();
+
+    theError = semaphore_destroy(mach_task_self(), mLoggingThreadSemaphore);
+    BGM_Utils::LogIfMachError("BGM_RTEventLog::~BGM_RTEventLog", "semaphore_destroy", theError);
+}
+
+void    BGM_RTEventLog::LogDetailRT(UInt16 inChannel,
+                                    UInt16 inType,
+                                    const char* _Nullable inDetail,
+                                    BGM_RTEventArg inArg0,
+                                    BGM_RTEventArg inArg1,
+                                    BGM_RTEventArg inArg2,
+                                    BGM_RTEventArg inArg3)
+{
+    if(inChannel >= mChannelCount || inType >= mTypeCount)
+    {
+        return;
+    }
+
+    BGM_RTEventChannel& theChannel = mChannels[inChannel];
+
+    // Claim the channel. If another thread is logging to it, drop the event instead of waiting.
+    if(theChannel.mLogging.test_and_set(std::memory_order_acquire))
+    {
+        theChannel.mSequenceNumber.fetch_add(1, std::memory_order_relaxed);
+        theChannel.mDroppedEvents.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    UInt64 theSequenceNumber = theChannel.mSequenceNumber.fetch_add(1, std::memory_order_relaxed);
+    UInt64 theWritePosition = theChannel.mWritePosition.load(std::memory_order_relaxed);
+
+    if(theWritePosition - theChannel.mReadPosition.load(std::memory_order_acquire) >= mEventsPerChannel)
+    {
+        theChannel.mDroppedEvents.fetch_add(1, std::memory_order_relaxed);
+        theChannel.mLogging.clear(std::memory_order_release);
+        return;
+    }
+
+    BGM_RTEvent& theEvent = theChannel.mEvents[theWritePosition & (mEventsPerChannel - 1)];
+    theEvent.mHostTime = mach_absolute_time();
+    theEvent.mSequenceNumber = theSequenceNumber;
+    theEvent.mType = inType;
+    theEvent.mChannel = inChannel;
+    theEvent.mReserved = 0;
+    theEvent.mArgs[0] = inArg0;
+    theEvent.mArgs[1] = inArg1;
+    theEvent.mArgs[2] = inArg2;
+    theEvent.mArgs[3] = inArg3;
+
+    // Copy the detail string, truncating it if it's too long. (strlcpy isn't available everywhere
+    // the portable build is.)
+    UInt32 theDetailLength = 0;
+
+    while(inDetail != nullptr &&
+          inDetail[theDetailLength] != '\0' &&
+          theDetailLength < kBGMRTEventDetailBytes - 1)
+    {
+        theEvent.mDetail[theDetailLength] = inDetail[theDetailLength];
+        theDetailLength++;
+    }
+
+    theEvent.mDetail[theDetailLength] = '\0';
+
+    theChannel.mWritePosition.store(theWritePosition + 1, std::memory_order_seq_cst);
+    theChannel.mLogging.clear(std::memory_order_release);
+
+    // Wake the logging thread if the channel was empty, i.e. the logging thread had drained
+    // everything before this event. Otherwise it's already been woken for the earlier events and
+    // DrainChannels will check for this one once it's handled them. (This and DrainChannels
+    // each store their position before loading the other's, so at least one sees the other's.)
+    if(theChannel.mReadPosition.load(std::memory_order_seq_cst) == theWritePosition)
+    {
+        semaphore_signal(mLoggingThreadSemaphore);
+    }
+}
+
+void    BGM_RTEventLog::StartRecording(const char* inPath)
+{
+    std::lock_guard<std::mutex> theLock(mLoggingThreadMutex);
+
+    // Handle the events logged so far, so they're written to the current recording (if there is
+    // one) rather than the new one.
+    DrainChannels();
+
+    if(mFile != nullptr)
+    {
+        fclose(mFile);
+        mFile = nullptr;
+    }
+
+    // Don't overwrite anything that's already at the path.
+    int theFileDescriptor = open(inPath, O_WRONLY | O_CREAT | O_EXCL, 0644);
+
+    if(theFileDescriptor < 0)
+    {
+        LogError("BGM_RTEventLog::StartRecording: Couldn't create %s: %s", inPath, strerror(errno));
+        Throw(CAException(kAudioHardwareIllegalOperationError));
+    }
+
+    mFile = fdopen(theFileDescriptor, "wb");
+
+    if(mFile == nullptr)
+    {
+        close(theFileDescriptor);
+        Throw(CAException(kAudioHardwareUnspecifiedError));
+    }
+
+    if(!WriteFileHeader())
+    {
+        LogError("BGM_RTEventLog::StartRecording: Couldn't write to %s", inPath);
+        fclose(mFile);
+        mFile = nullptr;
+        unlink(inPath);
+        Throw(CAException(kAudioHardwareUnspecifiedError));
+    }
+
+    DebugMsg("BGM_RTEventLog::StartRecording: Recording to %s", inPath);
+}
+
+void    BGM_RTEventLog::StopRecording()
+{
+    std::lock_guard<std::mutex> theLock(mLoggingThreadMutex);
+
+    if(mFile != nullptr)
+    {
+        DrainChannels();
+
+        fclose(mFile);
+        mFile = nullptr;
+    }
+}
+
+bool    BGM_RTEventLog::IsRecording() const
+{
+    std::lock_guard<std::mutex> theLock(mLoggingThreadMutex);
+    return mFile != nullptr;
+}
+
+UInt64  BGM_RTEventLog::GetDroppedEventCount() const
+{
+    UInt64 theDroppedEvents = 0;
+
+    for(UInt16 i = 0; i < mChannelCount; i++)
+    {
+        theDroppedEvents += mChannels[i].mDroppedEvents.load(std::memory_order_relaxed);
+    }
+
+    return theDroppedEvents;
+}
+
+UInt64  BGM_RTEventLog::GetPendingEventCount() const
+{
+    UInt64 thePendingEvents = 0;
+
+    for(UInt16 i = 0; i < mChannelCount; i++)
+    {
+        thePendingEvents += mChannels[i].mWritePosition.load(std::memory_order_acquire) -
+                            mChannels[i].mReadPosition.load(std::memory_order_acquire);
+    }
+
+    return thePendingEvents;
+}
+
+bool    BGM_RTEventLog::WaitUntilDrained(UInt32 inTimeoutMS) const
+{
+    std::vector<UInt64> theWritePositions(mChannelCount);
+
+    for(UInt16 i = 0; i < mChannelCount; i++)
+    {
+        theWritePositions[i] = mChannels[i].mWritePosition.load(std::memory_order_acquire);
+    }
+
+    auto theDeadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(inTimeoutMS);
+
+    for(UInt16 i = 0; i < mChannelCount; i++)
+    {
+        // Poll, since nothing signals when the logging thread drains the channels.
+        while(mChannels[i].mReadPosition.load(std::memory_order_acquire) < theWritePositions[i])
+        {
+            if(std::chrono::steady_clock::now() >= theDeadline)
+            {
+                return false;
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    return true;
+}
+
+// static
+std::string BGM_RTEventLog::FormatEvent(const BGM_RTEventType& inType, const BGM_RTEvent& inEvent)
+{
+    std::string theMessage = inType.mMessage;
+
+    if(inType.mDetailName != nullptr)
+    {
+        // mDetail should always be terminated, but don't trust it in events read from a file.
+        theMessage += std::string(" ") + inType.mDetailName + "=" +
+                      std::string(inEvent.mDetail, strnlen(inEvent.mDetail, kBGMRTEventDetailBytes));
+    }
+
+    for(UInt32 i = 0; i < kBGMRTEventMaxArgs; i++)
+    {
+        if(inType.mArgFormats[i] == kBGMRTEventArgUnused)
+        {
+            continue;
+        }
+
+        char theValue[64];
+
+        switch(inType.mArgFormats[i])
+        {
+            case kBGMRTEventArgFloat:
+                snprintf(theValue, sizeof(theValue), "%f", inEvent.mArgs[i].GetFloat());
+                break;
+
+            case kBGMRTEventArgOSStatus:
+                {
+                    SInt32 theStatus = static_cast<SInt32>(inEvent.mArgs[i].GetInteger());
+                    char the4CC[5] = {
+                        static_cast<char>((theStatus >> 24) & 0xFF),
+                        static_cast<char>((theStatus >> 16) & 0xFF),
+                        static_cast<char>((theStatus >> 8) & 0xFF),
+                        static_cast<char>(theStatus & 0xFF),
+                        '\0'
+                    };
+
+                    bool theIsPrintable = true;
+
+                    for(UInt32 j = 0; j < 4; j++)
+                    {
+                        theIsPrintable &= (the4CC[j] >= 0x20 && the4CC[j] < 0x7F);
+                    }
+
+                    snprintf(theValue,
+                             sizeof(theValue),
+                             "%d (%s)",
+                             static_cast<int>(theStatus),
+                             theIsPrintable ? the4CC : "unknown");
+                }
+                break;
+
+            default:
+                snprintf(theValue,
+                         sizeof(theValue),
+                         "%lld",
+                         static_cast<long long>(inEvent.mArgs[i].GetInteger()));
+                break;
+        }
+
+        theMessage += std::string(" ") + (inType.mArgNames[i] ? inType.mArgNames[i] : "arg") + "=" + theValue;
+    }
+
+    return theMessage;
+}
+
+void    BGM_RTEventLog::LoggingThreadProc()
+{
+    while(!mStopLoggingThread)
+    {
+        WaitForEvents();
+
+        std::lock_guard<std::mutex> theLock(mLoggingThreadMutex);
+        DrainChannels();
+    }
+
+    // Print the counts of any messages that are still being suppressed.
+    std::lock_guard<std::mutex> theLock(mLoggingThreadMutex);
+    ReportSuppressedMessages(mach_absolute_time(), true);
+}
+
+void    BGM_RTEventLog::WaitForEvents()
+{
+    bool theHasSuppressedMessages;
+
+    {
+        std::lock_guard<std::mutex> theLock(mLoggingThreadMutex);
+        theHasSuppressedMessages = HasSuppressedMessages();
+    }
+
+    kern_return_t theError;
+
+    if(theHasSuppressedMessages)
+    {
+        mach_timespec_t theTimeout = { kSuppressedMessagesReportPeriodMS / 1000,
+                                       (kSuppressedMessagesReportPeriodMS % 1000) * 1000000 };
+        theError = semaphore_timedwait(mLoggingThreadSemaphore, theTimeout);
+    }
+    else
+    {
+        theError = semaphore_wait(mLoggingThreadSemaphore);
+    }
+
+    if(theError != KERN_OPERATION_TIMED_OUT)
+    {
+        BGM_Utils::LogIfMachError("BGM_RTEventLog::WaitForEvents", "semaphore_wait", theError);
+    }
+}
+
+bool    BGM_RTEventLog::HasSuppressedMessages() const
+{
+    for(const BGM_RTEventTypeRateLimit& theRateLimit : mRateLimits)
+    {
+        if(theRateLimit.mSuppressedMessages > 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void    BGM_RTEventLog::DrainChannels()
+{
+    // The caller holds mLoggingThreadMutex, so this is only ever running on one thread.
+    mDrainedEvents.clear();
+
+    const UInt64 theNow = mach_absolute_time();
+    std::vector<UInt64> theEndPositions(mChannelCount);
+
+    for(UInt16 i = 0; i < mChannelCount; i++)
+    {
+        BGM_RTEventChannel& theChannel = mChannels[i];
+
+        const UInt64 theReadPosition = theChannel.mReadPosition.load(std::memory_order_relaxed);
+        theEndPositions[i] = theChannel.mWritePosition.load(std::memory_order_acquire);
+
+        for(UInt64 thePosition = theReadPosition; thePosition < theEndPositions[i]; thePosition++)
+        {
+            mDrainedEvents.push_back(theChannel.mEvents[thePosition & (mEventsPerChannel - 1)]);
+        }
+
+        // Report dropped events after the events that were logged before them.
+        UInt64 theDroppedEvents = theChannel.mDroppedEvents.load(std::memory_order_relaxed);
+
+        if(theDroppedEvents > theChannel.mReportedDroppedEvents)
+        {
+            BGM_RTEvent theEvent = {};
+            theEvent.mHostTime = theNow;
+            theEvent.mType = kBGMRTEventTypeDropped;
+            theEvent.mChannel = i;
+            theEvent.mArgs[0] = theDroppedEvents - theChannel.mReportedDroppedEvents;
+            theEvent.mArgs[1] = i;
+            mDrainedEvents.push_back(theEvent);
+
+            theChannel.mReportedDroppedEvents = theDroppedEvents;
+        }
+    }
+
+    // Interleave the channels' events in the order they were logged.
+    std::stable_sort(mDrainedEvents.begin(),
+                     mDrainedEvents.end(),
+                     [] (const BGM_RTEvent& inA, const BGM_RTEvent& inB) {
+                         return inA.mHostTime < inB.mHostTime;
+                     });
+
+    for(const BGM_RTEvent& theEvent : mDrainedEvents)
+    {
+        HandleEvent(theEvent);
+    }
+
+    if(mFile != nullptr && !mDrainedEvents.empty())
+    {
+        fflush(mFile);
+    }
+
+    // Only free the events now, so WaitUntilDrained doesn't return before they've been handled.
+    bool theMoreEventsLogged = false;
+
+    for(UInt16 i = 0; i < mChannelCount; i++)
+    {
+        mChannels[i].mReadPosition.store(theEndPositions[i], std::memory_order_seq_cst);
+
+        // LogDetailRT doesn't wake the logging thread for events logged while the channel wasn't
+        // empty, so check for them after freeing the channel.
+        theMoreEventsLogged |=
+                (mChannels[i].mWritePosition.load(std::memory_order_seq_cst) != theEndPositions[i]);
+    }
+
+    ReportSuppressedMessages(theNow, false);
+
+    if(theMoreEventsLogged)
+    {
+        semaphore_signal(mLoggingThreadSemaphore);
+    }
+}
+
+void    BGM_RTEventLog::HandleEvent(const BGM_RTEvent& inEvent)
+{
+    if(mFile != nullptr)
+    {
+        fwrite(&inEvent, sizeof(inEvent), 1, mFile);
+    }
+
+    const BGM_RTEventType& theType = GetType(inEvent.mType);
+    BGM_RTEventTypeRateLimit& theRateLimit =
+            mRateLimits[std::min(static_cast<UInt32>(inEvent.mType), static_cast<UInt32>(mTypeCount))];
+
+    if(inEvent.mHostTime - theRateLimit.mWindowStart >= mHostTicksPerSecond)
+    {
+        // Start a new window, after reporting the messages suppressed in the last one.
+        ReportSuppressedMessages(inEvent.mHostTime, false);
+        theRateLimit.mWindowStart = inEvent.mHostTime;
+        theRateLimit.mMessagesInWindow = 0;
+    }
+
+    if(theRateLimit.mMessagesInWindow < kMaxMessagesPerSecond)
+    {
+        theRateLimit.mMessagesInWindow++;
+        PrintMessage(theType.mSeverity, FormatEvent(theType, inEvent).c_str());
+    }
+    else
+    {
+        theRateLimit.mSuppressedMessages++;
+    }
+}
+
+void    BGM_RTEventLog::ReportSuppressedMessages(UInt64 inNow, bool inReportAll)
+{
+    for(UInt32 i = 0; i < mRateLimits.size(); i++)
+    {
+        BGM_RTEventTypeRateLimit& theRateLimit = mRateLimits[i];
+
+        if(theRateLimit.mSuppressedMessages > 0 &&
+           (inReportAll || inNow - theRateLimit.mWindowStart >= mHostTicksPerSecond))
+        {
+            const BGM_RTEventType& theType = GetType(static_cast<UInt16>(i < mTypeCount ? i : kBGMRTEventTypeDropped));
+
+            char theMessage[512];
+            snprintf(theMessage,
+                     sizeof(theMessage),
+                     "BGM_RTEventLog: Suppressed %u \"%s\" messages",
+                     theRateLimit.mSuppressedMessages,
+                     theType.mMessage);
+
+            // Never report them as an error, since that would crash debug builds.
+            PrintMessage(std::min(theType.mSeverity, kBGMRTEventSeverityWarning), theMessage);
+
+            theRateLimit.mSuppressedMessages = 0;
+        }
+    }
+}
+
+void    BGM_RTEventLog::PrintMessage(BGMRTEventSeverity inSeverity, const char* inMessage)
+{
+    if(mMessageHandler)
+    {
+        mMessageHandler(inSeverity, inMessage);
+        return;
+    }
+
+    switch(inSeverity)
+    {
+        case kBGMRTEventSeverityDebug:
+            DebugMsg("%s", inMessage);
+            break;
+
+        case kBGMRTEventSeverityWarning:
+            LogWarning("%s", inMessage);
+            break;
+
+        default:
+            LogError("%s", inMessage);
+            break;
+    }
+}
+
+bool    BGM_RTEventLog::WriteFileHeader()
+{
+    mach_timebase_info_data_t theTimebase;
+    mach_timebase_info(&theTimebase);
+
+    BGM_RTEventFileHeader theHeader = {};
+    theHeader.mMagic = kBGMRTEventFileMagic;
+    theHeader.mVersion = kBGMRTEventFileVersion;
+    theHeader.mTimebaseNumerator = theTimebase.numer;
+    theHeader.mTimebaseDenominator = theTimebase.denom;
+    theHeader.mTypeCount = mTypeCount;
+    theHeader.mChannelCount = mChannelCount;
+    theHeader.mEventBytes = sizeof(BGM_RTEvent);
+
+    bool theSucceeded = fwrite(&theHeader, sizeof(theHeader), 1, mFile) == 1;
+
+    auto writeString = [&] (const char* _Nullable inString) {
+        const char* theString = (inString != nullptr) ? inString : "";
+        theSucceeded &= fwrite(theString, strlen(theString) + 1, 1, mFile) == 1;
+    };
+
+    for(UInt16 i = 0; i < mTypeCount; i++)
+    {
+        const BGM_RTEventType& theType = mTypes[i];
+
+        UInt8 theFormats[1 + kBGMRTEventMaxArgs] = { theType.mSeverity };
+        std::copy(theType.mArgFormats, theType.mArgFormats + kBGMRTEventMaxArgs, theFormats + 1);
+        theSucceeded &= fwrite(theFormats, sizeof(theFormats), 1, mFile) == 1;
+
+        writeString(theType.mMessage);
+        writeString(theType.mDetailName);
+
+        for(UInt32 j = 0; j < kBGMRTEventMaxArgs; j++)
+        {
+            writeString(theType.mArgNames[j]);
+        }
+    }
+
+    return theSucceeded && fflush(mFile) == 0;
+}
+
+const BGM_RTEventType& BGM_RTEventLog::GetType(UInt16 inType) const
+{
+    return (inType < mTypeCount) ? mTypes[inType] : kDroppedEventType;
+}
+
+#pragma mark Reader
+
+BGM_RTEventReader::BGM_RTEventReader(const char* inPath)
+:
+    mFile(fopen(inPath, "rb")),
+    mFileHeader(),
+    mTypes(),
+    mStrings()
+{
+    ThrowIfNULL(mFile,
+                CAException(kAudioHardwareIllegalOperationError),
+                "BGM_RTEventReader::BGM_RTEventReader: Couldn't open the file");
+
+    try
+    {
+        ThrowIf(fread(&mFileHeader, sizeof(mFileHeader), 1, mFile) != 1 ||
+                    mFileHeader.mMagic != kBGMRTEventFileMagic,
+                CAException(kAudioHardwareIllegalOperationError),
+                "BGM_RTEventReader::BGM_RTEventReader: Not an RT event recording");
+        ThrowIf(mFileHeader.mVersion != kBGMRTEventFileVersion ||
+                    mFileHeader.mEventBytes != sizeof(BGM_RTEvent) ||
+                    mFileHeader.mTimebaseNumerator == 0 ||
+                    mFileHeader.mTimebaseDenominator == 0,
+                CAException(kAudioHardwareIllegalOperationError),
+                "BGM_RTEventReader::BGM_RTEventReader: Unsupported recording");
+
+        for(UInt16 i = 0; i < mFileHeader.mTypeCount; i++)
+        {
+            UInt8 theFormats[1 + kBGMRTEventMaxArgs];
+
+            ThrowIf(fread(theFormats, sizeof(theFormats), 1, mFile) != 1,
+                    CAException(kAudioHardwareIllegalOperationError),
+                    "BGM_RTEventReader::BGM_RTEventReader: Truncated event types");
+
+            BGM_RTEventType theType = {};
+            theType.mSeverity = static_cast<BGMRTEventSeverity>(theFormats[0]);
+
+            auto readString = [&] (bool inNullIfEmpty) -> const char* _Nullable {
+                mStrings.emplace_back(new std::string(ReadString()));
+                return (inNullIfEmpty && mStrings.back()->empty()) ? nullptr : mStrings.back()->c_str();
+            };
+
+            theType.mMessage = readString(false);
+            theType.mDetailName = readString(true);
+
+            for(UInt32 j = 0; j < kBGMRTEventMaxArgs; j++)
+            {
+                theType.mArgNames[j] = readString(true);
+                theType.mArgFormats[j] = static_cast<BGMRTEventArgFormat>(theFormats[1 + j]);
+            }
+
+            mTypes.push_back(theType);
+        }
+    }
+    catch(...)
+    {
+        fclose(mFile);
+        throw;
+    }
+}
+
+BGM_RTEventReader::~BGM_RTEventReader()
+{
+    fclose(mFile);
+}
+
+bool    BGM_RTEventReader::ReadEvent(BGM_RTEvent& outEvent)
+{
+    size_t theBytesRead = fread(&outEvent, 1, sizeof(outEvent), mFile);
+
+    if(theBytesRead == 0 && feof(mFile))
+    {
+        return false;
+    }
+
+    ThrowIf(theBytesRead != sizeof(outEvent),
+            CAException(kAudioHardwareIllegalOperationError),
+            "BGM_RTEventReader::ReadEvent: Truncated event");
+
+    return true;
+}
+
+std::string BGM_RTEventReader::ReadString()
+{
+    std::string theString;
+    int theCharacter;
+
+    while((theCharacter = fgetc(mFile)) != '\0')
+    {
+        ThrowIf(theCharacter == EOF,
+                CAException(kAudioHardwareIllegalOperationError),
+                "BGM_RTEventReader::ReadString: Truncated event types");
+        theString += static_cast<char>(theCharacter);
+    }
+
+    return theString;
+}
+
+#pragma clang assume_nonnull end
+
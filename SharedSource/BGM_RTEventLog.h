@@ -0,0 +1,353 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_RTEventLog.h
+//  SharedSource
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  An allocation-free log for real-time threads. Used by BGMDriver's IO operations and, through
+//  BGMPlayThroughRTLogger, BGMApp's IOProcs.
+//
+//  Events are fixed-size and typed. Each has a host time, a sequence number and up to four numeric
+//  arguments (plus a short string), and its type says how to print them. The owner gives the log
+//  an array of BGM_RTEventTypes and logs events by their index in it.
+//
+//  The log has a number of channels, each of which is a single-producer, single-consumer ring of
+//  events, and each thread that logs events should have its own channel. A non-realtime thread
+//  drains the channels, prints the events (at most kMaxMessagesPerSecond of
+//  each type, counting the rest) and, if the log is recording, writes them to a file that
+//  bgm-rt-event-decode can print. If a channel is full, events are dropped and counted, and their
+//  sequence numbers are skipped, so the recording shows exactly where events were lost.
+//
+//  The logging thread sleeps on a Mach semaphore, which is real-time safe to signal, and is only
+//  woken when an event is logged to an empty channel. So the log doesn't use any CPU while
+//  nothing's being logged.
+//
+//  If two threads log to the same channel at the same time, one of the events is dropped rather
+//  than making either thread wait.
+//
+
+#ifndef SharedSource__BGM_RTEventLog
+#define SharedSource__BGM_RTEventLog
+
+// STL Includes
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// System Includes
+#include <MacTypes.h>
+#include <mach/semaphore.h>
+#include <stdio.h>
+#include <string.h>
+
+
+#pragma clang assume_nonnull begin
+
+#pragma mark Events
+
+#define kBGMRTEventMaxArgs          4
+#define kBGMRTEventDetailBytes      32
+
+enum BGMRTEventSeverity : UInt8
+{
+    // Printed with DebugMsg, so only in debug builds or, in BGMApp, with debug logging enabled.
+    kBGMRTEventSeverityDebug,
+    kBGMRTEventSeverityWarning,
+    kBGMRTEventSeverityError
+};
+
+enum BGMRTEventArgFormat : UInt8
+{
+    kBGMRTEventArgUnused = 0,
+    kBGMRTEventArgInteger,
+    kBGMRTEventArgFloat,
+    // An OSStatus, printed as a number and a four-char code.
+    kBGMRTEventArgOSStatus
+};
+
+// A type of event: its message and how to print its arguments. Events are printed as the message
+// followed by name=value for the detail string and each argument that's used.
+struct BGM_RTEventType
+{
+    const char*                 mMessage;
+    BGMRTEventSeverity          mSeverity;
+    // The name of the event's detail string, or null if it doesn't have one.
+    const char* _Nullable       mDetailName;
+    const char* _Nullable       mArgNames[kBGMRTEventMaxArgs];
+    BGMRTEventArgFormat         mArgFormats[kBGMRTEventMaxArgs];
+};
+
+// One of an event's arguments. Integers (and enums and bools) are stored as SInt64s and floating
+// point values as Float64s.
+struct BGM_RTEventArg
+{
+                                BGM_RTEventArg() : mBits(0) { }
+
+    template <typename T,
+              typename std::enable_if<std::is_integral<T>::value ||
+                                      std::is_enum<T>::value, int>::type = 0>
+                                BGM_RTEventArg(T inValue)
+                                :
+                                    mBits(static_cast<UInt64>(static_cast<SInt64>(inValue)))
+                                {
+                                }
+
+    template <typename T,
+              typename std::enable_if<std::is_floating_point<T>::value, int>::type = 0>
+                                BGM_RTEventArg(T inValue)
+                                {
+                                    Float64 theValue = inValue;
+                                    memcpy(&mBits, &theValue, sizeof(mBits));
+                                }
+
+    SInt64                      GetInteger() const { return static_cast<SInt64>(mBits); }
+    Float64                     GetFloat() const
+                                {
+                                    Float64 theValue;
+                                    memcpy(&theValue, &mBits, sizeof(theValue));
+                                    return theValue;
+                                }
+
+    UInt64                      mBits;
+};
+
+// The type of the events the log adds when it finds a channel dropped events. Its first argument
+// is the number of events dropped.
+#define kBGMRTEventTypeDropped      0xFFFF
+
+struct BGM_RTEvent
+{
+    // From mach_absolute_time.
+    UInt64                      mHostTime;
+    // Counts the events logged to the channel, including dropped ones.
+    UInt64                      mSequenceNumber;
+    UInt16                      mType;
+    UInt16                      mChannel;
+    UInt32                      mReserved;
+    BGM_RTEventArg              mArgs[kBGMRTEventMaxArgs];
+    // Null-terminated. Truncated if it doesn't fit.
+    char                        mDetail[kBGMRTEventDetailBytes];
+};
+
+#pragma mark File Format
+
+// A recording is a BGM_RTEventFileHeader, then the event types, each of which is the type's
+// severity and argument formats as UInt8s followed by its message, detail name and argument names
+// as null-terminated strings (empty if unused), then the events in the order they were drained.
+// Events from different channels are only roughly in host time order. All values are in the
+// recording machine's byte order.
+
+#define kBGMRTEventFileMagic        'BGME'
+#define kBGMRTEventFileVersion      1
+
+struct BGM_RTEventFileHeader
+{
+    UInt32                      mMagic;
+    UInt32                      mVersion;
+    // The mach_timebase_info of the recording machine, to convert the events' host times.
+    UInt32                      mTimebaseNumerator;
+    UInt32                      mTimebaseDenominator;
+    UInt16                      mTypeCount;
+    UInt16                      mChannelCount;
+    UInt32                      mEventBytes;
+};
+
+#pragma mark Log
+
+class BGM_RTEventLog
+{
+
+public:
+    // Called on the logging thread to print a message instead of DebugMsg, LogWarning or LogError.
+    typedef std::function<void(BGMRTEventSeverity inSeverity, const char* inMessage)> MessageHandler;
+
+    static const UInt32         kDefaultEventsPerChannel = 1024;
+    // The most messages of each type printed per second. (Events are always recorded.)
+    static const UInt32         kMaxMessagesPerSecond = 20;
+
+    /*!
+     Not real-time safe. Starts the logging thread.
+
+     @throws CAException If the logging thread's semaphore couldn't be created.
+     @param inTypes The log's event types. Must stay valid for the life of the log.
+     @param inEventsPerChannel The size of each channel's ring. Rounded up to a power of two.
+     @param inMessageHandler Optional.
+     */
+                                BGM_RTEventLog(const BGM_RTEventType* inTypes,
+                                               UInt16 inTypeCount,
+                                               UInt16 inChannelCount,
+                                               UInt32 inEventsPerChannel = kDefaultEventsPerChannel,
+                                               MessageHandler _Nullable inMessageHandler = nullptr);
+                                ~BGM_RTEventLog();
+                                BGM_RTEventLog(const BGM_RTEventLog&) = delete;
+                                BGM_RTEventLog& operator=(const BGM_RTEventLog&) = delete;
+
+    /*!
+     Log an event. Real-time safe. Does nothing if inChannel or inType is out of range.
+     */
+    void                        LogRT(UInt16 inChannel,
+                                      UInt16 inType,
+                                      BGM_RTEventArg inArg0 = BGM_RTEventArg(),
+                                      BGM_RTEventArg inArg1 = BGM_RTEventArg(),
+                                      BGM_RTEventArg inArg2 = BGM_RTEventArg(),
+                                      BGM_RTEventArg inArg3 = BGM_RTEventArg())
+                                {
+                                    LogDetailRT(inChannel, inType, nullptr, inArg0, inArg1, inArg2, inArg3);
+                                }
+    /*!
+     Log an event with a detail string, e.g. the name of the function logging it. The string is
+     copied, so it doesn't have to outlive the call.
+     */
+    void                        LogDetailRT(UInt16 inChannel,
+                                            UInt16 inType,
+                                            const char* _Nullable inDetail,
+                                            BGM_RTEventArg inArg0 = BGM_RTEventArg(),
+                                            BGM_RTEventArg inArg1 = BGM_RTEventArg(),
+                                            BGM_RTEventArg inArg2 = BGM_RTEventArg(),
+                                            BGM_RTEventArg inArg3 = BGM_RTEventArg());
+
+    /*!
+     Start writing every event logged from now on to a new file at inPath, stopping the current
+     recording first if there is one. Doesn't overwrite existing files. Not real-time safe.
+
+     @throws CAException If the file couldn't be created.
+     */
+    void                        StartRecording(const char* inPath);
+    /*! Stop recording after writing the events logged so far. Not real-time safe. */
+    void                        StopRecording();
+    bool                        IsRecording() const;
+
+    /*! The number of events dropped because their channel was full or busy. */
+    UInt64                      GetDroppedEventCount() const;
+    /*! The number of events logged but not drained yet. */
+    UInt64                      GetPendingEventCount() const;
+    /*!
+     Wait until the logging thread has drained every event logged before this was called.
+
+     @return False if it hadn't after inTimeoutMS milliseconds.
+     */
+    bool                        WaitUntilDrained(UInt32 inTimeoutMS) const;
+
+    /*! Print an event the way the log does. Not real-time safe. */
+    static std::string          FormatEvent(const BGM_RTEventType& inType, const BGM_RTEvent& inEvent);
+
+private:
+    struct BGM_RTEventChannel
+    {
+        std::unique_ptr<BGM_RTEvent[]> mEvents;
+        // Total events written and read. Only the thread logging to the channel writes
+        // mWritePosition and only the logging thread writes mReadPosition.
+        std::atomic<UInt64>     mWritePosition { 0 };
+        std::atomic<UInt64>     mReadPosition { 0 };
+        std::atomic<UInt64>     mSequenceNumber { 0 };
+        std::atomic<UInt64>     mDroppedEvents { 0 };
+        // Set while a thread is logging to the channel.
+        std::atomic_flag        mLogging = ATOMIC_FLAG_INIT;
+        // Only used by the logging thread.
+        UInt64                  mReportedDroppedEvents = 0;
+    };
+
+    struct BGM_RTEventTypeRateLimit
+    {
+        UInt64                  mWindowStart = 0;
+        UInt32                  mMessagesInWindow = 0;
+        UInt32                  mSuppressedMessages = 0;
+    };
+
+    void                        LoggingThreadProc();
+    /*! Wait until an event is logged to an empty channel or the log is destroyed. */
+    void                        WaitForEvents();
+    bool                        HasSuppressedMessages() const;
+    void                        DrainChannels();
+    void                        HandleEvent(const BGM_RTEvent& inEvent);
+    void                        ReportSuppressedMessages(UInt64 inNow, bool inReportAll);
+    void                        PrintMessage(BGMRTEventSeverity inSeverity, const char* inMessage);
+    bool                        WriteFileHeader();
+    const BGM_RTEventType&      GetType(UInt16 inType) const;
+
+private:
+    const BGM_RTEventType*      mTypes;
+    const UInt16                mTypeCount;
+    const UInt16                mChannelCount;
+    const UInt32                mEventsPerChannel;
+    std::unique_ptr<BGM_RTEventChannel[]> mChannels;
+    MessageHandler _Nullable    mMessageHandler;
+
+    // Only used by the logging thread.
+    std::vector<BGM_RTEvent>    mDrainedEvents;
+    std::vector<BGM_RTEventTypeRateLimit> mRateLimits;
+    UInt64                      mHostTicksPerSecond;
+
+    // Guards mFile.
+    mutable std::mutex          mLoggingThreadMutex;
+    // Signalled when an event is logged to an empty channel and when the log is destroyed.
+    semaphore_t                 mLoggingThreadSemaphore;
+    std::atomic<bool>           mStopLoggingThread;
+    FILE* _Nullable             mFile;
+    std::thread                 mLoggingThread;
+
+};
+
+#pragma mark Reader
+
+class BGM_RTEventReader
+{
+
+public:
+    /*!
+     Open a recording and read its header and event types.
+
+     @throws CAException If the file couldn't be opened or isn't a recording.
+     */
+                                BGM_RTEventReader(const char* inPath);
+                                ~BGM_RTEventReader();
+                                BGM_RTEventReader(const BGM_RTEventReader&) = delete;
+                                BGM_RTEventReader& operator=(const BGM_RTEventReader&) = delete;
+
+    const BGM_RTEventFileHeader& GetFileHeader() const { return mFileHeader; }
+    const std::vector<BGM_RTEventType>& GetTypes() const { return mTypes; }
+
+    /*!
+     Read the next event.
+
+     @return False at the end of the file.
+     @throws CAException If the file is truncated.
+     */
+    bool                        ReadEvent(BGM_RTEvent& outEvent);
+
+private:
+    std::string                 ReadString();
+
+private:
+    FILE*                       mFile;
+    BGM_RTEventFileHeader       mFileHeader;
+    std::vector<BGM_RTEventType> mTypes;
+    // The storage for the strings in mTypes.
+    std::vector<std::unique_ptr<std::string>> mStrings;
+
+};
+
+#pragma clang assume_nonnull end
+
+#endif /* SharedSource__BGM_RTEventLog */
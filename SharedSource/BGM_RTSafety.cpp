@@ -0,0 +1,353 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_RTSafety.cpp
+//  SharedSource
+//
+//  Copyright © 2026 Background Music contributors
+//
+
+// Self Include
+#include "BGM_RTSafety.h"
+
+#if BGM_RTSafetyChecks
+
+// STL Includes
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// System Includes
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <stdlib.h>
+
+
+#pragma clang assume_nonnull begin
+
+static const int kMaxStackFrames = 48;
+// ReportViolation and the interposer that called it.
+static const int kSkippedStackFrames = 2;
+static const UInt32 kMaxStacks = 1024;
+static const UInt32 kMaxSuppressions = 64;
+// Suppressions are matched against this many frames, so they can name the function that called
+// the interposed function or the one that called a wrapper like CAMutex::Lock.
+static const int kSuppressionFrames = 2;
+// Set in the stacks table for stacks that matched a suppression. Stack hashes always have the
+// lowest bit cleared.
+static const UInt64 kStackSuppressedFlag = 1;
+
+struct BGM_RTSafetyThreadState
+{
+    UInt32                      mScopeDepth;
+    UInt32                      mExemptionDepth;
+    const char* _Nullable       mScopeName;
+    bool                        mReporting;
+};
+
+// Constant-initialised, so the interposers can use it without anything being allocated, even on
+// a new thread.
+static thread_local BGM_RTSafetyThreadState sThreadState = { 0, 0, nullptr, false };
+
+static std::atomic<UInt64> sViolations[kBGMRTSafetyViolationTypeCount];
+static std::atomic<UInt64> sSuppressed;
+static std::atomic<UInt64> sDistinct;
+// An open-addressed set of the stack traces seen so far, by hash. Zero means an empty slot.
+static std::atomic<UInt64> sStacks[kMaxStacks];
+
+static const char* sSuppressions[kMaxSuppressions];
+static UInt32 sSuppressionCount = 0;
+static std::atomic<bool> sPrintSuppressed { false };
+
+static const char* const kViolationTypeNames[kBGMRTSafetyViolationTypeCount] = {
+    "allocation",
+    "lock",
+    "system call"
+};
+
+#pragma mark Scopes
+
+BGM_RTSafety::Scope::Scope(const char* inName)
+:
+    mOuterName(sThreadState.mScopeName)
+{
+    sThreadState.mScopeDepth++;
+    sThreadState.mScopeName = inName;
+}
+
+BGM_RTSafety::Scope::~Scope()
+{
+    sThreadState.mScopeDepth--;
+    sThreadState.mScopeName = mOuterName;
+}
+
+BGM_RTSafety::Exemption::Exemption()
+{
+    sThreadState.mExemptionDepth++;
+}
+
+BGM_RTSafety::Exemption::~Exemption()
+{
+    sThreadState.mExemptionDepth--;
+}
+
+// static
+bool    BGM_RTSafety::IsCheckedRT()
+{
+    return sThreadState.mScopeDepth > 0 &&
+           sThreadState.mExemptionDepth == 0 &&
+           !sThreadState.mReporting;
+}
+
+#pragma mark Violations
+
+// FNV-1a over the return addresses.
+static UInt64 HashStack(void* const* inFrames, int inFrameCount)
+{
+    UInt64 theHash = 14695981039346656037ULL;
+    
+    for(int i = 0; i < inFrameCount; i++)
+    {
+        theHash ^= static_cast<UInt64>(reinterpret_cast<uintptr_t>(inFrames[i]));
+        theHash *= 1099511628211ULL;
+    }
+    
+    // Never zero, so it can't be mistaken for an empty slot.
+    return (theHash & ~kStackSuppressedFlag) | 2;
+}
+
+// Returns the stack's entry in sStacks, or zero if it hasn't been seen yet.
+static UInt64 FindStack(UInt64 inHash)
+{
+    for(UInt32 i = 0; i < kMaxStacks; i++)
+    {
+        UInt64 theEntry = sStacks[(inHash + i) % kMaxStacks].load(std::memory_order_acquire);
+        
+        if(theEntry == 0 || (theEntry & ~kStackSuppressedFlag) == inHash)
+        {
+            return theEntry;
+        }
+    }
+    
+    return 0;
+}
+
+// If the set is full, the stack just isn't added, so it'll be symbolicated again next time.
+static void AddStack(UInt64 inHash, bool inSuppressed)
+{
+    const UInt64 theEntry = inHash | (inSuppressed ? kStackSuppressedFlag : 0);
+    
+    for(UInt32 i = 0; i < kMaxStacks; i++)
+    {
+        UInt64 theExpected = 0;
+        std::atomic<UInt64>& theSlot = sStacks[(inHash + i) % kMaxStacks];
+        
+        if(theSlot.compare_exchange_strong(theExpected, theEntry) ||
+           (theExpected & ~kStackSuppressedFlag) == inHash)
+        {
+            return;
+        }
+    }
+}
+
+// The frame's function name, demangled if it's C++, or an empty string if it isn't exported.
+// Functions in the executable are only exported if it's linked with -rdynamic.
+static std::string GetFunctionName(void* inFrame, std::string& outImage, uintptr_t& outOffset)
+{
+    Dl_info theInfo;
+    
+    if(dladdr(inFrame, &theInfo) == 0)
+    {
+        outImage.clear();
+        outOffset = 0;
+        return std::string();
+    }
+    
+    const char* theImage = (theInfo.dli_fname == nullptr) ? nullptr : std::strrchr(theInfo.dli_fname, '/');
+    outImage = (theImage != nullptr) ? (theImage + 1) : (theInfo.dli_fname != nullptr ? theInfo.dli_fname : "");
+    
+    if(theInfo.dli_sname == nullptr)
+    {
+        outOffset = reinterpret_cast<uintptr_t>(inFrame) - reinterpret_cast<uintptr_t>(theInfo.dli_fbase);
+        return std::string();
+    }
+    
+    outOffset = reinterpret_cast<uintptr_t>(inFrame) - reinterpret_cast<uintptr_t>(theInfo.dli_saddr);
+    
+    int theStatus = 0;
+    char* theDemangledName = abi::__cxa_demangle(theInfo.dli_sname, nullptr, nullptr, &theStatus);
+    std::string theName = (theStatus == 0 && theDemangledName != nullptr) ? theDemangledName : theInfo.dli_sname;
+    free(theDemangledName);
+    
+    return theName;
+}
+
+// Counts a violation and prints its stack trace if it's new. Called by ReportViolation with the
+// checks off for the thread.
+static void RecordViolation(BGMRTSafetyViolation inType,
+                            const char* inFunction,
+                            void* const* inFrames,
+                            int inFrameCount)
+{
+    sViolations[inType]++;
+    
+    const UInt64 theHash = HashStack(inFrames, inFrameCount);
+    const UInt64 theEntry = FindStack(theHash);
+    
+    if(theEntry != 0)
+    {
+        // Seen before, so it's already been printed if it's going to be.
+        if(theEntry & kStackSuppressedFlag)
+        {
+            sSuppressed++;
+        }
+        
+        return;
+    }
+    
+    // Symbolicate the stack and check it against the suppressions.
+    std::vector<std::string> theLines;
+    bool isSuppressed = false;
+    
+    for(int i = 0; i < inFrameCount; i++)
+    {
+        std::string theImage;
+        uintptr_t theOffset = 0;
+        std::string theName = GetFunctionName(inFrames[i], theImage, theOffset);
+        
+        for(UInt32 j = 0; j < sSuppressionCount && i < kSuppressionFrames && !theName.empty(); j++)
+        {
+            isSuppressed = isSuppressed || (theName.find(sSuppressions[j]) != std::string::npos);
+        }
+        
+        char theLine[1024];
+        std::snprintf(theLine,
+                      sizeof(theLine),
+                      "    #%-2d %p %s + 0x%lx (%s)\n",
+                      i,
+                      inFrames[i],
+                      theName.empty() ? "???" : theName.c_str(),
+                      static_cast<unsigned long>(theOffset),
+                      theImage.c_str());
+        theLines.push_back(theLine);
+    }
+    
+    AddStack(theHash, isSuppressed);
+    sDistinct++;
+    
+    if(isSuppressed)
+    {
+        sSuppressed++;
+    }
+    
+    if(!isSuppressed || sPrintSuppressed)
+    {
+        std::string theReport = std::string("RT-safety violation") + (isSuppressed ? " (known)" : "") +
+                                ": " + kViolationTypeNames[inType] + ", " + inFunction +
+                                ", in real-time scope \"" +
+                                (sThreadState.mScopeName ? sThreadState.mScopeName : "") + "\"\n";
+        
+        for(const std::string& theLine : theLines)
+        {
+            theReport += theLine;
+        }
+        
+        std::fputs(theReport.c_str(), stderr);
+    }
+}
+
+// static
+void    BGM_RTSafety::ReportViolation(BGMRTSafetyViolation inType, const char* inFunction)
+{
+    if(sThreadState.mReporting || inType >= kBGMRTSafetyViolationTypeCount)
+    {
+        return;
+    }
+    
+    // Turn the checks off for this thread while we allocate, print, etc.
+    sThreadState.mReporting = true;
+    
+    void* theFrames[kMaxStackFrames];
+    int theFrameCount = backtrace(theFrames, kMaxStackFrames);
+    int theFirstFrame = std::min(kSkippedStackFrames, theFrameCount);
+    
+    RecordViolation(inType, inFunction, theFrames + theFirstFrame, theFrameCount - theFirstFrame);
+    
+    sThreadState.mReporting = false;
+}
+
+// static
+void    BGM_RTSafety::AddSuppression(const char* inSymbol)
+{
+    if(sSuppressionCount < kMaxSuppressions)
+    {
+        sSuppressions[sSuppressionCount++] = inSymbol;
+    }
+}
+
+// static
+void    BGM_RTSafety::SetPrintSuppressed(bool inPrintSuppressed)
+{
+    sPrintSuppressed = inPrintSuppressed;
+}
+
+// static
+BGM_RTSafety::Counts    BGM_RTSafety::GetCounts()
+{
+    Counts theCounts;
+    
+    for(UInt32 i = 0; i < kBGMRTSafetyViolationTypeCount; i++)
+    {
+        theCounts.mViolations[i] = sViolations[i];
+    }
+    
+    theCounts.mSuppressed = sSuppressed;
+    theCounts.mDistinct = sDistinct;
+    
+    return theCounts;
+}
+
+// static
+void    BGM_RTSafety::ResetCounts()
+{
+    for(UInt32 i = 0; i < kBGMRTSafetyViolationTypeCount; i++)
+    {
+        sViolations[i] = 0;
+    }
+    
+    sSuppressed = 0;
+    sDistinct = 0;
+    
+    for(UInt32 i = 0; i < kMaxStacks; i++)
+    {
+        sStacks[i] = 0;
+    }
+}
+
+// static
+const char*     BGM_RTSafety::GetViolationTypeName(BGMRTSafetyViolation inType)
+{
+    return (inType < kBGMRTSafetyViolationTypeCount) ? kViolationTypeNames[inType] : "unknown";
+}
+
+#pragma clang assume_nonnull end
+
+#endif /* BGM_RTSafetyChecks */
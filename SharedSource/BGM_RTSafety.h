@@ -0,0 +1,146 @@
+// This file is part of Background Music.
+//
+// Background Music is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation, either version 2 of the
+// License, or (at your option) any later version.
+//
+// Background Music is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Background Music. If not, see <http://www.gnu.org/licenses/>.
+
+//
+//
+//  BGM_RTSafety.h
+//  SharedSource
+//
+//  Copyright © 2026 Background Music contributors
+//
+//  Marks the code that runs on real-time threads so a test build can check it really is real-time
+//  safe. The "RT" suffix only documents that a function should be safe. In bgm-rt-safety-check,
+//  the interposers in BGMDriver/Portable/BGM_RTSafetyInterposers.cpp intercept memory allocation,
+//  mutex locks and blocking system calls, and report any made in a real-time scope with a stack
+//  trace.
+//
+//  BGMRTScope(name) marks the rest of the enclosing block as real-time. Scopes nest, so functions
+//  only called from one don't need their own. BGMRTSafetyExempt(reason) exempts the rest of the
+//  block, for code that's only unsafe in the portable build. For example, BGM_PortableMach
+//  implements semaphores with a mutex, but they're Mach traps on macOS.
+//
+//  Both macros expand to nothing unless BGM_RTSafetyChecks is defined. Only the portable CMake
+//  build defines it.
+//
+
+#ifndef SharedSource__BGM_RTSafety
+#define SharedSource__BGM_RTSafety
+
+#if BGM_RTSafetyChecks
+
+// System Includes
+#include <MacTypes.h>
+#include <stdlib.h>
+
+
+// The interposers rely on glibc, and the sanitizers replace the same functions with their own.
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__) && !defined(__SANITIZE_THREAD__)
+    #define BGM_RTSafetyInterposersAvailable 1
+#else
+    #define BGM_RTSafetyInterposersAvailable 0
+#endif
+
+
+#pragma clang assume_nonnull begin
+
+enum BGMRTSafetyViolation : UInt32
+{
+    kBGMRTSafetyViolationAllocation = 0,
+    kBGMRTSafetyViolationLock,
+    kBGMRTSafetyViolationSystemCall,
+    kBGMRTSafetyViolationTypeCount
+};
+
+class BGM_RTSafety
+{
+
+public:
+    struct Counts
+    {
+        // Every violation, including the suppressed ones.
+        UInt64                  mViolations[kBGMRTSafetyViolationTypeCount];
+        // Violations with a stack trace that matched a suppression.
+        UInt64                  mSuppressed;
+        // Violations with a stack trace that hadn't been seen before.
+        UInt64                  mDistinct;
+    };
+
+    class Scope
+    {
+    public:
+                                Scope(const char* inName);
+                                ~Scope();
+                                Scope(const Scope&) = delete;
+                                Scope& operator=(const Scope&) = delete;
+    private:
+        const char* _Nullable   mOuterName;
+    };
+
+    class Exemption
+    {
+    public:
+                                Exemption();
+                                ~Exemption();
+                                Exemption(const Exemption&) = delete;
+                                Exemption& operator=(const Exemption&) = delete;
+    };
+
+    /*!
+     True if the calling thread is in a real-time scope and not exempt. Called by the interposers,
+     so it doesn't allocate, lock or make system calls.
+     */
+    static bool                 IsCheckedRT();
+
+    /*!
+     Count a violation on the calling thread. The first time a stack trace is seen, it's printed
+     to stderr unless it matches a suppression. The checks are off for the calling thread until
+     this returns, so it's free to allocate.
+
+     @param inFunction The intercepted function, e.g. "malloc".
+     */
+    static void                 ReportViolation(BGMRTSafetyViolation inType, const char* inFunction);
+
+    /*!
+     Count violations made by inSymbol as known problems, so only new ones fail the check. Matches
+     the function that called the interposed function or its caller, e.g. the function that
+     called CAMutex::Lock. Not thread-safe. Call it before running any IO.
+
+     @param inSymbol Matched against the demangled names, e.g. "BGM_ClientMap::GetClientPtrRT".
+                     Must stay valid.
+     */
+    static void                 AddSuppression(const char* inSymbol);
+    /*! Print suppressed violations as well, the first time each is seen. */
+    static void                 SetPrintSuppressed(bool inPrintSuppressed);
+
+    static Counts               GetCounts();
+    static void                 ResetCounts();
+
+    static const char*          GetViolationTypeName(BGMRTSafetyViolation inType);
+
+};
+
+#pragma clang assume_nonnull end
+
+#define BGMRTScope(inName)                  BGM_RTSafety::Scope __rtSafetyScope(inName)
+#define BGMRTSafetyExempt(inReason)         BGM_RTSafety::Exemption __rtSafetyExemption
+
+#else
+
+#define BGMRTScope(inName)
+#define BGMRTSafetyExempt(inReason)
+
+#endif /* BGM_RTSafetyChecks */
+
+#endif /* SharedSource__BGM_RTSafety */
@@ -126,7 +126,124 @@ enum
     // Each dictionary contains: "srcPid" (source process ID), "dstPid" (destination process ID), 
     // "srcCh" (source output channel 0=L,1=R), "dstCh" (destination input channel 0=L,1=R), "enabled" (CFBoolean).
     // Setting this property adds or updates routes. Getting returns all active routes.
-    kAudioDeviceCustomPropertyAppRouting                              = 'aprt'
+    //
+    // Each route has a channel matrix, which defaults to L->L and R->R. A dictionary with "srcCh" and/or
+    // "dstCh" sets the matrix's gains from those source channels to those destination channels (all of
+    // them if a key is omitted or kBGMAppRoutingChannelAll) instead of the route's overall gain. E.g.
+    // {srcCh: 0, dstCh: 1} for left to right only, or {srcCh: -1, dstCh: -1, gain: 0.5} for a mono sum.
+    // If a route's matrix isn't the default, getting the property returns a dictionary for each entry.
+    //
+    // Routed audio is aligned by sample time the same way as the loopback audio: the audio a source app
+    // plays for output sample time T is read by the destination app for input sample time T, plus the
+    // route's optional "delay" in frames, which can be used to line it up with other paths. The route's
+    // total latency relative to the loopback audio is returned as "latency" so apps can compensate.
+    kAudioDeviceCustomPropertyAppRouting                              = 'aprt',
+    // A CFArray of CFDictionaries that each contain an app's pid and/or bundle ID and whether the app
+    // should get a "mix-minus" (N-1) loopback feed. When it's enabled for an app, BGMDevice's input
+    // stream gives the app's clients the mix of every other app, i.e. the full loopback minus the
+    // app's own output, which stops conferencing and streaming apps from hearing themselves. Apps with
+    // incoming routes (see kAudioDeviceCustomPropertyAppRouting) get only their routed audio instead.
+    //
+    // Setting this property adds, updates or (with kBGMMixMinusKey_Enabled set false) removes apps.
+    // Apps don't have to be clients of BGMDevice when they're added. Getting it returns every app
+    // with mix-minus enabled. See the dictionary keys below.
+    kAudioDeviceCustomPropertyMixMinusApps                            = 'mxmn',
+    // A CFArray of CFDictionaries that each set the capture filter for a "reader" app, i.e. an app
+    // that records from BGMDevice's input stream, such as a screen recorder. The filter decides which
+    // apps' audio the reader gets instead of the full loopback mix: either every app except the ones
+    // listed ("capture everything but Slack") or only the apps listed ("only Spotify and Safari").
+    // Readers are identified by bundle ID. Readers with incoming routes (see
+    // kAudioDeviceCustomPropertyAppRouting) get only their routed audio instead.
+    //
+    // Setting this property adds, updates or (with kBGMCaptureFilterKey_Mode set to
+    // kBGMCaptureFilterModeNone) removes readers' filters. Getting it returns every filter that's
+    // set. See the dictionary keys below.
+    kAudioDeviceCustomPropertyCaptureFilters                          = 'cpfl',
+    // A CFDictionary with the settings of BGMDevice's crossfader, which fades between two groups of
+    // apps, A and B. The crossfader's gain for each group is applied to the audio of the group's
+    // apps (after their app volumes) and ramped smoothly to its new value whenever the position
+    // changes, so the apps only need to send the position as often as their UI updates it.
+    //
+    // Setting this property only changes the settings given in the dictionary, e.g. moving the
+    // crossfader only needs kBGMCrossfaderKey_Position. Getting it returns every setting. See the
+    // dictionary keys below.
+    kAudioDeviceCustomPropertyCrossfader                              = 'xfdr',
+    // A CFArray of CFDictionaries that each schedule a gain change for an app at a given host time,
+    // e.g. "duck Spotify by 12 dB over 500 ms at time T". The changes start on the exact sample
+    // they're scheduled for, whatever the IO buffer size. The gains are applied after the apps'
+    // volumes and the crossfader.
+    //
+    // Setting this property adds the events to the apps' schedules. An app's events must be set in
+    // order of their times, so events can't be scheduled before one that's already scheduled for
+    // the same app. Getting it returns the events that haven't started yet. See the dictionary keys
+    // below.
+    kAudioDeviceCustomPropertyAppAutomation                           = 'aaut',
+    // A CFDictionary with a whole scene, i.e. the apps' volumes, pan positions and EQ, the routes
+    // and the music player, so a preset can be recalled with one property set instead of one for
+    // each setting. The scene is staged before it's published to IO, and everything in it changes
+    // in the same IO cycle, so listeners don't hear the intermediate states.
+    //
+    // If the scene has kBGMSceneKey_MorphMillis, the apps' volumes, pan positions and EQ gains ramp
+    // from their current values to the scene's over that time instead. The routes and the music
+    // player always change immediately. Setting kAudioDeviceCustomPropertyAppVolumes for an app
+    // while it's morphing takes effect when the morph finishes.
+    //
+    // Getting this property returns the current scene, without kBGMSceneKey_MorphMillis. See the
+    // dictionary keys below.
+    kAudioDeviceCustomPropertyScene                                   = 'scen',
+    // A CFDictionary with the settings of BGMDevice's ducking, which turns down some apps (the
+    // targets, e.g. the music player) while others (the triggers, e.g. a conferencing app) are
+    // playing. The triggers' audio is measured in the driver every IO cycle, so the targets are
+    // ducked as soon as a trigger starts playing, and the gain reduction follows an
+    // attack/hold/release envelope instead of pausing the music.
+    //
+    // Setting this property only changes the settings included in the dictionary. Getting it
+    // returns every setting. See the dictionary keys below.
+    kAudioDeviceCustomPropertyDucking                                 = 'duck',
+    // A CFArray of CFDictionaries with the loudness of each client's audio, measured in the driver as
+    // specified by EBU R128 (ITU-R BS.1770 K-weighting and gating) before the app's volume is
+    // applied, and the gain the automatic loudness normalization is applying to it. Read-only.
+    //
+    // The values change continuously, so no notifications are sent for this property. UIs should
+    // poll it. See the dictionary keys below.
+    kAudioDeviceCustomPropertyLoudness                                = 'loud',
+    // A CFDictionary with the settings of the automatic loudness normalization, which slowly steers
+    // each client's short-term loudness towards a target, so the user doesn't have to turn quiet
+    // apps up to make them match loud ones.
+    //
+    // Setting this property only changes the settings included in the dictionary. Getting it
+    // returns every setting. See the dictionary keys below.
+    kAudioDeviceCustomPropertyLoudnessNormalization                   = 'lnrm',
+    // A CFDictionary that starts and stops recording a trace of the device's IO operations, for
+    // debugging and profiling. The trace can be replayed through the driver's core with
+    // bgm-io-trace-replay. See BGM_IOTrace.h and the dictionary keys below.
+    //
+    // The trace is written by coreaudiod, so the path has to be somewhere its sandbox allows, e.g.
+    // /tmp. Existing files aren't overwritten.
+    kAudioDeviceCustomPropertyIOTrace                                 = 'iotr',
+    // A CFDictionary with the counts of the glitches on the device's IO path, e.g. underruns and
+    // late IO cycles, since it was last reset and over the last 10 and 60 seconds, and a histogram
+    // of the offset between the input and output sample times. See BGM_GlitchTelemetry.h and the
+    // dictionary keys below. Setting it to kCFBooleanTrue resets the counts.
+    kAudioDeviceCustomPropertyGlitchTelemetry                         = 'gltc',
+    // A CFArray of CFDictionaries that each contain an app's pid and/or bundle ID and its priority,
+    // one of the BGMAppPriority values below. When an IO cycle is close to running out of time, the
+    // driver stops doing optional processing for apps, starting with the lowest priority ones. See
+    // BGM_DSPBudget.h. The processing it skips is counted in kAudioDeviceCustomPropertyGlitchTelemetry.
+    //
+    // Setting this property adds, updates or (by setting kBGMAppPriorityNormal) removes apps. Apps
+    // don't have to be clients of BGMDevice when they're added. Getting it returns every app that
+    // doesn't have normal priority. See the dictionary keys below.
+    kAudioDeviceCustomPropertyAppPriorities                           = 'apri',
+    // A CFNumber<UInt32>. The number of real-time worker threads the driver processes the apps'
+    // volumes, EQ, etc. on, so that work can use more than one CPU core. 0, the default, processes
+    // them on the IO thread. Offloading the processing adds one IO buffer of latency to the apps'
+    // audio, which is included in the output stream's kAudioStreamPropertyLatency. At most
+    // kBGMMaxDSPOffloadWorkers. See BGM_IOPipeline.h.
+    //
+    // The device has to stop IO to change it, so setting it only requests the change and the new
+    // value is sent in a notification once it's been made.
+    kAudioDeviceCustomPropertyDSPOffloadWorkers                       = 'dspw'
 };
 
 // The number of silent/audible frames before BGMDriver will change kAudioDeviceCustomPropertyDeviceAudibleState
@@ -139,8 +256,9 @@ enum BGMDeviceAudibleState : SInt32
     // No audio is playing on the device's streams (regardless of whether IO is running or not)
     kBGMDeviceIsSilent              = 'silt',
     // The client whose bundle ID matches the current value of kCustomAudioDevicePropertyMusicPlayerBundleID is the
-    // only audible client
+    // only audible client. Short sounds from other clients, e.g. notifications and UI clicks, are ignored.
     kBGMDeviceIsSilentExceptMusic   = 'olym',
+    // A client other than the music player is playing sustained audio, e.g. speech or music
     kBGMDeviceIsAudible             = 'audi'
 };
 
@@ -191,14 +309,242 @@ enum BGMDeviceAudibleState : SInt32
 #define kBGMAppRoutingKey_SourceChannel      "srcCh"
 // Destination input channel (0=L, 1=R, etc.) as a CFNumber<SInt32>
 #define kBGMAppRoutingKey_DestChannel        "dstCh"
+// The value of kBGMAppRoutingKey_SourceChannel/DestChannel that means every channel
+#define kBGMAppRoutingChannelAll             -1
 // Whether the route is enabled as a CFBoolean
 #define kBGMAppRoutingKey_Enabled            "enabled"
 // Routing gain (0.0 to 1.0+)
 #define kBGMAppRoutingKey_Gain               "gain"
-// The source app's bundle ID as a CFString (optional, for reference)
+// The source app's bundle ID as a CFString. Optional. If given, the route is from every client with
+// this bundle ID, including ones added later, instead of from the source pid.
 #define kBGMAppRoutingKey_SourceBundleID     "srcBid"
-// The destination app's bundle ID as a CFString (optional, for reference)
+// The destination app's bundle ID as a CFString. Optional, like kBGMAppRoutingKey_SourceBundleID.
 #define kBGMAppRoutingKey_DestBundleID       "dstBid"
+// The number of frames to delay the route's audio by as a CFNumber<SInt32>, from 0 to
+// kBGMAppRoutingMaxDelayFrames (optional, defaults to 0)
+#define kBGMAppRoutingKey_DelayFrames        "delay"
+#define kBGMAppRoutingMaxDelayFrames         8192
+// The route's latency in frames, relative to the loopback audio, as a CFNumber<SInt32>. Read-only.
+#define kBGMAppRoutingKey_LatencyFrames      "latency"
+
+// kAudioDeviceCustomPropertyMixMinusApps keys
+//
+// The app's pid as a CFNumber. May be omitted if kBGMMixMinusKey_BundleID is present.
+#define kBGMMixMinusKey_ProcessID            "pid"
+// The app's bundle ID as a CFString. May be omitted if kBGMMixMinusKey_ProcessID is present.
+#define kBGMMixMinusKey_BundleID             "bid"
+// A CFBoolean. Optional, defaults to true. False turns mix-minus off for the app.
+#define kBGMMixMinusKey_Enabled              "enabled"
+
+// kAudioDeviceCustomPropertyCaptureFilters keys
+//
+// The reader app's bundle ID as a CFString.
+#define kBGMCaptureFilterKey_ReaderBundleID  "reader"
+// A CFNumber. One of the BGMCaptureFilterMode values below.
+#define kBGMCaptureFilterKey_Mode            "mode"
+// A CFArray of the bundle IDs (CFStrings) of the apps the filter includes/excludes. Optional,
+// defaults to an empty array.
+#define kBGMCaptureFilterKey_Apps            "apps"
+
+// kAudioDeviceCustomPropertyCaptureFilters modes
+enum BGMCaptureFilterMode : SInt32
+{
+    // No filter. The reader gets the full loopback mix.
+    kBGMCaptureFilterModeNone    = 0,
+    // The reader gets the mix of every app except the ones listed.
+    kBGMCaptureFilterModeExclude = 1,
+    // The reader gets the mix of only the apps listed.
+    kBGMCaptureFilterModeInclude = 2
+};
+
+// kAudioDeviceCustomPropertyCrossfader keys
+//
+// The bundle IDs (CFStrings) of the apps in group A, as a CFArray. An app can't be in both groups.
+#define kBGMCrossfaderKey_GroupA             "a"
+// The bundle IDs (CFStrings) of the apps in group B, as a CFArray.
+#define kBGMCrossfaderKey_GroupB             "b"
+// The position as a CFNumber<Float32> from -1.0, where only group A is heard, to 1.0, where only
+// group B is heard. Defaults to 0.0, the centre.
+#define kBGMCrossfaderKey_Position           "pos"
+// A CFNumber. One of the BGMCrossfaderCurve values below. Defaults to kBGMCrossfaderCurveEqualPower.
+#define kBGMCrossfaderKey_Curve              "curve"
+
+// kAudioDeviceCustomPropertyAppAutomation keys
+//
+// The app's PID as a CFNumber<pid_t>. An app's events are scheduled by PID or by bundle ID, and
+// clients with events scheduled by PID ignore the ones scheduled by bundle ID.
+#define kBGMAppAutomationKey_ProcessID       "pid"
+// The app's bundle ID as a CFString.
+#define kBGMAppAutomationKey_BundleID        "bid"
+// The mach host time (see mach_absolute_time) the event starts at as a CFNumber<SInt64>. Defaults
+// to now. Events scheduled for times that have already passed start as soon as possible.
+#define kBGMAppAutomationKey_HostTime        "host"
+// The gain to change to in dB as a CFNumber<Float32>, relative to the app's volume. Clamped to
+// kBGMAppAutomationMaxGainDB. Gains at or below kBGMAppAutomationMinGainDB silence the app.
+#define kBGMAppAutomationKey_GainDB          "db"
+// How long to ramp to the gain for, in milliseconds, as a CFNumber<Float32>. Defaults to 0, in
+// which case the gain changes on the sample at the event's host time.
+#define kBGMAppAutomationKey_RampMillis      "ramp"
+
+#define kBGMAppAutomationMinGainDB           -96.0f
+#define kBGMAppAutomationMaxGainDB           12.0f
+
+// kAudioDeviceCustomPropertyScene keys
+//
+// The apps' settings as a CFArray in the kAudioDeviceCustomPropertyAppVolumes format. Apps that
+// aren't in the array keep their settings.
+#define kBGMSceneKey_AppVolumes              "apps"
+// The routes as a CFArray in the kAudioDeviceCustomPropertyAppRouting format. If it's included,
+// it replaces every existing route, so an empty array removes them all.
+#define kBGMSceneKey_Routes                  "routes"
+// The music player's PID as a CFNumber<pid_t> or its bundle ID as a CFString. Like
+// kAudioDeviceCustomPropertyMusicPlayerProcessID and kAudioDeviceCustomPropertyMusicPlayerBundleID,
+// setting one unsets the other.
+#define kBGMSceneKey_MusicPlayerProcessID    "mppi"
+#define kBGMSceneKey_MusicPlayerBundleID     "mpbi"
+// How long to morph to the scene for, in milliseconds, as a CFNumber<Float32>. Defaults to 0, in
+// which case the scene is applied immediately. At most kBGMSceneMaxMorphMillis.
+#define kBGMSceneKey_MorphMillis             "morph"
+
+#define kBGMSceneMaxMorphMillis              60000.0f
+
+// kAudioDeviceCustomPropertyDucking keys
+//
+// CFArrays of the bundle IDs (CFStrings) of the apps that trigger ducking and the apps that get
+// ducked. An app can't be in both. Ducking is off if either is empty, unless
+// kBGMDuckingKey_DucksMusicPlayer is set.
+#define kBGMDuckingKey_Triggers              "trig"
+#define kBGMDuckingKey_Targets               "targ"
+// A CFBoolean. True if the music player (see kAudioDeviceCustomPropertyMusicPlayerProcessID) should
+// be ducked as well as the targets. Defaults to false.
+#define kBGMDuckingKey_DucksMusicPlayer      "mp"
+// A CFBoolean. True if the triggers should only cause ducking while they're playing sustained audio,
+// e.g. speech or music, and not for short sounds like notifications. Defaults to false.
+#define kBGMDuckingKey_SustainedTriggersOnly "sust"
+// CFNumber<Float32>s. A trigger is playing if its peak level is over the threshold, in dBFS. The
+// depth is the gain applied to the targets while ducking, in dB. The attack and release times are
+// how long the gain takes to move from unity to the depth and back. The hold time is how long the
+// triggers have to be under the threshold before the targets are released.
+#define kBGMDuckingKey_ThresholdDB           "thr"
+#define kBGMDuckingKey_DepthDB               "depth"
+#define kBGMDuckingKey_AttackMillis          "att"
+#define kBGMDuckingKey_HoldMillis            "hold"
+#define kBGMDuckingKey_ReleaseMillis         "rel"
+
+#define kBGMDuckingDefaultThresholdDB        -50.0f
+#define kBGMDuckingDefaultDepthDB            -18.0f
+#define kBGMDuckingDefaultAttackMillis       20.0f
+#define kBGMDuckingDefaultHoldMillis         500.0f
+#define kBGMDuckingDefaultReleaseMillis      800.0f
+
+// The threshold and depth are clamped to [kBGMDuckingMinDB, 0.0] and the times to
+// [0.0, kBGMDuckingMaxMillis].
+#define kBGMDuckingMinDB                     -96.0f
+#define kBGMDuckingMaxMillis                 10000.0f
+
+// kAudioDeviceCustomPropertyLoudness keys
+//
+// The client's pid (CFNumber) and its bundle ID (CFString), if it has one.
+#define kBGMLoudnessKey_ProcessID            "pid"
+#define kBGMLoudnessKey_BundleID             "bid"
+// CFNumber<Float32>s. The momentary (400 ms), short-term (3 s) and integrated (gated, since the
+// client started) loudness in LUFS. kBGMLoudnessMinLUFS if the client hasn't played enough audio
+// to measure or was silent.
+#define kBGMLoudnessKey_MomentaryLUFS        "m"
+#define kBGMLoudnessKey_ShortTermLUFS        "s"
+#define kBGMLoudnessKey_IntegratedLUFS       "i"
+// A CFNumber<Float32>. The gain the loudness normalization is applying to the client, in dB.
+#define kBGMLoudnessKey_GainDB               "gain"
+
+#define kBGMLoudnessMinLUFS                  -120.0f
+
+// kAudioDeviceCustomPropertyLoudnessNormalization keys
+//
+// A CFBoolean. Defaults to false. When normalization is turned off, the clients' gains slew back to
+// 0 dB.
+#define kBGMLoudnessNormalizationKey_Enabled         "on"
+// CFNumber<Float32>s. The short-term loudness to steer the clients towards, in LUFS, the fastest
+// the gain can change, in dB per second, and the largest boost or cut, in dB.
+#define kBGMLoudnessNormalizationKey_TargetLUFS      "target"
+#define kBGMLoudnessNormalizationKey_MaxSlewDBPerSec "slew"
+#define kBGMLoudnessNormalizationKey_MaxGainDB       "max"
+
+#define kBGMLoudnessNormalizationDefaultTargetLUFS       -23.0f
+#define kBGMLoudnessNormalizationDefaultMaxSlewDBPerSec  1.0f
+#define kBGMLoudnessNormalizationDefaultMaxGainDB        12.0f
+
+// The target is clamped to [kBGMLoudnessNormalizationMinTargetLUFS, 0.0], the slew rate to
+// [kBGMLoudnessNormalizationMinSlewDBPerSec, kBGMLoudnessNormalizationMaxSlewDBPerSec] and the
+// largest gain to [0.0, kBGMLoudnessNormalizationMaxGainDB].
+#define kBGMLoudnessNormalizationMinTargetLUFS           -60.0f
+#define kBGMLoudnessNormalizationMinSlewDBPerSec         0.1f
+#define kBGMLoudnessNormalizationMaxSlewDBPerSec         60.0f
+#define kBGMLoudnessNormalizationMaxGainDB               24.0f
+
+// kAudioDeviceCustomPropertyIOTrace keys
+//
+// A CFString. The path of the file to record the trace to. Setting it to an empty string stops
+// recording. Getting it returns an empty string if the device isn't recording.
+#define kBGMIOTraceKey_Path                  "path"
+// A CFBoolean. Defaults to false. Whether to include the audio buffers in the trace, which lets it
+// be replayed exactly but makes it much larger. Only used when starting a recording.
+#define kBGMIOTraceKey_RecordAudio           "audio"
+// A CFNumber<SInt32>. Read-only. The number of records that were dropped because the trace couldn't
+// be written quickly enough.
+#define kBGMIOTraceKey_DroppedRecords        "dropped"
+
+// kAudioDeviceCustomPropertyGlitchTelemetry keys
+//
+// A CFNumber<Float64>. The seconds since the counts were reset.
+#define kBGMGlitchTelemetryKey_Seconds       "seconds"
+// A CFNumber<UInt64>. The number of IO cycles since the counts were reset.
+#define kBGMGlitchTelemetryKey_Cycles        "cycles"
+// CFDictionaries of CFNumber<UInt64>s. The counts since the counts were reset and over the last 10
+// and 60 seconds, keyed by the counters' names, e.g. "underruns". See
+// BGM_GlitchTelemetry::GetCounterName.
+#define kBGMGlitchTelemetryKey_Total         "total"
+#define kBGMGlitchTelemetryKey_Last10Seconds "10s"
+#define kBGMGlitchTelemetryKey_Last60Seconds "60s"
+// A CFArray of CFNumber<UInt64>s. The histogram of the offsets between the input and output sample
+// times. See kBGMGlitchOffsetHistogramBuckets for the buckets' ranges.
+#define kBGMGlitchTelemetryKey_OffsetHistogram "offsets"
+
+// kAudioDeviceCustomPropertyAppPriorities keys
+//
+// The app's pid as a CFNumber. May be omitted if kBGMAppPriorityKey_BundleID is present.
+#define kBGMAppPriorityKey_ProcessID         "pid"
+// The app's bundle ID as a CFString. May be omitted if kBGMAppPriorityKey_ProcessID is present.
+#define kBGMAppPriorityKey_BundleID          "bid"
+// A CFNumber<SInt32>. One of the BGMAppPriority values below.
+#define kBGMAppPriorityKey_Priority          "priority"
+
+// kAudioDeviceCustomPropertyAppPriorities values
+enum BGMAppPriority : SInt32
+{
+    // The app's EQ is bypassed as well when the driver is overloaded.
+    kBGMAppPriorityLow    = 0,
+    // The default. The app's signal classification is simplified and its routed audio dropped when
+    // the driver is overloaded.
+    kBGMAppPriorityNormal = 1,
+    // None of the app's processing is skipped.
+    kBGMAppPriorityHigh   = 2
+};
+
+// The maximum value of kAudioDeviceCustomPropertyDSPOffloadWorkers
+#define kBGMMaxDSPOffloadWorkers             16
+
+// kAudioDeviceCustomPropertyCrossfader curves, i.e. how the position maps to each group's gain
+enum BGMCrossfaderCurve : SInt32
+{
+    // The gains change linearly and add up to 1. Both groups are at -6 dB in the centre.
+    kBGMCrossfaderCurveLinear     = 0,
+    // The gains follow a quarter sine/cosine, so the total power stays constant. Both groups are at
+    // -3 dB in the centre.
+    kBGMCrossfaderCurveEqualPower = 1,
+    // Both groups are at full volume from the centre to their own end. Past the centre, the group
+    // being faded out drops linearly to silence at the other end.
+    kBGMCrossfaderCurveCut        = 2
+};
 
 // Maximum routes per client and max ring buffer size for routing
 #define kMaxRoutesPerClient 16
@@ -259,6 +605,78 @@ static const AudioObjectPropertyAddress kBGMAppRoutingAddress = {
     kAudioObjectPropertyElementMaster
 };
 
+static const AudioObjectPropertyAddress kBGMMixMinusAppsAddress = {
+    kAudioDeviceCustomPropertyMixMinusApps,
+    kAudioObjectPropertyScopeGlobal,
+    kAudioObjectPropertyElementMaster
+};
+
+static const AudioObjectPropertyAddress kBGMCaptureFiltersAddress = {
+    kAudioDeviceCustomPropertyCaptureFilters,
+    kAudioObjectPropertyScopeGlobal,
+    kAudioObjectPropertyElementMaster
+};
+
+static const AudioObjectPropertyAddress kBGMCrossfaderAddress = {
+    kAudioDeviceCustomPropertyCrossfader,
+    kAudioObjectPropertyScopeGlobal,
+    kAudioObjectPropertyElementMaster
+};
+
+static const AudioObjectPropertyAddress kBGMAppAutomationAddress = {
+    kAudioDeviceCustomPropertyAppAutomation,
+    kAudioObjectPropertyScopeGlobal,
+    kAudioObjectPropertyElementMaster
+};
+
+static const AudioObjectPropertyAddress kBGMSceneAddress = {
+    kAudioDeviceCustomPropertyScene,
+    kAudioObjectPropertyScopeGlobal,
+    kAudioObjectPropertyElementMaster
+};
+
+static const AudioObjectPropertyAddress kBGMDuckingAddress = {
+    kAudioDeviceCustomPropertyDucking,
+    kAudioObjectPropertyScopeGlobal,
+    kAudioObjectPropertyElementMaster
+};
+
+static const AudioObjectPropertyAddress kBGMLoudnessAddress = {
+    kAudioDeviceCustomPropertyLoudness,
+    kAudioObjectPropertyScopeGlobal,
+    kAudioObjectPropertyElementMaster
+};
+
+static const AudioObjectPropertyAddress kBGMLoudnessNormalizationAddress = {
+    kAudioDeviceCustomPropertyLoudnessNormalization,
+    kAudioObjectPropertyScopeGlobal,
+    kAudioObjectPropertyElementMaster
+};
+
+static const AudioObjectPropertyAddress kBGMIOTraceAddress = {
+    kAudioDeviceCustomPropertyIOTrace,
+    kAudioObjectPropertyScopeGlobal,
+    kAudioObjectPropertyElementMaster
+};
+
+static const AudioObjectPropertyAddress kBGMGlitchTelemetryAddress = {
+    kAudioDeviceCustomPropertyGlitchTelemetry,
+    kAudioObjectPropertyScopeGlobal,
+    kAudioObjectPropertyElementMaster
+};
+
+static const AudioObjectPropertyAddress kBGMAppPrioritiesAddress = {
+    kAudioDeviceCustomPropertyAppPriorities,
+    kAudioObjectPropertyScopeGlobal,
+    kAudioObjectPropertyElementMaster
+};
+
+static const AudioObjectPropertyAddress kBGMDSPOffloadWorkersAddress = {
+    kAudioDeviceCustomPropertyDSPOffloadWorkers,
+    kAudioObjectPropertyScopeGlobal,
+    kAudioObjectPropertyElementMaster
+};
+
 #pragma mark XPC Return Codes
 
 enum {
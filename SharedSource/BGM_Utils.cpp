@@ -34,6 +34,7 @@
 
 #pragma clang assume_nonnull begin
 
+#if defined(__APPLE__)
 dispatch_queue_t BGMGetDispatchQueue_PriorityUserInteractive()
 {
     long queueClass;
@@ -57,14 +58,15 @@ dispatch_queue_t BGMGetDispatchQueue_PriorityUserInteractive()
 
     return dispatch_get_global_queue(queueClass, 0);
 }
+#endif
 
 namespace BGM_Utils
 {
     // Forward declarations
-    static OSStatus LogAndSwallowExceptions(const char* __nullable fileName,
+    static OSStatus LogAndSwallowExceptions(const char* _Nullable fileName,
                                             int lineNumber,
                                             const char* callerName,
-                                            const char* __nullable message,
+                                            const char* _Nullable message,
                                             bool expected,
                                             const std::function<void(void)>& function);
 
@@ -98,7 +100,7 @@ namespace BGM_Utils
         }
     }
     
-    OSStatus LogAndSwallowExceptions(const char* __nullable fileName,
+    OSStatus LogAndSwallowExceptions(const char* _Nullable fileName,
                                      int lineNumber,
                                      const char* callerName,
                                      const std::function<void(void)>& function)
@@ -106,16 +108,16 @@ namespace BGM_Utils
         return LogAndSwallowExceptions(fileName, lineNumber, callerName, nullptr, true, function);
     }
 
-    OSStatus LogAndSwallowExceptions(const char* __nullable fileName,
+    OSStatus LogAndSwallowExceptions(const char* _Nullable fileName,
                                      int lineNumber,
                                      const char* callerName,
-                                     const char* __nullable message,
+                                     const char* _Nullable message,
                                      const std::function<void(void)>& function)
     {
         return LogAndSwallowExceptions(fileName, lineNumber, callerName, message, true, function);
     }
     
-    void LogException(const char* __nullable fileName,
+    void LogException(const char* _Nullable fileName,
                       int lineNumber,
                       const char* callerName,
                       const CAException& e)
@@ -131,7 +133,7 @@ namespace BGM_Utils
                  err);
     }
     
-    void LogUnexpectedException(const char* __nullable fileName,
+    void LogUnexpectedException(const char* _Nullable fileName,
                                 int lineNumber,
                                 const char* callerName)
     {
@@ -147,7 +149,7 @@ namespace BGM_Utils
         return LogUnexpectedExceptions(nullptr, -1, callerName, nullptr, function);
     }
     
-    OSStatus LogUnexpectedExceptions(const char* __nullable fileName,
+    OSStatus LogUnexpectedExceptions(const char* _Nullable fileName,
                                      int lineNumber,
                                      const char* callerName,
                                      const std::function<void(void)>& function)
@@ -155,10 +157,10 @@ namespace BGM_Utils
         return LogUnexpectedExceptions(fileName, lineNumber, callerName, nullptr, function);
     }
     
-    OSStatus LogUnexpectedExceptions(const char* __nullable fileName,
+    OSStatus LogUnexpectedExceptions(const char* _Nullable fileName,
                                      int lineNumber,
                                      const char* callerName,
-                                     const char* __nullable message,
+                                     const char* _Nullable message,
                                      const std::function<void(void)>& function)
     {
         return LogAndSwallowExceptions(fileName, lineNumber, callerName, message, false, function);
@@ -166,10 +168,10 @@ namespace BGM_Utils
 
 #pragma mark Implementation
 
-    static OSStatus LogAndSwallowExceptions(const char* __nullable fileName,
+    static OSStatus LogAndSwallowExceptions(const char* _Nullable fileName,
                                             int lineNumber,
                                             const char* callerName,
-                                            const char* __nullable message,
+                                            const char* _Nullable message,
                                             bool expected,
                                             const std::function<void(void)>& function)
     {
@@ -37,7 +37,9 @@
 
 // System Includes
 #include <mach/error.h>
+#if defined(__APPLE__)
 #include <dispatch/dispatch.h>
+#endif
 
 #pragma mark Macros
 
@@ -94,7 +96,7 @@
         __typeof((expression)) value = (expression); \
         BGMAssertNonNull2(value, #expression); \
         BGMNonNullCastHelper<__typeof((expression))>* helper; \
-        (__typeof(helper.asNonNull) __nonnull)value; \
+        (__typeof(helper.asNonNull) _Nonnull)value; \
     })
 
 #else /* __has_feature(objc_generics) */
@@ -144,7 +146,9 @@
 
 #pragma mark C Utility Functions
 
+#if defined(__APPLE__)
 dispatch_queue_t BGMGetDispatchQueue_PriorityUserInteractive(void);
+#endif
 
 #if defined(__cplusplus)
 
@@ -155,9 +159,9 @@ namespace BGM_Utils
     // Used to explicitly cast from nullable to non-null. For Objective-C objects, use the BGMNN
     // macro (above).
     template <typename T>
-    inline T __nonnull NN(T __nullable v) {
+    inline T _Nonnull NN(T _Nullable v) {
         BGMAssertNonNull(v);
-        return static_cast<T __nonnull>(v);
+        return static_cast<T _Nonnull>(v);
     }
     
     // Log (and swallow) errors returned by Mach functions. Returns false if there was an error.
@@ -176,30 +180,30 @@ namespace BGM_Utils
     // Fails/stops debug builds. It's likely that if we log an error for an exception in release
     // builds, even if it's expected (i.e. not a bug in Background Music), we'd want to know if
     // it gets thrown during testing/debugging.
-    OSStatus LogAndSwallowExceptions(const char* __nullable fileName,
+    OSStatus LogAndSwallowExceptions(const char* _Nullable fileName,
                                      int lineNumber,
                                      const char* callerName,
                                      const std::function<void(void)>& function);
     
-    OSStatus LogAndSwallowExceptions(const char* __nullable fileName,
+    OSStatus LogAndSwallowExceptions(const char* _Nullable fileName,
                                      int lineNumber,
                                      const char* callerName,
-                                     const char* __nullable message,
+                                     const char* _Nullable message,
                                      const std::function<void(void)>& function);
     
-    void     LogException(const char* __nullable fileName,
+    void     LogException(const char* _Nullable fileName,
                           int lineNumber,
                           const char* callerName,
                           const CAException& e);
     
-    void     LogUnexpectedException(const char* __nullable fileName,
+    void     LogUnexpectedException(const char* _Nullable fileName,
                                     int lineNumber,
                                     const char* callerName);
     
     OSStatus LogUnexpectedExceptions(const char* callerName,
                                      const std::function<void(void)>& function);
     
-    OSStatus LogUnexpectedExceptions(const char* __nullable fileName,
+    OSStatus LogUnexpectedExceptions(const char* _Nullable fileName,
                                      int lineNumber,
                                      const char* callerName,
                                      const std::function<void(void)>& function);
@@ -213,10 +217,10 @@ namespace BGM_Utils
     // Fails/stops debug builds.
     //
     // TODO: Allow a format string and args for the message.
-    OSStatus LogUnexpectedExceptions(const char* __nullable fileName,
+    OSStatus LogUnexpectedExceptions(const char* _Nullable fileName,
                                      int lineNumber,
                                      const char* callerName,
-                                     const char* __nullable message,
+                                     const char* _Nullable message,
                                      const std::function<void(void)>& function);
 }
 
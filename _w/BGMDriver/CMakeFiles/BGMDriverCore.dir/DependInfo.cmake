@@ -0,0 +1,58 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/BGMDriver/BGMDriver/BGM_AudibleState.cpp" "BGMDriver/CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_AudibleState.cpp.o" "gcc" "BGMDriver/CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_AudibleState.cpp.o.d"
+  "/root/repo/BGMDriver/BGMDriver/BGM_Crossfader.cpp" "BGMDriver/CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_Crossfader.cpp.o" "gcc" "BGMDriver/CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_Crossfader.cpp.o.d"
+  "/root/repo/BGMDriver/BGMDriver/BGM_DSPBudget.cpp" "BGMDriver/CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_DSPBudget.cpp.o" "gcc" "BGMDriver/CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_DSPBudget.cpp.o.d"
+  "/root/repo/BGMDriver/BGMDriver/BGM_DSPContext.cpp" "BGMDriver/CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_DSPContext.cpp.o" "gcc" "BGMDriver/CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_DSPContext.cpp.o.d"
+  "/root/repo/BGMDriver/BGMDriver/BGM_DSPWorkerPool.cpp" "BGMDriver/CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_DSPWorkerPool.cpp.o" "gcc" "BGMDriver/CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_DSPWorkerPool.cpp.o.d"
+  "/root/repo/BGMDriver/BGMDriver/BGM_Ducker.cpp" "BGMDriver/CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_Ducker.cpp.o" "gcc" "BGMDriver/CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_Ducker.cpp.o.d"
+  "/root/repo/BGMDriver/BGMDriver/BGM_GainRamp.cpp" "BGMDriver/CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_GainRamp.cpp.o" "gcc" "BGMDriver/CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_GainRamp.cpp.o.d"
+  "/root/repo/BGMDriver/BGMDriver/BGM_IOPipeline.cpp" "BGMDriver/CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_IOPipeline.cpp.o" "gcc" "BGMDriver/CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_IOPipeline.cpp.o.d"
+  "/root/repo/BGMDriver/BGMDriver/BGM_IOTrace.cpp" "BGMDriver/CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_IOTrace.cpp.o" "gcc" "BGMDriver/CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_IOTrace.cpp.o.d"
+  "/root/repo/BGMDriver/BGMDriver/BGM_LoudnessMeter.cpp" "BGMDriver/CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_LoudnessMeter.cpp.o" "gcc" "BGMDriver/CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_LoudnessMeter.cpp.o.d"
+  "/root/repo/BGMDriver/BGMDriver/BGM_ParameterAutomation.cpp" "BGMDriver/CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_ParameterAutomation.cpp.o" "gcc" "BGMDriver/CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_ParameterAutomation.cpp.o.d"
+  "/root/repo/BGMDriver/BGMDriver/BGM_SampleTimeRingBuffer.cpp" "BGMDriver/CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_SampleTimeRingBuffer.cpp.o" "gcc" "BGMDriver/CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_SampleTimeRingBuffer.cpp.o.d"
+  "/root/repo/BGMDriver/BGMDriver/BGM_SceneMorph.cpp" "BGMDriver/CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_SceneMorph.cpp.o" "gcc" "BGMDriver/CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_SceneMorph.cpp.o.d"
+  "/root/repo/BGMDriver/BGMDriver/BGM_SharedParameterTable.cpp" "BGMDriver/CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_SharedParameterTable.cpp.o" "gcc" "BGMDriver/CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_SharedParameterTable.cpp.o.d"
+  "/root/repo/BGMDriver/BGMDriver/BGM_SignalClassifier.cpp" "BGMDriver/CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_SignalClassifier.cpp.o" "gcc" "BGMDriver/CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_SignalClassifier.cpp.o.d"
+  "/root/repo/BGMDriver/BGMDriver/BGM_TaskQueue.cpp" "BGMDriver/CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_TaskQueue.cpp.o" "gcc" "BGMDriver/CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_TaskQueue.cpp.o.d"
+  "/root/repo/BGMDriver/BGMDriver/DeviceClients/BGM_Client.cpp" "BGMDriver/CMakeFiles/BGMDriverCore.dir/BGMDriver/DeviceClients/BGM_Client.cpp.o" "gcc" "BGMDriver/CMakeFiles/BGMDriverCore.dir/BGMDriver/DeviceClients/BGM_Client.cpp.o.d"
+  "/root/repo/BGMDriver/BGMDriver/DeviceClients/BGM_ClientDSPStatePool.cpp" "BGMDriver/CMakeFiles/BGMDriverCore.dir/BGMDriver/DeviceClients/BGM_ClientDSPStatePool.cpp.o" "gcc" "BGMDriver/CMakeFiles/BGMDriverCore.dir/BGMDriver/DeviceClients/BGM_ClientDSPStatePool.cpp.o.d"
+  "/root/repo/BGMDriver/BGMDriver/DeviceClients/BGM_ClientMap.cpp" "BGMDriver/CMakeFiles/BGMDriverCore.dir/BGMDriver/DeviceClients/BGM_ClientMap.cpp.o" "gcc" "BGMDriver/CMakeFiles/BGMDriverCore.dir/BGMDriver/DeviceClients/BGM_ClientMap.cpp.o.d"
+  "/root/repo/BGMDriver/BGMDriver/DeviceClients/BGM_Clients.cpp" "BGMDriver/CMakeFiles/BGMDriverCore.dir/BGMDriver/DeviceClients/BGM_Clients.cpp.o" "gcc" "BGMDriver/CMakeFiles/BGMDriverCore.dir/BGMDriver/DeviceClients/BGM_Clients.cpp.o.d"
+  "/root/repo/BGMDriver/Portable/BGM_PortableCoreFoundation.cpp" "BGMDriver/CMakeFiles/BGMDriverCore.dir/Portable/BGM_PortableCoreFoundation.cpp.o" "gcc" "BGMDriver/CMakeFiles/BGMDriverCore.dir/Portable/BGM_PortableCoreFoundation.cpp.o.d"
+  "/root/repo/BGMDriver/Portable/BGM_PortableMach.cpp" "BGMDriver/CMakeFiles/BGMDriverCore.dir/Portable/BGM_PortableMach.cpp.o" "gcc" "BGMDriver/CMakeFiles/BGMDriverCore.dir/Portable/BGM_PortableMach.cpp.o.d"
+  "/root/repo/BGMDriver/Portable/BGM_PortablePlugIn.cpp" "BGMDriver/CMakeFiles/BGMDriverCore.dir/Portable/BGM_PortablePlugIn.cpp.o" "gcc" "BGMDriver/CMakeFiles/BGMDriverCore.dir/Portable/BGM_PortablePlugIn.cpp.o.d"
+  "/root/repo/BGMDriver/Portable/BGM_SimulatedHost.cpp" "BGMDriver/CMakeFiles/BGMDriverCore.dir/Portable/BGM_SimulatedHost.cpp.o" "gcc" "BGMDriver/CMakeFiles/BGMDriverCore.dir/Portable/BGM_SimulatedHost.cpp.o.d"
+  "/root/repo/BGMDriver/PublicUtility/CACFArray.cpp" "BGMDriver/CMakeFiles/BGMDriverCore.dir/PublicUtility/CACFArray.cpp.o" "gcc" "BGMDriver/CMakeFiles/BGMDriverCore.dir/PublicUtility/CACFArray.cpp.o.d"
+  "/root/repo/BGMDriver/PublicUtility/CACFDictionary.cpp" "BGMDriver/CMakeFiles/BGMDriverCore.dir/PublicUtility/CACFDictionary.cpp.o" "gcc" "BGMDriver/CMakeFiles/BGMDriverCore.dir/PublicUtility/CACFDictionary.cpp.o.d"
+  "/root/repo/BGMDriver/PublicUtility/CACFNumber.cpp" "BGMDriver/CMakeFiles/BGMDriverCore.dir/PublicUtility/CACFNumber.cpp.o" "gcc" "BGMDriver/CMakeFiles/BGMDriverCore.dir/PublicUtility/CACFNumber.cpp.o.d"
+  "/root/repo/BGMDriver/PublicUtility/CACFString.cpp" "BGMDriver/CMakeFiles/BGMDriverCore.dir/PublicUtility/CACFString.cpp.o" "gcc" "BGMDriver/CMakeFiles/BGMDriverCore.dir/PublicUtility/CACFString.cpp.o.d"
+  "/root/repo/BGMDriver/PublicUtility/CADebugMacros.cpp" "BGMDriver/CMakeFiles/BGMDriverCore.dir/PublicUtility/CADebugMacros.cpp.o" "gcc" "BGMDriver/CMakeFiles/BGMDriverCore.dir/PublicUtility/CADebugMacros.cpp.o.d"
+  "/root/repo/BGMDriver/PublicUtility/CADebugPrintf.cpp" "BGMDriver/CMakeFiles/BGMDriverCore.dir/PublicUtility/CADebugPrintf.cpp.o" "gcc" "BGMDriver/CMakeFiles/BGMDriverCore.dir/PublicUtility/CADebugPrintf.cpp.o.d"
+  "/root/repo/BGMDriver/PublicUtility/CAHostTimeBase.cpp" "BGMDriver/CMakeFiles/BGMDriverCore.dir/PublicUtility/CAHostTimeBase.cpp.o" "gcc" "BGMDriver/CMakeFiles/BGMDriverCore.dir/PublicUtility/CAHostTimeBase.cpp.o.d"
+  "/root/repo/BGMDriver/PublicUtility/CAMutex.cpp" "BGMDriver/CMakeFiles/BGMDriverCore.dir/PublicUtility/CAMutex.cpp.o" "gcc" "BGMDriver/CMakeFiles/BGMDriverCore.dir/PublicUtility/CAMutex.cpp.o.d"
+  "/root/repo/BGMDriver/PublicUtility/CAPThread.cpp" "BGMDriver/CMakeFiles/BGMDriverCore.dir/PublicUtility/CAPThread.cpp.o" "gcc" "BGMDriver/CMakeFiles/BGMDriverCore.dir/PublicUtility/CAPThread.cpp.o.d"
+  "/root/repo/BGMDriver/PublicUtility/CARingBuffer.cpp" "BGMDriver/CMakeFiles/BGMDriverCore.dir/PublicUtility/CARingBuffer.cpp.o" "gcc" "BGMDriver/CMakeFiles/BGMDriverCore.dir/PublicUtility/CARingBuffer.cpp.o.d"
+  "/root/repo/BGMDriver/PublicUtility/CAVolumeCurve.cpp" "BGMDriver/CMakeFiles/BGMDriverCore.dir/PublicUtility/CAVolumeCurve.cpp.o" "gcc" "BGMDriver/CMakeFiles/BGMDriverCore.dir/PublicUtility/CAVolumeCurve.cpp.o.d"
+  "/root/repo/SharedSource/BGM_AudioRingBuffer.cpp" "BGMDriver/CMakeFiles/BGMDriverCore.dir/__/SharedSource/BGM_AudioRingBuffer.cpp.o" "gcc" "BGMDriver/CMakeFiles/BGMDriverCore.dir/__/SharedSource/BGM_AudioRingBuffer.cpp.o.d"
+  "/root/repo/SharedSource/BGM_GlitchTelemetry.cpp" "BGMDriver/CMakeFiles/BGMDriverCore.dir/__/SharedSource/BGM_GlitchTelemetry.cpp.o" "gcc" "BGMDriver/CMakeFiles/BGMDriverCore.dir/__/SharedSource/BGM_GlitchTelemetry.cpp.o.d"
+  "/root/repo/SharedSource/BGM_RTEventLog.cpp" "BGMDriver/CMakeFiles/BGMDriverCore.dir/__/SharedSource/BGM_RTEventLog.cpp.o" "gcc" "BGMDriver/CMakeFiles/BGMDriverCore.dir/__/SharedSource/BGM_RTEventLog.cpp.o.d"
+  "/root/repo/SharedSource/BGM_RTSafety.cpp" "BGMDriver/CMakeFiles/BGMDriverCore.dir/__/SharedSource/BGM_RTSafety.cpp.o" "gcc" "BGMDriver/CMakeFiles/BGMDriverCore.dir/__/SharedSource/BGM_RTSafety.cpp.o.d"
+  "/root/repo/SharedSource/BGM_Utils.cpp" "BGMDriver/CMakeFiles/BGMDriverCore.dir/__/SharedSource/BGM_Utils.cpp.o" "gcc" "BGMDriver/CMakeFiles/BGMDriverCore.dir/__/SharedSource/BGM_Utils.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
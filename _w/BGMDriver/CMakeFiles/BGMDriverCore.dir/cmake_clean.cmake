@@ -0,0 +1,89 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_AudibleState.cpp.o"
+  "CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_AudibleState.cpp.o.d"
+  "CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_Crossfader.cpp.o"
+  "CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_Crossfader.cpp.o.d"
+  "CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_DSPBudget.cpp.o"
+  "CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_DSPBudget.cpp.o.d"
+  "CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_DSPContext.cpp.o"
+  "CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_DSPContext.cpp.o.d"
+  "CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_DSPWorkerPool.cpp.o"
+  "CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_DSPWorkerPool.cpp.o.d"
+  "CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_Ducker.cpp.o"
+  "CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_Ducker.cpp.o.d"
+  "CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_GainRamp.cpp.o"
+  "CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_GainRamp.cpp.o.d"
+  "CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_IOPipeline.cpp.o"
+  "CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_IOPipeline.cpp.o.d"
+  "CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_IOTrace.cpp.o"
+  "CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_IOTrace.cpp.o.d"
+  "CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_LoudnessMeter.cpp.o"
+  "CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_LoudnessMeter.cpp.o.d"
+  "CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_ParameterAutomation.cpp.o"
+  "CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_ParameterAutomation.cpp.o.d"
+  "CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_SampleTimeRingBuffer.cpp.o"
+  "CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_SampleTimeRingBuffer.cpp.o.d"
+  "CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_SceneMorph.cpp.o"
+  "CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_SceneMorph.cpp.o.d"
+  "CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_SharedParameterTable.cpp.o"
+  "CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_SharedParameterTable.cpp.o.d"
+  "CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_SignalClassifier.cpp.o"
+  "CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_SignalClassifier.cpp.o.d"
+  "CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_TaskQueue.cpp.o"
+  "CMakeFiles/BGMDriverCore.dir/BGMDriver/BGM_TaskQueue.cpp.o.d"
+  "CMakeFiles/BGMDriverCore.dir/BGMDriver/DeviceClients/BGM_Client.cpp.o"
+  "CMakeFiles/BGMDriverCore.dir/BGMDriver/DeviceClients/BGM_Client.cpp.o.d"
+  "CMakeFiles/BGMDriverCore.dir/BGMDriver/DeviceClients/BGM_ClientDSPStatePool.cpp.o"
+  "CMakeFiles/BGMDriverCore.dir/BGMDriver/DeviceClients/BGM_ClientDSPStatePool.cpp.o.d"
+  "CMakeFiles/BGMDriverCore.dir/BGMDriver/DeviceClients/BGM_ClientMap.cpp.o"
+  "CMakeFiles/BGMDriverCore.dir/BGMDriver/DeviceClients/BGM_ClientMap.cpp.o.d"
+  "CMakeFiles/BGMDriverCore.dir/BGMDriver/DeviceClients/BGM_Clients.cpp.o"
+  "CMakeFiles/BGMDriverCore.dir/BGMDriver/DeviceClients/BGM_Clients.cpp.o.d"
+  "CMakeFiles/BGMDriverCore.dir/Portable/BGM_PortableCoreFoundation.cpp.o"
+  "CMakeFiles/BGMDriverCore.dir/Portable/BGM_PortableCoreFoundation.cpp.o.d"
+  "CMakeFiles/BGMDriverCore.dir/Portable/BGM_PortableMach.cpp.o"
+  "CMakeFiles/BGMDriverCore.dir/Portable/BGM_PortableMach.cpp.o.d"
+  "CMakeFiles/BGMDriverCore.dir/Portable/BGM_PortablePlugIn.cpp.o"
+  "CMakeFiles/BGMDriverCore.dir/Portable/BGM_PortablePlugIn.cpp.o.d"
+  "CMakeFiles/BGMDriverCore.dir/Portable/BGM_SimulatedHost.cpp.o"
+  "CMakeFiles/BGMDriverCore.dir/Portable/BGM_SimulatedHost.cpp.o.d"
+  "CMakeFiles/BGMDriverCore.dir/PublicUtility/CACFArray.cpp.o"
+  "CMakeFiles/BGMDriverCore.dir/PublicUtility/CACFArray.cpp.o.d"
+  "CMakeFiles/BGMDriverCore.dir/PublicUtility/CACFDictionary.cpp.o"
+  "CMakeFiles/BGMDriverCore.dir/PublicUtility/CACFDictionary.cpp.o.d"
+  "CMakeFiles/BGMDriverCore.dir/PublicUtility/CACFNumber.cpp.o"
+  "CMakeFiles/BGMDriverCore.dir/PublicUtility/CACFNumber.cpp.o.d"
+  "CMakeFiles/BGMDriverCore.dir/PublicUtility/CACFString.cpp.o"
+  "CMakeFiles/BGMDriverCore.dir/PublicUtility/CACFString.cpp.o.d"
+  "CMakeFiles/BGMDriverCore.dir/PublicUtility/CADebugMacros.cpp.o"
+  "CMakeFiles/BGMDriverCore.dir/PublicUtility/CADebugMacros.cpp.o.d"
+  "CMakeFiles/BGMDriverCore.dir/PublicUtility/CADebugPrintf.cpp.o"
+  "CMakeFiles/BGMDriverCore.dir/PublicUtility/CADebugPrintf.cpp.o.d"
+  "CMakeFiles/BGMDriverCore.dir/PublicUtility/CAHostTimeBase.cpp.o"
+  "CMakeFiles/BGMDriverCore.dir/PublicUtility/CAHostTimeBase.cpp.o.d"
+  "CMakeFiles/BGMDriverCore.dir/PublicUtility/CAMutex.cpp.o"
+  "CMakeFiles/BGMDriverCore.dir/PublicUtility/CAMutex.cpp.o.d"
+  "CMakeFiles/BGMDriverCore.dir/PublicUtility/CAPThread.cpp.o"
+  "CMakeFiles/BGMDriverCore.dir/PublicUtility/CAPThread.cpp.o.d"
+  "CMakeFiles/BGMDriverCore.dir/PublicUtility/CARingBuffer.cpp.o"
+  "CMakeFiles/BGMDriverCore.dir/PublicUtility/CARingBuffer.cpp.o.d"
+  "CMakeFiles/BGMDriverCore.dir/PublicUtility/CAVolumeCurve.cpp.o"
+  "CMakeFiles/BGMDriverCore.dir/PublicUtility/CAVolumeCurve.cpp.o.d"
+  "CMakeFiles/BGMDriverCore.dir/__/SharedSource/BGM_AudioRingBuffer.cpp.o"
+  "CMakeFiles/BGMDriverCore.dir/__/SharedSource/BGM_AudioRingBuffer.cpp.o.d"
+  "CMakeFiles/BGMDriverCore.dir/__/SharedSource/BGM_GlitchTelemetry.cpp.o"
+  "CMakeFiles/BGMDriverCore.dir/__/SharedSource/BGM_GlitchTelemetry.cpp.o.d"
+  "CMakeFiles/BGMDriverCore.dir/__/SharedSource/BGM_RTEventLog.cpp.o"
+  "CMakeFiles/BGMDriverCore.dir/__/SharedSource/BGM_RTEventLog.cpp.o.d"
+  "CMakeFiles/BGMDriverCore.dir/__/SharedSource/BGM_RTSafety.cpp.o"
+  "CMakeFiles/BGMDriverCore.dir/__/SharedSource/BGM_RTSafety.cpp.o.d"
+  "CMakeFiles/BGMDriverCore.dir/__/SharedSource/BGM_Utils.cpp.o"
+  "CMakeFiles/BGMDriverCore.dir/__/SharedSource/BGM_Utils.cpp.o.d"
+  "libBGMDriverCore.a"
+  "libBGMDriverCore.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/BGMDriverCore.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bgm-classifier-eval.dir/Tools/BGM_SignalClassifierEval.cpp.o"
+  "CMakeFiles/bgm-classifier-eval.dir/Tools/BGM_SignalClassifierEval.cpp.o.d"
+  "bgm-classifier-eval"
+  "bgm-classifier-eval.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bgm-classifier-eval.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bgm-client-churn-benchmark.dir/Tools/BGM_ClientChurnBenchmark.cpp.o"
+  "CMakeFiles/bgm-client-churn-benchmark.dir/Tools/BGM_ClientChurnBenchmark.cpp.o.d"
+  "bgm-client-churn-benchmark"
+  "bgm-client-churn-benchmark.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bgm-client-churn-benchmark.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bgm-denormal-benchmark.dir/Tools/BGM_DenormalBenchmark.cpp.o"
+  "CMakeFiles/bgm-denormal-benchmark.dir/Tools/BGM_DenormalBenchmark.cpp.o.d"
+  "bgm-denormal-benchmark"
+  "bgm-denormal-benchmark.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bgm-denormal-benchmark.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bgm-gain-ramp-benchmark.dir/Tools/BGM_GainRampBenchmark.cpp.o"
+  "CMakeFiles/bgm-gain-ramp-benchmark.dir/Tools/BGM_GainRampBenchmark.cpp.o.d"
+  "bgm-gain-ramp-benchmark"
+  "bgm-gain-ramp-benchmark.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bgm-gain-ramp-benchmark.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bgm-glitch-telemetry.dir/Tools/BGM_GlitchTelemetryTool.cpp.o"
+  "CMakeFiles/bgm-glitch-telemetry.dir/Tools/BGM_GlitchTelemetryTool.cpp.o.d"
+  "bgm-glitch-telemetry"
+  "bgm-glitch-telemetry.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bgm-glitch-telemetry.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
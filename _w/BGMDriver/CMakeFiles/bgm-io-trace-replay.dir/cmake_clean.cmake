@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bgm-io-trace-replay.dir/Tools/BGM_IOTraceReplay.cpp.o"
+  "CMakeFiles/bgm-io-trace-replay.dir/Tools/BGM_IOTraceReplay.cpp.o.d"
+  "bgm-io-trace-replay"
+  "bgm-io-trace-replay.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bgm-io-trace-replay.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bgm-loudness-conformance.dir/Tools/BGM_LoudnessConformance.cpp.o"
+  "CMakeFiles/bgm-loudness-conformance.dir/Tools/BGM_LoudnessConformance.cpp.o.d"
+  "bgm-loudness-conformance"
+  "bgm-loudness-conformance.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bgm-loudness-conformance.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
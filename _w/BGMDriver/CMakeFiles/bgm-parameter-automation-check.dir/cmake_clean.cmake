@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bgm-parameter-automation-check.dir/Tools/BGM_ParameterAutomationCheck.cpp.o"
+  "CMakeFiles/bgm-parameter-automation-check.dir/Tools/BGM_ParameterAutomationCheck.cpp.o.d"
+  "bgm-parameter-automation-check"
+  "bgm-parameter-automation-check.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bgm-parameter-automation-check.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
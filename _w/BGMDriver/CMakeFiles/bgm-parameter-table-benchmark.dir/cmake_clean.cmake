@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bgm-parameter-table-benchmark.dir/Tools/BGM_ParameterTableBenchmark.cpp.o"
+  "CMakeFiles/bgm-parameter-table-benchmark.dir/Tools/BGM_ParameterTableBenchmark.cpp.o.d"
+  "bgm-parameter-table-benchmark"
+  "bgm-parameter-table-benchmark.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bgm-parameter-table-benchmark.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
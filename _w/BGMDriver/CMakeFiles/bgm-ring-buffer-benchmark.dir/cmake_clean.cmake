@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bgm-ring-buffer-benchmark.dir/Tools/BGM_RingBufferBenchmark.cpp.o"
+  "CMakeFiles/bgm-ring-buffer-benchmark.dir/Tools/BGM_RingBufferBenchmark.cpp.o.d"
+  "bgm-ring-buffer-benchmark"
+  "bgm-ring-buffer-benchmark.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bgm-ring-buffer-benchmark.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bgm-rt-event-decode.dir/Tools/BGM_RTEventDecode.cpp.o"
+  "CMakeFiles/bgm-rt-event-decode.dir/Tools/BGM_RTEventDecode.cpp.o.d"
+  "bgm-rt-event-decode"
+  "bgm-rt-event-decode.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bgm-rt-event-decode.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
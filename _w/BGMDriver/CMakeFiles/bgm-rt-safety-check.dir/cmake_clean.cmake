@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bgm-rt-safety-check.dir/Portable/BGM_RTSafetyInterposers.cpp.o"
+  "CMakeFiles/bgm-rt-safety-check.dir/Portable/BGM_RTSafetyInterposers.cpp.o.d"
+  "CMakeFiles/bgm-rt-safety-check.dir/Tools/BGM_RTSafetyCheck.cpp.o"
+  "CMakeFiles/bgm-rt-safety-check.dir/Tools/BGM_RTSafetyCheck.cpp.o.d"
+  "bgm-rt-safety-check"
+  "bgm-rt-safety-check.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bgm-rt-safety-check.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bgm-simulated-host.dir/Tools/BGM_SimulatedHostTool.cpp.o"
+  "CMakeFiles/bgm-simulated-host.dir/Tools/BGM_SimulatedHostTool.cpp.o.d"
+  "bgm-simulated-host"
+  "bgm-simulated-host.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bgm-simulated-host.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
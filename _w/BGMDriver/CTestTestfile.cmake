@@ -0,0 +1,40 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo/BGMDriver
+# Build directory: /root/repo/_w/BGMDriver
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+add_test(SimulatedHostCheck "/root/repo/_w/BGMDriver/bgm-simulated-host" "check")
+set_tests_properties(SimulatedHostCheck PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/BGMDriver/CMakeLists.txt;156;add_test;/root/repo/BGMDriver/CMakeLists.txt;0;")
+add_test(SimulatedHostCheckSmallBuffers "/root/repo/_w/BGMDriver/bgm-simulated-host" "check" "64")
+set_tests_properties(SimulatedHostCheckSmallBuffers PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/BGMDriver/CMakeLists.txt;157;add_test;/root/repo/BGMDriver/CMakeLists.txt;0;")
+add_test(RingBufferCheck "/root/repo/_w/BGMDriver/bgm-ring-buffer-benchmark" "check")
+set_tests_properties(RingBufferCheck PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/BGMDriver/CMakeLists.txt;159;add_test;/root/repo/BGMDriver/CMakeLists.txt;0;")
+add_test(GainRampCheck "/root/repo/_w/BGMDriver/bgm-gain-ramp-benchmark" "check")
+set_tests_properties(GainRampCheck PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/BGMDriver/CMakeLists.txt;161;add_test;/root/repo/BGMDriver/CMakeLists.txt;0;")
+add_test(RTEventLogCheck "/root/repo/_w/BGMDriver/bgm-rt-event-decode" "check" "/root/repo/_w/BGMDriver/rt-event-log-check.events")
+set_tests_properties(RTEventLogCheck PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/BGMDriver/CMakeLists.txt;163;add_test;/root/repo/BGMDriver/CMakeLists.txt;0;")
+add_test(GlitchTelemetryCheck "/root/repo/_w/BGMDriver/bgm-glitch-telemetry" "check")
+set_tests_properties(GlitchTelemetryCheck PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/BGMDriver/CMakeLists.txt;166;add_test;/root/repo/BGMDriver/CMakeLists.txt;0;")
+add_test(ClientChurnCheck "/root/repo/_w/BGMDriver/bgm-client-churn-benchmark" "check")
+set_tests_properties(ClientChurnCheck PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/BGMDriver/CMakeLists.txt;168;add_test;/root/repo/BGMDriver/CMakeLists.txt;0;")
+add_test(ParameterAutomationCheck "/root/repo/_w/BGMDriver/bgm-parameter-automation-check" "check")
+set_tests_properties(ParameterAutomationCheck PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/BGMDriver/CMakeLists.txt;170;add_test;/root/repo/BGMDriver/CMakeLists.txt;0;")
+add_test(ParameterTableCheck "/root/repo/_w/BGMDriver/bgm-parameter-table-benchmark" "check")
+set_tests_properties(ParameterTableCheck PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/BGMDriver/CMakeLists.txt;172;add_test;/root/repo/BGMDriver/CMakeLists.txt;0;")
+add_test(RTSafetyCheck "/root/repo/_w/BGMDriver/bgm-rt-safety-check" "check")
+set_tests_properties(RTSafetyCheck PROPERTIES  SKIP_RETURN_CODE "77" _BACKTRACE_TRIPLES "/root/repo/BGMDriver/CMakeLists.txt;175;add_test;/root/repo/BGMDriver/CMakeLists.txt;0;")
+add_test(RTSafetyCheckSmallBuffers "/root/repo/_w/BGMDriver/bgm-rt-safety-check" "check" "64")
+set_tests_properties(RTSafetyCheckSmallBuffers PROPERTIES  SKIP_RETURN_CODE "77" _BACKTRACE_TRIPLES "/root/repo/BGMDriver/CMakeLists.txt;176;add_test;/root/repo/BGMDriver/CMakeLists.txt;0;")
+add_test(LoudnessConformance "/root/repo/_w/BGMDriver/bgm-loudness-conformance" "test")
+set_tests_properties(LoudnessConformance PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/BGMDriver/CMakeLists.txt;181;add_test;/root/repo/BGMDriver/CMakeLists.txt;0;")
+add_test(SignalClassifierGenerateClips "/root/repo/_w/BGMDriver/bgm-classifier-eval" "generate" "/root/repo/_w/BGMDriver/classifier-clips")
+set_tests_properties(SignalClassifierGenerateClips PROPERTIES  FIXTURES_SETUP "BGMClassifierClips" _BACKTRACE_TRIPLES "/root/repo/BGMDriver/CMakeLists.txt;185;add_test;/root/repo/BGMDriver/CMakeLists.txt;0;")
+add_test(SignalClassifierEval "/root/repo/_w/BGMDriver/bgm-classifier-eval" "evaluate" "/root/repo/_w/BGMDriver/classifier-clips/labels.txt")
+set_tests_properties(SignalClassifierEval PROPERTIES  FIXTURES_REQUIRED "BGMClassifierClips" _BACKTRACE_TRIPLES "/root/repo/BGMDriver/CMakeLists.txt;186;add_test;/root/repo/BGMDriver/CMakeLists.txt;0;")
+add_test(IOTraceClean "/usr/bin/cmake" "-E" "remove" "-f" "/root/repo/_w/BGMDriver/simulated-host.bgmtrace")
+set_tests_properties(IOTraceClean PROPERTIES  FIXTURES_SETUP "BGMIOTraceClean" _BACKTRACE_TRIPLES "/root/repo/BGMDriver/CMakeLists.txt;193;add_test;/root/repo/BGMDriver/CMakeLists.txt;0;")
+add_test(IOTraceRecord "/root/repo/_w/BGMDriver/bgm-simulated-host" "record" "/root/repo/_w/BGMDriver/simulated-host.bgmtrace")
+set_tests_properties(IOTraceRecord PROPERTIES  FIXTURES_REQUIRED "BGMIOTraceClean" FIXTURES_SETUP "BGMIOTrace" _BACKTRACE_TRIPLES "/root/repo/BGMDriver/CMakeLists.txt;194;add_test;/root/repo/BGMDriver/CMakeLists.txt;0;")
+add_test(IOTraceReplay "/root/repo/_w/BGMDriver/bgm-io-trace-replay" "/root/repo/_w/BGMDriver/simulated-host.bgmtrace" "verify")
+set_tests_properties(IOTraceReplay PROPERTIES  FIXTURES_REQUIRED "BGMIOTrace" _BACKTRACE_TRIPLES "/root/repo/BGMDriver/CMakeLists.txt;195;add_test;/root/repo/BGMDriver/CMakeLists.txt;0;")
@@ -0,0 +1,65 @@
+# CMAKE generated file: DO NOT EDIT!
+# Generated by "Unix Makefiles" Generator, CMake Version 3.25
+
+# The generator used is:
+set(CMAKE_DEPENDS_GENERATOR "Unix Makefiles")
+
+# The top level Makefile was generated from the following files:
+set(CMAKE_MAKEFILE_DEPENDS
+  "CMakeCache.txt"
+  "/root/repo/BGMDriver/CMakeLists.txt"
+  "/root/repo/CMakeLists.txt"
+  "CMakeFiles/3.25.1/CMakeCXXCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeSystem.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCXXInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCommonLanguageInclude.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeGenericSystem.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeInitializeConfigs.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeLanguageInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInitialize.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckCXXSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckIncludeFileCXX.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckLibraryExists.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/CMakeCommonCompilerMacros.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPackageHandleStandardArgs.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPackageMessage.cmake"
+  "/usr/share/cmake-3.25/Modules/FindThreads.cmake"
+  "/usr/share/cmake-3.25/Modules/Internal/CheckSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/UnixPaths.cmake"
+  )
+
+# The corresponding makefile is:
+set(CMAKE_MAKEFILE_OUTPUTS
+  "Makefile"
+  "CMakeFiles/cmake.check_cache"
+  )
+
+# Byproducts of CMake generate step:
+set(CMAKE_MAKEFILE_PRODUCTS
+  "CMakeFiles/CMakeDirectoryInformation.cmake"
+  "BGMDriver/CMakeFiles/CMakeDirectoryInformation.cmake"
+  )
+
+# Dependency information for all targets:
+set(CMAKE_DEPEND_INFO_FILES
+  "BGMDriver/CMakeFiles/BGMDriverCore.dir/DependInfo.cmake"
+  "BGMDriver/CMakeFiles/bgm-simulated-host.dir/DependInfo.cmake"
+  "BGMDriver/CMakeFiles/bgm-loudness-conformance.dir/DependInfo.cmake"
+  "BGMDriver/CMakeFiles/bgm-classifier-eval.dir/DependInfo.cmake"
+  "BGMDriver/CMakeFiles/bgm-io-trace-replay.dir/DependInfo.cmake"
+  "BGMDriver/CMakeFiles/bgm-rt-event-decode.dir/DependInfo.cmake"
+  "BGMDriver/CMakeFiles/bgm-glitch-telemetry.dir/DependInfo.cmake"
+  "BGMDriver/CMakeFiles/bgm-ring-buffer-benchmark.dir/DependInfo.cmake"
+  "BGMDriver/CMakeFiles/bgm-denormal-benchmark.dir/DependInfo.cmake"
+  "BGMDriver/CMakeFiles/bgm-gain-ramp-benchmark.dir/DependInfo.cmake"
+  "BGMDriver/CMakeFiles/bgm-client-churn-benchmark.dir/DependInfo.cmake"
+  "BGMDriver/CMakeFiles/bgm-parameter-automation-check.dir/DependInfo.cmake"
+  "BGMDriver/CMakeFiles/bgm-parameter-table-benchmark.dir/DependInfo.cmake"
+  "BGMDriver/CMakeFiles/bgm-rt-safety-check.dir/DependInfo.cmake"
+  )